@@ -0,0 +1,51 @@
+/**
+ * Tests file copy based initial sync: the new node copies the sync source's data files through a
+ * backup cursor, shuts itself down, and on restart installs the files and replays the oplog from
+ * the backup's checkpoint before continuing with steady state replication.
+ *
+ * @tags: [requires_wiredtiger, requires_persistence, requires_journaling]
+ */
+(function() {
+    "use strict";
+
+    const rst = new ReplSetTest({nodes: 2});
+    rst.startSet();
+
+    const conf = rst.getReplSetConfig();
+    conf.members[1].votes = 0;
+    conf.members[1].priority = 0;
+    rst.initiate(conf);
+
+    const primary = rst.getPrimary();
+    const coll = primary.getDB("test").getCollection("coll");
+    assert.commandWorked(coll.createIndex({x: 1}));
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, x: i});
+    }
+    assert.writeOK(bulk.execute());
+    rst.awaitReplication();
+
+    // Restart the secondary with an empty dbpath. It exits by itself once the files are staged.
+    const secondary = rst.nodes[1];
+    rst.stop(secondary);
+    const program = rst.start(secondary, {
+        startClean: true,
+        waitForConnect: false,
+        setParameter: {initialSyncUsesFileCopy: true, numInitialSyncAttempts: 1},
+    });
+    assert.eq(0, waitProgram(program.pid));
+
+    // Writes taken after the backup are fetched by steady state replication after the restart.
+    assert.writeOK(coll.insert({_id: 1000, x: 1000}));
+
+    rst.start(secondary, {setParameter: {initialSyncUsesFileCopy: true}}, true /* restart */);
+    rst.awaitSecondaryNodes();
+    rst.awaitReplication();
+
+    const secondaryColl = rst.nodes[1].getDB("test").getCollection("coll");
+    assert.eq(1001, secondaryColl.find().itcount());
+    assert.eq(2, secondaryColl.getIndexes().length);
+
+    rst.stopSet();
+})();
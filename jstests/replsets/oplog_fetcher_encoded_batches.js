@@ -0,0 +1,66 @@
+/**
+ * Tests that a secondary with 'oplogFetcherEncodesBatches' enabled replicates correctly from
+ * batches returned in the compact oplog batch encoding, and reports the compression it saw. Runs
+ * both with getMores sent per batch and with the sync source streaming the batches
+ * ('oplogFetcherUsesExhaust').
+ */
+(function() {
+    "use strict";
+
+    function runTest(useExhaust) {
+        jsTestLog("Testing encoded oplog batches with oplogFetcherUsesExhaust: " + useExhaust);
+
+        const rst = new ReplSetTest({
+            name: "oplog_fetcher_encoded_batches",
+            nodes: [
+                {},
+                {
+                  rsConfig: {priority: 0},
+                  setParameter:
+                      {oplogFetcherEncodesBatches: true, oplogFetcherUsesExhaust: useExhaust}
+                }
+            ],
+        });
+        rst.startSet();
+        rst.initiate();
+
+        const primary = rst.getPrimary();
+        const secondary = rst.getSecondary();
+        const testColl = primary.getDB("test").getCollection("coll");
+
+        const numDocs = 1000;
+        let bulk = testColl.initializeUnorderedBulkOp();
+        for (let i = 0; i < numDocs; ++i) {
+            bulk.insert(
+                {_id: i, fieldOne: i, fieldTwo: "value" + i, nested: {fieldThree: [i, i]}});
+        }
+        assert.writeOK(bulk.execute());
+
+        bulk = testColl.initializeUnorderedBulkOp();
+        for (let i = 0; i < numDocs; ++i) {
+            bulk.find({_id: i}).updateOne({$inc: {fieldOne: 1}, $set: {"nested.fieldFour": i}});
+        }
+        assert.writeOK(bulk.execute());
+        rst.awaitReplication();
+
+        const secondaryColl = secondary.getDB("test").getCollection("coll");
+        assert.eq(numDocs, secondaryColl.find().itcount());
+        assert.eq(numDocs, secondaryColl.find({"nested.fieldFour": {$exists: true}}).itcount());
+        rst.checkReplicatedDataHashes();
+
+        const network = secondary.adminCommand({serverStatus: 1}).metrics.repl.network;
+        const stats = network.encodedBatches;
+        jsTestLog("Encoded oplog batch stats: " + tojson(stats));
+        assert.gt(stats.num, 0, tojson(stats));
+        assert.gt(stats.rawBytes, stats.encodedBytes, tojson(stats));
+        assert.gt(stats.compressionRatio, 1, tojson(stats));
+        if (useExhaust) {
+            assert.gt(network.streamedBatches, 0, tojson(network));
+        }
+
+        rst.stopSet();
+    }
+
+    runTest(false);
+    runTest(true);
+})();
@@ -0,0 +1,91 @@
+/**
+ * Tests that reads on a secondary are not held up by batch application when
+ * allowSecondaryReadsDuringBatchApplication is on. A failpoint holds a batch before completion,
+ * with the PBWM lock held and the last applied timestamp not yet advanced. Reads issued in the
+ * meantime must finish within their time limit and return the data as of the last applied
+ * timestamp, without any of the writes from the held batch.
+ */
+(function() {
+    "use strict";
+
+    load('jstests/replsets/libs/secondary_reads_test.js');
+
+    const name = "secondaryReadsLatencyDuringBatchApplication";
+    const collName = "testColl";
+    const numDocs = 100;
+    const numReads = 50;
+    // A read that had to wait for the held batch would run into this limit.
+    const readTimeLimitMillis = 10 * 1000;
+
+    let secondaryReadsTest = new SecondaryReadsTest(name);
+    let replSet = secondaryReadsTest.getReplset();
+    let primaryDB = secondaryReadsTest.getPrimaryDB();
+    let secondaryDB = secondaryReadsTest.getSecondaryDB();
+
+    if (!primaryDB.serverStatus().storageEngine.supportsSnapshotReadConcern) {
+        secondaryReadsTest.stop();
+        return;
+    }
+
+    assert.commandWorked(secondaryDB.adminCommand(
+        {setParameter: 1, allowSecondaryReadsDuringBatchApplication: true}));
+
+    let primaryColl = primaryDB.getCollection(collName);
+    let bulk = primaryColl.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, x: 0});
+    }
+    assert.writeOK(bulk.execute());
+    replSet.awaitReplication();
+
+    function getLastApplied() {
+        let status = assert.commandWorked(secondaryDB.adminCommand({replSetGetStatus: 1}));
+        return status.optimes.appliedOpTime.ts;
+    }
+
+    // Hold the next batch on the secondary before it completes.
+    let pauseAwait = secondaryReadsTest.pauseSecondaryBatchApplication();
+    assert.writeOK(primaryColl.update({}, {$set: {x: 1}}, {multi: true}));
+    const batchTimestamp = primaryDB.getSiblingDB("local")
+                               .oplog.rs.find()
+                               .sort({$natural: -1})
+                               .limit(1)
+                               .next()
+                               .ts;
+    pauseAwait();
+
+    // The last applied timestamp stays behind the held batch.
+    const lastApplied = getLastApplied();
+    assert.lt(timestampCmp(lastApplied, batchTimestamp), 0);
+
+    for (let i = 0; i < numReads; i++) {
+        const start = Date.now();
+        let res = assert.commandWorked(secondaryDB.runCommand({
+            find: collName,
+            filter: {_id: i % numDocs},
+            readConcern: {level: "local"},
+            maxTimeMS: readTimeLimitMillis
+        }));
+        const elapsedMillis = Date.now() - start;
+        assert.lt(elapsedMillis, readTimeLimitMillis, tojson(res));
+
+        // The read sees the document as of the last applied timestamp.
+        assert.eq([{_id: i % numDocs, x: 0}], res.cursor.firstBatch, tojson(res));
+    }
+
+    let res = assert.commandWorked(secondaryDB.runCommand({
+        count: collName,
+        query: {x: 1},
+        readConcern: {level: "local"},
+        maxTimeMS: readTimeLimitMillis
+    }));
+    assert.eq(0, res.n, "read saw writes from the held batch: " + tojson(res));
+    assert.eq(0, timestampCmp(lastApplied, getLastApplied()));
+
+    secondaryReadsTest.resumeSecondaryBatchApplication();
+    replSet.awaitReplication();
+
+    assert.eq(numDocs, secondaryDB.getCollection(collName).find({x: 1}).itcount());
+
+    secondaryReadsTest.stop();
+})();
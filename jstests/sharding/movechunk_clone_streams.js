@@ -0,0 +1,52 @@
+//
+// Tests that a chunk is cloned correctly when the donor splits it into several clone streams, and
+// that the changelog entry for moveChunk.to contains the clone throughput.
+//
+
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({
+        mongos: 1,
+        shards: 2,
+        other: {shardOptions: {setParameter: {migrationCloneStreams: 4}}}
+    });
+    var kDbName = 'db';
+
+    var mongos = st.s0;
+    var shard0 = st.shard0.shardName;
+    var shard1 = st.shard1.shardName;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: kDbName}));
+    st.ensurePrimaryShard(kDbName, shard0);
+
+    var ns = kDbName + '.foo';
+    assert.commandWorked(mongos.adminCommand({shardCollection: ns, key: {x: 1}}));
+
+    // Several thousand documents, some of them sharing a shard key value, so that the chunk is
+    // split into multiple streams
+    var coll = mongos.getDB(kDbName).foo;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 10000; i++) {
+        bulk.insert({_id: i, x: Math.floor(i / 3), padding: 'x'.repeat(100)});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(mongos.adminCommand({moveChunk: ns, find: {x: 0}, to: shard1}));
+
+    assert.eq(10000, coll.find().itcount());
+    assert.eq(10000, st.shard1.getDB(kDbName).foo.find().itcount());
+    assert.eq(0, st.shard0.getDB(kDbName).foo.find().itcount());
+
+    var changeLog = st.s.getDB('config').changelog.find({what: 'moveChunk.to', ns: ns}).toArray();
+    assert.eq(1, changeLog.length, tojson(changeLog));
+
+    var details = changeLog[0].details;
+    assert.eq(4, details.cloneStreams, tojson(details));
+    assert.eq(10000, details.clonedDocs, tojson(details));
+    assert.gt(details.clonedBytes, 0, tojson(details));
+    assert(details.hasOwnProperty('clonedDocsPerSec'), tojson(details));
+    assert(details.hasOwnProperty('clonedBytesPerSec'), tojson(details));
+
+    st.stop();
+})();
@@ -57,6 +57,7 @@ const char* kNamespaceFieldName = "ns";
 
 const char* kFirstBatchFieldName = "firstBatch";
 const char* kNextBatchFieldName = "nextBatch";
+const char* kEncodedBatchFieldName = "encodedBatch";
 
 /**
  * Parses cursor response in command result for cursor ID, namespace and documents.
@@ -161,6 +162,17 @@ Status parseCursorResponse(const BSONObj& obj,
         doc.shareOwnershipWith(obj);
     }
 
+    BSONElement encodedBatchElement = cursorObj.getField(kEncodedBatchFieldName);
+    if (!encodedBatchElement.eoo()) {
+        if (encodedBatchElement.type() != BinData) {
+            return Status(ErrorCodes::FailedToParse,
+                          str::stream() << "'" << kCursorFieldName << "." << kEncodedBatchFieldName
+                                        << "' field must be binary data: "
+                                        << obj);
+        }
+        batchData->otherFields.encodedBatch = encodedBatchElement.wrap();
+    }
+
     return Status::OK();
 }
 
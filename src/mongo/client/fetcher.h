@@ -68,6 +68,9 @@ public:
         Documents documents;
         struct OtherFields {
             BSONObj metadata;
+            // Holds the cursor's "encodedBatch" BinData element, if the remote returned its batch
+            // in the compact oplog batch encoding. Empty otherwise.
+            BSONObj encodedBatch;
         } otherFields;
         Milliseconds elapsedMillis = Milliseconds(0);
         bool first = false;
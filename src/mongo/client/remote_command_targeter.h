@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <set>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/time_support.h"
@@ -92,6 +94,16 @@ public:
         return findHostWithMaxWait(readPref, Milliseconds::zero());
     }
 
+    /**
+     * Finds a host matching the given read preference which is not one of 'excludedHosts', using
+     * only the targeter's current view of the hosts. Never blocks or engages in networking calls.
+     *
+     * Used to pick a second host to which an idempotent read can be hedged. Returns
+     * FailedToSatisfyReadPreference if no other host is eligible.
+     */
+    virtual StatusWith<HostAndPort> findAlternateHostNoWait(
+        const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) = 0;
+
     /**
      * Reports to the targeter that a 'status' indicating a not master error was received when
      * communicating with 'host', and so it should update its bookkeeping to avoid giving out the
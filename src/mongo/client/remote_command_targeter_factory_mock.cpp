@@ -57,6 +57,12 @@ public:
         return _mock->findHostWithMaxWait(readPref, maxWait);
     }
 
+    StatusWith<HostAndPort> findAlternateHostNoWait(
+        const ReadPreferenceSetting& readPref,
+        const std::set<HostAndPort>& excludedHosts) override {
+        return _mock->findAlternateHostNoWait(readPref, excludedHosts);
+    }
+
     void markHostNotMaster(const HostAndPort& host, const Status& status) override {
         _mock->markHostNotMaster(host, status);
     }
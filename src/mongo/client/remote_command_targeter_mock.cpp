@@ -36,7 +36,9 @@
 namespace mongo {
 
 RemoteCommandTargeterMock::RemoteCommandTargeterMock()
-    : _findHostReturnValue(Status(ErrorCodes::InternalError, "No return value set")) {}
+    : _findHostReturnValue(Status(ErrorCodes::InternalError, "No return value set")),
+      _findAlternateHostReturnValue(
+          Status(ErrorCodes::FailedToSatisfyReadPreference, "No alternate host set")) {}
 
 RemoteCommandTargeterMock::~RemoteCommandTargeterMock() = default;
 
@@ -63,6 +65,11 @@ StatusWith<HostAndPort> RemoteCommandTargeterMock::findHostWithMaxWait(
     return _findHostReturnValue;
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterMock::findAlternateHostNoWait(
+    const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) {
+    return _findAlternateHostReturnValue;
+}
+
 void RemoteCommandTargeterMock::markHostNotMaster(const HostAndPort& host, const Status& status) {}
 
 void RemoteCommandTargeterMock::markHostUnreachable(const HostAndPort& host, const Status& status) {
@@ -76,4 +83,9 @@ void RemoteCommandTargeterMock::setFindHostReturnValue(StatusWith<HostAndPort> r
     _findHostReturnValue = std::move(returnValue);
 }
 
+void RemoteCommandTargeterMock::setFindAlternateHostReturnValue(
+    StatusWith<HostAndPort> returnValue) {
+    _findAlternateHostReturnValue = std::move(returnValue);
+}
+
 }  // namespace mongo
@@ -60,6 +60,14 @@ public:
     StatusWith<HostAndPort> findHost(OperationContext* opCtx,
                                      const ReadPreferenceSetting& readPref) override;
 
+    /**
+     * Returns the return value last set by setFindAlternateHostReturnValue.
+     * Returns ErrorCodes::FailedToSatisfyReadPreference if setFindAlternateHostReturnValue was
+     * never called.
+     */
+    StatusWith<HostAndPort> findAlternateHostNoWait(
+        const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) override;
+
     /**
      * No-op for the mock.
      */
@@ -80,9 +88,15 @@ public:
      */
     void setFindHostReturnValue(StatusWith<HostAndPort> returnValue);
 
+    /**
+     * Sets the return value for the next call to findAlternateHostNoWait.
+     */
+    void setFindAlternateHostReturnValue(StatusWith<HostAndPort> returnValue);
+
 private:
     ConnectionString _connectionStringReturnValue;
     StatusWith<HostAndPort> _findHostReturnValue;
+    StatusWith<HostAndPort> _findAlternateHostReturnValue;
 };
 
 }  // namespace mongo
@@ -65,6 +65,11 @@ StatusWith<HostAndPort> RemoteCommandTargeterRS::findHostWithMaxWait(
     return _rsMonitor->getHostOrRefresh(readPref, maxWait);
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterRS::findAlternateHostNoWait(
+    const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) {
+    return _rsMonitor->getAlternateHost(readPref, excludedHosts);
+}
+
 StatusWith<HostAndPort> RemoteCommandTargeterRS::findHost(OperationContext* opCtx,
                                                           const ReadPreferenceSetting& readPref) {
     auto clock = opCtx->getServiceContext()->getFastClockSource();
@@ -32,6 +32,7 @@
 #include "mongo/client/remote_command_targeter_standalone.h"
 
 #include "mongo/base/status_with.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -47,6 +48,16 @@ StatusWith<HostAndPort> RemoteCommandTargeterStandalone::findHostWithMaxWait(
     return _hostAndPort;
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterStandalone::findAlternateHostNoWait(
+    const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) {
+    if (excludedHosts.count(_hostAndPort)) {
+        return {ErrorCodes::FailedToSatisfyReadPreference,
+                str::stream() << "No host other than " << _hostAndPort.toString()
+                              << " is available"};
+    }
+    return _hostAndPort;
+}
+
 StatusWith<HostAndPort> RemoteCommandTargeterStandalone::findHost(
     OperationContext* opCtx, const ReadPreferenceSetting& readPref) {
     return _hostAndPort;
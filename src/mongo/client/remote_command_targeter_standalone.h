@@ -49,6 +49,9 @@ public:
     StatusWith<HostAndPort> findHostWithMaxWait(const ReadPreferenceSetting& readPref,
                                                 Milliseconds maxWait) override;
 
+    StatusWith<HostAndPort> findAlternateHostNoWait(
+        const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) override;
+
     void markHostNotMaster(const HostAndPort& host, const Status& status) override;
 
     void markHostUnreachable(const HostAndPort& host, const Status& status) override;
@@ -309,6 +309,26 @@ StatusWith<HostAndPort> ReplicaSetMonitor::getHostOrRefresh(const ReadPreference
                           << getName()};
 }
 
+StatusWith<HostAndPort> ReplicaSetMonitor::getAlternateHost(
+    const ReadPreferenceSetting& criteria, const std::set<HostAndPort>& excludedHosts) {
+    if (_isRemovedFromManager.load()) {
+        return {ErrorCodes::ReplicaSetMonitorRemoved,
+                str::stream() << "ReplicaSetMonitor for set " << getName() << " is removed"};
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    HostAndPort out = _state->getMatchingHost(criteria, excludedHosts);
+    if (out.empty()) {
+        return {ErrorCodes::FailedToSatisfyReadPreference,
+                str::stream() << "Could not find another host matching read preference "
+                              << criteria.toString()
+                              << " for set "
+                              << getName()};
+    }
+
+    return {std::move(out)};
+}
+
 HostAndPort ReplicaSetMonitor::getMasterOrUassert() {
     return uassertStatusOK(getHostOrRefresh(kPrimaryOnlyReadPreference));
 }
@@ -1029,33 +1049,38 @@ SetState::SetState(const MongoURI& uri)
     setUri = uri;
 }
 
-HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) const {
+HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria,
+                                      const std::set<HostAndPort>& excludedHosts) const {
     switch (criteria.pref) {
         // "Prefered" read preferences are defined in terms of other preferences
         case ReadPreference::PrimaryPreferred: {
-            HostAndPort out =
-                getMatchingHost(ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+            HostAndPort out = getMatchingHost(
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excludedHosts);
             // NOTE: the spec says we should use the primary even if tags don't match
             if (!out.empty())
                 return out;
-            return getMatchingHost(ReadPreferenceSetting(
-                ReadPreference::SecondaryOnly, criteria.tags, criteria.maxStalenessSeconds));
+            return getMatchingHost(ReadPreferenceSetting(ReadPreference::SecondaryOnly,
+                                                         criteria.tags,
+                                                         criteria.maxStalenessSeconds),
+                                   excludedHosts);
         }
 
         case ReadPreference::SecondaryPreferred: {
-            HostAndPort out = getMatchingHost(ReadPreferenceSetting(
-                ReadPreference::SecondaryOnly, criteria.tags, criteria.maxStalenessSeconds));
+            HostAndPort out = getMatchingHost(ReadPreferenceSetting(ReadPreference::SecondaryOnly,
+                                                                    criteria.tags,
+                                                                    criteria.maxStalenessSeconds),
+                                              excludedHosts);
             if (!out.empty())
                 return out;
             // NOTE: the spec says we should use the primary even if tags don't match
             return getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excludedHosts);
         }
 
         case ReadPreference::PrimaryOnly: {
             // NOTE: isMaster implies isUp
             Nodes::const_iterator it = std::find_if(nodes.begin(), nodes.end(), isMaster);
-            if (it == nodes.end())
+            if (it == nodes.end() || excludedHosts.count(it->host))
                 return HostAndPort();
             return it->host;
         }
@@ -1111,7 +1136,7 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
                 std::vector<const Node*> matchingNodes;
                 for (size_t i = 0; i < nodes.size(); i++) {
                     if (nodes[i].matches(criteria.pref) && nodes[i].matches(tag) &&
-                        matchNode(nodes[i])) {
+                        matchNode(nodes[i]) && !excludedHosts.count(nodes[i].host)) {
                         matchingNodes.push_back(&nodes[i]);
                     }
                 }
@@ -93,6 +93,17 @@ public:
     StatusWith<HostAndPort> getHostOrRefresh(const ReadPreferenceSetting& readPref,
                                              Milliseconds maxWait = kDefaultFindHostTimeout);
 
+    /**
+     * Returns a host matching the given read preference which is not one of 'excludedHosts', or
+     * an error if no such host is known. Uses only the current view of the set and never waits for
+     * or triggers a refresh, so it is cheap enough to call when choosing a host to hedge a read to.
+     *
+     * Known errors are:
+     *  FailedToSatisfyReadPreference, if no host other than the excluded ones matches.
+     */
+    StatusWith<HostAndPort> getAlternateHost(const ReadPreferenceSetting& readPref,
+                                             const std::set<HostAndPort>& excludedHosts);
+
     /**
      * Returns the host we think is the current master or uasserts.
      *
@@ -50,7 +50,8 @@ HostAndPort selectNode(const vector<Node>& nodes,
                        ReadPreference pref,
                        const TagSet& tagSet,
                        int latencyThresholdMillis,
-                       bool* isPrimarySelected) {
+                       bool* isPrimarySelected,
+                       const set<HostAndPort>& excludedHosts = {}) {
     invariant(!nodes.empty());
 
     set<HostAndPort> seeds;
@@ -61,7 +62,7 @@ HostAndPort selectNode(const vector<Node>& nodes,
     set.latencyThresholdMicros = latencyThresholdMillis * 1000;
 
     ReadPreferenceSetting criteria(pref, tagSet);
-    HostAndPort out = set.getMatchingHost(criteria);
+    HostAndPort out = set.getMatchingHost(criteria, excludedHosts);
     if (isPrimarySelected && !out.empty()) {
         Node* node = set.findNode(out);
         ASSERT(node);
@@ -298,6 +299,49 @@ TEST(ReplSetMonitorReadPref, NearestOneLocal) {
     ASSERT(!isPrimarySelected);
 }
 
+TEST(ReplSetMonitorReadPref, NearestOneLocalExcluded) {
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    nodes[0].latencyMicros = 10 * 1000;
+    nodes[1].latencyMicros = 20 * 1000;
+    nodes[2].latencyMicros = 30 * 1000;
+
+    // The latency window is computed from the closest host which is not excluded
+    bool isPrimarySelected = false;
+    HostAndPort host = selectNode(
+        nodes, mongo::ReadPreference::Nearest, tags, 3, &isPrimarySelected, {HostAndPort("a")});
+
+    ASSERT_EQUALS("b", host.host());
+    ASSERT(isPrimarySelected);
+}
+
+TEST(ReplSetMonitorReadPref, PrimaryOnlyExcluded) {
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    HostAndPort host = selectNode(
+        nodes, mongo::ReadPreference::PrimaryOnly, tags, 3, nullptr, {HostAndPort("b")});
+
+    ASSERT(host.empty());
+}
+
+TEST(ReplSetMonitorReadPref, SecPrefAllSecondariesExcluded) {
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    bool isPrimarySelected = false;
+    HostAndPort host = selectNode(nodes,
+                                  mongo::ReadPreference::SecondaryPreferred,
+                                  tags,
+                                  3,
+                                  &isPrimarySelected,
+                                  {HostAndPort("a"), HostAndPort("c")});
+
+    ASSERT_EQUALS("b", host.host());
+    ASSERT(isPrimarySelected);
+}
+
 TEST(ReplSetMonitorReadPref, PriOnlyWithTagsNoMatch) {
     vector<Node> nodes = getThreeMemberWithTags();
     TagSet tags(getP2TagSet());
@@ -224,6 +224,13 @@ public:
                                     bool noWarn,
                                     StoreDeletedDoc storeDeletedDoc) = 0;
 
+        virtual size_t deleteDocuments(OperationContext* opCtx,
+                                       const std::vector<RecordId>& locs,
+                                       OpDebug* opDebug,
+                                       bool fromMigrate,
+                                       bool noWarn,
+                                       int64_t* bytesDeletedOut) = 0;
+
         virtual Status insertDocuments(OperationContext* opCtx,
                                        std::vector<InsertStatement>::const_iterator begin,
                                        std::vector<InsertStatement>::const_iterator end,
@@ -457,6 +464,28 @@ public:
             opCtx, stmtId, loc, opDebug, fromMigrate, noWarn, storeDeletedDoc);
     }
 
+    /**
+     * Deletes the documents with the given RecordIds from the collection inside the caller's
+     * WriteUnitOfWork. Index keys are removed one index at a time for the whole batch, which
+     * touches far fewer index pages than deleting each document individually. RecordIds that no
+     * longer refer to a document are skipped.
+     *
+     * 'fromMigrate', 'opDebug' and 'noWarn' have the same meaning as for deleteDocument.
+     * 'bytesDeletedOut' Optional argument. When not null, will be set to the total size of the
+     * deleted documents.
+     *
+     * Returns the number of documents deleted.
+     */
+    inline size_t deleteDocuments(OperationContext* const opCtx,
+                                  const std::vector<RecordId>& locs,
+                                  OpDebug* const opDebug,
+                                  const bool fromMigrate = false,
+                                  const bool noWarn = false,
+                                  int64_t* const bytesDeletedOut = nullptr) {
+        return this->_impl().deleteDocuments(
+            opCtx, locs, opDebug, fromMigrate, noWarn, bytesDeletedOut);
+    }
+
     /*
      * Inserts all documents inside one WUOW.
      * Caller should ensure vector is appropriately sized for this.
@@ -578,6 +578,67 @@ void CollectionImpl::deleteDocument(OperationContext* opCtx,
         opCtx, ns(), uuid(), stmtId, fromMigrate, deletedDoc);
 }
 
+size_t CollectionImpl::deleteDocuments(OperationContext* opCtx,
+                                       const std::vector<RecordId>& locs,
+                                       OpDebug* opDebug,
+                                       bool fromMigrate,
+                                       bool noWarn,
+                                       int64_t* bytesDeletedOut) {
+    if (isCapped()) {
+        log() << "failing remove on a capped ns " << _ns;
+        uasserted(50883, "cannot remove from a capped collection");
+        return 0;
+    }
+
+    invariant(opCtx->lockState()->inAWriteUnitOfWork());
+
+    // All documents are fetched before any BsonRecord is built, so that 'docs' is not
+    // reallocated while a BsonRecord points into it.
+    std::vector<std::pair<RecordId, Snapshotted<BSONObj>>> docs;
+    docs.reserve(locs.size());
+    for (const auto& loc : locs) {
+        Snapshotted<BSONObj> doc;
+        if (findDoc(opCtx, loc, &doc)) {
+            docs.emplace_back(loc, std::move(doc));
+        }
+    }
+
+    int64_t bytesDeleted = 0;
+    std::vector<BsonRecord> bsonRecords;
+    bsonRecords.reserve(docs.size());
+    for (const auto& doc : docs) {
+        /* check if any cursors point to us.  if so, advance them. */
+        _cursorManager.invalidateDocument(opCtx, doc.first, INVALIDATION_DELETION);
+
+        bytesDeleted += doc.second.value().objsize();
+        bsonRecords.push_back({doc.first, Timestamp(), &doc.second.value()});
+    }
+
+    // As in deleteDocument, the index keys of a document are removed before its record, but here
+    // they are removed for the whole batch first, visiting each index once.
+    int64_t keysDeleted;
+    _indexCatalog.unindexRecords(opCtx, bsonRecords, noWarn, &keysDeleted);
+    if (opDebug) {
+        opDebug->keysDeleted += keysDeleted;
+    }
+
+    // aboutToDelete stashes the document key on the operation for the following onDelete, so the
+    // two must bracket the deletion of a single record. aboutToDelete only reads the document and
+    // the sharding state, neither of which the index key removal above changes.
+    auto opObserver = getGlobalServiceContext()->getOpObserver();
+    for (const auto& bsonRecord : bsonRecords) {
+        opObserver->aboutToDelete(opCtx, ns(), *bsonRecord.docPtr);
+        _recordStore->deleteRecord(opCtx, bsonRecord.id);
+        opObserver->onDelete(opCtx, ns(), uuid(), kUninitializedStmtId, fromMigrate, boost::none);
+    }
+
+    if (bytesDeletedOut) {
+        *bytesDeletedOut = bytesDeleted;
+    }
+
+    return bsonRecords.size();
+}
+
 Counter64 moveCounter;
 ServerStatusMetricField<Counter64> moveCounterDisplay("record.moves", &moveCounter);
 
@@ -152,6 +152,22 @@ public:
         bool noWarn = false,
         Collection::StoreDeletedDoc storeDeletedDoc = Collection::StoreDeletedDoc::Off) final;
 
+    /**
+     * Deletes the documents with the given RecordIds from the collection, removing index keys
+     * one index at a time for the whole batch. Must be called inside a WriteUnitOfWork.
+     *
+     * 'bytesDeletedOut' Optional argument. When not null, will be set to the total size of the
+     * deleted documents.
+     *
+     * Returns the number of documents deleted; RecordIds without a document are skipped.
+     */
+    size_t deleteDocuments(OperationContext* opCtx,
+                           const std::vector<RecordId>& locs,
+                           OpDebug* opDebug,
+                           bool fromMigrate = false,
+                           bool noWarn = false,
+                           int64_t* bytesDeletedOut = nullptr) final;
+
     /*
      * Inserts all documents inside one WUOW.
      * Caller should ensure vector is appropriately sized for this.
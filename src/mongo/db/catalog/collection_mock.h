@@ -133,6 +133,15 @@ public:
         std::abort();
     }
 
+    size_t deleteDocuments(OperationContext* opCtx,
+                           const std::vector<RecordId>& locs,
+                           OpDebug* opDebug,
+                           bool fromMigrate,
+                           bool noWarn,
+                           int64_t* bytesDeletedOut) {
+        std::abort();
+    }
+
     Status insertDocuments(OperationContext* opCtx,
                            std::vector<InsertStatement>::const_iterator begin,
                            std::vector<InsertStatement>::const_iterator end,
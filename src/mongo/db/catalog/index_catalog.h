@@ -237,6 +237,11 @@ public:
                                    bool noWarn,
                                    int64_t* keysDeletedOut) = 0;
 
+        virtual void unindexRecords(OperationContext* opCtx,
+                                    const std::vector<BsonRecord>& bsonRecords,
+                                    bool noWarn,
+                                    int64_t* keysDeletedOut) = 0;
+
         virtual std::string getAccessMethodName(OperationContext* opCtx,
                                                 const BSONObj& keyPattern) = 0;
 
@@ -527,6 +532,18 @@ public:
         return this->_impl().unindexRecord(opCtx, obj, loc, noWarn, keysDeletedOut);
     }
 
+    /**
+     * Removes the index keys of every record in 'bsonRecords', visiting each index once for the
+     * whole batch rather than once per record. When 'keysDeletedOut' is not null, it will be set
+     * to the number of index keys removed by this operation.
+     */
+    inline void unindexRecords(OperationContext* const opCtx,
+                               const std::vector<BsonRecord>& bsonRecords,
+                               const bool noWarn,
+                               int64_t* const keysDeletedOut) {
+        return this->_impl().unindexRecords(opCtx, bsonRecords, noWarn, keysDeletedOut);
+    }
+
     // ------- temp internal -------
 
     inline std::string getAccessMethodName(OperationContext* const opCtx,
@@ -1504,6 +1504,55 @@ void IndexCatalogImpl::unindexRecord(OperationContext* opCtx,
     }
 }
 
+void IndexCatalogImpl::_unindexRecords(OperationContext* opCtx,
+                                       IndexCatalogEntry* index,
+                                       const std::vector<BsonRecord>& bsonRecords,
+                                       bool logIfError,
+                                       int64_t* keysDeletedOut) {
+    InsertDeleteOptions options;
+    prepareInsertDeleteOptions(opCtx, index->descriptor(), &options);
+    options.logIfError = logIfError;
+
+    // See _unindexRecord for why blind deletes are disabled for in-progress indexes.
+    options.dupsAllowed = options.dupsAllowed || !index->isReady(opCtx);
+
+    IndexAccessMethod* const accessMethod = index->accessMethod();
+    for (const auto& bsonRecord : bsonRecords) {
+        invariant(bsonRecord.id != RecordId());
+
+        int64_t removed = 0;
+        Status status =
+            accessMethod->remove(opCtx, *bsonRecord.docPtr, bsonRecord.id, options, &removed);
+
+        if (!status.isOK()) {
+            log() << "Couldn't unindex record " << redact(*bsonRecord.docPtr)
+                  << " from collection " << _collection->ns() << ". Status: " << redact(status);
+        }
+
+        if (keysDeletedOut) {
+            *keysDeletedOut += removed;
+        }
+    }
+}
+
+void IndexCatalogImpl::unindexRecords(OperationContext* opCtx,
+                                      const std::vector<BsonRecord>& bsonRecords,
+                                      bool noWarn,
+                                      int64_t* keysDeletedOut) {
+    if (keysDeletedOut) {
+        *keysDeletedOut = 0;
+    }
+
+    for (IndexCatalogEntryContainer::const_iterator i = _entries.begin(); i != _entries.end();
+         ++i) {
+        IndexCatalogEntry* entry = i->get();
+
+        // If it's a background index, we DO NOT want to log anything.
+        bool logIfError = entry->isReady(opCtx) ? !noWarn : false;
+        _unindexRecords(opCtx, entry, bsonRecords, logIfError, keysDeletedOut);
+    }
+}
+
 BSONObj IndexCatalogImpl::fixIndexKey(const BSONObj& key) {
     if (IndexDescriptor::isIdIndexPattern(key)) {
         return _idObj;
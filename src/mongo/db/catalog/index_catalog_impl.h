@@ -351,6 +351,15 @@ public:
                        bool noWarn,
                        int64_t* keysDeletedOut) override;
 
+    /**
+     * When 'keysDeletedOut' is not null, it will be set to the number of index keys removed by
+     * this operation.
+     */
+    void unindexRecords(OperationContext* opCtx,
+                        const std::vector<BsonRecord>& bsonRecords,
+                        bool noWarn,
+                        int64_t* keysDeletedOut) override;
+
     // ------- temp internal -------
 
     inline std::string getAccessMethodName(OperationContext* opCtx,
@@ -404,6 +413,12 @@ private:
                           bool logIfError,
                           int64_t* keysDeletedOut);
 
+    void _unindexRecords(OperationContext* opCtx,
+                         IndexCatalogEntry* index,
+                         const std::vector<BsonRecord>& bsonRecords,
+                         bool logIfError,
+                         int64_t* keysDeletedOut);
+
     inline const IndexCatalogEntryContainer& _getEntries() const override {
         return this->_entries;
     }
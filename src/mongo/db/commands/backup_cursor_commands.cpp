@@ -0,0 +1,164 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/backup_cursor_service.h"
+
+namespace mongo {
+namespace {
+
+// Upper bound on the bytes returned by one _readBackupFile, which keeps replies below the maximum
+// BSON document size.
+const long long kMaxReadBackupFileBytes = 8 * 1024 * 1024;
+
+/**
+ * Base class for the commands a file copy based initial sync runs against its sync source.
+ */
+class BackupCursorCommand : public BasicCommand {
+public:
+    using BasicCommand::BasicCommand;
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool adminOnly() const final {
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::internal);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+
+protected:
+    static UUID parseBackupId(const BSONObj& cmdObj) {
+        return uassertStatusOK(UUID::parse(cmdObj["backupId"]));
+    }
+};
+
+class CmdBeginBackupCursor : public BackupCursorCommand {
+public:
+    CmdBeginBackupCursor() : BackupCursorCommand("_beginBackupCursor") {}
+
+    std::string help() const override {
+        return "{ _beginBackupCursor : 1 } INTERNAL ONLY. Pins the last checkpoint and returns "
+               "the files to copy";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        auto state = uassertStatusOK(
+            BackupCursorService::get(opCtx->getServiceContext())->openBackupCursor(opCtx));
+        state.backupId.appendToBuilder(&result, "backupId");
+        result.append("checkpointTimestamp", state.checkpointTimestamp);
+        BSONArrayBuilder filesBuilder(result.subarrayStart("files"));
+        for (auto&& file : state.files) {
+            filesBuilder.append(BSON("filename" << file.filename << "fileSize"
+                                                << static_cast<long long>(file.fileSize)));
+        }
+        return true;
+    }
+} cmdBeginBackupCursor;
+
+class CmdReadBackupFile : public BackupCursorCommand {
+public:
+    CmdReadBackupFile() : BackupCursorCommand("_readBackupFile") {}
+
+    std::string help() const override {
+        return "{ _readBackupFile : 1, backupId : <UUID>, filename : <string>, offset : <long>, "
+               "length : <long> } INTERNAL ONLY. An empty 'data' field marks the end of the file";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        auto backupId = parseBackupId(cmdObj);
+        std::string filename;
+        uassertStatusOK(bsonExtractStringField(cmdObj, "filename", &filename));
+        long long offset;
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "offset", &offset));
+        long long length;
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "length", &length));
+        uassert(ErrorCodes::BadValue,
+                "offset and length must not be negative",
+                offset >= 0 && length >= 0);
+
+        length = std::min(length, kMaxReadBackupFileBytes);
+
+        auto service = BackupCursorService::get(opCtx->getServiceContext());
+        auto data = uassertStatusOK(service->readBackupFile(
+            opCtx, backupId, filename, static_cast<std::uint64_t>(offset), length));
+        result.appendBinData("data", data.size(), BinDataGeneral, data.data());
+        return true;
+    }
+} cmdReadBackupFile;
+
+class CmdEndBackupCursor : public BackupCursorCommand {
+public:
+    CmdEndBackupCursor() : BackupCursorCommand("_endBackupCursor") {}
+
+    std::string help() const override {
+        return "{ _endBackupCursor : 1, backupId : <UUID> } INTERNAL ONLY";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        uassertStatusOK(BackupCursorService::get(opCtx->getServiceContext())
+                            ->closeBackupCursor(opCtx, parseBackupId(cmdObj)));
+        return true;
+    }
+} cmdEndBackupCursor;
+
+}  // namespace
+}  // namespace mongo
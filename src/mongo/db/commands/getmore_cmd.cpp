@@ -51,6 +51,7 @@
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_batch_encoding.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/counters.h"
@@ -514,12 +515,21 @@ public:
         // an interrupt point, we just continue as normal and return rather than reporting a
         // timeout to the user.
         BSONObj obj;
+
+        // Oplog fetchers may ask for the batch in the compact oplog batch encoding. The batch is
+        // still bounded by the size the documents would take in a regular reply.
+        boost::optional<repl::OplogBatchEncoder> encoder;
+        if (request.encodeOplogBatch) {
+            encoder.emplace();
+        }
+
         try {
             while (!FindCommon::enoughForGetMore(request.batchSize.value_or(0), *numResults) &&
                    PlanExecutor::ADVANCED == (*state = exec->getNext(&obj, NULL))) {
                 // If adding this object will cause us to exceed the message size limit, then we
                 // stash it for later.
-                if (!FindCommon::haveSpaceForNext(obj, *numResults, nextBatch->bytesUsed())) {
+                const auto bytesUsed = encoder ? encoder->rawBytes() : nextBatch->bytesUsed();
+                if (!FindCommon::haveSpaceForNext(obj, *numResults, bytesUsed)) {
                     exec->enqueue(obj);
                     break;
                 }
@@ -528,7 +538,11 @@ public:
                 awaitDataState(opCtx).shouldWaitForInserts = false;
                 // Add result to output buffer.
                 nextBatch->setLatestOplogTimestamp(exec->getLatestOplogTimestamp());
-                nextBatch->append(obj);
+                if (encoder) {
+                    encoder->append(obj);
+                } else {
+                    nextBatch->append(obj);
+                }
                 (*numResults)++;
             }
         } catch (const ExceptionFor<ErrorCodes::CloseChangeStream>&) {
@@ -537,6 +551,10 @@ public:
             return Status::OK();
         }
 
+        if (encoder && encoder->count()) {
+            nextBatch->setEncodedBatch(encoder->done());
+        }
+
         switch (*state) {
             case PlanExecutor::FAILURE:
                 // Log an error message and then perform the same cleanup as DEAD.
@@ -99,6 +99,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database_and_check_version.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
+#include "mongo/db/repl/file_copy_initial_syncer.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_consistency_markers_impl.h"
@@ -339,6 +340,13 @@ ExitCode _initAndListen(int listenPort) {
         serviceContext->setTransportLayer(std::move(tl));
     }
 
+    // A file copy based initial sync that completed before the last shutdown leaves the sync
+    // source's files staged in the dbpath; they must replace ours before the storage engine opens.
+    if (!storageGlobalParams.readOnly) {
+        uassertStatusOK(
+            repl::FileCopyInitialSyncer::installStagedFiles(storageGlobalParams.dbpath));
+    }
+
     initializeStorageEngine(serviceContext, StorageEngineInitFlags::kNone);
 
 #ifdef MONGO_CONFIG_WIREDTIGER_ENABLED
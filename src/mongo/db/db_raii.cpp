@@ -39,6 +39,7 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/db/storage/snapshot_manager.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -46,6 +47,20 @@ namespace {
 
 const boost::optional<int> kDoNotChangeProfilingLevel = boost::none;
 
+/**
+ * Returns the timestamp that reads with ReadSource::kLastApplied are served at: the local snapshot
+ * the replication system publishes to the storage engine at the end of each batch. Reading it does
+ * not take the ReplicationCoordinator mutex, so secondary readers do not contend with batch
+ * application and position updates for it. A null timestamp means reads are not timestamped yet.
+ */
+Timestamp getLastAppliedReadTimestamp(OperationContext* opCtx) {
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    if (auto snapshotManager = storageEngine->getSnapshotManager()) {
+        return snapshotManager->getLocalSnapshot().value_or(Timestamp());
+    }
+    return repl::ReplicationCoordinator::get(opCtx)->getMyLastAppliedOpTime().getTimestamp();
+}
+
 }  // namespace
 
 // If true, do not take the PBWM lock in AutoGetCollectionForRead on secondaries during batch
@@ -134,7 +149,7 @@ AutoGetCollectionForRead::AutoGetCollectionForRead(OperationContext* opCtx,
         // because it is set asynchonously. This is not problematic because holding the collection
         // lock guarantees no metadata changes will occur in that time.
         auto lastAppliedTimestamp = readAtLastAppliedTimestamp
-            ? boost::optional<Timestamp>(replCoord->getMyLastAppliedOpTime().getTimestamp())
+            ? boost::optional<Timestamp>(getLastAppliedReadTimestamp(opCtx))
             : boost::none;
 
         auto minSnapshot = coll->getMinimumVisibleSnapshot();
@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bson_validate.h"
 #include "mongo/client/constants.h"
@@ -446,6 +448,10 @@ Message makeGetMoreMessage(StringData ns, long long cursorId, int nToReturn, int
 struct DbResponse {
     Message response;       // If empty, nothing will be returned to the client.
     std::string exhaustNS;  // Namespace of cursor if exhaust mode, else "".
+
+    // Request to run once 'response' is sent, without waiting for the client, for OP_MSG exhaust
+    // cursors. Its reply is sent as the next reply to the client's original request.
+    boost::optional<Message> nextInvocation;
 };
 
 /**
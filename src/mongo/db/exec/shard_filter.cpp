@@ -35,6 +35,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/s/chunk_load_statistics.h"
 #include "mongo/db/s/metadata_manager.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/memory.h"
@@ -111,6 +112,14 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
                 ++_specificStats.chunkSkips;
                 return PlanStage::NEED_TIME;
             }
+
+            if (ChunkLoadStatistics::shouldSample()) {
+                ChunkLoadStatistics::get(getOpCtx())
+                    .record(*_metadata.getMetadata(),
+                            shardKey,
+                            member->hasObj() ? member->obj.value().objsize() : 0,
+                            Date_t::now());
+            }
         }
 
         // If we're here either we have shard state and our doc passed, or we have no shard
@@ -207,6 +207,11 @@ std::unique_ptr<SortedDataInterface::Cursor> IndexAccessMethod::newRandomCursor(
     return _newInterface->newRandomCursor(opCtx);
 }
 
+std::unique_ptr<SortedDataInterface::Cursor> IndexAccessMethod::newSamplingCursor(
+    OperationContext* opCtx, long long numSamples) const {
+    return _newInterface->newSamplingCursor(opCtx, numSamples);
+}
+
 // Remove the provided doc from the index.
 Status IndexAccessMethod::remove(OperationContext* opCtx,
                                  const BSONObj& obj,
@@ -138,6 +138,12 @@ public:
      */
     std::unique_ptr<SortedDataInterface::Cursor> newRandomCursor(OperationContext* opCtx) const;
 
+    /**
+     * Returns a pseudo-random cursor over 'this' index for drawing about 'numSamples' entries.
+     */
+    std::unique_ptr<SortedDataInterface::Cursor> newSamplingCursor(OperationContext* opCtx,
+                                                                   long long numSamples) const;
+
     // ------ index level operations ------
 
 
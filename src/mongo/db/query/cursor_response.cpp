@@ -44,6 +44,7 @@ const char kIdField[] = "id";
 const char kNsField[] = "ns";
 const char kBatchField[] = "nextBatch";
 const char kBatchFieldInitial[] = "firstBatch";
+const char kEncodedBatchField[] = "encodedBatch";
 const char kInternalLatestOplogTimestampField[] = "$_internalLatestOplogTimestamp";
 
 }  // namespace
@@ -58,6 +59,10 @@ CursorResponseBuilder::CursorResponseBuilder(bool isInitialResponse,
 void CursorResponseBuilder::done(CursorId cursorId, StringData cursorNamespace) {
     invariant(_active);
     _batch.doneFast();
+    if (!_encodedBatch.empty()) {
+        _cursorObject.appendBinData(
+            kEncodedBatchField, _encodedBatch.size(), BinDataGeneral, _encodedBatch.data());
+    }
     _cursorObject.append(kIdField, cursorId);
     _cursorObject.append(kNsField, cursorNamespace);
     _cursorObject.doneFast();
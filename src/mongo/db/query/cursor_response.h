@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
@@ -80,6 +81,15 @@ public:
         return _numDocs;
     }
 
+    /**
+     * Attaches a batch of documents encoded by repl::OplogBatchEncoder. It is returned in the
+     * cursor object under "encodedBatch", alongside the (then normally empty) batch array.
+     */
+    void setEncodedBatch(std::string encodedBatch) {
+        invariant(_active);
+        _encodedBatch = std::move(encodedBatch);
+    }
+
     /**
      * Call this after successfully appending all fields that will be part of this response.
      * After calling, you may not call any more methods on this object.
@@ -101,6 +111,7 @@ private:
     BSONArrayBuilder _batch;
     long long _numDocs = 0;
     Timestamp _latestOplogTimestamp;
+    std::string _encodedBatch;
 };
 
 /**
@@ -50,25 +50,28 @@ const char kBatchSizeField[] = "batchSize";
 const char kAwaitDataTimeoutField[] = "maxTimeMS";
 const char kTermField[] = "term";
 const char kLastKnownCommittedOpTimeField[] = "lastKnownCommittedOpTime";
+const char kEncodeOplogBatchField[] = "$_encodeOplogBatch";
 
 }  // namespace
 
 const char GetMoreRequest::kGetMoreCommandName[] = "getMore";
 
-GetMoreRequest::GetMoreRequest() : cursorid(0), batchSize(0) {}
+GetMoreRequest::GetMoreRequest() : cursorid(0), batchSize(0), encodeOplogBatch(false) {}
 
 GetMoreRequest::GetMoreRequest(NamespaceString namespaceString,
                                CursorId id,
                                boost::optional<std::int64_t> sizeOfBatch,
                                boost::optional<Milliseconds> awaitDataTimeout,
                                boost::optional<long long> term,
-                               boost::optional<repl::OpTime> lastKnownCommittedOpTime)
+                               boost::optional<repl::OpTime> lastKnownCommittedOpTime,
+                               bool encodeOplogBatch)
     : nss(std::move(namespaceString)),
       cursorid(id),
       batchSize(sizeOfBatch),
       awaitDataTimeout(awaitDataTimeout),
       term(term),
-      lastKnownCommittedOpTime(lastKnownCommittedOpTime) {}
+      lastKnownCommittedOpTime(lastKnownCommittedOpTime),
+      encodeOplogBatch(encodeOplogBatch) {}
 
 Status GetMoreRequest::isValid() const {
     if (!nss.isValid()) {
@@ -87,6 +90,13 @@ Status GetMoreRequest::isValid() const {
                                     << *batchSize);
     }
 
+    if (encodeOplogBatch && !nss.isOplog()) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "Field '" << kEncodeOplogBatchField
+                                    << "' is only supported on the oplog, not on: "
+                                    << nss.ns());
+    }
+
     return Status::OK();
 }
 
@@ -112,6 +122,7 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
     boost::optional<Milliseconds> awaitDataTimeout;
     boost::optional<long long> term;
     boost::optional<repl::OpTime> lastKnownCommittedOpTime;
+    bool encodeOplogBatch = false;
 
     for (BSONElement el : cmdObj) {
         const auto fieldName = el.fieldNameStringData();
@@ -159,6 +170,14 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
                 return status;
             }
             lastKnownCommittedOpTime = ot;
+        } else if (fieldName == kEncodeOplogBatchField) {
+            if (el.type() != BSONType::Bool) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << "Field '" << kEncodeOplogBatchField
+                                      << "' must be of type bool in: "
+                                      << cmdObj};
+            }
+            encodeOplogBatch = el.boolean();
         } else if (!isGenericArgument(fieldName)) {
             return {ErrorCodes::FailedToParse,
                     str::stream() << "Failed to parse: " << cmdObj << ". "
@@ -178,8 +197,13 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
                 str::stream() << "Field 'collection' missing in: " << cmdObj};
     }
 
-    GetMoreRequest request(
-        std::move(*nss), *cursorid, batchSize, awaitDataTimeout, term, lastKnownCommittedOpTime);
+    GetMoreRequest request(std::move(*nss),
+                           *cursorid,
+                           batchSize,
+                           awaitDataTimeout,
+                           term,
+                           lastKnownCommittedOpTime,
+                           encodeOplogBatch);
     Status validStatus = request.isValid();
     if (!validStatus.isOK()) {
         return validStatus;
@@ -210,6 +234,10 @@ BSONObj GetMoreRequest::toBSON() const {
         lastKnownCommittedOpTime->append(&builder, kLastKnownCommittedOpTimeField);
     }
 
+    if (encodeOplogBatch) {
+        builder.append(kEncodeOplogBatchField, true);
+    }
+
     return builder.obj();
 }
 
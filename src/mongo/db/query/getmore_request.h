@@ -55,7 +55,8 @@ struct GetMoreRequest {
                    boost::optional<std::int64_t> sizeOfBatch,
                    boost::optional<Milliseconds> awaitDataTimeout,
                    boost::optional<long long> term,
-                   boost::optional<repl::OpTime> lastKnownCommittedOpTime);
+                   boost::optional<repl::OpTime> lastKnownCommittedOpTime,
+                   bool encodeOplogBatch = false);
 
     /**
      * Construct a GetMoreRequest from the command specification and db name.
@@ -87,6 +88,10 @@ struct GetMoreRequest {
     // Only internal queries from replication will have a last known committed optime.
     const boost::optional<repl::OpTime> lastKnownCommittedOpTime;
 
+    // Set by oplog fetchers that want the batch returned in the compact encoding produced by
+    // repl::OplogBatchEncoder rather than as an array of documents. Only valid on the oplog.
+    const bool encodeOplogBatch;
+
 private:
     /**
      * Returns a non-OK status if there are semantic errors in the parsed request
@@ -209,6 +209,37 @@ TEST(GetMoreRequestTest, parseFromBSONHasMaxTimeMSOfZero) {
     ASSERT(!result.getValue().awaitDataTimeout);
 }
 
+TEST(GetMoreRequestTest, parseFromBSONEncodeOplogBatch) {
+    StatusWith<GetMoreRequest> result =
+        GetMoreRequest::parseFromBSON("local",
+                                      BSON("getMore" << CursorId(123) << "collection"
+                                                     << "oplog.rs"
+                                                     << "$_encodeOplogBatch"
+                                                     << true));
+    ASSERT_OK(result.getStatus());
+    ASSERT_TRUE(result.getValue().encodeOplogBatch);
+}
+
+TEST(GetMoreRequestTest, parseFromBSONEncodeOplogBatchRequiresOplog) {
+    StatusWith<GetMoreRequest> result =
+        GetMoreRequest::parseFromBSON("db",
+                                      BSON("getMore" << CursorId(123) << "collection"
+                                                     << "coll"
+                                                     << "$_encodeOplogBatch"
+                                                     << true));
+    ASSERT_EQUALS(ErrorCodes::BadValue, result.getStatus().code());
+}
+
+TEST(GetMoreRequestTest, parseFromBSONEncodeOplogBatchWrongType) {
+    StatusWith<GetMoreRequest> result =
+        GetMoreRequest::parseFromBSON("local",
+                                      BSON("getMore" << CursorId(123) << "collection"
+                                                     << "oplog.rs"
+                                                     << "$_encodeOplogBatch"
+                                                     << 1));
+    ASSERT_EQUALS(ErrorCodes::TypeMismatch, result.getStatus().code());
+}
+
 TEST(GetMoreRequestTest, toBSONHasBatchSize) {
     GetMoreRequest request(
         NamespaceString("testdb.testcoll"), 123, 99, boost::none, boost::none, boost::none);
@@ -280,4 +311,20 @@ TEST(GetMoreRequestTest, toBSONHasMaxTimeMS) {
     ASSERT_BSONOBJ_EQ(requestObj, expectedRequest);
 }
 
+TEST(GetMoreRequestTest, toBSONHasEncodeOplogBatch) {
+    GetMoreRequest request(NamespaceString("local.oplog.rs"),
+                           123,
+                           boost::none,
+                           boost::none,
+                           boost::none,
+                           boost::none,
+                           true);
+    BSONObj requestObj = request.toBSON();
+    BSONObj expectedRequest = BSON("getMore" << CursorId(123) << "collection"
+                                             << "oplog.rs"
+                                             << "$_encodeOplogBatch"
+                                             << true);
+    ASSERT_BSONOBJ_EQ(requestObj, expectedRequest);
+}
+
 }  // namespace
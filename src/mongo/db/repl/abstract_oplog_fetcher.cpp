@@ -36,6 +36,7 @@
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_batch_encoding.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
@@ -61,6 +62,26 @@ const Milliseconds kNetworkTimeoutBufferMS{5000};
 // Default `maxTimeMS` timeout for `getMore`s.
 const Milliseconds kDefaultOplogGetMoreMaxMS{5000};
 
+/**
+ * Fills 'decoded' with a copy of 'queryResponse' whose documents include those carried in its
+ * encoded oplog batch.
+ */
+Status decodeEncodedBatch(const Fetcher::QueryResponse& queryResponse,
+                          Fetcher::QueryResponse* decoded) {
+    int len = 0;
+    const char* data = queryResponse.otherFields.encodedBatch.firstElement().binData(len);
+    auto docs = decodeOplogBatch(ConstDataRange(data, len));
+    if (!docs.isOK()) {
+        return docs.getStatus();
+    }
+
+    *decoded = queryResponse;
+    decoded->otherFields.encodedBatch = BSONObj();
+    decoded->documents.insert(decoded->documents.end(),
+                              std::make_move_iterator(docs.getValue().begin()),
+                              std::make_move_iterator(docs.getValue().end()));
+    return Status::OK();
+}
 
 }  // namespace
 
@@ -105,6 +126,14 @@ Milliseconds AbstractOplogFetcher::_getGetMoreMaxTime() const {
     return kDefaultOplogGetMoreMaxMS;
 }
 
+OplogStreamReader::ConnectFn AbstractOplogFetcher::_makeStreamConnectFn() const {
+    return {};
+}
+
+bool AbstractOplogFetcher::_adjustQueryAfterError(const Status& status) {
+    return false;
+}
+
 std::string AbstractOplogFetcher::toString() const {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
     str::stream msg;
@@ -115,6 +144,9 @@ std::string AbstractOplogFetcher::toString() const {
     if (_fetcher) {
         msg << " fetcher: " << _fetcher->getDiagnosticString();
     }
+    if (_streamReader) {
+        msg << " stream reader: " << _streamReader->toString();
+    }
     return msg;
 }
 
@@ -129,11 +161,25 @@ void AbstractOplogFetcher::_makeAndScheduleFetcherCallback(
     BSONObj findCommandObj = _makeFindCommandObject(_nss, _getLastOpTimeWithHashFetched().opTime);
     BSONObj metadataObj = _makeMetadataObject();
 
+    auto streamConnectFn = _makeStreamConnectFn();
     Status scheduleStatus = Status::OK();
     {
         stdx::lock_guard<stdx::mutex> lock(_mutex);
-        _fetcher = _makeFetcher(findCommandObj, metadataObj);
-        scheduleStatus = _scheduleFetcher_inlock();
+        if (streamConnectFn) {
+            _streamReader = stdx::make_unique<OplogStreamReader>(
+                std::move(streamConnectFn),
+                _nss.db().toString(),
+                findCommandObj,
+                metadataObj,
+                [this](const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob) {
+                    _onStreamBatch(result, getMoreBob);
+                });
+            readersCreatedStats.increment();
+            _streamReader->startup();
+        } else {
+            _fetcher = _makeFetcher(findCommandObj, metadataObj);
+            scheduleStatus = _scheduleFetcher_inlock();
+        }
     }
     if (!scheduleStatus.isOK()) {
         _finishCallback(scheduleStatus);
@@ -155,6 +201,9 @@ void AbstractOplogFetcher::_doShutdown_inlock() noexcept {
     if (_fetcher) {
         _fetcher->shutdown();
     }
+    if (_streamReader) {
+        _streamReader->shutdown();
+    }
 }
 
 stdx::mutex* AbstractOplogFetcher::_getMutex() noexcept {
@@ -206,19 +255,22 @@ void AbstractOplogFetcher::_callback(const Fetcher::QueryResponseStatus& result,
     // If target cut connections between connecting and querying (for
     // example, because it stepped down) we might not have a cursor.
     if (!responseStatus.isOK()) {
+        const bool queryAdjusted = _adjustQueryAfterError(responseStatus);
         BSONObj findCommandObj =
             _makeFindCommandObject(_nss, _getLastOpTimeWithHashFetched().opTime);
         BSONObj metadataObj = _makeMetadataObject();
         {
             stdx::lock_guard<stdx::mutex> lock(_mutex);
-            if (_fetcherRestarts == _maxFetcherRestarts) {
+            if (!queryAdjusted && _fetcherRestarts == _maxFetcherRestarts) {
                 log() << "Error returned from oplog query (no more query restarts left): "
                       << redact(responseStatus);
             } else {
                 log() << "Restarting oplog query due to error: " << redact(responseStatus)
                       << ". Last fetched optime (with hash): " << _lastFetched
                       << ". Restarts remaining: " << (_maxFetcherRestarts - _fetcherRestarts);
-                _fetcherRestarts++;
+                if (!queryAdjusted) {
+                    _fetcherRestarts++;
+                }
                 // Destroying current instance in _shuttingDownFetcher will possibly block.
                 _shuttingDownFetcher.reset();
                 // Move the old fetcher into the shutting down instance.
@@ -251,8 +303,23 @@ void AbstractOplogFetcher::_callback(const Fetcher::QueryResponseStatus& result,
         return;
     }
 
+    // Batches returned in the compact oplog batch encoding are decoded here so that subclasses
+    // only ever see plain oplog entries.
+    const auto* queryResponsePtr = &result.getValue();
+    Fetcher::QueryResponse decodedResponse;
+    if (!queryResponsePtr->otherFields.encodedBatch.isEmpty()) {
+        auto decodeStatus = decodeEncodedBatch(*queryResponsePtr, &decodedResponse);
+        if (!decodeStatus.isOK()) {
+            error() << "invalid encoded oplog batch from " << _getSource() << ": "
+                    << redact(decodeStatus);
+            _finishCallback(decodeStatus);
+            return;
+        }
+        queryResponsePtr = &decodedResponse;
+    }
+
     // At this point we have a successful batch and can call the subclass's _onSuccessfulBatch.
-    const auto& queryResponse = result.getValue();
+    const auto& queryResponse = *queryResponsePtr;
     auto batchResult = _onSuccessfulBatch(queryResponse);
     if (!batchResult.isOK()) {
         // The stopReplProducer fail point expects this to return successfully. If another fail
@@ -301,6 +368,24 @@ void AbstractOplogFetcher::_callback(const Fetcher::QueryResponseStatus& result,
     getMoreBob->appendElements(batchResult.getValue());
 }
 
+void AbstractOplogFetcher::_onStreamBatch(const Fetcher::QueryResponseStatus& result,
+                                          BSONObjBuilder* getMoreBob) {
+    auto handle =
+        _getExecutor()->scheduleWork([&](const executor::TaskExecutor::CallbackArgs& args) {
+            if (!args.status.isOK()) {
+                _callback(args.status, nullptr);
+                return;
+            }
+            _callback(result, getMoreBob);
+        });
+    if (!handle.isOK()) {
+        // The executor is shutting down and will not run any more work for this fetcher.
+        _callback(handle.getStatus(), nullptr);
+        return;
+    }
+    _getExecutor()->wait(handle.getValue());
+}
+
 void AbstractOplogFetcher::_finishCallback(Status status) {
     invariant(isActive());
 
@@ -33,6 +33,7 @@
 #include "mongo/client/fetcher.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/abstract_async_component.h"
+#include "mongo/db/repl/oplog_stream_reader.h"
 #include "mongo/db/repl/optime_with.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
@@ -120,6 +121,13 @@ protected:
      */
     virtual Milliseconds _getGetMoreMaxTime() const;
 
+    /**
+     * Returns a function connecting to the sync source if the oplog query should run on a
+     * connection of its own with the sync source streaming the batches back (see
+     * OplogStreamReader). Returns an empty function to run the query through the executor.
+     */
+    virtual OplogStreamReader::ConnectFn _makeStreamConnectFn() const;
+
     /**
      * Returns the sync source from which this oplog fetcher is fetching.
      */
@@ -173,6 +181,13 @@ private:
      */
     virtual StatusWith<BSONObj> _onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) = 0;
 
+    /**
+     * Called when the oplog query fails. Returns true if the subclass changed the commands it
+     * sends in response to 'status', in which case the query is restarted without using up one of
+     * the restarts. The default implementation returns false.
+     */
+    virtual bool _adjustQueryAfterError(const Status& status);
+
     /**
      * This function creates a Fetcher with the given `find` command and metadata.
      */
@@ -196,6 +211,12 @@ private:
      */
     void _callback(const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob);
 
+    /**
+     * Called on the stream reader's thread with each batch streamed back by the sync source. Runs
+     * "_callback" on the executor, as a Fetcher would, and waits for it to complete.
+     */
+    void _onStreamBatch(const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob);
+
     /**
      * Notifies caller that the oplog fetcher has completed processing operations from
      * the remote oplog using the "_onShutdownCallbackFn".
@@ -228,6 +249,11 @@ private:
 
     // Handle to currently scheduled _makeAndScheduleFetcherCallback task.
     executor::TaskExecutor::CallbackHandle _makeAndScheduleFetcherHandle;
+
+    // Runs the initial oplog query instead of '_fetcher' when the sync source streams the batches.
+    // Queries restarted after an error always use a Fetcher. Declared last so that the reader's
+    // thread is joined before the other members are destroyed.
+    std::unique_ptr<OplogStreamReader> _streamReader;
 };
 
 }  // namespace repl
@@ -35,7 +35,10 @@
 #include <algorithm>
 #include <iterator>
 
+#include "mongo/base/counter.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/sync_tail.h"
@@ -53,6 +56,48 @@ const auto kInsertGroupMaxBatchSize = insertVectorMaxBytes;
 // Limit number of ops in a single group.
 constexpr auto kInsertGroupMaxBatchCount = 64;
 
+// Limit number of ops applied in a single grouped WriteUnitOfWork.
+constexpr auto kUpdateDeleteGroupMaxBatchCount = 64;
+
+// Number of grouped inserts applied and the ops they contained.
+Counter64 insertGroupsStats;
+ServerStatusMetricField<Counter64> displayInsertGroups("repl.apply.grouping.insertGroups",
+                                                       &insertGroupsStats);
+Counter64 insertGroupOpsStats;
+ServerStatusMetricField<Counter64> displayInsertGroupOps("repl.apply.grouping.insertOps",
+                                                         &insertGroupOpsStats);
+
+// Number of update and delete groups applied and the ops they contained.
+Counter64 updateDeleteGroupsStats;
+ServerStatusMetricField<Counter64> displayUpdateDeleteGroups(
+    "repl.apply.grouping.updateDeleteGroups", &updateDeleteGroupsStats);
+Counter64 updateDeleteGroupOpsStats;
+ServerStatusMetricField<Counter64> displayUpdateDeleteGroupOps(
+    "repl.apply.grouping.updateDeleteOps", &updateDeleteGroupOpsStats);
+
+// Number of groups of any kind that failed and were reapplied one op at a time.
+Counter64 failedGroupsStats;
+ServerStatusMetricField<Counter64> displayFailedGroups("repl.apply.grouping.failedGroups",
+                                                       &failedGroupsStats);
+
+/**
+ * Returns true if 'entry' is an update or delete that can be applied as part of a group: it must
+ * target a single document by _id on a collection that is not capped.
+ */
+bool isGroupableUpdateOrDelete(const OplogEntry& entry) {
+    if (entry.isForCappedCollection) {
+        return false;
+    }
+    switch (entry.getOpType()) {
+        case OpTypeEnum::kUpdate:
+            return entry.getObject2() && entry.getObject2()->hasField("_id");
+        case OpTypeEnum::kDelete:
+            return entry.getObject().hasField("_id");
+        default:
+            return false;
+    }
+}
+
 }  // namespace
 
 // static
@@ -187,6 +232,8 @@ StatusWith<InsertGroup::ConstIterator> InsertGroup::groupAndApplyInserts(ConstIt
     try {
         // Apply the group of inserts.
         uassertStatusOK(SyncTail::syncApply(_opCtx, groupedInsertObj, _mode));
+        insertGroupsStats.increment(1);
+        insertGroupOpsStats.increment(std::distance(it, endOfGroupableOpsIterator));
         // It succeeded, advance the oplogEntriesIterator to the end of the
         // group of inserts.
         return endOfGroupableOpsIterator - 1;
@@ -208,6 +255,90 @@ StatusWith<InsertGroup::ConstIterator> InsertGroup::groupAndApplyInserts(ConstIt
         // Avoid quadratic run time from failed insert by not retrying until we
         // are beyond this group of ops.
         _doNotGroupBeforePoint = endOfGroupableOpsIterator - 1;
+        failedGroupsStats.increment(1);
+
+        return status;
+    }
+
+    MONGO_UNREACHABLE;
+}
+
+using UpdateDeleteGroup = ApplierHelpers::UpdateDeleteGroup;
+
+UpdateDeleteGroup::UpdateDeleteGroup(ApplierHelpers::OperationPtrs* ops,
+                                     OperationContext* opCtx,
+                                     UpdateDeleteGroup::Mode mode)
+    : _doNotGroupBeforePoint(ops->cbegin()), _end(ops->cend()), _opCtx(opCtx), _mode(mode) {}
+
+StatusWith<UpdateDeleteGroup::ConstIterator> UpdateDeleteGroup::groupAndApplyUpdatesAndDeletes(
+    ConstIterator it) {
+    const auto& entry = **it;
+
+    // The following conditions must be met before attempting to group the oplog entries starting
+    // at 'oplogEntriesIterator':
+    // 1) We are not in initial sync, where a missing document must be fetched from the sync
+    //    source rather than upserted;
+    // 2) The CRUD operation must be an _id-targeted update or delete on a collection that is not
+    //    capped;
+    // 3) We have not attempted to group this op during a previous call to this function.
+    if (Mode::kInitialSync == _mode) {
+        return Status(ErrorCodes::InvalidOptions,
+                      "Cannot group update and delete operations during initial sync.");
+    }
+    if (!isGroupableUpdateOrDelete(entry)) {
+        return Status(ErrorCodes::TypeMismatch,
+                      "Can only group _id-targeted update and delete operations on collections "
+                      "that are not capped.");
+    }
+    if (it <= _doNotGroupBeforePoint) {
+        return Status(ErrorCodes::InvalidPath,
+                      "Cannot group an operation that we previously attempted to group.");
+    }
+
+    auto batchCount = OperationPtrs::size_type(1);
+    const auto& batchNamespace = entry.getNamespace();
+    const auto& batchUuid = entry.getUuid();
+
+    // Each write in the group's WriteUnitOfWork carries its own timestamp, so a document may only
+    // be written once per group.
+    auto batchIds = SimpleBSONElementComparator::kInstance.makeBSONEltSet({entry.getIdElement()});
+
+    // Search for the first op that cannot be added to this group, as InsertGroup does.
+    auto endOfGroupableOpsIterator =
+        std::find_if(it + 1, _end, [&](const OplogEntry* nextEntry) -> bool {
+            batchCount += 1;
+            return !isGroupableUpdateOrDelete(*nextEntry)  // Must be an update or delete.
+                || nextEntry->getNamespace() != batchNamespace  // Must be in the same namespace.
+                || nextEntry->getUuid() != batchUuid            // Must be the same collection.
+                || batchCount > kUpdateDeleteGroupMaxBatchCount  // Limit ops in a single group.
+                || !batchIds.insert(nextEntry->getIdElement()).second;  // Must be a new document.
+        });
+
+    // See if we were able to create a group that contains more than a single op.
+    if (std::distance(it, endOfGroupableOpsIterator) == 1) {
+        return Status(ErrorCodes::NoSuchKey,
+                      "Not able to create a group with more than a single update or delete");
+    }
+
+    try {
+        uassertStatusOK(
+            SyncTail::syncApplyUpdatesAndDeletes(_opCtx, it, endOfGroupableOpsIterator));
+        updateDeleteGroupsStats.increment(1);
+        updateDeleteGroupOpsStats.increment(std::distance(it, endOfGroupableOpsIterator));
+        return endOfGroupableOpsIterator - 1;
+    } catch (...) {
+        // The group failed and none of its writes were committed. Fall through to the
+        // application of individual ops, which knows how to handle each failure.
+        auto status = exceptionToStatus().withContext(
+            str::stream() << "Error applying " << std::distance(it, endOfGroupableOpsIterator)
+                          << " grouped updates and deletes. Trying first op alone: "
+                          << redact(entry.raw));
+        LOG(2) << status;
+
+        // Avoid quadratic run time from a failed group by not retrying until we are beyond this
+        // group of ops.
+        _doNotGroupBeforePoint = endOfGroupableOpsIterator - 1;
+        failedGroupsStats.increment(1);
 
         return status;
     }
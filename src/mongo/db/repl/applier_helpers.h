@@ -51,6 +51,7 @@ public:
     static void stableSortByNamespace(OperationPtrs* oplogEntryPointers);
 
     class InsertGroup;
+    class UpdateDeleteGroup;
 };
 
 /**
@@ -88,5 +89,39 @@ private:
     Mode _mode;
 };
 
+/**
+ * Groups consecutive _id-targeted update and delete operations on distinct documents in the same
+ * namespace and applies them in a single WriteUnitOfWork, each write still timestamped with its
+ * own operation's timestamp.
+ * Advances the MultiApplier::OperationPtrs iterator if the group is applied successfully.
+ */
+class ApplierHelpers::UpdateDeleteGroup {
+    MONGO_DISALLOW_COPYING(UpdateDeleteGroup);
+
+public:
+    using ConstIterator = OperationPtrs::const_iterator;
+    using Mode = OplogApplication::Mode;
+
+    UpdateDeleteGroup(OperationPtrs* ops, OperationContext* opCtx, Mode mode);
+
+    /**
+     * Attempts to group update and delete operations starting at 'iter'.
+     * If the group is applied successfully, returns the iterator to the last operation included
+     * in the group.
+     */
+    StatusWith<ConstIterator> groupAndApplyUpdatesAndDeletes(ConstIterator oplogEntriesIterator);
+
+private:
+    // Prevents retrying a failed group by marking its final op and not allowing further groups
+    // until that op has been processed.
+    ConstIterator _doNotGroupBeforePoint;
+
+    // Used for constructing search bounds when grouping updates and deletes.
+    ConstIterator _end;
+
+    OperationContext* _opCtx;
+    Mode _mode;
+};
+
 }  // namespace repl
 }  // namespace mongo
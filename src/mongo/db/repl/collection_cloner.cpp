@@ -32,6 +32,7 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "mongo/base/string_data.h"
@@ -68,6 +69,32 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionCountAttempts, int, 3);
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListIndexesAttempts, int, 3);
 // The number of attempts for the find command, which gets the data.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionFindAttempts, int, 3);
+
+// Collections with at least twice this many documents are split into _id ranges that are
+// fetched from the sync source concurrently.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncCollectionClonerDocumentsPerRange, int, 1000 * 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "initialSyncCollectionClonerDocumentsPerRange must be at least 1");
+        }
+        return Status::OK();
+    });
+
+// The maximum number of _id ranges, and therefore cursors, used to clone a single collection.
+// A value of 1 disables range cloning.
+MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncCollectionClonerRanges, int, 8)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "maxNumInitialSyncCollectionClonerRanges must be between 1 and 64, "
+                          "inclusive");
+        }
+        return Status::OK();
+    });
+
+// The number of _id values sampled per range when picking range boundaries.
+const int kRangeBoundarySamplesPerRange = 20;
 }  // namespace
 
 // Failpoint which causes initial sync to hang before establishing its cursor to clone the
@@ -147,6 +174,7 @@ CollectionCloner::CollectionCloner(executor::TaskExecutor* executor,
               executor::RemoteCommandRequest::kNoTimeout,
               RemoteCommandRetryScheduler::kAllRetriableErrors)),
       _indexSpecs(),
+      _sourceCollectionNss(_sourceNss),
       _documentsToInsert(),
       _dbWorkTaskRunner(_dbWorkThreadPool),
       _scheduleDbWorkFn([this](const executor::TaskExecutor::CallbackFn& work) {
@@ -268,6 +296,12 @@ void CollectionCloner::_cancelRemainingWork_inlock() {
     if (_verifyCollectionDroppedScheduler) {
         _verifyCollectionDroppedScheduler->shutdown();
     }
+    if (_sampleRangeBoundariesScheduler) {
+        _sampleRangeBoundariesScheduler->shutdown();
+    }
+    for (auto&& scheduler : _rangeCursorSchedulers) {
+        scheduler->shutdown();
+    }
     _dbWorkTaskRunner.cancel();
 }
 
@@ -401,6 +435,10 @@ void CollectionCloner::_listIndexesCallback(const Fetcher::QueryResponseStatus&
     }
 
     UniqueLock lk(_mutex);
+    if (batchData.nss.isListIndexesCursorNS()) {
+        _sourceCollectionNss = batchData.nss.getTargetNSForListIndexes();
+    }
+
     // When listing indexes by UUID, the sync source may use a different name for the collection
     // as result of renaming or two-phase drop. As the index spec also includes a 'ns' field, this
     // must be rewritten.
@@ -477,6 +515,30 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
 
     _collLoader = std::move(collectionBulkLoader.getValue());
 
+    Client::initThreadIfNotAlready();
+    auto opCtx = cc().getOperationContext();
+
+    MONGO_FAIL_POINT_BLOCK(initialSyncHangBeforeCollectionClone, options) {
+        const BSONObj& data = options.getData();
+        if (data["namespace"].String() == _destNss.ns()) {
+            log() << "initial sync - initialSyncHangBeforeCollectionClone fail point "
+                     "enabled. Blocking until fail point is disabled.";
+            while (MONGO_FAIL_POINT(initialSyncHangBeforeCollectionClone) && !_isShuttingDown()) {
+                mongo::sleepsecs(1);
+            }
+        }
+    }
+
+    auto numRanges = _getNumRangesToClone();
+    auto scheduleStatus = numRanges > 1 ? _scheduleSampleRangeBoundaries(numRanges)
+                                        : _scheduleEstablishCollectionCursors(opCtx);
+    if (!scheduleStatus.isOK()) {
+        _finishCallback(scheduleStatus);
+        return;
+    }
+}
+
+Status CollectionCloner::_scheduleEstablishCollectionCursors(OperationContext* opCtx) {
     BSONObjBuilder cmdObj;
     EstablishCursorsCommand cursorCommand;
     // The 'find' command is used when the number of cloning cursors is 1 to ensure
@@ -497,20 +559,6 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
         cursorCommand = ParallelCollScan;
     }
 
-    Client::initThreadIfNotAlready();
-    auto opCtx = cc().getOperationContext();
-
-    MONGO_FAIL_POINT_BLOCK(initialSyncHangBeforeCollectionClone, options) {
-        const BSONObj& data = options.getData();
-        if (data["namespace"].String() == _destNss.ns()) {
-            log() << "initial sync - initialSyncHangBeforeCollectionClone fail point "
-                     "enabled. Blocking until fail point is disabled.";
-            while (MONGO_FAIL_POINT(initialSyncHangBeforeCollectionClone) && !_isShuttingDown()) {
-                mongo::sleepsecs(1);
-            }
-        }
-    }
-
     _establishCollectionCursorsScheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
         _executor,
         RemoteCommandRequest(_source,
@@ -531,9 +579,299 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
 
     if (!scheduleStatus.isOK()) {
         _establishCollectionCursorsScheduler.reset();
+    }
+    return scheduleStatus;
+}
+
+int CollectionCloner::_getNumRangesToClone() const {
+    LockGuard lk(_mutex);
+    // Ranges are bounds on the _id index, so they require one whose order matches the order in
+    // which _id values compare here. 'parallelCollectionScan' already splits the collection, and
+    // capped collections must be cloned in insertion order.
+    if (_maxNumClonerCursors != 1 || _idIndexSpec.isEmpty() || _options.capped ||
+        !_options.collation.isEmpty()) {
+        return 1;
+    }
+    auto numRanges = _stats.documentToCopy /
+        static_cast<size_t>(initialSyncCollectionClonerDocumentsPerRange.load());
+    return static_cast<int>(std::min(
+        numRanges, static_cast<size_t>(maxNumInitialSyncCollectionClonerRanges.load())));
+}
+
+Status CollectionCloner::_scheduleSampleRangeBoundaries(int numRanges) {
+    LockGuard lk(_mutex);
+    // 'aggregate' cannot address a collection by UUID, so use the name the sync source reported
+    // for it. The sample only decides where the ranges split; every range is still read through
+    // the UUID, so a concurrent rename can at worst produce unbalanced ranges.
+    BSONObjBuilder cmdObj;
+    cmdObj.append("aggregate", _sourceCollectionNss.coll());
+    cmdObj.append("pipeline",
+                  BSON_ARRAY(BSON("$sample" << BSON("size" << numRanges *
+                                                        kRangeBoundarySamplesPerRange))
+                             << BSON("$project" << BSON("_id" << 1))
+                             << BSON("$sort" << BSON("_id" << 1))));
+    cmdObj.append("cursor", BSONObj());
+
+    _sampleRangeBoundariesScheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
+        _executor,
+        RemoteCommandRequest(_source,
+                             _sourceNss.db().toString(),
+                             cmdObj.obj(),
+                             ReadPreferenceSetting::secondaryPreferredMetadata(),
+                             nullptr,
+                             RemoteCommandRequest::kNoTimeout),
+        [=](const RemoteCommandCallbackArgs& rcbd) {
+            _sampleRangeBoundariesCallback(rcbd, numRanges);
+        },
+        RemoteCommandRetryScheduler::makeRetryPolicy(
+            numInitialSyncCollectionFindAttempts.load(),
+            executor::RemoteCommandRequest::kNoTimeout,
+            RemoteCommandRetryScheduler::kAllRetriableErrors));
+    auto scheduleStatus = _sampleRangeBoundariesScheduler->startup();
+    LOG(1) << "Sampling _id values to split collection " << _sourceNss.ns() << " into "
+           << numRanges << " ranges";
+
+    if (!scheduleStatus.isOK()) {
+        _sampleRangeBoundariesScheduler.reset();
+    }
+    return scheduleStatus;
+}
+
+void CollectionCloner::_sampleRangeBoundariesCallback(const RemoteCommandCallbackArgs& rcbd,
+                                                      int numRanges) {
+    if (_isShuttingDown()) {
+        _finishCallback({ErrorCodes::CallbackCanceled, "Cloner shutting down."});
+        return;
+    }
+
+    // Failing to sample only costs parallelism, so fall back to a single cursor.
+    auto fallBackToSingleCursor = [this](const Status& reason) {
+        LOG(1) << "Cloning collection " << _sourceNss.ns()
+               << " with a single cursor: " << redact(reason);
+        auto scheduleStatus = _scheduleEstablishCollectionCursors(nullptr);
+        if (!scheduleStatus.isOK()) {
+            _finishCallback(scheduleStatus);
+        }
+    };
+
+    if (!rcbd.response.isOK()) {
+        fallBackToSingleCursor(rcbd.response.status);
+        return;
+    }
+    auto commandStatus = getStatusFromCommandResult(rcbd.response.data);
+    if (!commandStatus.isOK()) {
+        fallBackToSingleCursor(commandStatus);
+        return;
+    }
+    auto sampleResponse = CursorResponse::parseFromBSON(rcbd.response.data);
+    if (!sampleResponse.isOK()) {
+        fallBackToSingleCursor(sampleResponse.getStatus());
+        return;
+    }
+
+    // The sample is sorted by _id. Take every (samples / numRanges)-th value as a split point,
+    // skipping duplicates so that no range is empty by construction. Any documents of the
+    // collection outside the sample still fall into exactly one range, since the first and last
+    // ranges are unbounded.
+    const auto& samples = sampleResponse.getValue().getBatch();
+    std::vector<BSONObj> splitPoints;
+    for (int i = 1; i < numRanges; ++i) {
+        auto sampleIndex = samples.size() * i / numRanges;
+        if (sampleIndex == 0 || sampleIndex >= samples.size()) {
+            continue;
+        }
+        auto id = samples[sampleIndex]["_id"];
+        if (id.eoo()) {
+            continue;
+        }
+        if (!splitPoints.empty() && splitPoints.back().firstElement().woCompare(id, false) >= 0) {
+            continue;
+        }
+        splitPoints.push_back(id.wrap("_id"));
+    }
+    if (splitPoints.empty()) {
+        fallBackToSingleCursor({ErrorCodes::InvalidLength,
+                                str::stream() << "sampled " << samples.size()
+                                              << " _id values, not enough to split ranges"});
+        return;
+    }
+
+    {
+        LockGuard lk(_mutex);
+        _rangeSplitPoints = std::move(splitPoints);
+        _stats.ranges.clear();
+        for (size_t i = 0; i <= _rangeSplitPoints.size(); ++i) {
+            Stats::Range range;
+            range.min = i == 0 ? BSON("_id" << MINKEY) : _rangeSplitPoints[i - 1];
+            range.max = i == _rangeSplitPoints.size() ? BSON("_id" << MAXKEY)
+                                                      : _rangeSplitPoints[i];
+            _stats.ranges.push_back(std::move(range));
+        }
+        log() << "Cloning collection " << _sourceNss.ns() << " as " << _stats.ranges.size()
+              << " _id ranges";
+    }
+
+    auto scheduleStatus = _scheduleEstablishRangeCursor(0);
+    if (!scheduleStatus.isOK()) {
         _finishCallback(scheduleStatus);
+    }
+}
+
+Status CollectionCloner::_scheduleEstablishRangeCursor(size_t rangeIndex) {
+    LockGuard lk(_mutex);
+    if (State::kShuttingDown == _state) {
+        return {ErrorCodes::CallbackCanceled, "Cloner shutting down."};
+    }
+
+    BSONObjBuilder cmdObj;
+    cmdObj.appendElements(makeCommandWithUUIDorCollectionName("find", _options.uuid, _sourceNss));
+    cmdObj.append("hint", BSON("_id" << 1));
+    if (rangeIndex > 0) {
+        cmdObj.append("min", _rangeSplitPoints[rangeIndex - 1]);
+    }
+    if (rangeIndex < _rangeSplitPoints.size()) {
+        cmdObj.append("max", _rangeSplitPoints[rangeIndex]);
+    }
+    cmdObj.append("noCursorTimeout", true);
+    cmdObj.append("batchSize", 0);
+
+    // Each scheduler is kept until the cloner is destroyed, because a scheduler may not be
+    // destroyed from within its own callback.
+    _rangeCursorSchedulers.push_back(stdx::make_unique<RemoteCommandRetryScheduler>(
+        _executor,
+        RemoteCommandRequest(_source,
+                             _sourceNss.db().toString(),
+                             cmdObj.obj(),
+                             ReadPreferenceSetting::secondaryPreferredMetadata(),
+                             nullptr,
+                             RemoteCommandRequest::kNoTimeout),
+        [=](const RemoteCommandCallbackArgs& rcbd) {
+            _establishRangeCursorCallback(rcbd, rangeIndex);
+        },
+        RemoteCommandRetryScheduler::makeRetryPolicy(
+            numInitialSyncCollectionFindAttempts.load(),
+            executor::RemoteCommandRequest::kNoTimeout,
+            RemoteCommandRetryScheduler::kAllRetriableErrors)));
+    return _rangeCursorSchedulers.back()->startup();
+}
+
+void CollectionCloner::_establishRangeCursorCallback(const RemoteCommandCallbackArgs& rcbd,
+                                                     size_t rangeIndex) {
+    auto response = rcbd.response;
+
+    // The cursors must be killed before _finishCallback(), which may destroy this cloner.
+    auto finishWithStatus = [this, &response](const Status& status) {
+        _killRangeCursors(response);
+        _finishCallback(status);
+    };
+
+    if (_isShuttingDown()) {
+        finishWithStatus({ErrorCodes::CallbackCanceled, "Cloner shutting down."});
+        return;
+    }
+    if (!response.isOK()) {
+        finishWithStatus(response.status);
+        return;
+    }
+    Status commandStatus = getStatusFromCommandResult(response.data);
+    if (commandStatus == ErrorCodes::NamespaceNotFound) {
+        finishWithStatus(Status::OK());
         return;
     }
+    if (!commandStatus.isOK()) {
+        finishWithStatus(commandStatus.withContext(
+            str::stream() << "Error querying range " << rangeIndex << " of collection '"
+                          << _sourceNss.ns()
+                          << "'"));
+        return;
+    }
+    std::vector<CursorResponse> cursorResponses;
+    Status parseResponseStatus = _parseCursorResponse(response.data, &cursorResponses, Find);
+    if (!parseResponseStatus.isOK()) {
+        finishWithStatus(parseResponseStatus);
+        return;
+    }
+
+    bool allRangesEstablished;
+    {
+        LockGuard lk(_mutex);
+        invariant(_rangeCursorResponses.size() == rangeIndex);
+        _rangeCursorResponses.push_back(std::move(cursorResponses.front()));
+        allRangesEstablished = _rangeCursorResponses.size() == _stats.ranges.size();
+        if (allRangesEstablished) {
+            cursorResponses.clear();
+            cursorResponses.swap(_rangeCursorResponses);
+        }
+    }
+
+    if (!allRangesEstablished) {
+        auto scheduleStatus = _scheduleEstablishRangeCursor(rangeIndex + 1);
+        if (!scheduleStatus.isOK()) {
+            // The cursor in 'response' is already recorded with the others.
+            _killRangeCursors(executor::RemoteCommandResponse(scheduleStatus));
+            _finishCallback(scheduleStatus);
+        }
+        return;
+    }
+
+    LOG(1) << "Collection cloner running with " << cursorResponses.size()
+           << " range cursors established.";
+    _startFetchingDocuments(std::move(cursorResponses));
+}
+
+void CollectionCloner::_killRangeCursors(const executor::RemoteCommandResponse& response) {
+    std::vector<CursorId> cursorIds;
+    {
+        LockGuard lk(_mutex);
+        for (auto&& cursorResponse : _rangeCursorResponses) {
+            cursorIds.push_back(cursorResponse.getCursorId());
+        }
+        _rangeCursorResponses.clear();
+    }
+    // A 'find' that completes after the cloner started shutting down may still have opened a
+    // cursor.
+    if (response.isOK()) {
+        auto cursorResponse = CursorResponse::parseFromBSON(response.data);
+        if (cursorResponse.isOK()) {
+            cursorIds.push_back(cursorResponse.getValue().getCursorId());
+        }
+    }
+    cursorIds.erase(std::remove(cursorIds.begin(), cursorIds.end(), CursorId(0)), cursorIds.end());
+    if (cursorIds.empty()) {
+        return;
+    }
+
+    auto logKillCursorsResult = [](const RemoteCommandCallbackArgs& args) {
+        if (!args.response.isOK()) {
+            warning() << "killCursors command task failed: " << redact(args.response.status);
+            return;
+        }
+        auto status = getStatusFromCommandResult(args.response.data);
+        if (!status.isOK()) {
+            warning() << "killCursors command failed: " << redact(status);
+        }
+    };
+    BSONObjBuilder cmdObj;
+    cmdObj.append("killCursors", _sourceNss.coll());
+    cmdObj.append("cursors", cursorIds);
+    auto scheduleResult = _executor->scheduleRemoteCommand(
+        RemoteCommandRequest(_source, _sourceNss.db().toString(), cmdObj.obj(), nullptr),
+        logKillCursorsResult);
+    if (!scheduleResult.isOK()) {
+        warning() << "failed to schedule killCursors command: "
+                  << redact(scheduleResult.getStatus());
+    }
+}
+
+size_t CollectionCloner::_getRangeIndex_inlock(const BSONElement& id) const {
+    auto it = std::upper_bound(
+        _rangeSplitPoints.begin(),
+        _rangeSplitPoints.end(),
+        id,
+        [](const BSONElement& lhs, const BSONObj& rhs) {
+            return lhs.woCompare(rhs.firstElement(), false) < 0;
+        });
+    return static_cast<size_t>(std::distance(_rangeSplitPoints.begin(), it));
 }
 
 Status CollectionCloner::_parseCursorResponse(BSONObj response,
@@ -619,7 +957,10 @@ void CollectionCloner::_establishCollectionCursorsCallback(const RemoteCommandCa
     }
     LOG(1) << "Collection cloner running with " << cursorResponses.size()
            << " cursors established.";
+    _startFetchingDocuments(std::move(cursorResponses));
+}
 
+void CollectionCloner::_startFetchingDocuments(std::vector<CursorResponse> cursorResponses) {
     // Initialize the 'AsyncResultsMerger'(ARM).
     std::vector<RemoteCursor> remoteCursors;
     for (auto&& cursorResponse : cursorResponses) {
@@ -879,6 +1220,11 @@ void CollectionCloner::_insertDocumentsCallback(
     }
     _documentsToInsert.swap(docs);
     _stats.documentsCopied += docs.size();
+    if (!_stats.ranges.empty()) {
+        for (auto&& doc : docs) {
+            ++_stats.ranges[_getRangeIndex_inlock(doc["_id"])].documentsCopied;
+        }
+    }
     ++_stats.fetchBatches;
     _progressMeter.hit(int(docs.size()));
     invariant(_collLoader);
@@ -973,6 +1319,15 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
     builder->appendNumber(kDocumentsCopiedFieldName, documentsCopied);
     builder->appendNumber("indexes", indexes);
     builder->appendNumber("fetchedBatches", fetchBatches);
+    if (!ranges.empty()) {
+        BSONArrayBuilder rangesBuilder(builder->subarrayStart("ranges"));
+        for (auto&& range : ranges) {
+            BSONObjBuilder rangeBuilder(rangesBuilder.subobjStart());
+            rangeBuilder.append("min", range.min);
+            rangeBuilder.append("max", range.max);
+            rangeBuilder.appendNumber(kDocumentsCopiedFieldName, range.documentsCopied);
+        }
+    }
     if (start != Date_t()) {
         builder->appendDate("start", start);
         if (end != Date_t()) {
@@ -73,6 +73,15 @@ public:
         static constexpr StringData kDocumentsToCopyFieldName = "documentsToCopy"_sd;
         static constexpr StringData kDocumentsCopiedFieldName = "documentsCopied"_sd;
 
+        /**
+         * Progress of one _id range when the collection is cloned as several ranges.
+         */
+        struct Range {
+            BSONObj min;  // Inclusive, MinKey for the first range.
+            BSONObj max;  // Exclusive, MaxKey for the last range.
+            size_t documentsCopied{0};
+        };
+
         std::string ns;
         Date_t start;
         Date_t end;
@@ -80,6 +89,7 @@ public:
         size_t documentsCopied{0};
         size_t indexes{0};
         size_t fetchBatches{0};
+        std::vector<Range> ranges;
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -196,6 +206,59 @@ private:
      */
     enum EstablishCursorsCommand { Find, ParallelCollScan };
 
+    /**
+     * Schedules the 'find' or 'parallelCollectionScan' command that establishes the cursor(s)
+     * covering the whole collection.
+     */
+    Status _scheduleEstablishCollectionCursors(OperationContext* opCtx);
+
+    /**
+     * Returns the number of _id ranges the collection should be split into, or 1 if the
+     * collection should be cloned with a single cursor.
+     */
+    int _getNumRangesToClone() const;
+
+    /**
+     * Asks the sync source for a random sample of _id values from which the boundaries of
+     * 'numRanges' ranges are picked.
+     */
+    Status _scheduleSampleRangeBoundaries(int numRanges);
+
+    /**
+     * Turns the sampled _id values into range boundaries and starts establishing a cursor for
+     * each range. Falls back to a single cursor if the sample could not be obtained or does not
+     * yield at least two distinct ranges.
+     */
+    void _sampleRangeBoundariesCallback(const RemoteCommandCallbackArgs& rcbd, int numRanges);
+
+    /**
+     * Schedules a 'find' restricted to the range at 'rangeIndex' using min/max on the _id index.
+     */
+    Status _scheduleEstablishRangeCursor(size_t rangeIndex);
+
+    /**
+     * Records the cursor for the range at 'rangeIndex' and establishes the next one. Once every
+     * range has a cursor, all of them are handed to the 'AsyncResultsMerger' together.
+     */
+    void _establishRangeCursorCallback(const RemoteCommandCallbackArgs& rcbd, size_t rangeIndex);
+
+    /**
+     * Sends a killCursors for the range cursors not yet handed to the 'AsyncResultsMerger', and for
+     * the cursor in 'response' if it holds one. Range cursors are opened with 'noCursorTimeout',
+     * so the sync source would otherwise keep them open after the cloner fails.
+     */
+    void _killRangeCursors(const executor::RemoteCommandResponse& response);
+
+    /**
+     * Returns the index of the range whose bounds contain 'id'.
+     */
+    size_t _getRangeIndex_inlock(const BSONElement& id) const;
+
+    /**
+     * Creates the 'AsyncResultsMerger' over 'cursorResponses' and starts fetching documents.
+     */
+    void _startFetchingDocuments(std::vector<CursorResponse> cursorResponses);
+
     /**
      * Parses the cursor responses from the 'find' or 'parallelCollectionScan' command
      * and passes them into the 'AsyncResultsMerger'.
@@ -287,6 +350,9 @@ private:
     Fetcher _listIndexesFetcher;                  // (S)
     std::vector<BSONObj> _indexSpecs;             // (M)
     BSONObj _idIndexSpec;                         // (M)
+    // (M) Name of the collection on the sync source, as reported by listIndexes. Used for the
+    // commands that cannot address a collection by UUID.
+    NamespaceString _sourceCollectionNss;
     std::vector<BSONObj>
         _documentsToInsert;        // (M) Documents read from 'AsyncResultsMerger' to insert.
     TaskRunner _dbWorkTaskRunner;  // (R)
@@ -311,6 +377,18 @@ private:
     // (M) Scheduler used to determine if a cursor was closed because the collection was dropped.
     std::unique_ptr<RemoteCommandRetryScheduler> _verifyCollectionDroppedScheduler;
 
+    // (M) Scheduler used to sample _id values for splitting the collection into ranges.
+    std::unique_ptr<RemoteCommandRetryScheduler> _sampleRangeBoundariesScheduler;
+
+    // (M) Schedulers used to establish one cursor per _id range, in range order.
+    std::vector<std::unique_ptr<RemoteCommandRetryScheduler>> _rangeCursorSchedulers;
+
+    // (M) Owned {_id: <value>} documents separating consecutive ranges, in ascending order.
+    std::vector<BSONObj> _rangeSplitPoints;
+
+    // (M) Cursors established so far for the ranges, in range order.
+    std::vector<CursorResponse> _rangeCursorResponses;
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
@@ -37,10 +37,12 @@
 #include "mongo/db/repl/collection_cloner.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/task_executor_proxy.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace {
 
@@ -1626,6 +1628,149 @@ TEST_F(CollectionClonerUUIDTest,
     ASSERT_FALSE(collectionCloner->isActive());
 }
 
+namespace {
+
+void setServerParameter(StringData name, StringData value) {
+    auto parameter = ServerParameterSet::getGlobal()->getMap().find(name.toString());
+    ASSERT(parameter != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(parameter->second->setFromString(value.toString()));
+}
+
+}  // namespace
+
+/**
+ * Start cloning a collection large enough to be split into three _id ranges.
+ * The CollectionCloner should sample _id values, establish one bounded 'find' cursor per range and
+ * report the documents copied from each range in its stats.
+ */
+TEST_F(CollectionClonerTest, LargeCollectionIsClonedAsSeparateIdRanges) {
+    setServerParameter("initialSyncCollectionClonerDocumentsPerRange", "1");
+    ON_BLOCK_EXIT(
+        [] { setServerParameter("initialSyncCollectionClonerDocumentsPerRange", "1000000"); });
+
+    ASSERT_OK(collectionCloner->startup());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(3));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionStats.initCalled);
+
+    // The sampled _id values 2 and 4 split the collection into [MinKey, 2), [2, 4) and [4, MaxKey).
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        auto noi = getNet()->getNextReadyRequest();
+        auto&& cmdObj = noi->getRequest().cmdObj;
+        ASSERT_EQUALS("aggregate"_sd, cmdObj.firstElementFieldName());
+        ASSERT_EQUALS(nss.coll(), cmdObj.firstElement().str());
+        scheduleNetworkResponse(noi,
+                                createCursorResponse(0,
+                                                     BSON_ARRAY(BSON("_id" << 0)
+                                                                << BSON("_id" << 1)
+                                                                << BSON("_id" << 2)
+                                                                << BSON("_id" << 3)
+                                                                << BSON("_id" << 4)
+                                                                << BSON("_id" << 5))));
+        finishProcessingNetworkResponse();
+    }
+
+    const std::vector<std::pair<BSONObj, BSONObj>> expectedBounds = {
+        {BSONObj(), BSON("_id" << 2)},
+        {BSON("_id" << 2), BSON("_id" << 4)},
+        {BSON("_id" << 4), BSONObj()}};
+    for (size_t i = 0; i < expectedBounds.size(); ++i) {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        auto noi = getNet()->getNextReadyRequest();
+        auto&& cmdObj = noi->getRequest().cmdObj;
+        ASSERT_EQUALS("find"_sd, cmdObj.firstElementFieldName());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << 1), cmdObj["hint"].Obj());
+        ASSERT_BSONOBJ_EQ(expectedBounds[i].first,
+                          cmdObj["min"].eoo() ? BSONObj() : cmdObj["min"].Obj());
+        ASSERT_BSONOBJ_EQ(expectedBounds[i].second,
+                          cmdObj["max"].eoo() ? BSONObj() : cmdObj["max"].Obj());
+        ASSERT_EQUALS(0, cmdObj["batchSize"].numberInt());
+        scheduleNetworkResponse(noi, createCursorResponse(CursorId(i + 1), BSONArray()));
+        finishProcessingNetworkResponse();
+    }
+
+    // All three range cursors are fetched from concurrently.
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(
+            createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 0) << BSON("_id" << 1))));
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 2))));
+        processNetworkResponse(
+            createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 4) << BSON("_id" << 5))));
+    }
+
+    collectionCloner->join();
+    ASSERT_OK(getStatus());
+    ASSERT_EQUALS(5, collectionStats.insertCount);
+    ASSERT_TRUE(collectionStats.commitCalled);
+
+    auto stats = collectionCloner->getStats();
+    ASSERT_EQUALS(5U, stats.documentsCopied);
+    ASSERT_EQUALS(3U, stats.ranges.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << MINKEY), stats.ranges[0].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << MAXKEY), stats.ranges[2].max);
+    ASSERT_EQUALS(2U, stats.ranges[0].documentsCopied);
+    ASSERT_EQUALS(1U, stats.ranges[1].documentsCopied);
+    ASSERT_EQUALS(2U, stats.ranges[2].documentsCopied);
+    ASSERT_EQUALS(3U, stats.toBSON()["ranges"].Array().size());
+}
+
+/**
+ * Start cloning a collection split into three _id ranges and fail the 'find' for the last range.
+ * The CollectionCloner should kill the cursors already established for the first two ranges, since
+ * they are opened with 'noCursorTimeout'.
+ */
+TEST_F(CollectionClonerTest, FailingToEstablishRangeCursorKillsCursorsOfPreviousRanges) {
+    setServerParameter("initialSyncCollectionClonerDocumentsPerRange", "1");
+    ON_BLOCK_EXIT(
+        [] { setServerParameter("initialSyncCollectionClonerDocumentsPerRange", "1000000"); });
+
+    ASSERT_OK(collectionCloner->startup());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(3));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->waitForDbWorker();
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCursorResponse(0,
+                                                    BSON_ARRAY(BSON("_id" << 0)
+                                                               << BSON("_id" << 1)
+                                                               << BSON("_id" << 2)
+                                                               << BSON("_id" << 3)
+                                                               << BSON("_id" << 4)
+                                                               << BSON("_id" << 5))));
+    }
+    for (CursorId cursorId : {1, 2}) {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCursorResponse(cursorId, BSONArray()));
+    }
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(BSON("ok" << 0 << "errmsg"
+                                         << "find error"
+                                         << "code"
+                                         << int(ErrorCodes::OperationFailed)));
+    }
+
+    collectionCloner->join();
+    ASSERT_EQUALS(ErrorCodes::OperationFailed, getStatus());
+
+    executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+    ASSERT_TRUE(getNet()->hasReadyRequests());
+    auto&& cmdObj = getNet()->getNextReadyRequest()->getRequest().cmdObj;
+    ASSERT_EQUALS("killCursors"_sd, cmdObj.firstElementFieldName());
+    ASSERT_EQUALS(nss.coll(), cmdObj.firstElement().str());
+    ASSERT_BSONOBJ_EQ(BSON("cursors" << BSON_ARRAY(1LL << 2LL)), cmdObj["cursors"].wrap());
+}
+
 class ParallelCollectionClonerTest : public BaseClonerTest {
 public:
     BaseCloner* getCloner() const override;
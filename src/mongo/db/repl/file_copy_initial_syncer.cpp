@@ -0,0 +1,370 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_initial_syncer.h"
+
+#include <boost/filesystem.hpp>
+#include <vector>
+
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/client.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/file.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+namespace repl {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// Written in place of the completion marker once the node's own files have been removed, so that
+// an install interrupted while moving files is resumed without removing any of them again.
+const char kInstallingMarkerName[] = "initialsync.installing";
+
+/**
+ * Returns true if 'path' is a file WiredTiger owns, which the staged files replace.
+ */
+bool isStorageEngineFile(const fs::path& path) {
+    const auto filename = path.filename().string();
+    return StringData(filename).endsWith(".wt") || StringData(filename).startsWith("WiredTiger") ||
+        path.parent_path().filename() == "journal";
+}
+
+/**
+ * Returns true if 'relativePath', as sent by the sync source, names a file inside the dbpath.
+ */
+bool isSafeRelativePath(const fs::path& relativePath) {
+    if (relativePath.empty() || relativePath.has_root_path()) {
+        return false;
+    }
+    for (auto&& component : relativePath) {
+        if (component == "..") {
+            return false;
+        }
+    }
+    return true;
+}
+
+Status writeFile(const fs::path& path, const char* data, std::size_t size) {
+    File file;
+    file.open(path.string().c_str());
+    if (file.bad()) {
+        return {ErrorCodes::FileNotOpen, str::stream() << "failed to open " << path.string()};
+    }
+    file.write(0, data, size);
+    file.fsync();
+    if (file.bad()) {
+        return {ErrorCodes::FileStreamFailed, str::stream() << "failed to write " << path.string()};
+    }
+    return Status::OK();
+}
+
+}  // namespace
+
+constexpr StringData FileCopyInitialSyncer::kStagingDirName;
+constexpr StringData FileCopyInitialSyncer::kCompleteMarkerName;
+
+FileCopyInitialSyncer::FileCopyInitialSyncer(Options options,
+                                             ChooseSyncSourceFn chooseSyncSourceFn,
+                                             ConnectFn connectFn,
+                                             OnCompletionFn onCompletion)
+    : _options(std::move(options)),
+      _chooseSyncSourceFn(std::move(chooseSyncSourceFn)),
+      _connectFn(std::move(connectFn)),
+      _onCompletion(std::move(onCompletion)) {
+    uassert(ErrorCodes::BadValue, "chunk size must be positive", _options.chunkSizeBytes > 0);
+    uassert(ErrorCodes::BadValue, "callback function cannot be null", _onCompletion);
+}
+
+FileCopyInitialSyncer::~FileCopyInitialSyncer() {
+    shutdown();
+    join();
+}
+
+void FileCopyInitialSyncer::startup(int maxAttempts) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(!_thread.joinable());
+    _thread = stdx::thread([this, maxAttempts] { _run(maxAttempts); });
+}
+
+void FileCopyInitialSyncer::shutdown() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inShutdown = true;
+}
+
+void FileCopyInitialSyncer::join() {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+bool FileCopyInitialSyncer::_isShuttingDown() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _inShutdown;
+}
+
+void FileCopyInitialSyncer::_run(int maxAttempts) {
+    Client::initThread("FileCopyInitialSyncer");
+
+    StatusWith<Timestamp> result(ErrorCodes::InitialSyncFailure, "no attempts were made");
+    for (int attempt = 1; attempt <= maxAttempts; ++attempt) {
+        if (_isShuttingDown()) {
+            result = {ErrorCodes::CallbackCanceled, "file copy initial sync shutting down"};
+            break;
+        }
+        if (attempt > 1) {
+            sleepmillis(durationCount<Milliseconds>(_options.retryWait));
+        }
+
+        const auto source = _chooseSyncSourceFn();
+        if (source.empty()) {
+            result = {ErrorCodes::InvalidSyncSource, "no sync source available"};
+            log() << "File copy initial sync attempt " << attempt << " of " << maxAttempts
+                  << " found no sync source";
+            continue;
+        }
+
+        log() << "File copy initial sync attempt " << attempt << " of " << maxAttempts
+              << " copying from " << source;
+        try {
+            auto conn = _connectFn(source);
+            if (!conn.isOK()) {
+                result = conn.getStatus();
+            } else {
+                result = copyFiles(conn.getValue().get());
+            }
+        } catch (const DBException& ex) {
+            result = ex.toStatus();
+        }
+        if (result.isOK() || result == ErrorCodes::CallbackCanceled) {
+            break;
+        }
+        error() << "File copy initial sync attempt " << attempt << " of " << maxAttempts
+                << " failed: " << redact(result.getStatus());
+    }
+
+    _onCompletion(result);
+}
+
+StatusWith<Timestamp> FileCopyInitialSyncer::copyFiles(DBClientBase* conn) {
+    const auto stagingDir = fs::path(_options.dbpath) / kStagingDirName.toString();
+    try {
+        fs::remove_all(stagingDir);
+        fs::create_directories(stagingDir);
+    } catch (const fs::filesystem_error& ex) {
+        return {ErrorCodes::FileRenameFailed,
+                str::stream() << "failed to create " << stagingDir.string() << ": " << ex.what()};
+    }
+
+    BSONObj beginReply;
+    conn->runCommand("admin", BSON("_beginBackupCursor" << 1), beginReply);
+    auto status = getStatusFromCommandResult(beginReply);
+    if (!status.isOK()) {
+        return status.withContext("failed to open a backup cursor on the sync source");
+    }
+    auto backupId = UUID::parse(beginReply["backupId"]);
+    if (!backupId.isOK()) {
+        return backupId.getStatus();
+    }
+    const auto checkpointTimestamp = beginReply["checkpointTimestamp"].timestamp();
+    ON_BLOCK_EXIT([&] {
+        // Best effort: the sync source also closes backup cursors that are no longer used.
+        try {
+            BSONObj endReply;
+            conn->runCommand("admin",
+                             BSON("_endBackupCursor" << 1 << "backupId" << backupId.getValue()),
+                             endReply);
+        } catch (const DBException& ex) {
+            warning() << "Failed to close backup cursor " << backupId.getValue() << ": "
+                      << redact(ex.toStatus());
+        }
+    });
+
+    std::uint64_t bytesCopied = 0;
+    std::size_t filesCopied = 0;
+    std::vector<char> chunk;
+    for (auto&& fileElem : beginReply["files"].Obj()) {
+        const auto fileObj = fileElem.Obj();
+        const auto filename = fileObj["filename"].str();
+        const auto fileSize = static_cast<std::uint64_t>(fileObj["fileSize"].safeNumberLong());
+        const fs::path relativePath(filename);
+        if (!isSafeRelativePath(relativePath)) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "sync source sent invalid backup file name '" << filename
+                                  << "'"};
+        }
+
+        const auto path = stagingDir / relativePath;
+        File file;
+        try {
+            fs::create_directories(path.parent_path());
+        } catch (const fs::filesystem_error& ex) {
+            return {ErrorCodes::FileRenameFailed,
+                    str::stream() << "failed to create " << path.parent_path().string() << ": "
+                                  << ex.what()};
+        }
+        file.open(path.string().c_str());
+        if (file.bad()) {
+            return {ErrorCodes::FileNotOpen, str::stream() << "failed to open " << path.string()};
+        }
+
+        std::uint64_t offset = 0;
+        while (offset < fileSize) {
+            if (_isShuttingDown()) {
+                return {ErrorCodes::CallbackCanceled, "file copy initial sync shutting down"};
+            }
+            BSONObj readReply;
+            conn->runCommand("admin",
+                             BSON("_readBackupFile" << 1 << "backupId" << backupId.getValue()
+                                                    << "filename"
+                                                    << filename
+                                                    << "offset"
+                                                    << static_cast<long long>(offset)
+                                                    << "length"
+                                                    << static_cast<long long>(
+                                                           _options.chunkSizeBytes)),
+                             readReply);
+            status = getStatusFromCommandResult(readReply);
+            if (!status.isOK()) {
+                return status.withContext(str::stream() << "failed to read backup file "
+                                                        << filename);
+            }
+            int length = 0;
+            const char* data = readReply["data"].binData(length);
+            if (length == 0) {
+                return {ErrorCodes::InitialSyncFailure,
+                        str::stream() << "backup file " << filename << " ended after " << offset
+                                      << " of "
+                                      << fileSize
+                                      << " bytes"};
+            }
+            file.write(offset, data, length);
+            if (file.bad()) {
+                return {ErrorCodes::FileStreamFailed,
+                        str::stream() << "failed to write " << path.string()};
+            }
+            offset += length;
+        }
+        file.fsync();
+        bytesCopied += fileSize;
+        ++filesCopied;
+        LOG(1) << "Copied backup file " << filename << " (" << fileSize << " bytes)";
+    }
+
+    // The marker is only written once every file is durable, so a crash before this point leaves
+    // a staging directory that installStagedFiles() discards.
+    const auto marker = BSON("backupId" << backupId.getValue() << "checkpointTimestamp"
+                                        << checkpointTimestamp
+                                        << "files"
+                                        << static_cast<long long>(filesCopied)
+                                        << "bytes"
+                                        << static_cast<long long>(bytesCopied));
+    status = writeFile(
+        stagingDir / kCompleteMarkerName.toString(), marker.objdata(), marker.objsize());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    log() << "Copied " << filesCopied << " files (" << bytesCopied
+          << " bytes) of the sync source's checkpoint at " << checkpointTimestamp;
+    return checkpointTimestamp;
+}
+
+Status FileCopyInitialSyncer::installStagedFiles(const std::string& dbpath) {
+    const fs::path dbpathDir(dbpath);
+    const auto stagingDir = dbpathDir / kStagingDirName.toString();
+    const auto completeMarker = stagingDir / kCompleteMarkerName.toString();
+    const auto installingMarker = stagingDir / kInstallingMarkerName;
+    try {
+        if (!fs::exists(stagingDir)) {
+            return Status::OK();
+        }
+
+        if (fs::exists(completeMarker)) {
+            log() << "Replacing the data files in " << dbpath
+                  << " with those copied by file copy initial sync";
+            std::vector<fs::path> oldFiles;
+            for (fs::recursive_directory_iterator it(dbpathDir), end; it != end; ++it) {
+                if (it->path() == stagingDir || it->path().filename() == "diagnostic.data") {
+                    it.no_push();
+                    continue;
+                }
+                if (fs::is_regular_file(it->path()) && isStorageEngineFile(it->path())) {
+                    oldFiles.push_back(it->path());
+                }
+            }
+            for (auto&& path : oldFiles) {
+                fs::remove(path);
+            }
+            fs::rename(completeMarker, installingMarker);
+        }
+
+        if (!fs::exists(installingMarker)) {
+            log() << "Removing the files of an interrupted file copy initial sync from "
+                  << stagingDir.string();
+            fs::remove_all(stagingDir);
+            return Status::OK();
+        }
+
+        std::vector<fs::path> stagedFiles;
+        for (fs::recursive_directory_iterator it(stagingDir), end; it != end; ++it) {
+            if (fs::is_regular_file(it->path()) && it->path() != installingMarker) {
+                stagedFiles.push_back(it->path());
+            }
+        }
+        const auto prefixLength = stagingDir.string().size() + 1;
+        for (auto&& path : stagedFiles) {
+            const auto target = dbpathDir / path.string().substr(prefixLength);
+            fs::create_directories(target.parent_path());
+            fs::remove(target);
+            fs::rename(path, target);
+        }
+        fs::remove_all(stagingDir);
+        log() << "Installed " << stagedFiles.size() << " files copied by file copy initial sync";
+    } catch (const fs::filesystem_error& ex) {
+        return {ErrorCodes::FileRenameFailed,
+                str::stream() << "failed to install the files staged in " << stagingDir.string()
+                              << ": "
+                              << ex.what()};
+    }
+    return Status::OK();
+}
+
+}  // namespace repl
+}  // namespace mongo
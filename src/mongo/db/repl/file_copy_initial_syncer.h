@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class DBClientBase;
+
+namespace repl {
+
+/**
+ * Copies the data files of a sync source instead of cloning it document by document.
+ *
+ * The sync source opens a backup cursor (see BackupCursorService), which pins its last checkpoint,
+ * and the files making up that checkpoint together with the journal are copied in chunks into a
+ * staging directory under the dbpath. Once every file is copied a marker file is written. The
+ * staged files replace the node's own data files the next time mongod starts, before the storage
+ * engine opens them (see installStagedFiles()), after which startup recovery replays the copied
+ * oplog from the checkpoint timestamp, as on any restart.
+ *
+ * Copying runs on the syncer's own thread. Failed attempts are retried, possibly against another
+ * sync source, up to the number of attempts passed to startup().
+ */
+class FileCopyInitialSyncer {
+    MONGO_DISALLOW_COPYING(FileCopyInitialSyncer);
+
+public:
+    // Directory under the dbpath the files are copied into.
+    static constexpr StringData kStagingDirName = "initialsync.filecopy"_sd;
+
+    // File written to the staging directory once all files have been copied.
+    static constexpr StringData kCompleteMarkerName = "initialsync.complete"_sd;
+
+    /**
+     * Returns the sync source to copy from, or an empty HostAndPort if none is available yet.
+     */
+    using ChooseSyncSourceFn = stdx::function<HostAndPort()>;
+
+    using ConnectFn =
+        stdx::function<StatusWith<std::unique_ptr<DBClientBase>>(const HostAndPort& source)>;
+
+    /**
+     * Called once, on the syncer's thread, with the checkpoint timestamp of the copied backup or
+     * the error of the last attempt.
+     */
+    using OnCompletionFn = stdx::function<void(const StatusWith<Timestamp>& result)>;
+
+    struct Options {
+        std::string dbpath;
+        std::size_t chunkSizeBytes = 8 * 1024 * 1024;
+        Milliseconds retryWait = Seconds(1);
+    };
+
+    FileCopyInitialSyncer(Options options,
+                          ChooseSyncSourceFn chooseSyncSourceFn,
+                          ConnectFn connectFn,
+                          OnCompletionFn onCompletion);
+
+    ~FileCopyInitialSyncer();
+
+    /**
+     * Starts the syncer's thread.
+     */
+    void startup(int maxAttempts);
+
+    /**
+     * Stops copying after the chunk in progress. The completion callback receives
+     * CallbackCanceled unless the syncer had already finished.
+     */
+    void shutdown();
+
+    /**
+     * Waits for the syncer's thread to exit.
+     */
+    void join();
+
+    /**
+     * Copies the backup of the sync source 'conn' is connected to into the staging directory,
+     * replacing anything staged before. Returns the backup's checkpoint timestamp.
+     */
+    StatusWith<Timestamp> copyFiles(DBClientBase* conn);
+
+    /**
+     * Moves the files of a completed file copy initial sync into 'dbpath', replacing the storage
+     * engine's files there. A staging directory without the completion marker is left over from
+     * an interrupted copy and is removed. Must be called before the storage engine is started.
+     */
+    static Status installStagedFiles(const std::string& dbpath);
+
+private:
+    void _run(int maxAttempts);
+
+    bool _isShuttingDown() const;
+
+    const Options _options;
+    const ChooseSyncSourceFn _chooseSyncSourceFn;
+    const ConnectFn _connectFn;
+    const OnCompletionFn _onCompletion;
+
+    // Protects the members below.
+    mutable stdx::mutex _mutex;
+
+    bool _inShutdown = false;
+
+    stdx::thread _thread;
+};
+
+}  // namespace repl
+}  // namespace mongo
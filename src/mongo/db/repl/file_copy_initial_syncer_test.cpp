@@ -0,0 +1,187 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/file_copy_initial_syncer.h"
+#include "mongo/dbtests/mock/mock_dbclient_connection.h"
+#include "mongo/dbtests/mock/mock_remote_db_server.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/uuid.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+namespace fs = boost::filesystem;
+
+const char kSyncSource[] = "syncsource:27017";
+
+void writeTestFile(const fs::path& path, const std::string& contents) {
+    fs::create_directories(path.parent_path());
+    std::ofstream out(path.string(), std::ios::binary);
+    out << contents;
+}
+
+std::string readTestFile(const fs::path& path) {
+    std::ifstream in(path.string(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+BSONObj makeReadBackupFileReply(const std::string& data) {
+    BSONObjBuilder bob;
+    bob.appendBinData("data", data.size(), BinDataGeneral, data.data());
+    bob.append("ok", 1);
+    return bob.obj();
+}
+
+class FileCopyInitialSyncerTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _dbpath = stdx::make_unique<unittest::TempDir>("file_copy_initial_syncer_test");
+        _server = stdx::make_unique<MockRemoteDBServer>(kSyncSource);
+        _server->setCommandReply("_endBackupCursor", BSON("ok" << 1));
+    }
+
+    fs::path dbpath() const {
+        return fs::path(_dbpath->path());
+    }
+
+    fs::path stagingDir() const {
+        return dbpath() / FileCopyInitialSyncer::kStagingDirName.toString();
+    }
+
+    /**
+     * Makes the sync source serve a backup of 'files', given as name and contents, in chunks of
+     * 'chunkSize' bytes.
+     */
+    void setBackup(const std::vector<std::pair<std::string, std::string>>& files,
+                   std::size_t chunkSize) {
+        BSONArrayBuilder filesBuilder;
+        std::vector<BSONObj> readReplies;
+        for (auto&& file : files) {
+            filesBuilder.append(BSON("filename" << file.first << "fileSize"
+                                                << static_cast<long long>(file.second.size())));
+            for (std::size_t offset = 0; offset < file.second.size(); offset += chunkSize) {
+                readReplies.push_back(
+                    makeReadBackupFileReply(file.second.substr(offset, chunkSize)));
+            }
+        }
+        _server->setCommandReply("_beginBackupCursor",
+                                 BSON("backupId" << UUID::gen() << "checkpointTimestamp"
+                                                 << Timestamp(20, 1)
+                                                 << "files"
+                                                 << filesBuilder.arr()
+                                                 << "ok"
+                                                 << 1));
+        if (!readReplies.empty()) {
+            _server->setCommandReply("_readBackupFile", readReplies);
+        }
+    }
+
+    StatusWith<Timestamp> copyFiles(std::size_t chunkSize) {
+        FileCopyInitialSyncer::Options options;
+        options.dbpath = _dbpath->path();
+        options.chunkSizeBytes = chunkSize;
+        FileCopyInitialSyncer syncer(std::move(options),
+                                     [] { return HostAndPort(kSyncSource); },
+                                     [](const HostAndPort&) {
+                                         return StatusWith<std::unique_ptr<DBClientBase>>(
+                                             ErrorCodes::InternalError, "unused");
+                                     },
+                                     [](const StatusWith<Timestamp>&) {});
+        MockDBClientConnection conn(_server.get());
+        return syncer.copyFiles(&conn);
+    }
+
+    std::unique_ptr<unittest::TempDir> _dbpath;
+    std::unique_ptr<MockRemoteDBServer> _server;
+};
+
+TEST_F(FileCopyInitialSyncerTest, CopyFilesStagesEveryBackupFileInChunks) {
+    const std::size_t chunkSize = 4;
+    setBackup({{"collection-0-123.wt", "abcdefghij"},
+               {"journal/WiredTigerLog.0000000001", "xyz"}},
+              chunkSize);
+
+    auto result = copyFiles(chunkSize);
+    ASSERT_OK(result.getStatus());
+    ASSERT_EQUALS(Timestamp(20, 1), result.getValue());
+
+    ASSERT_EQUALS("abcdefghij", readTestFile(stagingDir() / "collection-0-123.wt"));
+    ASSERT_EQUALS("xyz", readTestFile(stagingDir() / "journal" / "WiredTigerLog.0000000001"));
+    ASSERT_TRUE(
+        fs::exists(stagingDir() / FileCopyInitialSyncer::kCompleteMarkerName.toString()));
+}
+
+TEST_F(FileCopyInitialSyncerTest, CopyFilesRejectsFileNamesOutsideTheDbpath) {
+    setBackup({{"../collection-0-123.wt", "abc"}}, 4);
+
+    ASSERT_EQUALS(ErrorCodes::BadValue, copyFiles(4).getStatus());
+    ASSERT_FALSE(fs::exists(dbpath().parent_path() / "collection-0-123.wt"));
+    ASSERT_FALSE(
+        fs::exists(stagingDir() / FileCopyInitialSyncer::kCompleteMarkerName.toString()));
+}
+
+TEST_F(FileCopyInitialSyncerTest, InstallStagedFilesReplacesStorageEngineFiles) {
+    writeTestFile(dbpath() / "collection-7-456.wt", "old");
+    writeTestFile(dbpath() / "journal" / "WiredTigerLog.0000000005", "old");
+    writeTestFile(dbpath() / "storage.bson", "kept");
+    setBackup({{"collection-0-123.wt", "new"}, {"journal/WiredTigerLog.0000000001", "log"}}, 4);
+    ASSERT_OK(copyFiles(4).getStatus());
+
+    ASSERT_OK(FileCopyInitialSyncer::installStagedFiles(_dbpath->path()));
+
+    ASSERT_FALSE(fs::exists(dbpath() / "collection-7-456.wt"));
+    ASSERT_FALSE(fs::exists(dbpath() / "journal" / "WiredTigerLog.0000000005"));
+    ASSERT_EQUALS("kept", readTestFile(dbpath() / "storage.bson"));
+    ASSERT_EQUALS("new", readTestFile(dbpath() / "collection-0-123.wt"));
+    ASSERT_EQUALS("log", readTestFile(dbpath() / "journal" / "WiredTigerLog.0000000001"));
+    ASSERT_FALSE(fs::exists(stagingDir()));
+}
+
+TEST_F(FileCopyInitialSyncerTest, InstallStagedFilesDiscardsAnIncompleteCopy) {
+    writeTestFile(dbpath() / "collection-7-456.wt", "old");
+    writeTestFile(stagingDir() / "collection-0-123.wt", "partial");
+
+    ASSERT_OK(FileCopyInitialSyncer::installStagedFiles(_dbpath->path()));
+
+    ASSERT_EQUALS("old", readTestFile(dbpath() / "collection-7-456.wt"));
+    ASSERT_FALSE(fs::exists(dbpath() / "collection-0-123.wt"));
+    ASSERT_FALSE(fs::exists(stagingDir()));
+}
+
+}  // namespace
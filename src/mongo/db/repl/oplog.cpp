@@ -36,6 +36,7 @@
 #include <set>
 #include <vector>
 
+#include "mongo/bson/bsonelement_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
@@ -1499,6 +1500,75 @@ Status applyOperation_inlock(OperationContext* opCtx,
     return Status::OK();
 }
 
+Status applyUpdatesAndDeletes_inlock(OperationContext* opCtx,
+                                     Database* db,
+                                     Collection* collection,
+                                     std::vector<const OplogEntry*>::const_iterator begin,
+                                     std::vector<const OplogEntry*>::const_iterator end,
+                                     IncrementOpsAppliedStatsFn incrementOpsAppliedStats) {
+    invariant(collection);
+    invariant(!opCtx->writesAreReplicated());
+    invariant(!opCtx->lockState()->inAWriteUnitOfWork());
+
+    // Each write in the WriteUnitOfWork carries its own timestamp, so a document may only be
+    // written once. The grouping compares _ids without the collection's collation, so check again.
+    BSONElementComparator idComparator(BSONElementComparator::FieldNamesMode::kIgnore,
+                                       collection->getDefaultCollator());
+    auto ids = idComparator.makeBSONEltSet();
+    for (auto it = begin; it != end; ++it) {
+        if (!ids.insert((*it)->getIdElement()).second) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "grouped updates and deletes write the same document "
+                                           "more than once: "
+                                        << redact((*it)->toBSON()));
+        }
+    }
+
+    const auto& nss = collection->ns();
+    UpdateLifecycleImpl updateLifecycle(nss);
+
+    WriteUnitOfWork wuow(opCtx);
+    for (auto it = begin; it != end; ++it) {
+        const auto& entry = **it;
+        LOG(3) << "applying grouped op: " << redact(entry.toBSON());
+
+        uassertStatusOK(opCtx->recoveryUnit()->setTimestamp(entry.getTimestamp()));
+
+        if (entry.getOpType() == OpTypeEnum::kUpdate) {
+            UpdateRequest request(nss);
+            request.setQuery(entry.getObject2()->getField("_id").wrap());
+            request.setUpdates(entry.getObject());
+            request.setUpsert();
+            request.setFromOplogApplication(true);
+            request.setLifecycle(&updateLifecycle);
+
+            UpdateResult ur = update(opCtx, db, request);
+            if (ur.numMatched == 0 && ur.upserted.isEmpty()) {
+                return Status(ErrorCodes::UpdateOperationFailed,
+                              str::stream() << "failed to apply grouped update: "
+                                            << redact(entry.toBSON()));
+            }
+        } else {
+            invariant(entry.getOpType() == OpTypeEnum::kDelete);
+            const auto justOne = true;
+            deleteObjects(opCtx, collection, nss, entry.getObject()["_id"].wrap(), justOne);
+        }
+    }
+    wuow.commit();
+
+    for (auto it = begin; it != end; ++it) {
+        if ((*it)->getOpType() == OpTypeEnum::kUpdate) {
+            replOpCounters.gotUpdate();
+        } else {
+            replOpCounters.gotDelete();
+        }
+        if (incrementOpsAppliedStats) {
+            incrementOpsAppliedStats();
+        }
+    }
+    return Status::OK();
+}
+
 Status applyCommand_inlock(OperationContext* opCtx,
                            const BSONObj& op,
                            OplogApplication::Mode mode) {
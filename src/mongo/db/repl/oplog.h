@@ -72,6 +72,7 @@ public:
 };
 
 namespace repl {
+class OplogEntry;
 class ReplSettings;
 
 struct OplogLink {
@@ -227,6 +228,22 @@ Status applyOperation_inlock(OperationContext* opCtx,
                              OplogApplication::Mode mode,
                              IncrementOpsAppliedStatsFn incrementOpsAppliedStats = {});
 
+/**
+ * Applies the update and delete ops in [begin, end), all on 'collection', in a single
+ * WriteUnitOfWork. Each write is timestamped with its own op's timestamp. Updates are applied as
+ * upserts by _id and deletes are applied by _id.
+ * @param incrementOpsAppliedStats is called for each op once the group has committed.
+ * Returns UpdateOperationFailed, without committing any of the writes, if an update neither
+ * matched nor upserted a document. Returns BadValue, without writing anything, if two of the ops
+ * target the same document.
+ */
+Status applyUpdatesAndDeletes_inlock(OperationContext* opCtx,
+                                     Database* db,
+                                     Collection* collection,
+                                     std::vector<const OplogEntry*>::const_iterator begin,
+                                     std::vector<const OplogEntry*>::const_iterator end,
+                                     IncrementOpsAppliedStatsFn incrementOpsAppliedStats = {});
+
 /**
  * Take a command op and apply it locally
  * Used for applying from an oplog
@@ -0,0 +1,335 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_batch_encoding.h"
+
+#include "mongo/base/data_range_cursor.h"
+#include "mongo/base/data_view.h"
+#include "mongo/base/counter.h"
+#include "mongo/bson/bson_depth.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace repl {
+
+constexpr std::uint8_t OplogBatchEncoder::kVersion;
+constexpr std::uint8_t OplogBatchEncoder::kDictionaryValueFlag;
+
+namespace {
+
+// Top-level oplog entry fields whose values are stored in the batch dictionary.
+const StringData kDictionaryValueFields[] = {"ns"_sd, "ui"_sd};
+
+// Reports how much encoded oplog batches saved over the documents they carried.
+Counter64 encodedBatchCount;
+Counter64 encodedBatchBytes;
+Counter64 encodedBatchRawBytes;
+
+class EncodedBatchesSSM final : public ServerStatusMetric {
+public:
+    EncodedBatchesSSM() : ServerStatusMetric("repl.network.encodedBatches") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const final {
+        BSONObjBuilder bob(b.subobjStart(_leafName));
+        const auto encodedBytes = encodedBatchBytes.get();
+        const auto rawBytes = encodedBatchRawBytes.get();
+        bob.append("num", encodedBatchCount.get());
+        bob.append("encodedBytes", encodedBytes);
+        bob.append("rawBytes", rawBytes);
+        bob.append("compressionRatio",
+                   encodedBytes ? static_cast<double>(rawBytes) / encodedBytes : 0.0);
+        bob.doneFast();
+    }
+} encodedBatchesSSM;
+
+bool isDictionaryValueField(StringData fieldName) {
+    for (auto&& name : kDictionaryValueFields) {
+        if (fieldName == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void appendVarint(BufBuilder* buf, std::uint32_t value) {
+    while (value >= 0x80) {
+        buf->appendUChar(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    buf->appendUChar(static_cast<unsigned char>(value));
+}
+
+Status malformed(StringData reason) {
+    return {ErrorCodes::FailedToParse, str::stream() << "Malformed oplog batch: " << reason};
+}
+
+StatusWith<std::uint32_t> readVarint(ConstDataRangeCursor* cursor) {
+    std::uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        auto byte = cursor->readAndAdvance<std::uint8_t>();
+        if (!byte.isOK()) {
+            return malformed("truncated varint");
+        }
+        value |= static_cast<std::uint32_t>(byte.getValue() & 0x7f) << shift;
+        if (!(byte.getValue() & 0x80)) {
+            return value;
+        }
+    }
+    return malformed("varint too long");
+}
+
+class OplogBatchDecoder {
+public:
+    explicit OplogBatchDecoder(ConstDataRange encoded) : _cursor(encoded) {}
+
+    StatusWith<std::vector<BSONObj>> decode() {
+        auto version = _cursor.readAndAdvance<std::uint8_t>();
+        if (!version.isOK() || version.getValue() != OplogBatchEncoder::kVersion) {
+            return malformed("unsupported version");
+        }
+
+        auto docCount = readVarint(&_cursor);
+        if (!docCount.isOK()) {
+            return docCount.getStatus();
+        }
+        auto dictSize = readVarint(&_cursor);
+        if (!dictSize.isOK()) {
+            return dictSize.getStatus();
+        }
+        if (dictSize.getValue() > _cursor.length() || docCount.getValue() > _cursor.length()) {
+            return malformed("counts exceed batch size");
+        }
+
+        _dictionary.reserve(dictSize.getValue());
+        for (std::uint32_t i = 0; i < dictSize.getValue(); ++i) {
+            auto entry = _readBytes();
+            if (!entry.isOK()) {
+                return entry.getStatus();
+            }
+            _dictionary.push_back(entry.getValue());
+        }
+
+        std::vector<int> offsets;
+        offsets.reserve(docCount.getValue());
+        for (std::uint32_t i = 0; i < docCount.getValue(); ++i) {
+            offsets.push_back(_out.len());
+            auto status = _decodeObject(false, 0);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        if (_cursor.length() != 0) {
+            return malformed("trailing bytes");
+        }
+
+        ConstSharedBuffer buffer(_out.release());
+        std::vector<BSONObj> docs;
+        docs.reserve(offsets.size());
+        for (auto offset : offsets) {
+            const char* data = buffer.get() + offset;
+            const int size = ConstDataView(data).read<LittleEndian<int>>();
+            auto status = validateBSON(data, size, BSONVersion::kLatest);
+            if (!status.isOK()) {
+                return status;
+            }
+            docs.push_back(BSONObj(data).shareOwnershipWith(buffer));
+        }
+        return std::move(docs);
+    }
+
+private:
+    StatusWith<StringData> _readBytes() {
+        auto len = readVarint(&_cursor);
+        if (!len.isOK()) {
+            return len.getStatus();
+        }
+        if (len.getValue() > _cursor.length()) {
+            return malformed("truncated value");
+        }
+        StringData bytes(_cursor.data(), len.getValue());
+        invariant(_cursor.advance(len.getValue()));
+        return bytes;
+    }
+
+    StatusWith<StringData> _readDictionaryEntry() {
+        auto index = readVarint(&_cursor);
+        if (!index.isOK()) {
+            return index.getStatus();
+        }
+        if (index.getValue() >= _dictionary.size()) {
+            return malformed("dictionary index out of range");
+        }
+        return _dictionary[index.getValue()];
+    }
+
+    Status _decodeObject(bool isArray, std::uint32_t depth) {
+        if (depth > BSONDepth::getMaxAllowableDepth()) {
+            return malformed("nesting too deep");
+        }
+
+        const int start = _out.len();
+        _out.skip(sizeof(int));
+
+        for (std::uint32_t arrayIndex = 0;; ++arrayIndex) {
+            auto typeByte = _cursor.readAndAdvance<std::uint8_t>();
+            if (!typeByte.isOK()) {
+                return malformed("truncated document");
+            }
+            std::uint8_t type = typeByte.getValue();
+            if (type == 0) {
+                break;
+            }
+
+            // MinKey is the only BSON type with the high bit set, and it is never stored in the
+            // dictionary since it has no value bytes.
+            const bool fromDictionary = type != static_cast<std::uint8_t>(MinKey) &&
+                (type & OplogBatchEncoder::kDictionaryValueFlag);
+            if (fromDictionary) {
+                type &= ~OplogBatchEncoder::kDictionaryValueFlag;
+            }
+            _out.appendUChar(type);
+
+            if (isArray) {
+                _out.appendStr(std::to_string(arrayIndex));
+            } else {
+                auto name = _readDictionaryEntry();
+                if (!name.isOK()) {
+                    return name.getStatus();
+                }
+                _out.appendStr(name.getValue());
+            }
+
+            if (!fromDictionary && (type == Object || type == Array)) {
+                auto status = _decodeObject(type == Array, depth + 1);
+                if (!status.isOK()) {
+                    return status;
+                }
+                continue;
+            }
+
+            auto value = fromDictionary ? _readDictionaryEntry() : _readBytes();
+            if (!value.isOK()) {
+                return value.getStatus();
+            }
+            _out.appendBuf(value.getValue().rawData(), value.getValue().size());
+        }
+
+        _out.appendChar(EOO);
+        DataView(_out.buf() + start).write<LittleEndian<int>>(_out.len() - start);
+        return Status::OK();
+    }
+
+    ConstDataRangeCursor _cursor;
+    std::vector<StringData> _dictionary;
+    BufBuilder _out;
+};
+
+}  // namespace
+
+void OplogBatchEncoder::append(const BSONObj& doc) {
+    _appendObject(doc, false, true);
+    _rawBytes += doc.objsize();
+    _count++;
+}
+
+std::string OplogBatchEncoder::done() {
+    BufBuilder header;
+    header.appendUChar(kVersion);
+    appendVarint(&header, _count);
+    appendVarint(&header, _dictionary.size());
+    for (auto&& entry : _dictionary) {
+        appendVarint(&header, entry.size());
+        header.appendBuf(entry.data(), entry.size());
+    }
+
+    std::string encoded;
+    encoded.reserve(header.len() + _body.len());
+    encoded.append(header.buf(), header.len());
+    encoded.append(_body.buf(), _body.len());
+    return encoded;
+}
+
+std::uint32_t OplogBatchEncoder::_intern(StringData bytes) {
+    auto it = _dictionaryIndex.find(bytes);
+    if (it != _dictionaryIndex.end()) {
+        return it->second;
+    }
+    const std::uint32_t index = _dictionary.size();
+    _dictionary.push_back(bytes.toString());
+    _dictionaryIndex[bytes] = index;
+    return index;
+}
+
+void OplogBatchEncoder::_appendObject(const BSONObj& obj, bool isArray, bool isTopLevel) {
+    for (auto&& elem : obj) {
+        const auto type = elem.type();
+        const bool isNested = type == Object || type == Array;
+        const bool toDictionary = isTopLevel && !isNested && elem.valuesize() > 0 &&
+            isDictionaryValueField(elem.fieldNameStringData());
+
+        const std::uint8_t typeByte = static_cast<std::uint8_t>(type);
+        _body.appendUChar(toDictionary ? typeByte | kDictionaryValueFlag : typeByte);
+        if (!isArray) {
+            appendVarint(&_body, _intern(elem.fieldNameStringData()));
+        }
+
+        if (isNested) {
+            _appendObject(elem.embeddedObject(), type == Array, false);
+        } else if (toDictionary) {
+            appendVarint(&_body, _intern(StringData(elem.value(), elem.valuesize())));
+        } else {
+            appendVarint(&_body, elem.valuesize());
+            _body.appendBuf(elem.value(), elem.valuesize());
+        }
+    }
+    _body.appendChar(EOO);
+}
+
+StatusWith<std::vector<BSONObj>> decodeOplogBatch(ConstDataRange encoded) {
+    auto docs = OplogBatchDecoder(encoded).decode();
+    if (docs.isOK()) {
+        long long rawBytes = 0;
+        for (auto&& doc : docs.getValue()) {
+            rawBytes += doc.objsize();
+        }
+        encodedBatchCount.increment();
+        encodedBatchBytes.increment(encoded.length());
+        encodedBatchRawBytes.increment(rawBytes);
+    }
+    return docs;
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,113 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/data_range.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Compact encoding for a batch of oplog entries, used by sync sources to answer oplog getMores
+ * from fetchers that ask for it.
+ *
+ * Oplog entries in a batch repeat the same field names ("ts", "t", "h", "op", "ns", "o", ...) and
+ * mostly the same few namespace and collection UUID values. The encoding stores each distinct
+ * field name, and each distinct top-level "ns" and "ui" value, once in a dictionary at the front
+ * of the batch and refers to them by index in the entries. All other values are copied verbatim,
+ * so decoding reproduces the original documents byte for byte.
+ *
+ * Layout (varints are unsigned LEB128):
+ *   version:u8 docCount:varint dictSize:varint { len:varint bytes }* doc*
+ *   doc      := element* 0x00
+ *   element  := type:u8 [nameIndex:varint] value
+ *   value    := doc                                 for Object and Array
+ *             | dictIndex:varint                     when type has kDictionaryValueFlag set
+ *             | len:varint bytes                     otherwise
+ *
+ * Array elements omit the name index since their names are positional.
+ */
+class OplogBatchEncoder {
+public:
+    static constexpr std::uint8_t kVersion = 1;
+    static constexpr std::uint8_t kDictionaryValueFlag = 0x80;
+
+    /**
+     * Adds 'doc' to the batch.
+     */
+    void append(const BSONObj& doc);
+
+    /**
+     * Returns the number of documents appended so far.
+     */
+    std::size_t count() const {
+        return _count;
+    }
+
+    /**
+     * Returns the total BSON size of the documents appended so far. Callers bound batch sizes by
+     * this value so an encoded batch never decodes to more than a regular batch would hold.
+     */
+    std::size_t rawBytes() const {
+        return _rawBytes;
+    }
+
+    /**
+     * Returns the encoded batch. The encoder may not be used afterwards.
+     */
+    std::string done();
+
+private:
+    std::uint32_t _intern(StringData bytes);
+    void _appendObject(const BSONObj& obj, bool isArray, bool isTopLevel);
+
+    StringMap<std::uint32_t> _dictionaryIndex;
+    std::vector<std::string> _dictionary;
+    BufBuilder _body;
+    std::size_t _count = 0;
+    std::size_t _rawBytes = 0;
+};
+
+/**
+ * Decodes a batch produced by OplogBatchEncoder. The returned documents share a single owned
+ * buffer. Returns FailedToParse if 'encoded' is truncated or malformed.
+ */
+StatusWith<std::vector<BSONObj>> decodeOplogBatch(ConstDataRange encoded);
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_batch_encoding.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/uuid.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+BSONObj makeUpdate(int i, const UUID& uuid) {
+    return BSON("ts" << Timestamp(1, i) << "t" << 1LL << "h" << static_cast<long long>(i) << "v"
+                     << 2
+                     << "op"
+                     << "u"
+                     << "ns"
+                     << "test.coll"
+                     << "ui"
+                     << uuid
+                     << "o2"
+                     << BSON("_id" << i)
+                     << "o"
+                     << BSON("$set" << BSON("a" << i << "b"
+                                                << BSON_ARRAY(1 << "two" << BSON("c" << 3)))));
+}
+
+std::vector<BSONObj> roundTrip(const std::vector<BSONObj>& docs, std::size_t* encodedSize) {
+    OplogBatchEncoder encoder;
+    for (auto&& doc : docs) {
+        encoder.append(doc);
+    }
+    ASSERT_EQ(docs.size(), encoder.count());
+    auto encoded = encoder.done();
+    *encodedSize = encoded.size();
+    return unittest::assertGet(decodeOplogBatch(ConstDataRange(encoded.data(), encoded.size())));
+}
+
+void assertBinaryEqual(const std::vector<BSONObj>& expected, const std::vector<BSONObj>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_TRUE(expected[i].binaryEqual(actual[i])) << expected[i] << " != " << actual[i];
+    }
+}
+
+TEST(OplogBatchEncodingTest, RoundTripIsByteIdenticalAndSmaller) {
+    auto uuid = UUID::gen();
+    std::vector<BSONObj> docs;
+    std::size_t rawBytes = 0;
+    for (int i = 0; i < 100; ++i) {
+        docs.push_back(makeUpdate(i, uuid));
+        rawBytes += docs.back().objsize();
+    }
+
+    std::size_t encodedSize = 0;
+    auto decoded = roundTrip(docs, &encodedSize);
+    assertBinaryEqual(docs, decoded);
+    ASSERT_LT(encodedSize, rawBytes);
+}
+
+TEST(OplogBatchEncodingTest, RoundTripPreservesAllTypes) {
+    BSONObjBuilder bob;
+    bob.appendMinKey("min");
+    bob.appendMaxKey("max");
+    bob.appendNull("null");
+    bob.appendUndefined("undefined");
+    bob.append("bool", true);
+    bob.append("double", 1.5);
+    bob.append("decimal", Decimal128("1.25"));
+    bob.append("date", Date_t::fromMillisSinceEpoch(1234));
+    bob.append("oid", OID::gen());
+    bob.appendRegex("regex", "^a", "i");
+    bob.appendCode("code", "function() {}");
+    bob.append("emptyObj", BSONObj());
+    bob.append("emptyArr", BSONArray());
+    bob.append("nested", BSON("a" << BSON("b" << BSON_ARRAY(BSON_ARRAY(1) << BSONObj()))));
+    // A top-level "ns" that is not a string still goes through the dictionary.
+    bob.append("ns", 5);
+    std::vector<BSONObj> docs{bob.obj(), BSONObj(), BSON("ns" << BSONNULL)};
+
+    std::size_t encodedSize = 0;
+    assertBinaryEqual(docs, roundTrip(docs, &encodedSize));
+}
+
+TEST(OplogBatchEncodingTest, EmptyBatch) {
+    std::size_t encodedSize = 0;
+    ASSERT_TRUE(roundTrip({}, &encodedSize).empty());
+}
+
+TEST(OplogBatchEncodingTest, TruncatedBatchFailsToDecode) {
+    OplogBatchEncoder encoder;
+    encoder.append(makeUpdate(1, UUID::gen()));
+    auto encoded = encoder.done();
+    for (std::size_t len = 0; len < encoded.size(); ++len) {
+        ASSERT_EQUALS(ErrorCodes::FailedToParse,
+                      decodeOplogBatch(ConstDataRange(encoded.data(), len)).getStatus());
+    }
+}
+
+TEST(OplogBatchEncodingTest, UnknownVersionFailsToDecode) {
+    OplogBatchEncoder encoder;
+    encoder.append(BSON("a" << 1));
+    auto encoded = encoder.done();
+    encoded[0] = OplogBatchEncoder::kVersion + 1;
+    ASSERT_EQUALS(ErrorCodes::FailedToParse,
+                  decodeOplogBatch(ConstDataRange(encoded.data(), encoded.size())).getStatus());
+}
+
+TEST(OplogBatchEncodingTest, DictionaryIndexOutOfRangeFailsToDecode) {
+    OplogBatchEncoder encoder;
+    encoder.append(BSON("a" << 1));
+    auto encoded = encoder.done();
+    // version, docCount, dictSize, "a" entry (len, byte), then the element type and name index.
+    ASSERT_EQ(NumberInt, encoded[5]);
+    encoded[6] = 1;
+    ASSERT_EQUALS(ErrorCodes::FailedToParse,
+                  decodeOplogBatch(ConstDataRange(encoded.data(), encoded.size())).getStatus());
+}
+
+}  // namespace
@@ -0,0 +1,215 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_buffer_shared_reply.h"
+
+#include <algorithm>
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// Limit the reply buffers held by the oplog buffer to 256MB.
+const std::size_t kOplogBufferSize = 256 * 1024 * 1024;
+
+}  // namespace
+
+OplogBufferSharedReply::OplogBufferSharedReply() : OplogBufferSharedReply(nullptr) {}
+OplogBufferSharedReply::OplogBufferSharedReply(Counters* counters) : _counters(counters) {}
+
+void OplogBufferSharedReply::startup(OperationContext*) {
+    // Update server status metric to reflect the current oplog buffer's max size.
+    if (_counters) {
+        _counters->setMaxSize(getMaxSize());
+    }
+}
+
+void OplogBufferSharedReply::shutdown(OperationContext* opCtx) {
+    clear(opCtx);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _isShutdown = true;
+    _notFullCondition.notify_all();
+}
+
+void OplogBufferSharedReply::pushEvenIfFull(OperationContext*, const Value& value) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _push_inlock(value);
+}
+
+void OplogBufferSharedReply::push(OperationContext*, const Value& value) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _waitForSpace_inlock(lk, std::size_t(value.objsize()));
+    _push_inlock(value);
+}
+
+void OplogBufferSharedReply::pushAllNonBlocking(OperationContext*,
+                                                Batch::const_iterator begin,
+                                                Batch::const_iterator end) {
+    if (begin == end) {
+        return;
+    }
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    std::for_each(begin, end, [this](const Value& value) { _push_inlock(value); });
+}
+
+void OplogBufferSharedReply::waitForSpace(OperationContext*, std::size_t size) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _waitForSpace_inlock(lk, size);
+}
+
+bool OplogBufferSharedReply::isEmpty() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _entries.empty();
+}
+
+std::size_t OplogBufferSharedReply::getMaxSize() const {
+    return kOplogBufferSize;
+}
+
+std::size_t OplogBufferSharedReply::getSize() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _retainedBytes;
+}
+
+std::size_t OplogBufferSharedReply::getCount() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _entries.size();
+}
+
+std::size_t OplogBufferSharedReply::getRetainedBufferCount() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _retainedBuffers.size();
+}
+
+void OplogBufferSharedReply::clear(OperationContext*) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _entries.clear();
+    _retainedBuffers.clear();
+    _retainedBytes = 0;
+    if (_counters) {
+        _counters->clear();
+    }
+    _notFullCondition.notify_all();
+    _notEmptyCondition.notify_all();
+}
+
+bool OplogBufferSharedReply::tryPop(OperationContext*, Value* value) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_entries.empty()) {
+        return false;
+    }
+
+    *value = std::move(_entries.front());
+    _entries.pop_front();
+
+    // Entries are popped in the order they were pushed, so the front entry always belongs to the
+    // front run of retained buffer.
+    invariant(!_retainedBuffers.empty());
+    auto& retained = _retainedBuffers.front();
+    invariant(retained.data == value->sharedBuffer().get());
+    std::size_t releasedBytes = 0;
+    if (--retained.entries == 0) {
+        releasedBytes = retained.bytes;
+        _retainedBytes -= releasedBytes;
+        _retainedBuffers.pop_front();
+        _notFullCondition.notify_one();
+    }
+
+    if (_counters) {
+        _counters->count.decrement(1);
+        _counters->size.decrement(releasedBytes);
+    }
+    return true;
+}
+
+bool OplogBufferSharedReply::waitForData(Seconds waitDuration) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_entries.empty()) {
+        // Returns early if the buffer is cleared, like OplogBufferBlockingQueue.
+        (void)_notEmptyCondition.wait_for(lk, waitDuration.toSystemDuration());
+    }
+    return !_entries.empty();
+}
+
+bool OplogBufferSharedReply::peek(OperationContext*, Value* value) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_entries.empty()) {
+        return false;
+    }
+    *value = _entries.front();
+    return true;
+}
+
+boost::optional<OplogBuffer::Value> OplogBufferSharedReply::lastObjectPushed(
+    OperationContext*) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_entries.empty()) {
+        return boost::none;
+    }
+    return _entries.back();
+}
+
+void OplogBufferSharedReply::_push_inlock(const Value& value) {
+    // Entries that do not already hold a reference to the buffer they point into are copied, so
+    // that every queued entry can be accounted against the buffer it keeps alive.
+    _entries.push_back(value.isOwned() ? value : value.getOwned());
+    const auto& buffer = _entries.back().sharedBuffer();
+
+    std::size_t retainedBytes = 0;
+    if (!_retainedBuffers.empty() && _retainedBuffers.back().data == buffer.get()) {
+        ++_retainedBuffers.back().entries;
+    } else {
+        retainedBytes = std::max(buffer.capacity(), std::size_t(value.objsize()));
+        _retainedBuffers.push_back({buffer.get(), retainedBytes, 1U});
+        _retainedBytes += retainedBytes;
+    }
+
+    if (_counters) {
+        _counters->count.increment(1);
+        _counters->size.increment(retainedBytes);
+    }
+    if (_entries.size() == 1) {
+        _notEmptyCondition.notify_one();
+    }
+}
+
+void OplogBufferSharedReply::_waitForSpace_inlock(stdx::unique_lock<stdx::mutex>& lk,
+                                                  std::size_t size) {
+    // A single buffer larger than the limit is allowed into an empty oplog buffer so that large
+    // replies cannot wedge replication.
+    _notFullCondition.wait(lk, [&] {
+        return _isShutdown || _retainedBuffers.empty() || _retainedBytes + size <= kOplogBufferSize;
+    });
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <deque>
+
+#include "mongo/db/repl/oplog_buffer.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * In memory oplog buffer like OplogBufferBlockingQueue, but which accounts for its size in bytes
+ * of the reply buffers its entries keep alive rather than in the sum of the entries' BSON sizes.
+ *
+ * The OplogFetcher and the OplogStreamReader produce entries that share ownership of the network
+ * reply buffer they were fetched in, so a single small entry keeps its entire reply buffer alive.
+ * Summing BSON sizes underestimates that memory; getSize() and the "size" counter report the
+ * retained size instead. Entries are stored and handed out as BSONObj values, exactly as
+ * OplogBufferBlockingQueue does, and unowned entries are copied on the way in.
+ *
+ * Entries from the same reply buffer are expected to be pushed consecutively. A buffer whose
+ * entries are interleaved with another buffer's is accounted once per run of entries, which
+ * overestimates the memory held but never underestimates it.
+ */
+class OplogBufferSharedReply final : public OplogBuffer {
+public:
+    OplogBufferSharedReply();
+    explicit OplogBufferSharedReply(Counters* counters);
+
+    void startup(OperationContext* opCtx) override;
+    void shutdown(OperationContext* opCtx) override;
+    void pushEvenIfFull(OperationContext* opCtx, const Value& value) override;
+    void push(OperationContext* opCtx, const Value& value) override;
+    void pushAllNonBlocking(OperationContext* opCtx,
+                            Batch::const_iterator begin,
+                            Batch::const_iterator end) override;
+    void waitForSpace(OperationContext* opCtx, std::size_t size) override;
+    bool isEmpty() const override;
+    std::size_t getMaxSize() const override;
+    std::size_t getSize() const override;
+    std::size_t getCount() const override;
+    void clear(OperationContext* opCtx) override;
+    bool tryPop(OperationContext* opCtx, Value* value) override;
+    bool waitForData(Seconds waitDuration) override;
+    bool peek(OperationContext* opCtx, Value* value) override;
+    boost::optional<Value> lastObjectPushed(OperationContext* opCtx) const override;
+
+    /**
+     * Returns the number of distinct reply buffers currently held by this oplog buffer.
+     */
+    std::size_t getRetainedBufferCount() const;
+
+private:
+    /**
+     * A run of consecutive queued entries that all view the same reply buffer.
+     */
+    struct RetainedBuffer {
+        const char* data;
+        std::size_t bytes;
+        std::size_t entries;
+    };
+
+    void _push_inlock(const Value& value);
+
+    void _waitForSpace_inlock(stdx::unique_lock<stdx::mutex>& lk, std::size_t size);
+
+    Counters* const _counters;
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _notEmptyCondition;
+    stdx::condition_variable _notFullCondition;
+
+    // Queued entries, in order. Every entry shares ownership of a reply buffer.
+    std::deque<Value> _entries;
+
+    // Reply buffers pinned by '_entries', in the same order.
+    std::deque<RetainedBuffer> _retainedBuffers;
+
+    // Sum of the allocation sizes of '_retainedBuffers'.
+    std::size_t _retainedBytes = 0;
+
+    bool _isShutdown = false;
+};
+
+}  // namespace repl
+}  // namespace mongo
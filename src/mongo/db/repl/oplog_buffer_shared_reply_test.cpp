@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_buffer_shared_reply.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+/**
+ * Returns a reply containing 'numDocs' documents in a "batch" array, and fills 'docs' with views
+ * into the reply that share ownership of its buffer, the way the OplogFetcher hands them out.
+ */
+BSONObj makeReply(int numDocs, OplogBuffer::Batch* docs) {
+    BSONObjBuilder bob;
+    {
+        BSONArrayBuilder batch(bob.subarrayStart("batch"));
+        for (int i = 0; i < numDocs; ++i) {
+            batch.append(BSON("_id" << i << "op"
+                                    << "i"));
+        }
+    }
+    auto reply = bob.obj();
+    for (auto&& elem : reply["batch"].Obj()) {
+        docs->push_back(elem.Obj().shareOwnershipWith(reply));
+    }
+    return reply;
+}
+
+TEST(OplogBufferSharedReplyTest, EntriesViewingTheSameReplyAreNotCopiedAndAccountedOnce) {
+    OplogBuffer::Counters counters;
+    OplogBufferSharedReply oplogBuffer(&counters);
+    oplogBuffer.startup(nullptr);
+    ASSERT_EQUALS(oplogBuffer.getMaxSize(), std::size_t(counters.maxSize.get()));
+
+    OplogBuffer::Batch docs;
+    auto reply = makeReply(3, &docs);
+    oplogBuffer.pushAllNonBlocking(nullptr, docs.cbegin(), docs.cend());
+
+    ASSERT_EQUALS(3U, oplogBuffer.getCount());
+    ASSERT_EQUALS(1U, oplogBuffer.getRetainedBufferCount());
+    ASSERT_EQUALS(reply.sharedBuffer().capacity(), oplogBuffer.getSize());
+    ASSERT_EQUALS(3U, counters.count.get());
+    ASSERT_EQUALS(reply.sharedBuffer().capacity(), std::size_t(counters.size.get()));
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(oplogBuffer.peek(nullptr, &value));
+    ASSERT_EQUALS(docs[0].objdata(), value.objdata());
+    ASSERT_EQUALS(docs[2].objdata(), oplogBuffer.lastObjectPushed(nullptr)->objdata());
+
+    for (const auto& doc : docs) {
+        ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &value));
+        ASSERT_EQUALS(doc.objdata(), value.objdata());
+    }
+    ASSERT_TRUE(oplogBuffer.isEmpty());
+    ASSERT_FALSE(oplogBuffer.tryPop(nullptr, &value));
+    ASSERT_EQUALS(0U, oplogBuffer.getSize());
+    ASSERT_EQUALS(0U, counters.count.get());
+    ASSERT_EQUALS(0U, counters.size.get());
+}
+
+TEST(OplogBufferSharedReplyTest, ReplyIsReleasedWhenItsLastEntryIsPopped) {
+    OplogBufferSharedReply oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    OplogBuffer::Batch firstDocs;
+    auto firstReply = makeReply(2, &firstDocs);
+    OplogBuffer::Batch secondDocs;
+    auto secondReply = makeReply(1, &secondDocs);
+    oplogBuffer.pushAllNonBlocking(nullptr, firstDocs.cbegin(), firstDocs.cend());
+    oplogBuffer.pushAllNonBlocking(nullptr, secondDocs.cbegin(), secondDocs.cend());
+
+    const auto firstBytes = firstReply.sharedBuffer().capacity();
+    const auto secondBytes = secondReply.sharedBuffer().capacity();
+    ASSERT_EQUALS(2U, oplogBuffer.getRetainedBufferCount());
+    ASSERT_EQUALS(firstBytes + secondBytes, oplogBuffer.getSize());
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &value));
+    ASSERT_EQUALS(firstBytes + secondBytes, oplogBuffer.getSize());
+
+    ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &value));
+    ASSERT_EQUALS(1U, oplogBuffer.getRetainedBufferCount());
+    ASSERT_EQUALS(secondBytes, oplogBuffer.getSize());
+
+    ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &value));
+    ASSERT_EQUALS(0U, oplogBuffer.getRetainedBufferCount());
+    ASSERT_EQUALS(0U, oplogBuffer.getSize());
+}
+
+TEST(OplogBufferSharedReplyTest, UnownedEntryIsCopiedAndAccountedByItsOwnSize) {
+    OplogBufferSharedReply oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    auto owned = BSON("_id" << 1);
+    BSONObj unowned(owned.objdata());
+    ASSERT_FALSE(unowned.isOwned());
+    oplogBuffer.push(nullptr, unowned);
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(oplogBuffer.peek(nullptr, &value));
+    ASSERT_TRUE(value.isOwned());
+    ASSERT_NOT_EQUALS(unowned.objdata(), value.objdata());
+    ASSERT_BSONOBJ_EQ(owned, value);
+    ASSERT_EQUALS(std::size_t(owned.objsize()), oplogBuffer.getSize());
+}
+
+TEST(OplogBufferSharedReplyTest, ClearReleasesAllReplies) {
+    OplogBuffer::Counters counters;
+    OplogBufferSharedReply oplogBuffer(&counters);
+    oplogBuffer.startup(nullptr);
+
+    OplogBuffer::Batch docs;
+    auto reply = makeReply(5, &docs);
+    oplogBuffer.pushAllNonBlocking(nullptr, docs.cbegin(), docs.cend());
+    ASSERT_FALSE(oplogBuffer.isEmpty());
+
+    oplogBuffer.clear(nullptr);
+    ASSERT_TRUE(oplogBuffer.isEmpty());
+    ASSERT_EQUALS(0U, oplogBuffer.getRetainedBufferCount());
+    ASSERT_EQUALS(0U, oplogBuffer.getSize());
+    ASSERT_EQUALS(0U, counters.count.get());
+    ASSERT_EQUALS(0U, counters.size.get());
+    ASSERT_FALSE(oplogBuffer.waitForData(Seconds(0)));
+    ASSERT_FALSE(oplogBuffer.lastObjectPushed(nullptr));
+
+    oplogBuffer.shutdown(nullptr);
+}
+
+}  // namespace
@@ -33,9 +33,13 @@
 #include "mongo/db/repl/oplog_fetcher.h"
 
 #include "mongo/base/counter.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
 #include "mongo/util/assert_util.h"
@@ -65,6 +69,80 @@ ServerStatusMetricField<Counter64> displayBytesRead("repl.network.bytes", &netwo
 
 const Milliseconds maximumAwaitDataTimeoutMS(30 * 1000);
 
+// When enabled, the oplog query runs on a dedicated connection and the sync source streams the
+// batches back instead of waiting for a getMore per batch.
+MONGO_EXPORT_SERVER_PARAMETER(oplogFetcherUsesExhaust, bool, false);
+
+// When enabled, oplog getMores ask the sync source to return each batch in the compact oplog batch
+// encoding, which stores field names and namespaces once per batch. Fetchers go back to plain
+// batches if the sync source does not understand the '$_encodeOplogBatch' getMore field.
+MONGO_EXPORT_SERVER_PARAMETER(oplogFetcherEncodesBatches, bool, false);
+
+const char kEncodeOplogBatchFieldName[] = "$_encodeOplogBatch";
+
+// Time allowed on top of the find and getMore timeouts before the streaming connection gives up.
+const Milliseconds kStreamSocketTimeoutBuffer{5000};
+
+/**
+ * Oplog stream connection over a DBClientConnection.
+ */
+class DBClientOplogStreamConnection final : public OplogStreamReader::Connection {
+public:
+    explicit DBClientOplogStreamConnection(std::unique_ptr<DBClientConnection> conn)
+        : _conn(std::move(conn)) {}
+
+    Status send(Message* request) override {
+        try {
+            _conn->say(*request);
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+        return Status::OK();
+    }
+
+    StatusWith<Message> receive(int32_t responseTo) override {
+        Message reply;
+        try {
+            if (!_conn->recv(reply, responseTo)) {
+                return {ErrorCodes::HostUnreachable,
+                        str::stream() << "network error while streaming the oplog from "
+                                      << _conn->getServerAddress()};
+            }
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+        return std::move(reply);
+    }
+
+    void shutdown() override {
+        _conn->shutdown();
+    }
+
+private:
+    const std::unique_ptr<DBClientConnection> _conn;
+};
+
+StatusWith<std::unique_ptr<OplogStreamReader::Connection>> connectForOplogStream(
+    const HostAndPort& source, Milliseconds socketTimeout) {
+    Client::initThreadIfNotAlready("OplogStreamReader");
+
+    auto conn = stdx::make_unique<DBClientConnection>(
+        false, durationCount<Milliseconds>(socketTimeout) / 1000.0);
+    std::string errmsg;
+    if (!conn->connect(source, "OplogFetcher"_sd, errmsg)) {
+        return {ErrorCodes::HostUnreachable,
+                str::stream() << "failed to connect to " << source << " to stream the oplog: "
+                              << errmsg};
+    }
+    if (!replAuthenticate(conn.get())) {
+        return {ErrorCodes::AuthenticationFailed,
+                str::stream() << "failed to authenticate to " << source
+                              << " to stream the oplog"};
+    }
+    conn->setTags(transport::Session::kKeepOpen);
+    return {stdx::make_unique<DBClientOplogStreamConnection>(std::move(conn))};
+}
+
 /**
  * Calculates await data timeout based on the current replica set configuration.
  */
@@ -86,7 +164,8 @@ BSONObj makeGetMoreCommandObject(const NamespaceString& nss,
                                  CursorId cursorId,
                                  OpTimeWithTerm lastCommittedWithCurrentTerm,
                                  Milliseconds fetcherMaxTimeMS,
-                                 int batchSize) {
+                                 int batchSize,
+                                 bool encodeBatch) {
     BSONObjBuilder cmdBob;
     cmdBob.append("getMore", cursorId);
     cmdBob.append("collection", nss.coll());
@@ -96,6 +175,9 @@ BSONObj makeGetMoreCommandObject(const NamespaceString& nss,
         cmdBob.append("term", lastCommittedWithCurrentTerm.value);
         lastCommittedWithCurrentTerm.opTime.append(&cmdBob, "lastKnownCommittedOpTime");
     }
+    if (encodeBatch) {
+        cmdBob.append(kEncodeOplogBatchFieldName, true);
+    }
     return cmdBob.obj();
 }
 
@@ -338,7 +420,8 @@ OplogFetcher::OplogFetcher(executor::TaskExecutor* executor,
       _dataReplicatorExternalState(dataReplicatorExternalState),
       _enqueueDocumentsFn(enqueueDocumentsFn),
       _awaitDataTimeout(calculateAwaitDataTimeout(config)),
-      _batchSize(batchSize) {
+      _batchSize(batchSize),
+      _encodeBatches(oplogFetcherEncodesBatches.load()) {
 
     invariant(config.isInitialized());
     invariant(enqueueDocumentsFn);
@@ -390,6 +473,33 @@ Milliseconds OplogFetcher::_getGetMoreMaxTime() const {
     return _awaitDataTimeout;
 }
 
+OplogStreamReader::ConnectFn OplogFetcher::_makeStreamConnectFn() const {
+    if (!oplogFetcherUsesExhaust.load()) {
+        return {};
+    }
+    const auto socketTimeout =
+        std::max(_getFindMaxTime(), _getGetMoreMaxTime()) + kStreamSocketTimeoutBuffer;
+    return [ source = _getSource(), socketTimeout ] {
+        return connectForOplogStream(source, socketTimeout);
+    };
+}
+
+bool OplogFetcher::_adjustQueryAfterError(const Status& status) {
+    // Sync sources that predate the compact oplog batch encoding reject the getMore field asking
+    // for it. Restart the query with plain batches.
+    if (status != ErrorCodes::FailedToParse ||
+        status.reason().find(kEncodeOplogBatchFieldName) == std::string::npos) {
+        return false;
+    }
+    if (!_encodeBatches.swap(false)) {
+        return false;
+    }
+    warning() << "Sync source " << _getSource()
+              << " does not support encoded oplog batches, fetching plain batches instead: "
+              << redact(status);
+    return true;
+}
+
 StatusWith<BSONObj> OplogFetcher::_onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) {
 
     // Stop fetching and return on fail point.
@@ -510,7 +620,8 @@ StatusWith<BSONObj> OplogFetcher::_onSuccessfulBatch(const Fetcher::QueryRespons
                                     queryResponse.cursorId,
                                     lastCommittedWithCurrentTerm,
                                     _getGetMoreMaxTime(),
-                                    _batchSize);
+                                    _batchSize,
+                                    _encodeBatches.load());
 }
 }  // namespace repl
 }  // namespace mongo
@@ -38,6 +38,7 @@
 #include "mongo/db/repl/abstract_oplog_fetcher.h"
 #include "mongo/db/repl/data_replicator_external_state.h"
 #include "mongo/db/repl/repl_set_config.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/fail_point_service.h"
 
@@ -152,11 +153,18 @@ private:
 
     Milliseconds _getGetMoreMaxTime() const override;
 
+    OplogStreamReader::ConnectFn _makeStreamConnectFn() const override;
+
     /**
      * This function is run by the AbstractOplogFetcher on a successful batch of oplog entries.
      */
     StatusWith<BSONObj> _onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) override;
 
+    /**
+     * Stops asking for encoded oplog batches if the sync source rejected the request for them.
+     */
+    bool _adjustQueryAfterError(const Status& status) override;
+
     // The metadata object sent with the Fetcher queries.
     const BSONObj _metadataObject;
 
@@ -173,6 +181,10 @@ private:
     const EnqueueDocumentsFn _enqueueDocumentsFn;
     const Milliseconds _awaitDataTimeout;
     const int _batchSize;
+
+    // Whether getMores ask for batches in the compact oplog batch encoding. Cleared if the sync
+    // source does not support it.
+    AtomicWord<bool> _encodeBatches;
 };
 
 }  // namespace repl
@@ -33,6 +33,7 @@
 #include "mongo/db/repl/abstract_oplog_fetcher_test_fixture.h"
 #include "mongo/db/repl/data_replicator_external_state_mock.h"
 #include "mongo/db/repl/oplog_fetcher.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/rpc/metadata.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
@@ -735,6 +736,65 @@ TEST_F(
                       request.cmdObj["lastKnownCommittedOpTime"].Obj())));
 }
 
+TEST_F(OplogFetcherTest, OplogFetcherFallsBackToPlainBatchesIfSyncSourceRejectsEncodedBatches) {
+    auto encodeBatchesParam =
+        ServerParameterSet::getGlobal()->getMap().find("oplogFetcherEncodesBatches")->second;
+    ASSERT_OK(encodeBatchesParam->setFromString("true"));
+    ON_BLOCK_EXIT([encodeBatchesParam] { encodeBatchesParam->setFromString("false").ignore(); });
+
+    // No restarts are allowed, so only the fallback can restart the query.
+    ShutdownState shutdownState;
+    OplogFetcher oplogFetcher(&getExecutor(),
+                              lastFetched,
+                              source,
+                              nss,
+                              _createConfig(),
+                              0,
+                              rbid,
+                              true,
+                              dataReplicatorExternalState.get(),
+                              enqueueDocumentsFn,
+                              stdx::ref(shutdownState),
+                              defaultBatchSize);
+    ASSERT_OK(oplogFetcher.startup());
+
+    CursorId cursorId = 22LL;
+    auto firstEntry = makeNoopOplogEntry(lastFetched);
+    auto secondEntry = makeNoopOplogEntry({{Seconds(456), 0}, lastFetched.opTime.getTerm()}, 200);
+    auto metadataObj = makeOplogQueryMetadataObject(
+        {{Seconds(1000), 0}, lastFetched.opTime.getTerm()}, rbid, 2, 2);
+    processNetworkResponse(
+        {makeCursorResponse(cursorId, {firstEntry, secondEntry}), metadataObj, Milliseconds(0)},
+        true);
+
+    // The sync source does not know the field asking for encoded batches.
+    auto request = processNetworkResponse(BSON("ok" << 0 << "code" << ErrorCodes::FailedToParse
+                                                    << "errmsg"
+                                                    << "Unrecognized field '$_encodeOplogBatch'."),
+                                          true);
+    ASSERT_EQUALS(std::string("getMore"), request.cmdObj.firstElementFieldName());
+    ASSERT_TRUE(request.cmdObj["$_encodeOplogBatch"].trueValue());
+
+    // The query is restarted after the last fetched entry and asks for plain batches.
+    auto thirdEntry = makeNoopOplogEntry({{Seconds(789), 0}, lastFetched.opTime.getTerm()}, 300);
+    request = processNetworkResponse(
+        {makeCursorResponse(cursorId, {secondEntry, thirdEntry}), metadataObj, Milliseconds(0)},
+        true);
+    ASSERT_EQUALS(std::string("find"), request.cmdObj.firstElementFieldName());
+    ASSERT_EQUALS(1U, lastEnqueuedDocuments.size());
+    ASSERT_BSONOBJ_EQ(thirdEntry, lastEnqueuedDocuments[0]);
+
+    auto fourthEntry = makeNoopOplogEntry({{Seconds(900), 0}, lastFetched.opTime.getTerm()}, 400);
+    request = processNetworkResponse(makeCursorResponse(0, {fourthEntry}, false));
+    ASSERT_EQUALS(std::string("getMore"), request.cmdObj.firstElementFieldName());
+    ASSERT_FALSE(request.cmdObj.hasField("$_encodeOplogBatch"));
+    ASSERT_EQUALS(1U, lastEnqueuedDocuments.size());
+    ASSERT_BSONOBJ_EQ(fourthEntry, lastEnqueuedDocuments[0]);
+
+    oplogFetcher.join();
+    ASSERT_OK(shutdownState.getStatus());
+}
+
 TEST_F(OplogFetcherTest, ValidateDocumentsReturnsNoSuchKeyIfTimestampIsNotFoundInAnyDocument) {
     auto firstEntry = makeNoopOplogEntry(Seconds(123), 100);
     auto secondEntry = BSON("o" << BSON("msg"
@@ -0,0 +1,167 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_stream_connection_mock.h"
+
+#include "mongo/db/repl/oplog_batch_encoding.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace repl {
+
+OplogStreamConnectionMock::OplogStreamConnectionMock(Options options)
+    : _options(std::move(options)) {
+    invariant(_options.batchSize > 0);
+}
+
+Status OplogStreamConnectionMock::send(Message* request) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_inShutdown) {
+        return {ErrorCodes::HostUnreachable, "connection closed"};
+    }
+
+    const auto requestId = _nextMessageId++;
+    request->header().setId(requestId);
+    const auto body = OpMsg::parse(*request).body.getOwned();
+    _requests.push_back(body);
+
+    const auto commandName = body.firstElementFieldName();
+    const auto deliverAt = Date_t::now() + _options.oneWayLatency * 2;
+    if (commandName == "find"_sd) {
+        _queueNextBatch_inlock(requestId, deliverAt, true, false, false);
+    } else if (commandName == "getMore"_sd) {
+        const bool encode = body["$_encodeOplogBatch"].trueValue();
+        if (encode && !_options.supportsEncodedBatches) {
+            _queueReply_inlock(requestId,
+                               deliverAt,
+                               BSON("ok" << 0 << "code" << ErrorCodes::FailedToParse << "errmsg"
+                                         << "Unrecognized field '$_encodeOplogBatch'."),
+                               false);
+            _replyQueued.notify_all();
+            return Status::OK();
+        }
+        const bool exhaust =
+            _options.supportsExhaust && OpMsg::isFlagSet(*request, OpMsg::kExhaustSupported);
+        auto responseTo = _queueNextBatch_inlock(requestId, deliverAt, false, exhaust, encode);
+        while (exhaust && _position < _options.oplog.size()) {
+            responseTo = _queueNextBatch_inlock(responseTo, deliverAt, false, exhaust, encode);
+        }
+    } else {
+        return {ErrorCodes::CommandNotFound,
+                str::stream() << "unexpected command sent to mock sync source: " << body};
+    }
+    _replyQueued.notify_all();
+    return Status::OK();
+}
+
+StatusWith<Message> OplogStreamConnectionMock::receive(int32_t responseTo) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (!_inShutdown && (_replies.empty() || Date_t::now() < _replies.front().deliverAt)) {
+        if (_replies.empty()) {
+            _replyQueued.wait(lk);
+        } else {
+            _replyQueued.wait_until(lk, _replies.front().deliverAt.toSystemTimePoint());
+        }
+    }
+    if (_inShutdown) {
+        return {ErrorCodes::HostUnreachable, "connection closed"};
+    }
+
+    auto reply = std::move(_replies.front().message);
+    _replies.pop_front();
+    if (reply.header().getResponseToMsgId() != responseTo) {
+        return {ErrorCodes::ProtocolError, "reply does not answer the expected message"};
+    }
+    return std::move(reply);
+}
+
+void OplogStreamConnectionMock::shutdown() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inShutdown = true;
+    _replyQueued.notify_all();
+}
+
+std::vector<BSONObj> OplogStreamConnectionMock::getRequests() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _requests;
+}
+
+int32_t OplogStreamConnectionMock::_queueNextBatch_inlock(
+    int32_t responseTo, Date_t deliverAt, bool first, bool exhaust, bool encode) {
+    const auto end = std::min(_position + _options.batchSize, _options.oplog.size());
+    const CursorId cursorId = end < _options.oplog.size() ? 1 : 0;
+
+    BSONObjBuilder bob;
+    {
+        BSONObjBuilder cursorBob(bob.subobjStart("cursor"));
+        cursorBob.append("id", cursorId);
+        cursorBob.append("ns", _options.nss.ns());
+        BSONArrayBuilder batchBob(cursorBob.subarrayStart(first ? "firstBatch" : "nextBatch"));
+        OplogBatchEncoder encoder;
+        for (; _position < end; ++_position) {
+            if (encode) {
+                encoder.append(_options.oplog[_position]);
+            } else {
+                batchBob.append(_options.oplog[_position]);
+            }
+        }
+        batchBob.doneFast();
+        if (encode) {
+            const auto encodedBatch = encoder.done();
+            cursorBob.appendBinData(
+                "encodedBatch", encodedBatch.size(), BinDataGeneral, encodedBatch.data());
+        }
+    }
+    bob.append("ok", 1);
+
+    return _queueReply_inlock(responseTo, deliverAt, bob.obj(), exhaust && cursorId);
+}
+
+int32_t OplogStreamConnectionMock::_queueReply_inlock(int32_t responseTo,
+                                                      Date_t deliverAt,
+                                                      BSONObj body,
+                                                      bool moreToCome) {
+    OpMsg reply;
+    reply.body = std::move(body);
+    auto message = reply.serialize();
+    if (moreToCome) {
+        OpMsg::setFlag(&message, OpMsg::kMoreToCome);
+    }
+    const auto replyId = _nextMessageId++;
+    message.header().setId(replyId);
+    message.header().setResponseToMsgId(responseTo);
+    _replies.push_back({deliverAt, std::move(message)});
+    return replyId;
+}
+
+}  // namespace repl
+}  // namespace mongo
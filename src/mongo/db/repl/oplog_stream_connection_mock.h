@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/repl/oplog_stream_reader.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Simulated connection to a sync source serving a fixed oplog over a link with a fixed latency.
+ * Serves `find` and `getMore` commands on an oplog cursor that is exhausted with the last entry.
+ */
+class OplogStreamConnectionMock : public OplogStreamReader::Connection {
+public:
+    struct Options {
+        std::vector<BSONObj> oplog;
+        std::size_t batchSize = 1;
+
+        // Time for a message to reach the other end of the connection.
+        Milliseconds oneWayLatency{0};
+
+        // Whether getMores flagged with OpMsg::kExhaustSupported are streamed.
+        bool supportsExhaust = true;
+
+        // Whether getMores asking for the compact oplog batch encoding get it. If not, they fail
+        // as they do on sync sources that predate the encoding.
+        bool supportsEncodedBatches = true;
+
+        NamespaceString nss = NamespaceString("local.oplog.rs");
+    };
+
+    explicit OplogStreamConnectionMock(Options options);
+
+    Status send(Message* request) override;
+    StatusWith<Message> receive(int32_t responseTo) override;
+    void shutdown() override;
+
+    /**
+     * Returns the bodies of the requests received so far.
+     */
+    std::vector<BSONObj> getRequests() const;
+
+private:
+    struct Reply {
+        Date_t deliverAt;
+        Message message;
+    };
+
+    /**
+     * Queues the next batch of the cursor as a reply to the message with id 'responseTo' and
+     * returns the id of the reply.
+     */
+    int32_t _queueNextBatch_inlock(
+        int32_t responseTo, Date_t deliverAt, bool first, bool exhaust, bool encode);
+
+    /**
+     * Queues 'body' as a reply to the message with id 'responseTo'.
+     */
+    int32_t _queueReply_inlock(int32_t responseTo, Date_t deliverAt, BSONObj body, bool moreToCome);
+
+    const Options _options;
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _replyQueued;
+
+    std::vector<BSONObj> _requests;
+    std::deque<Reply> _replies;
+    std::size_t _position = 0;
+    int32_t _nextMessageId = 1;
+    bool _inShutdown = false;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_stream_reader.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// Number of batches received from a sync source streaming the oplog without a getMore per batch.
+Counter64 streamedBatchesStats;
+ServerStatusMetricField<Counter64> displayStreamedBatches("repl.network.streamedBatches",
+                                                          &streamedBatchesStats);
+
+}  // namespace
+
+OplogStreamReader::OplogStreamReader(ConnectFn connectFn,
+                                     std::string dbname,
+                                     BSONObj findCmdObj,
+                                     BSONObj metadataObj,
+                                     CallbackFn work)
+    : _connectFn(std::move(connectFn)),
+      _dbname(std::move(dbname)),
+      _findCmdObj(findCmdObj.getOwned()),
+      _metadataObj(metadataObj.getOwned()),
+      _work(std::move(work)) {
+    invariant(_connectFn);
+    invariant(_work);
+}
+
+OplogStreamReader::~OplogStreamReader() {
+    shutdown();
+    join();
+}
+
+void OplogStreamReader::startup() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(!_thread.joinable());
+    _thread = stdx::thread([this] { _run(); });
+}
+
+void OplogStreamReader::shutdown() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inShutdown = true;
+    if (_connection) {
+        _connection->shutdown();
+    }
+}
+
+void OplogStreamReader::join() {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+bool OplogStreamReader::isStreaming() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _streaming;
+}
+
+std::string OplogStreamReader::toString() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return str::stream() << "OplogStreamReader -- cmd:" << _findCmdObj
+                         << " streaming: " << _streaming << " shutting down: " << _inShutdown;
+}
+
+StatusWith<int32_t> OplogStreamReader::_send(const BSONObj& cmdObj, bool exhaust) {
+    auto request = OpMsgRequest::fromDBAndBody(_dbname, cmdObj, _metadataObj).serialize();
+    if (exhaust) {
+        OpMsg::setFlag(&request, OpMsg::kExhaustSupported);
+    }
+    auto status = _connection->send(&request);
+    if (!status.isOK()) {
+        return status;
+    }
+    return request.header().getId();
+}
+
+Fetcher::QueryResponseStatus OplogStreamReader::_parseReply(const Message& reply, bool first) {
+    if (reply.operation() != dbMsg) {
+        return {ErrorCodes::ProtocolError,
+                str::stream() << "unexpected reply to an oplog query: "
+                              << networkOpToString(reply.operation())};
+    }
+
+    // The batch and metadata share the reply's buffer instead of being copied out of it.
+    auto body = OpMsg::parseOwned(reply).body;
+    auto cursorResponse = CursorResponse::parseFromBSON(body);
+    if (!cursorResponse.isOK()) {
+        return cursorResponse.getStatus();
+    }
+
+    Fetcher::QueryResponse batch;
+    batch.cursorId = cursorResponse.getValue().getCursorId();
+    batch.nss = cursorResponse.getValue().getNSS();
+    batch.documents = cursorResponse.getValue().releaseBatch();
+    for (auto& doc : batch.documents) {
+        doc.shareOwnershipWith(reply.sharedBuffer());
+    }
+
+    // CursorResponse does not know about batches in the compact oplog batch encoding. Pass them on
+    // like the Fetcher does, so that AbstractOplogFetcher decodes them.
+    const auto encodedBatchElement = body["cursor"]["encodedBatch"];
+    if (!encodedBatchElement.eoo()) {
+        if (encodedBatchElement.type() != BinData) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "'cursor.encodedBatch' field must be binary data: "
+                                  << redact(body)};
+        }
+        batch.otherFields.encodedBatch = encodedBatchElement.wrap();
+    }
+    batch.otherFields.metadata = std::move(body);
+    batch.first = first;
+    return batch;
+}
+
+void OplogStreamReader::_run() {
+    auto stop = [this](Status status) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_inShutdown) {
+                status = {ErrorCodes::CallbackCanceled,
+                          str::stream() << "oplog stream reader shut down: " << status.reason()};
+            }
+        }
+        _work(status, nullptr);
+    };
+
+    auto swConnection = _connectFn();
+    if (!swConnection.isOK()) {
+        stop(swConnection.getStatus());
+        return;
+    }
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _connection = std::move(swConnection.getValue());
+        if (_inShutdown) {
+            _connection->shutdown();
+        }
+    }
+
+    // Closing the connection is the only way to stop a sync source from streaming.
+    ON_BLOCK_EXIT([this] {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _connection->shutdown();
+        _streaming = false;
+    });
+
+    BSONObj cmdObj = _findCmdObj;
+    bool first = true;
+    bool streaming = false;
+    int32_t responseTo = 0;
+    while (true) {
+        Timer timer;
+        if (!streaming) {
+            auto swRequestId = _send(cmdObj, !first);
+            if (!swRequestId.isOK()) {
+                stop(swRequestId.getStatus());
+                return;
+            }
+            responseTo = swRequestId.getValue();
+        }
+
+        auto swReply = _connection->receive(responseTo);
+        if (!swReply.isOK()) {
+            stop(swReply.getStatus());
+            return;
+        }
+        const auto& reply = swReply.getValue();
+
+        auto batch = _parseReply(reply, first);
+        if (!batch.isOK()) {
+            stop(batch.getStatus());
+            return;
+        }
+        batch.getValue().elapsedMillis = Milliseconds(timer.millis());
+
+        if (streaming) {
+            streamedBatchesStats.increment();
+        }
+        streaming = OpMsg::isFlagSet(reply, OpMsg::kMoreToCome);
+        responseTo = reply.header().getId();
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _streaming = streaming;
+        }
+
+        if (!batch.getValue().cursorId) {
+            _work(batch, nullptr);
+            return;
+        }
+
+        BSONObjBuilder getMoreBob;
+        _work(batch, &getMoreBob);
+        cmdObj = getMoreBob.obj();
+        if (cmdObj.isEmpty()) {
+            return;
+        }
+        first = false;
+    }
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/client/fetcher.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/rpc/message.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Runs an oplog query on a single connection to the sync source and has the sync source stream
+ * the batches back. The `find` is followed by a single `getMore` flagged with
+ * OpMsg::kExhaustSupported, which the sync source keeps running, sending each batch as soon as it
+ * is available. This saves a round trip per batch. Sync sources that do not stream reply without
+ * the moreToCome flag, in which case the reader falls back to sending a `getMore` per batch.
+ *
+ * Batches are passed to the callback on the reader's own thread, one at a time and in order, with
+ * the same arguments a Fetcher callback receives. The next reply is not read from the connection
+ * until the callback returns, so a slow consumer fills up the socket buffers and stalls the sync
+ * source rather than having batches pile up in memory.
+ *
+ * The reader stops after the last batch, after an error (which is passed to the callback), when
+ * the callback leaves the `getMore` builder empty, or on shutdown().
+ */
+class OplogStreamReader {
+    MONGO_DISALLOW_COPYING(OplogStreamReader);
+
+public:
+    /**
+     * Connection to the sync source.
+     */
+    class Connection {
+    public:
+        virtual ~Connection() = default;
+
+        /**
+         * Sends 'request', setting its message id.
+         */
+        virtual Status send(Message* request) = 0;
+
+        /**
+         * Waits for the next message, which must answer the message with id 'responseTo'.
+         */
+        virtual StatusWith<Message> receive(int32_t responseTo) = 0;
+
+        /**
+         * Makes pending and future send() and receive() calls fail. May be called from any thread.
+         */
+        virtual void shutdown() = 0;
+    };
+
+    using ConnectFn = stdx::function<StatusWith<std::unique_ptr<Connection>>()>;
+
+    /**
+     * Called for each batch. 'getMoreBob' is null for the last batch and on errors. Otherwise the
+     * callback appends the `getMore` command to send next, or leaves it empty to stop the reader.
+     */
+    using CallbackFn = stdx::function<void(const Fetcher::QueryResponseStatus& result,
+                                           BSONObjBuilder* getMoreBob)>;
+
+    OplogStreamReader(ConnectFn connectFn,
+                      std::string dbname,
+                      BSONObj findCmdObj,
+                      BSONObj metadataObj,
+                      CallbackFn work);
+
+    ~OplogStreamReader();
+
+    /**
+     * Starts the reader's thread.
+     */
+    void startup();
+
+    /**
+     * Closes the connection. The callback is passed CallbackCanceled unless the reader had already
+     * stopped.
+     */
+    void shutdown();
+
+    /**
+     * Waits for the reader's thread to exit.
+     */
+    void join();
+
+    /**
+     * Returns true if the sync source has been streaming batches without `getMore` requests.
+     */
+    bool isStreaming() const;
+
+    std::string toString() const;
+
+private:
+    void _run();
+
+    /**
+     * Sends 'cmdObj' and returns the id of the request.
+     */
+    StatusWith<int32_t> _send(const BSONObj& cmdObj, bool exhaust);
+
+    /**
+     * Parses a reply into the batch passed to the callback.
+     */
+    Fetcher::QueryResponseStatus _parseReply(const Message& reply, bool first);
+
+    const ConnectFn _connectFn;
+    const std::string _dbname;
+    const BSONObj _findCmdObj;
+    const BSONObj _metadataObj;
+    const CallbackFn _work;
+
+    // Protects the members below.
+    mutable stdx::mutex _mutex;
+
+    std::unique_ptr<Connection> _connection;
+    bool _inShutdown = false;
+    bool _streaming = false;
+
+    stdx::thread _thread;
+};
+
+}  // namespace repl
+}  // namespace mongo
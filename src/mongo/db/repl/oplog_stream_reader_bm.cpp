@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/repl/oplog_stream_connection_mock.h"
+#include "mongo/db/repl/oplog_stream_reader.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const int kNumEntries = 1000;
+const std::size_t kBatchSize = 50;
+
+/**
+ * Measures how long a secondary takes to catch up on a burst of oplog entries already on its sync
+ * source, over a link with a one-way latency of state.range(0) milliseconds. With getMore per
+ * batch, the catch-up time grows with the number of batches times the round trip time; with a
+ * streaming sync source, it is close to a single round trip.
+ */
+void BM_CatchUp(benchmark::State& state, bool supportsExhaust) {
+    OplogStreamConnectionMock::Options options;
+    for (int i = 0; i < kNumEntries; i++) {
+        options.oplog.push_back(BSON("ts" << Timestamp(1, i + 1) << "h" << 1LL << "op"
+                                          << "i"
+                                          << "o"
+                                          << BSON("_id" << i)));
+    }
+    options.batchSize = kBatchSize;
+    options.oneWayLatency = Milliseconds(state.range(0));
+    options.supportsExhaust = supportsExhaust;
+
+    std::size_t numBatches = 0;
+    for (auto _ : state) {
+        Status status = Status::OK();
+        OplogStreamReader reader(
+            [&options]() -> StatusWith<std::unique_ptr<OplogStreamReader::Connection>> {
+                return {stdx::make_unique<OplogStreamConnectionMock>(options)};
+            },
+            "local",
+            BSON("find"
+                 << "oplog.rs"),
+            BSONObj(),
+            [&](const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob) {
+                if (!result.isOK()) {
+                    status = result.getStatus();
+                    return;
+                }
+                ++numBatches;
+                if (getMoreBob) {
+                    getMoreBob->append("getMore", result.getValue().cursorId);
+                    getMoreBob->append("collection", "oplog.rs");
+                }
+            });
+        reader.startup();
+        reader.join();
+        invariant(status);
+    }
+    state.counters["batches"] = double(numBatches) / state.iterations();
+    state.SetItemsProcessed(state.iterations() * kNumEntries);
+}
+
+BENCHMARK_CAPTURE(BM_CatchUp, getMore, false)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(50)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_CatchUp, exhaust, true)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(50)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
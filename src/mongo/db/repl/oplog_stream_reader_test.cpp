@@ -0,0 +1,264 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_batch_encoding.h"
+#include "mongo/db/repl/oplog_stream_connection_mock.h"
+#include "mongo/db/repl/oplog_stream_reader.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+std::vector<BSONObj> makeOplog(int numEntries) {
+    std::vector<BSONObj> oplog;
+    for (int i = 0; i < numEntries; i++) {
+        oplog.push_back(BSON("ts" << Timestamp(1, i + 1) << "h" << 1LL << "op"
+                                  << "n"));
+    }
+    return oplog;
+}
+
+class OplogStreamReaderTest : public unittest::Test {
+protected:
+    /**
+     * Reads the whole oplog of a mock sync source. The callback asks for the next batch until
+     * 'maxBatches' have been received, in the compact oplog batch encoding if 'encodeBatches' is
+     * set.
+     */
+    Status readOplog(OplogStreamConnectionMock::Options options,
+                     std::size_t maxBatches = 1000,
+                     bool encodeBatches = false) {
+        _connection = std::make_shared<OplogStreamConnectionMock>(std::move(options));
+        Status finalStatus = Status::OK();
+        OplogStreamReader reader(
+            [this]() -> StatusWith<std::unique_ptr<OplogStreamReader::Connection>> {
+                return {stdx::make_unique<ConnectionProxy>(_connection)};
+            },
+            "local",
+            BSON("find"
+                 << "oplog.rs"),
+            BSON("$replData" << 1),
+            [&](const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob) {
+                if (!result.isOK()) {
+                    finalStatus = result.getStatus();
+                    return;
+                }
+                _batches.push_back(result.getValue());
+                if (getMoreBob && _batches.size() < maxBatches) {
+                    getMoreBob->append("getMore", result.getValue().cursorId);
+                    getMoreBob->append("collection", "oplog.rs");
+                    if (encodeBatches) {
+                        getMoreBob->append("$_encodeOplogBatch", true);
+                    }
+                }
+            });
+        reader.startup();
+        reader.join();
+        return finalStatus;
+    }
+
+    /**
+     * Hands the reader a connection that outlives it, so the requests can be inspected.
+     */
+    class ConnectionProxy : public OplogStreamReader::Connection {
+    public:
+        explicit ConnectionProxy(std::shared_ptr<OplogStreamConnectionMock> connection)
+            : _connection(std::move(connection)) {}
+
+        Status send(Message* request) override {
+            return _connection->send(request);
+        }
+        StatusWith<Message> receive(int32_t responseTo) override {
+            return _connection->receive(responseTo);
+        }
+        void shutdown() override {
+            _connection->shutdown();
+        }
+
+    private:
+        std::shared_ptr<OplogStreamConnectionMock> _connection;
+    };
+
+    std::vector<BSONObj> getDocuments() const {
+        std::vector<BSONObj> documents;
+        for (auto&& batch : _batches) {
+            documents.insert(documents.end(), batch.documents.begin(), batch.documents.end());
+            if (!batch.otherFields.encodedBatch.isEmpty()) {
+                int len = 0;
+                const char* data = batch.otherFields.encodedBatch.firstElement().binData(len);
+                auto decoded = unittest::assertGet(decodeOplogBatch(ConstDataRange(data, len)));
+                documents.insert(documents.end(), decoded.begin(), decoded.end());
+            }
+        }
+        return documents;
+    }
+
+    std::vector<Fetcher::QueryResponse> _batches;
+    std::shared_ptr<OplogStreamConnectionMock> _connection;
+};
+
+TEST_F(OplogStreamReaderTest, SyncSourceStreamsBatchesAfterFirstGetMore) {
+    OplogStreamConnectionMock::Options options;
+    options.oplog = makeOplog(10);
+    options.batchSize = 2;
+
+    ASSERT_OK(readOplog(options));
+
+    ASSERT_EQUALS(5U, _batches.size());
+    ASSERT_TRUE(_batches.front().first);
+    ASSERT_FALSE(_batches.back().first);
+    ASSERT_EQUALS(0, _batches.back().cursorId);
+
+    auto documents = getDocuments();
+    ASSERT_EQUALS(options.oplog.size(), documents.size());
+    for (std::size_t i = 0; i < documents.size(); i++) {
+        ASSERT_BSONOBJ_EQ(options.oplog[i], documents[i]);
+    }
+
+    // Only the find and the first getMore are sent. Both carry the metadata.
+    auto requests = _connection->getRequests();
+    ASSERT_EQUALS(2U, requests.size());
+    ASSERT_EQUALS("find"_sd, requests[0].firstElementFieldName());
+    ASSERT_EQUALS("getMore"_sd, requests[1].firstElementFieldName());
+    for (auto&& request : requests) {
+        ASSERT_EQUALS(1, request["$replData"].numberInt());
+        ASSERT_EQUALS("local"_sd, request["$db"].valueStringData());
+    }
+}
+
+TEST_F(OplogStreamReaderTest, FallsBackToGetMorePerBatchWhenSyncSourceDoesNotStream) {
+    OplogStreamConnectionMock::Options options;
+    options.oplog = makeOplog(10);
+    options.batchSize = 2;
+    options.supportsExhaust = false;
+
+    ASSERT_OK(readOplog(options));
+
+    ASSERT_EQUALS(5U, _batches.size());
+    ASSERT_EQUALS(options.oplog.size(), getDocuments().size());
+    ASSERT_EQUALS(5U, _connection->getRequests().size());
+}
+
+TEST_F(OplogStreamReaderTest, StreamedEncodedBatchesArePassedToCallback) {
+    OplogStreamConnectionMock::Options options;
+    options.oplog = makeOplog(10);
+    options.batchSize = 2;
+
+    ASSERT_OK(readOplog(options, 1000, true));
+
+    // The find returns a plain batch. The streamed getMore batches only arrive encoded.
+    ASSERT_EQUALS(5U, _batches.size());
+    ASSERT_TRUE(_batches.front().otherFields.encodedBatch.isEmpty());
+    for (std::size_t i = 1; i < _batches.size(); i++) {
+        ASSERT_TRUE(_batches[i].documents.empty());
+        ASSERT_FALSE(_batches[i].otherFields.encodedBatch.isEmpty());
+    }
+
+    auto documents = getDocuments();
+    ASSERT_EQUALS(options.oplog.size(), documents.size());
+    for (std::size_t i = 0; i < documents.size(); i++) {
+        ASSERT_BSONOBJ_EQ(options.oplog[i], documents[i]);
+    }
+
+    auto requests = _connection->getRequests();
+    ASSERT_EQUALS(2U, requests.size());
+    ASSERT_TRUE(requests[1]["$_encodeOplogBatch"].trueValue());
+}
+
+TEST_F(OplogStreamReaderTest, RejectedEncodedBatchRequestIsPassedToCallback) {
+    OplogStreamConnectionMock::Options options;
+    options.oplog = makeOplog(10);
+    options.batchSize = 2;
+    options.supportsEncodedBatches = false;
+
+    auto status = readOplog(options, 1000, true);
+    ASSERT_EQUALS(ErrorCodes::FailedToParse, status);
+    ASSERT_STRING_CONTAINS(status.reason(), "$_encodeOplogBatch");
+    ASSERT_EQUALS(1U, _batches.size());
+}
+
+TEST_F(OplogStreamReaderTest, StopsWhenCallbackDoesNotAskForMore) {
+    OplogStreamConnectionMock::Options options;
+    options.oplog = makeOplog(10);
+    options.batchSize = 2;
+
+    ASSERT_OK(readOplog(options, 1));
+
+    ASSERT_EQUALS(1U, _batches.size());
+    ASSERT_EQUALS(1U, _connection->getRequests().size());
+}
+
+TEST_F(OplogStreamReaderTest, ConnectionFailureIsPassedToCallback) {
+    Status finalStatus = Status::OK();
+    OplogStreamReader reader(
+        []() -> StatusWith<std::unique_ptr<OplogStreamReader::Connection>> {
+            return Status(ErrorCodes::HostUnreachable, "no route to host");
+        },
+        "local",
+        BSON("find"
+             << "oplog.rs"),
+        BSONObj(),
+        [&](const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob) {
+            ASSERT_FALSE(getMoreBob);
+            finalStatus = result.getStatus();
+        });
+    reader.startup();
+    reader.join();
+    ASSERT_EQUALS(ErrorCodes::HostUnreachable, finalStatus);
+}
+
+TEST_F(OplogStreamReaderTest, ShutdownCancelsPendingRead) {
+    OplogStreamConnectionMock::Options options;
+    options.oplog = makeOplog(10);
+    options.oneWayLatency = Hours(1);
+
+    Status finalStatus = Status::OK();
+    OplogStreamReader reader(
+        [&options]() -> StatusWith<std::unique_ptr<OplogStreamReader::Connection>> {
+            return {stdx::make_unique<OplogStreamConnectionMock>(options)};
+        },
+        "local",
+        BSON("find"
+             << "oplog.rs"),
+        BSONObj(),
+        [&](const Fetcher::QueryResponseStatus& result, BSONObjBuilder* getMoreBob) {
+            finalStatus = result.getStatus();
+        });
+    reader.startup();
+    reader.shutdown();
+    reader.join();
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled, finalStatus);
+}
+
+}  // namespace
@@ -64,7 +64,7 @@
 #include "mongo/db/repl/noop_writer.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplog_applier_impl.h"
-#include "mongo/db/repl/oplog_buffer_blocking_queue.h"
+#include "mongo/db/repl/oplog_buffer_shared_reply.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_process.h"
@@ -136,7 +136,7 @@ MONGO_EXPORT_SERVER_PARAMETER(oplogFetcherMaxFetcherRestarts, int, 3)
 // The count of items in the buffer
 OplogBuffer::Counters bufferGauge;
 ServerStatusMetricField<Counter64> displayBufferCount("repl.buffer.count", &bufferGauge.count);
-// The size (bytes) of items in the buffer
+// The size (bytes) of the reply buffers retained by items in the buffer
 ServerStatusMetricField<Counter64> displayBufferSize("repl.buffer.sizeBytes", &bufferGauge.size);
 // The max size (bytes) of the buffer. If the buffer does not have a size constraint, this is
 // set to 0.
@@ -226,9 +226,9 @@ void ReplicationCoordinatorExternalStateImpl::startSteadyStateReplication(
         return;
 
     invariant(replCoord);
-    _oplogBuffer = std::make_unique<OplogBufferBlockingQueue>(&bufferGauge);
+    _oplogBuffer = std::make_unique<OplogBufferSharedReply>(&bufferGauge);
 
-    // No need to log OplogBuffer::startup because the blocking queue implementation
+    // No need to log OplogBuffer::startup because the in memory implementation
     // does not start any threads or access the storage layer.
     _oplogBuffer->startup(opCtx);
 
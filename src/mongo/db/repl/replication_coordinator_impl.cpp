@@ -36,6 +36,7 @@
 #include <limits>
 
 #include "mongo/base/status.h"
+#include "mongo/client/dbclientinterface.h"
 #include "mongo/client/fetcher.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
@@ -49,9 +50,11 @@
 #include "mongo/db/repl/check_quorum_for_config_change.h"
 #include "mongo/db/repl/data_replicator_external_state_initial_sync.h"
 #include "mongo/db/repl/elect_cmd_runner.h"
+#include "mongo/db/repl/file_copy_initial_syncer.h"
 #include "mongo/db/repl/freshness_checker.h"
 #include "mongo/db/repl/is_master_response.h"
 #include "mongo/db/repl/last_vote.h"
+#include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/repl_set_config_checks.h"
@@ -70,6 +73,7 @@
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/executor/connection_pool_stats.h"
@@ -79,6 +83,7 @@
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -108,6 +113,10 @@ const OperationContext::Decoration<bool> alwaysAllowNonLocalWrites =
 
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncAttempts, int, 10);
 
+// Copies the data files of the sync source during initial sync instead of cloning its documents.
+// Requires the WiredTiger storage engine on both nodes.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncUsesFileCopy, bool, false);
+
 // Number of seconds between noop writer writes.
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(periodicNoopIntervalSecs, int, 10);
 
@@ -224,6 +233,7 @@ void ReplicationCoordinatorImpl::CallbackWaiter::notify_inlock() {
 }
 
 
+template <typename WaiterListType>
 class ReplicationCoordinatorImpl::WaiterGuard {
 public:
     /**
@@ -237,7 +247,7 @@ public:
      * _list is guarded by ReplicationCoordinatorImpl::_mutex, thus it is illegal to construct one
      * of these without holding _mutex
      */
-    WaiterGuard(WaiterList* list, Waiter* waiter) : _list(list), _waiter(waiter) {
+    WaiterGuard(WaiterListType* list, Waiter* waiter) : _list(list), _waiter(waiter) {
         list->add_inlock(_waiter);
     }
 
@@ -246,7 +256,7 @@ public:
     }
 
 private:
-    WaiterList* _list;
+    WaiterListType* _list;
     Waiter* _waiter;
 };
 
@@ -326,6 +336,20 @@ InitialSyncerOptions createInitialSyncerOptions(
     options.oplogFetcherMaxFetcherRestarts = externalState->getOplogFetcherMaxFetcherRestarts();
     return options;
 }
+
+StatusWith<std::unique_ptr<DBClientBase>> connectForFileCopy(const HostAndPort& source) {
+    auto conn = stdx::make_unique<DBClientConnection>(true /* autoReconnect */);
+    std::string errmsg;
+    if (!conn->connect(source, "FileCopyInitialSyncer"_sd, errmsg)) {
+        return {ErrorCodes::HostUnreachable,
+                str::stream() << "failed to connect to " << source << ": " << errmsg};
+    }
+    if (!replAuthenticate(conn.get())) {
+        return {ErrorCodes::AuthenticationFailed,
+                str::stream() << "failed to authenticate to " << source};
+    }
+    return {std::move(conn)};
+}
 }  // namespace
 
 ReplicationCoordinatorImpl::ReplicationCoordinatorImpl(
@@ -630,9 +654,11 @@ void ReplicationCoordinatorImpl::_finishLoadLocalConfig(
 
 void ReplicationCoordinatorImpl::_stopDataReplication(OperationContext* opCtx) {
     std::shared_ptr<InitialSyncer> initialSyncerCopy;
+    std::shared_ptr<FileCopyInitialSyncer> fileCopyInitialSyncerCopy;
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         _initialSyncer.swap(initialSyncerCopy);
+        _fileCopyInitialSyncer.swap(fileCopyInitialSyncerCopy);
     }
     if (initialSyncerCopy) {
         LOG(1)
@@ -644,6 +670,10 @@ void ReplicationCoordinatorImpl::_stopDataReplication(OperationContext* opCtx) {
         initialSyncerCopy.reset();
         // Do not return here, fall through.
     }
+    if (fileCopyInitialSyncerCopy) {
+        fileCopyInitialSyncerCopy->shutdown();
+        fileCopyInitialSyncerCopy.reset();
+    }
     LOG(1) << "ReplicationCoordinatorImpl::_stopDataReplication calling "
               "ReplCoordExtState::stopDataReplication.";
     _externalState->stopDataReplication(opCtx);
@@ -671,6 +701,15 @@ void ReplicationCoordinatorImpl::_startDataReplication(OperationContext* opCtx,
         return;
     }
 
+    if (initialSyncUsesFileCopy) {
+        if (storageGlobalParams.engine == "wiredTiger") {
+            _startFileCopyInitialSync();
+            return;
+        }
+        warning() << "initialSyncUsesFileCopy requires the wiredTiger storage engine, not "
+                  << storageGlobalParams.engine << "; cloning the sync source's documents instead";
+    }
+
     auto onCompletion = [this, startCompleted](const StatusWith<OpTimeWithHash>& status) {
         {
             stdx::lock_guard<stdx::mutex> lock(_mutex);
@@ -738,6 +777,46 @@ void ReplicationCoordinatorImpl::_startDataReplication(OperationContext* opCtx,
     }
 }
 
+void ReplicationCoordinatorImpl::_startFileCopyInitialSync() {
+    auto onCompletion = [this](const StatusWith<Timestamp>& result) {
+        if (result == ErrorCodes::CallbackCanceled) {
+            log() << "File copy initial sync has been cancelled: " << result.getStatus();
+            return;
+        }
+        if (!result.isOK()) {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            if (_inShutdown) {
+                log() << "File copy initial sync failed during shutdown due to "
+                      << result.getStatus();
+                return;
+            }
+            error() << "File copy initial sync failed, shutting down now. Restart the server to "
+                       "attempt a new initial sync.";
+            fassertFailedWithStatusNoTrace(50868, result.getStatus());
+        }
+
+        log() << "File copy initial sync copied the sync source's checkpoint at "
+              << result.getValue() << ". Shutting down; the copied files are installed and the "
+              << "oplog is replayed from the checkpoint when the server is restarted.";
+        // Shutting down joins the syncer's thread, which is the thread running this callback.
+        stdx::thread([] { exitCleanly(EXIT_CLEAN); }).detach();
+    };
+
+    FileCopyInitialSyncer::Options options;
+    options.dbpath = storageGlobalParams.dbpath;
+    auto syncer = std::make_shared<FileCopyInitialSyncer>(
+        std::move(options),
+        [this] { return chooseNewSyncSource(OpTime()); },
+        connectForFileCopy,
+        onCompletion);
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _fileCopyInitialSyncer = syncer;
+    }
+    log() << "Starting file copy initial sync";
+    syncer->startup(numInitialSyncAttempts.load());
+}
+
 void ReplicationCoordinatorImpl::startup(OperationContext* opCtx) {
     if (!isReplEnabled()) {
         if (ReplSettings::shouldRecoverFromOplogAsStandalone()) {
@@ -803,6 +882,7 @@ void ReplicationCoordinatorImpl::shutdown(OperationContext* opCtx) {
 
     // Used to shut down outside of the lock.
     std::shared_ptr<InitialSyncer> initialSyncerCopy;
+    std::shared_ptr<FileCopyInitialSyncer> fileCopyInitialSyncerCopy;
     {
         stdx::unique_lock<stdx::mutex> lk(_mutex);
         fassert(28533, !_inShutdown);
@@ -824,6 +904,7 @@ void ReplicationCoordinatorImpl::shutdown(OperationContext* opCtx) {
         _opTimeWaiterList.signalAll_inlock();
         _currentCommittedSnapshotCond.notify_all();
         _initialSyncer.swap(initialSyncerCopy);
+        _fileCopyInitialSyncer.swap(fileCopyInitialSyncerCopy);
         _stepDownWaiters.notify_all();
     }
 
@@ -838,6 +919,11 @@ void ReplicationCoordinatorImpl::shutdown(OperationContext* opCtx) {
         initialSyncerCopy->join();
         initialSyncerCopy.reset();
     }
+    if (fileCopyInitialSyncerCopy) {
+        fileCopyInitialSyncerCopy->shutdown();
+        fileCopyInitialSyncerCopy->join();
+        fileCopyInitialSyncerCopy.reset();
+    }
     _externalState->shutdown(opCtx);
     _replExecutor->shutdown();
     _replExecutor->join();
@@ -1308,7 +1394,7 @@ Status ReplicationCoordinatorImpl::_waitUntilOpTime(OperationContext* opCtx,
         // We just need to wait for the opTime to catch up to what we need (not majority RC).
         stdx::condition_variable condVar;
         ThreadWaiter waiter(targetOpTime, nullptr, &condVar);
-        WaiterGuard guard(&_opTimeWaiterList, &waiter);
+        WaiterGuard<WaiterList> guard(&_opTimeWaiterList, &waiter);
 
         LOG(3) << "waitUntilOpTime: OpID " << opCtx->getOpID() << " is waiting for OpTime "
                << waiter << " until " << opCtx->getDeadline();
@@ -1574,7 +1660,7 @@ Status ReplicationCoordinatorImpl::_awaitReplication_inlock(
     // Must hold _mutex before constructing waitInfo as it will modify _replicationWaiterList
     stdx::condition_variable condVar;
     ThreadWaiter waiter(opTime, &writeConcern, &condVar);
-    WaiterGuard guard(&_replicationWaiterList, &waiter);
+    WaiterGuard<ReplicationWaiterIndex<Waiter>> guard(&_replicationWaiterList, &waiter);
     while (!_doneWaitingForReplication_inlock(opTime, writeConcern)) {
 
         if (_inShutdown) {
@@ -2876,9 +2962,10 @@ ReplicationCoordinatorImpl::_setCurrentRSConfig_inlock(OperationContext* opCtx,
 }
 
 void ReplicationCoordinatorImpl::_wakeReadyWaiters_inlock() {
-    _replicationWaiterList.signalIf_inlock([this](Waiter* waiter) {
-        return _doneWaitingForReplication_inlock(waiter->opTime, *waiter->writeConcern);
-    });
+    _replicationWaiterList.signalReady_inlock(
+        [this](const OpTime& opTime, const WriteConcernOptions& writeConcern) {
+            return _doneWaitingForReplication_inlock(opTime, writeConcern);
+        });
 }
 
 Status ReplicationCoordinatorImpl::processReplSetUpdatePosition(const UpdatePositionArgs& updates,
@@ -41,6 +41,7 @@
 #include "mongo/db/repl/repl_set_config.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_external_state.h"
+#include "mongo/db/repl/replication_waiter_index.h"
 #include "mongo/db/repl/sync_source_resolver.h"
 #include "mongo/db/repl/topology_coordinator.h"
 #include "mongo/db/repl/update_position_args.h"
@@ -71,6 +72,7 @@ class ReplSetMetadata;
 namespace repl {
 
 class ElectCmdRunner;
+class FileCopyInitialSyncer;
 class FreshnessChecker;
 class HeartbeatResponseAction;
 class LastVote;
@@ -502,6 +504,7 @@ private:
         FinishFunc finishCallback = nullptr;
     };
 
+    template <typename WaiterListType>
     class WaiterGuard;
 
     class WaiterList {
@@ -748,6 +751,12 @@ private:
     void _startDataReplication(OperationContext* opCtx,
                                stdx::function<void()> startCompleted = nullptr);
 
+    /**
+     * Starts copying the data files of a sync source for a file copy based initial sync. The
+     * server shuts down once the files are staged and installs them on its next startup.
+     */
+    void _startFileCopyInitialSync();
+
     /**
      * Stops replicating data by stopping the applier, fetcher and such.
      */
@@ -1164,8 +1173,9 @@ private:
     // Pointer to the ReplicationCoordinatorExternalState owned by this ReplicationCoordinator.
     std::unique_ptr<ReplicationCoordinatorExternalState> _externalState;  // (PS)
 
-    // list of information about clients waiting on replication.  Does *not* own the WaiterInfos.
-    WaiterList _replicationWaiterList;  // (M)
+    // Information about clients waiting on replication, ordered by write concern and OpTime.
+    // Does *not* own the WaiterInfos.
+    ReplicationWaiterIndex<Waiter> _replicationWaiterList;  // (M)
 
     // list of information about clients waiting for a particular opTime.
     // Does *not* own the WaiterInfos.
@@ -1249,6 +1259,9 @@ private:
     // InitialSyncer used for initial sync.
     std::shared_ptr<InitialSyncer>
         _initialSyncer;  // (I) pointer set under mutex, copied by callers.
+    // FileCopyInitialSyncer used instead of the InitialSyncer when initialSyncUsesFileCopy is set.
+    std::shared_ptr<FileCopyInitialSyncer>
+        _fileCopyInitialSyncer;  // (I) pointer set under mutex, copied by callers.
 
     // Hands out the next snapshot name.
     AtomicUInt64 _snapshotNameGenerator;  // (S)
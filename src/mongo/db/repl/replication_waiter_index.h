@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/write_concern_options.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Index of waiters blocked until an OpTime has been replicated with a given write concern.
+ *
+ * Waiters are bucketed by the parts of their write concern that decide whether they are satisfied
+ * (w and j), and ordered by OpTime within a bucket. Whether a waiter is done waiting is monotonic
+ * in its OpTime for a fixed write concern: if a write concern is satisfied at some OpTime it is
+ * satisfied at every earlier one. So signalReady_inlock() only looks at the waiters it wakes plus
+ * the first one still waiting in each bucket, rather than at every waiter.
+ *
+ * 'WaiterType' must have 'opTime' and 'writeConcern' members, and runs_once() and notify_inlock()
+ * member functions, like ReplicationCoordinatorImpl::Waiter.
+ *
+ * Like the other waiter lists, this is not synchronized; callers hold the replication coordinator
+ * mutex for every call.
+ */
+template <typename WaiterType>
+class ReplicationWaiterIndex {
+    MONGO_DISALLOW_COPYING(ReplicationWaiterIndex);
+
+public:
+    /**
+     * Returns whether a waiter for 'opTime' with 'writeConcern' is done waiting. Must be monotonic
+     * in 'opTime' as described above.
+     */
+    using DoneWaitingFn = stdx::function<bool(const OpTime&, const WriteConcernOptions&)>;
+
+    ReplicationWaiterIndex() = default;
+
+    /**
+     * Adds 'waiter' to the index. The waiter's write concern must outlive its stay in the index.
+     */
+    void add_inlock(WaiterType* waiter) {
+        invariant(waiter->writeConcern);
+        _buckets[_makeKey(*waiter->writeConcern)].emplace(waiter->opTime, waiter);
+        ++_size;
+    }
+
+    /**
+     * Returns whether 'waiter' is found and removed.
+     */
+    bool remove_inlock(WaiterType* waiter) {
+        auto bucketIt = _buckets.find(_makeKey(*waiter->writeConcern));
+        if (bucketIt == _buckets.end()) {
+            return false;
+        }
+        auto& bucket = bucketIt->second;
+        auto range = bucket.equal_range(waiter->opTime);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == waiter) {
+                bucket.erase(it);
+                if (bucket.empty()) {
+                    _buckets.erase(bucketIt);
+                }
+                --_size;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Signals the waiters for which 'doneWaiting' returns true. Waiters that only run once are
+     * removed before they are notified; the others stay in the index until removed by their
+     * owner, as with WaiterList.
+     */
+    void signalReady_inlock(const DoneWaitingFn& doneWaiting) {
+        _signal_inlock(&doneWaiting);
+    }
+
+    /**
+     * Signals every waiter in the index.
+     */
+    void signalAll_inlock() {
+        _signal_inlock(nullptr);
+    }
+
+    /**
+     * Returns the number of waiters in the index.
+     */
+    std::size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+private:
+    // The parts of a write concern that determine whether it is satisfied at a given OpTime.
+    using Key = std::tuple<std::string, int, WriteConcernOptions::SyncMode>;
+
+    using Bucket = std::multimap<OpTime, WaiterType*>;
+
+    static Key _makeKey(const WriteConcernOptions& writeConcern) {
+        // wNumNodes is ignored when wMode is set.
+        return Key{writeConcern.wMode,
+                   writeConcern.wMode.empty() ? writeConcern.wNumNodes : 0,
+                   writeConcern.syncMode};
+    }
+
+    void _signal_inlock(const DoneWaitingFn* doneWaiting) {
+        // Collect first and notify afterwards, since notifying a waiter may add waiters to or
+        // remove waiters from this index.
+        std::vector<WaiterType*> ready;
+        for (auto bucketIt = _buckets.begin(); bucketIt != _buckets.end();) {
+            auto& bucket = bucketIt->second;
+            for (auto it = bucket.begin(); it != bucket.end();) {
+                auto waiter = it->second;
+                if (doneWaiting && !(*doneWaiting)(waiter->opTime, *waiter->writeConcern)) {
+                    // Every later waiter in this bucket is waiting for a later OpTime.
+                    break;
+                }
+                ready.push_back(waiter);
+                if (waiter->runs_once()) {
+                    it = bucket.erase(it);
+                    --_size;
+                } else {
+                    ++it;
+                }
+            }
+            if (bucket.empty()) {
+                bucketIt = _buckets.erase(bucketIt);
+            } else {
+                ++bucketIt;
+            }
+        }
+
+        for (auto waiter : ready) {
+            waiter->notify_inlock();
+        }
+    }
+
+    std::map<Key, Bucket> _buckets;
+    std::size_t _size = 0;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "mongo/db/repl/replication_waiter_index.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+struct BenchmarkWaiter {
+    bool runs_once() const {
+        return true;
+    }
+
+    void notify_inlock() {
+        notified = true;
+    }
+
+    OpTime opTime;
+    const WriteConcernOptions* writeConcern = nullptr;
+    bool notified = false;
+};
+
+/**
+ * The unordered list ReplicationCoordinatorImpl used to keep its replication waiters in, which
+ * checks every waiter on every position update.
+ */
+class LinearWaiterList {
+public:
+    void add_inlock(BenchmarkWaiter* waiter) {
+        _list.push_back(waiter);
+    }
+
+    void signalReady_inlock(
+        const ReplicationWaiterIndex<BenchmarkWaiter>::DoneWaitingFn& doneWaiting) {
+        for (auto it = _list.begin(); it != _list.end();) {
+            if (!doneWaiting((*it)->opTime, *(*it)->writeConcern)) {
+                ++it;
+                continue;
+            }
+            auto waiter = *it;
+            std::swap(*it, _list.back());
+            _list.pop_back();
+            waiter->notify_inlock();
+        }
+    }
+
+private:
+    std::vector<BenchmarkWaiter*> _list;
+};
+
+const std::vector<WriteConcernOptions> kWriteConcerns = {
+    {WriteConcernOptions::kMajority, WriteConcernOptions::SyncMode::NONE, Milliseconds(0)},
+    {WriteConcernOptions::kMajority, WriteConcernOptions::SyncMode::JOURNAL, Milliseconds(0)},
+    {2, WriteConcernOptions::SyncMode::NONE, Milliseconds(0)},
+};
+
+/**
+ * Simulates state.range(0) concurrent writers waiting for replication with a mix of write
+ * concerns. Each iteration is one replSetUpdatePosition that moves the replicated OpTime forward
+ * by one write; the writer whose write became replicated is woken and issues its next write at
+ * the end of the queue.
+ */
+template <typename WaiterListType>
+void BM_WakeReadyWaitersOnPositionUpdate(benchmark::State& state) {
+    const auto numWaiters = state.range(0);
+
+    std::vector<BenchmarkWaiter> waiters(numWaiters);
+    WaiterListType list;
+    for (int64_t i = 0; i < numWaiters; ++i) {
+        waiters[i].opTime = OpTime(Timestamp(1, i + 1), 1);
+        waiters[i].writeConcern = &kWriteConcerns[i % kWriteConcerns.size()];
+        list.add_inlock(&waiters[i]);
+    }
+
+    std::uint32_t replicated = 0;
+    std::uint32_t nextWrite = numWaiters + 1;
+    std::size_t numChecked = 0;
+    auto doneWaiting = [&](const OpTime& opTime, const WriteConcernOptions&) {
+        ++numChecked;
+        return opTime.getTimestamp().getInc() <= replicated;
+    };
+
+    for (auto _ : state) {
+        ++replicated;
+        list.signalReady_inlock(doneWaiting);
+
+        auto& woken = waiters[(replicated - 1) % numWaiters];
+        invariant(woken.notified);
+        woken.notified = false;
+        woken.opTime = OpTime(Timestamp(1, nextWrite++), 1);
+        list.add_inlock(&woken);
+    }
+    state.counters["checked"] = double(numChecked) / state.iterations();
+}
+
+BENCHMARK_TEMPLATE(BM_WakeReadyWaitersOnPositionUpdate, LinearWaiterList)->Range(16, 16384);
+BENCHMARK_TEMPLATE(BM_WakeReadyWaitersOnPositionUpdate, ReplicationWaiterIndex<BenchmarkWaiter>)
+    ->Range(16, 16384);
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/replication_waiter_index.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+struct TestWaiter {
+    TestWaiter(OpTime opTime, const WriteConcernOptions* writeConcern, bool runsOnce = false)
+        : opTime(opTime), writeConcern(writeConcern), runsOnce(runsOnce) {}
+
+    bool runs_once() const {
+        return runsOnce;
+    }
+
+    void notify_inlock() {
+        ++notifyCount;
+    }
+
+    const OpTime opTime;
+    const WriteConcernOptions* writeConcern;
+    const bool runsOnce;
+    int notifyCount = 0;
+};
+
+OpTime makeOpTime(int secs) {
+    return OpTime(Timestamp(secs, 0), 1);
+}
+
+const WriteConcernOptions kMajority(
+    WriteConcernOptions::kMajority, WriteConcernOptions::SyncMode::NONE, Milliseconds(0));
+const WriteConcernOptions kMajorityJournal(
+    WriteConcernOptions::kMajority, WriteConcernOptions::SyncMode::JOURNAL, Milliseconds(0));
+const WriteConcernOptions kTwoNodes(2, WriteConcernOptions::SyncMode::NONE, Milliseconds(0));
+
+TEST(ReplicationWaiterIndexTest, SignalReadyWakesWaitersUpToTheSatisfiedOpTimeOfEachWriteConcern) {
+    ReplicationWaiterIndex<TestWaiter> index;
+    TestWaiter majority1(makeOpTime(1), &kMajority);
+    TestWaiter majority2(makeOpTime(2), &kMajority);
+    TestWaiter majority3(makeOpTime(3), &kMajority);
+    TestWaiter twoNodes1(makeOpTime(1), &kTwoNodes);
+    TestWaiter twoNodes3(makeOpTime(3), &kTwoNodes);
+    for (auto waiter : {&majority3, &twoNodes1, &majority1, &twoNodes3, &majority2}) {
+        index.add_inlock(waiter);
+    }
+    ASSERT_EQUALS(5U, index.size());
+
+    // Majority has reached OpTime 2, and two nodes have reached OpTime 3.
+    std::vector<OpTime> checked;
+    index.signalReady_inlock([&](const OpTime& opTime, const WriteConcernOptions& writeConcern) {
+        checked.push_back(opTime);
+        return opTime <= (writeConcern.wMode.empty() ? makeOpTime(3) : makeOpTime(2));
+    });
+
+    ASSERT_EQUALS(1, majority1.notifyCount);
+    ASSERT_EQUALS(1, majority2.notifyCount);
+    ASSERT_EQUALS(0, majority3.notifyCount);
+    ASSERT_EQUALS(1, twoNodes1.notifyCount);
+    ASSERT_EQUALS(1, twoNodes3.notifyCount);
+
+    // Every waiter was checked exactly once, and the scan of each write concern stopped at the
+    // first waiter that was not yet satisfied.
+    ASSERT_EQUALS(5U, checked.size());
+
+    // Waiters that do not run once stay in the index until removed.
+    ASSERT_EQUALS(5U, index.size());
+    ASSERT_TRUE(index.remove_inlock(&majority1));
+    ASSERT_FALSE(index.remove_inlock(&majority1));
+    ASSERT_EQUALS(4U, index.size());
+}
+
+TEST(ReplicationWaiterIndexTest, WaitersThatRunOnceAreRemovedWhenSignaled) {
+    ReplicationWaiterIndex<TestWaiter> index;
+    TestWaiter waiter1(makeOpTime(1), &kMajorityJournal, true);
+    TestWaiter waiter2(makeOpTime(2), &kMajorityJournal, true);
+    index.add_inlock(&waiter1);
+    index.add_inlock(&waiter2);
+
+    index.signalReady_inlock([](const OpTime& opTime, const WriteConcernOptions&) {
+        return opTime <= makeOpTime(1);
+    });
+    ASSERT_EQUALS(1, waiter1.notifyCount);
+    ASSERT_EQUALS(0, waiter2.notifyCount);
+    ASSERT_EQUALS(1U, index.size());
+    ASSERT_FALSE(index.remove_inlock(&waiter1));
+
+    index.signalAll_inlock();
+    ASSERT_EQUALS(1, waiter1.notifyCount);
+    ASSERT_EQUALS(1, waiter2.notifyCount);
+    ASSERT_TRUE(index.empty());
+}
+
+TEST(ReplicationWaiterIndexTest, WaitersForTheSameOpTimeAreRemovedIndividually) {
+    ReplicationWaiterIndex<TestWaiter> index;
+    TestWaiter waiter1(makeOpTime(1), &kMajority);
+    TestWaiter waiter2(makeOpTime(1), &kMajority);
+    TestWaiter otherWriteConcern(makeOpTime(1), &kMajorityJournal);
+    index.add_inlock(&waiter1);
+    index.add_inlock(&waiter2);
+
+    ASSERT_FALSE(index.remove_inlock(&otherWriteConcern));
+    ASSERT_TRUE(index.remove_inlock(&waiter2));
+    ASSERT_EQUALS(1U, index.size());
+
+    index.signalAll_inlock();
+    ASSERT_EQUALS(1, waiter1.notifyCount);
+    ASSERT_EQUALS(0, waiter2.notifyCount);
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -33,6 +33,7 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include "third_party/murmurhash3/MurmurHash3.h"
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 #include <memory>
 
@@ -67,6 +68,7 @@
 #include "mongo/db/repl/repl_set_config.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/session_update_tracker.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/session.h"
 #include "mongo/db/session_txn_record_gen.h"
@@ -102,6 +104,24 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+// Number of batches written to the oplog and partitioned while the previous batch was applied.
+Counter64 pipelinedBatchesStats;
+ServerStatusMetricField<Counter64> displayPipelinedBatches("repl.apply.pipelinedBatches",
+                                                           &pipelinedBatchesStats);
+
+// When enabled, the oplog writes and writer assignment of a batch overlap the application of the
+// previous batch.
+MONGO_EXPORT_SERVER_PARAMETER(replPipelineBatchApplication, bool, true);
+
+// Summed over all batches, the number of operations assigned to the busiest writer thread and the
+// number each thread would have been assigned with an even split. Their ratio is the writer skew.
+Counter64 writerSkewBusiestOpsStats;
+ServerStatusMetricField<Counter64> displayWriterSkewBusiestOps("repl.apply.writerSkew.busiestOps",
+                                                               &writerSkewBusiestOpsStats);
+Counter64 writerSkewIdealOpsStats;
+ServerStatusMetricField<Counter64> displayWriterSkewIdealOps("repl.apply.writerSkew.idealOps",
+                                                             &writerSkewIdealOpsStats);
+
 class ApplyBatchFinalizer {
 public:
     ApplyBatchFinalizer(ReplicationCoordinator* replCoord) : _replCoord(replCoord) {}
@@ -321,6 +341,37 @@ Status SyncTail::syncApply(OperationContext* opCtx,
     MONGO_UNREACHABLE;
 }
 
+// static
+Status SyncTail::syncApplyUpdatesAndDeletes(OperationContext* opCtx,
+                                            MultiApplier::OperationPtrs::const_iterator begin,
+                                            MultiApplier::OperationPtrs::const_iterator end) {
+    invariant(begin != end);
+
+    // Count the whole group as a single operation, for reporting purposes.
+    CurOp groupOp(opCtx);
+
+    const auto& first = **begin;
+    const auto& nss = first.getNamespace();
+    return writeConflictRetry(opCtx, "syncApply_updatesAndDeletes", nss.ns(), [&] {
+        UnreplicatedWritesBlock uwb(opCtx);
+        DisableDocumentValidation validationDisabler(opCtx);
+
+        AutoGetCollection autoColl(opCtx, getNsOrUUID(nss, first.raw), MODE_IX);
+        auto collection = autoColl.getCollection();
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "missing collection (" << nss.ns() << ")",
+                collection);
+        OldClientContext ctx(opCtx, autoColl.getNss().ns(), autoColl.getDb());
+
+        Status status = applyUpdatesAndDeletes_inlock(
+            opCtx, ctx.db(), collection, begin, end, [] { opsAppliedStats.increment(1); });
+        if (!status.isOK() && status.code() == ErrorCodes::WriteConflict) {
+            throw WriteConflictException();
+        }
+        return status;
+    });
+}
+
 SyncTail::SyncTail(OplogApplier::Observer* observer,
                    ReplicationConsistencyMarkers* consistencyMarkers,
                    StorageInterface* storageInterface,
@@ -381,6 +432,23 @@ void prefetchOps(const MultiApplier::Operations& ops, ThreadPool* prefetcherPool
     prefetcherPool->waitForIdle();
 }
 
+// Adds the number of operations in the largest writer vector and the number each writer thread
+// would have been given with an even split to the writer skew metrics.
+void recordWriterSkew(const std::vector<MultiApplier::OperationPtrs>& writerVectors) {
+    size_t totalOps = 0;
+    size_t busiestOps = 0;
+    for (const auto& writer : writerVectors) {
+        totalOps += writer.size();
+        busiestOps = std::max(busiestOps, writer.size());
+    }
+    if (totalOps == 0) {
+        return;
+    }
+    writerSkewBusiestOpsStats.increment(busiestOps);
+    writerSkewIdealOpsStats.increment((totalOps + writerVectors.size() - 1) /
+                                      writerVectors.size());
+}
+
 // Doles out all the work to the writer pool threads.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
@@ -390,6 +458,7 @@ void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
               std::vector<Status>* statusVector,
               std::vector<WorkerMultikeyPathInfo>* workerMultikeyPathInfo) {
     invariant(writerVectors.size() == statusVector->size());
+    recordWriterSkew(writerVectors);
     for (size_t i = 0; i < writerVectors.size(); i++) {
         if (!writerVectors[i].empty()) {
             invariant(writerPool->schedule([
@@ -515,7 +584,8 @@ private:
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * writerVectors - Set of operations to apply. Operations that may conflict are always assigned
+ *      to the same vector, in oplog order.
  * derivedOps - If provided, this function inserts a decomposition of applyOps operations
  *      and instructions for updating the transactions table.
  * sessionUpdateTracker - if provided, keeps track of session info from ops.
@@ -663,6 +733,33 @@ void tryToGoLiveAsASecondary(OperationContext* opCtx,
 }
 }
 
+/**
+ * A batch of operations along with the state needed to apply it. The writer vectors point into
+ * 'ops' and 'derivedOps', so a batch must stay in place once it has been prepared.
+ */
+struct SyncTail::PreparedBatch {
+    MONGO_DISALLOW_COPYING(PreparedBatch);
+
+    explicit PreparedBatch(MultiApplier::Operations batchOps) : ops(std::move(batchOps)) {}
+
+    MultiApplier::Operations ops;
+
+    // Holds 'pseudo operations' generated by secondaries to aid in replication.
+    // Keep in scope until all operations in 'ops' and 'derivedOps' have been applied.
+    // Pseudo operations include:
+    // - applyOps operations expanded to individual ops.
+    // - ops to update config.transactions. Normal writes to config.transactions in the
+    //   primary don't create an oplog entry, so extract info from writes with transactions
+    //   and create a pseudo oplog.
+    std::vector<MultiApplier::Operations> derivedOps;
+
+    std::vector<MultiApplier::OperationPtrs> writerVectors;
+
+    // Set once the batch has been scheduled for writing to the oplog and its operations have been
+    // assigned to writer threads.
+    bool prepared = false;
+};
+
 class SyncTail::OpQueueBatcher {
     MONGO_DISALLOW_COPYING(OpQueueBatcher);
 
@@ -791,6 +888,12 @@ void SyncTail::_oplogApplication(OplogBuffer* oplogBuffer,
     // Get replication consistency markers.
     OpTime minValid;
 
+    // A batch taken from the batcher and prepared while the previous batch was being applied.
+    std::unique_ptr<PreparedBatch> nextBatch;
+
+    // Set if the batcher signaled shutdown while a batch was being applied.
+    bool batcherShutDown = false;
+
     while (true) {  // Exits on message from OpQueueBatcher.
         // Use a new operation context each iteration, as otherwise we may appear to use a single
         // collection name to refer to collections with different UUIDs.
@@ -818,24 +921,34 @@ void SyncTail::_oplogApplication(OplogBuffer* oplogBuffer,
         // Transition to SECONDARY state, if possible.
         tryToGoLiveAsASecondary(&opCtx, replCoord, minValid);
 
-        long long termWhenBufferIsEmpty = replCoord->getTerm();
-        // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
-        // ready in time, we'll loop again so we can do the above checks periodically.
-        OpQueue ops = batcher->getNextBatch(Seconds(1));
-        if (ops.empty()) {
-            if (ops.mustShutdown()) {
+        std::unique_ptr<PreparedBatch> batch = std::move(nextBatch);
+        if (!batch) {
+            if (batcherShutDown) {
                 // Shut down and exit oplog application loop.
                 return;
             }
-            if (MONGO_FAIL_POINT(rsSyncApplyStop)) {
-                continue;
+
+            long long termWhenBufferIsEmpty = replCoord->getTerm();
+            // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
+            // ready in time, we'll loop again so we can do the above checks periodically.
+            OpQueue ops = batcher->getNextBatch(Seconds(1));
+            if (ops.empty()) {
+                if (ops.mustShutdown()) {
+                    // Shut down and exit oplog application loop.
+                    return;
+                }
+                if (MONGO_FAIL_POINT(rsSyncApplyStop)) {
+                    continue;
+                }
+                // Signal drain complete if we're in Draining state and the buffer is empty.
+                replCoord->signalDrainComplete(&opCtx, termWhenBufferIsEmpty);
+                continue;  // Try again.
             }
-            // Signal drain complete if we're in Draining state and the buffer is empty.
-            replCoord->signalDrainComplete(&opCtx, termWhenBufferIsEmpty);
-            continue;  // Try again.
+            batch = stdx::make_unique<PreparedBatch>(ops.releaseBatch());
         }
+        const auto& ops = batch->ops;
 
-        // Extract some info from ops that we'll need after releasing the batch below.
+        // Extract some info from ops that we'll need after applying the batch below.
         const auto firstOpTimeInBatch = ops.front().getOpTime();
         const auto lastOpTimeInBatch = ops.back().getOpTime();
         const auto lastAppliedOpTimeAtStartOfBatch = replCoord->getMyLastAppliedOpTime();
@@ -854,10 +967,36 @@ void SyncTail::_oplogApplication(OplogBuffer* oplogBuffer,
         // Don't allow the fsync+lock thread to see intermediate states of batch application.
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
-        // Apply the operations in this batch. 'multiApply' returns the optime of the last op that
+        // While this batch is being applied, take the next batch if one is ready, write it to the
+        // oplog and assign its operations to writer threads. Commands may change the collection
+        // properties that writer assignment depends on, so a batch following a command is only
+        // prepared once the command has been applied. MMAPv1 prefetching also needs the writer
+        // pool to itself.
+        stdx::function<void()> prepareNextBatch;
+        if (replPipelineBatchApplication.load() && !isMMAPV1() &&
+            !MONGO_FAIL_POINT(rsSyncApplyStop) &&
+            std::none_of(ops.begin(), ops.end(), [](const OplogEntry& op) {
+                return op.isCommand();
+            })) {
+            prepareNextBatch = [&] {
+                OpQueue nextOps = batcher->getNextBatch(Seconds(0));
+                if (nextOps.empty()) {
+                    if (nextOps.mustShutdown()) {
+                        batcherShutDown = true;
+                    }
+                    return;
+                }
+
+                nextBatch = stdx::make_unique<PreparedBatch>(nextOps.releaseBatch());
+                _prepareBatch(&opCtx, nextBatch.get());
+                pipelinedBatchesStats.increment();
+            };
+        }
+
+        // Apply the operations in this batch. '_multiApply' returns the optime of the last op that
         // was applied, which should be the last optime in the batch.
         auto lastOpTimeAppliedInBatch =
-            fassertNoTrace(34437, multiApply(&opCtx, ops.releaseBatch()));
+            fassertNoTrace(34437, _multiApply(&opCtx, batch.get(), prepareNextBatch));
         invariant(lastOpTimeAppliedInBatch == lastOpTimeInBatch);
 
         // In order to provide resilience in the event of a crash in the middle of batch
@@ -1191,6 +1330,7 @@ Status multiSyncApply(OperationContext* opCtx,
                : OplogApplication::Mode::kSecondary);
 
     ApplierHelpers::InsertGroup insertGroup(ops, opCtx, oplogApplicationMode);
+    ApplierHelpers::UpdateDeleteGroup updateDeleteGroup(ops, opCtx, oplogApplicationMode);
 
     {  // Ensure that the MultikeyPathTracker stops tracking paths.
         ON_BLOCK_EXIT([opCtx] { MultikeyPathTracker::get(opCtx).stopTrackingMultikeyPathInfo(); });
@@ -1207,6 +1347,13 @@ Status multiSyncApply(OperationContext* opCtx,
                 continue;
             }
 
+            // Likewise for runs of updates and deletes on a single collection.
+            groupResult = updateDeleteGroup.groupAndApplyUpdatesAndDeletes(it);
+            if (groupResult.isOK()) {
+                it = groupResult.getValue();
+                continue;
+            }
+
             // If we didn't create a group, try to apply the op individually.
             try {
                 const Status status = SyncTail::syncApply(opCtx, entry.raw, oplogApplicationMode);
@@ -1252,10 +1399,35 @@ Status multiSyncApply(OperationContext* opCtx,
     return Status::OK();
 }
 
+void SyncTail::_prepareBatch(OperationContext* opCtx, PreparedBatch* batch) {
+    invariant(!batch->prepared);
+    const auto& ops = batch->ops;
+
+    // Write batch of ops into oplog.
+    if (!_options.skipWritesToOplog) {
+        _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
+        scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
+    }
+
+    batch->writerVectors.resize(_writerPool->getStats().numThreads);
+    fillWriterVectors(opCtx, &batch->ops, &batch->writerVectors, &batch->derivedOps);
+    batch->prepared = true;
+}
+
 StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::Operations ops) {
     invariant(!ops.empty());
 
-    if (isMMAPV1()) {
+    PreparedBatch batch(std::move(ops));
+    return _multiApply(opCtx, &batch, {});
+}
+
+StatusWith<OpTime> SyncTail::_multiApply(OperationContext* opCtx,
+                                         PreparedBatch* batch,
+                                         const stdx::function<void()>& whileApplying) {
+    const auto& ops = batch->ops;
+    invariant(!ops.empty());
+
+    if (isMMAPV1() && !batch->prepared) {
         // Use a ThreadPool to prefetch all the operations in a batch.
         prefetchOps(ops, _writerPool);
     }
@@ -1281,24 +1453,12 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
         // because the spawned threads refer to objects on the stack
         ON_BLOCK_EXIT([&] { _writerPool->waitForIdle(); });
 
-        // Write batch of ops into oplog.
-        if (!_options.skipWritesToOplog) {
-            _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
-            scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
+        // A batch prepared while the previous batch was applied has already been scheduled for
+        // writing to the oplog.
+        if (!batch->prepared) {
+            _prepareBatch(opCtx, batch);
         }
 
-        // Holds 'pseudo operations' generated by secondaries to aid in replication.
-        // Keep in scope until all operations in 'ops' and 'derivedOps' have been applied.
-        // Pseudo operations include:
-        // - applyOps operations expanded to individual ops.
-        // - ops to update config.transactions. Normal writes to config.transactions in the
-        //   primary don't create an oplog entry, so extract info from writes with transactions
-        //   and create a pseudo oplog.
-        std::vector<MultiApplier::Operations> derivedOps;
-
-        std::vector<MultiApplier::OperationPtrs> writerVectors(_writerPool->getStats().numThreads);
-        fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
-
         // Wait for writes to finish before applying ops.
         _writerPool->waitForIdle();
 
@@ -1310,7 +1470,18 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
 
         {
             std::vector<Status> statusVector(_writerPool->getStats().numThreads, Status::OK());
-            applyOps(writerVectors, _writerPool, _applyFunc, this, &statusVector, &multikeyVector);
+            applyOps(batch->writerVectors,
+                     _writerPool,
+                     _applyFunc,
+                     this,
+                     &statusVector,
+                     &multikeyVector);
+
+            // The writes of a batch prepared here run on the writer threads alongside this batch
+            // and are complete once the pool is idle.
+            if (whileApplying) {
+                whileApplying();
+            }
             _writerPool->waitForIdle();
 
             // If any of the statuses is not ok, return error.
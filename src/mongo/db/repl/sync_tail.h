@@ -79,6 +79,15 @@ public:
                             const BSONObj& o,
                             OplogApplication::Mode oplogApplicationMode);
 
+    /**
+     * Applies a run of update and delete operations on a single collection, as grouped by
+     * ApplierHelpers::UpdateDeleteGroup, in one WriteUnitOfWork. If any of the operations cannot
+     * be applied as part of the group, none of them are, and an error is returned.
+     */
+    static Status syncApplyUpdatesAndDeletes(OperationContext* opCtx,
+                                             MultiApplier::OperationPtrs::const_iterator begin,
+                                             MultiApplier::OperationPtrs::const_iterator end);
+
     /**
      *
      * Constructs a SyncTail.
@@ -248,6 +257,23 @@ private:
                            ReplicationCoordinator* replCoord,
                            OpQueueBatcher* batcher) noexcept;
 
+    struct PreparedBatch;
+
+    /**
+     * Schedules the writes of 'batch' to the oplog on the writer pool and assigns its operations
+     * to writer threads. The oplog writes may still be in progress when this returns.
+     */
+    void _prepareBatch(OperationContext* opCtx, PreparedBatch* batch);
+
+    /**
+     * Implements multiApply() for a batch that may already have been prepared. If set,
+     * 'whileApplying' is called once the operations of 'batch' have been handed to the writer
+     * threads, so that the next batch can be prepared while this one is applied.
+     */
+    StatusWith<OpTime> _multiApply(OperationContext* opCtx,
+                                   PreparedBatch* batch,
+                                   const stdx::function<void()>& whileApplying);
+
     OplogApplier::Observer* const _observer;
     ReplicationConsistencyMarkers* const _consistencyMarkers;
     StorageInterface* const _storageInterface;
@@ -26,10 +26,13 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -42,6 +45,7 @@
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/feature_compatibility_version_parser.h"
+#include "mongo/db/commands/server_status_internal.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
@@ -49,6 +53,7 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/repl/applier_helpers.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
 #include "mongo/db/repl/idempotency_test_fixture.h"
@@ -60,20 +65,60 @@
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/sync_tail.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/string_map.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace repl {
 namespace {
 
+ServerParameter* getServerParameter(StringData name) {
+    auto parameter = ServerParameterSet::getGlobal()->getMap().find(name.toString());
+    ASSERT(parameter != ServerParameterSet::getGlobal()->getMap().end());
+    return parameter->second;
+}
+
+void setServerParameter(StringData name, StringData value) {
+    ASSERT_OK(getServerParameter(name)->setFromString(value.toString()));
+}
+
+/**
+ * Sets the server parameter 'name' to 'value' and returns a guard which restores its original
+ * value.
+ */
+auto overrideServerParameter(StringData name, StringData value) {
+    BSONObjBuilder original;
+    getServerParameter(name)->append(nullptr, original, "value");
+    setServerParameter(name, value);
+    return MakeGuard(
+        [ name = name.toString(), original = original.obj() ] {
+            setServerParameter(name, original["value"].toString(false));
+        });
+}
+
+long long getPipelinedBatches() {
+    BSONObjBuilder metrics;
+    MetricTree::theMetricTree->appendTo(metrics);
+    return metrics.obj()["metrics"]["repl"]["apply"]["pipelinedBatches"].safeNumberLong();
+}
+
+long long getApplyMetric(StringData section, StringData name) {
+    BSONObjBuilder metrics;
+    MetricTree::theMetricTree->appendTo(metrics);
+    return metrics.obj()["metrics"]["repl"]["apply"][section][name].safeNumberLong();
+}
+
 /**
  * Creates an OplogEntry with given parameters and preset defaults for this test suite.
  */
@@ -518,6 +563,84 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_EQUALS(op2, lastEntry);
 }
 
+TEST_F(SyncTailTest, MultiApplyReportsWriterSkewOfABatchUpdatingOneDocument) {
+    // Updates to a single document all go to the same writer thread.
+    const NamespaceString nss("test.hot");
+    const int kNumOps = 8;
+    const size_t kNumWriterThreads = 4;
+    auto writerPool = OplogApplier::makeWriterPool(kNumWriterThreads);
+
+    auto applyOperationFn = [](OperationContext* opCtx,
+                               MultiApplier::OperationPtrs* operationsForWriterThreadToApply,
+                               SyncTail* st,
+                               WorkerMultikeyPathInfo*) -> Status { return Status::OK(); };
+
+    MultiApplier::Operations ops;
+    for (int i = 0; i < kNumOps; i++) {
+        ops.push_back(makeUpdateDocumentOplogEntry({Timestamp(Seconds(1 + i), 0), 1LL},
+                                                   nss,
+                                                   BSON("_id" << 0),
+                                                   BSON("$set" << BSON("x" << i))));
+    }
+
+    auto busiestOpsBefore = getApplyMetric("writerSkew", "busiestOps");
+    auto idealOpsBefore = getApplyMetric("writerSkew", "idealOps");
+    SyncTail syncTail(nullptr,
+                      getConsistencyMarkers(),
+                      getStorageInterface(),
+                      applyOperationFn,
+                      writerPool.get());
+    auto lastOpTime = unittest::assertGet(syncTail.multiApply(_opCtx.get(), ops));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    ASSERT_EQUALS(kNumOps, getApplyMetric("writerSkew", "busiestOps") - busiestOpsBefore);
+    ASSERT_EQUALS(kNumOps / int(kNumWriterThreads),
+                  getApplyMetric("writerSkew", "idealOps") - idealOpsBefore);
+}
+
+TEST_F(SyncTailTest, MultiApplyKeepsInsertsIntoACollectionInOneGroupPerWriterThread) {
+    // Inserts into a collection are grouped per writer vector, so by default a batch of them is
+    // split into no more groups than there are writer threads.
+    const NamespaceString nss("test.t");
+    const int kNumOps = 400;
+    const size_t kNumWriterThreads = 4;
+    auto writerPool = OplogApplier::makeWriterPool(kNumWriterThreads);
+
+    stdx::mutex mutex;
+    std::vector<size_t> groupSizes;
+    auto applyOperationFn = [&](OperationContext* opCtx,
+                                MultiApplier::OperationPtrs* operationsForWriterThreadToApply,
+                                SyncTail* st,
+                                WorkerMultikeyPathInfo*) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        groupSizes.push_back(operationsForWriterThreadToApply->size());
+        return Status::OK();
+    };
+
+    MultiApplier::Operations ops;
+    for (int i = 0; i < kNumOps; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1 + i), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    SyncTail syncTail(nullptr,
+                      getConsistencyMarkers(),
+                      getStorageInterface(),
+                      applyOperationFn,
+                      writerPool.get());
+    auto lastOpTime = unittest::assertGet(syncTail.multiApply(_opCtx.get(), ops));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_LTE(groupSizes.size(), kNumWriterThreads);
+    ASSERT_EQUALS(size_t(kNumOps),
+                  std::accumulate(groupSizes.begin(), groupSizes.end(), size_t(0)));
+    for (auto groupSize : groupSizes) {
+        // The _id hash spreads the inserts evenly enough that no writer thread gets a small group.
+        ASSERT_GTE(groupSize, kNumOps / kNumWriterThreads / 2);
+    }
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
@@ -992,6 +1115,115 @@ TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingInsertsIndividuallyWhenGro
     ASSERT_EQUALS(1U, numFailedGroupedInserts);
 }
 
+TEST_F(SyncTailTest, MultiSyncApplyGroupsUpdateAndDeleteOperationsOnTheSameCollection) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    auto createOp = makeCreateCollectionOplogEntry(nextOpTime(), nss);
+    auto insertOp1 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 1));
+    auto insertOp2 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2));
+    auto insertOp3 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 3));
+    ASSERT_OK(runOpsSteadyState({createOp, insertOp1, insertOp2, insertOp3}));
+
+    auto updateOp1 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 1), BSON("$set" << BSON("x" << 1)));
+    auto updateOp2 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 2), BSON("$set" << BSON("x" << 2)));
+    auto deleteOp3 = makeDeleteDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 3));
+
+    std::size_t numDeletes = 0;
+    _opObserver->onDeleteFn = [&](OperationContext* opCtx,
+                                  const NamespaceString&,
+                                  OptionalCollectionUUID,
+                                  StmtId,
+                                  bool,
+                                  const boost::optional<BSONObj>&) {
+        // The delete shares its WriteUnitOfWork with the updates that preceded it.
+        ASSERT_TRUE(opCtx->lockState()->inAWriteUnitOfWork());
+        numDeletes++;
+    };
+    ASSERT_OK(runOpsSteadyState({updateOp1, updateOp2, deleteOp3}));
+    ASSERT_EQUALS(1U, numDeletes);
+
+    auto storage = getStorageInterface();
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "x" << 1),
+                      unittest::assertGet(storage->findById(
+                          _opCtx.get(), nss, BSON("_id" << 1).firstElement())));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2 << "x" << 2),
+                      unittest::assertGet(storage->findById(
+                          _opCtx.get(), nss, BSON("_id" << 2).firstElement())));
+    ASSERT_EQUALS(
+        ErrorCodes::NoSuchKey,
+        storage->findById(_opCtx.get(), nss, BSON("_id" << 3).firstElement()).getStatus());
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingUpdatesAndDeletesIndividuallyWhenGroupFails) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    auto createOp = makeCreateCollectionOplogEntry(nextOpTime(), nss);
+    auto insertOp1 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 1));
+    auto insertOp2 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2));
+    ASSERT_OK(runOpsSteadyState({createOp, insertOp1, insertOp2}));
+
+    auto updateOp1 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 1), BSON("$set" << BSON("x" << 1)));
+    auto deleteOp2 = makeDeleteDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2));
+
+    // Reject the first delete, which is the one applied as part of the group.
+    std::size_t numDeletes = 0;
+    _opObserver->onDeleteFn = [&](OperationContext*,
+                                  const NamespaceString&,
+                                  OptionalCollectionUUID,
+                                  StmtId,
+                                  bool,
+                                  const boost::optional<BSONObj>&) {
+        if (numDeletes++ == 0) {
+            uasserted(ErrorCodes::OperationFailed, "grouped deletes not supported");
+        }
+    };
+    ASSERT_OK(runOpsSteadyState({updateOp1, deleteOp2}));
+
+    // The group was rolled back and both operations were then applied one at a time.
+    ASSERT_EQUALS(2U, numDeletes);
+    auto storage = getStorageInterface();
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "x" << 1),
+                      unittest::assertGet(storage->findById(
+                          _opCtx.get(), nss, BSON("_id" << 1).firstElement())));
+    ASSERT_EQUALS(
+        ErrorCodes::NoSuchKey,
+        storage->findById(_opCtx.get(), nss, BSON("_id" << 2).firstElement()).getStatus());
+}
+
+TEST_F(SyncTailTest, UpdateDeleteGroupEndsWhenAnIdRepeats) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    auto createOp = makeCreateCollectionOplogEntry(nextOpTime(), nss);
+    auto insertOp1 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 1));
+    auto insertOp2 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2));
+    ASSERT_OK(runOpsSteadyState({createOp, insertOp1, insertOp2}));
+
+    auto updateOp1 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 1), BSON("$set" << BSON("x" << 1)));
+    auto updateOp2 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 2), BSON("$set" << BSON("x" << 1)));
+    auto updateOp3 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 1), BSON("$set" << BSON("x" << 2)));
+    auto deleteOp4 = makeDeleteDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2));
+    MultiApplier::OperationPtrs ops = {&updateOp1, &updateOp2, &updateOp3, &deleteOp4};
+
+    // The second write to _id 1 starts a new group rather than sharing a WriteUnitOfWork with
+    // the first one.
+    ApplierHelpers::UpdateDeleteGroup group(&ops, _opCtx.get(), OplogApplication::Mode::kSecondary);
+    auto groupEnd = unittest::assertGet(group.groupAndApplyUpdatesAndDeletes(ops.cbegin()));
+    ASSERT(groupEnd == ops.cbegin() + 1);
+    groupEnd = unittest::assertGet(group.groupAndApplyUpdatesAndDeletes(groupEnd + 1));
+    ASSERT(groupEnd == ops.cbegin() + 3);
+
+    auto storage = getStorageInterface();
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "x" << 2),
+                      unittest::assertGet(storage->findById(
+                          _opCtx.get(), nss, BSON("_id" << 1).firstElement())));
+    ASSERT_EQUALS(
+        ErrorCodes::NoSuchKey,
+        storage->findById(_opCtx.get(), nss, BSON("_id" << 2).firstElement()).getStatus());
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyIgnoresUpdateOperationIfDocumentIsMissingFromSyncSource) {
     BSONObj emptyDoc;
     SyncTailWithLocalDocumentFetcher syncTail(emptyDoc);
@@ -1137,6 +1369,90 @@ DEATH_TEST_F(SyncTailTest,
     syncTail.oplogApplication(oplogBuffer.get(), &replCoord);
 }
 
+/**
+ * Replays a recorded oplog of inserts through steady state oplog application and logs the
+ * throughput, with batch pipelining enabled or disabled. Every entry must be applied exactly once
+ * either way, and only pipelined application may prepare a batch while applying another one.
+ */
+class OplogApplicationReplayTest : public SyncTailTest {
+protected:
+    void replayRecordedOplog(bool pipelined) {
+        const int kNumOps = 5000;
+        const NamespaceString nss("test.replay_" + std::string(pipelined ? "pipelined" : "serial"));
+        createCollectionWithUuid(_opCtx.get(), nss);
+
+        std::vector<BSONObj> recordedOplog;
+        for (int i = 0; i < kNumOps; i++) {
+            recordedOplog.push_back(
+                makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << i << "x" << i))
+                    .toBSON());
+        }
+        const auto lastOpTime = OplogEntry(recordedOplog.back()).getOpTime();
+
+        // Use small batches so that the replay spans many of them.
+        auto batchLimitGuard = overrideServerParameter("replBatchLimitOperations", "100");
+        auto pipelineGuard =
+            overrideServerParameter("replPipelineBatchApplication", pipelined ? "true" : "false");
+        const auto pipelinedBatchesBefore = getPipelinedBatches();
+
+        OplogBufferBlockingQueue oplogBuffer;
+        oplogBuffer.pushAllNonBlocking(_opCtx.get(), recordedOplog.begin(), recordedOplog.end());
+
+        auto writerPool = OplogApplier::makeWriterPool();
+        SyncTail syncTail(nullptr,  // observer. not required by oplogApplication().
+                          _consistencyMarkers.get(),
+                          _storageInterface.get(),
+                          multiSyncApply,
+                          writerPool.get(),
+                          OplogApplier::Options());
+
+        auto replCoord = ReplicationCoordinator::get(_opCtx.get());
+        ASSERT_OK(replCoord->setFollowerMode(MemberState::RS_SECONDARY));
+
+        // oplogApplication() returns once the buffer has been drained.
+        syncTail.shutdown();
+
+        // SyncTail::oplogApplication() creates its own OperationContext in the current thread
+        // context.
+        _opCtx = {};
+        Timer timer;
+        syncTail.oplogApplication(&oplogBuffer, replCoord);
+        const auto micros = std::max(timer.micros(), 1LL);
+        log() << "Replayed " << kNumOps << " oplog entries " << (pipelined ? "with" : "without")
+              << " batch pipelining in " << micros / 1000 << "ms ("
+              << kNumOps * 1000 * 1000LL / micros << " entries/sec)";
+        _opCtx = cc().makeOperationContext();
+
+        ASSERT_EQUALS(lastOpTime, replCoord->getMyLastAppliedOpTime());
+
+        // The whole oplog was buffered up front, so a pipelined replay finds the next batch ready
+        // while applying the current one.
+        const auto pipelinedBatches = getPipelinedBatches() - pipelinedBatchesBefore;
+        if (pipelined) {
+            ASSERT_GT(pipelinedBatches, 0);
+        } else {
+            ASSERT_EQ(pipelinedBatches, 0);
+        }
+
+        DBDirectClient client(_opCtx.get());
+        ASSERT_EQUALS(kNumOps, static_cast<int>(client.count(nss.ns())));
+        auto cursor = client.query(nss.ns(), Query().sort(BSON("_id" << 1)));
+        for (int i = 0; i < kNumOps; i++) {
+            ASSERT_TRUE(cursor->more());
+            ASSERT_BSONOBJ_EQ(BSON("_id" << i << "x" << i), cursor->next());
+        }
+        ASSERT_FALSE(cursor->more());
+    }
+};
+
+TEST_F(OplogApplicationReplayTest, ReplayWithoutBatchPipelining) {
+    replayRecordedOplog(false);
+}
+
+TEST_F(OplogApplicationReplayTest, ReplayWithBatchPipelining) {
+    replayRecordedOplog(true);
+}
+
 TEST_F(IdempotencyTest, Geo2dsphereIndexFailedOnUpdate) {
     ASSERT_OK(
         ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_RECOVERING));
@@ -106,6 +106,18 @@ StatusWith<DistributionStatus> createCollectionDistributionStatus(
         }
     }
 
+    // Cache the load each shard observed on its chunks of the collection
+    for (const auto& stat : allShards) {
+        const auto it = stat.chunkLoads.find(chunkMgr->getns().ns());
+        if (it == stat.chunkLoads.end()) {
+            continue;
+        }
+
+        for (const auto& chunkLoad : it->second) {
+            distribution.addChunkLoad(chunkLoad);
+        }
+    }
+
     return {std::move(distribution)};
 }
 
@@ -149,6 +161,13 @@ public:
         }
     }
 
+    /**
+     * Returns whether any split points have been added for the specified chunk.
+     */
+    bool hasSplitPoints(const Chunk& chunk) const {
+        return _chunkSplitPoints.count(chunk.getMin());
+    }
+
     /**
      * May be called only once for the lifetime of the buffer. Moves the contents of the buffer into
      * a vector of split infos to be passed to the split call.
@@ -406,6 +425,20 @@ StatusWith<SplitInfoVector> BalancerChunkSelectionPolicyImpl::_getSplitCandidate
         }
     }
 
+    // Split the chunks which are too hot to be balanced by moving them whole. Chunks which are
+    // already being split at zone boundaries are left for a later round, once their load has been
+    // observed under their new bounds.
+    for (const auto& loadSplit : BalancerPolicy::selectHotChunksToSplit(shardStats, distribution)) {
+        const auto chunk = cm->findIntersectingChunkWithSimpleCollation(loadSplit.splitPoint);
+        if (chunk.getMin().woCompare(loadSplit.chunk.getMin()) ||
+            chunk.getMax().woCompare(loadSplit.chunk.getMax()) ||
+            splitCandidates.hasSplitPoints(chunk))
+            continue;
+
+        LOG(1) << "Splitting hot chunk " << loadSplit.toString();
+        splitCandidates.addSplitPoint(chunk, loadSplit.splitPoint);
+    }
+
     return splitCandidates.done();
 }
 
@@ -32,6 +32,9 @@
 
 #include "mongo/db/s/balancer/balancer_policy.h"
 
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
 #include "mongo/util/log.h"
@@ -45,6 +48,8 @@ using std::set;
 using std::string;
 using std::vector;
 
+MONGO_EXPORT_SERVER_PARAMETER(balancerUseChunkLoad, bool, false);
+
 namespace {
 
 // These values indicate the minimum deviation shard's number of chunks need to have from the
@@ -52,12 +57,46 @@ namespace {
 const size_t kDefaultImbalanceThreshold = 2;
 const size_t kAggressiveImbalanceThreshold = 1;
 
+// How far above the average load of a zone's shards a shard's load needs to be for a rebalancing
+// migration or a split of its hot chunks to be initiated.
+const double kLoadImbalanceRatio = 1.2;
+
+// Total load, in operations per second, below which a zone is balanced by chunk count alone,
+// because the observed load is too small to be representative.
+const double kMinLoadToBalance = 100;
+
+/**
+ * Returns the average load per shard for the specified zone, or zero if the zone's load is too
+ * small to balance by.
+ */
+double idealLoadPerShardForTag(const ShardStatisticsVector& shardStats,
+                               const DistributionStatus& distribution,
+                               const string& tag) {
+    double totalLoad = 0;
+    size_t numShardsWithTag = 0;
+
+    for (const auto& stat : shardStats) {
+        totalLoad += distribution.loadOfShardWithTag(stat.shardId, tag);
+        if (tag.empty() || stat.shardTags.count(tag)) {
+            numShardsWithTag++;
+        }
+    }
+
+    if (!numShardsWithTag || totalLoad < kMinLoadToBalance) {
+        return 0;
+    }
+
+    return totalLoad / numShardsWithTag;
+}
+
 }  // namespace
 
 DistributionStatus::DistributionStatus(NamespaceString nss, ShardToChunksMap shardToChunksMap)
     : _nss(std::move(nss)),
       _shardChunks(std::move(shardToChunksMap)),
-      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()) {}
+      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()),
+      _chunkLoads(SimpleBSONObjComparator::kInstance
+                      .makeBSONObjIndexedMap<ClusterStatistics::ChunkLoad>()) {}
 
 size_t DistributionStatus::totalChunks() const {
     size_t total = 0;
@@ -173,6 +212,38 @@ string DistributionStatus::getTagForChunk(const ChunkType& chunk) const {
     return "";
 }
 
+void DistributionStatus::addChunkLoad(const ClusterStatistics::ChunkLoad& chunkLoad) {
+    _chunkLoads[chunkLoad.min] = chunkLoad;
+}
+
+const ClusterStatistics::ChunkLoad* DistributionStatus::findChunkLoad(
+    const ChunkType& chunk) const {
+    const auto it = _chunkLoads.find(chunk.getMin());
+    if (it == _chunkLoads.end() ||
+        SimpleBSONObjComparator::kInstance.evaluate(it->second.max != chunk.getMax())) {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+double DistributionStatus::getChunkLoad(const ChunkType& chunk) const {
+    const auto chunkLoad = findChunkLoad(chunk);
+    return chunkLoad ? chunkLoad->load() : 0;
+}
+
+double DistributionStatus::loadOfShardWithTag(const ShardId& shardId, const string& tag) const {
+    double total = 0;
+
+    for (const auto& chunk : getChunks(shardId)) {
+        if (tag == getTagForChunk(chunk)) {
+            total += getChunkLoad(chunk);
+        }
+    }
+
+    return total;
+}
+
 void DistributionStatus::report(BSONObjBuilder* builder) const {
     builder->append("ns", _nss.ns());
 
@@ -419,6 +490,13 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
             continue;
         }
 
+        // Even out the observed load first, so that the chunk count balancing below, which moves
+        // the least loaded chunks, works around the hot chunks
+        if (distribution.hasChunkLoad()) {
+            while (_singleZoneLoadBalance(shardStats, distribution, tag, &migrations, usedShards))
+                ;
+        }
+
         // Calculate the ceiling of the optimal number of chunks per shard
         const size_t idealNumberOfChunksPerShardForTag =
             (totalNumberOfChunksWithTag / totalNumberOfShardsWithTag) +
@@ -452,6 +530,127 @@ boost::optional<MigrateInfo> BalancerPolicy::balanceSingleChunk(
     return MigrateInfo(newShardId, chunk);
 }
 
+vector<LoadSplitInfo> BalancerPolicy::selectHotChunksToSplit(
+    const ShardStatisticsVector& shardStats, const DistributionStatus& distribution) {
+    vector<LoadSplitInfo> splits;
+
+    if (!distribution.hasChunkLoad()) {
+        return splits;
+    }
+
+    vector<string> tagsPlusEmpty(distribution.tags().begin(), distribution.tags().end());
+    tagsPlusEmpty.push_back("");
+
+    for (const auto& tag : tagsPlusEmpty) {
+        const double idealLoad = idealLoadPerShardForTag(shardStats, distribution, tag);
+        if (idealLoad == 0)
+            continue;
+
+        for (const auto& stat : shardStats) {
+            if (distribution.loadOfShardWithTag(stat.shardId, tag) <=
+                idealLoad * kLoadImbalanceRatio)
+                continue;
+
+            for (const auto& chunk : distribution.getChunks(stat.shardId)) {
+                if (distribution.getTagForChunk(chunk) != tag)
+                    continue;
+
+                const auto chunkLoad = distribution.findChunkLoad(chunk);
+                if (!chunkLoad || chunkLoad->load() <= idealLoad / 2)
+                    continue;
+
+                const BSONObj& splitPoint = chunkLoad->splitPoint;
+                if (splitPoint.isEmpty() || splitPoint.woCompare(chunk.getMin()) <= 0 ||
+                    splitPoint.woCompare(chunk.getMax()) >= 0) {
+                    LOG(1) << "Chunk " << redact(chunk.toString()) << " has a load of "
+                           << chunkLoad->load() << ", but no split point to divide it";
+                    continue;
+                }
+
+                splits.emplace_back(chunk, splitPoint);
+            }
+        }
+    }
+
+    return splits;
+}
+
+bool BalancerPolicy::_singleZoneLoadBalance(const ShardStatisticsVector& shardStats,
+                                            const DistributionStatus& distribution,
+                                            const string& tag,
+                                            vector<MigrateInfo>* migrations,
+                                            set<ShardId>* usedShards) {
+    const double idealLoad = idealLoadPerShardForTag(shardStats, distribution, tag);
+    if (idealLoad == 0)
+        return false;
+
+    ShardId from;
+    double maxLoad = 0;
+    ShardId to;
+    double minLoad = numeric_limits<double>::max();
+
+    for (const auto& stat : shardStats) {
+        if (usedShards->count(stat.shardId))
+            continue;
+
+        const double load = distribution.loadOfShardWithTag(stat.shardId, tag);
+
+        if (load > maxLoad) {
+            from = stat.shardId;
+            maxLoad = load;
+        }
+
+        if (load < minLoad && isShardSuitableReceiver(stat, tag).isOK()) {
+            to = stat.shardId;
+            minLoad = load;
+        }
+    }
+
+    if (!from.isValid() || !to.isValid() || from == to)
+        return false;
+
+    if (maxLoad <= idealLoad * kLoadImbalanceRatio)
+        return false;
+
+    // A chunk heavier than this would leave either shard further from the average than before
+    const double maxChunkLoad = std::min(maxLoad - idealLoad, idealLoad - minLoad);
+
+    LOG(1) << "collection : " << distribution.nss().ns();
+    LOG(1) << "zone       : " << tag;
+    LOG(1) << "donor      : " << from << " load " << maxLoad;
+    LOG(1) << "receiver   : " << to << " load " << minLoad;
+    LOG(1) << "ideal load : " << idealLoad;
+
+    const ChunkType* hottest = nullptr;
+    double hottestLoad = 0;
+
+    for (const auto& chunk : distribution.getChunks(from)) {
+        if (distribution.getTagForChunk(chunk) != tag)
+            continue;
+
+        if (chunk.getJumbo())
+            continue;
+
+        const double chunkLoad = distribution.getChunkLoad(chunk);
+        if (chunkLoad <= hottestLoad || chunkLoad > maxChunkLoad)
+            continue;
+
+        hottest = &chunk;
+        hottestLoad = chunkLoad;
+    }
+
+    if (!hottest) {
+        LOG(1) << "No chunk on " << from << " fits the load gap of " << maxChunkLoad
+               << "; its hot chunks need to be split first";
+        return false;
+    }
+
+    migrations->emplace_back(to, *hottest);
+    invariant(usedShards->insert(from).second);
+    invariant(usedShards->insert(to).second);
+    return true;
+}
+
 bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
                                         const DistributionStatus& distribution,
                                         const string& tag,
@@ -496,9 +695,19 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
     if (imbalance < imbalanceThreshold)
         return false;
 
+    // Move the least loaded chunk, so that evening out the chunk counts disturbs the load as
+    // little as possible, and never push the receiver so far above the average load that
+    // _singleZoneLoadBalance would move load back
+    const double idealLoad = idealLoadPerShardForTag(shardStats, distribution, tag);
+    const double maxChunkLoad = idealLoad > 0
+        ? idealLoad * kLoadImbalanceRatio - distribution.loadOfShardWithTag(to, tag)
+        : numeric_limits<double>::max();
+
     const vector<ChunkType>& chunks = distribution.getChunks(from);
 
     unsigned numJumboChunks = 0;
+    const ChunkType* coldest = nullptr;
+    double coldestLoad = 0;
 
     for (const auto& chunk : chunks) {
         if (distribution.getTagForChunk(chunk) != tag)
@@ -509,8 +718,17 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
             continue;
         }
 
-        migrations->emplace_back(to, chunk);
-        invariant(usedShards->insert(chunk.getShard()).second);
+        const double chunkLoad = distribution.getChunkLoad(chunk);
+        if (chunkLoad > maxChunkLoad || (coldest && chunkLoad >= coldestLoad))
+            continue;
+
+        coldest = &chunk;
+        coldestLoad = chunkLoad;
+    }
+
+    if (coldest) {
+        migrations->emplace_back(to, *coldest);
+        invariant(usedShards->insert(coldest->getShard()).second);
         invariant(usedShards->insert(to).second);
         return true;
     }
@@ -531,6 +749,14 @@ string ZoneRange::toString() const {
     return str::stream() << min << " -->> " << max << "  on  " << zone;
 }
 
+LoadSplitInfo::LoadSplitInfo(const ChunkType& a_chunk, const BSONObj& a_splitPoint)
+    : chunk(a_chunk), splitPoint(a_splitPoint.getOwned()) {}
+
+string LoadSplitInfo::toString() const {
+    return str::stream() << chunk.getNS().ns() << ": [" << chunk.getMin() << ", "
+                         << chunk.getMax() << ") at " << splitPoint;
+}
+
 MigrateInfo::MigrateInfo(const ShardId& a_to, const ChunkType& a_chunk) {
     invariant(a_chunk.validate());
     invariant(a_to.isValid());
@@ -36,11 +36,16 @@
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_id.h"
 
 namespace mongo {
 
+// Whether the balancer places chunks by the load the shards observe on them, in addition to
+// evening out chunk counts.
+extern AtomicBool balancerUseChunkLoad;
+
 struct ZoneRange {
     ZoneRange(const BSONObj& a_min, const BSONObj& a_max, const std::string& _zone);
 
@@ -66,6 +71,19 @@ struct MigrateInfo {
     ChunkVersion version;
 };
 
+/**
+ * Describes a chunk which carries too much load to be balanced by moving it whole, along with the
+ * key at which to split it.
+ */
+struct LoadSplitInfo {
+    LoadSplitInfo(const ChunkType& a_chunk, const BSONObj& a_splitPoint);
+
+    std::string toString() const;
+
+    ChunkType chunk;
+    BSONObj splitPoint;
+};
+
 typedef std::vector<ClusterStatistics::ShardStatistics> ShardStatisticsVector;
 typedef std::map<ShardId, std::vector<ChunkType>> ShardToChunksMap;
 
@@ -140,6 +158,36 @@ public:
      */
     std::string getTagForChunk(const ChunkType& chunk) const;
 
+    /**
+     * Records the load observed on a chunk of the collection. Loads, which do not match the bounds
+     * of a chunk exactly, are never returned by getChunkLoad.
+     */
+    void addChunkLoad(const ClusterStatistics::ChunkLoad& chunkLoad);
+
+    /**
+     * Returns whether the load of any chunk has been recorded, which makes the balancer place
+     * chunks by load.
+     */
+    bool hasChunkLoad() const {
+        return !_chunkLoads.empty();
+    }
+
+    /**
+     * Returns the load reported for the specified chunk, or nullptr if none was reported.
+     */
+    const ClusterStatistics::ChunkLoad* findChunkLoad(const ChunkType& chunk) const;
+
+    /**
+     * Returns the load observed on the specified chunk, or zero if none was reported.
+     */
+    double getChunkLoad(const ChunkType& chunk) const;
+
+    /**
+     * Returns the total load observed on the chunks in the specified shard, which have the given
+     * tag.
+     */
+    double loadOfShardWithTag(const ShardId& shardId, const std::string& tag) const;
+
     /**
      * Returns a BSON/string representation of this distribution status.
      */
@@ -158,6 +206,9 @@ private:
 
     // Set of all zones defined for this collection
     std::set<std::string> _allTags;
+
+    // Map of chunk min key to the load observed on that chunk
+    BSONObjIndexedMap<ClusterStatistics::ChunkLoad> _chunkLoads;
 };
 
 class BalancerPolicy {
@@ -181,6 +232,10 @@ public:
      * any of the shards have chunks, which are sufficiently higher than this number, suggests
      * moving chunks to shards, which are under this number.
      *
+     * If chunk loads were recorded in the distribution, shards whose load is sufficiently above
+     * the average for a zone first move their hottest chunks, which fit between them and the
+     * least loaded shard, and the chunk count balancing then moves the least loaded chunks.
+     *
      * The shouldAggressivelyBalance parameter causes the threshold for chunk could disparity
      * between shards to be lowered.
      *
@@ -201,6 +256,14 @@ public:
                                                            const ShardStatisticsVector& shardStats,
                                                            const DistributionStatus& distribution);
 
+    /**
+     * Using the chunk loads recorded in the distribution, returns the chunks on overloaded shards
+     * which each carry more than half of a zone's average per-shard load. Such chunks cannot be
+     * balanced by moving them whole, so they should be split at their reported split point.
+     */
+    static std::vector<LoadSplitInfo> selectHotChunksToSplit(
+        const ShardStatisticsVector& shardStats, const DistributionStatus& distribution);
+
 private:
     /**
      * Return the shard with the specified tag, which has the least number of chunks. If the tag is
@@ -220,6 +283,21 @@ private:
                                            const std::string& chunkTag,
                                            const std::set<ShardId>& excludedShards);
 
+    /**
+     * Selects one chunk for the specified zone (if appropriate) to be moved from the shard with
+     * the highest observed load to the one with the lowest, if the former is sufficiently above
+     * the zone's average per-shard load. Only chunks whose load fits in the gap between both shards
+     * and the average are considered, so that a move never makes the receiver the new hotspot.
+     *
+     * Returns true if a migration was suggested, false otherwise. This method is intented to be
+     * called multiple times until all posible migrations for a zone have been selected.
+     */
+    static bool _singleZoneLoadBalance(const ShardStatisticsVector& shardStats,
+                                       const DistributionStatus& distribution,
+                                       const std::string& tag,
+                                       std::vector<MigrateInfo>* migrations,
+                                       std::set<ShardId>* usedShards);
+
     /**
      * Selects one chunk for the specified zone (if appropriate) to be moved in order to bring the
      * deviation of the shards chunk contents closer to even across all shards in the specified
@@ -36,6 +36,7 @@
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 namespace {
@@ -118,6 +119,188 @@ std::vector<MigrateInfo> balanceChunks(const ShardStatisticsVector& shardStats,
         shardStats, distribution, shouldAggressivelyBalance, &usedShards);
 }
 
+/**
+ * Records the specified load, in operations per second, for each chunk of the shard in order.
+ */
+void addChunkLoads(DistributionStatus* distribution,
+                   const ShardToChunksMap& chunkMap,
+                   const ShardId& shardId,
+                   const vector<double>& opsPerSec,
+                   bool withSplitPoints = false) {
+    const auto& chunks = chunkMap.at(shardId);
+    ASSERT_EQ(chunks.size(), opsPerSec.size());
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        ClusterStatistics::ChunkLoad chunkLoad;
+        chunkLoad.min = chunks[i].getMin();
+        chunkLoad.max = chunks[i].getMax();
+        chunkLoad.opsPerSec = opsPerSec[i];
+        if (withSplitPoints) {
+            chunkLoad.splitPoint = BSON("x" << (i + 0.5));
+        }
+        distribution->addChunkLoad(chunkLoad);
+    }
+}
+
+/**
+ * Simulates the load based balancing of a collection, whose chunks each receive a fixed share of
+ * the load, spread evenly across their key range. Splitting a chunk divides its load in half and
+ * migrations move the load along with the chunk.
+ */
+class ChunkLoadSimulator {
+public:
+    struct SimulatedChunk {
+        int64_t min;
+        int64_t max;
+        ShardId shardId;
+        double opsPerSec;
+    };
+
+    ChunkLoadSimulator(const vector<std::pair<ShardId, vector<double>>>& shardsAndChunkLoads) {
+        const int64_t kChunkWidth = 1024;
+
+        int64_t currentKey = 0;
+        for (const auto& entry : shardsAndChunkLoads) {
+            _shardStats.emplace_back(
+                entry.first, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion);
+            for (double opsPerSec : entry.second) {
+                _chunks.push_back({currentKey, currentKey + kChunkWidth, entry.first, opsPerSec});
+                currentKey += kChunkWidth;
+            }
+        }
+    }
+
+    /**
+     * Runs balancing rounds, each of which splits the selected hot chunks and then performs the
+     * suggested migrations, until a round changes nothing. Returns the number of rounds run.
+     */
+    int run(int maxRounds) {
+        for (int round = 0; round < maxRounds; round++) {
+            const auto splits =
+                BalancerPolicy::selectHotChunksToSplit(_shardStats, _makeDistribution());
+            for (const auto& split : splits) {
+                _split(split);
+            }
+
+            const auto migrations = balanceChunks(_shardStats, _makeDistribution(), false);
+            for (const auto& migration : migrations) {
+                _migrate(migration);
+            }
+
+            if (splits.empty() && migrations.empty()) {
+                return round;
+            }
+        }
+
+        FAIL("Balancing did not converge");
+        return maxRounds;
+    }
+
+    double totalLoad() const {
+        double total = 0;
+        for (const auto& chunk : _chunks) {
+            total += chunk.opsPerSec;
+        }
+        return total;
+    }
+
+    double loadOfShard(const ShardId& shardId) const {
+        double total = 0;
+        for (const auto& chunk : _chunks) {
+            if (chunk.shardId == shardId) {
+                total += chunk.opsPerSec;
+            }
+        }
+        return total;
+    }
+
+    const ShardStatisticsVector& shardStats() const {
+        return _shardStats;
+    }
+
+private:
+    BSONObj _minKey(size_t i) const {
+        return i == 0 ? kMinBSONKey : BSON("x" << _chunks[i].min);
+    }
+
+    BSONObj _maxKey(size_t i) const {
+        return i == _chunks.size() - 1 ? kMaxBSONKey : BSON("x" << _chunks[i].max);
+    }
+
+    size_t _findChunk(const BSONObj& minKey) const {
+        for (size_t i = 0; i < _chunks.size(); i++) {
+            if (SimpleBSONObjComparator::kInstance.evaluate(_minKey(i) == minKey)) {
+                return i;
+            }
+        }
+
+        FAIL(str::stream() << "No chunk starts at " << minKey);
+        return 0;
+    }
+
+    DistributionStatus _makeDistribution() {
+        ShardToChunksMap chunkMap;
+        for (const auto& stat : _shardStats) {
+            chunkMap[stat.shardId];
+        }
+
+        vector<ClusterStatistics::ChunkLoad> chunkLoads;
+
+        for (size_t i = 0; i < _chunks.size(); i++) {
+            ChunkType chunk;
+            chunk.setNS(kNamespace);
+            chunk.setMin(_minKey(i));
+            chunk.setMax(_maxKey(i));
+            chunk.setShard(_chunks[i].shardId);
+            chunk.setVersion(_chunkVersion);
+            _chunkVersion.incMajor();
+
+            ClusterStatistics::ChunkLoad chunkLoad;
+            chunkLoad.min = chunk.getMin();
+            chunkLoad.max = chunk.getMax();
+            chunkLoad.opsPerSec = _chunks[i].opsPerSec;
+            if (_chunks[i].max - _chunks[i].min > 1) {
+                chunkLoad.splitPoint = BSON("x" << (_chunks[i].min + _chunks[i].max) / 2);
+            }
+            chunkLoads.push_back(std::move(chunkLoad));
+
+            chunkMap[_chunks[i].shardId].push_back(std::move(chunk));
+        }
+
+        DistributionStatus distribution(kNamespace, std::move(chunkMap));
+        for (const auto& chunkLoad : chunkLoads) {
+            distribution.addChunkLoad(chunkLoad);
+        }
+
+        return distribution;
+    }
+
+    void _split(const LoadSplitInfo& split) {
+        const size_t i = _findChunk(split.chunk.getMin());
+        const int64_t splitKey = split.splitPoint["x"].numberLong();
+        ASSERT_GT(splitKey, _chunks[i].min);
+        ASSERT_LT(splitKey, _chunks[i].max);
+
+        SimulatedChunk upper = _chunks[i];
+        upper.min = splitKey;
+        upper.opsPerSec /= 2;
+
+        _chunks[i].max = splitKey;
+        _chunks[i].opsPerSec /= 2;
+        _chunks.insert(_chunks.begin() + i + 1, upper);
+    }
+
+    void _migrate(const MigrateInfo& migration) {
+        const size_t i = _findChunk(migration.minKey);
+        ASSERT_EQ(migration.from, _chunks[i].shardId);
+        _chunks[i].shardId = migration.to;
+    }
+
+    ShardStatisticsVector _shardStats;
+    vector<SimulatedChunk> _chunks;
+    ChunkVersion _chunkVersion{1, 0, OID::gen()};
+};
+
 TEST(BalancerPolicy, Basic) {
     auto cluster = generateCluster(
         {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
@@ -609,6 +792,121 @@ TEST(BalancerPolicy, BalancerHandlesNoShardsWithTag) {
     ASSERT(balanceChunks(cluster.first, distribution, false).empty());
 }
 
+TEST(BalancerPolicy, LoadBalancingMovesHotChunkWhichFitsTheLoadGap) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addChunkLoads(&distribution, cluster.second, kShardId0, {100, 40, 10, 10});
+    addChunkLoads(&distribution, cluster.second, kShardId1, {10, 10, 10, 10});
+
+    // The average load is 100, so moving the chunk with 100 would only swap the hot shard
+    const auto migrations(balanceChunks(cluster.first, distribution, false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), migrations[0].maxKey);
+
+    ASSERT(BalancerPolicy::selectHotChunksToSplit(cluster.first, distribution).empty());
+}
+
+TEST(BalancerPolicy, LoadBalancingSplitsChunkWhichIsTooHotToMove) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addChunkLoads(&distribution, cluster.second, kShardId0, {0, 300, 0, 0}, true);
+
+    // The hot chunk is left in place and the chunk count balancing moves a cold chunk instead
+    const auto migrations(balanceChunks(cluster.first, distribution, false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), migrations[0].minKey);
+
+    const auto splits = BalancerPolicy::selectHotChunksToSplit(cluster.first, distribution);
+    ASSERT_EQ(1U, splits.size());
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), splits[0].chunk.getMin());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 1.5), splits[0].splitPoint);
+}
+
+TEST(BalancerPolicy, LoadBalancingCountBalancesEvenlyLoadedChunksByMovingTheLeastLoaded) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 6, false, emptyTagSet, emptyShardVersion), 6},
+         {ShardStatistics(kShardId1, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addChunkLoads(&distribution, cluster.second, kShardId0, {20, 5, 20, 20, 20, 15});
+    addChunkLoads(&distribution, cluster.second, kShardId1, {50, 50});
+
+    // The load is even, but every chunk has some, so the chunk counts are evened out by moving
+    // the least loaded chunk
+    const auto migrations(balanceChunks(cluster.first, distribution, false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), migrations[0].maxKey);
+}
+
+TEST(BalancerPolicy, LoadBalancingDoesNotSplitChunkWithoutSplitPoint) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2},
+         {ShardStatistics(kShardId1, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addChunkLoads(&distribution, cluster.second, kShardId0, {300, 0});
+
+    ASSERT(BalancerPolicy::selectHotChunksToSplit(cluster.first, distribution).empty());
+    ASSERT(balanceChunks(cluster.first, distribution, false).empty());
+}
+
+TEST(BalancerPolicy, LoadBalancingIgnoresLoadBelowMinimum) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addChunkLoads(&distribution, cluster.second, kShardId0, {20, 20, 20, 20}, true);
+
+    ASSERT(balanceChunks(cluster.first, distribution, false).empty());
+    ASSERT(BalancerPolicy::selectHotChunksToSplit(cluster.first, distribution).empty());
+}
+
+TEST(BalancerPolicy, LoadBalancingSimulationConvergesWithSkewedLoad) {
+    ChunkLoadSimulator simulator({{kShardId0, {200, 150, 100, 50}},
+                                  {kShardId1, {25, 25, 25, 25}},
+                                  {kShardId2, {25, 25, 25, 25}},
+                                  {kShardId3, {25, 25, 25, 25}}});
+
+    const double idealLoad = simulator.totalLoad() / simulator.shardStats().size();
+
+    const int rounds = simulator.run(50);
+    ASSERT_GT(rounds, 0);
+
+    for (const auto& stat : simulator.shardStats()) {
+        ASSERT_LTE(simulator.loadOfShard(stat.shardId), idealLoad * 1.2) << stat.shardId;
+    }
+}
+
+TEST(BalancerPolicy, LoadBalancingSimulationConvergesWithSingleHotChunk) {
+    ChunkLoadSimulator simulator({{kShardId0, {0, 1000, 0, 0}},
+                                  {kShardId1, {0, 0, 0, 0}},
+                                  {kShardId2, {0, 0, 0, 0}},
+                                  {kShardId3, {0, 0, 0, 0}}});
+
+    const double idealLoad = simulator.totalLoad() / simulator.shardStats().size();
+
+    simulator.run(50);
+
+    for (const auto& stat : simulator.shardStats()) {
+        ASSERT_LTE(simulator.loadOfShard(stat.shardId), idealLoad * 1.2) << stat.shardId;
+    }
+}
+
 TEST(DistributionStatus, AddTagRangeOverlap) {
     DistributionStatus d(kNamespace, ShardToChunksMap{});
 
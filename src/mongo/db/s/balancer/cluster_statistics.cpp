@@ -30,15 +30,102 @@
 
 #include "mongo/db/s/balancer/cluster_statistics.h"
 
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
+constexpr double ClusterStatistics::ChunkLoad::kBytesPerOp;
+
 ClusterStatistics::ClusterStatistics() = default;
 
 ClusterStatistics::~ClusterStatistics() = default;
 
+double ClusterStatistics::ChunkLoad::load() const {
+    return opsPerSec + bytesPerSec / kBytesPerOp;
+}
+
+StatusWith<ClusterStatistics::CollectionChunkLoads> ClusterStatistics::parseChunkLoad(
+    const BSONObj& chunkLoadSection) {
+    CollectionChunkLoads chunkLoads;
+
+    BSONElement collectionsElem;
+    Status status =
+        bsonExtractTypedField(chunkLoadSection, "collections", Array, &collectionsElem);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    for (const auto& collectionElem : collectionsElem.Obj()) {
+        if (collectionElem.type() != Object) {
+            return {ErrorCodes::TypeMismatch,
+                    str::stream() << "Invalid chunk load entry " << collectionElem};
+        }
+        const BSONObj collection = collectionElem.Obj();
+
+        std::string ns;
+        status = bsonExtractStringField(collection, "ns", &ns);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        BSONElement chunksElem;
+        status = bsonExtractTypedField(collection, "chunks", Array, &chunksElem);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        auto& loads = chunkLoads[ns];
+        for (const auto& chunkElem : chunksElem.Obj()) {
+            if (chunkElem.type() != Object) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << "Invalid chunk load entry " << chunkElem};
+            }
+            const BSONObj chunk = chunkElem.Obj();
+
+            ChunkLoad load;
+
+            BSONElement boundElem;
+            status = bsonExtractTypedField(chunk, "min", Object, &boundElem);
+            if (!status.isOK()) {
+                return status;
+            }
+            load.min = boundElem.Obj().getOwned();
+
+            status = bsonExtractTypedField(chunk, "max", Object, &boundElem);
+            if (!status.isOK()) {
+                return status;
+            }
+            load.max = boundElem.Obj().getOwned();
+
+            status = bsonExtractDoubleField(chunk, "opsPerSec", &load.opsPerSec);
+            if (!status.isOK()) {
+                return status;
+            }
+
+            status = bsonExtractDoubleField(chunk, "bytesPerSec", &load.bytesPerSec);
+            if (!status.isOK()) {
+                return status;
+            }
+
+            BSONElement splitPointElem;
+            status = bsonExtractTypedField(chunk, "splitPoint", Object, &splitPointElem);
+            if (status.isOK()) {
+                load.splitPoint = splitPointElem.Obj().getOwned();
+            } else if (status != ErrorCodes::NoSuchKey) {
+                return status;
+            }
+
+            loads.push_back(std::move(load));
+        }
+    }
+
+    return chunkLoads;
+}
+
 ClusterStatistics::ShardStatistics::ShardStatistics(ShardId inShardId,
                                                     uint64_t inMaxSizeMB,
                                                     uint64_t inCurrSizeMB,
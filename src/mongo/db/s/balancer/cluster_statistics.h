@@ -28,17 +28,18 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/s/client/shard.h"
 
 namespace mongo {
 
-class BSONObj;
 class OperationContext;
 template <typename T>
 class StatusWith;
@@ -52,6 +53,38 @@ class ClusterStatistics {
     MONGO_DISALLOW_COPYING(ClusterStatistics);
 
 public:
+    /**
+     * Structure, which describes the load observed on a single chunk by the shard which owns it.
+     */
+    struct ChunkLoad {
+        /**
+         * Returns the load as a single figure, in which transferring kBytesPerOp bytes counts the
+         * same as one operation.
+         */
+        double load() const;
+
+        // Number of transferred bytes weighted the same as a single operation
+        static constexpr double kBytesPerOp = 16 * 1024;
+
+        BSONObj min;
+        BSONObj max;
+
+        double opsPerSec{0};
+        double bytesPerSec{0};
+
+        // Shard key, which divides the observed load of the chunk roughly in half. Empty if the
+        // shard has not sampled enough keys from the chunk.
+        BSONObj splitPoint;
+    };
+
+    // Map from collection namespace to the load of its chunks on a shard
+    typedef std::map<std::string, std::vector<ChunkLoad>> CollectionChunkLoads;
+
+    /**
+     * Parses the 'chunkLoad' serverStatus section reported by a shard.
+     */
+    static StatusWith<CollectionChunkLoads> parseChunkLoad(const BSONObj& chunkLoadSection);
+
     /**
      * Structure, which describes the statistics of a single shard host.
      */
@@ -92,6 +125,9 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // Load observed on the shard's chunks. Only collected when the balancer balances by load.
+        CollectionChunkLoads chunkLoads;
     };
 
     virtual ~ClusterStatistics();
@@ -37,6 +37,7 @@
 #include "mongo/base/status_with.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/client/read_preference.h"
+#include "mongo/db/s/balancer/balancer_policy.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
@@ -48,16 +49,18 @@ namespace mongo {
 namespace {
 
 const char kVersionField[] = "version";
+const char kChunkLoadField[] = "chunkLoad";
 
 /**
- * Executes the serverStatus command against the specified shard and obtains the version of the
- * running MongoD service.
+ * Executes the serverStatus command against the specified shard, including the per-chunk load
+ * section if requested.
  *
- * Returns the MongoD version in strig format or an error. Known error codes are:
+ * Returns the serverStatus response or an error. Known error codes are:
  *  ShardNotFound if shard by that id is not available on the registry
- *  NoSuchKey if the version could not be retrieved
  */
-StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId shardId) {
+StatusWith<BSONObj> retrieveShardServerStatus(OperationContext* opCtx,
+                                              ShardId shardId,
+                                              bool includeChunkLoad) {
     auto shardRegistry = Grid::get(opCtx)->shardRegistry();
     auto shardStatus = shardRegistry->getShard(opCtx, shardId);
     if (!shardStatus.isOK()) {
@@ -69,7 +72,8 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         shard->runCommandWithFixedRetryAttempts(opCtx,
                                                 ReadPreferenceSetting{ReadPreference::PrimaryOnly},
                                                 "admin",
-                                                BSON("serverStatus" << 1),
+                                                BSON("serverStatus" << 1 << kChunkLoadField
+                                                                    << includeChunkLoad),
                                                 Shard::RetryPolicy::kIdempotent);
     if (!commandResponse.isOK()) {
         return commandResponse.getStatus();
@@ -78,15 +82,7 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         return commandResponse.getValue().commandStatus;
     }
 
-    BSONObj serverStatus = std::move(commandResponse.getValue().response);
-
-    std::string version;
-    Status status = bsonExtractStringField(serverStatus, kVersionField, &version);
-    if (!status.isOK()) {
-        return status;
-    }
-
-    return version;
+    return std::move(commandResponse.getValue().response);
 }
 
 }  // namespace
@@ -132,16 +128,38 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
                                       << shard.getName());
         }
 
+        const bool useChunkLoad = balancerUseChunkLoad.load();
+
         std::string mongoDVersion;
+        ClusterStatistics::CollectionChunkLoads chunkLoads;
+
+        auto serverStatusStatus =
+            retrieveShardServerStatus(opCtx, shard.getName(), useChunkLoad);
+        if (serverStatusStatus.isOK()) {
+            const auto& serverStatus = serverStatusStatus.getValue();
 
-        auto mongoDVersionStatus = retrieveShardMongoDVersion(opCtx, shard.getName());
-        if (mongoDVersionStatus.isOK()) {
-            mongoDVersion = std::move(mongoDVersionStatus.getValue());
-        } else {
             // Since the mongod version is only used for reporting, there is no need to fail the
             // entire round if it cannot be retrieved, so just leave it empty
+            auto status = bsonExtractStringField(serverStatus, kVersionField, &mongoDVersion);
+            if (!status.isOK()) {
+                log() << "Unable to obtain shard version for " << shard.getName()
+                      << causedBy(status);
+            }
+
+            // Without load information the shard is balanced by chunk count alone
+            const auto chunkLoadElem = serverStatus[kChunkLoadField];
+            if (useChunkLoad && chunkLoadElem.type() == Object) {
+                auto swChunkLoads = ClusterStatistics::parseChunkLoad(chunkLoadElem.Obj());
+                if (swChunkLoads.isOK()) {
+                    chunkLoads = std::move(swChunkLoads.getValue());
+                } else {
+                    log() << "Unable to obtain chunk load for " << shard.getName()
+                          << causedBy(swChunkLoads.getStatus());
+                }
+            }
+        } else {
             log() << "Unable to obtain shard version for " << shard.getName()
-                  << causedBy(mongoDVersionStatus.getStatus());
+                  << causedBy(serverStatusStatus.getStatus());
         }
 
         std::set<std::string> shardTags;
@@ -156,6 +174,7 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+        stats.back().chunkLoads = std::move(chunkLoads);
     }
 
     return stats;
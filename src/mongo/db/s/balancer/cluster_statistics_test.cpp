@@ -28,6 +28,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/base/status_with.h"
 #include "mongo/db/s/balancer/cluster_statistics.h"
 #include "mongo/unittest/unittest.h"
 
@@ -47,5 +48,53 @@ TEST(ShardStatistics, SizeMaxedTest) {
                .isSizeMaxed());
 }
 
+TEST(ClusterStatistics, ParseChunkLoad) {
+    const auto swChunkLoads = ClusterStatistics::parseChunkLoad(BSON(
+        "windowMillis" << 60000 << "collections"
+                       << BSON_ARRAY(BSON(
+                              "ns"
+                              << "TestDB.TestColl"
+                              << "chunks"
+                              << BSON_ARRAY(BSON("min" << BSON("x" << 0) << "max" << BSON("x" << 10)
+                                                       << "opsPerSec"
+                                                       << 100
+                                                       << "bytesPerSec"
+                                                       << 16384.0
+                                                       << "splitPoint"
+                                                       << BSON("x" << 5))
+                                            << BSON("min" << BSON("x" << 10) << "max"
+                                                          << BSON("x" << 20)
+                                                          << "opsPerSec"
+                                                          << 1.5
+                                                          << "bytesPerSec"
+                                                          << 0))))));
+    ASSERT_OK(swChunkLoads.getStatus());
+
+    const auto& chunkLoads = swChunkLoads.getValue();
+    ASSERT_EQ(1U, chunkLoads.size());
+
+    const auto& loads = chunkLoads.at("TestDB.TestColl");
+    ASSERT_EQ(2U, loads.size());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 0), loads[0].min);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 10), loads[0].max);
+    ASSERT_EQ(101, loads[0].load());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 5), loads[0].splitPoint);
+    ASSERT_EQ(1.5, loads[1].load());
+    ASSERT(loads[1].splitPoint.isEmpty());
+}
+
+TEST(ClusterStatistics, ParseChunkLoadRejectsMissingBounds) {
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              ClusterStatistics::parseChunkLoad(
+                  BSON("collections" << BSON_ARRAY(BSON(
+                           "ns"
+                           << "TestDB.TestColl"
+                           << "chunks"
+                           << BSON_ARRAY(BSON("min" << BSON("x" << 0) << "opsPerSec" << 100
+                                                    << "bytesPerSec"
+                                                    << 0))))))
+                  .getStatus());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,233 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/chunk_load_statistics.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/s/collection_metadata.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/s/catalog/type_chunk.h"
+
+namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(chunkLoadSampleRate, int, 100)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue, "chunkLoadSampleRate must not be negative");
+        }
+        return Status::OK();
+    });
+
+MONGO_EXPORT_SERVER_PARAMETER(chunkLoadWindowSecs, int, 60)->withValidator([](const int& newVal) {
+    if (newVal < 1) {
+        return Status(ErrorCodes::BadValue, "chunkLoadWindowSecs must be at least 1");
+    }
+    return Status::OK();
+});
+
+namespace {
+
+const auto getChunkLoadStatistics = ServiceContext::declareDecoration<ChunkLoadStatistics>();
+
+}  // namespace
+
+constexpr size_t ChunkLoadStatistics::kMaxReportedChunks;
+constexpr size_t ChunkLoadStatistics::kMaxSampledKeys;
+constexpr size_t ChunkLoadStatistics::kMinSampledKeysForSplit;
+
+ChunkLoadStatistics::ChunkLoadStatistics()
+    : _random(static_cast<int64_t>(Date_t::now().toMillisSinceEpoch())) {}
+
+ChunkLoadStatistics& ChunkLoadStatistics::get(ServiceContext* serviceContext) {
+    return getChunkLoadStatistics(serviceContext);
+}
+
+ChunkLoadStatistics& ChunkLoadStatistics::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+bool ChunkLoadStatistics::shouldSample() {
+    const int sampleRate = chunkLoadSampleRate.load();
+    if (sampleRate <= 0) {
+        return false;
+    }
+
+    thread_local int countdown = 0;
+    if (--countdown > 0) {
+        return false;
+    }
+
+    countdown = sampleRate;
+    return true;
+}
+
+void ChunkLoadStatistics::record(const CollectionMetadata& metadata,
+                                 const BSONObj& shardKey,
+                                 long long bytes,
+                                 Date_t now) {
+    const int sampleRate = chunkLoadSampleRate.load();
+    if (sampleRate <= 0 || shardKey.isEmpty()) {
+        return;
+    }
+
+    ChunkType chunk;
+    if (!metadata.getNextChunk(shardKey, &chunk) || shardKey.woCompare(chunk.getMin()) < 0) {
+        return;
+    }
+
+    const auto& ns = metadata.getChunkManager()->getns().ns();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _rotateIfNeeded(lk, now);
+
+    auto collIt = _current.collections.find(ns);
+    if (collIt == _current.collections.end()) {
+        collIt = _current.collections
+                     .emplace(ns,
+                              SimpleBSONObjComparator::kInstance
+                                  .makeBSONObjIndexedMap<ChunkCounters>())
+                     .first;
+    }
+
+    auto& chunks = collIt->second;
+    auto it = chunks.find(chunk.getMin());
+    if (it == chunks.end()) {
+        it = chunks.emplace(chunk.getMin().getOwned(), ChunkCounters()).first;
+        it->second.max = chunk.getMax().getOwned();
+    } else if (it->second.max.woCompare(chunk.getMax())) {
+        // The chunk was split or merged since it was last sampled, so its counters no longer
+        // describe its current bounds
+        it->second = ChunkCounters();
+        it->second.max = chunk.getMax().getOwned();
+    }
+
+    auto& counters = it->second;
+    counters.ops += sampleRate;
+    counters.bytes += bytes * sampleRate;
+
+    // Reservoir sampling keeps every sampled key equally likely to be retained
+    counters.numSampledKeys++;
+    if (counters.sampledKeys.size() < kMaxSampledKeys) {
+        counters.sampledKeys.push_back(shardKey.getOwned());
+    } else {
+        const auto slot = _random.nextInt64(counters.numSampledKeys);
+        if (slot < static_cast<long long>(kMaxSampledKeys)) {
+            counters.sampledKeys[slot] = shardKey.getOwned();
+        }
+    }
+}
+
+void ChunkLoadStatistics::report(BSONObjBuilder* builder, Date_t now) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _rotateIfNeeded(lk, now);
+
+    // Until the first window completes, report the partial one
+    const Window& window = (_previous.end != Date_t()) ? _previous : _current;
+    const Date_t windowEnd = (window.end != Date_t()) ? window.end : now;
+    const long long windowMillis =
+        std::max(durationCount<Milliseconds>(windowEnd - window.start), 1LL);
+    const double windowSecs = windowMillis / 1000.0;
+
+    builder->append("windowMillis", windowMillis);
+
+    BSONArrayBuilder collectionsArr(builder->subarrayStart("collections"));
+    for (const auto& collection : window.collections) {
+        using ChunkEntry = std::pair<const BSONObj, ChunkCounters>;
+
+        std::vector<const ChunkEntry*> hottest;
+        for (const auto& entry : collection.second) {
+            hottest.push_back(&entry);
+        }
+        std::sort(hottest.begin(), hottest.end(), [](const ChunkEntry* a, const ChunkEntry* b) {
+            return a->second.ops > b->second.ops;
+        });
+        if (hottest.size() > kMaxReportedChunks) {
+            hottest.resize(kMaxReportedChunks);
+        }
+
+        BSONObjBuilder collectionBuilder(collectionsArr.subobjStart());
+        collectionBuilder.append("ns", collection.first);
+
+        BSONArrayBuilder chunksArr(collectionBuilder.subarrayStart("chunks"));
+        for (const auto* entry : hottest) {
+            const auto& counters = entry->second;
+
+            BSONObjBuilder chunkBuilder(chunksArr.subobjStart());
+            chunkBuilder.append("min", entry->first);
+            chunkBuilder.append("max", counters.max);
+            chunkBuilder.append("opsPerSec", counters.ops / windowSecs);
+            chunkBuilder.append("bytesPerSec", counters.bytes / windowSecs);
+
+            if (counters.sampledKeys.size() >= kMinSampledKeysForSplit) {
+                auto keys = counters.sampledKeys;
+                auto median = keys.begin() + keys.size() / 2;
+                std::nth_element(
+                    keys.begin(), median, keys.end(), [](const BSONObj& a, const BSONObj& b) {
+                        return a.woCompare(b) < 0;
+                    });
+
+                // Splitting at the chunk's own min key would not divide its load
+                if (median->woCompare(entry->first) > 0) {
+                    chunkBuilder.append("splitPoint", *median);
+                }
+            }
+
+            chunkBuilder.doneFast();
+        }
+        chunksArr.doneFast();
+
+        collectionBuilder.doneFast();
+    }
+    collectionsArr.doneFast();
+}
+
+void ChunkLoadStatistics::_rotateIfNeeded(WithLock, Date_t now) {
+    if (_current.start == Date_t()) {
+        _current.start = now;
+        return;
+    }
+
+    if (now - _current.start < Seconds(chunkLoadWindowSecs.load())) {
+        return;
+    }
+
+    _current.end = now;
+    _previous = std::move(_current);
+
+    _current = Window();
+    _current.start = now;
+}
+
+}  // namespace mongo
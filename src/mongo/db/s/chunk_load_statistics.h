@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/random.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class CollectionMetadata;
+class OperationContext;
+class ServiceContext;
+
+// One in how many operations against sharded collections is sampled for chunk load statistics.
+// Zero disables sampling.
+extern AtomicInt32 chunkLoadSampleRate;
+
+// Length of the window over which chunk load is accumulated before it is reported.
+extern AtomicInt32 chunkLoadWindowSecs;
+
+/**
+ * Samples the operations and bytes served by each chunk of the sharded collections owned by this
+ * shard, so that the balancer can place chunks by observed load rather than by count. Reads are
+ * sampled from the shard filtering stage and writes from the shard op observer.
+ *
+ * Load is accumulated over fixed windows of chunkLoadWindowSecs and the last complete window is
+ * reported through the 'chunkLoad' serverStatus section. Alongside each chunk's rate a split point
+ * is reported, chosen as the median of the shard keys sampled from it, which divides the chunk's
+ * observed load roughly in half.
+ */
+class ChunkLoadStatistics {
+    MONGO_DISALLOW_COPYING(ChunkLoadStatistics);
+
+public:
+    // Maximum number of chunks reported per collection, hottest first
+    static constexpr size_t kMaxReportedChunks = 128;
+
+    // Maximum number of shard keys kept per chunk from which to choose its split point
+    static constexpr size_t kMaxSampledKeys = 32;
+
+    // Minimum number of shard keys sampled from a chunk before a split point is reported for it
+    static constexpr size_t kMinSampledKeysForSplit = 8;
+
+    ChunkLoadStatistics();
+
+    static ChunkLoadStatistics& get(ServiceContext* serviceContext);
+    static ChunkLoadStatistics& get(OperationContext* opCtx);
+
+    /**
+     * Returns true if the calling thread's current operation should be recorded. Sampling is a
+     * per-thread countdown, so this is cheap enough to call for every document.
+     */
+    static bool shouldSample();
+
+    /**
+     * Records a sampled operation, which touched 'bytes' bytes, against the chunk of 'metadata'
+     * that contains 'shardKey'. The counters are scaled by the sampling rate, so that they
+     * estimate the full load. Keys which do not belong to this shard are ignored.
+     */
+    void record(const CollectionMetadata& metadata,
+                const BSONObj& shardKey,
+                long long bytes,
+                Date_t now);
+
+    /**
+     * Appends the per-chunk load of the last complete window for every collection, in the format
+     * parsed by the balancer's cluster statistics.
+     */
+    void report(BSONObjBuilder* builder, Date_t now);
+
+private:
+    struct ChunkCounters {
+        BSONObj max;
+        long long ops{0};
+        long long bytes{0};
+
+        // Reservoir of shard keys sampled from the chunk and the number of keys offered to it
+        std::vector<BSONObj> sampledKeys;
+        long long numSampledKeys{0};
+    };
+
+    struct Window {
+        Date_t start;
+        Date_t end;
+
+        // Namespace to counters for each chunk, keyed by the chunk's min key
+        std::map<std::string, BSONObjIndexedMap<ChunkCounters>> collections;
+    };
+
+    /**
+     * Completes the current window if it has lasted at least chunkLoadWindowSecs.
+     */
+    void _rotateIfNeeded(WithLock, Date_t now);
+
+    stdx::mutex _mutex;
+
+    Window _current;
+    Window _previous;
+
+    PseudoRandom _random;
+};
+
+}  // namespace mongo
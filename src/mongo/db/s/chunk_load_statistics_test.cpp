@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/s/chunk_load_statistics.h"
+#include "mongo/db/s/collection_metadata.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.foo");
+const ShardId kThisShard("thisShard");
+const ShardId kOtherShard("otherShard");
+
+/**
+ * Returns metadata for a collection sharded on 'x', of which this shard owns [0, 100) and the
+ * other shard owns the rest.
+ */
+std::unique_ptr<CollectionMetadata> makeCollectionMetadata() {
+    const OID epoch = OID::gen();
+    const KeyPattern shardKeyPattern(BSON("x" << 1));
+
+    ChunkVersion version{1, 0, epoch};
+
+    std::vector<ChunkType> allChunks;
+    allChunks.emplace_back(
+        kNss, ChunkRange{shardKeyPattern.globalMin(), BSON("x" << 0)}, version, kOtherShard);
+    version.incMajor();
+    allChunks.emplace_back(kNss, ChunkRange{BSON("x" << 0), BSON("x" << 100)}, version, kThisShard);
+    version.incMajor();
+    allChunks.emplace_back(
+        kNss, ChunkRange{BSON("x" << 100), shardKeyPattern.globalMax()}, version, kOtherShard);
+
+    auto rt = RoutingTableHistory::makeNew(
+        kNss, UUID::gen(), shardKeyPattern, nullptr, false, epoch, allChunks);
+    std::shared_ptr<ChunkManager> cm = std::make_shared<ChunkManager>(rt, Timestamp(100, 0));
+    return stdx::make_unique<CollectionMetadata>(cm, kThisShard);
+}
+
+TEST(ChunkLoadStatistics, ReportsLoadAndSplitPointOfLastWindow) {
+    const auto metadata = makeCollectionMetadata();
+    const int sampleRate = chunkLoadSampleRate.load();
+    const Date_t start = Date_t::now();
+
+    ChunkLoadStatistics stats;
+    for (int i = 0; i < 10; i++) {
+        stats.record(*metadata, BSON("x" << i), 1024, start + Seconds(i));
+    }
+
+    // Keys owned by the other shard are not recorded
+    stats.record(*metadata, BSON("x" << 150), 1024, start);
+
+    BSONObjBuilder builder;
+    stats.report(&builder, start + Seconds(chunkLoadWindowSecs.load()));
+    const BSONObj report = builder.obj();
+
+    ASSERT_EQ(chunkLoadWindowSecs.load() * 1000LL, report["windowMillis"].numberLong());
+
+    const auto collections = report["collections"].Array();
+    ASSERT_EQ(1U, collections.size());
+    ASSERT_EQ(kNss.ns(), collections[0]["ns"].String());
+
+    const auto chunks = collections[0]["chunks"].Array();
+    ASSERT_EQ(1U, chunks.size());
+
+    const BSONObj chunk = chunks[0].Obj();
+    ASSERT_BSONOBJ_EQ(BSON("x" << 0), chunk["min"].Obj());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 100), chunk["max"].Obj());
+    ASSERT_APPROX_EQUAL(
+        10.0 * sampleRate / chunkLoadWindowSecs.load(), chunk["opsPerSec"].numberDouble(), 0.001);
+    ASSERT_APPROX_EQUAL(10.0 * 1024 * sampleRate / chunkLoadWindowSecs.load(),
+                        chunk["bytesPerSec"].numberDouble(),
+                        0.001);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 5), chunk["splitPoint"].Obj());
+}
+
+TEST(ChunkLoadStatistics, NoSplitPointWithFewSampledKeys) {
+    const auto metadata = makeCollectionMetadata();
+    const Date_t start = Date_t::now();
+
+    ChunkLoadStatistics stats;
+    for (size_t i = 0; i < ChunkLoadStatistics::kMinSampledKeysForSplit - 1; i++) {
+        stats.record(*metadata, BSON("x" << static_cast<int>(i)), 0, start);
+    }
+
+    BSONObjBuilder builder;
+    stats.report(&builder, start + Seconds(1));
+    const BSONObj report = builder.obj();
+
+    const auto chunks = report["collections"].Array()[0]["chunks"].Array();
+    ASSERT_EQ(1U, chunks.size());
+    ASSERT(!chunks[0].Obj().hasField("splitPoint"));
+}
+
+}  // namespace
+}  // namespace mongo
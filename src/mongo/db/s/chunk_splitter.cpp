@@ -40,6 +40,7 @@
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/split_chunk.h"
 #include "mongo/db/s/split_vector.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -52,6 +53,16 @@
 #include "mongo/util/log.h"
 
 namespace mongo {
+
+// The number of shard key index entries within a chunk, from which auto-split estimates the split
+// points instead of scanning the chunk, or 0 to always scan it
+MONGO_EXPORT_SERVER_PARAMETER(autoSplitSampleSize, int, 0)->withValidator([](const int& newVal) {
+    if (newVal < 0) {
+        return Status(ErrorCodes::BadValue, "autoSplitSampleSize must not be negative");
+    }
+    return Status::OK();
+});
+
 namespace {
 
 /**
@@ -306,16 +317,34 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                << " dataWritten since last check: " << dataWritten
                << " maxChunkSizeBytes: " << maxChunkSizeBytes;
 
-        auto splitPoints = uassertStatusOK(splitVector(opCtx.get(),
-                                                       nss,
-                                                       shardKeyPattern.toBSON(),
-                                                       chunk.getMin(),
-                                                       chunk.getMax(),
-                                                       false,
-                                                       boost::none,
-                                                       boost::none,
-                                                       boost::none,
-                                                       maxChunkSizeBytes));
+        auto splitPoints = [&] {
+            const int numSamples = autoSplitSampleSize.load();
+            if (numSamples > 0) {
+                auto sampledSplitPoints =
+                    uassertStatusOK(sampleSplitPoints(opCtx.get(),
+                                                      nss,
+                                                      shardKeyPattern.toBSON(),
+                                                      chunk.getMin(),
+                                                      chunk.getMax(),
+                                                      boost::none,
+                                                      maxChunkSizeBytes,
+                                                      numSamples));
+                if (sampledSplitPoints) {
+                    return std::move(*sampledSplitPoints);
+                }
+            }
+
+            return uassertStatusOK(splitVector(opCtx.get(),
+                                               nss,
+                                               shardKeyPattern.toBSON(),
+                                               chunk.getMin(),
+                                               chunk.getMax(),
+                                               false,
+                                               boost::none,
+                                               boost::none,
+                                               boost::none,
+                                               maxChunkSizeBytes));
+        }();
 
         if (splitPoints.size() <= 1) {
             // No split points means there isn't enough data to split on; 1 split point means we
@@ -38,9 +38,11 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/operation_context.h"
@@ -68,6 +70,8 @@ MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchDelayMS, int, 20)
         return Status::OK();
     });
 
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchedDeletes, bool, true);
+
 namespace {
 
 using Deletion = CollectionRangeDeleter::Deletion;
@@ -77,6 +81,82 @@ const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 WriteConcernOptions::SyncMode::UNSET,
                                                 Seconds(60));
 
+Counter64 batchesStats;
+ServerStatusMetricField<Counter64> displayBatches("rangeDeleter.batches", &batchesStats);
+
+Counter64 docsDeletedStats;
+ServerStatusMetricField<Counter64> displayDocsDeleted("rangeDeleter.docsDeleted",
+                                                      &docsDeletedStats);
+
+Counter64 bytesDeletedStats;
+ServerStatusMetricField<Counter64> displayBytesDeleted("rangeDeleter.bytesDeleted",
+                                                       &bytesDeletedStats);
+
+// Sum of the bytesRemaining estimates of every range being deleted on this shard.
+Counter64 orphanBytesRemainingStats;
+ServerStatusMetricField<Counter64> displayOrphanBytesRemaining("rangeDeleter.orphanBytesRemaining",
+                                                               &orphanBytesRemainingStats);
+
+// Number of random index entries drawn to estimate the share of the collection in a range.
+const long long kRangeEstimateSamples{1000};
+
+/**
+ * Estimates the size of the documents in [min, max) of the given index, whose bounds must be in
+ * index key format. Runs under the collection lock, so its cost must not grow with the range: if
+ * the collection has more records than kRangeEstimateSamples, the share of its data in the range
+ * is estimated from random entries of the index, otherwise the keys in the range are counted.
+ * Without random index cursors, the whole collection's data size is the estimate.
+ */
+long long estimateBytesInRange(OperationContext* opCtx,
+                               Collection* collection,
+                               const IndexDescriptor* descriptor,
+                               const BSONObj& min,
+                               const BSONObj& max) {
+    const long long numRecords = collection->numRecords(opCtx);
+    if (numRecords <= kRangeEstimateSamples) {
+        auto exec = InternalPlanner::indexScan(opCtx,
+                                               collection,
+                                               descriptor,
+                                               min,
+                                               max,
+                                               BoundInclusion::kIncludeStartKeyOnly,
+                                               PlanExecutor::YIELD_MANUAL,
+                                               InternalPlanner::FORWARD);
+        long long numKeys = 0;
+        while (exec->getNext(nullptr, nullptr) == PlanExecutor::ADVANCED) {
+            ++numKeys;
+        }
+        return numKeys * collection->averageObjectSize(opCtx);
+    }
+
+    const long long dataSize = collection->dataSize(opCtx);
+    auto cursor = collection->getIndexCatalog()->getIndex(descriptor)->newRandomCursor(opCtx);
+    if (!cursor) {
+        return dataSize;
+    }
+
+    const Ordering ordering = Ordering::make(descriptor->keyPattern());
+    long long numSamples = 0;
+    long long numInRange = 0;
+    while (numSamples < kRangeEstimateSamples) {
+        auto entry = cursor->next(SortedDataInterface::Cursor::kWantKey);
+        if (!entry) {
+            break;
+        }
+        ++numSamples;
+
+        if (entry->key.woCompare(min, ordering, false) >= 0 &&
+            entry->key.woCompare(max, ordering, false) < 0) {
+            ++numInRange;
+        }
+    }
+
+    if (numSamples == 0) {
+        return dataSize;
+    }
+    return dataSize * numInRange / numSamples;
+}
+
 boost::optional<DeleteNotification> checkOverlap(std::list<Deletion> const& deletions,
                                                  ChunkRange const& range) {
     // Start search with newest entries by using reverse iterators
@@ -107,6 +187,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     CollectionRangeDeleter* forTestOnly) {
 
     StatusWith<int> wrote = 0;
+    bool estimateRangeBytes = false;
 
     auto range = boost::optional<ChunkRange>(boost::none);
     auto notification = DeleteNotification();
@@ -171,6 +252,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
             const auto& frontRange = orphans.front().range;
             range.emplace(frontRange.getMin().getOwned(), frontRange.getMax().getOwned());
             notification = orphans.front().notification;
+            estimateRangeBytes = !orphans.front().bytesRemaining;
         }
 
         invariant(range);
@@ -207,7 +289,15 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
 
         try {
             const auto keyPattern = scopedCollectionMetadata->getKeyPattern();
-            wrote = self->_doDeletion(opCtx, collection, keyPattern, *range, maxToDelete);
+            BatchStats stats;
+            wrote = self->_doDeletion(
+                opCtx, collection, keyPattern, *range, maxToDelete, estimateRangeBytes, &stats);
+
+            stdx::lock_guard<stdx::mutex> scopedLock(css->_metadataManager->_managerLock);
+            if (!notification.ready()) {
+                invariant(!self->isEmpty() && self->_orphans.front().notification == notification);
+                self->_updateBytesRemaining(stats);
+            }
         } catch (const DBException& e) {
             wrote = e.toStatus();
             warning() << e.what();
@@ -289,7 +379,9 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
                                                     Collection* collection,
                                                     BSONObj const& keyPattern,
                                                     ChunkRange const& range,
-                                                    int maxToDelete) {
+                                                    int maxToDelete,
+                                                    bool estimateRangeBytes,
+                                                    BatchStats* stats) {
     invariant(collection != nullptr);
     invariant(!isEmpty());
 
@@ -331,9 +423,66 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         saver.emplace("moveChunk", nss.ns(), "cleaning");
     }
 
+    if (estimateRangeBytes) {
+        stats->rangeBytesEstimate = estimateBytesInRange(opCtx, collection, descriptor, min, max);
+    }
+
     auto halfOpen = BoundInclusion::kIncludeStartKeyOnly;
     auto manual = PlanExecutor::YIELD_MANUAL;
     auto forward = InternalPlanner::FORWARD;
+
+    if (rangeDeleterBatchedDeletes.load() && !saver) {
+        // Gather the whole batch from the index alone, then delete it in one WriteUnitOfWork
+        // instead of one per document.
+        std::vector<RecordId> batch;
+        batch.reserve(maxToDelete);
+        {
+            auto exec = InternalPlanner::indexScan(
+                opCtx, collection, descriptor, min, max, halfOpen, manual, forward);
+
+            while (batch.size() < static_cast<size_t>(maxToDelete)) {
+                RecordId rloc;
+                BSONObj obj;
+                PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+                if (state == PlanExecutor::IS_EOF) {
+                    break;
+                }
+                if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                    warning() << PlanExecutor::statestr(state)
+                              << " - cursor error while trying to delete " << redact(min) << " to "
+                              << redact(max) << " in " << nss << ": "
+                              << redact(WorkingSetCommon::toStatusString(obj))
+                              << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                    break;
+                }
+                invariant(PlanExecutor::ADVANCED == state);
+                batch.push_back(std::move(rloc));
+            }
+        }
+
+        if (batch.empty()) {
+            return 0;
+        }
+
+        size_t numDeleted = 0;
+        int64_t bytesDeleted = 0;
+        writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
+            WriteUnitOfWork wuow(opCtx);
+            numDeleted =
+                collection->deleteDocuments(opCtx, batch, nullptr, true, false, &bytesDeleted);
+            wuow.commit();
+        });
+
+        batchesStats.increment();
+        docsDeletedStats.increment(numDeleted);
+        bytesDeletedStats.increment(bytesDeleted);
+        stats->bytesDeleted = bytesDeleted;
+
+        // Report the size of the batch rather than the documents actually deleted, so that a batch
+        // whose documents were all removed concurrently does not end the range early.
+        return static_cast<int>(batch.size());
+    }
+
     auto fetch = InternalPlanner::IXSCAN_FETCH;
 
     auto exec = InternalPlanner::indexScan(
@@ -355,6 +504,7 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
             break;
         }
         invariant(PlanExecutor::ADVANCED == state);
+        const int objSize = obj.objsize();
 
         exec->saveState();
         writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
@@ -365,6 +515,10 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
             collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             wuow.commit();
         });
+        stats->bytesDeleted += objSize;
+        docsDeletedStats.increment();
+        bytesDeletedStats.increment(objSize);
+
         auto restoreStateStatus = exec->restoreState();
         if (!restoreStateStatus.isOK()) {
             warning() << "error restoring cursor state while trying to delete " << redact(min)
@@ -376,6 +530,10 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
 
     } while (++numDeleted < maxToDelete);
 
+    if (numDeleted > 0) {
+        batchesStats.increment();
+    }
+
     return numDeleted;
 }
 
@@ -416,6 +574,8 @@ boost::optional<Date_t> CollectionRangeDeleter::add(std::list<Deletion> ranges)
 }
 
 void CollectionRangeDeleter::append(BSONObjBuilder* builder) const {
+    builder->append("orphanBytesRemaining", orphanBytesRemaining());
+
     BSONArrayBuilder arr(builder->subarrayStart("rangesToClean"));
     for (auto const& entry : _orphans) {
         BSONObjBuilder obj;
@@ -438,9 +598,18 @@ bool CollectionRangeDeleter::isEmpty() const {
     return _orphans.empty() && _delayedOrphans.empty();
 }
 
+long long CollectionRangeDeleter::orphanBytesRemaining() const {
+    long long total = 0;
+    for (auto const& entry : _orphans) {
+        total += entry.bytesRemaining.value_or(0);
+    }
+    return total;
+}
+
 void CollectionRangeDeleter::clear(Status status) {
     for (auto& range : _orphans) {
         range.notification.notify(status);  // wake up anything still waiting
+        orphanBytesRemainingStats.decrement(range.bytesRemaining.value_or(0));
     }
     _orphans.clear();
     for (auto& range : _delayedOrphans) {
@@ -451,9 +620,24 @@ void CollectionRangeDeleter::clear(Status status) {
 
 void CollectionRangeDeleter::_pop(Status result) {
     _orphans.front().notification.notify(result);  // wake up waitForClean
+    orphanBytesRemainingStats.decrement(_orphans.front().bytesRemaining.value_or(0));
     _orphans.pop_front();
 }
 
+void CollectionRangeDeleter::_updateBytesRemaining(const BatchStats& stats) {
+    auto& front = _orphans.front();
+    const long long before = front.bytesRemaining.value_or(0);
+    const long long start = stats.rangeBytesEstimate.value_or(before);
+    const long long after = std::max(start - stats.bytesDeleted, 0LL);
+
+    front.bytesRemaining = after;
+    if (after > before) {
+        orphanBytesRemainingStats.increment(after - before);
+    } else {
+        orphanBytesRemainingStats.decrement(before - after);
+    }
+}
+
 // DeleteNotification
 
 CollectionRangeDeleter::DeleteNotification::DeleteNotification()
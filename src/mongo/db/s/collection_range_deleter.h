@@ -46,6 +46,10 @@ class OperationContext;
 // next batch of deletions.
 extern AtomicInt32 rangeDeleterBatchDelayMS;
 
+// Whether each batch of orphan documents is deleted in a single WriteUnitOfWork, rather than one
+// document per WriteUnitOfWork.
+extern AtomicBool rangeDeleterBatchedDeletes;
+
 class CollectionRangeDeleter {
     MONGO_DISALLOW_COPYING(CollectionRangeDeleter);
 
@@ -110,6 +114,10 @@ public:
         ChunkRange range;
         Date_t whenToDelete;  // A value of Date_t{} means immediately.
         DeleteNotification notification{};
+
+        // Estimated size of the documents left to delete in the range. Unset until deletion of
+        // the range begins.
+        boost::optional<long long> bytesRemaining;
     };
 
     CollectionRangeDeleter();
@@ -145,6 +153,12 @@ public:
 
     bool isEmpty() const;
 
+    /**
+     * Reports the estimated size of the orphan documents still to be deleted, summed over the
+     * ranges whose deletion has begun.
+     */
+    long long orphanBytesRemaining() const;
+
     /*
      * Notifies with the specified status anything waiting on ranges scheduled, and then discards
      * the ranges and notifications.  Is called in the destructor.
@@ -174,9 +188,21 @@ public:
                                                     CollectionRangeDeleter* forTestOnly = nullptr);
 
 private:
+    /**
+     * Progress made by a single call to _doDeletion.
+     */
+    struct BatchStats {
+        long long bytesDeleted{0};
+
+        // Size of the documents in the range before the batch was deleted. Only set when the
+        // caller asked for it.
+        boost::optional<long long> rangeBytesEstimate;
+    };
+
     /**
      * Performs the deletion of up to maxToDelete entries within the range in progress. Must be
-     * called under the collection lock.
+     * called under the collection lock. If estimateRangeBytes is true, also estimates the size of
+     * all documents in the range before deleting any of them.
      *
      * Returns the number of documents deleted, 0 if done with the range, or bad status if deleting
      * the range failed.
@@ -185,7 +211,15 @@ private:
                                 Collection* collection,
                                 const BSONObj& keyPattern,
                                 ChunkRange const& range,
-                                int maxToDelete);
+                                int maxToDelete,
+                                bool estimateRangeBytes,
+                                BatchStats* stats);
+
+    /**
+     * Records the progress of a batch against the range at the front of the queue, which must
+     * still be the range the batch was run on.
+     */
+    void _updateBytesRemaining(const BatchStats& stats);
 
     /**
      * Removes the latest-scheduled range from the ranges to be cleaned up, and notifies any
@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/logical_session_id.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/repl/replication_coordinator_mock.h"
+#include "mongo/db/service_context_d_test_fixture.h"
+#include "mongo/db/storage/storage_engine_init.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/platform/random.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.orphans");
+
+const int kNumDocuments = 20 * 1000;
+
+// Matches the default range deleter batch size, internalQueryExecYieldIterations.
+const int kBatchSize = 128;
+
+/**
+ * Starts the WiredTiger storage engine in a temporary directory, with a mock replication
+ * coordinator which accepts writes, for the lifetime of the benchmark binary.
+ */
+class StorageHarness {
+public:
+    StorageHarness() : _dbpath("collection_range_deleter_bm") {
+        auto serviceContext = getGlobalServiceContext();
+
+        storageGlobalParams.dbpath = _dbpath.path();
+        storageGlobalParams.engine = "wiredTiger";
+        storageGlobalParams.engineSetByUser = true;
+        createLockFile(serviceContext);
+        initializeStorageEngine(serviceContext, StorageEngineInitFlags::kNone);
+
+        // Since the storage engine is already initialized, this only sets up the client and the
+        // op observers.
+        _fixture.setUp();
+
+        auto replCoord = stdx::make_unique<repl::ReplicationCoordinatorMock>(serviceContext);
+        invariant(replCoord->setFollowerMode(repl::MemberState::RS_PRIMARY));
+        repl::ReplicationCoordinator::set(serviceContext, std::move(replCoord));
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    ServiceContextMongoDTest _fixture;
+};
+
+/**
+ * (Re)creates the collection with an _id and a secondary index, filled with kNumDocuments
+ * documents, all of which are orphans to be deleted.
+ */
+void loadCollection(OperationContext* opCtx) {
+    writeConflictRetry(opCtx, "loadCollection", kNss.ns(), [&] {
+        AutoGetOrCreateDb autoDb(opCtx, kNss.db(), MODE_X);
+        auto db = autoDb.getDb();
+
+        WriteUnitOfWork wuow(opCtx);
+        if (db->getCollection(opCtx, kNss)) {
+            uassertStatusOK(db->dropCollection(opCtx, kNss.ns()));
+        }
+        auto collection = db->createCollection(opCtx, kNss.ns());
+        uassertStatusOK(collection->getIndexCatalog()->createIndexOnEmptyCollection(
+            opCtx,
+            BSON("v" << 2 << "key" << BSON("x" << 1) << "name"
+                     << "x_1"
+                     << "ns"
+                     << kNss.ns())));
+        wuow.commit();
+    });
+
+    AutoGetCollection autoColl(opCtx, kNss, MODE_IX);
+    PseudoRandom random(1);
+    for (int first = 0; first < kNumDocuments; first += kBatchSize) {
+        WriteUnitOfWork wuow(opCtx);
+        for (int id = first; id < first + kBatchSize && id < kNumDocuments; id++) {
+            uassertStatusOK(autoColl.getCollection()->insertDocument(
+                opCtx,
+                InsertStatement(BSON("_id" << id << "x" << random.nextInt32(kNumDocuments)
+                                           << "payload"
+                                           << std::string(200, 'p'))),
+                nullptr,
+                false));
+        }
+        wuow.commit();
+    }
+}
+
+/**
+ * Returns the RecordIds of the next 'batchSize' documents in _id order, as the range deleter's
+ * key-only scan of the shard key index does.
+ */
+std::vector<RecordId> nextBatch(OperationContext* opCtx, Collection* collection, int batchSize) {
+    const IndexDescriptor* idIndex = collection->getIndexCatalog()->findIdIndex(opCtx);
+    auto exec = InternalPlanner::indexScan(opCtx,
+                                           collection,
+                                           idIndex,
+                                           BSON("" << MINKEY),
+                                           BSON("" << MAXKEY),
+                                           BoundInclusion::kIncludeBothStartAndEndKeys,
+                                           PlanExecutor::NO_YIELD);
+    std::vector<RecordId> batch;
+    RecordId rloc;
+    while (static_cast<int>(batch.size()) < batchSize &&
+           exec->getNext(nullptr, &rloc) == PlanExecutor::ADVANCED) {
+        batch.push_back(rloc);
+    }
+    return batch;
+}
+
+/**
+ * The range deleter's per-document path: one WriteUnitOfWork per deleted document.
+ */
+void deletePerDocument(OperationContext* opCtx, Collection* collection) {
+    for (auto batch = nextBatch(opCtx, collection, kBatchSize); !batch.empty();
+         batch = nextBatch(opCtx, collection, kBatchSize)) {
+        for (const auto& rloc : batch) {
+            WriteUnitOfWork wuow(opCtx);
+            collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
+            wuow.commit();
+        }
+    }
+}
+
+/**
+ * The range deleter's batched path: one Collection::deleteDocuments call and WriteUnitOfWork per
+ * batch.
+ */
+void deleteBatched(OperationContext* opCtx, Collection* collection) {
+    for (auto batch = nextBatch(opCtx, collection, kBatchSize); !batch.empty();
+         batch = nextBatch(opCtx, collection, kBatchSize)) {
+        WriteUnitOfWork wuow(opCtx);
+        collection->deleteDocuments(opCtx, batch, nullptr, true);
+        wuow.commit();
+    }
+}
+
+/**
+ * Measures the deletion of every document of a collection with an _id and one secondary index, in
+ * batches gathered like the range deleter does, reloading the collection between iterations.
+ */
+void BM_RangeDelete(benchmark::State& state,
+                    void (*deleteRange)(OperationContext*, Collection*)) {
+    static StorageHarness harness;
+    auto opCtx = cc().makeOperationContext();
+
+    for (auto keepRunning : state) {
+        state.PauseTiming();
+        loadCollection(opCtx.get());
+        AutoGetCollection autoColl(opCtx.get(), kNss, MODE_IX);
+        state.ResumeTiming();
+
+        deleteRange(opCtx.get(), autoColl.getCollection());
+    }
+
+    state.SetItemsProcessed(state.iterations() * kNumDocuments);
+}
+
+BENCHMARK_CAPTURE(BM_RangeDelete, perDocument, deletePerDocument)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_RangeDelete, batched, deleteBatched)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mongo
@@ -45,6 +45,7 @@
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/shard_server_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -385,5 +386,124 @@ TEST_F(CollectionRangeDeleterTest, MultipleDocumentsInMultipleRangesToClean) {
     ASSERT_FALSE(next(rangeDeleter, 1));
 }
 
+// Tests that batched deletions remove the keys of the deleted documents from every index.
+TEST_F(CollectionRangeDeleterTest, BatchedDeletionsRemoveKeysFromEveryIndex) {
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    dbclient.createIndex(kNss.toString(), BSON("a" << 1));
+    for (int i = 0; i < 5; ++i) {
+        dbclient.insert(kNss.toString(), BSON(kShardKey << i << "a" << i));
+    }
+    dbclient.insert(kNss.toString(), BSON(kShardKey << 10 << "a" << 10));
+
+    std::list<Deletion> ranges;
+    auto deletion = Deletion{ChunkRange(BSON(kShardKey << 0), BSON(kShardKey << 10)), Date_t{}};
+    ranges.emplace_back(std::move(deletion));
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+
+    ASSERT_TRUE(next(rangeDeleter, 100));
+    ASSERT_TRUE(next(rangeDeleter, 100));
+
+    // The projections are covered by the hinted index, so any key left behind would be returned
+    // even though its document is gone.
+    const BSONObj idProjection = BSON(kShardKey << 1);
+    const BSONObj aProjection = BSON(kShardKey << 0 << "a" << 1);
+    auto idCursor = dbclient.query(kNss.toString(),
+                                   Query(BSON(kShardKey << GTE << 0)).hint(kShardKeyPattern),
+                                   0,
+                                   0,
+                                   &idProjection);
+    ASSERT_EQUALS(1, idCursor->itcount());
+    auto aCursor = dbclient.query(
+        kNss.toString(), Query(BSON("a" << GTE << 0)).hint(BSON("a" << 1)), 0, 0, &aProjection);
+    ASSERT_EQUALS(1, aCursor->itcount());
+}
+
+// Tests that the per-document deletion path, used when batched deletes are disabled, still removes
+// the whole range.
+TEST_F(CollectionRangeDeleterTest, PerDocumentDeletionsCleanWholeRange) {
+    rangeDeleterBatchedDeletes.store(false);
+    ON_BLOCK_EXIT([] { rangeDeleterBatchedDeletes.store(true); });
+
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 0; i < 5; ++i) {
+        dbclient.insert(kNss.toString(), BSON(kShardKey << i));
+    }
+    dbclient.insert(kNss.toString(), BSON(kShardKey << 10));
+
+    std::list<Deletion> ranges;
+    auto deletion = Deletion{ChunkRange(BSON(kShardKey << 0), BSON(kShardKey << 10)), Date_t{}};
+    ranges.emplace_back(std::move(deletion));
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+
+    ASSERT_TRUE(next(rangeDeleter, 2));
+    ASSERT_EQUALS(3ULL, dbclient.count(kNss.toString(), BSON(kShardKey << LT << 10)));
+    ASSERT_TRUE(next(rangeDeleter, 2));
+    ASSERT_TRUE(next(rangeDeleter, 2));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSON(kShardKey << LT << 10)));
+    ASSERT_TRUE(next(rangeDeleter, 2));
+    ASSERT_FALSE(next(rangeDeleter, 2));
+
+    // The document at the range's exclusive upper bound is not an orphan.
+    ASSERT_EQUALS(1ULL, dbclient.count(kNss.toString(), BSONObj()));
+}
+
+// Tests that the estimate of orphan bytes left to delete shrinks with every batch and is dropped
+// once the range is finished.
+TEST_F(CollectionRangeDeleterTest, TracksOrphanBytesRemaining) {
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 0; i < 4; ++i) {
+        dbclient.insert(kNss.toString(), BSON(kShardKey << i));
+    }
+    const long long docSize = BSON(kShardKey << 0).objsize();
+
+    std::list<Deletion> ranges;
+    auto deletion = Deletion{ChunkRange(BSON(kShardKey << 0), BSON(kShardKey << 10)), Date_t{}};
+    ranges.emplace_back(std::move(deletion));
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+    ASSERT_EQUALS(0LL, rangeDeleter.orphanBytesRemaining());
+
+    ASSERT_TRUE(next(rangeDeleter, 2));
+    ASSERT_EQUALS(2ULL, dbclient.count(kNss.toString(), BSONObj()));
+    ASSERT_EQUALS(2 * docSize, rangeDeleter.orphanBytesRemaining());
+
+    ASSERT_TRUE(next(rangeDeleter, 2));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSONObj()));
+    ASSERT_EQUALS(0LL, rangeDeleter.orphanBytesRemaining());
+
+    ASSERT_TRUE(next(rangeDeleter, 2));
+    ASSERT_TRUE(rangeDeleter.isEmpty());
+    ASSERT_EQUALS(0LL, rangeDeleter.orphanBytesRemaining());
+}
+
+// Tests that the orphan bytes in a range of a large collection are estimated from a sample of the
+// shard key index rather than by counting the keys in the range.
+TEST_F(CollectionRangeDeleterTest, EstimatesOrphanBytesOfLargeCollectionFromSample) {
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 0; i < 2000; ++i) {
+        dbclient.insert(kNss.toString(), BSON(kShardKey << i));
+    }
+    const long long docSize = BSON(kShardKey << 0).objsize();
+
+    std::list<Deletion> ranges;
+    auto deletion = Deletion{ChunkRange(BSON(kShardKey << 0), BSON(kShardKey << 1000)), Date_t{}};
+    ranges.emplace_back(std::move(deletion));
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+
+    ASSERT_TRUE(next(rangeDeleter, 1));
+    ASSERT_EQUALS(1999ULL, dbclient.count(kNss.toString(), BSONObj()));
+
+    // Half of the sampled index entries fall within the range, give or take the sampling error.
+    ASSERT_GTE(rangeDeleter.orphanBytesRemaining(), 800 * docSize);
+    ASSERT_LTE(rangeDeleter.orphanBytesRemaining(), 1200 * docSize);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -37,13 +37,14 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/dbhelpers.h"
-#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/s/start_chunk_clone_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/executor/task_executor.h"
@@ -63,9 +64,21 @@ namespace {
 const char kRecvChunkStatus[] = "_recvChunkStatus";
 const char kRecvChunkCommit[] = "_recvChunkCommit";
 const char kRecvChunkAbort[] = "_recvChunkAbort";
+const char kCloneStreams[] = "cloneStreams";
 
 const int kMaxObjectPerChunk{250000};
 
+// Upper bound for the migrationCloneStreams server parameter
+const int kMaxCloneStreams{16};
+
+// Every this many documents, the shard key scan done at the start of the clone remembers a key as
+// a candidate boundary between clone streams
+const unsigned long long kCloneStreamSampleInterval{1024};
+
+// Number of bytes of xfer mods the donor keeps in memory, split evenly between the reloaded and the
+// deleted document ids, before spilling them to a file under the temporary directory
+MONGO_EXPORT_SERVER_PARAMETER(migrationXferModsMaxMemoryBytes, long long, 100 * 1024 * 1024);
+
 bool isInRange(const BSONObj& obj,
                const BSONObj& min,
                const BSONObj& max,
@@ -87,44 +100,15 @@ BSONObj createRequestWithSessionId(StringData commandName,
 
 }  // namespace
 
-/**
- * Used to receive invalidation notifications from operations, which delete documents.
- */
-class DeleteNotificationStage final : public PlanStage {
-public:
-    DeleteNotificationStage(MigrationChunkClonerSourceLegacy* cloner, OperationContext* opCtx)
-        : PlanStage("SHARDING_NOTIFY_DELETE", opCtx), _cloner(cloner) {}
-
-    void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) override {
-        if (type == INVALIDATION_DELETION) {
-            stdx::lock_guard<stdx::mutex> sl(_cloner->_mutex);
-            _cloner->_cloneLocs.erase(dl);
+MONGO_EXPORT_SERVER_PARAMETER(migrationCloneStreams, int, 4)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > kMaxCloneStreams) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "migrationCloneStreams must be between 1 and "
+                                        << kMaxCloneStreams);
         }
-    }
-
-    StageState doWork(WorkingSetID* out) override {
-        MONGO_UNREACHABLE;
-    }
-
-    bool isEOF() override {
-        MONGO_UNREACHABLE;
-    }
-
-    std::unique_ptr<PlanStageStats> getStats() override {
-        MONGO_UNREACHABLE;
-    }
-
-    SpecificStats* getSpecificStats() const override {
-        MONGO_UNREACHABLE;
-    }
-
-    StageType stageType() const override {
-        return STAGE_NOTIFY_DELETE;
-    }
-
-private:
-    MigrationChunkClonerSourceLegacy* const _cloner;
-};
+        return Status::OK();
+    });
 
 /**
  * Used to commit work for LogOpForSharding. Used to keep track of changes in documents that are
@@ -150,15 +134,13 @@ public:
         switch (_op) {
             case 'd': {
                 stdx::lock_guard<stdx::mutex> sl(_cloner->_mutex);
-                _cloner->_deleted.push_back(_idObj);
-                _cloner->_memoryUsed += _idObj.firstElement().size() + 5;
+                _cloner->_deleted.push(_idObj);
             } break;
 
             case 'i':
             case 'u': {
                 stdx::lock_guard<stdx::mutex> sl(_cloner->_mutex);
-                _cloner->_reload.push_back(_idObj);
-                _cloner->_memoryUsed += _idObj.firstElement().size() + 5;
+                _cloner->_reload.push(_idObj);
             } break;
 
             default:
@@ -195,11 +177,13 @@ MigrationChunkClonerSourceLegacy::MigrationChunkClonerSourceLegacy(MoveChunkRequ
       _sessionId(MigrationSessionId::generate(_args.getFromShardId().toString(),
                                               _args.getToShardId().toString())),
       _donorConnStr(std::move(donorConnStr)),
-      _recipientHost(std::move(recipientHost)) {}
+      _recipientHost(std::move(recipientHost)),
+      _reload(storageGlobalParams.dbpath + "/_tmp", migrationXferModsMaxMemoryBytes.load() / 2),
+      _deleted(storageGlobalParams.dbpath + "/_tmp", migrationXferModsMaxMemoryBytes.load() / 2) {}
 
 MigrationChunkClonerSourceLegacy::~MigrationChunkClonerSourceLegacy() {
     invariant(_state == kDone);
-    invariant(!_deleteNotifyExec);
+    invariant(_cloneStreamsRemaining == 0);
 }
 
 Status MigrationChunkClonerSourceLegacy::startClone(OperationContext* opCtx) {
@@ -234,6 +218,9 @@ Status MigrationChunkClonerSourceLegacy::startClone(OperationContext* opCtx) {
                                             _shardKeyPattern.toBSON(),
                                             _args.getSecondaryThrottle());
 
+    // Recipients which do not understand this field fetch the streams one after another
+    cmdBuilder.append(kCloneStreams, getNumCloneStreams());
+
     auto startChunkCloneResponseStatus = _callRecipient(cmdBuilder.obj());
     if (!startChunkCloneResponseStatus.isOK()) {
         return startChunkCloneResponseStatus.getStatus();
@@ -276,18 +263,20 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
 
         stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-        const std::size_t cloneLocsRemaining = _cloneLocs.size();
+        const int cloneStreamsRemaining = _cloneStreamsRemaining;
 
-        log() << "moveChunk data transfer progress: " << redact(res) << " mem used: " << _memoryUsed
-              << " documents remaining to clone: " << cloneLocsRemaining;
+        log() << "moveChunk data transfer progress: " << redact(res)
+              << " mem used: " << _memoryUsed()
+              << " spilled to disk: " << _reload.spilledBytes() + _deleted.spilledBytes()
+              << " clone streams remaining: " << cloneStreamsRemaining;
 
         if (res["state"].String() == "steady") {
-            if (cloneLocsRemaining != 0) {
+            if (cloneStreamsRemaining != 0) {
                 return {ErrorCodes::OperationIncomplete,
                         str::stream() << "Unable to enter critical section because the recipient "
                                          "shard thinks all data is cloned while there are still "
-                                      << cloneLocsRemaining
-                                      << " documents remaining"};
+                                      << cloneStreamsRemaining
+                                      << " clone streams remaining"};
             }
 
             return Status::OK();
@@ -319,7 +308,7 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
                     "Destination shard aborted migration because a new one is running"};
         }
 
-        if (_memoryUsed > 500 * 1024 * 1024) {
+        if (_memoryUsed() > 500 * 1024 * 1024) {
             // This is too much memory for us to use so we're going to abort the migration
             return {ErrorCodes::ExceededMemoryLimit,
                     "Aborting migration because of high memory usage"};
@@ -458,12 +447,19 @@ void MigrationChunkClonerSourceLegacy::onDeleteOp(OperationContext* opCtx,
 uint64_t MigrationChunkClonerSourceLegacy::getCloneBatchBufferAllocationSize() {
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
+    const uint64_t recordsRemaining =
+        _numRecordsToClone > _numRecordsCloned ? _numRecordsToClone - _numRecordsCloned : 0;
+
+    // The streams may be fetched concurrently, so only a share of the remaining records is
+    // expected in each batch
     return std::min(static_cast<uint64_t>(BSONObjMaxUserSize),
-                    _averageObjectSizeForCloneLocs * _cloneLocs.size());
+                    _averageObjectSizeForCloneLocs * recordsRemaining /
+                        std::max(_cloneStreamsRemaining, 1));
 }
 
 Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
                                                         Collection* collection,
+                                                        boost::optional<int> streamIndex,
                                                         BSONArrayBuilder* arrBuilder) {
     dassert(opCtx->lockState()->isCollectionLockedForMode(_args.getNss().ns(), MODE_IS));
 
@@ -471,42 +467,122 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
                            internalQueryExecYieldIterations.load(),
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
-    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    if (streamIndex) {
+        if (*streamIndex < 0 || *streamIndex >= getNumCloneStreams()) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "Clone stream " << *streamIndex
+                                  << " was requested, but the chunk is being cloned in "
+                                  << getNumCloneStreams()
+                                  << " streams"};
+        }
+
+        return _nextCloneBatchFromStream(
+                   opCtx, collection, _cloneStreams[*streamIndex].get(), &tracker, arrBuilder)
+            .getStatus();
+    }
+
+    for (const auto& stream : _cloneStreams) {
+        auto swDrained =
+            _nextCloneBatchFromStream(opCtx, collection, stream.get(), &tracker, arrBuilder);
+        if (!swDrained.isOK()) {
+            return swDrained.getStatus();
+        }
+
+        // Only move on to the next stream once this one has been fully returned, so that the
+        // documents are returned in shard key order
+        if (!swDrained.getValue()) {
+            break;
+        }
+    }
 
-    std::set<RecordId>::iterator it;
+    return Status::OK();
+}
+
+StatusWith<bool> MigrationChunkClonerSourceLegacy::_nextCloneBatchFromStream(
+    OperationContext* opCtx,
+    Collection* collection,
+    CloneStream* stream,
+    ElapsedTracker* tracker,
+    BSONArrayBuilder* arrBuilder) {
+    stdx::lock_guard<stdx::mutex> streamLock(stream->mutex);
+
+    if (!stream->exec) {
+        return true;
+    }
+
+    uint64_t numCloned = 0;
+
+    if (!stream->pendingDoc.isEmpty()) {
+        if (arrBuilder->arrSize() &&
+            (arrBuilder->len() + stream->pendingDoc.objsize() + 1024) > BSONObjMaxUserSize) {
+            return false;
+        }
+
+        arrBuilder->append(stream->pendingDoc);
+        stream->pendingDoc = BSONObj();
+        numCloned++;
+    }
 
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
+    stream->exec->reattachToOperationContext(opCtx);
+
+    Status restoreStatus = stream->exec->restoreState();
+    if (!restoreStatus.isOK()) {
+        stream->exec->detachFromOperationContext();
+        return restoreStatus.withContext("Unable to resume cloning documents belonging to chunk");
+    }
+
+    bool drained = false;
+
+    BSONObj obj;
+    PlanExecutor::ExecState state;
+    while (true) {
         // We must always make progress in this method by at least one document because empty return
         // indicates there is no more initial clone data.
-        if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
+        if (arrBuilder->arrSize() && tracker->intervalHasElapsed()) {
             break;
         }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(opCtx, *it, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so that we
-            // take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
-                break;
-            }
+        state = stream->exec->getNext(&obj, nullptr);
+        if (PlanExecutor::IS_EOF == state) {
+            drained = true;
+            break;
+        }
 
-            arrBuilder->append(doc.value());
+        if (PlanExecutor::ADVANCED != state) {
+            stream->exec->detachFromOperationContext();
+            return WorkingSetCommon::getMemberObjectStatus(obj).withContext(
+                "Executor error while cloning documents belonging to chunk");
+        }
+
+        // Use the builder size instead of accumulating the document sizes directly so that we
+        // take into consideration the overhead of BSONArray indices.
+        if (arrBuilder->arrSize() &&
+            (arrBuilder->len() + obj.objsize() + 1024) > BSONObjMaxUserSize) {
+            stream->pendingDoc = obj.getOwned();
+            break;
         }
-    }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+        arrBuilder->append(obj);
+        numCloned++;
+    }
 
-    // If we have drained all the cloned data, there is no need to keep the delete notify executor
-    // around
-    if (_cloneLocs.empty() && _deleteNotifyExec) {
+    if (drained) {
         // We have a different OperationContext than when we created the PlanExecutor, so need to
         // manually destroy it ourselves.
-        _deleteNotifyExec->dispose(opCtx, collection->getCursorManager());
-        _deleteNotifyExec.reset();
+        stream->exec->dispose(opCtx, collection->getCursorManager());
+        stream->exec.reset();
+    } else {
+        stream->exec->saveState();
+        stream->exec->detachFromOperationContext();
     }
 
-    return Status::OK();
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    _numRecordsCloned += numCloned;
+    if (drained) {
+        _cloneStreamsRemaining--;
+    }
+
+    return drained;
 }
 
 Status MigrationChunkClonerSourceLegacy::nextModsBatch(OperationContext* opCtx,
@@ -517,7 +593,7 @@ Status MigrationChunkClonerSourceLegacy::nextModsBatch(OperationContext* opCtx,
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     // All clone data must have been drained before starting to fetch the incremental changes
-    invariant(_cloneLocs.empty());
+    invariant(_cloneStreamsRemaining == 0);
 
     long long docSizeAccumulator = 0;
 
@@ -536,23 +612,41 @@ void MigrationChunkClonerSourceLegacy::_cleanup(OperationContext* opCtx) {
         _reload.clear();
         _deleted.clear();
     }
-    // Implicitly resets _deleteNotifyExec to avoid possible invariant failure
-    // in on destruction of MigrationChunkClonerSourceLegacy, and will always
-    // call deleteNotifyExec destructor on scope exit even if something in the
-    // below if statement fails
-    auto deleteNotifyExec = std::move(_deleteNotifyExec);
 
-    if (deleteNotifyExec) {
-        // Don't allow an Interrupt exception to prevent _deleteNotifyExec from getting cleaned up.
-        UninterruptibleLockGuard noInterrupt(opCtx->lockState());
+    // Takes the clone executors out of the streams, so that no more batches can be served from
+    // them and they are destroyed even if disposing them below fails
+    std::vector<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> cloneExecs;
+    for (const auto& stream : _cloneStreams) {
+        stdx::lock_guard<stdx::mutex> streamLock(stream->mutex);
+        if (stream->exec) {
+            cloneExecs.push_back(std::move(stream->exec));
+        }
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
+        _cloneStreamsRemaining = 0;
+    }
 
-        AutoGetCollection autoColl(opCtx, _args.getNss(), MODE_IS);
-        const auto cursorManager =
-            autoColl.getCollection() ? autoColl.getCollection()->getCursorManager() : nullptr;
-        deleteNotifyExec->dispose(opCtx, cursorManager);
+    if (cloneExecs.empty()) {
+        return;
+    }
+
+    // Don't allow an Interrupt exception to prevent the clone executors from getting cleaned up.
+    UninterruptibleLockGuard noInterrupt(opCtx->lockState());
+
+    AutoGetCollection autoColl(opCtx, _args.getNss(), MODE_IS);
+    const auto cursorManager =
+        autoColl.getCollection() ? autoColl.getCollection()->getCursorManager() : nullptr;
+    for (auto& exec : cloneExecs) {
+        exec->dispose(opCtx, cursorManager);
     }
 }
 
+uint64_t MigrationChunkClonerSourceLegacy::_memoryUsed() const {
+    return _reload.memoryUsed() + _deleted.memoryUsed();
+}
+
 StatusWith<BSONObj> MigrationChunkClonerSourceLegacy::_callRecipient(const BSONObj& cmdObj) {
     executor::RemoteCommandResponse responseStatus(
         Status{ErrorCodes::InternalError, "Uninitialized value"});
@@ -605,19 +699,6 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
                               << _args.getNss().ns()};
     }
 
-    // Install the stage, which will listen for notifications on the collection
-    auto statusWithDeleteNotificationPlanExecutor =
-        PlanExecutor::make(opCtx,
-                           stdx::make_unique<WorkingSet>(),
-                           stdx::make_unique<DeleteNotificationStage>(this, opCtx),
-                           collection,
-                           PlanExecutor::YIELD_MANUAL);
-    if (!statusWithDeleteNotificationPlanExecutor.isOK()) {
-        return statusWithDeleteNotificationPlanExecutor.getStatus();
-    }
-
-    _deleteNotifyExec = std::move(statusWithDeleteNotificationPlanExecutor.getValue());
-
     // Assume both min and max non-empty, append MinKey's to make them fit chosen index
     const KeyPattern kp(idx->keyPattern());
 
@@ -651,22 +732,22 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
     }
 
     // Do a full traversal of the chunk and don't stop even if we think it is a large chunk we want
-    // the number of records to better report, in that case.
+    // the number of records to better report, in that case. Only the index keys are read and some
+    // of them are kept as candidate boundaries between the clone streams.
     bool isLargeChunk = false;
     unsigned long long recCount = 0;
+    std::vector<BSONObj> sampledKeys;
 
     BSONObj obj;
-    RecordId recordId;
     PlanExecutor::ExecState state;
-    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &recordId))) {
+    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, nullptr))) {
         Status interruptStatus = opCtx->checkForInterruptNoAssert();
         if (!interruptStatus.isOK()) {
             return interruptStatus;
         }
 
-        if (!isLargeChunk) {
-            stdx::lock_guard<stdx::mutex> lk(_mutex);
-            _cloneLocs.insert(recordId);
+        if (!isLargeChunk && recCount > 0 && recCount % kCloneStreamSampleInterval == 0) {
+            sampledKeys.push_back(obj.getOwned());
         }
 
         if (++recCount > maxRecsWhenFull) {
@@ -703,7 +784,44 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
                           << _args.getMaxKey()};
     }
 
+    // Split the range into streams with roughly the same number of documents, skipping duplicate
+    // boundaries, which happen when many documents share the same shard key
+    const int numStreams =
+        std::min(static_cast<int>(sampledKeys.size() + 1), migrationCloneStreams.load());
+
+    std::vector<BSONObj> bounds{min};
+    for (int i = 1; i < numStreams; i++) {
+        const BSONObj& key = sampledKeys[i * sampledKeys.size() / numStreams];
+        if (key.woCompare(bounds.back()) != 0) {
+            bounds.push_back(key);
+        }
+    }
+    bounds.push_back(max);
+
+    // The documents are fetched in index order while the recipient pulls them, so they are read
+    // with a manual yield policy and saved between the batches. Any change to the documents after
+    // they have been read is queued and will migrate in the 'transferMods' stage.
+    std::vector<std::unique_ptr<CloneStream>> cloneStreams;
+    for (size_t i = 0; i + 1 < bounds.size(); i++) {
+        auto stream = stdx::make_unique<CloneStream>();
+        stream->exec = InternalPlanner::indexScan(opCtx,
+                                                  collection,
+                                                  idx,
+                                                  bounds[i],
+                                                  bounds[i + 1],
+                                                  BoundInclusion::kIncludeStartKeyOnly,
+                                                  PlanExecutor::YIELD_MANUAL,
+                                                  InternalPlanner::FORWARD,
+                                                  InternalPlanner::IXSCAN_FETCH);
+        stream->exec->saveState();
+        stream->exec->detachFromOperationContext();
+        cloneStreams.push_back(std::move(stream));
+    }
+
     stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _cloneStreams = std::move(cloneStreams);
+    _cloneStreamsRemaining = _cloneStreams.size();
+    _numRecordsToClone = recCount;
     _averageObjectSizeForCloneLocs = collectionAverageObjectSize + 12;
 
     return Status::OK();
@@ -711,14 +829,14 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
 
 void MigrationChunkClonerSourceLegacy::_xfer(OperationContext* opCtx,
                                              Database* db,
-                                             std::list<BSONObj>* docIdList,
+                                             MigrationModsBuffer* docIdList,
                                              BSONObjBuilder* builder,
                                              const char* fieldName,
                                              long long* sizeAccumulator,
                                              bool explode) {
     const long long maxSize = 1024 * 1024;
 
-    if (docIdList->size() == 0 || *sizeAccumulator > maxSize) {
+    if (docIdList->empty() || *sizeAccumulator > maxSize) {
         return;
     }
 
@@ -726,9 +844,8 @@ void MigrationChunkClonerSourceLegacy::_xfer(OperationContext* opCtx,
 
     BSONArrayBuilder arr(builder->subarrayStart(fieldName));
 
-    std::list<BSONObj>::iterator docIdIter = docIdList->begin();
-    while (docIdIter != docIdList->end() && *sizeAccumulator < maxSize) {
-        BSONObj idDoc = *docIdIter;
+    while (!docIdList->empty() && *sizeAccumulator < maxSize) {
+        BSONObj idDoc = docIdList->pop();
         if (explode) {
             BSONObj fullDoc;
             if (Helpers::findById(opCtx, db, ns.c_str(), idDoc, fullDoc)) {
@@ -739,8 +856,6 @@ void MigrationChunkClonerSourceLegacy::_xfer(OperationContext* opCtx,
             arr.append(idDoc);
             *sizeAccumulator += idDoc.objsize();
         }
-
-        docIdIter = docIdList->erase(docIdIter);
     }
 
     arr.done();
@@ -28,8 +28,10 @@
 
 #pragma once
 
-#include <list>
-#include <set>
+#include <memory>
+#include <vector>
+
+#include <boost/optional.hpp>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/connection_string.h"
@@ -37,8 +39,10 @@
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/s/migration_chunk_cloner_source.h"
+#include "mongo/db/s/migration_mods_buffer.h"
 #include "mongo/db/s/migration_session_id.h"
 #include "mongo/db/s/session_catalog_migration_source.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/request_types/move_chunk_request.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/memory.h"
@@ -51,7 +55,10 @@ class BSONArrayBuilder;
 class BSONObjBuilder;
 class Collection;
 class Database;
-class RecordId;
+class ElapsedTracker;
+
+// Number of concurrent streams, which the donor shard splits the initial clone of a chunk into
+extern AtomicInt32 migrationCloneStreams;
 
 class MigrationChunkClonerSourceLegacy final : public MigrationChunkClonerSource {
     MONGO_DISALLOW_COPYING(MigrationChunkClonerSourceLegacy);
@@ -104,10 +111,22 @@ public:
      */
     uint64_t getCloneBatchBufferAllocationSize();
 
+    /**
+     * Returns the number of streams into which the initial clone was split. Only valid after
+     * startClone has succeeded.
+     */
+    int getNumCloneStreams() const {
+        return _cloneStreams.size();
+    }
+
     /**
      * Called by the recipient shard. Populates the passed BSONArrayBuilder with a set of documents,
      * which are part of the initial clone sequence.
      *
+     * If 'streamIndex' is specified, only documents from that clone stream are returned, which
+     * allows the recipient to fetch the streams concurrently. Otherwise the streams are drained
+     * one after another, in shard key order.
+     *
      * Returns OK status on success. If there were documents returned in the result argument, this
      * method should be called more times until the result is empty. If it returns failure, it is
      * not safe to call more methods on this class other than cancelClone.
@@ -120,6 +139,7 @@ public:
      */
     Status nextCloneBatch(OperationContext* opCtx,
                           Collection* collection,
+                          boost::optional<int> streamIndex,
                           BSONArrayBuilder* arrBuilder);
 
     /**
@@ -140,12 +160,26 @@ public:
     repl::OpTime nextSessionMigrationBatch(OperationContext* opCtx, BSONArrayBuilder* arrBuilder);
 
 private:
-    friend class DeleteNotificationStage;
     friend class LogOpForShardingHandler;
 
     // Represents the states in which the cloner can be
     enum State { kNew, kCloning, kDone };
 
+    /**
+     * A contiguous shard key range of the chunk, which is cloned by scanning the shard key index
+     * in order. The executor is saved and detached between calls to nextCloneBatch.
+     */
+    struct CloneStream {
+        // Serializes the requests for this stream and protects the entries below
+        stdx::mutex mutex;
+
+        // Index scan over the range of the stream, reset once the range has been drained
+        std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> exec;
+
+        // Document which was fetched, but did not fit in the previous batch
+        BSONObj pendingDoc;
+    };
+
     /**
      * Idempotent method, which cleans up any previously initialized state. It is safe to be called
      * at any time, but no methods should be called after it.
@@ -159,13 +193,29 @@ private:
     StatusWith<BSONObj> _callRecipient(const BSONObj& cmdObj);
 
     /**
-     * Get the disklocs that belong to the chunk migrated and sort them in _cloneLocs (to avoid
-     * seeking disk later).
+     * Counts the documents that belong to the chunk being migrated, failing with ChunkTooBig if
+     * there are too many, and splits its range into the index scans of _cloneStreams.
      *
      * Returns OK or any error status otherwise.
      */
     Status _storeCurrentLocs(OperationContext* opCtx);
 
+    /**
+     * Appends documents from 'stream' to the passed BSONArrayBuilder until the stream is drained,
+     * the batch is full or 'tracker' says it is time to yield. Returns true if the stream was
+     * drained.
+     */
+    StatusWith<bool> _nextCloneBatchFromStream(OperationContext* opCtx,
+                                               Collection* collection,
+                                               CloneStream* stream,
+                                               ElapsedTracker* tracker,
+                                               BSONArrayBuilder* arrBuilder);
+
+    /**
+     * Returns the number of bytes of xfer mods currently held in memory.
+     */
+    uint64_t _memoryUsed() const;
+
     /**
      * Insert items from docIdList to a new array with the given fieldName in the given builder. If
      * explode is true, the inserted object will be the full version of the document. Note that
@@ -176,7 +226,7 @@ private:
      */
     void _xfer(OperationContext* opCtx,
                Database* db,
-               std::list<BSONObj>* docIdList,
+               MigrationModsBuffer* docIdList,
                BSONObjBuilder* builder,
                const char* fieldName,
                long long* sizeAccumulator,
@@ -197,9 +247,9 @@ private:
     // The resolved primary of the recipient shard
     const HostAndPort _recipientHost;
 
-    // Registered deletion notifications plan executor, which will listen for document deletions
-    // during the cloning stage
-    std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _deleteNotifyExec;
+    // Ranges of the initial clone, in shard key order. Populated by startClone and not resized
+    // afterwards, so they can be accessed without holding _mutex.
+    std::vector<std::unique_ptr<CloneStream>> _cloneStreams;
 
     std::unique_ptr<SessionCatalogMigrationSource> _sessionCatalogSource;
 
@@ -209,22 +259,24 @@ private:
     // The current state of the cloner
     State _state{kNew};
 
-    // List of record ids that needs to be transferred (initial clone)
-    std::set<RecordId> _cloneLocs;
+    // Number of entries in _cloneStreams, which have not been drained yet (initial clone)
+    int _cloneStreamsRemaining{0};
+
+    // Number of documents found in the chunk when the clone started and the number of documents
+    // returned since. Used to estimate the remaining clone size.
+    uint64_t _numRecordsToClone{0};
+    uint64_t _numRecordsCloned{0};
 
     // The estimated average object size during the clone phase. Used for buffer size
     // pre-allocation (initial clone).
     uint64_t _averageObjectSizeForCloneLocs{0};
 
     // List of _id of documents that were modified that must be re-cloned (xfer mods)
-    std::list<BSONObj> _reload;
+    MigrationModsBuffer _reload;
 
     // List of _id of documents that were deleted during clone that should be deleted later (xfer
     // mods)
-    std::list<BSONObj> _deleted;
-
-    // Total bytes in _reload + _deleted (xfer mods)
-    uint64_t _memoryUsed{0};
+    MigrationModsBuffer _deleted;
 };
 
 }  // namespace mongo
@@ -147,6 +147,17 @@ public:
         const MigrationSessionId migrationSessionId(
             uassertStatusOK(MigrationSessionId::extractFromBSON(cmdObj)));
 
+        // Recipients which fetch the clone streams concurrently specify which one they want
+        boost::optional<int> streamIndex;
+        const BSONElement streamElem = cmdObj["stream"];
+        if (!streamElem.eoo()) {
+            uassert(ErrorCodes::TypeMismatch,
+                    str::stream() << "The clone stream must be a number, but found "
+                                  << typeName(streamElem.type()),
+                    streamElem.isNumber());
+            streamIndex = streamElem.numberInt();
+        }
+
         boost::optional<BSONArrayBuilder> arrBuilder;
 
         // Try to maximize on the size of the buffer, which we are returning in order to have less
@@ -163,7 +174,7 @@ public:
             arrSizeAtPrevIteration = arrBuilder->arrSize();
 
             uassertStatusOK(autoCloner.getCloner()->nextCloneBatch(
-                opCtx, autoCloner.getColl(), arrBuilder.get_ptr()));
+                opCtx, autoCloner.getColl(), streamIndex, arrBuilder.get_ptr()));
         }
 
         invariant(arrBuilder);
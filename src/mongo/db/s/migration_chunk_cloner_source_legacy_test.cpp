@@ -39,6 +39,7 @@
 #include "mongo/s/shard_server_test_fixture.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -214,8 +215,8 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
 
         {
             BSONArrayBuilder arrBuilder;
-            ASSERT_OK(
-                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_OK(cloner.nextCloneBatch(
+                operationContext(), autoColl.getCollection(), boost::none, &arrBuilder));
             ASSERT_EQ(2, arrBuilder.arrSize());
 
             const auto arr = arrBuilder.arr();
@@ -225,8 +226,8 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
 
         {
             BSONArrayBuilder arrBuilder;
-            ASSERT_OK(
-                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_OK(cloner.nextCloneBatch(
+                operationContext(), autoColl.getCollection(), boost::none, &arrBuilder));
             ASSERT_EQ(0, arrBuilder.arrSize());
         }
     }
@@ -264,8 +265,8 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
 
         {
             BSONArrayBuilder arrBuilder;
-            ASSERT_OK(
-                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_OK(cloner.nextCloneBatch(
+                operationContext(), autoColl.getCollection(), boost::none, &arrBuilder));
             ASSERT_EQ(0, arrBuilder.arrSize());
         }
 
@@ -295,6 +296,88 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
     futureCommit.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationChunkClonerSourceLegacyTest, CloneStreamsPartitionTheChunk) {
+    std::vector<BSONObj> contents;
+    for (int i = 0; i < 3000; i++) {
+        contents.push_back(createCollectionDocument(i));
+    }
+
+    createShardedCollection(contents);
+
+    const int originalCloneStreams = migrationCloneStreams.load();
+    migrationCloneStreams.store(3);
+    ON_BLOCK_EXIT([&] { migrationCloneStreams.store(originalCloneStreams); });
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 0), BSON("X" << 3000))),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+
+    {
+        auto futureStartClone = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) {
+                ASSERT_EQ(3, request.cmdObj["cloneStreams"].numberInt());
+                return BSON("ok" << true);
+            });
+        });
+
+        ASSERT_OK(cloner.startClone(operationContext()));
+        futureStartClone.timed_get(kFutureTimeout);
+    }
+
+    ASSERT_EQ(3, cloner.getNumCloneStreams());
+
+    // Each stream returns a contiguous range of the chunk in shard key order, regardless of the
+    // order in which the streams are fetched
+    const std::vector<std::pair<int, int>> expectedRanges = {{0, 1024}, {1024, 2048}, {2048, 3000}};
+
+    {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IS);
+
+        for (int stream : {2, 0, 1}) {
+            int nextExpected = expectedRanges[stream].first;
+
+            while (true) {
+                BSONArrayBuilder arrBuilder;
+                ASSERT_OK(cloner.nextCloneBatch(
+                    operationContext(), autoColl.getCollection(), stream, &arrBuilder));
+                if (arrBuilder.arrSize() == 0) {
+                    break;
+                }
+
+                const auto arr = arrBuilder.arr();
+                for (const auto& elem : arr) {
+                    ASSERT_BSONOBJ_EQ(createCollectionDocument(nextExpected++), elem.Obj());
+                }
+            }
+
+            ASSERT_EQ(expectedRanges[stream].second, nextExpected);
+        }
+
+        {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(cloner.nextCloneBatch(
+                operationContext(), autoColl.getCollection(), boost::none, &arrBuilder));
+            ASSERT_EQ(0, arrBuilder.arrSize());
+        }
+
+        {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_EQ(ErrorCodes::BadValue,
+                      cloner.nextCloneBatch(
+                          operationContext(), autoColl.getCollection(), 3, &arrBuilder));
+        }
+    }
+
+    auto futureCancel = launchAsync([&]() {
+        onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+    });
+
+    cloner.cancelClone(operationContext());
+    futureCancel.timed_get(kFutureTimeout);
+}
+
 TEST_F(MigrationChunkClonerSourceLegacyTest, CollectionNotFound) {
     MigrationChunkClonerSourceLegacy cloner(
         createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
@@ -352,15 +435,15 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, FailedToEngageRecipientShard) {
 
         {
             BSONArrayBuilder arrBuilder;
-            ASSERT_OK(
-                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_OK(cloner.nextCloneBatch(
+                operationContext(), autoColl.getCollection(), boost::none, &arrBuilder));
             ASSERT_EQ(2, arrBuilder.arrSize());
         }
 
         {
             BSONArrayBuilder arrBuilder;
-            ASSERT_OK(
-                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_OK(cloner.nextCloneBatch(
+                operationContext(), autoColl.getCollection(), boost::none, &arrBuilder));
             ASSERT_EQ(0, arrBuilder.arrSize());
         }
     }
@@ -62,6 +62,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/producer_consumer_queue.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -171,15 +172,25 @@ bool opReplicatedEnough(OperationContext* opCtx,
     return true;
 }
 
+// Upper bound on the number of clone streams this shard fetches concurrently, regardless of how
+// many the donor offers
+const int kMaxCloneStreams = 16;
+
 /**
  * Create the migration clone request BSON object to send to the source shard.
  *
  * 'sessionId' unique identifier for this migration.
+ * 'streamIndex' the clone stream to fetch from, if the donor split the clone into streams.
  */
-BSONObj createMigrateCloneRequest(const NamespaceString& nss, const MigrationSessionId& sessionId) {
+BSONObj createMigrateCloneRequest(const NamespaceString& nss,
+                                  const MigrationSessionId& sessionId,
+                                  boost::optional<int> streamIndex) {
     BSONObjBuilder builder;
     builder.append("_migrateClone", nss.ns());
     sessionId.append(&builder);
+    if (streamIndex) {
+        builder.append("stream", *streamIndex);
+    }
     return builder.obj();
 }
 
@@ -325,7 +336,8 @@ Status MigrationDestinationManager::start(const NamespaceString& nss,
                                           const BSONObj& max,
                                           const BSONObj& shardKeyPattern,
                                           const OID& epoch,
-                                          const WriteConcernOptions& writeConcern) {
+                                          const WriteConcernOptions& writeConcern,
+                                          int numCloneStreams) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     invariant(!_sessionId);
     invariant(!_scopedReceiveChunk);
@@ -341,6 +353,7 @@ Status MigrationDestinationManager::start(const NamespaceString& nss,
     _min = min;
     _max = max;
     _shardKeyPattern = shardKeyPattern;
+    _numCloneStreams = std::max(1, std::min(numCloneStreams, kMaxCloneStreams));
 
     _chunkMarkedPending = false;
 
@@ -417,6 +430,101 @@ void MigrationDestinationManager::cloneDocumentsFromDonor(
     }
 }
 
+void MigrationDestinationManager::cloneDocumentsFromDonorStreams(
+    OperationContext* opCtx,
+    int numStreams,
+    stdx::function<void(OperationContext*, BSONObjIterator)> insertBatchFn,
+    stdx::function<BSONObj(OperationContext*, int)> fetchBatchFn) {
+    if (numStreams <= 1) {
+        cloneDocumentsFromDonor(opCtx, insertBatchFn, [&](OperationContext* opCtx) {
+            return fetchBatchFn(opCtx, 0);
+        });
+        return;
+    }
+
+    auto const serviceContext = opCtx->getServiceContext();
+
+    // Protects the entries below
+    stdx::mutex mutex;
+    stdx::condition_variable streamFinishedCV;
+    std::vector<OperationContext*> streamOpCtxs;
+    int numStreamsFinished = 0;
+    boost::optional<Status> firstError;
+
+    // Must be called with 'mutex' held
+    auto killStreams = [&](Status status) {
+        if (!firstError) {
+            firstError = status;
+        }
+
+        for (auto streamOpCtx : streamOpCtxs) {
+            stdx::lock_guard<Client> lk(*streamOpCtx->getClient());
+            serviceContext->killOperation(streamOpCtx, status.code());
+        }
+
+        streamFinishedCV.notify_all();
+    };
+
+    std::vector<stdx::thread> streamThreads;
+    for (int streamIndex = 0; streamIndex < numStreams; streamIndex++) {
+        streamThreads.emplace_back([&, streamIndex] {
+            const std::string threadName = str::stream() << "chunkCloneStream-" << streamIndex;
+            Client::initThread(threadName);
+            auto streamOpCtx = Client::getCurrent()->makeOperationContext();
+
+            auto finishGuard = MakeGuard([&] {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                streamOpCtxs.erase(
+                    std::find(streamOpCtxs.begin(), streamOpCtxs.end(), streamOpCtx.get()));
+                numStreamsFinished++;
+                streamFinishedCV.notify_all();
+            });
+
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                streamOpCtxs.push_back(streamOpCtx.get());
+                if (firstError) {
+                    return;
+                }
+            }
+
+            try {
+                cloneDocumentsFromDonor(
+                    streamOpCtx.get(), insertBatchFn, [&](OperationContext* opCtx) {
+                        return fetchBatchFn(opCtx, streamIndex);
+                    });
+            } catch (...) {
+                const auto status = exceptionToStatus();
+                log() << "Clone stream " << streamIndex << " failed " << causedBy(redact(status));
+
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                killStreams(status);
+            }
+        });
+    }
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        try {
+            opCtx->waitForConditionOrInterrupt(streamFinishedCV, lk, [&] {
+                return numStreamsFinished == numStreams || firstError;
+            });
+        } catch (const DBException& ex) {
+            killStreams(ex.toStatus());
+        }
+
+        streamFinishedCV.wait(lk, [&] { return numStreamsFinished == numStreams; });
+    }
+
+    for (auto& streamThread : streamThreads) {
+        streamThread.join();
+    }
+
+    if (firstError) {
+        uassertStatusOK(*firstError);
+    }
+}
+
 Status MigrationDestinationManager::abort(const MigrationSessionId& sessionId) {
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
@@ -750,7 +858,22 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
 
         _sessionMigration->start(opCtx->getServiceContext());
 
-        const BSONObj migrateCloneRequest = createMigrateCloneRequest(_nss, *_sessionId);
+        // The first clone stream is fetched over the connection used for the rest of the migration
+        // and each of the other streams gets its own connection
+        const int numCloneStreams = _numCloneStreams;
+
+        std::vector<BSONObj> migrateCloneRequests;
+        std::vector<std::unique_ptr<ScopedDbConnection>> streamConns;
+        for (int streamIndex = 0; streamIndex < numCloneStreams; streamIndex++) {
+            migrateCloneRequests.push_back(createMigrateCloneRequest(
+                _nss,
+                *_sessionId,
+                numCloneStreams > 1 ? boost::optional<int>(streamIndex) : boost::none));
+
+            if (streamIndex > 0) {
+                streamConns.push_back(stdx::make_unique<ScopedDbConnection>(fromShardConnString));
+            }
+        }
 
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
@@ -813,12 +936,14 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
             }
         };
 
-        auto fetchBatchFn = [&](OperationContext* opCtx) {
+        auto fetchBatchFn = [&](OperationContext* opCtx, int streamIndex) {
+            auto& streamConn = streamIndex == 0 ? conn : *streamConns[streamIndex - 1];
+
             BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                conn.done();
+            if (!streamConn->runCommand("admin",
+                                        migrateCloneRequests[streamIndex],
+                                        res)) {  // gets array of objects to copy, in key order
+                streamConn.done();
                 const std::string errMsg = str::stream() << "_migrateClone failed: "
                                                          << redact(res.toString());
                 uasserted(50747, errMsg);
@@ -826,7 +951,31 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
             return res;
         };
 
-        cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn);
+        Timer cloneTimer;
+        cloneDocumentsFromDonorStreams(opCtx, numCloneStreams, insertBatchFn, fetchBatchFn);
+
+        for (auto& streamConn : streamConns) {
+            streamConn->done();
+        }
+
+        {
+            const long long cloneMillis = std::max(cloneTimer.millis(), 1);
+
+            stdx::unique_lock<stdx::mutex> statsLock(_mutex);
+            const long long numCloned = _numCloned;
+            const long long clonedBytes = _clonedBytes;
+            statsLock.unlock();
+
+            timing.appendDetails(BSON("cloneStreams" << numCloneStreams << "clonedDocs" << numCloned
+                                                     << "clonedBytes"
+                                                     << clonedBytes
+                                                     << "cloneMillis"
+                                                     << cloneMillis
+                                                     << "clonedDocsPerSec"
+                                                     << numCloned * 1000 / cloneMillis
+                                                     << "clonedBytesPerSec"
+                                                     << clonedBytes * 1000 / cloneMillis));
+        }
 
         timing.done(3);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
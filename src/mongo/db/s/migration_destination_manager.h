@@ -97,7 +97,8 @@ public:
     BSONObj getMigrationStatusReport();
 
     /**
-     * Returns OK if migration started successfully.
+     * Returns OK if migration started successfully. 'numCloneStreams' is the number of streams the
+     * donor split the initial clone into, which are fetched concurrently.
      */
     Status start(const NamespaceString& nss,
                  ScopedReceiveChunk scopedReceiveChunk,
@@ -109,7 +110,8 @@ public:
                  const BSONObj& max,
                  const BSONObj& shardKeyPattern,
                  const OID& epoch,
-                 const WriteConcernOptions& writeConcern);
+                 const WriteConcernOptions& writeConcern,
+                 int numCloneStreams);
 
     /**
      * Clones documents from a donor shard.
@@ -119,6 +121,17 @@ public:
         stdx::function<void(OperationContext*, BSONObjIterator)> insertBatchFn,
         stdx::function<BSONObj(OperationContext*)> fetchBatchFn);
 
+    /**
+     * Clones documents from a donor shard over 'numStreams' concurrent streams, each of which runs
+     * cloneDocumentsFromDonor on its own thread with the stream index passed to 'fetchBatchFn'. If
+     * any stream fails, the remaining ones are interrupted and the first error is rethrown.
+     */
+    static void cloneDocumentsFromDonorStreams(
+        OperationContext* opCtx,
+        int numStreams,
+        stdx::function<void(OperationContext*, BSONObjIterator)> insertBatchFn,
+        stdx::function<BSONObj(OperationContext*, int)> fetchBatchFn);
+
     /**
      * Idempotent method, which causes the current ongoing migration to abort only if it has the
      * specified session id. If the migration is already aborted, does nothing.
@@ -219,6 +232,9 @@ private:
     BSONObj _max;
     BSONObj _shardKeyPattern;
 
+    // Number of concurrent streams over which the initial clone is fetched from the donor
+    int _numCloneStreams{1};
+
     // Set to true once we have accepted the chunk as pending into our metadata. Used so that on
     // failure we can perform the appropriate cleanup.
     bool _chunkMarkedPending{false};
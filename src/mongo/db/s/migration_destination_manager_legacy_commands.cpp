@@ -117,6 +117,10 @@ public:
         const MigrationSessionId migrationSessionId(
             uassertStatusOK(MigrationSessionId::extractFromBSON(cmdObj)));
 
+        // Donors which do not split the clone into streams don't send this field
+        const int numCloneStreams =
+            cmdObj["cloneStreams"].isNumber() ? cmdObj["cloneStreams"].numberInt() : 1;
+
         // Ensure this shard is not currently receiving or donating any chunks.
         auto scopedReceiveChunk(uassertStatusOK(
             ActiveMigrationsRegistry::get(opCtx).registerReceiveChunk(nss, chunkRange, fromShard)));
@@ -132,7 +136,8 @@ public:
             chunkRange.getMax(),
             shardKeyPattern,
             shardVersion.epoch(),
-            writeConcern));
+            writeConcern,
+            numCloneStreams));
 
         result.appendBool("started", true);
         return true;
@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <set>
+
 #include "mongo/db/s/migration_destination_manager.h"
 #include "mongo/s/shard_server_test_fixture.h"
 #include "mongo/unittest/unittest.h"
@@ -156,5 +158,75 @@ TEST_F(MigrationDestinationManagerTest, CloneDocumentsCatchesInsertErrors) {
     ASSERT_EQ(operationContext()->getKillStatus(), ErrorCodes::FailedToParse);
 }
 
+// Tests that documents from every clone stream ferry to the insert logic and that each stream is
+// fetched until it returns an empty batch.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorStreamsFetchesAllStreams) {
+    const int kNumStreams = 3;
+
+    stdx::mutex mutex;
+    std::vector<int> batchesFetched(kNumStreams, 0);
+    std::set<int> resultIds;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx, int streamIndex) {
+        BSONObjBuilder fetchBatchResultBuilder;
+
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        if (batchesFetched[streamIndex]++ > 0) {
+            fetchBatchResultBuilder.append("objects", BSONObj());
+        } else {
+            BSONArrayBuilder arrayBuilder;
+            for (int i = 0; i < 10; i++) {
+                arrayBuilder.append(createDocument(streamIndex * 10 + i));
+            }
+            fetchBatchResultBuilder.append("objects", arrayBuilder.arr());
+        }
+
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObjIterator docs) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        while (docs.more()) {
+            resultIds.insert(docs.next().Obj()["_id"].numberInt());
+        }
+    };
+
+    MigrationDestinationManager::cloneDocumentsFromDonorStreams(
+        operationContext(), kNumStreams, insertBatchFn, fetchBatchFn);
+
+    ASSERT_EQ(30U, resultIds.size());
+    ASSERT_EQ(0, *resultIds.begin());
+    ASSERT_EQ(29, *resultIds.rbegin());
+
+    for (int streamIndex = 0; streamIndex < kNumStreams; streamIndex++) {
+        ASSERT_EQ(2, batchesFetched[streamIndex]);
+    }
+}
+
+// Tests that an exception in one clone stream interrupts the others and is rethrown on the main
+// thread.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorStreamsThrowsStreamErrors) {
+    auto fetchBatchFn = [&](OperationContext* opCtx, int streamIndex) {
+        if (streamIndex == 1) {
+            uasserted(ErrorCodes::NetworkTimeout, "network error");
+        }
+
+        // The other streams never finish on their own, so they must be interrupted
+        opCtx->sleepFor(Hours(1));
+
+        BSONObjBuilder fetchBatchResultBuilder;
+        fetchBatchResultBuilder.append("objects", BSONObj());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObjIterator docs) {};
+
+    ASSERT_THROWS_CODE_AND_WHAT(MigrationDestinationManager::cloneDocumentsFromDonorStreams(
+                                    operationContext(), 3, insertBatchFn, fetchBatchFn),
+                                DBException,
+                                ErrorCodes::NetworkTimeout,
+                                "network error");
+}
+
 }  // namespace
 }  // namespace mongo
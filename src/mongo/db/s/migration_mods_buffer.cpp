@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/migration_mods_buffer.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+namespace {
+
+// Used to generate unique spill file names within the temporary directory
+AtomicUInt32 spillFileCounter;
+
+}  // namespace
+
+MigrationModsBuffer::MigrationModsBuffer(std::string tempDir, uint64_t maxMemoryBytes)
+    : _tempDir(std::move(tempDir)), _maxMemoryBytes(maxMemoryBytes) {}
+
+MigrationModsBuffer::~MigrationModsBuffer() {
+    _removeSpillFile();
+}
+
+void MigrationModsBuffer::push(const BSONObj& idDoc) {
+    const uint64_t size = idDoc.objsize();
+    if (_memoryUsed + size > _maxMemoryBytes && _spill(idDoc)) {
+        return;
+    }
+
+    _inMemory.push_back(idDoc.getOwned());
+    _memoryUsed += size;
+}
+
+BSONObj MigrationModsBuffer::pop() {
+    invariant(!empty());
+
+    if (!_inMemory.empty()) {
+        BSONObj idDoc = std::move(_inMemory.front());
+        _inMemory.pop_front();
+        _memoryUsed -= idDoc.objsize();
+        return idDoc;
+    }
+
+    int32_t size = 0;
+    _file.seekg(_readOffset);
+    _file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    uassert(50869,
+            str::stream() << "error reading migration mods spill file \"" << _fileName << "\"",
+            _file.good() && size >= BSONObj::kMinBSONLength && size <= BSONObjMaxInternalSize);
+
+    SharedBuffer buffer = SharedBuffer::allocate(size);
+    std::memcpy(buffer.get(), &size, sizeof(size));
+    _file.read(buffer.get() + sizeof(size), size - sizeof(size));
+    uassert(50870,
+            str::stream() << "error reading migration mods spill file \"" << _fileName << "\"",
+            _file.good());
+
+    _readOffset += size;
+    if (--_spilledCount == 0) {
+        _removeSpillFile();
+    }
+
+    return BSONObj(std::move(buffer));
+}
+
+void MigrationModsBuffer::clear() {
+    _inMemory.clear();
+    _memoryUsed = 0;
+    _removeSpillFile();
+}
+
+bool MigrationModsBuffer::_spill(const BSONObj& idDoc) {
+    try {
+        if (_fileName.empty()) {
+            boost::filesystem::create_directories(_tempDir);
+
+            _fileName = str::stream() << _tempDir << "/migrationmods."
+                                      << spillFileCounter.fetchAndAdd(1);
+            _file.open(_fileName.c_str(),
+                       std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+            uassert(50871,
+                    str::stream() << "error opening file \"" << _fileName << "\"",
+                    _file.good());
+        }
+
+        _file.seekp(_writeOffset);
+        _file.write(idDoc.objdata(), idDoc.objsize());
+        uassert(50872,
+                str::stream() << "error writing to file \"" << _fileName << "\"",
+                _file.good());
+    } catch (const std::exception& ex) {
+        if (!_loggedSpillFailure) {
+            warning() << "Unable to spill migration mods to disk, keeping them in memory"
+                      << causedBy(redact(ex.what()));
+            _loggedSpillFailure = true;
+        }
+
+        _file.clear();
+        if (_spilledCount == 0) {
+            _removeSpillFile();
+        }
+
+        return false;
+    }
+
+    _writeOffset += idDoc.objsize();
+    _spilledCount++;
+    return true;
+}
+
+void MigrationModsBuffer::_removeSpillFile() {
+    if (_file.is_open()) {
+        _file.close();
+    }
+    _file.clear();
+
+    if (!_fileName.empty()) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(_fileName, ec);
+        _fileName.clear();
+    }
+
+    _spilledCount = 0;
+    _readOffset = 0;
+    _writeOffset = 0;
+}
+
+}  // namespace mongo
@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+/**
+ * Holds the _id keys of the documents, which were modified on the donor shard while a chunk is
+ * being migrated and which need to be transferred to the recipient through _transferMods.
+ *
+ * Keys are kept in memory up to 'maxMemoryBytes'. Any keys pushed beyond that are appended to a
+ * spill file under 'tempDir' and are only read back once the in-memory keys have been drained. The
+ * order in which keys are returned is therefore not necessarily the order in which they were
+ * pushed, which is acceptable because the recipient applies the deleted and reloaded keys
+ * independently of their order.
+ *
+ * This class is not thread-safe and callers must provide their own synchronization.
+ */
+class MigrationModsBuffer {
+    MONGO_DISALLOW_COPYING(MigrationModsBuffer);
+
+public:
+    MigrationModsBuffer(std::string tempDir, uint64_t maxMemoryBytes);
+    ~MigrationModsBuffer();
+
+    /**
+     * Appends a copy of 'idDoc' to the buffer. Never throws. If spilling to disk fails, the key is
+     * kept in memory so that no modification is lost.
+     */
+    void push(const BSONObj& idDoc);
+
+    /**
+     * Removes and returns the next key from the buffer. Must not be called if the buffer is empty.
+     * Throws if the spill file cannot be read back.
+     */
+    BSONObj pop();
+
+    /**
+     * Discards all keys and removes the spill file, if any.
+     */
+    void clear();
+
+    bool empty() const {
+        return _inMemory.empty() && _spilledCount == 0;
+    }
+
+    /**
+     * Returns the total number of keys in the buffer, including the ones which were spilled.
+     */
+    size_t size() const {
+        return _inMemory.size() + _spilledCount;
+    }
+
+    /**
+     * Returns the number of bytes of keys currently held in memory.
+     */
+    uint64_t memoryUsed() const {
+        return _memoryUsed;
+    }
+
+    /**
+     * Returns the number of bytes of keys currently waiting in the spill file.
+     */
+    uint64_t spilledBytes() const {
+        return _writeOffset - _readOffset;
+    }
+
+private:
+    /**
+     * Appends 'idDoc' to the spill file, opening it if necessary. Returns false if the file could
+     * not be written, in which case the file is left as it was.
+     */
+    bool _spill(const BSONObj& idDoc);
+
+    /**
+     * Closes and removes the spill file and resets the read and write offsets.
+     */
+    void _removeSpillFile();
+
+    const std::string _tempDir;
+    const uint64_t _maxMemoryBytes;
+
+    // Keys held in memory and their total size
+    std::deque<BSONObj> _inMemory;
+    uint64_t _memoryUsed{0};
+
+    // Name of the spill file, empty if the file has not been created
+    std::string _fileName;
+    std::fstream _file;
+
+    // Number of keys in the spill file, which have not been read back yet
+    size_t _spilledCount{0};
+
+    // Positions in the spill file of the next key to read and of the end of the written data
+    uint64_t _readOffset{0};
+    uint64_t _writeOffset{0};
+
+    // Whether a failure to spill has already been logged, so that it is only reported once
+    bool _loggedSpillFailure{false};
+};
+
+}  // namespace mongo
@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <fstream>
+#include <set>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/s/migration_mods_buffer.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+BSONObj makeId(int value) {
+    return BSON("_id" << value);
+}
+
+TEST(MigrationModsBufferTest, KeepsKeysInMemoryUnderTheLimit) {
+    unittest::TempDir tempDir("migration_mods_buffer_test");
+    MigrationModsBuffer buffer(tempDir.path(), 1024 * 1024);
+    ASSERT(buffer.empty());
+
+    for (int i = 0; i < 10; i++) {
+        buffer.push(makeId(i));
+    }
+
+    ASSERT_EQ(10U, buffer.size());
+    ASSERT_EQ(10U * makeId(0).objsize(), buffer.memoryUsed());
+    ASSERT_EQ(0U, buffer.spilledBytes());
+
+    for (int i = 0; i < 10; i++) {
+        ASSERT_BSONOBJ_EQ(makeId(i), buffer.pop());
+    }
+
+    ASSERT(buffer.empty());
+    ASSERT_EQ(0U, buffer.memoryUsed());
+}
+
+TEST(MigrationModsBufferTest, SpillsKeysOverTheLimitAndReadsThemBack) {
+    unittest::TempDir tempDir("migration_mods_buffer_test");
+    const uint64_t idSize = makeId(0).objsize();
+    MigrationModsBuffer buffer(tempDir.path(), 4 * idSize);
+
+    for (int i = 0; i < 100; i++) {
+        buffer.push(makeId(i));
+    }
+
+    ASSERT_EQ(100U, buffer.size());
+    ASSERT_EQ(4 * idSize, buffer.memoryUsed());
+    ASSERT_EQ(96 * idSize, buffer.spilledBytes());
+
+    // Keys pushed while the spilled ones are waiting are served before them, so only the set of
+    // returned keys is checked
+    buffer.pop();
+    buffer.push(makeId(100));
+
+    std::set<int> seen;
+    while (!buffer.empty()) {
+        seen.insert(buffer.pop()["_id"].numberInt());
+    }
+
+    ASSERT_EQ(100U, seen.size());
+    ASSERT_EQ(1, *seen.begin());
+    ASSERT_EQ(100, *seen.rbegin());
+    ASSERT_EQ(0U, buffer.spilledBytes());
+
+    // The spill file is reused once it has been drained
+    for (int i = 0; i < 10; i++) {
+        buffer.push(makeId(i));
+    }
+
+    for (int i = 0; i < 10; i++) {
+        ASSERT_BSONOBJ_EQ(makeId(i), buffer.pop());
+    }
+}
+
+TEST(MigrationModsBufferTest, ClearDiscardsSpilledKeys) {
+    unittest::TempDir tempDir("migration_mods_buffer_test");
+    MigrationModsBuffer buffer(tempDir.path(), 0);
+
+    for (int i = 0; i < 10; i++) {
+        buffer.push(makeId(i));
+    }
+
+    ASSERT_EQ(0U, buffer.memoryUsed());
+    ASSERT_EQ(10U, buffer.size());
+
+    buffer.clear();
+    ASSERT(buffer.empty());
+    ASSERT_EQ(0U, buffer.spilledBytes());
+}
+
+TEST(MigrationModsBufferTest, KeepsKeysInMemoryIfSpillingFails) {
+    unittest::TempDir tempDir("migration_mods_buffer_test");
+
+    // A regular file in place of the temporary directory makes creating the spill file fail
+    const std::string notADirectory = tempDir.path() + "/file";
+    std::ofstream(notADirectory.c_str()) << "not a directory";
+
+    MigrationModsBuffer buffer(notADirectory, 0);
+
+    buffer.push(makeId(1));
+    ASSERT_EQ(1U, buffer.size());
+    ASSERT_EQ(0U, buffer.spilledBytes());
+    ASSERT_BSONOBJ_EQ(makeId(1), buffer.pop());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -54,6 +54,12 @@ public:
 
     void done(int step);
 
+    /**
+     * Appends the fields of 'details' to the change log entry, which is written when this object
+     * goes out of scope.
+     */
+    void appendDetails(const BSONObj& details);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
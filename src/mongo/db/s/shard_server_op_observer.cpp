@@ -34,6 +34,7 @@
 
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/catalog_raii.h"
+#include "mongo/db/s/chunk_load_statistics.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/database_sharding_state.h"
 #include "mongo/db/s/migration_source_manager.h"
@@ -189,6 +190,23 @@ void incrementChunkOnInsertOrUpdate(OperationContext* opCtx,
     }
 }
 
+/**
+ * Attributes a sampled write of 'bytes' bytes to the chunk which owns 'document'.
+ */
+void recordChunkLoad(OperationContext* opCtx,
+                     CollectionShardingState* css,
+                     const BSONObj& document,
+                     long long bytes) {
+    auto metadata = css->getMetadata(opCtx);
+    if (!metadata) {
+        return;
+    }
+
+    const auto shardKey =
+        metadata->getChunkManager()->getShardKeyPattern().extractShardKeyFromDoc(document);
+    ChunkLoadStatistics::get(opCtx).record(*metadata.getMetadata(), shardKey, bytes, Date_t::now());
+}
+
 }  // namespace
 
 ShardServerOpObserver::ShardServerOpObserver() = default;
@@ -402,6 +420,10 @@ void shardObserveInsertOp(OperationContext* opCtx,
     if (msm) {
         msm->getCloner()->onInsertOp(opCtx, insertedDoc, opTime);
     }
+
+    if (ChunkLoadStatistics::shouldSample()) {
+        recordChunkLoad(opCtx, css, insertedDoc, insertedDoc.objsize());
+    }
 }
 
 void shardObserveUpdateOp(OperationContext* opCtx,
@@ -414,6 +436,10 @@ void shardObserveUpdateOp(OperationContext* opCtx,
     if (msm) {
         msm->getCloner()->onUpdateOp(opCtx, updatedDoc, opTime, prePostImageOpTime);
     }
+
+    if (ChunkLoadStatistics::shouldSample()) {
+        recordChunkLoad(opCtx, css, updatedDoc, updatedDoc.objsize());
+    }
 }
 
 void shardObserveDeleteOp(OperationContext* opCtx,
@@ -426,6 +452,10 @@ void shardObserveDeleteOp(OperationContext* opCtx,
     if (msm && deleteState.isMigrating) {
         msm->getCloner()->onDeleteOp(opCtx, deleteState.documentKey, opTime, preImageOpTime);
     }
+
+    if (ChunkLoadStatistics::shouldSample()) {
+        recordChunkLoad(opCtx, css, deleteState.documentKey, 0);
+    }
 }
 
 ShardObserverDeleteState ShardObserverDeleteState::make(OperationContext* opCtx,
@@ -31,6 +31,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/s/active_migrations_registry.h"
+#include "mongo/db/s/chunk_load_statistics.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/sharding_statistics.h"
 #include "mongo/db/server_options.h"
@@ -119,5 +120,30 @@ public:
 
 } shardingStatisticsServerStatus;
 
+class ChunkLoadServerStatus final : public ServerStatusSection {
+public:
+    ChunkLoadServerStatus() : ServerStatusSection("chunkLoad") {}
+
+    // The per-chunk report can be large, so it is only produced when the balancer asks for it
+    bool includeByDefault() const override {
+        return false;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        if (!isClusterNode())
+            return {};
+
+        auto const shardingState = ShardingState::get(opCtx);
+        if (!shardingState->enabled())
+            return {};
+
+        BSONObjBuilder result;
+        ChunkLoadStatistics::get(opCtx).report(&result, Date_t::now());
+        return result.obj();
+    }
+
+} chunkLoadServerStatus;
+
 }  // namespace
 }  // namespace mongo
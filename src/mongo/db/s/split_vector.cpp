@@ -32,12 +32,16 @@
 
 #include "mongo/db/s/split_vector.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "mongo/base/status_with.h"
 #include "mongo/db/bson/dotted_path_support.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/namespace_string.h"
@@ -50,6 +54,16 @@ namespace {
 
 const int kMaxObjectPerChunk{250000};
 
+// sampleSplitPoints reads a run of consecutive keys of the chunk from every random index entry
+// which falls within it, so that fewer random entries are needed. Runs are kept short enough for
+// the samples to come from at least kMinRunsPerSample runs.
+const long long kMaxKeysPerRun{16};
+const long long kMinRunsPerSample{64};
+
+// The least number of random index entries within the chunk for sampleSplitPoints to estimate the
+// number of keys in it
+const long long kMinRunsInChunk{10};
+
 BSONObj prettyKey(const BSONObj& keyPattern, const BSONObj& key) {
     return key.replaceFieldNames(keyPattern).clientReadable();
 }
@@ -276,4 +290,168 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
     return splitKeys;
 }
 
+StatusWith<boost::optional<std::vector<BSONObj>>> sampleSplitPoints(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const BSONObj& keyPattern,
+    const BSONObj& min,
+    const BSONObj& max,
+    boost::optional<long long> maxSplitPoints,
+    long long maxChunkSizeBytes,
+    int numSamples) {
+    invariant(numSamples > 0);
+
+    if (maxChunkSizeBytes <= 0) {
+        return {ErrorCodes::InvalidOptions, "need to specify the desired max chunk size"};
+    }
+
+    AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+
+    Collection* const collection = autoColl.getCollection();
+    if (!collection) {
+        return {ErrorCodes::NamespaceNotFound, "ns not found"};
+    }
+
+    IndexDescriptor* idx =
+        collection->getIndexCatalog()->findShardKeyPrefixedIndex(opCtx, keyPattern, false);
+    if (idx == NULL) {
+        return {ErrorCodes::IndexNotFound,
+                "couldn't find index over splitting key " +
+                    keyPattern.clientReadable().toString()};
+    }
+
+    KeyPattern kp(idx->keyPattern());
+    const BSONObj minKey = Helpers::toKeyFormat(kp.extendRangeBound(min, false));
+    const BSONObj maxKey = Helpers::toKeyFormat(kp.extendRangeBound(max, max.isEmpty()));
+    const Ordering ordering = Ordering::make(idx->keyPattern());
+
+    const long long recCount = collection->numRecords(opCtx);
+    const long long dataSize = collection->dataSize(opCtx);
+
+    // If there's not enough data for more than one chunk, no point continuing.
+    if (dataSize < maxChunkSizeBytes || recCount == 0) {
+        return {std::vector<BSONObj>()};
+    }
+
+    const long long keysPerRun =
+        std::max(1LL, std::min(kMaxKeysPerRun, numSamples / kMinRunsPerSample));
+
+    // A chunk holding a fraction f of the collection's N keys needs numSamples / (keysPerRun * f)
+    // random entries to be sampled, and N * f keys to be scanned. Sampling is the cheaper of the
+    // two as long as f > sqrt(numSamples / (keysPerRun * N)), which takes at most
+    // sqrt(numSamples * N / keysPerRun) random entries. A chunk which does not yield enough samples
+    // within that many is smaller than that, and scanning it costs less than the sampling did.
+    const long long maxAttempts = std::min(
+        recCount,
+        std::max(kMinRunsInChunk,
+                 static_cast<long long>(std::ceil(std::sqrt(static_cast<double>(numSamples) *
+                                                            recCount / keysPerRun)))));
+
+    auto iam = collection->getIndexCatalog()->getIndex(idx);
+    auto randomCursor = iam->newSamplingCursor(opCtx, maxAttempts);
+    if (!randomCursor) {
+        return {boost::none};
+    }
+
+    // The random cursor draws from the whole index and only finds positions within the chunk. The
+    // samples are read from those positions with a cursor which cannot leave the chunk.
+    auto rangeCursor = iam->newCursor(opCtx);
+    rangeCursor->setEndPosition(maxKey, false);
+
+    Timer timer;
+
+    std::vector<BSONObj> samples;
+    long long attempts = 0;
+    long long runs = 0;
+    while (attempts < maxAttempts && samples.size() < static_cast<size_t>(numSamples)) {
+        auto entry = randomCursor->next(SortedDataInterface::Cursor::kWantKey);
+        if (!entry) {
+            break;
+        }
+        attempts++;
+
+        if (entry->key.woCompare(minKey, ordering, false) < 0 ||
+            entry->key.woCompare(maxKey, ordering, false) >= 0) {
+            continue;
+        }
+        runs++;
+
+        // The run starts at the first entry with the random entry's key, which is the random
+        // entry itself unless its key is duplicated
+        long long keysInRun = 0;
+        for (auto key = rangeCursor->seek(entry->key, true, SortedDataInterface::Cursor::kWantKey);
+             key && keysInRun < keysPerRun;
+             key = rangeCursor->next(SortedDataInterface::Cursor::kWantKey)) {
+            samples.push_back(key->key.getOwned());
+            keysInRun++;
+        }
+    }
+
+    if (runs < std::min<long long>(numSamples, kMinRunsInChunk)) {
+        LOG(1) << "only " << runs << " of " << attempts << " sampled keys fell in chunk "
+               << nss.toString() << " " << redact(minKey) << " -->> " << redact(maxKey)
+               << ", falling back to scanning it";
+        return {boost::none};
+    }
+
+    // The fraction of random entries which fell within the chunk estimates its share of the
+    // collection. We'll use the average object size to find approximately how many keys each
+    // chunk should have, like splitVector does.
+    const long long estimatedKeysInChunk = recCount * runs / attempts;
+    const long long avgRecSize = std::max(dataSize / recCount, 1LL);
+    const long long keyCount = std::max(maxChunkSizeBytes / (2 * avgRecSize), 1LL);
+
+    // splitVector picks a split point after every keyCount keys following the chunk's first key.
+    // The sampled keys cannot resolve more split points than there are samples.
+    long long numSplitPoints = std::min<long long>(
+        std::max(estimatedKeysInChunk - 1, 0LL) / keyCount, samples.size() - 1);
+    if (maxSplitPoints && maxSplitPoints.get()) {
+        numSplitPoints = std::min(numSplitPoints, maxSplitPoints.get());
+    }
+
+    std::sort(samples.begin(), samples.end(), [&](const BSONObj& a, const BSONObj& b) {
+        return a.woCompare(b, ordering, false) < 0;
+    });
+
+    // Use the evenly spaced quantiles of the sampled keys as split points. A key which was chosen
+    // for more than one quantile is a key more frequent than a chunk allows, so it is only used
+    // once, just like splitVector does. The chunk's own min can not be a split point.
+    std::vector<BSONObj> splitKeys;
+    auto tooFrequentKeys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    BSONObj prevKey = min;
+    for (long long i = 1; i <= numSplitPoints; i++) {
+        const auto& sample = samples[i * samples.size() / (numSplitPoints + 1)];
+        BSONObj splitKey = dotted_path_support::extractElementsBasedOnTemplate(
+            prettyKey(idx->keyPattern(), sample), keyPattern);
+
+        if (splitKey.woCompare(prevKey) == 0) {
+            tooFrequentKeys.insert(splitKey.getOwned());
+            continue;
+        }
+
+        LOG(4) << "picked a sampled split key: " << redact(splitKey);
+        splitKeys.push_back(splitKey.getOwned());
+        prevKey = splitKeys.back();
+    }
+
+    for (const auto& key : tooFrequentKeys) {
+        warning() << "possible low cardinality key detected in " << nss.toString()
+                  << " - key is " << prettyKey(idx->keyPattern(), key);
+    }
+
+    if (timer.millis() > serverGlobalParams.slowMS) {
+        warning() << "Sampling the split points for " << nss.toString() << " over "
+                  << redact(keyPattern) << " keyCount: " << keyCount
+                  << " numSplits: " << splitKeys.size() << " sampled: " << samples.size()
+                  << " keys from " << runs << "/" << attempts << " random entries took "
+                  << timer.millis() << "ms";
+    }
+
+    // Make sure splitKeys is in ascending order
+    std::sort(
+        splitKeys.begin(), splitKeys.end(), SimpleBSONObjComparator::kInstance.makeLessThan());
+
+    return {std::move(splitKeys)};
+}
+
 }  // namespace mongo
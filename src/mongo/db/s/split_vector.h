@@ -66,4 +66,32 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
                                              boost::optional<long long> maxChunkSize,
                                              boost::optional<long long> maxChunkSizeBytes);
 
+/**
+ * Estimates the split points of a chunk from a random sample of the entries of the shard key
+ * index, instead of walking every key in the chunk like splitVector does, so its cost only depends
+ * on the number of samples.
+ *
+ * The random cursor returns entries from the whole index, and is only used to find random
+ * positions within the chunk. From each of them, a short run of the chunk's keys is read with a
+ * regular index cursor bounded by the chunk's max, until "numSamples" keys were read. The number of
+ * random entries drawn is bounded by the cost of scanning a chunk too small to sample. The fraction
+ * of random entries which fell within the chunk estimates the number of keys in it, from which the
+ * number of split points is derived the same way as splitVector does, so that each new chunk has
+ * approximately half the keys of a maxChunkSizeBytes chunk. The split points are then chosen at
+ * evenly spaced quantiles of the sampled keys.
+ *
+ * Returns boost::none if the storage engine does not support random index cursors or if too few of
+ * the random entries fell within the chunk for an estimate, in which case the chunk is small enough
+ * for the caller to fall back to splitVector.
+ */
+StatusWith<boost::optional<std::vector<BSONObj>>> sampleSplitPoints(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const BSONObj& keyPattern,
+    const BSONObj& min,
+    const BSONObj& max,
+    boost::optional<long long> maxSplitPoints,
+    long long maxChunkSizeBytes,
+    int numSamples);
+
 }  // namespace mongo
@@ -32,6 +32,7 @@
 
 #include "mongo/db/s/split_vector.h"
 
+#include "mongo/db/client.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/s/shard_server_test_fixture.h"
 #include "mongo/unittest/unittest.h"
@@ -300,5 +301,177 @@ TEST_F(SplitVectorTest, NoMaxChunkSize) {
     ASSERT_EQUALS(status.code(), ErrorCodes::InvalidOptions);
 }
 
+class SampleSplitPointsTest : public SplitVectorTest {
+public:
+    void setUp() {
+        SplitVectorTest::setUp();
+
+        // Make the sampled keys deterministic
+        operationContext()->getClient()->getPrng() = PseudoRandom(int64_t(12345));
+    }
+};
+
+TEST_F(SampleSplitPointsTest, SampleSplitPointsInHalf) {
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           kNss,
+                                                           BSON(kPattern << 1),
+                                                           BSON(kPattern << 0),
+                                                           BSON(kPattern << 100),
+                                                           boost::none,
+                                                           getDocSizeBytes() * 100LL,
+                                                           100));
+    ASSERT(splitKeys);
+    ASSERT_EQ(1UL, splitKeys->size());
+
+    // The median of the sampled keys only approximates the median of the chunk
+    const int splitKey = splitKeys->front()[kPattern].numberInt();
+    ASSERT_GTE(splitKey, 35);
+    ASSERT_LTE(splitKey, 65);
+}
+
+TEST_F(SampleSplitPointsTest, SampleSplitPointsAreOrderedAndWithinChunk) {
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           kNss,
+                                                           BSON(kPattern << 1),
+                                                           BSON(kPattern << 0),
+                                                           BSON(kPattern << 100),
+                                                           boost::none,
+                                                           getDocSizeBytes() * 20LL,
+                                                           100));
+    ASSERT(splitKeys);
+
+    // Sampling with replacement may pick the same key for adjacent quantiles
+    ASSERT_GTE(splitKeys->size(), 8UL);
+    ASSERT_LTE(splitKeys->size(), 9UL);
+
+    int lastSplitKey = 0;
+    for (const auto& splitKeyObj : *splitKeys) {
+        const int splitKey = splitKeyObj[kPattern].numberInt();
+        ASSERT_GT(splitKey, lastSplitKey);
+        ASSERT_LT(splitKey, 100);
+        lastSplitKey = splitKey;
+    }
+}
+
+TEST_F(SampleSplitPointsTest, SampleSplitPointsRespectsMaxSplitPoints) {
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           kNss,
+                                                           BSON(kPattern << 1),
+                                                           BSON(kPattern << 0),
+                                                           BSON(kPattern << 100),
+                                                           3LL,
+                                                           getDocSizeBytes() * 20LL,
+                                                           100));
+    ASSERT(splitKeys);
+    ASSERT_EQ(3UL, splitKeys->size());
+}
+
+TEST_F(SampleSplitPointsTest, NoSampleSplitPointsIfCollectionIsSmall) {
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           kNss,
+                                                           BSON(kPattern << 1),
+                                                           BSON(kPattern << 0),
+                                                           BSON(kPattern << 100),
+                                                           boost::none,
+                                                           getDocSizeBytes() * 200LL,
+                                                           100));
+    ASSERT(splitKeys);
+    ASSERT_EQ(0UL, splitKeys->size());
+}
+
+TEST_F(SampleSplitPointsTest, NoEstimateIfTooFewSamplesFallWithinChunk) {
+    // Only 2% of the index entries fall within the chunk, so the 100 sampled entries are not
+    // enough to estimate its split points
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           kNss,
+                                                           BSON(kPattern << 1),
+                                                           BSON(kPattern << 0),
+                                                           BSON(kPattern << 2),
+                                                           boost::none,
+                                                           getDocSizeBytes() * 2LL,
+                                                           100));
+    ASSERT(!splitKeys);
+}
+
+TEST_F(SampleSplitPointsTest, SampleSplitPointsMatchSplitVectorOnSkewedKeys) {
+    // 1500 consecutive keys followed by 500 keys 1000 apart, so that the keys are much denser at
+    // the start of the chunk
+    const NamespaceString skewedNss("foo", "skewed");
+    DBDirectClient dbclient(operationContext());
+    ASSERT_TRUE(dbclient.createCollection(skewedNss.ns()));
+    for (int i = 0; i < 2000; i++) {
+        dbclient.insert(skewedNss.toString(),
+                        BSON(kPattern << (i < 1500 ? i : 1500 + (i - 1500) * 1000)));
+    }
+
+    // The chunk holds the 1500 dense keys and 250 of the sparse ones, and each new chunk should
+    // have 200 keys
+    const BSONObj min = BSON(kPattern << 0);
+    const BSONObj max = BSON(kPattern << 251500);
+    const long long maxChunkSizeBytes = getDocSizeBytes() * 400LL;
+    const long long maxKeysPerChunk = 400;
+
+    const auto expectedSplitKeys = unittest::assertGet(splitVector(operationContext(),
+                                                                   skewedNss,
+                                                                   BSON(kPattern << 1),
+                                                                   min,
+                                                                   max,
+                                                                   false,
+                                                                   boost::none,
+                                                                   boost::none,
+                                                                   boost::none,
+                                                                   maxChunkSizeBytes));
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           skewedNss,
+                                                           BSON(kPattern << 1),
+                                                           min,
+                                                           max,
+                                                           boost::none,
+                                                           maxChunkSizeBytes,
+                                                           1000));
+    ASSERT(splitKeys);
+    ASSERT_GTE(splitKeys->size() + 1, expectedSplitKeys.size());
+    ASSERT_LTE(splitKeys->size(), expectedSplitKeys.size() + 1);
+
+    // Splitting at evenly spaced keys instead of evenly spaced quantiles would leave most of the
+    // dense keys in a single chunk
+    BSONObj chunkMin = min;
+    for (size_t i = 0; i <= splitKeys->size(); i++) {
+        const BSONObj chunkMax = i < splitKeys->size() ? (*splitKeys)[i] : max;
+        const auto keysInChunk = dbclient.count(skewedNss.toString(),
+                                                BSON(kPattern << BSON("$gte" << chunkMin[kPattern]
+                                                                         << "$lt"
+                                                                         << chunkMax[kPattern])));
+        ASSERT_LTE(keysInChunk, static_cast<unsigned long long>(maxKeysPerChunk));
+        chunkMin = chunkMax;
+    }
+}
+
+TEST_F(SampleSplitPointsTest, SampleSplitPointsNoCollection) {
+    auto status = sampleSplitPoints(operationContext(),
+                                    NamespaceString("dummy", "collection"),
+                                    BSON(kPattern << 1),
+                                    BSON(kPattern << 0),
+                                    BSON(kPattern << 100),
+                                    boost::none,
+                                    getDocSizeBytes() * 100LL,
+                                    100)
+                      .getStatus();
+    ASSERT_EQUALS(status.code(), ErrorCodes::NamespaceNotFound);
+}
+
+TEST_F(SampleSplitPointsTest, SampleSplitPointsNoIndex) {
+    auto status = sampleSplitPoints(operationContext(),
+                                    kNss,
+                                    BSON("foo" << 1),
+                                    BSON(kPattern << 0),
+                                    BSON(kPattern << 100),
+                                    boost::none,
+                                    getDocSizeBytes() * 100LL,
+                                    100)
+                      .getStatus();
+    ASSERT_EQUALS(status.code(), ErrorCodes::IndexNotFound);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -965,6 +965,7 @@ DbResponse runCommands(OperationContext* opCtx,
                        const Message& message,
                        const ServiceEntryPointCommon::Hooks& behaviors) {
     auto replyBuilder = rpc::makeReplyBuilder(rpc::protocolForMessage(message));
+    bool isGetMore = false;
     [&] {
         OpMsgRequest request;
         try {  // Parse.
@@ -994,6 +995,7 @@ DbResponse runCommands(OperationContext* opCtx,
 
         try {  // Execute.
             curOpCommandSetup(opCtx, request);
+            isGetMore = request.getCommandName() == "getMore"_sd;
 
             Command* c = nullptr;
             // In the absence of a Command object, no redaction is possible. Therefore
@@ -1046,8 +1048,12 @@ DbResponse runCommands(OperationContext* opCtx,
     auto response = replyBuilder->done();
     CurOp::get(opCtx)->debug().responseLength = response.header().dataLen();
 
-    // TODO exhaust
-    return DbResponse{std::move(response)};
+    DbResponse dbResponse{std::move(response)};
+    if (isGetMore && OpMsg::isFlagSet(message, OpMsg::kExhaustSupported)) {
+        dbResponse.nextInvocation =
+            ServiceEntryPointCommon::makeNextExhaustGetMore(message, &dbResponse.response);
+    }
+    return dbResponse;
 }
 
 DbResponse receivedQuery(OperationContext* opCtx,
@@ -1254,6 +1260,47 @@ BSONObj ServiceEntryPointCommon::getRedactedCopyForLogging(const Command* comman
     return bob.obj();
 }
 
+boost::optional<Message> ServiceEntryPointCommon::makeNextExhaustGetMore(const Message& request,
+                                                                         Message* reply) {
+    const auto replyBody = OpMsg::parse(*reply).body;
+    if (!replyBody["ok"].trueValue() || replyBody["cursor"]["id"].safeNumberLong() == 0) {
+        return boost::none;
+    }
+
+    // The client learns the commit point from the metadata of each reply. Pass the one it was just
+    // sent on to the next getMore so that an awaitData getMore does not return early for a commit
+    // point the client already knows about. The commit point may have moved since the reply was
+    // built, so it must not be read from the replication coordinator here.
+    boost::optional<repl::OpTime> lastCommittedOpTime;
+    if (replyBody.hasField(rpc::kOplogQueryMetadataFieldName)) {
+        auto metadata = rpc::OplogQueryMetadata::readFromMetadata(replyBody);
+        if (metadata.isOK()) {
+            lastCommittedOpTime = metadata.getValue().getLastOpCommitted();
+        }
+    } else if (replyBody.hasField(rpc::kReplSetMetadataFieldName)) {
+        auto metadata = rpc::ReplSetMetadata::readFromMetadata(replyBody);
+        if (metadata.isOK()) {
+            lastCommittedOpTime = metadata.getValue().getLastOpCommitted();
+        }
+    }
+
+    BSONObjBuilder bodyBuilder;
+    for (auto&& elem : OpMsg::parse(request).body) {
+        if (lastCommittedOpTime && elem.fieldNameStringData() == "lastKnownCommittedOpTime"_sd) {
+            lastCommittedOpTime->append(&bodyBuilder, "lastKnownCommittedOpTime");
+        } else {
+            bodyBuilder.append(elem);
+        }
+    }
+
+    OpMsg nextRequest;
+    nextRequest.body = bodyBuilder.obj();
+    auto nextInvocation = nextRequest.serialize();
+    OpMsg::setFlag(&nextInvocation, OpMsg::kExhaustSupported);
+    OpMsg::setFlag(reply, OpMsg::kMoreToCome);
+    return nextInvocation;
+}
+
 DbResponse ServiceEntryPointCommon::handleRequest(OperationContext* opCtx,
                                                   const Message& m,
                                                   const Hooks& behaviors) {
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/transport/service_entry_point_impl.h"
 
 #include "mongo/base/status.h"
@@ -81,6 +83,16 @@ struct ServiceEntryPointCommon {
      * `command->redactForLogging`.
      */
     static BSONObj getRedactedCopyForLogging(const Command* command, const BSONObj& cmdObj);
+
+    /**
+     * For a getMore sent with the exhaustSupported flag, marks 'reply' as one of several replies
+     * and returns the getMore to run next. Returns boost::none once the getMore failed or exhausted
+     * its cursor.
+     *
+     * The next getMore is sent the commit point found in the metadata of 'reply' as its
+     * lastKnownCommittedOpTime.
+     */
+    static boost::optional<Message> makeNextExhaustGetMore(const Message& request, Message* reply);
 };
 
 }  // namespace mongo
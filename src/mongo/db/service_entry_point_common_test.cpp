@@ -0,0 +1,148 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/service_entry_point_common.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/rpc/metadata/oplog_query_metadata.h"
+#include "mongo/rpc/metadata/repl_set_metadata.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const repl::OpTime kClientsCommitPoint(Timestamp(10, 1), 1);
+const repl::OpTime kReplDataCommitPoint(Timestamp(20, 1), 1);
+const repl::OpTime kOplogQueryDataCommitPoint(Timestamp(30, 1), 1);
+
+Message makeExhaustGetMore() {
+    BSONObjBuilder bob;
+    bob.append("getMore", 5LL);
+    bob.append("collection", "oplog.rs");
+    kClientsCommitPoint.append(&bob, "lastKnownCommittedOpTime");
+    bob.append("$db", "local");
+
+    auto request = OpMsg{bob.obj()}.serialize();
+    OpMsg::setFlag(&request, OpMsg::kExhaustSupported);
+    return request;
+}
+
+BSONObjBuilder makeReplyBuilder(long long cursorId) {
+    BSONObjBuilder bob;
+    bob.append("cursor",
+               BSON("id" << cursorId << "ns"
+                         << "local.oplog.rs"
+                         << "nextBatch"
+                         << BSONArray()));
+    bob.append("ok", 1);
+    return bob;
+}
+
+void appendReplData(BSONObjBuilder* bob) {
+    ASSERT_OK(rpc::ReplSetMetadata(
+                  1, kReplDataCommitPoint, kReplDataCommitPoint, 1, OID::gen(), 0, -1)
+                  .writeToMetadata(bob));
+}
+
+void appendOplogQueryData(BSONObjBuilder* bob) {
+    ASSERT_OK(
+        rpc::OplogQueryMetadata(kOplogQueryDataCommitPoint, kOplogQueryDataCommitPoint, 1, 0, -1)
+            .writeToMetadata(bob));
+}
+
+repl::OpTime lastKnownCommittedOpTime(const Message& getMore) {
+    return repl::OpTime::parse(OpMsg::parse(getMore).body["lastKnownCommittedOpTime"].Obj());
+}
+
+TEST(MakeNextExhaustGetMoreTest, PassesOnCommitPointFromOplogQueryMetadata) {
+    auto request = makeExhaustGetMore();
+    auto replyBuilder = makeReplyBuilder(5);
+    appendReplData(&replyBuilder);
+    appendOplogQueryData(&replyBuilder);
+    auto reply = OpMsg{replyBuilder.obj()}.serialize();
+
+    auto next = ServiceEntryPointCommon::makeNextExhaustGetMore(request, &reply);
+    ASSERT(next);
+    ASSERT(OpMsg::isFlagSet(reply, OpMsg::kMoreToCome));
+    ASSERT(OpMsg::isFlagSet(*next, OpMsg::kExhaustSupported));
+    ASSERT_EQ(kOplogQueryDataCommitPoint, lastKnownCommittedOpTime(*next));
+
+    // Everything but the commit point is sent again unchanged.
+    ASSERT_BSONOBJ_EQ(OpMsg::parse(request).body.removeField("lastKnownCommittedOpTime"),
+                      OpMsg::parse(*next).body.removeField("lastKnownCommittedOpTime"));
+}
+
+TEST(MakeNextExhaustGetMoreTest, PassesOnCommitPointFromReplSetMetadata) {
+    auto request = makeExhaustGetMore();
+    auto replyBuilder = makeReplyBuilder(5);
+    appendReplData(&replyBuilder);
+    auto reply = OpMsg{replyBuilder.obj()}.serialize();
+
+    auto next = ServiceEntryPointCommon::makeNextExhaustGetMore(request, &reply);
+    ASSERT(next);
+    ASSERT_EQ(kReplDataCommitPoint, lastKnownCommittedOpTime(*next));
+}
+
+TEST(MakeNextExhaustGetMoreTest, KeepsCommitPointWithoutReplyMetadata) {
+    auto request = makeExhaustGetMore();
+    auto reply = OpMsg{makeReplyBuilder(5).obj()}.serialize();
+
+    auto next = ServiceEntryPointCommon::makeNextExhaustGetMore(request, &reply);
+    ASSERT(next);
+    ASSERT_EQ(kClientsCommitPoint, lastKnownCommittedOpTime(*next));
+}
+
+TEST(MakeNextExhaustGetMoreTest, StopsOnceCursorIsExhausted) {
+    auto request = makeExhaustGetMore();
+    auto replyBuilder = makeReplyBuilder(0);
+    appendOplogQueryData(&replyBuilder);
+    auto reply = OpMsg{replyBuilder.obj()}.serialize();
+
+    ASSERT_FALSE(ServiceEntryPointCommon::makeNextExhaustGetMore(request, &reply));
+    ASSERT_FALSE(OpMsg::isFlagSet(reply, OpMsg::kMoreToCome));
+}
+
+TEST(MakeNextExhaustGetMoreTest, StopsOnError) {
+    auto request = makeExhaustGetMore();
+    auto reply = OpMsg{BSON("ok" << 0 << "errmsg"
+                                 << "cursor not found"
+                                 << "code"
+                                 << ErrorCodes::CursorNotFound)}
+                     .serialize();
+
+    ASSERT_FALSE(ServiceEntryPointCommon::makeNextExhaustGetMore(request, &reply));
+    ASSERT_FALSE(OpMsg::isFlagSet(reply, OpMsg::kMoreToCome));
+}
+
+}  // namespace
+}  // namespace mongo
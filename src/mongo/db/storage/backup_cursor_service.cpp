@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/backup_cursor_service.h"
+
+#include <algorithm>
+#include <boost/filesystem/path.hpp>
+#include <fstream>
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/util/clock_source.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const auto getBackupCursorService = ServiceContext::declareDecoration<BackupCursorService>();
+
+// Seconds after which an unused backup cursor may be closed to make way for a new one.
+MONGO_EXPORT_SERVER_PARAMETER(backupCursorTimeoutSecs, int, 30 * 60)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue, "backupCursorTimeoutSecs must be at least 1");
+        }
+        return Status::OK();
+    });
+
+}  // namespace
+
+BackupCursorService* BackupCursorService::get(ServiceContext* service) {
+    return &getBackupCursorService(service);
+}
+
+StatusWith<BackupCursorService::BackupCursorState> BackupCursorService::openBackupCursor(
+    OperationContext* opCtx) {
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    const auto now = opCtx->getServiceContext()->getFastClockSource()->now();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_state) {
+        if (now - _lastUsed < Seconds(backupCursorTimeoutSecs.load())) {
+            return Status(ErrorCodes::ConflictingOperationInProgress,
+                          str::stream() << "Backup cursor " << _state->backupId
+                                        << " is already open");
+        }
+        log() << "Closing backup cursor " << _state->backupId << " which was last used at "
+              << _lastUsed;
+        _closeBackupCursor_inlock(opCtx);
+    }
+
+    // Read before the cursor is opened, since a checkpoint completing in between only makes the
+    // backup newer than reported.
+    Timestamp checkpointTimestamp;
+    if (storageEngine->supportsRecoverToStableTimestamp()) {
+        checkpointTimestamp =
+            storageEngine->getLastStableCheckpointTimestamp().value_or(Timestamp());
+    }
+
+    auto files = storageEngine->beginNonBlockingBackup(opCtx);
+    if (!files.isOK()) {
+        return files.getStatus();
+    }
+
+    _state = BackupCursorState{UUID::gen(), checkpointTimestamp, std::move(files.getValue())};
+    _lastUsed = now;
+    log() << "Opened backup cursor " << _state->backupId << " with " << _state->files.size()
+          << " files at checkpoint timestamp " << checkpointTimestamp;
+    return *_state;
+}
+
+Status BackupCursorService::closeBackupCursor(OperationContext* opCtx, const UUID& backupId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto status = _checkBackupId_inlock(backupId);
+    if (!status.isOK()) {
+        return status;
+    }
+    log() << "Closing backup cursor " << backupId;
+    _closeBackupCursor_inlock(opCtx);
+    return Status::OK();
+}
+
+StatusWith<std::string> BackupCursorService::readBackupFile(OperationContext* opCtx,
+                                                            const UUID& backupId,
+                                                            StringData filename,
+                                                            std::uint64_t offset,
+                                                            std::size_t length) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto status = _checkBackupId_inlock(backupId);
+    if (!status.isOK()) {
+        return status;
+    }
+    _lastUsed = opCtx->getServiceContext()->getFastClockSource()->now();
+
+    // Only files that belong to the backup may be read, which also keeps callers inside the dbpath.
+    auto file = std::find_if(
+        _state->files.begin(), _state->files.end(), [&](const StorageEngine::BackupFile& f) {
+            return f.filename == filename;
+        });
+    if (file == _state->files.end()) {
+        return Status(ErrorCodes::NoSuchKey,
+                      str::stream() << "'" << filename << "' is not part of backup " << backupId);
+    }
+    if (offset >= file->fileSize) {
+        return std::string();
+    }
+    const auto toRead = static_cast<std::size_t>(
+        std::min(static_cast<std::uint64_t>(length), file->fileSize - offset));
+
+    const auto path = boost::filesystem::path(storageGlobalParams.dbpath) / file->filename;
+    std::ifstream in(path.string(), std::ios::binary);
+    std::string data(toRead, '\0');
+    if (!in.seekg(static_cast<std::streamoff>(offset)) || !in.read(&data[0], toRead)) {
+        return Status(ErrorCodes::FileStreamFailed,
+                      str::stream() << "Failed to read " << toRead << " bytes at offset " << offset
+                                    << " of backup file "
+                                    << path.string());
+    }
+    return std::move(data);
+}
+
+Status BackupCursorService::_checkBackupId_inlock(const UUID& backupId) const {
+    if (!_state || _state->backupId != backupId) {
+        return Status(ErrorCodes::NoSuchKey,
+                      str::stream() << "Backup cursor " << backupId << " is not open");
+    }
+    return Status::OK();
+}
+
+void BackupCursorService::_closeBackupCursor_inlock(OperationContext* opCtx) {
+    opCtx->getServiceContext()->getStorageEngine()->endNonBlockingBackup(opCtx);
+    _state = boost::none;
+}
+
+}  // namespace mongo
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Serves the files of a non-blocking storage engine backup to a remote node, as used by file copy
+ * based initial sync. At most one backup cursor is open at a time. A backup cursor that has not
+ * been used for 'backupCursorTimeoutSecs' is closed when another one is requested, so that a sync
+ * source does not keep a checkpoint pinned forever for a node that went away.
+ */
+class BackupCursorService {
+    MONGO_DISALLOW_COPYING(BackupCursorService);
+
+public:
+    struct BackupCursorState {
+        UUID backupId;
+        // A lower bound on the timestamp of the checkpoint the backup captured. Null if the
+        // storage engine does not take stable checkpoints.
+        Timestamp checkpointTimestamp;
+        std::vector<StorageEngine::BackupFile> files;
+    };
+
+    static BackupCursorService* get(ServiceContext* service);
+
+    BackupCursorService() = default;
+
+    /**
+     * Opens a backup cursor on the storage engine and returns the files that make up the backup.
+     */
+    StatusWith<BackupCursorState> openBackupCursor(OperationContext* opCtx);
+
+    /**
+     * Closes the backup cursor identified by 'backupId'.
+     */
+    Status closeBackupCursor(OperationContext* opCtx, const UUID& backupId);
+
+    /**
+     * Reads up to 'length' bytes at 'offset' of the backup file 'filename', never past the size the
+     * file had when the backup was opened. Returns an empty string once 'offset' reaches that size.
+     */
+    StatusWith<std::string> readBackupFile(OperationContext* opCtx,
+                                           const UUID& backupId,
+                                           StringData filename,
+                                           std::uint64_t offset,
+                                           std::size_t length);
+
+private:
+    Status _checkBackupId_inlock(const UUID& backupId) const;
+
+    void _closeBackupCursor_inlock(OperationContext* opCtx);
+
+    stdx::mutex _mutex;
+    boost::optional<BackupCursorState> _state;
+    Date_t _lastUsed;
+};
+
+}  // namespace mongo
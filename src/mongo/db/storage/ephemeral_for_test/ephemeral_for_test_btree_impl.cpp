@@ -35,6 +35,7 @@
 #include <set>
 
 #include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/client.h"
 #include "mongo/db/storage/ephemeral_for_test/ephemeral_for_test_recovery_unit.h"
 #include "mongo/db/storage/index_entry_comparison.h"
 #include "mongo/stdx/memory.h"
@@ -475,6 +476,63 @@ public:
         return stdx::make_unique<Cursor>(opCtx, *_data, isForward, _isUnique);
     }
 
+    class RandomCursor final : public SortedDataInterface::Cursor {
+    public:
+        RandomCursor(OperationContext* opCtx, const IndexSet& data)
+            : _opCtx(opCtx), _data(data) {}
+
+        boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
+            if (_data.empty()) {
+                return {};
+            }
+
+            // A std::set cannot be indexed, so this is linear in the number of entries, which is
+            // acceptable for a storage engine only used for testing
+            auto& prng = _opCtx->getClient()->getPrng();
+            return *std::next(_data.begin(), prng.nextInt64(_data.size()));
+        }
+
+        void detachFromOperationContext() final {
+            _opCtx = nullptr;
+        }
+
+        void reattachToOperationContext(OperationContext* opCtx) final {
+            _opCtx = opCtx;
+        }
+
+        //
+        // Should never be called.
+        //
+        void setEndPosition(const BSONObj& key, bool inclusive) override {
+            MONGO_UNREACHABLE;
+        }
+        boost::optional<IndexKeyEntry> seek(const BSONObj& key,
+                                            bool inclusive,
+                                            RequestedInfo parts) override {
+            MONGO_UNREACHABLE;
+        }
+        boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
+                                            RequestedInfo parts) override {
+            MONGO_UNREACHABLE;
+        }
+
+        //
+        // May be called, but are no-ops.
+        //
+        void save() override {}
+        void saveUnpositioned() override {}
+        void restore() override {}
+
+    private:
+        OperationContext* _opCtx;
+        const IndexSet& _data;
+    };
+
+    virtual std::unique_ptr<SortedDataInterface::Cursor> newRandomCursor(
+        OperationContext* opCtx) const {
+        return stdx::make_unique<RandomCursor>(opCtx, *_data);
+    }
+
     virtual Status initAsEmpty(OperationContext* opCtx) {
         // No-op
         return Status::OK();
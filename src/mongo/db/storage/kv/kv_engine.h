@@ -40,6 +40,7 @@
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/storage_engine.h"
 
 namespace mongo {
 
@@ -187,6 +188,22 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    /**
+     * See StorageEngine::beginNonBlockingBackup for details
+     */
+    virtual StatusWith<std::vector<StorageEngine::BackupFile>> beginNonBlockingBackup(
+        OperationContext* opCtx) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The current storage engine doesn't support non-blocking backups");
+    }
+
+    /**
+     * See StorageEngine::endNonBlockingBackup for details
+     */
+    virtual void endNonBlockingBackup(OperationContext* opCtx) {
+        MONGO_UNREACHABLE;
+    }
+
     virtual bool isDurable() const = 0;
 
     /**
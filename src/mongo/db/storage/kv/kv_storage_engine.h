@@ -109,6 +109,10 @@ public:
 
     virtual void endBackup(OperationContext* opCtx);
 
+    StatusWith<std::vector<BackupFile>> beginNonBlockingBackup(OperationContext* opCtx) override;
+
+    void endNonBlockingBackup(OperationContext* opCtx) override;
+
     virtual bool isDurable() const;
 
     virtual bool isEphemeral() const;
@@ -0,0 +1,458 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_index.h"
+
+#include <utility>
+#include <vector>
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_recovery_unit.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/bufreader.h"
+
+namespace mongo {
+namespace {
+
+const int TempKeyMaxSize = 1024;  // This goes away with SERVER-3372.
+
+bool hasFieldNames(const BSONObj& obj) {
+    BSONForEach(e, obj) {
+        if (e.fieldName()[0])
+            return true;
+    }
+    return false;
+}
+
+BSONObj stripFieldNames(const BSONObj& query) {
+    if (!hasFieldNames(query))
+        return query;
+
+    BSONObjBuilder bb;
+    BSONForEach(e, query) {
+        bb.appendAs(e, StringData());
+    }
+    return bb.obj();
+}
+
+Status checkKeySize(const BSONObj& key) {
+    if (key.objsize() >= TempKeyMaxSize) {
+        return Status(ErrorCodes::KeyTooLong, "key too big");
+    }
+    return Status::OK();
+}
+
+StringData toStringData(const KeyString& ks) {
+    return StringData(ks.getBuffer(), ks.getSize());
+}
+
+MemoryMVCCTransaction* getTransaction(OperationContext* opCtx) {
+    return MemoryMVCCRecoveryUnit::get(opCtx)->getTransaction();
+}
+
+}  // namespace
+
+MemoryMVCCIndex::Data::Data()
+    : entries(std::make_shared<MemoryMVCCTable>()),
+      uniqueKeys(std::make_shared<MemoryMVCCTable>()) {}
+
+MemoryMVCCIndex::MemoryMVCCIndex(const Ordering& ordering,
+                                 bool isUnique,
+                                 StringData ident,
+                                 std::shared_ptr<void>* dataInOut)
+    : _ordering(ordering),
+      _isUnique(isUnique),
+      _ident(ident.toString()),
+      _data([&] {
+          if (!*dataInOut) {
+              *dataInOut = std::make_shared<Data>();
+          }
+          return std::shared_ptr<Data>(*dataInOut, static_cast<Data*>(dataInOut->get()));
+      }()) {}
+
+Status MemoryMVCCIndex::insert(OperationContext* opCtx,
+                               const BSONObj& key,
+                               const RecordId& loc,
+                               bool dupsAllowed) {
+    invariant(loc.isNormal());
+    invariant(!hasFieldNames(key));
+
+    Status status = checkKeySize(key);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    auto txn = getTransaction(opCtx);
+    if (_isUnique && !dupsAllowed) {
+        const KeyString prefix(_keyStringVersion, key, _ordering);
+        _lockUniqueKey(txn, prefix);
+        if (_isDup(*txn, prefix, loc)) {
+            return _dupKeyError(key);
+        }
+    }
+
+    const KeyString entry(_keyStringVersion, key, _ordering, loc);
+    const auto& typeBits = entry.getTypeBits();
+    _data->entries->put(txn,
+                        toStringData(entry),
+                        reinterpret_cast<const char*>(typeBits.getBuffer()),
+                        typeBits.getSize());
+    return Status::OK();
+}
+
+void MemoryMVCCIndex::unindex(OperationContext* opCtx,
+                              const BSONObj& key,
+                              const RecordId& loc,
+                              bool dupsAllowed) {
+    invariant(loc.isNormal());
+    invariant(!hasFieldNames(key));
+
+    auto txn = getTransaction(opCtx);
+    if (_isUnique) {
+        _lockUniqueKey(txn, KeyString(_keyStringVersion, key, _ordering));
+    }
+
+    const KeyString entry(_keyStringVersion, key, _ordering, loc);
+    _data->entries->remove(txn, toStringData(entry));
+}
+
+Status MemoryMVCCIndex::dupKeyCheck(OperationContext* opCtx,
+                                    const BSONObj& key,
+                                    const RecordId& loc) {
+    invariant(!hasFieldNames(key));
+    invariant(_isUnique);
+
+    if (_isDup(*getTransaction(opCtx), KeyString(_keyStringVersion, key, _ordering), loc))
+        return _dupKeyError(key);
+    return Status::OK();
+}
+
+bool MemoryMVCCIndex::_isDup(const MemoryMVCCTransaction& txn,
+                             const KeyString& key,
+                             const RecordId& loc) const {
+    // The KeyString of a key without a RecordId is a prefix of the KeyString of every entry for
+    // that key.
+    const StringData prefix = toStringData(key);
+    auto entry = _data->entries->seek(txn, prefix, true, true);
+    while (entry && StringData(entry->key).startsWith(prefix)) {
+        if (KeyString::decodeRecordIdAtEnd(entry->key.data(), entry->key.size()) != loc)
+            return true;
+        entry = _data->entries->seek(txn, entry->key, true, false);
+    }
+    return false;
+}
+
+void MemoryMVCCIndex::_lockUniqueKey(MemoryMVCCTransaction* txn, const KeyString& key) {
+    // Deleting the key right away keeps the table from growing; the uncommitted delete conflicts
+    // just as well as an insert would, and is pruned once it is visible to everyone.
+    _data->uniqueKeys->put(txn, toStringData(key), nullptr, 0);
+    _data->uniqueKeys->remove(txn, toStringData(key));
+}
+
+Status MemoryMVCCIndex::_dupKeyError(const BSONObj& key) const {
+    StringBuilder sb;
+    sb << "E11000 duplicate key error ";
+    sb << "index: " << _ident << " ";
+    sb << "dup key: " << key;
+    return Status(ErrorCodes::DuplicateKey, sb.str());
+}
+
+void MemoryMVCCIndex::fullValidate(OperationContext* opCtx,
+                                   long long* numKeysOut,
+                                   ValidateResults* fullResults) const {
+    if (numKeysOut) {
+        *numKeysOut = numEntries(opCtx);
+    }
+}
+
+bool MemoryMVCCIndex::appendCustomStats(OperationContext* opCtx,
+                                        BSONObjBuilder* output,
+                                        double scale) const {
+    return false;
+}
+
+long long MemoryMVCCIndex::getSpaceUsedBytes(OperationContext* opCtx) const {
+    auto txn = getTransaction(opCtx);
+    long long size = 0;
+    auto entry = _data->entries->seek(*txn, StringData(), true, false);
+    while (entry) {
+        size += entry->key.size() + entry->size;
+        entry = _data->entries->seek(*txn, entry->key, true, false);
+    }
+    return size;
+}
+
+long long MemoryMVCCIndex::numEntries(OperationContext* opCtx) const {
+    auto txn = getTransaction(opCtx);
+    long long count = 0;
+    auto entry = _data->entries->seek(*txn, StringData(), true, false);
+    while (entry) {
+        count++;
+        entry = _data->entries->seek(*txn, entry->key, true, false);
+    }
+    return count;
+}
+
+bool MemoryMVCCIndex::isEmpty(OperationContext* opCtx) {
+    return !_data->entries->seek(*getTransaction(opCtx), StringData(), true, false);
+}
+
+Status MemoryMVCCIndex::initAsEmpty(OperationContext* opCtx) {
+    // No-op.
+    return Status::OK();
+}
+
+/**
+ * Buffers keys in order and installs them in a single transaction of its own on commit(), so
+ * that the build neither depends on nor holds open the caller's snapshot.
+ */
+class MemoryMVCCIndex::BulkBuilder final : public SortedDataBuilderInterface {
+public:
+    BulkBuilder(MemoryMVCCIndex* index, OperationContext* opCtx, bool dupsAllowed)
+        : _index(index), _opCtx(opCtx), _dupsAllowed(dupsAllowed) {}
+
+    Status addKey(const BSONObj& key, const RecordId& loc) final {
+        invariant(loc.isNormal());
+        invariant(!hasFieldNames(key));
+
+        Status status = checkKeySize(key);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        // Checks whether the new key to be inserted is > or >= the previous one depending on
+        // _dupsAllowed.
+        const int cmp = key.woCompare(_lastKey, _index->_ordering);
+        if (!_dupsAllowed && _index->_isUnique && cmp == 0) {
+            return _index->_dupKeyError(key);
+        } else if (cmp < 0) {
+            return Status(ErrorCodes::InternalError, "expected higher RecordId in bulk builder");
+        }
+        _lastKey = key.getOwned();
+
+        const KeyString ks(_index->_keyStringVersion, key, _index->_ordering, loc);
+        const auto& typeBits = ks.getTypeBits();
+        _entries.emplace_back(std::string(ks.getBuffer(), ks.getSize()),
+                              std::string(reinterpret_cast<const char*>(typeBits.getBuffer()),
+                                          typeBits.getSize()));
+        return Status::OK();
+    }
+
+    void commit(bool mayInterrupt) final {
+        auto store = MemoryMVCCRecoveryUnit::get(_opCtx)->getStore();
+        auto txn = store->beginTransaction(boost::none);
+        for (const auto& entry : _entries) {
+            _index->_data->entries->put(
+                txn.get(), entry.first, entry.second.data(), entry.second.size());
+        }
+        txn->commit(Timestamp());
+        _entries.clear();
+    }
+
+private:
+    MemoryMVCCIndex* const _index;
+    OperationContext* const _opCtx;
+    const bool _dupsAllowed;
+    BSONObj _lastKey;
+    // Pairs of entry keys and type bits.
+    std::vector<std::pair<std::string, std::string>> _entries;
+};
+
+SortedDataBuilderInterface* MemoryMVCCIndex::getBulkBuilder(OperationContext* opCtx,
+                                                            bool dupsAllowed) {
+    return new BulkBuilder(this, opCtx, dupsAllowed);
+}
+
+/**
+ * Like the record store cursor, remembers the KeyString of its current entry and looks up the
+ * next visible entry on every move.
+ */
+class MemoryMVCCIndex::Cursor final : public SortedDataInterface::Cursor {
+public:
+    Cursor(const MemoryMVCCIndex& index, OperationContext* opCtx, bool isForward)
+        : _index(index),
+          _opCtx(opCtx),
+          _isForward(isForward),
+          _typeBits(index._keyStringVersion) {}
+
+    boost::optional<IndexKeyEntry> next(RequestedInfo parts) final {
+        if (_isEOF) {
+            return {};
+        }
+
+        if (_lastMoveWasRestore) {
+            // restore() already moved the cursor past the saved position.
+            _lastMoveWasRestore = false;
+        } else {
+            _updatePosition(_index._data->entries->seek(
+                *getTransaction(_opCtx), _key, _isForward, false));
+        }
+        return _getCurrentEntry(parts);
+    }
+
+    void setEndPosition(const BSONObj& key, bool inclusive) final {
+        // Scan to end of index.
+        if (key.isEmpty()) {
+            _endPosition.reset();
+            return;
+        }
+
+        // This uses the opposite rules as a normal seek because a forward scan should end after the
+        // key if inclusive and before if exclusive.
+        const auto discriminator =
+            _isForward == inclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore;
+        _endPosition = stdx::make_unique<KeyString>(_index._keyStringVersion);
+        _endPosition->resetToKey(stripFieldNames(key), _index._ordering, discriminator);
+    }
+
+    boost::optional<IndexKeyEntry> seek(const BSONObj& key,
+                                        bool inclusive,
+                                        RequestedInfo parts) final {
+        // By using a discriminator other than kInclusive, the start position never equals an
+        // entry, so there is no need to distinguish inclusive and exclusive seeks below.
+        const auto discriminator =
+            _isForward == inclusive ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+        return _seek(KeyString(_index._keyStringVersion,
+                               stripFieldNames(key),
+                               _index._ordering,
+                               discriminator),
+                     parts);
+    }
+
+    boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
+                                        RequestedInfo parts) final {
+        BSONObj startKey = IndexEntryComparison::makeQueryObject(seekPoint, _isForward);
+
+        const auto discriminator =
+            _isForward ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+        return _seek(
+            KeyString(_index._keyStringVersion, startKey, _index._ordering, discriminator), parts);
+    }
+
+    // All work is done in restore().
+    void save() final {}
+
+    void saveUnpositioned() final {
+        _isEOF = true;
+    }
+
+    void restore() final {
+        if (_isEOF) {
+            return;
+        }
+
+        auto entry =
+            _index._data->entries->seek(*getTransaction(_opCtx), _key, _isForward, true);
+        if (entry && entry->key == _key) {
+            return;
+        }
+
+        // The entry we were positioned on is gone; position on the one after it, which the next
+        // call to next() returns.
+        _updatePosition(std::move(entry));
+        _lastMoveWasRestore = !_isEOF;
+    }
+
+    void detachFromOperationContext() final {
+        _opCtx = nullptr;
+    }
+
+    void reattachToOperationContext(OperationContext* opCtx) final {
+        _opCtx = opCtx;
+    }
+
+private:
+    boost::optional<IndexKeyEntry> _seek(const KeyString& start, RequestedInfo parts) {
+        _lastMoveWasRestore = false;
+        _updatePosition(_index._data->entries->seek(
+            *getTransaction(_opCtx), toStringData(start), _isForward, true));
+        return _getCurrentEntry(parts);
+    }
+
+    /**
+     * Moves to 'entry', or to EOF if there is none or it is past the end position.
+     */
+    void _updatePosition(boost::optional<MemoryMVCCTable::Entry> entry) {
+        if (!entry) {
+            _isEOF = true;
+            return;
+        }
+
+        if (_endPosition) {
+            const int cmp = StringData(entry->key).compare(toStringData(*_endPosition));
+            if (_isForward ? cmp > 0 : cmp < 0) {
+                _isEOF = true;
+                return;
+            }
+        }
+
+        _isEOF = false;
+        _key = std::move(entry->key);
+        _recId = KeyString::decodeRecordIdAtEnd(_key.data(), _key.size());
+        BufReader br(entry->value.get(), entry->size);
+        _typeBits.resetFromBuffer(&br);
+    }
+
+    boost::optional<IndexKeyEntry> _getCurrentEntry(RequestedInfo parts) const {
+        if (_isEOF) {
+            return {};
+        }
+
+        BSONObj bson;
+        if (parts & kWantKey) {
+            bson = KeyString::toBson(_key.data(), _key.size(), _index._ordering, _typeBits);
+        }
+
+        return {{std::move(bson), _recId}};
+    }
+
+    const MemoryMVCCIndex& _index;
+    OperationContext* _opCtx;
+    const bool _isForward;
+
+    bool _isEOF = true;
+    bool _lastMoveWasRestore = false;
+
+    // The current position.
+    std::string _key;
+    RecordId _recId;
+    KeyString::TypeBits _typeBits;
+
+    std::unique_ptr<KeyString> _endPosition;
+};
+
+std::unique_ptr<SortedDataInterface::Cursor> MemoryMVCCIndex::newCursor(OperationContext* opCtx,
+                                                                        bool isForward) const {
+    return stdx::make_unique<Cursor>(*this, opCtx, isForward);
+}
+
+}  // namespace mongo
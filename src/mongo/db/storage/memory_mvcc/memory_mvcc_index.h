@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/db/storage/sorted_data_interface.h"
+
+namespace mongo {
+
+class MemoryMVCCTable;
+class MemoryMVCCTransaction;
+
+/**
+ * A SortedDataInterface backed by a MemoryMVCCTable. Every entry is stored under the KeyString of
+ * its key and RecordId, with the KeyString type bits as the value, so unique and standard indexes
+ * share one format.
+ */
+class MemoryMVCCIndex final : public SortedDataInterface {
+public:
+    MemoryMVCCIndex(const Ordering& ordering,
+                    bool isUnique,
+                    StringData ident,
+                    std::shared_ptr<void>* dataInOut);
+
+    SortedDataBuilderInterface* getBulkBuilder(OperationContext* opCtx, bool dupsAllowed) final;
+
+    Status insert(OperationContext* opCtx,
+                  const BSONObj& key,
+                  const RecordId& loc,
+                  bool dupsAllowed) final;
+
+    void unindex(OperationContext* opCtx,
+                 const BSONObj& key,
+                 const RecordId& loc,
+                 bool dupsAllowed) final;
+
+    Status dupKeyCheck(OperationContext* opCtx, const BSONObj& key, const RecordId& loc) final;
+
+    void fullValidate(OperationContext* opCtx,
+                      long long* numKeysOut,
+                      ValidateResults* fullResults) const final;
+
+    bool appendCustomStats(OperationContext* opCtx,
+                           BSONObjBuilder* output,
+                           double scale) const final;
+
+    long long getSpaceUsedBytes(OperationContext* opCtx) const final;
+
+    long long numEntries(OperationContext* opCtx) const final;
+
+    bool isEmpty(OperationContext* opCtx) final;
+
+    std::unique_ptr<SortedDataInterface::Cursor> newCursor(OperationContext* opCtx,
+                                                           bool isForward = true) const final;
+
+    Status initAsEmpty(OperationContext* opCtx) final;
+
+private:
+    class BulkBuilder;
+    class Cursor;
+
+    // This is the "persistent" data, shared by every index opened on the same ident.
+    struct Data {
+        Data();
+
+        const std::shared_ptr<MemoryMVCCTable> entries;
+
+        // Holds one key per indexed value of a unique index. Writers of a value touch its key so
+        // that two transactions inserting or removing the same value conflict with each other,
+        // even though their entries differ by RecordId.
+        const std::shared_ptr<MemoryMVCCTable> uniqueKeys;
+    };
+
+    /**
+     * Returns true if an entry for 'key' with a RecordId other than 'loc' is visible to 'txn'.
+     */
+    bool _isDup(const MemoryMVCCTransaction& txn, const KeyString& key, const RecordId& loc) const;
+
+    /**
+     * Writes, then deletes, the unique key for 'key' to force a write conflict with any
+     * concurrent writer of the same value.
+     */
+    void _lockUniqueKey(MemoryMVCCTransaction* txn, const KeyString& key);
+
+    Status _dupKeyError(const BSONObj& key) const;
+
+    const Ordering _ordering;
+    const KeyString::Version _keyStringVersion = KeyString::kLatestVersion;
+    const bool _isUnique;
+    const std::string _ident;
+
+    const std::shared_ptr<Data> _data;
+};
+
+}  // namespace mongo
@@ -0,0 +1,70 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_index.h"
+
+#include "mongo/base/init.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_recovery_unit.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+#include "mongo/db/storage/sorted_data_interface_test_harness.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class MemoryMVCCIndexHarnessHelper final : public virtual SortedDataInterfaceHarnessHelper {
+public:
+    MemoryMVCCIndexHarnessHelper() : _order(Ordering::make(BSONObj())) {}
+
+    std::unique_ptr<SortedDataInterface> newSortedDataInterface(bool unique) final {
+        return stdx::make_unique<MemoryMVCCIndex>(_order, unique, "ident", &_data);
+    }
+
+    std::unique_ptr<RecoveryUnit> newRecoveryUnit() final {
+        return stdx::make_unique<MemoryMVCCRecoveryUnit>(&_store, nullptr);
+    }
+
+private:
+    MemoryMVCCStore _store;
+    std::shared_ptr<void> _data;  // used by MemoryMVCCIndex
+    Ordering _order;
+};
+
+std::unique_ptr<HarnessHelper> makeHarnessHelper() {
+    return stdx::make_unique<MemoryMVCCIndexHarnessHelper>();
+}
+
+MONGO_INITIALIZER(RegisterHarnessFactory)(InitializerContext* const) {
+    mongo::registerHarnessHelperFactory(makeHarnessHelper);
+    return Status::OK();
+}
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_kv_engine.h"
+
+#include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_index.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_record_store.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_recovery_unit.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+
+RecoveryUnit* MemoryMVCCKVEngine::newRecoveryUnit() {
+    return new MemoryMVCCRecoveryUnit(&_store, &_snapshotManager, [this]() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        JournalListener::Token token = _journalListener->getToken();
+        _journalListener->onDurable(token);
+    });
+}
+
+Status MemoryMVCCKVEngine::createRecordStore(OperationContext* opCtx,
+                                             StringData ns,
+                                             StringData ident,
+                                             const CollectionOptions& options) {
+    // Register the ident in the `_dataMap` (for `getAllIdents`). Remainder of work done in
+    // `getRecordStore`.
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _dataMap[ident] = {};
+    return Status::OK();
+}
+
+std::unique_ptr<RecordStore> MemoryMVCCKVEngine::getRecordStore(OperationContext* opCtx,
+                                                                StringData ns,
+                                                                StringData ident,
+                                                                const CollectionOptions& options) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (options.capped) {
+        return stdx::make_unique<MemoryMVCCRecordStore>(
+            ns,
+            ident,
+            &_dataMap[ident],
+            true,
+            options.cappedSize ? options.cappedSize : 4096,
+            options.cappedMaxDocs ? options.cappedMaxDocs : -1);
+    } else {
+        return stdx::make_unique<MemoryMVCCRecordStore>(ns, ident, &_dataMap[ident]);
+    }
+}
+
+Status MemoryMVCCKVEngine::createSortedDataInterface(OperationContext* opCtx,
+                                                     StringData ident,
+                                                     const IndexDescriptor* desc) {
+    // Register the ident in `_dataMap` (for `getAllIdents`). Remainder of work done in
+    // `getSortedDataInterface`.
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _dataMap[ident] = {};
+    return Status::OK();
+}
+
+SortedDataInterface* MemoryMVCCKVEngine::getSortedDataInterface(OperationContext* opCtx,
+                                                                StringData ident,
+                                                                const IndexDescriptor* desc) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return new MemoryMVCCIndex(
+        Ordering::make(desc->keyPattern()), desc->unique(), ident, &_dataMap[ident]);
+}
+
+Status MemoryMVCCKVEngine::dropIdent(OperationContext* opCtx, StringData ident) {
+    // Record stores and indexes still open on the ident keep its data alive until they close.
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _dataMap.erase(ident);
+    return Status::OK();
+}
+
+int64_t MemoryMVCCKVEngine::getIdentSize(OperationContext* opCtx, StringData ident) {
+    return 1;
+}
+
+bool MemoryMVCCKVEngine::hasIdent(OperationContext* opCtx, StringData ident) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _dataMap.find(ident) != _dataMap.end();
+}
+
+std::vector<std::string> MemoryMVCCKVEngine::getAllIdents(OperationContext* opCtx) const {
+    std::vector<std::string> all;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (DataMap::const_iterator it = _dataMap.begin(); it != _dataMap.end(); ++it) {
+            all.push_back(it->first);
+        }
+    }
+    return all;
+}
+
+void MemoryMVCCKVEngine::setJournalListener(JournalListener* jl) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _journalListener = jl;
+}
+
+void MemoryMVCCKVEngine::setStableTimestamp(Timestamp stableTimestamp) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _stableTimestamp = stableTimestamp;
+}
+
+void MemoryMVCCKVEngine::setOldestTimestampFromStable() {
+    Timestamp stableTimestamp;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        stableTimestamp = _stableTimestamp;
+    }
+    setOldestTimestamp(stableTimestamp);
+}
+
+void MemoryMVCCKVEngine::setOldestTimestamp(Timestamp newOldestTimestamp) {
+    // Moving the oldest timestamp forward lets commits prune versions that timestamped readers
+    // could otherwise still ask for.
+    _store.setOldestTimestamp(newOldestTimestamp);
+}
+
+Timestamp MemoryMVCCKVEngine::getAllCommittedTimestamp() const {
+    return _store.getAllCommittedTimestamp();
+}
+
+}  // namespace mongo
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/storage/journal_listener.h"
+#include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_snapshot_manager.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class JournalListener;
+
+/**
+ * An in-memory KVEngine with multi-version concurrency control. Readers work on snapshots and
+ * never block writers, and writers only conflict when they modify the same key, so, unlike the
+ * ephemeralForTest engine, it supports document-level locking, timestamped reads and
+ * majority/snapshot read concerns.
+ */
+class MemoryMVCCKVEngine final : public KVEngine {
+public:
+    MemoryMVCCKVEngine() = default;
+
+    RecoveryUnit* newRecoveryUnit() final;
+
+    Status createRecordStore(OperationContext* opCtx,
+                             StringData ns,
+                             StringData ident,
+                             const CollectionOptions& options) final;
+
+    std::unique_ptr<RecordStore> getRecordStore(OperationContext* opCtx,
+                                                StringData ns,
+                                                StringData ident,
+                                                const CollectionOptions& options) final;
+
+    Status createSortedDataInterface(OperationContext* opCtx,
+                                     StringData ident,
+                                     const IndexDescriptor* desc) final;
+
+    SortedDataInterface* getSortedDataInterface(OperationContext* opCtx,
+                                                StringData ident,
+                                                const IndexDescriptor* desc) final;
+
+    Status dropIdent(OperationContext* opCtx, StringData ident) final;
+
+    bool supportsDocLocking() const final {
+        return true;
+    }
+
+    bool supportsDirectoryPerDB() const final {
+        return false;
+    }
+
+    /**
+     * Data stored in memory is not durable.
+     */
+    bool isDurable() const final {
+        return false;
+    }
+
+    bool isEphemeral() const final {
+        return true;
+    }
+
+    int64_t getIdentSize(OperationContext* opCtx, StringData ident) final;
+
+    Status repairIdent(OperationContext* opCtx, StringData ident) final {
+        return Status::OK();
+    }
+
+    void cleanShutdown() final {}
+
+    bool hasIdent(OperationContext* opCtx, StringData ident) const final;
+
+    std::vector<std::string> getAllIdents(OperationContext* opCtx) const final;
+
+    SnapshotManager* getSnapshotManager() const final {
+        return &_snapshotManager;
+    }
+
+    void setJournalListener(JournalListener* jl) final;
+
+    void setStableTimestamp(Timestamp stableTimestamp) final;
+
+    void setOldestTimestampFromStable() final;
+
+    void setOldestTimestamp(Timestamp newOldestTimestamp) final;
+
+    Timestamp getAllCommittedTimestamp() const final;
+
+    bool supportsReadConcernSnapshot() const final {
+        return true;
+    }
+
+private:
+    typedef StringMap<std::shared_ptr<void>> DataMap;
+
+    MemoryMVCCStore _store;
+    mutable MemoryMVCCSnapshotManager _snapshotManager;
+
+    mutable stdx::mutex _mutex;
+    DataMap _dataMap;  // All actual data is owned in here
+    Timestamp _stableTimestamp;
+
+    // Notified when we write as everything is considered "journalled" since repl depends on it.
+    JournalListener* _journalListener = &NoOpJournalListener::instance;
+};
+
+}  // namespace mongo
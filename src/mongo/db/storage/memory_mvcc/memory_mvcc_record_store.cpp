@@ -0,0 +1,638 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_record_store.h"
+
+#include <cstring>
+
+#include "mongo/bson/mutable/damage_vector.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_recovery_unit.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+#include "mongo/db/storage/oplog_hack.h"
+#include "mongo/platform/endian.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Encodes 'id' so that the byte-wise order of keys matches the order of RecordIds.
+ */
+std::string makeKey(const RecordId& id) {
+    const uint64_t biased = static_cast<uint64_t>(id.repr()) ^ (1ULL << 63);
+    const uint64_t bigEndian = endian::nativeToBig(biased);
+    return std::string(reinterpret_cast<const char*>(&bigEndian), sizeof(bigEndian));
+}
+
+RecordId extractRecordId(StringData key) {
+    invariant(key.size() == sizeof(uint64_t));
+    uint64_t bigEndian;
+    std::memcpy(&bigEndian, key.rawData(), sizeof(bigEndian));
+    return RecordId(static_cast<int64_t>(endian::bigToNative(bigEndian) ^ (1ULL << 63)));
+}
+
+MemoryMVCCTransaction* getTransaction(OperationContext* opCtx) {
+    return MemoryMVCCRecoveryUnit::get(opCtx)->getTransaction();
+}
+
+RecordData toRecordData(const MemoryMVCCTable::Entry& entry) {
+    return RecordData(entry.value, entry.size);
+}
+
+}  // namespace
+
+class MemoryMVCCRecordStore::CappedInsertChange : public RecoveryUnit::Change {
+public:
+    CappedInsertChange(std::shared_ptr<Data> data, RecordId loc)
+        : _data(std::move(data)), _loc(loc) {}
+
+    void commit(boost::optional<Timestamp>) final {
+        _remove();
+    }
+
+    void rollback() final {
+        _remove();
+    }
+
+private:
+    void _remove() {
+        stdx::lock_guard<stdx::mutex> lk(_data->uncommittedMutex);
+        _data->uncommittedRecords.erase(_loc);
+        _data->uncommittedRecordsChanged.notify_all();
+    }
+
+    const std::shared_ptr<Data> _data;
+    const RecordId _loc;
+};
+
+/**
+ * Cursors remember the key of their current position rather than an iterator, and look up the
+ * next visible key on every call to next(). This keeps them valid across concurrent writes
+ * without any invalidation machinery.
+ */
+class MemoryMVCCRecordStore::Cursor final : public SeekableRecordCursor {
+public:
+    Cursor(OperationContext* opCtx, const MemoryMVCCRecordStore& rs, bool forward)
+        : _opCtx(opCtx), _rs(rs), _forward(forward) {
+        _updateCappedVisibility();
+    }
+
+    boost::optional<Record> next() final {
+        if (_eof)
+            return {};
+
+        auto txn = getTransaction(_opCtx);
+        auto entry = _rs._data->records->seek(
+            *txn, _needFirstSeek ? StringData() : StringData(_key), _forward, false);
+        if (!entry) {
+            _eof = true;
+            return {};
+        }
+
+        const RecordId id = extractRecordId(entry->key);
+        if (_hideFrom && id >= *_hideFrom && !entry->isOwnWrite) {
+            // Stop in front of an uncommitted capped insert. The position is kept so that a
+            // tailing reader picks up from here once the hole has been filled.
+            return {};
+        }
+
+        _needFirstSeek = false;
+        _key = std::move(entry->key);
+        return {{id, toRecordData(*entry)}};
+    }
+
+    boost::optional<Record> seekExact(const RecordId& id) final {
+        _needFirstSeek = false;
+        _key = makeKey(id);
+
+        auto entry = _rs._data->records->find(*getTransaction(_opCtx), _key);
+        if (!entry) {
+            _eof = true;
+            return {};
+        }
+        _eof = false;
+        return {{id, toRecordData(*entry)}};
+    }
+
+    void save() final {}
+
+    void saveUnpositioned() final {
+        _eof = true;
+    }
+
+    bool restore() final {
+        if (_eof || _needFirstSeek)
+            return true;
+
+        _updateCappedVisibility();
+
+        // Capped iterators die on invalidation rather than advancing.
+        if (_rs._isCapped && !_rs._data->records->find(*getTransaction(_opCtx), _key)) {
+            return false;
+        }
+        return true;
+    }
+
+    void detachFromOperationContext() final {
+        _opCtx = nullptr;
+    }
+
+    void reattachToOperationContext(OperationContext* opCtx) final {
+        _opCtx = opCtx;
+    }
+
+private:
+    void _updateCappedVisibility() {
+        if (!_rs._isCapped || !_forward)
+            return;
+
+        // Compute the hidden range before opening the snapshot, so that every insert the snapshot
+        // cannot see is either below the range or part of it.
+        auto ru = MemoryMVCCRecoveryUnit::get(_opCtx);
+        const uint64_t txnId = ru->inActiveTxn() ? ru->getTransaction()->id() : 0;
+        _hideFrom = _rs._lowestUncommittedRecord(txnId);
+        ru->getTransaction();
+    }
+
+    OperationContext* _opCtx;
+    const MemoryMVCCRecordStore& _rs;
+    const bool _forward;
+
+    bool _needFirstSeek = true;
+    bool _eof = false;
+    std::string _key;  // Key of the current position.
+    boost::optional<RecordId> _hideFrom;
+};
+
+MemoryMVCCRecordStore::Data::Data(bool isOplog)
+    : isOplog(isOplog), records(std::make_shared<MemoryMVCCTable>()) {}
+
+MemoryMVCCRecordStore::MemoryMVCCRecordStore(StringData ns,
+                                             StringData ident,
+                                             std::shared_ptr<void>* dataInOut,
+                                             bool isCapped,
+                                             int64_t cappedMaxSize,
+                                             int64_t cappedMaxDocs,
+                                             CappedCallback* cappedCallback)
+    : RecordStore(ns),
+      _ident(ident.toString()),
+      _isCapped(isCapped),
+      _cappedMaxSize(cappedMaxSize),
+      _cappedMaxDocs(cappedMaxDocs),
+      _cappedCallback(cappedCallback),
+      _data([&] {
+          if (!*dataInOut) {
+              *dataInOut = std::make_shared<Data>(NamespaceString::oplog(ns));
+          }
+          // Share ownership with every other RecordStore opened on this ident.
+          return std::shared_ptr<Data>(*dataInOut, static_cast<Data*>(dataInOut->get()));
+      }()) {
+    if (_isCapped) {
+        invariant(_cappedMaxSize > 0);
+        invariant(_cappedMaxDocs == -1 || _cappedMaxDocs > 0);
+    } else {
+        invariant(_cappedMaxSize == -1);
+        invariant(_cappedMaxDocs == -1);
+    }
+}
+
+const char* MemoryMVCCRecordStore::name() const {
+    return "memoryMVCC";
+}
+
+RecordData MemoryMVCCRecordStore::dataFor(OperationContext* opCtx, const RecordId& loc) const {
+    RecordData rd;
+    if (!findRecord(opCtx, loc, &rd)) {
+        severe() << "memoryMVCC could not find record " << loc << " in " << ns();
+        invariant(false);
+    }
+    return rd;
+}
+
+bool MemoryMVCCRecordStore::findRecord(OperationContext* opCtx,
+                                       const RecordId& loc,
+                                       RecordData* rd) const {
+    auto entry = _data->records->find(*getTransaction(opCtx), makeKey(loc));
+    if (!entry)
+        return false;
+    *rd = toRecordData(*entry);
+    return true;
+}
+
+void MemoryMVCCRecordStore::deleteRecord(OperationContext* opCtx, const RecordId& dl) {
+    auto txn = getTransaction(opCtx);
+    const std::string key = makeKey(dl);
+
+    auto entry = _data->records->find(*txn, key);
+    invariant(entry);
+    invariant(_data->records->remove(txn, key));
+
+    _changeNumRecords(opCtx, -1);
+    _increaseDataSize(opCtx, -static_cast<int64_t>(entry->size));
+}
+
+bool MemoryMVCCRecordStore::_cappedAndNeedDelete() const {
+    if (!_isCapped)
+        return false;
+
+    if (_data->dataSize.load() > _cappedMaxSize)
+        return true;
+
+    if ((_cappedMaxDocs != -1) && (_data->numRecords.load() > _cappedMaxDocs))
+        return true;
+
+    return false;
+}
+
+void MemoryMVCCRecordStore::_cappedDeleteAsNeeded(OperationContext* opCtx,
+                                                  const RecordId& justInserted) {
+    if (!_cappedAndNeedDelete())
+        return;
+
+    // Ensure only one thread at a time deletes, otherwise they would conflict on the same oldest
+    // records. The maximum number of documents has to be exact, so wait for the other deleter in
+    // that case. Otherwise let it catch up.
+    stdx::unique_lock<stdx::mutex> lock(_data->cappedDeleterMutex, stdx::defer_lock);
+    if (_cappedMaxDocs != -1) {
+        lock.lock();
+    } else if (!lock.try_lock()) {
+        return;
+    }
+
+    // Delete in a side transaction, so that inserters do not conflict with each other over the
+    // removal of the oldest records and a conflict does not abort the insert.
+    auto realRecoveryUnit = checked_cast<MemoryMVCCRecoveryUnit*>(opCtx->releaseRecoveryUnit());
+    invariant(realRecoveryUnit);
+    const auto realRUstate = opCtx->setRecoveryUnit(
+        new MemoryMVCCRecoveryUnit(realRecoveryUnit->getStore(),
+                                   realRecoveryUnit->getSnapshotManager()),
+        WriteUnitOfWork::RecoveryUnitState::kNotInUnitOfWork);
+    ON_BLOCK_EXIT([&] {
+        delete opCtx->releaseRecoveryUnit();
+        opCtx->setRecoveryUnit(realRecoveryUnit, realRUstate);
+    });
+
+    try {
+        WriteUnitOfWork wuow(opCtx);
+
+        auto txn = getTransaction(opCtx);
+        auto entry = _data->records->seek(*txn, StringData(), true, false);
+        while (entry && _cappedAndNeedDelete()) {
+            // Don't go past the record just inserted.
+            const RecordId id = extractRecordId(entry->key);
+            if (id >= justInserted)
+                break;
+
+            if (_cappedCallback) {
+                uassertStatusOK(
+                    _cappedCallback->aboutToDeleteCapped(opCtx, id, toRecordData(*entry)));
+            }
+
+            invariant(_data->records->remove(txn, entry->key));
+            _changeNumRecords(opCtx, -1);
+            _increaseDataSize(opCtx, -static_cast<int64_t>(entry->size));
+
+            entry = _data->records->seek(*txn, entry->key, true, false);
+        }
+
+        wuow.commit();
+    } catch (const WriteConflictException&) {
+        LOG(1) << "Got conflict deleting from capped collection " << _ident << ", ignoring";
+    }
+}
+
+RecordId MemoryMVCCRecordStore::_nextId() {
+    RecordId out = RecordId(_data->nextId.fetchAndAdd(1));
+    invariant(out < RecordId::max());
+    return out;
+}
+
+StatusWith<RecordId> MemoryMVCCRecordStore::_insertRecord(OperationContext* opCtx,
+                                                          const char* data,
+                                                          int len,
+                                                          Timestamp timestamp) {
+    if (_isCapped && len > _cappedMaxSize) {
+        // We use dataSize for capped rollover and we don't want to delete everything if we know
+        // this won't fit.
+        return Status(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+    }
+
+    RecordId loc;
+    if (_data->isOplog) {
+        StatusWith<RecordId> status = oploghack::extractKey(data, len);
+        if (!status.isOK())
+            return status;
+        loc = status.getValue();
+    } else {
+        loc = _nextId();
+    }
+
+    auto ru = MemoryMVCCRecoveryUnit::get(opCtx);
+    if (!timestamp.isNull()) {
+        fassert(50867, ru->setTimestamp(timestamp));
+    }
+
+    auto txn = ru->getTransaction();
+    _data->records->put(txn, makeKey(loc), data, len);
+
+    if (_isCapped) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_data->uncommittedMutex);
+            _data->uncommittedRecords.emplace(loc, txn->id());
+        }
+        ru->registerChange(new CappedInsertChange(_data, loc));
+    }
+
+    _changeNumRecords(opCtx, 1);
+    _increaseDataSize(opCtx, len);
+
+    _cappedDeleteAsNeeded(opCtx, loc);
+    return loc;
+}
+
+StatusWith<RecordId> MemoryMVCCRecordStore::insertRecord(
+    OperationContext* opCtx, const char* data, int len, Timestamp timestamp, bool enforceQuota) {
+    return _insertRecord(opCtx, data, len, timestamp);
+}
+
+Status MemoryMVCCRecordStore::insertRecordsWithDocWriter(OperationContext* opCtx,
+                                                         const DocWriter* const* docs,
+                                                         const Timestamp* timestamps,
+                                                         size_t nDocs,
+                                                         RecordId* idsOut) {
+    std::unique_ptr<Record[]> records(new Record[nDocs]);
+
+    size_t totalSize = 0;
+    for (size_t i = 0; i < nDocs; i++) {
+        const size_t docSize = docs[i]->documentSize();
+        records[i].data = RecordData(nullptr, docSize);  // We fill in the real ptr in next loop.
+        totalSize += docSize;
+    }
+
+    std::unique_ptr<char[]> buffer(new char[totalSize]);
+    char* pos = buffer.get();
+    for (size_t i = 0; i < nDocs; i++) {
+        docs[i]->writeDocument(pos);
+        const size_t size = records[i].data.size();
+        records[i].data = RecordData(pos, size);
+        pos += size;
+    }
+    invariant(pos == (buffer.get() + totalSize));
+
+    for (size_t i = 0; i < nDocs; i++) {
+        auto res = _insertRecord(
+            opCtx, records[i].data.data(), records[i].data.size(), timestamps[i]);
+        if (!res.isOK())
+            return res.getStatus();
+        if (idsOut)
+            idsOut[i] = res.getValue();
+    }
+
+    return Status::OK();
+}
+
+Status MemoryMVCCRecordStore::updateRecord(OperationContext* opCtx,
+                                           const RecordId& loc,
+                                           const char* data,
+                                           int len,
+                                           bool enforceQuota,
+                                           UpdateNotifier* notifier) {
+    auto txn = getTransaction(opCtx);
+    const std::string key = makeKey(loc);
+
+    auto oldEntry = _data->records->find(*txn, key);
+    invariant(oldEntry);
+    const int oldLen = oldEntry->size;
+
+    // Documents in capped collections cannot change size. We check that above the storage layer.
+    invariant(!_isCapped || len == oldLen);
+
+    // This engine supports document-level locking, so there are no in-place update notifications
+    // to deliver.
+    _data->records->put(txn, key, data, len);
+    _increaseDataSize(opCtx, len - oldLen);
+
+    _cappedDeleteAsNeeded(opCtx, loc);
+    return Status::OK();
+}
+
+bool MemoryMVCCRecordStore::updateWithDamagesSupported() const {
+    return true;
+}
+
+StatusWith<RecordData> MemoryMVCCRecordStore::updateWithDamages(
+    OperationContext* opCtx,
+    const RecordId& loc,
+    const RecordData& oldRec,
+    const char* damageSource,
+    const mutablebson::DamageVector& damages) {
+    auto txn = getTransaction(opCtx);
+    const std::string key = makeKey(loc);
+
+    auto oldEntry = _data->records->find(*txn, key);
+    invariant(oldEntry);
+
+    // Versions are immutable once installed, so apply the damages to a copy.
+    const size_t size = oldEntry->size;
+    auto newData = SharedBuffer::allocate(size);
+    std::memcpy(newData.get(), oldEntry->value.get(), size);
+    for (const auto& event : damages) {
+        invariant(event.targetOffset + event.size <= size);
+        std::memcpy(
+            newData.get() + event.targetOffset, damageSource + event.sourceOffset, event.size);
+    }
+
+    _data->records->put(txn, key, newData.get(), size);
+    return RecordData(std::move(newData), size);
+}
+
+std::unique_ptr<SeekableRecordCursor> MemoryMVCCRecordStore::getCursor(OperationContext* opCtx,
+                                                                       bool forward) const {
+    return stdx::make_unique<Cursor>(opCtx, *this, forward);
+}
+
+Status MemoryMVCCRecordStore::truncate(OperationContext* opCtx) {
+    auto txn = getTransaction(opCtx);
+
+    int64_t numRecordsRemoved = 0;
+    int64_t dataSizeRemoved = 0;
+    auto entry = _data->records->seek(*txn, StringData(), true, false);
+    while (entry) {
+        invariant(_data->records->remove(txn, entry->key));
+        numRecordsRemoved++;
+        dataSizeRemoved += entry->size;
+        entry = _data->records->seek(*txn, entry->key, true, false);
+    }
+
+    _changeNumRecords(opCtx, -numRecordsRemoved);
+    _increaseDataSize(opCtx, -dataSizeRemoved);
+    return Status::OK();
+}
+
+void MemoryMVCCRecordStore::cappedTruncateAfter(OperationContext* opCtx,
+                                                RecordId end,
+                                                bool inclusive) {
+    auto txn = getTransaction(opCtx);
+
+    auto entry = _data->records->seek(*txn, makeKey(end), true, inclusive);
+    while (entry) {
+        const RecordId id = extractRecordId(entry->key);
+        if (_cappedCallback) {
+            uassertStatusOK(_cappedCallback->aboutToDeleteCapped(opCtx, id, toRecordData(*entry)));
+        }
+
+        invariant(_data->records->remove(txn, entry->key));
+        _changeNumRecords(opCtx, -1);
+        _increaseDataSize(opCtx, -static_cast<int64_t>(entry->size));
+
+        entry = _data->records->seek(*txn, entry->key, true, false);
+    }
+}
+
+Status MemoryMVCCRecordStore::validate(OperationContext* opCtx,
+                                       ValidateCmdLevel level,
+                                       ValidateAdaptor* adaptor,
+                                       ValidateResults* results,
+                                       BSONObjBuilder* output) {
+    results->valid = true;
+
+    auto txn = getTransaction(opCtx);
+    long long nrecords = 0;
+    auto entry = _data->records->seek(*txn, StringData(), true, false);
+    while (entry) {
+        const RecordId id = extractRecordId(entry->key);
+        size_t dataSize;
+        const Status status = adaptor->validate(id, toRecordData(*entry), &dataSize);
+        if (!status.isOK()) {
+            if (results->valid) {
+                // Only log once.
+                results->errors.push_back("detected one or more invalid documents (see logs)");
+            }
+            results->valid = false;
+            log() << "Invalid object detected in " << _ns << ": " << status.reason();
+        }
+        nrecords++;
+        entry = _data->records->seek(*txn, entry->key, true, false);
+    }
+
+    output->appendNumber("nrecords", nrecords);
+
+    return Status::OK();
+}
+
+void MemoryMVCCRecordStore::appendCustomStats(OperationContext* opCtx,
+                                              BSONObjBuilder* result,
+                                              double scale) const {
+    result->appendBool("capped", _isCapped);
+    if (_isCapped) {
+        result->appendIntOrLL("max", _cappedMaxDocs);
+        result->appendIntOrLL("maxSize", _cappedMaxSize / scale);
+    }
+}
+
+Status MemoryMVCCRecordStore::touch(OperationContext* opCtx, BSONObjBuilder* output) const {
+    if (output) {
+        output->append("numRanges", 1);
+        output->append("millis", 0);
+    }
+    return Status::OK();
+}
+
+int64_t MemoryMVCCRecordStore::storageSize(OperationContext* opCtx,
+                                           BSONObjBuilder* extraInfo,
+                                           int infoLevel) const {
+    // Note: not making use of extraInfo or infoLevel since we don't have extents
+    return dataSize(opCtx);
+}
+
+boost::optional<RecordId> MemoryMVCCRecordStore::oplogStartHack(
+    OperationContext* opCtx, const RecordId& startingPosition) const {
+    if (!_data->isOplog)
+        return boost::none;
+
+    // Returns RecordId() if the startingPosition is before the oldest oplog entry, as specified
+    // in record_store.h.
+    auto entry =
+        _data->records->seek(*getTransaction(opCtx), makeKey(startingPosition), false, true);
+    return entry ? extractRecordId(entry->key) : RecordId();
+}
+
+boost::optional<RecordId> MemoryMVCCRecordStore::_lowestUncommittedRecord(uint64_t txnId) const {
+    stdx::lock_guard<stdx::mutex> lk(_data->uncommittedMutex);
+    for (auto&& uncommitted : _data->uncommittedRecords) {
+        if (uncommitted.second != txnId)
+            return uncommitted.first;
+    }
+    return boost::none;
+}
+
+void MemoryMVCCRecordStore::waitForAllEarlierOplogWritesToBeVisible(
+    OperationContext* opCtx) const {
+    invariant(!MemoryMVCCRecoveryUnit::get(opCtx)->inUnitOfWork());
+
+    stdx::unique_lock<stdx::mutex> lk(_data->uncommittedMutex);
+    if (_data->uncommittedRecords.empty())
+        return;
+
+    const RecordId waitFor = _data->uncommittedRecords.rbegin()->first;
+    opCtx->waitForConditionOrInterrupt(_data->uncommittedRecordsChanged, lk, [&] {
+        return _data->uncommittedRecords.empty() ||
+            _data->uncommittedRecords.begin()->first > waitFor;
+    });
+}
+
+void MemoryMVCCRecordStore::updateStatsAfterRepair(OperationContext* opCtx,
+                                                   long long numRecords,
+                                                   long long dataSize) {
+    _data->numRecords.store(numRecords);
+    _data->dataSize.store(dataSize);
+}
+
+void MemoryMVCCRecordStore::_changeNumRecords(OperationContext* opCtx, int64_t diff) {
+    _data->numRecords.fetchAndAdd(diff);
+    opCtx->recoveryUnit()->onRollback(
+        [ data = _data, diff ]() { data->numRecords.fetchAndSubtract(diff); });
+}
+
+void MemoryMVCCRecordStore::_increaseDataSize(OperationContext* opCtx, int64_t amount) {
+    _data->dataSize.fetchAndAdd(amount);
+    opCtx->recoveryUnit()->onRollback(
+        [ data = _data, amount ]() { data->dataSize.fetchAndSubtract(amount); });
+}
+
+}  // namespace mongo
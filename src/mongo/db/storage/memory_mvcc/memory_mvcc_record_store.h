@@ -0,0 +1,206 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include "mongo/db/storage/capped_callback.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class MemoryMVCCTable;
+
+/**
+ * A RecordStore backed by a MemoryMVCCTable, keyed by RecordId.
+ *
+ * Unlike the ephemeralForTest record store, writers do not serialize on a per-collection mutex:
+ * each operation reads from its own snapshot and concurrent writers only conflict when they touch
+ * the same record. Capped collections hide records behind uncommitted inserts from forward
+ * cursors so that tailing readers never skip a hole that is filled in later.
+ *
+ * @param cappedMaxSize - required if isCapped. limit uses dataSize() in this impl.
+ */
+class MemoryMVCCRecordStore final : public RecordStore {
+public:
+    MemoryMVCCRecordStore(StringData ns,
+                          StringData ident,
+                          std::shared_ptr<void>* dataInOut,
+                          bool isCapped = false,
+                          int64_t cappedMaxSize = -1,
+                          int64_t cappedMaxDocs = -1,
+                          CappedCallback* cappedCallback = nullptr);
+
+    const char* name() const final;
+
+    const std::string& getIdent() const final {
+        return _ident;
+    }
+
+    RecordData dataFor(OperationContext* opCtx, const RecordId& loc) const final;
+
+    bool findRecord(OperationContext* opCtx, const RecordId& loc, RecordData* rd) const final;
+
+    void deleteRecord(OperationContext* opCtx, const RecordId& dl) final;
+
+    StatusWith<RecordId> insertRecord(OperationContext* opCtx,
+                                      const char* data,
+                                      int len,
+                                      Timestamp timestamp,
+                                      bool enforceQuota) final;
+
+    Status insertRecordsWithDocWriter(OperationContext* opCtx,
+                                      const DocWriter* const* docs,
+                                      const Timestamp* timestamps,
+                                      size_t nDocs,
+                                      RecordId* idsOut) final;
+
+    Status updateRecord(OperationContext* opCtx,
+                        const RecordId& oldLocation,
+                        const char* data,
+                        int len,
+                        bool enforceQuota,
+                        UpdateNotifier* notifier) final;
+
+    bool updateWithDamagesSupported() const final;
+
+    StatusWith<RecordData> updateWithDamages(OperationContext* opCtx,
+                                             const RecordId& loc,
+                                             const RecordData& oldRec,
+                                             const char* damageSource,
+                                             const mutablebson::DamageVector& damages) final;
+
+    std::unique_ptr<SeekableRecordCursor> getCursor(OperationContext* opCtx,
+                                                    bool forward) const final;
+
+    Status truncate(OperationContext* opCtx) final;
+
+    void cappedTruncateAfter(OperationContext* opCtx, RecordId end, bool inclusive) final;
+
+    Status validate(OperationContext* opCtx,
+                    ValidateCmdLevel level,
+                    ValidateAdaptor* adaptor,
+                    ValidateResults* results,
+                    BSONObjBuilder* output) final;
+
+    void appendCustomStats(OperationContext* opCtx,
+                           BSONObjBuilder* result,
+                           double scale) const final;
+
+    Status touch(OperationContext* opCtx, BSONObjBuilder* output) const final;
+
+    int64_t storageSize(OperationContext* opCtx,
+                        BSONObjBuilder* extraInfo = NULL,
+                        int infoLevel = 0) const final;
+
+    long long dataSize(OperationContext* opCtx) const final {
+        return _data->dataSize.load();
+    }
+
+    long long numRecords(OperationContext* opCtx) const final {
+        return _data->numRecords.load();
+    }
+
+    boost::optional<RecordId> oplogStartHack(OperationContext* opCtx,
+                                             const RecordId& startingPosition) const final;
+
+    void waitForAllEarlierOplogWritesToBeVisible(OperationContext* opCtx) const final;
+
+    void updateStatsAfterRepair(OperationContext* opCtx,
+                                long long numRecords,
+                                long long dataSize) final;
+
+    //
+    // Not in RecordStore interface
+    //
+
+    bool isCapped() const {
+        return _isCapped;
+    }
+
+    void setCappedCallback(CappedCallback* cb) {
+        _cappedCallback = cb;
+    }
+
+private:
+    class Cursor;
+    class CappedInsertChange;
+
+    // This is the "persistent" data, shared by every RecordStore opened on the same ident.
+    struct Data {
+        explicit Data(bool isOplog);
+
+        const bool isOplog;
+        const std::shared_ptr<MemoryMVCCTable> records;
+
+        AtomicInt64 nextId{1};
+        AtomicInt64 numRecords{0};
+        AtomicInt64 dataSize{0};
+
+        // Serializes capped deletions, which run in a transaction of their own, so that concurrent
+        // inserters do not all try to delete the same oldest records.
+        stdx::mutex cappedDeleterMutex;
+
+        // Capped inserts that are not yet committed or rolled back, mapped to the id of the
+        // inserting transaction. Forward cursors stop before the lowest of these.
+        mutable stdx::mutex uncommittedMutex;  // Guards uncommittedRecords.
+        mutable stdx::condition_variable uncommittedRecordsChanged;
+        std::map<RecordId, uint64_t> uncommittedRecords;
+    };
+
+    /**
+     * Returns the lowest RecordId inserted by a capped insert that is not yet committed, ignoring
+     * inserts made by the transaction 'txnId'.
+     */
+    boost::optional<RecordId> _lowestUncommittedRecord(uint64_t txnId) const;
+
+    RecordId _nextId();
+    StatusWith<RecordId> _insertRecord(OperationContext* opCtx,
+                                       const char* data,
+                                       int len,
+                                       Timestamp timestamp);
+    void _changeNumRecords(OperationContext* opCtx, int64_t diff);
+    void _increaseDataSize(OperationContext* opCtx, int64_t amount);
+    bool _cappedAndNeedDelete() const;
+    void _cappedDeleteAsNeeded(OperationContext* opCtx, const RecordId& justInserted);
+
+    const std::string _ident;
+    const bool _isCapped;
+    const int64_t _cappedMaxSize;
+    const int64_t _cappedMaxDocs;
+    CappedCallback* _cappedCallback;
+
+    const std::shared_ptr<Data> _data;
+};
+
+}  // namespace mongo
@@ -0,0 +1,133 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_record_store.h"
+
+#include "mongo/base/init.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_recovery_unit.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+#include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class MemoryMVCCRecordStoreHarnessHelper final : public RecordStoreHarnessHelper {
+public:
+    MemoryMVCCRecordStoreHarnessHelper() {}
+
+    std::unique_ptr<RecordStore> newNonCappedRecordStore() final {
+        return newNonCappedRecordStore("a.b");
+    }
+
+    std::unique_ptr<RecordStore> newNonCappedRecordStore(const std::string& ns) final {
+        return stdx::make_unique<MemoryMVCCRecordStore>(ns, "ident", &data);
+    }
+
+    std::unique_ptr<RecordStore> newCappedRecordStore(int64_t cappedSizeBytes,
+                                                      int64_t cappedMaxDocs) final {
+        return newCappedRecordStore("a.b", cappedSizeBytes, cappedMaxDocs);
+    }
+
+    std::unique_ptr<RecordStore> newCappedRecordStore(const std::string& ns,
+                                                      int64_t cappedSizeBytes,
+                                                      int64_t cappedMaxDocs) final {
+        return stdx::make_unique<MemoryMVCCRecordStore>(
+            ns, "ident", &data, true, cappedSizeBytes, cappedMaxDocs);
+    }
+
+    std::unique_ptr<RecoveryUnit> newRecoveryUnit() final {
+        return stdx::make_unique<MemoryMVCCRecoveryUnit>(&store, nullptr);
+    }
+
+    bool supportsDocLocking() final {
+        return true;
+    }
+
+    MemoryMVCCStore store;
+    std::shared_ptr<void> data;
+};
+
+std::unique_ptr<HarnessHelper> makeHarnessHelper() {
+    return stdx::make_unique<MemoryMVCCRecordStoreHarnessHelper>();
+}
+
+MONGO_INITIALIZER(RegisterHarnessFactory)(InitializerContext* const) {
+    mongo::registerHarnessHelperFactory(makeHarnessHelper);
+    return Status::OK();
+}
+
+RecordId doInsert(OperationContext* opCtx, RecordStore* rs) {
+    static char zeros[16];
+    return uassertStatusOK(rs->insertRecord(opCtx, zeros, sizeof(zeros), Timestamp(), false));
+}
+
+// Capped deletes run in a transaction of their own, so two inserters which both push the
+// collection over its cap do not conflict over removing the oldest records.
+TEST(MemoryMVCCRecordStoreTest, ConcurrentCappedInsertsDoNotConflict) {
+    MemoryMVCCRecordStoreHarnessHelper harness;
+    auto rs = harness.newCappedRecordStore(3 * 16, -1);
+
+    std::vector<RecordId> ids;
+    {
+        auto opCtx = harness.newOperationContext();
+        WriteUnitOfWork wuow(opCtx.get());
+        for (int i = 0; i < 3; ++i) {
+            ids.push_back(doInsert(opCtx.get(), rs.get()));
+        }
+        wuow.commit();
+    }
+
+    auto clientA = harness.serviceContext()->makeClient("inserterA");
+    auto opCtxA = harness.newOperationContext(clientA.get());
+    auto clientB = harness.serviceContext()->makeClient("inserterB");
+    auto opCtxB = harness.newOperationContext(clientB.get());
+
+    WriteUnitOfWork wuowA(opCtxA.get());
+    WriteUnitOfWork wuowB(opCtxB.get());
+    ids.push_back(doInsert(opCtxA.get(), rs.get()));
+    ids.push_back(doInsert(opCtxB.get(), rs.get()));
+    wuowA.commit();
+    wuowB.commit();
+
+    auto opCtx = harness.newOperationContext();
+    ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+    ASSERT_EQ(3 * 16, rs->dataSize(opCtx.get()));
+
+    RecordData rd;
+    ASSERT_FALSE(rs->findRecord(opCtx.get(), ids[0], &rd));
+    ASSERT_FALSE(rs->findRecord(opCtx.get(), ids[1], &rd));
+    for (size_t i = 2; i < ids.size(); ++i) {
+        ASSERT_TRUE(rs->findRecord(opCtx.get(), ids[i], &rd));
+    }
+}
+}  // namespace
+}  // namespace mongo
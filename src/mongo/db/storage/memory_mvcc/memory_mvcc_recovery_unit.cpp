@@ -0,0 +1,334 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_recovery_unit.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_snapshot_manager.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+// Always notice the oldest snapshot id, even across recovery units.
+AtomicUInt64 nextSnapshotId{1};
+
+}  // namespace
+
+MemoryMVCCRecoveryUnit::MemoryMVCCRecoveryUnit(MemoryMVCCStore* store,
+                                               MemoryMVCCSnapshotManager* snapshotManager,
+                                               stdx::function<void()> waitUntilDurableCallback)
+    : _store(store),
+      _snapshotManager(snapshotManager),
+      _waitUntilDurableCallback(std::move(waitUntilDurableCallback)),
+      _mySnapshotId(nextSnapshotId.fetchAndAdd(1)) {}
+
+MemoryMVCCRecoveryUnit::~MemoryMVCCRecoveryUnit() {
+    invariant(!_inUnitOfWork);
+    _abort();
+}
+
+void MemoryMVCCRecoveryUnit::beginUnitOfWork(OperationContext* opCtx) {
+    invariant(!_inUnitOfWork);
+    _inUnitOfWork = true;
+}
+
+void MemoryMVCCRecoveryUnit::commitUnitOfWork() {
+    invariant(_inUnitOfWork);
+    _inUnitOfWork = false;
+    _commit();
+}
+
+void MemoryMVCCRecoveryUnit::abortUnitOfWork() {
+    invariant(_inUnitOfWork);
+    _inUnitOfWork = false;
+    _abort();
+}
+
+void MemoryMVCCRecoveryUnit::_commit() {
+    // Since we cannot have both a _lastTimestampSet and a _commitTimestamp, the commit time is
+    // whichever is non-empty.
+    auto commitTime = _commitTimestamp.isNull() ? _lastTimestampSet : _commitTimestamp;
+
+    try {
+        if (_txn) {
+            _txnClose(true);
+        }
+
+        for (auto& change : _changes) {
+            change->commit(commitTime);
+        }
+        _changes.clear();
+    } catch (...) {
+        std::terminate();
+    }
+}
+
+void MemoryMVCCRecoveryUnit::_abort() {
+    try {
+        if (_txn) {
+            _txnClose(false);
+        }
+
+        for (auto it = _changes.rbegin(), end = _changes.rend(); it != end; ++it) {
+            Change* change = it->get();
+            LOG(2) << "CUSTOM ROLLBACK " << redact(demangleName(typeid(*change)));
+            change->rollback();
+        }
+        _changes.clear();
+    } catch (...) {
+        std::terminate();
+    }
+}
+
+bool MemoryMVCCRecoveryUnit::waitUntilDurable() {
+    invariant(!_inUnitOfWork);
+    if (_waitUntilDurableCallback) {
+        _waitUntilDurableCallback();
+    }
+    return true;
+}
+
+void MemoryMVCCRecoveryUnit::abandonSnapshot() {
+    invariant(!_inUnitOfWork);
+    if (_txn) {
+        // Can't be in a WriteUnitOfWork, so safe to rollback.
+        _txnClose(false);
+    }
+}
+
+void MemoryMVCCRecoveryUnit::preallocateSnapshot() {
+    getTransaction();
+}
+
+MemoryMVCCTransaction* MemoryMVCCRecoveryUnit::getTransaction() {
+    if (!_txn) {
+        _txnOpen();
+    }
+    return _txn.get();
+}
+
+void MemoryMVCCRecoveryUnit::_txnOpen() {
+    invariant(!_txn);
+
+    boost::optional<Timestamp> readTimestamp;
+    switch (_timestampReadSource) {
+        case ReadSource::kUnset:
+        case ReadSource::kNoTimestamp:
+            break;
+        case ReadSource::kMajorityCommitted: {
+            invariant(_snapshotManager);
+            // Reset _majorityCommittedSnapshot to the actual read timestamp used when the
+            // transaction was started.
+            _majorityCommittedSnapshot = _snapshotManager->getCommittedSnapshotForRead();
+            readTimestamp = _majorityCommittedSnapshot;
+            break;
+        }
+        case ReadSource::kLastApplied: {
+            if (auto localSnapshot =
+                    _snapshotManager ? _snapshotManager->getLocalSnapshot() : boost::none) {
+                _readAtTimestamp = *localSnapshot;
+                readTimestamp = _readAtTimestamp;
+            }
+            break;
+        }
+        case ReadSource::kLastAppliedSnapshot: {
+            // Only ever read the last applied timestamp once, and continue reusing it for
+            // subsequent transactions.
+            if (_readAtTimestamp.isNull()) {
+                invariant(_snapshotManager);
+                auto localSnapshot = _snapshotManager->getLocalSnapshot();
+                invariant(localSnapshot);
+                _readAtTimestamp = *localSnapshot;
+            }
+            readTimestamp = _readAtTimestamp;
+            break;
+        }
+        case ReadSource::kProvided:
+            readTimestamp = _readAtTimestamp;
+            break;
+    }
+
+    _txn = _store->beginTransaction(readTimestamp);
+    if (!_commitTimestamp.isNull()) {
+        _txn->setCommitTimestamp(_commitTimestamp);
+    }
+    LOG(3) << "memoryMVCC begin transaction " << _txn->id() << " for snapshot id "
+           << _mySnapshotId;
+}
+
+void MemoryMVCCRecoveryUnit::_txnClose(bool commit) {
+    invariant(_txn);
+
+    if (commit) {
+        _txn->commit(_commitTimestamp);
+        LOG(3) << "memoryMVCC commit transaction for snapshot id " << _mySnapshotId;
+    } else {
+        _txn->abort();
+        LOG(3) << "memoryMVCC rollback transaction for snapshot id " << _mySnapshotId;
+    }
+    _txn.reset();
+
+    invariant(!_lastTimestampSet || _commitTimestamp.isNull(),
+              str::stream() << "Cannot have both a _lastTimestampSet and a "
+                               "_commitTimestamp. _lastTimestampSet: "
+                            << _lastTimestampSet->toString()
+                            << ". _commitTimestamp: "
+                            << _commitTimestamp.toString());
+
+    // We reset the _lastTimestampSet between transactions. Since it is legal for one
+    // transaction on a RecoveryUnit to call setTimestamp() and another to call
+    // setCommitTimestamp().
+    _lastTimestampSet = boost::none;
+
+    _mySnapshotId = nextSnapshotId.fetchAndAdd(1);
+}
+
+Status MemoryMVCCRecoveryUnit::obtainMajorityCommittedSnapshot() {
+    invariant(_timestampReadSource == ReadSource::kMajorityCommitted);
+    auto snapshotName =
+        _snapshotManager ? _snapshotManager->getMinSnapshotForNextCommittedRead() : boost::none;
+    if (!snapshotName) {
+        return {ErrorCodes::ReadConcernMajorityNotAvailableYet,
+                "Read concern majority reads are currently not possible."};
+    }
+    _majorityCommittedSnapshot = *snapshotName;
+    return Status::OK();
+}
+
+boost::optional<Timestamp> MemoryMVCCRecoveryUnit::getPointInTimeReadTimestamp() const {
+    if (_timestampReadSource == ReadSource::kProvided ||
+        _timestampReadSource == ReadSource::kLastAppliedSnapshot) {
+        invariant(!_readAtTimestamp.isNull());
+        return _readAtTimestamp;
+    }
+
+    if (_timestampReadSource == ReadSource::kLastApplied && !_readAtTimestamp.isNull()) {
+        return _readAtTimestamp;
+    }
+
+    if (_timestampReadSource == ReadSource::kMajorityCommitted) {
+        invariant(!_majorityCommittedSnapshot.isNull());
+        return _majorityCommittedSnapshot;
+    }
+
+    return boost::none;
+}
+
+SnapshotId MemoryMVCCRecoveryUnit::getSnapshotId() const {
+    return SnapshotId(_mySnapshotId);
+}
+
+Status MemoryMVCCRecoveryUnit::setTimestamp(Timestamp timestamp) {
+    LOG(3) << "memoryMVCC set timestamp of future write operations to " << timestamp;
+    invariant(_inUnitOfWork);
+    invariant(_commitTimestamp.isNull(),
+              str::stream() << "Commit timestamp set to " << _commitTimestamp.toString()
+                            << " and trying to set WUOW timestamp to "
+                            << timestamp.toString());
+
+    _lastTimestampSet = timestamp;
+    getTransaction()->setWriteTimestamp(timestamp);
+    return Status::OK();
+}
+
+void MemoryMVCCRecoveryUnit::setCommitTimestamp(Timestamp timestamp) {
+    invariant(!_inUnitOfWork);
+    invariant(_commitTimestamp.isNull(),
+              str::stream() << "Commit timestamp set to " << _commitTimestamp.toString()
+                            << " and trying to set it to "
+                            << timestamp.toString());
+    invariant(!_lastTimestampSet,
+              str::stream() << "Last timestamp set is " << _lastTimestampSet->toString()
+                            << " and trying to set commit timestamp to "
+                            << timestamp.toString());
+
+    _commitTimestamp = timestamp;
+
+    // Register the commit timestamp with the store now rather than at commit, otherwise the
+    // all-committed timestamp could move past it while this transaction is still writing.
+    if (_txn) {
+        _txn->setCommitTimestamp(timestamp);
+    } else {
+        _txnOpen();
+    }
+}
+
+Timestamp MemoryMVCCRecoveryUnit::getCommitTimestamp() {
+    return _commitTimestamp;
+}
+
+void MemoryMVCCRecoveryUnit::clearCommitTimestamp() {
+    invariant(!_inUnitOfWork);
+    invariant(!_commitTimestamp.isNull());
+    invariant(!_lastTimestampSet,
+              str::stream() << "Last timestamp set is " << _lastTimestampSet->toString()
+                            << " and trying to clear commit timestamp.");
+
+    if (_txn) {
+        _txn->clearCommitTimestamp();
+    }
+    _commitTimestamp = Timestamp();
+}
+
+void MemoryMVCCRecoveryUnit::setTimestampReadSource(ReadSource readSource,
+                                                    boost::optional<Timestamp> provided) {
+    LOG(3) << "setting timestamp read source: " << static_cast<int>(readSource)
+           << ", provided timestamp: " << ((provided) ? provided->toString() : "none");
+
+    invariant(!_txn || _timestampReadSource == ReadSource::kUnset ||
+              _timestampReadSource == readSource);
+    invariant(!provided == (readSource != ReadSource::kProvided));
+    invariant(!(provided && provided->isNull()));
+
+    _timestampReadSource = readSource;
+    _readAtTimestamp = (provided) ? *provided : Timestamp();
+}
+
+RecoveryUnit::ReadSource MemoryMVCCRecoveryUnit::getTimestampReadSource() const {
+    return _timestampReadSource;
+}
+
+void MemoryMVCCRecoveryUnit::registerChange(Change* change) {
+    invariant(_inUnitOfWork);
+    _changes.push_back(std::unique_ptr<Change>{change});
+}
+
+void* MemoryMVCCRecoveryUnit::writingPtr(void* data, size_t len) {
+    // This API should not be used for anything other than the MMAP V1 storage engine
+    MONGO_UNREACHABLE;
+}
+
+}  // namespace mongo
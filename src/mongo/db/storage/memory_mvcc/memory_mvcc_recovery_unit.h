@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/stdx/functional.h"
+
+namespace mongo {
+
+class MemoryMVCCSnapshotManager;
+class MemoryMVCCStore;
+class MemoryMVCCTransaction;
+
+/**
+ * Wraps a MemoryMVCCTransaction, which is opened lazily on first access and closed when the unit
+ * of work ends or the snapshot is abandoned.
+ */
+class MemoryMVCCRecoveryUnit final : public RecoveryUnit {
+public:
+    MemoryMVCCRecoveryUnit(MemoryMVCCStore* store,
+                           MemoryMVCCSnapshotManager* snapshotManager,
+                           stdx::function<void()> waitUntilDurableCallback = nullptr);
+
+    ~MemoryMVCCRecoveryUnit();
+
+    static MemoryMVCCRecoveryUnit* get(OperationContext* opCtx) {
+        return checked_cast<MemoryMVCCRecoveryUnit*>(opCtx->recoveryUnit());
+    }
+
+    void beginUnitOfWork(OperationContext* opCtx) final;
+    void commitUnitOfWork() final;
+    void abortUnitOfWork() final;
+
+    bool waitUntilDurable() final;
+
+    void abandonSnapshot() final;
+    void preallocateSnapshot() final;
+
+    Status obtainMajorityCommittedSnapshot() final;
+
+    boost::optional<Timestamp> getPointInTimeReadTimestamp() const final;
+
+    SnapshotId getSnapshotId() const final;
+
+    Status setTimestamp(Timestamp timestamp) final;
+    void setCommitTimestamp(Timestamp timestamp) final;
+    void clearCommitTimestamp() final;
+    Timestamp getCommitTimestamp() final;
+
+    void setTimestampReadSource(ReadSource source,
+                                boost::optional<Timestamp> provided = boost::none) final;
+    ReadSource getTimestampReadSource() const final;
+
+    void registerChange(Change* change) final;
+
+    void* writingPtr(void* data, size_t len) final;
+
+    void setRollbackWritesDisabled() final {}
+
+    void setOrderedCommit(bool orderedCommit) final {}
+
+    // ---- memoryMVCC specific
+
+    /**
+     * Returns the open transaction, beginning one if necessary.
+     */
+    MemoryMVCCTransaction* getTransaction();
+
+    MemoryMVCCStore* getStore() const {
+        return _store;
+    }
+
+    MemoryMVCCSnapshotManager* getSnapshotManager() const {
+        return _snapshotManager;
+    }
+
+    bool inActiveTxn() const {
+        return static_cast<bool>(_txn);
+    }
+
+    bool inUnitOfWork() const {
+        return _inUnitOfWork;
+    }
+
+private:
+    void _commit();
+    void _abort();
+
+    void _txnOpen();
+    void _txnClose(bool commit);
+
+    MemoryMVCCStore* const _store;
+    MemoryMVCCSnapshotManager* const _snapshotManager;
+    stdx::function<void()> _waitUntilDurableCallback;
+
+    bool _inUnitOfWork = false;
+    std::unique_ptr<MemoryMVCCTransaction> _txn;
+    uint64_t _mySnapshotId;
+
+    Timestamp _commitTimestamp;
+    boost::optional<Timestamp> _lastTimestampSet;
+
+    ReadSource _timestampReadSource = ReadSource::kUnset;
+    Timestamp _readAtTimestamp;
+    Timestamp _majorityCommittedSnapshot;
+
+    typedef std::vector<std::unique_ptr<Change>> Changes;
+    Changes _changes;
+};
+
+}  // namespace mongo
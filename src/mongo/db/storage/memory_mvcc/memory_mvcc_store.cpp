@@ -0,0 +1,470 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+
+#include <cstring>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+MemoryMVCCTransaction::MemoryMVCCTransaction(MemoryMVCCStore* store,
+                                             uint64_t id,
+                                             uint64_t snapshotSeq,
+                                             boost::optional<Timestamp> readTimestamp)
+    : _store(store), _id(id), _snapshotSeq(snapshotSeq), _readTimestamp(readTimestamp) {}
+
+MemoryMVCCTransaction::~MemoryMVCCTransaction() {
+    if (!_finished) {
+        abort();
+    }
+}
+
+void MemoryMVCCTransaction::setWriteTimestamp(Timestamp timestamp) {
+    invariant(!_finished);
+    _writeTimestamp = timestamp;
+    if (!timestamp.isNull() && _activeTimestamp.isNull()) {
+        _activeTimestamp = timestamp;
+        _store->_addActiveWriteTimestamp(timestamp);
+    }
+}
+
+void MemoryMVCCTransaction::setCommitTimestamp(Timestamp timestamp) {
+    invariant(!_finished);
+    invariant(!timestamp.isNull());
+    invariant(_activeTimestamp.isNull());
+    _activeTimestamp = timestamp;
+    _store->_addActiveWriteTimestamp(timestamp);
+}
+
+void MemoryMVCCTransaction::clearCommitTimestamp() {
+    invariant(!_finished);
+    invariant(_writeTimestamp.isNull());
+    invariant(_writes.empty());
+    if (!_activeTimestamp.isNull()) {
+        _store->_removeActiveWriteTimestamp(_activeTimestamp);
+        _activeTimestamp = Timestamp();
+    }
+}
+
+void MemoryMVCCTransaction::commit(Timestamp commitTimestamp) {
+    invariant(!_finished);
+    _store->_commit(this, commitTimestamp);
+    _finish();
+}
+
+void MemoryMVCCTransaction::abort() {
+    invariant(!_finished);
+    _store->_abort(this);
+    _finish();
+}
+
+void MemoryMVCCTransaction::_registerWrite(std::shared_ptr<MemoryMVCCTable> table,
+                                           StringData key) {
+    invariant(!_finished);
+    _writes.push_back({std::move(table), key.toString()});
+}
+
+void MemoryMVCCTransaction::_finish() {
+    _writes.clear();
+    _finished = true;
+}
+
+std::unique_ptr<MemoryMVCCTransaction> MemoryMVCCStore::beginTransaction(
+    boost::optional<Timestamp> readTimestamp) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (readTimestamp && !_oldestTimestamp.isNull() && *readTimestamp < _oldestTimestamp) {
+        uasserted(ErrorCodes::SnapshotTooOld,
+                  str::stream() << "Read timestamp " << readTimestamp->toString()
+                                << " is older than the oldest available timestamp "
+                                << _oldestTimestamp.toString());
+    }
+
+    const uint64_t id = _nextTransactionId++;
+    const uint64_t snapshotSeq = _lastCommittedSeq.load();
+    _activeSnapshots.insert(snapshotSeq);
+    if (readTimestamp) {
+        _activeReadTimestamps.insert(*readTimestamp);
+    }
+    return stdx::make_unique<MemoryMVCCTransaction>(this, id, snapshotSeq, readTimestamp);
+}
+
+void MemoryMVCCStore::setOldestTimestamp(Timestamp oldestTimestamp) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (oldestTimestamp > _oldestTimestamp) {
+        _oldestTimestamp = oldestTimestamp;
+    }
+}
+
+Timestamp MemoryMVCCStore::getOldestTimestamp() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _oldestTimestamp;
+}
+
+Timestamp MemoryMVCCStore::getAllCommittedTimestamp() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_activeWriteTimestamps.empty()) {
+        return _lastCommitTimestamp;
+    }
+    return Timestamp(_activeWriteTimestamps.begin()->asULL() - 1);
+}
+
+MemoryMVCCStore::PruneHorizon MemoryMVCCStore::getPruneHorizon() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _getPruneHorizon_inlock();
+}
+
+MemoryMVCCStore::PruneHorizon MemoryMVCCStore::_getPruneHorizon_inlock() const {
+    PruneHorizon horizon;
+    horizon.snapshotSeq =
+        _activeSnapshots.empty() ? _lastCommittedSeq.load() : *_activeSnapshots.begin();
+    horizon.oldestTimestamp = _oldestTimestamp;
+    if (!_activeReadTimestamps.empty() && !horizon.oldestTimestamp.isNull()) {
+        // Readers that started before the oldest timestamp moved forward keep their history.
+        horizon.oldestTimestamp = std::min(horizon.oldestTimestamp, *_activeReadTimestamps.begin());
+    }
+    return horizon;
+}
+
+void MemoryMVCCStore::_commit(MemoryMVCCTransaction* txn, Timestamp commitTimestamp) {
+    const Timestamp endTimestamp = std::max(commitTimestamp, txn->_writeTimestamp);
+    if (txn->_writes.empty()) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _endTransaction_inlock(txn, endTimestamp);
+        return;
+    }
+
+    PruneHorizon horizon;
+    {
+        stdx::lock_guard<stdx::mutex> commitLk(_commitMutex);
+        const uint64_t commitSeq = _lastCommittedSeq.load() + 1;
+        for (auto&& write : txn->_writes) {
+            write.table->_commitKey(write.key, txn->_id, commitSeq, commitTimestamp);
+        }
+
+        // Publishing the sequence number makes the writes visible to new snapshots all at once.
+        // The horizon is computed under the same lock so that no snapshot older than it can be
+        // opened afterwards.
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _lastCommittedSeq.store(commitSeq);
+        _endTransaction_inlock(txn, endTimestamp);
+        horizon = _getPruneHorizon_inlock();
+    }
+
+    for (auto&& write : txn->_writes) {
+        write.table->_pruneKey(write.key, horizon);
+    }
+}
+
+void MemoryMVCCStore::_abort(MemoryMVCCTransaction* txn) {
+    for (auto&& write : txn->_writes) {
+        write.table->_abortKey(write.key, txn->_id);
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _endTransaction_inlock(txn, Timestamp());
+}
+
+void MemoryMVCCStore::_addActiveWriteTimestamp(Timestamp timestamp) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _activeWriteTimestamps.insert(timestamp);
+}
+
+void MemoryMVCCStore::_removeActiveWriteTimestamp(Timestamp timestamp) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto writeIt = _activeWriteTimestamps.find(timestamp);
+    invariant(writeIt != _activeWriteTimestamps.end());
+    _activeWriteTimestamps.erase(writeIt);
+}
+
+void MemoryMVCCStore::_endTransaction_inlock(MemoryMVCCTransaction* txn,
+                                             Timestamp commitTimestamp) {
+    auto snapshotIt = _activeSnapshots.find(txn->_snapshotSeq);
+    invariant(snapshotIt != _activeSnapshots.end());
+    _activeSnapshots.erase(snapshotIt);
+
+    if (txn->_readTimestamp) {
+        auto readIt = _activeReadTimestamps.find(*txn->_readTimestamp);
+        invariant(readIt != _activeReadTimestamps.end());
+        _activeReadTimestamps.erase(readIt);
+    }
+
+    if (!txn->_activeTimestamp.isNull()) {
+        auto writeIt = _activeWriteTimestamps.find(txn->_activeTimestamp);
+        invariant(writeIt != _activeWriteTimestamps.end());
+        _activeWriteTimestamps.erase(writeIt);
+    }
+
+    if (!txn->_writes.empty() && commitTimestamp > _lastCommitTimestamp) {
+        _lastCommitTimestamp = commitTimestamp;
+    }
+}
+
+const MemoryMVCCTable::Version* MemoryMVCCTable::_visibleVersion(const MemoryMVCCTransaction& txn,
+                                                                 const Version* head) {
+    for (const Version* version = head; version; version = version->older.get()) {
+        if (version->commitSeq == 0) {
+            if (version->writer == txn.id()) {
+                return version;
+            }
+            continue;
+        }
+
+        if (version->commitSeq > txn.snapshotSeq()) {
+            continue;
+        }
+
+        const auto& readTimestamp = txn.readTimestamp();
+        if (readTimestamp && !version->commitTimestamp.isNull() &&
+            version->commitTimestamp > *readTimestamp) {
+            continue;
+        }
+
+        return version;
+    }
+    return nullptr;
+}
+
+boost::optional<MemoryMVCCTable::Entry> MemoryMVCCTable::_toEntry(
+    const MemoryMVCCTransaction& txn, const Versions::value_type& kv) {
+    const Version* version = _visibleVersion(txn, kv.second.get());
+    if (!version || version->isDelete) {
+        return boost::none;
+    }
+
+    Entry entry;
+    entry.key = kv.first;
+    entry.value = version->value;
+    entry.size = version->size;
+    entry.isOwnWrite = version->commitSeq == 0;
+    return entry;
+}
+
+boost::optional<MemoryMVCCTable::Entry> MemoryMVCCTable::find(const MemoryMVCCTransaction& txn,
+                                                              StringData key) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _versions.find(key);
+    if (it == _versions.end()) {
+        return boost::none;
+    }
+    return _toEntry(txn, *it);
+}
+
+boost::optional<MemoryMVCCTable::Entry> MemoryMVCCTable::seek(const MemoryMVCCTransaction& txn,
+                                                              StringData key,
+                                                              bool forward,
+                                                              bool inclusive) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    if (forward) {
+        auto it = key.empty() ? _versions.begin()
+                              : (inclusive ? _versions.lower_bound(key) : _versions.upper_bound(key));
+        for (; it != _versions.end(); ++it) {
+            if (auto entry = _toEntry(txn, *it)) {
+                return entry;
+            }
+        }
+        return boost::none;
+    }
+
+    // A reverse_iterator dereferences to the element before its base, so this positions on the
+    // last key <= 'key' when inclusive and < 'key' otherwise.
+    auto rit = key.empty()
+        ? _versions.rbegin()
+        : Versions::const_reverse_iterator(inclusive ? _versions.upper_bound(key)
+                                                     : _versions.lower_bound(key));
+    for (; rit != _versions.rend(); ++rit) {
+        if (auto entry = _toEntry(txn, *rit)) {
+            return entry;
+        }
+    }
+    return boost::none;
+}
+
+void MemoryMVCCTable::put(MemoryMVCCTransaction* txn,
+                          StringData key,
+                          const char* data,
+                          size_t size) {
+    SharedBuffer value = SharedBuffer::allocate(size);
+    if (size) {
+        std::memcpy(value.get(), data, size);
+    }
+
+    bool created;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        Version* version;
+        std::tie(version, created) = _prepareWrite_inlock(txn, key);
+        version->value = std::move(value);
+        version->size = size;
+        version->isDelete = false;
+        version->commitTimestamp = txn->getWriteTimestamp();
+    }
+
+    if (created) {
+        txn->_registerWrite(shared_from_this(), key);
+    }
+}
+
+bool MemoryMVCCTable::remove(MemoryMVCCTransaction* txn, StringData key) {
+    bool created;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _versions.find(key);
+        if (it == _versions.end() || !_toEntry(*txn, *it)) {
+            return false;
+        }
+
+        Version* version;
+        std::tie(version, created) = _prepareWrite_inlock(txn, key);
+        version->value = SharedBuffer();
+        version->size = 0;
+        version->isDelete = true;
+        version->commitTimestamp = txn->getWriteTimestamp();
+    }
+
+    if (created) {
+        txn->_registerWrite(shared_from_this(), key);
+    }
+    return true;
+}
+
+size_t MemoryMVCCTable::numKeys() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _versions.size();
+}
+
+std::pair<MemoryMVCCTable::Version*, bool> MemoryMVCCTable::_prepareWrite_inlock(
+    MemoryMVCCTransaction* txn, StringData key) {
+    auto it = _versions.find(key);
+    if (it == _versions.end()) {
+        auto version = stdx::make_unique<Version>();
+        version->writer = txn->id();
+        Version* out = version.get();
+        _versions.emplace(key.toString(), std::move(version));
+        return {out, true};
+    }
+
+    Version* head = it->second.get();
+    if (head->commitSeq == 0) {
+        if (head->writer == txn->id()) {
+            return {head, false};
+        }
+        throw WriteConflictException();
+    }
+
+    if (head->commitSeq > txn->snapshotSeq()) {
+        throw WriteConflictException();
+    }
+
+    auto version = stdx::make_unique<Version>();
+    version->writer = txn->id();
+    version->older = std::move(it->second);
+    it->second = std::move(version);
+    return {it->second.get(), true};
+}
+
+void MemoryMVCCTable::_commitKey(StringData key,
+                                 uint64_t txnId,
+                                 uint64_t commitSeq,
+                                 Timestamp commitTimestamp) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _versions.find(key);
+    invariant(it != _versions.end());
+
+    Version* head = it->second.get();
+    invariant(head->commitSeq == 0 && head->writer == txnId);
+
+    head->commitSeq = commitSeq;
+    if (head->commitTimestamp.isNull()) {
+        head->commitTimestamp = commitTimestamp;
+    }
+}
+
+void MemoryMVCCTable::_pruneKey(StringData key, const MemoryMVCCStore::PruneHorizon& horizon) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _versions.find(key);
+    if (it != _versions.end()) {
+        _prune_inlock(it, horizon);
+    }
+}
+
+void MemoryMVCCTable::_abortKey(StringData key, uint64_t txnId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _versions.find(key);
+    if (it == _versions.end()) {
+        return;
+    }
+
+    Version* head = it->second.get();
+    if (head->commitSeq != 0 || head->writer != txnId) {
+        return;
+    }
+
+    it->second = std::move(head->older);
+    if (!it->second) {
+        _versions.erase(it);
+    }
+}
+
+void MemoryMVCCTable::_prune_inlock(Versions::iterator it,
+                                    const MemoryMVCCStore::PruneHorizon& horizon) {
+    // Find the newest version that every current and future reader can see. Anything older is
+    // unreachable. Timestamped versions are retained until the oldest timestamp passes them.
+    Version* version = it->second.get();
+    for (; version; version = version->older.get()) {
+        if (version->commitSeq == 0 || version->commitSeq > horizon.snapshotSeq) {
+            continue;
+        }
+        if (!version->commitTimestamp.isNull() &&
+            (horizon.oldestTimestamp.isNull() ||
+             version->commitTimestamp > horizon.oldestTimestamp)) {
+            continue;
+        }
+        break;
+    }
+
+    if (!version) {
+        return;
+    }
+
+    version->older.reset();
+    if (version == it->second.get() && version->isDelete) {
+        _versions.erase(it);
+    }
+}
+
+}  // namespace mongo
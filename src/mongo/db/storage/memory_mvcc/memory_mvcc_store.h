@@ -0,0 +1,318 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+
+class MemoryMVCCStore;
+class MemoryMVCCTable;
+
+/**
+ * A single storage transaction against a MemoryMVCCStore.
+ *
+ * A transaction reads from the snapshot of committed data that existed when it began, optionally
+ * further restricted to writes with commit timestamps at or before its read timestamp. Its own
+ * writes are installed in the tables immediately as uncommitted versions, which makes them
+ * visible to itself and causes any other transaction writing the same key to fail with a
+ * WriteConflictException.
+ *
+ * Transactions are not thread-safe; each one is owned by a single MemoryMVCCRecoveryUnit.
+ */
+class MemoryMVCCTransaction {
+    MONGO_DISALLOW_COPYING(MemoryMVCCTransaction);
+
+public:
+    MemoryMVCCTransaction(MemoryMVCCStore* store,
+                          uint64_t id,
+                          uint64_t snapshotSeq,
+                          boost::optional<Timestamp> readTimestamp);
+
+    /**
+     * Transactions that were not committed are rolled back on destruction.
+     */
+    ~MemoryMVCCTransaction();
+
+    uint64_t id() const {
+        return _id;
+    }
+
+    uint64_t snapshotSeq() const {
+        return _snapshotSeq;
+    }
+
+    const boost::optional<Timestamp>& readTimestamp() const {
+        return _readTimestamp;
+    }
+
+    /**
+     * Sets the timestamp assigned to subsequent writes. Writes made while no timestamp is set are
+     * assigned the commit timestamp passed to commit().
+     */
+    void setWriteTimestamp(Timestamp timestamp);
+
+    Timestamp getWriteTimestamp() const {
+        return _writeTimestamp;
+    }
+
+    /**
+     * Declares the timestamp this transaction will commit at before it writes anything, so that
+     * the all-committed timestamp stays behind it until the transaction commits or aborts. Can't
+     * be combined with setWriteTimestamp().
+     */
+    void setCommitTimestamp(Timestamp timestamp);
+
+    /**
+     * Withdraws the timestamp declared by setCommitTimestamp(). The transaction must not have
+     * written anything.
+     */
+    void clearCommitTimestamp();
+
+    /**
+     * Makes all writes of this transaction visible to transactions that begin afterwards.
+     */
+    void commit(Timestamp commitTimestamp);
+
+    /**
+     * Removes all writes of this transaction.
+     */
+    void abort();
+
+private:
+    friend class MemoryMVCCStore;
+    friend class MemoryMVCCTable;
+
+    struct Write {
+        std::shared_ptr<MemoryMVCCTable> table;
+        std::string key;
+    };
+
+    void _registerWrite(std::shared_ptr<MemoryMVCCTable> table, StringData key);
+
+    void _finish();
+
+    MemoryMVCCStore* const _store;
+    const uint64_t _id;
+    const uint64_t _snapshotSeq;
+    const boost::optional<Timestamp> _readTimestamp;
+
+    Timestamp _writeTimestamp;
+    // The first write or commit timestamp of this transaction, which holds back the store's
+    // all-committed timestamp until the transaction ends.
+    Timestamp _activeTimestamp;
+    std::vector<Write> _writes;
+    bool _finished = false;
+};
+
+/**
+ * Process-wide transaction state shared by all tables of a MemoryMVCCKVEngine: the commit
+ * sequence that defines snapshots, the set of open snapshots, and the oldest timestamp that
+ * readers may request.
+ */
+class MemoryMVCCStore {
+    MONGO_DISALLOW_COPYING(MemoryMVCCStore);
+
+public:
+    /**
+     * Versions older than the newest one visible at this horizon can never be read again.
+     */
+    struct PruneHorizon {
+        uint64_t snapshotSeq;
+        Timestamp oldestTimestamp;
+    };
+
+    MemoryMVCCStore() = default;
+
+    /**
+     * Opens a transaction on the latest committed data. Throws SnapshotTooOld if
+     * 'readTimestamp' is older than the oldest timestamp.
+     */
+    std::unique_ptr<MemoryMVCCTransaction> beginTransaction(
+        boost::optional<Timestamp> readTimestamp);
+
+    void setOldestTimestamp(Timestamp oldestTimestamp);
+
+    Timestamp getOldestTimestamp() const;
+
+    /**
+     * Returns the latest timestamp at or before which every timestamped transaction has either
+     * committed or aborted.
+     */
+    Timestamp getAllCommittedTimestamp() const;
+
+    PruneHorizon getPruneHorizon() const;
+
+    uint64_t getLastCommittedSeq() const {
+        return _lastCommittedSeq.load();
+    }
+
+private:
+    friend class MemoryMVCCTransaction;
+
+    void _commit(MemoryMVCCTransaction* txn, Timestamp commitTimestamp);
+
+    void _abort(MemoryMVCCTransaction* txn);
+
+    void _addActiveWriteTimestamp(Timestamp timestamp);
+    void _removeActiveWriteTimestamp(Timestamp timestamp);
+
+    void _endTransaction_inlock(MemoryMVCCTransaction* txn, Timestamp commitTimestamp);
+    PruneHorizon _getPruneHorizon_inlock() const;
+
+    // Serializes commits so that sequence numbers are published in order.
+    stdx::mutex _commitMutex;
+    AtomicUInt64 _lastCommittedSeq{0};
+
+    mutable stdx::mutex _mutex;  // Guards the members below.
+    uint64_t _nextTransactionId = 1;
+    std::multiset<uint64_t> _activeSnapshots;
+    std::multiset<Timestamp> _activeReadTimestamps;
+    std::multiset<Timestamp> _activeWriteTimestamps;
+    Timestamp _oldestTimestamp;
+    Timestamp _lastCommitTimestamp;
+};
+
+/**
+ * An ordered key-value table holding a chain of versions for each key, newest first.
+ *
+ * The table's latch is only held for the duration of a single lookup or modification, so
+ * concurrent transactions can read and write different keys of the same table freely; conflicts
+ * between writers of the same key are detected on write (first writer wins).
+ */
+class MemoryMVCCTable : public std::enable_shared_from_this<MemoryMVCCTable> {
+    MONGO_DISALLOW_COPYING(MemoryMVCCTable);
+
+public:
+    struct Entry {
+        std::string key;
+        SharedBuffer value;
+        size_t size = 0;
+        // True if the version was written by the transaction reading it and is not yet committed.
+        bool isOwnWrite = false;
+    };
+
+    MemoryMVCCTable() = default;
+
+    /**
+     * Returns the version of 'key' visible to 'txn', or boost::none if there is none or it was
+     * deleted.
+     */
+    boost::optional<Entry> find(const MemoryMVCCTransaction& txn, StringData key) const;
+
+    /**
+     * Returns the first key visible to 'txn' that is after (or at, if 'inclusive') 'key' in the
+     * direction of the scan. An empty 'key' positions at the start of the scan.
+     */
+    boost::optional<Entry> seek(const MemoryMVCCTransaction& txn,
+                                StringData key,
+                                bool forward,
+                                bool inclusive) const;
+
+    /**
+     * Inserts or overwrites 'key'. Throws WriteConflictException if another transaction has
+     * written 'key' since 'txn' began.
+     */
+    void put(MemoryMVCCTransaction* txn, StringData key, const char* data, size_t size);
+
+    /**
+     * Deletes 'key'. Returns false, without writing, if no version of 'key' is visible to 'txn'.
+     * Throws WriteConflictException under the same conditions as put().
+     */
+    bool remove(MemoryMVCCTransaction* txn, StringData key);
+
+    /**
+     * Approximate number of keys, including versions not visible to every reader.
+     */
+    size_t numKeys() const;
+
+private:
+    friend class MemoryMVCCStore;
+
+    struct Version {
+        SharedBuffer value;
+        size_t size = 0;
+        bool isDelete = false;
+        uint64_t writer = 0;
+        // Zero while the version is uncommitted.
+        uint64_t commitSeq = 0;
+        Timestamp commitTimestamp;
+        std::unique_ptr<Version> older;
+
+        Version() = default;
+
+        // Unlinks the chain iteratively so that destroying a long history can't overflow the
+        // stack.
+        ~Version() {
+            auto next = std::move(older);
+            while (next) {
+                next = std::move(next->older);
+            }
+        }
+    };
+
+    using Versions = std::map<std::string, std::unique_ptr<Version>, std::less<>>;
+
+    static const Version* _visibleVersion(const MemoryMVCCTransaction& txn, const Version* head);
+
+    static boost::optional<Entry> _toEntry(const MemoryMVCCTransaction& txn,
+                                           const Versions::value_type& kv);
+
+    /**
+     * Returns the uncommitted version of 'key' owned by 'txn', creating it if needed, and whether
+     * it was created. Throws WriteConflictException if another transaction owns the newest
+     * version or committed it after 'txn' began.
+     */
+    std::pair<Version*, bool> _prepareWrite_inlock(MemoryMVCCTransaction* txn, StringData key);
+
+    void _commitKey(StringData key, uint64_t txnId, uint64_t commitSeq, Timestamp commitTimestamp);
+    void _pruneKey(StringData key, const MemoryMVCCStore::PruneHorizon& horizon);
+
+    void _abortKey(StringData key, uint64_t txnId);
+
+    void _prune_inlock(Versions::iterator it, const MemoryMVCCStore::PruneHorizon& horizon);
+
+    mutable stdx::mutex _mutex;  // Guards _versions.
+    Versions _versions;
+};
+
+}  // namespace mongo
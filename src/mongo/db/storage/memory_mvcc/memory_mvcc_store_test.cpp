@@ -0,0 +1,203 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_store.h"
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/storage/memory_mvcc/memory_mvcc_recovery_unit.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class MemoryMVCCStoreTest : public unittest::Test {
+protected:
+    void put(MemoryMVCCTransaction* txn, StringData key, StringData value) {
+        table->put(txn, key, value.rawData(), value.size());
+    }
+
+    void commitPut(StringData key, StringData value, Timestamp ts = Timestamp()) {
+        auto txn = store.beginTransaction(boost::none);
+        put(txn.get(), key, value);
+        txn->commit(ts);
+    }
+
+    std::string get(const MemoryMVCCTransaction& txn, StringData key) {
+        auto entry = table->find(txn, key);
+        return entry ? std::string(entry->value.get(), entry->size) : "<none>";
+    }
+
+    MemoryMVCCStore store;
+    std::shared_ptr<MemoryMVCCTable> table = std::make_shared<MemoryMVCCTable>();
+};
+
+TEST_F(MemoryMVCCStoreTest, ReadersSeeTheirSnapshot) {
+    commitPut("a", "1");
+
+    auto reader = store.beginTransaction(boost::none);
+    commitPut("a", "2");
+    commitPut("b", "1");
+
+    ASSERT_EQ("1", get(*reader, "a"));
+    ASSERT_EQ("<none>", get(*reader, "b"));
+    ASSERT_FALSE(table->seek(*reader, "a", true, false));
+
+    auto newReader = store.beginTransaction(boost::none);
+    ASSERT_EQ("2", get(*newReader, "a"));
+    ASSERT_EQ("1", get(*newReader, "b"));
+}
+
+TEST_F(MemoryMVCCStoreTest, UncommittedWritesOnlyVisibleToWriter) {
+    auto writer = store.beginTransaction(boost::none);
+    put(writer.get(), "a", "1");
+
+    auto reader = store.beginTransaction(boost::none);
+    ASSERT_EQ("1", get(*writer, "a"));
+    ASSERT_EQ("<none>", get(*reader, "a"));
+
+    writer->abort();
+    auto afterAbort = store.beginTransaction(boost::none);
+    ASSERT_EQ("<none>", get(*afterAbort, "a"));
+    ASSERT_EQ(0U, table->numKeys());
+}
+
+TEST_F(MemoryMVCCStoreTest, ConcurrentWritersOfSameKeyConflict) {
+    auto first = store.beginTransaction(boost::none);
+    auto second = store.beginTransaction(boost::none);
+
+    put(first.get(), "a", "1");
+    put(second.get(), "b", "1");
+    ASSERT_THROWS(put(second.get(), "a", "2"), WriteConflictException);
+
+    // The first writer still conflicts with the second after committing, since the second's
+    // snapshot predates the commit.
+    first->commit(Timestamp());
+    ASSERT_THROWS(put(second.get(), "a", "2"), WriteConflictException);
+    ASSERT_EQ("<none>", get(*second, "a"));
+}
+
+TEST_F(MemoryMVCCStoreTest, ReadTimestampFiltersLaterCommits) {
+    commitPut("a", "1", Timestamp(10, 0));
+    commitPut("a", "2", Timestamp(20, 0));
+
+    auto atTen = store.beginTransaction(Timestamp(10, 0));
+    auto atFifteen = store.beginTransaction(Timestamp(15, 0));
+    auto atTwenty = store.beginTransaction(Timestamp(20, 0));
+    ASSERT_EQ("1", get(*atTen, "a"));
+    ASSERT_EQ("1", get(*atFifteen, "a"));
+    ASSERT_EQ("2", get(*atTwenty, "a"));
+
+    auto beforeFirst = store.beginTransaction(Timestamp(5, 0));
+    ASSERT_EQ("<none>", get(*beforeFirst, "a"));
+}
+
+TEST_F(MemoryMVCCStoreTest, ReadsBeforeOldestTimestampAreRejected) {
+    commitPut("a", "1", Timestamp(10, 0));
+    store.setOldestTimestamp(Timestamp(10, 0));
+
+    ASSERT_THROWS_CODE(
+        store.beginTransaction(Timestamp(5, 0)), AssertionException, ErrorCodes::SnapshotTooOld);
+    auto atOldest = store.beginTransaction(Timestamp(10, 0));
+    ASSERT_EQ("1", get(*atOldest, "a"));
+}
+
+TEST_F(MemoryMVCCStoreTest, AllCommittedTimestampWaitsForOpenWriters) {
+    commitPut("a", "1", Timestamp(10, 0));
+    ASSERT_EQ(Timestamp(10, 0), store.getAllCommittedTimestamp());
+
+    auto writer = store.beginTransaction(boost::none);
+    writer->setWriteTimestamp(Timestamp(20, 0));
+    put(writer.get(), "a", "2");
+    commitPut("b", "1", Timestamp(30, 0));
+    ASSERT_EQ(Timestamp(19, 0xFFFFFFFF), store.getAllCommittedTimestamp());
+
+    writer->commit(Timestamp());
+    ASSERT_EQ(Timestamp(30, 0), store.getAllCommittedTimestamp());
+}
+
+TEST_F(MemoryMVCCStoreTest, AllCommittedTimestampWaitsForOverlappingCommitTimestamps) {
+    commitPut("a", "1", Timestamp(10, 0));
+
+    MemoryMVCCRecoveryUnit first(&store, nullptr);
+    MemoryMVCCRecoveryUnit second(&store, nullptr);
+    first.setCommitTimestamp(Timestamp(20, 0));
+    second.setCommitTimestamp(Timestamp(30, 0));
+    ASSERT_EQ(Timestamp(19, 0xFFFFFFFF), store.getAllCommittedTimestamp());
+
+    first.beginUnitOfWork(nullptr);
+    put(first.getTransaction(), "b", "1");
+    second.beginUnitOfWork(nullptr);
+    put(second.getTransaction(), "c", "1");
+
+    // The later commit must not advance the all-committed timestamp past the earlier, still open,
+    // transaction.
+    second.commitUnitOfWork();
+    second.clearCommitTimestamp();
+    ASSERT_EQ(Timestamp(19, 0xFFFFFFFF), store.getAllCommittedTimestamp());
+
+    first.commitUnitOfWork();
+    first.clearCommitTimestamp();
+    ASSERT_EQ(Timestamp(30, 0), store.getAllCommittedTimestamp());
+}
+
+TEST_F(MemoryMVCCStoreTest, AbortedCommitTimestampNoLongerHoldsBackAllCommitted) {
+    commitPut("a", "1", Timestamp(10, 0));
+
+    MemoryMVCCRecoveryUnit ru(&store, nullptr);
+    ru.setCommitTimestamp(Timestamp(20, 0));
+    ru.beginUnitOfWork(nullptr);
+    put(ru.getTransaction(), "b", "1");
+    ASSERT_EQ(Timestamp(19, 0xFFFFFFFF), store.getAllCommittedTimestamp());
+
+    ru.abortUnitOfWork();
+    ru.clearCommitTimestamp();
+    ASSERT_EQ(Timestamp(10, 0), store.getAllCommittedTimestamp());
+}
+
+TEST_F(MemoryMVCCStoreTest, OldVersionsArePrunedOnceInvisible) {
+    auto reader = store.beginTransaction(boost::none);
+    commitPut("a", "1");
+    commitPut("a", "2");
+    auto txn = store.beginTransaction(boost::none);
+    ASSERT_TRUE(table->remove(txn.get(), "a"));
+    txn->commit(Timestamp());
+    ASSERT_EQ(1U, table->numKeys());
+
+    // Once no snapshot can see the key, the next commit touching it drops the key entirely.
+    reader.reset();
+    commitPut("a", "3");
+    txn = store.beginTransaction(boost::none);
+    ASSERT_TRUE(table->remove(txn.get(), "a"));
+    txn->commit(Timestamp());
+    ASSERT_EQ(0U, table->numKeys());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,178 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include <sqlite3.h>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/mobile/mobile_group_commit.h"
+#include "mongo/db/storage/mobile/mobile_util.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/background.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(mobileGroupCommitDelayMillis, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue, "mobileGroupCommitDelayMillis cannot be negative");
+        }
+
+        return Status::OK();
+    });
+
+class MobileGroupCommit::Flusher : public BackgroundJob {
+public:
+    explicit Flusher(MobileGroupCommit* groupCommit)
+        : BackgroundJob(false /* deleteSelf */), _groupCommit(groupCommit) {}
+
+    std::string name() const override {
+        return "MobileGroupCommitFlusher";
+    }
+
+    void run() override {
+        LOG(1) << "starting " << name() << " thread";
+        _groupCommit->_flusherLoop();
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+private:
+    MobileGroupCommit* _groupCommit;
+};
+
+MobileGroupCommit::MobileGroupCommit(const std::string& path, Milliseconds maxDelay)
+    : _maxDelay(maxDelay) {
+    int status = sqlite3_open(path.c_str(), &_syncSession);
+    checkStatus(status, SQLITE_OK, "sqlite3_open");
+
+    // SQLite opens the WAL lazily on the first read of a connection. Keeping this connection open
+    // also keeps the WAL file from being removed when the other connections close.
+    status = sqlite3_exec(_syncSession, "SELECT count(*) FROM sqlite_master;", NULL, NULL, NULL);
+    checkStatus(status, SQLITE_OK, "sqlite3_exec");
+
+    _flusher = stdx::make_unique<Flusher>(this);
+    _flusher->go();
+}
+
+MobileGroupCommit::~MobileGroupCommit() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shuttingDown = true;
+        _cond.notify_all();
+    }
+    _flusher->wait();
+
+    // Complete any commits the flusher did not get to.
+    waitUntilDurable();
+    checkStatus(sqlite3_close(_syncSession), SQLITE_OK, "sqlite3_close");
+}
+
+void MobileGroupCommit::notifyCommitted() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_oldestUnsyncedCommit == Date_t()) {
+        _oldestUnsyncedCommit = Date_t::now();
+    }
+    if (_commitCount++ == _syncedCount) {
+        // Wake the flusher, which sleeps while there is nothing to sync.
+        _cond.notify_all();
+    }
+}
+
+void MobileGroupCommit::waitUntilDurable() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    const uint64_t target = _commitCount;
+
+    while (_syncedCount < target) {
+        if (_syncInProgress) {
+            // The sync in progress may not cover every commit up to 'target'; re-check once it
+            // completes.
+            _cond.wait(lk);
+            continue;
+        }
+
+        _syncInProgress = true;
+        const uint64_t syncing = _commitCount;
+        _oldestUnsyncedCommit = Date_t();
+        lk.unlock();
+        _syncWal();
+        lk.lock();
+
+        _syncInProgress = false;
+        _syncedCount = syncing;
+        _numSyncs++;
+        _cond.notify_all();
+    }
+}
+
+uint64_t MobileGroupCommit::getNumSyncs() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _numSyncs;
+}
+
+void MobileGroupCommit::_flusherLoop() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (!_shuttingDown) {
+        _cond.wait(lk, [&] { return _shuttingDown || _commitCount > _syncedCount; });
+        if (_shuttingDown) {
+            break;
+        }
+
+        // Give further commits a chance to join this sync, bounded by the configured delay after
+        // the oldest commit it covers. That commit may have arrived while a previous sync was in
+        // progress, or is already covered by one in progress if none is recorded.
+        const Date_t deadline = _oldestUnsyncedCommit + _maxDelay;
+        _cond.wait_until(lk, deadline.toSystemTimePoint(), [&] { return _shuttingDown; });
+
+        lk.unlock();
+        waitUntilDurable();
+        lk.lock();
+    }
+}
+
+void MobileGroupCommit::_syncWal() {
+    sqlite3_file* file = nullptr;
+    int status = sqlite3_file_control(_syncSession, "main", SQLITE_FCNTL_JOURNAL_POINTER, &file);
+    checkStatus(status, SQLITE_OK, "sqlite3_file_control");
+
+    // Outside of WAL mode there may be no open journal, and commits reach the database file
+    // directly.
+    if (!file || !file->pMethods) {
+        status = sqlite3_file_control(_syncSession, "main", SQLITE_FCNTL_FILE_POINTER, &file);
+        checkStatus(status, SQLITE_OK, "sqlite3_file_control");
+    }
+
+    status = file->pMethods->xSync(file, SQLITE_SYNC_NORMAL);
+    checkStatus(status, SQLITE_OK, "xSync");
+}
+
+}  // namespace mongo
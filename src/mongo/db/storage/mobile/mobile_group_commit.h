@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <sqlite3.h>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Maximum number of milliseconds a committed write may wait for its WAL sync when group commit
+ * is enabled. Zero (the default) disables group commit, in which case every COMMIT is synced by
+ * SQLite itself.
+ */
+extern int mobileGroupCommitDelayMillis;
+
+/**
+ * Batches the syncs of the SQLite write-ahead log across write transactions.
+ *
+ * Sessions opened while group commit is enabled run with "PRAGMA synchronous=NORMAL", so a COMMIT
+ * only appends to the WAL. Committed transactions register here, and a single sync then makes
+ * every transaction registered before it durable. A background flusher performs the sync at most
+ * 'maxDelay' after the first unsynced commit; callers of waitUntilDurable() sync immediately,
+ * piggy-backing on a sync already in progress when possible.
+ */
+class MobileGroupCommit final {
+    MONGO_DISALLOW_COPYING(MobileGroupCommit);
+
+public:
+    MobileGroupCommit(const std::string& path, Milliseconds maxDelay);
+
+    /**
+     * Stops the flusher and syncs any remaining commits.
+     */
+    ~MobileGroupCommit();
+
+    /**
+     * Records that a write transaction has committed but may not yet be durable.
+     */
+    void notifyCommitted();
+
+    /**
+     * Blocks until every transaction that committed before this call is durable.
+     */
+    void waitUntilDurable();
+
+    /**
+     * Returns the number of WAL syncs performed so far.
+     */
+    uint64_t getNumSyncs() const;
+
+private:
+    class Flusher;
+
+    /**
+     * Runs the flusher loop until shutdown.
+     */
+    void _flusherLoop();
+
+    /**
+     * Syncs the WAL file of the database through '_syncSession'.
+     */
+    void _syncWal();
+
+    const Milliseconds _maxDelay;
+
+    // A dedicated connection used only to reach the WAL file handle. It is accessed solely by the
+    // thread that sets '_syncInProgress'.
+    sqlite3* _syncSession = nullptr;
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _cond;
+
+    // Number of commits registered and number of those known to be durable.
+    uint64_t _commitCount = 0;
+    uint64_t _syncedCount = 0;
+
+    // Time of the oldest commit not covered by a completed or in-progress sync, or Date_t() if
+    // there is none. The flusher syncs at most '_maxDelay' after it.
+    Date_t _oldestUnsyncedCommit;
+
+    bool _syncInProgress = false;
+    bool _shuttingDown = false;
+    uint64_t _numSyncs = 0;
+
+    std::unique_ptr<Flusher> _flusher;
+};
+}  // namespace mongo
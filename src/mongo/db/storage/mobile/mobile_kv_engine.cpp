@@ -38,6 +38,7 @@
 
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/storage/mobile/mobile_group_commit.h"
 #include "mongo/db/storage/mobile/mobile_index.h"
 #include "mongo/db/storage/mobile/mobile_kv_engine.h"
 #include "mongo/db/storage/mobile/mobile_record_store.h"
@@ -79,7 +80,9 @@ MobileKVEngine::MobileKVEngine(const std::string& path) {
     status = sqlite3_finalize(stmt);
     checkStatus(status, SQLITE_OK, "sqlite3_finalize");
 
-    _sessionPool.reset(new MobileSessionPool(_path));
+    _sessionPool.reset(new MobileSessionPool(_path,
+                                             MobileSessionPool::kDefaultMaxPoolSize,
+                                             Milliseconds(mobileGroupCommitDelayMillis)));
 }
 
 void MobileKVEngine::_initDBPath(const std::string& path) {
@@ -117,6 +120,13 @@ void MobileKVEngine::_initDBPath(const std::string& path) {
     _path = dbPath.generic_string();
 }
 
+int MobileKVEngine::flushAllFiles(OperationContext* opCtx, bool sync) {
+    if (auto groupCommit = _sessionPool->getGroupCommit()) {
+        groupCommit->waitUntilDurable();
+    }
+    return 0;
+}
+
 RecoveryUnit* MobileKVEngine::newRecoveryUnit() {
     return new MobileRecoveryUnit(_sessionPool.get());
 }
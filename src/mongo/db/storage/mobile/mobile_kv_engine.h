@@ -93,11 +93,10 @@ public:
     }
 
     /**
-     * Flush is a no-op since SQLite transactions are durable by default after each commit.
+     * SQLite transactions are durable after each commit unless group commit is enabled, in which
+     * case this syncs the write-ahead log.
      */
-    int flushAllFiles(OperationContext* opCtx, bool sync) override {
-        return 0;
-    }
+    int flushAllFiles(OperationContext* opCtx, bool sync) override;
 
     bool isEphemeral() const override {
         return false;
@@ -26,6 +26,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
 #include "mongo/platform/basic.h"
 
 #include <boost/filesystem.hpp>
@@ -44,6 +46,8 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 
 namespace mongo {
@@ -54,7 +58,8 @@ static int inc = 0;
 
 class MobileHarnessHelper final : public RecordStoreHarnessHelper {
 public:
-    MobileHarnessHelper() : _dbPath("mobile_record_store_harness") {
+    explicit MobileHarnessHelper(Milliseconds groupCommitDelay = Milliseconds(0))
+        : _dbPath("mobile_record_store_harness") {
         // TODO: Determine if this should be util function.
         boost::system::error_code err;
         boost::filesystem::path dir(_dbPath.path());
@@ -84,7 +89,8 @@ public:
         }
 
         _fullPath = fullPath.string();
-        _sessionPool.reset(new MobileSessionPool(_fullPath));
+        _sessionPool.reset(new MobileSessionPool(
+            _fullPath, MobileSessionPool::kDefaultMaxPoolSize, groupCommitDelay));
     }
 
     std::unique_ptr<RecordStore> newNonCappedRecordStore() override {
@@ -125,6 +131,10 @@ public:
         return false;
     }
 
+    MobileSessionPool* getSessionPool() {
+        return _sessionPool.get();
+    }
+
 private:
     unittest::TempDir _dbPath;
     std::string _fullPath;
@@ -139,5 +149,64 @@ MONGO_INITIALIZER(RegisterHarnessFactory)(InitializerContext* const) {
     mongo::registerHarnessHelperFactory(makeHarnessHelper);
     return Status::OK();
 }
+
+const int kNumBenchmarkInserts = 1000;
+
+/**
+ * Inserts kNumBenchmarkInserts records, each in its own WriteUnitOfWork, and logs the achieved
+ * throughput. When 'waitEach' is set, every insert also waits for durability.
+ */
+void runInsertBenchmark(MobileHarnessHelper* harnessHelper, StringData name, bool waitEach) {
+    std::unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+    const std::string data = "benchmark record";
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    Timer timer;
+    for (int i = 0; i < kNumBenchmarkInserts; i++) {
+        WriteUnitOfWork uow(opCtx.get());
+        ASSERT_OK(rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp(), false)
+                      .getStatus());
+        uow.commit();
+        if (waitEach) {
+            opCtx->recoveryUnit()->waitUntilDurable();
+        }
+    }
+    opCtx->recoveryUnit()->waitUntilDurable();
+
+    const long long micros = std::max(timer.micros(), 1LL);
+    log() << name << ": " << kNumBenchmarkInserts << " inserts in " << micros / 1000 << "ms ("
+          << kNumBenchmarkInserts * 1000 * 1000LL / micros << " inserts/sec)";
+
+    ASSERT_EQUALS(kNumBenchmarkInserts, rs->numRecords(opCtx.get()));
+}
+
+TEST(MobileRecordStoreBenchmark, InsertThroughputWithoutGroupCommit) {
+    MobileHarnessHelper harnessHelper;
+    ASSERT(!harnessHelper.getSessionPool()->getGroupCommit());
+    runInsertBenchmark(&harnessHelper, "synchronous commits", false);
+}
+
+TEST(MobileRecordStoreBenchmark, InsertThroughputWithGroupCommit) {
+    MobileHarnessHelper harnessHelper(Milliseconds(100));
+    MobileGroupCommit* groupCommit = harnessHelper.getSessionPool()->getGroupCommit();
+    ASSERT(groupCommit);
+
+    runInsertBenchmark(&harnessHelper, "group commit", false);
+
+    // Commits that did not wait for durability share syncs.
+    ASSERT_GTE(groupCommit->getNumSyncs(), 1U);
+    ASSERT_LT(groupCommit->getNumSyncs(), static_cast<uint64_t>(kNumBenchmarkInserts));
+}
+
+TEST(MobileRecordStoreBenchmark, InsertThroughputWithGroupCommitWaitingEachCommit) {
+    MobileHarnessHelper harnessHelper(Milliseconds(100));
+    MobileGroupCommit* groupCommit = harnessHelper.getSessionPool()->getGroupCommit();
+    ASSERT(groupCommit);
+
+    runInsertBenchmark(&harnessHelper, "group commit, waiting for each commit", true);
+
+    // A waiter syncs right away rather than waiting for the flusher.
+    ASSERT_GTE(groupCommit->getNumSyncs(), static_cast<uint64_t>(kNumBenchmarkInserts));
+}
 }  // namespace
 }  // namespace mongo
@@ -125,6 +125,14 @@ void MobileRecoveryUnit::abortUnitOfWork() {
     _abort();
 }
 
+bool MobileRecoveryUnit::waitUntilDurable() {
+    // Without group commit, SQLite syncs every transaction as part of its COMMIT.
+    if (auto groupCommit = _sessionPool->getGroupCommit()) {
+        groupCommit->waitUntilDurable();
+    }
+    return true;
+}
+
 void MobileRecoveryUnit::abandonSnapshot() {
     invariant(!_inUnitOfWork);
     if (_active) {
@@ -210,6 +218,11 @@ void MobileRecoveryUnit::_txnClose(bool commit) {
 
     if (commit) {
         SqliteStatement::execQuery(_session.get(), "COMMIT");
+        if (!_isReadOnly) {
+            if (auto groupCommit = _sessionPool->getGroupCommit()) {
+                groupCommit->notifyCommitted();
+            }
+        }
     } else {
         SqliteStatement::execQuery(_session.get(), "ROLLBACK");
     }
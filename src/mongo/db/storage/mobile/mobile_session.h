@@ -53,6 +53,13 @@ public:
      */
     sqlite3* getSession() const;
 
+    /**
+     * Returns the pool this session belongs to.
+     */
+    MobileSessionPool* getSessionPool() const {
+        return _sessionPool;
+    }
+
 private:
     sqlite3* _session;
     MobileSessionPool* _sessionPool;
@@ -42,6 +42,7 @@
 #include "mongo/db/storage/mobile/mobile_session_pool.h"
 #include "mongo/db/storage/mobile/mobile_sqlite_statement.h"
 #include "mongo/db/storage/mobile/mobile_util.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
 
@@ -94,8 +95,14 @@ bool MobileDelayedOpQueue::isEmpty() {
     return (_isEmpty.load());
 }
 
-MobileSessionPool::MobileSessionPool(const std::string& path, std::uint64_t maxPoolSize)
-    : _path(path), _maxPoolSize(maxPoolSize) {}
+MobileSessionPool::MobileSessionPool(const std::string& path,
+                                     std::uint64_t maxPoolSize,
+                                     Milliseconds groupCommitDelay)
+    : _path(path), _maxPoolSize(maxPoolSize) {
+    if (groupCommitDelay > Milliseconds(0)) {
+        _groupCommit = stdx::make_unique<MobileGroupCommit>(_path, groupCommitDelay);
+    }
+}
 
 MobileSessionPool::~MobileSessionPool() {
     shutDown();
@@ -116,9 +123,7 @@ std::unique_ptr<MobileSession> MobileSessionPool::getSession(OperationContext* o
 
     // Checks if a new session can be opened.
     if (_curPoolSize < _maxPoolSize) {
-        sqlite3* session;
-        int status = sqlite3_open(_path.c_str(), &session);
-        checkStatus(status, SQLITE_OK, "sqlite3_open");
+        sqlite3* session = _openSession();
         _curPoolSize++;
         return stdx::make_unique<MobileSession>(session, this);
     }
@@ -166,15 +171,84 @@ void MobileSessionPool::shutDown() {
 
         int status = sqlite3_open(_path.c_str(), &session);
         checkStatus(status, SQLITE_OK, "sqlite3_open");
-        std::unique_ptr<MobileSession> mobSession = stdx::make_unique<MobileSession>(session, this);
-        LOG(MOBILE_LOG_LEVEL_LOW) << "MobileSE: Executing queued drops at shutdown";
-        failedDropsQueue.execAndDequeueAllOps(mobSession.get());
-        sqlite3_close(session);
+
+        // Destroying 'mobSession' releases the new session into the pool, which takes '_mutex'.
+        // It is closed below with the others, once its cached statements are finalized.
+        lk.unlock();
+        {
+            std::unique_ptr<MobileSession> mobSession =
+                stdx::make_unique<MobileSession>(session, this);
+            LOG(MOBILE_LOG_LEVEL_LOW) << "MobileSE: Executing queued drops at shutdown";
+            failedDropsQueue.execAndDequeueAllOps(mobSession.get());
+        }
+        lk.lock();
     }
 
+    // Make every commit durable before the connections go away.
+    _groupCommit.reset();
+
     for (auto&& session : _sessions) {
-        sqlite3_close(session);
+        _finalizeCachedStatements(session);
+        checkStatus(sqlite3_close(session), SQLITE_OK, "sqlite3_close");
+    }
+}
+
+sqlite3_stmt* MobileSessionPool::takeCachedStatement(sqlite3* session,
+                                                     const std::string& sqlQuery) {
+    stdx::lock_guard<stdx::mutex> lk(_statementCacheMutex);
+    auto cacheIt = _statementCache.find(session);
+    if (cacheIt == _statementCache.end()) {
+        return nullptr;
+    }
+
+    auto stmtIt = cacheIt->second.find(sqlQuery);
+    if (stmtIt == cacheIt->second.end()) {
+        return nullptr;
+    }
+
+    sqlite3_stmt* stmt = stmtIt->second;
+    cacheIt->second.erase(stmtIt);
+    return stmt;
+}
+
+bool MobileSessionPool::cacheStatement(sqlite3* session,
+                                       const std::string& sqlQuery,
+                                       sqlite3_stmt* stmt) {
+    stdx::lock_guard<stdx::mutex> lk(_statementCacheMutex);
+    auto& cache = _statementCache[session];
+    if (cache.size() >= kMaxCachedStatementsPerSession) {
+        return false;
+    }
+
+    cache.emplace(sqlQuery, stmt);
+    return true;
+}
+
+sqlite3* MobileSessionPool::_openSession() {
+    sqlite3* session;
+    int status = sqlite3_open(_path.c_str(), &session);
+    checkStatus(status, SQLITE_OK, "sqlite3_open");
+
+    if (_groupCommit) {
+        // With WAL journaling, NORMAL skips the sync on every COMMIT while still guaranteeing
+        // consistency. Durability is provided by the group committer instead.
+        status = sqlite3_exec(session, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
+        checkStatus(status, SQLITE_OK, "sqlite3_exec");
+    }
+    return session;
+}
+
+void MobileSessionPool::_finalizeCachedStatements(sqlite3* session) {
+    stdx::lock_guard<stdx::mutex> lk(_statementCacheMutex);
+    auto cacheIt = _statementCache.find(session);
+    if (cacheIt == _statementCache.end()) {
+        return;
+    }
+
+    for (auto&& entry : cacheIt->second) {
+        sqlite3_finalize(entry.second);
     }
+    _statementCache.erase(cacheIt);
 }
 
 // This method should only be called when _sessions is locked.
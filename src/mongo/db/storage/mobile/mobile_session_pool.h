@@ -35,8 +35,10 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/storage/mobile/mobile_group_commit.h"
 #include "mongo/db/storage/mobile/mobile_session.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
 class MobileSession;
@@ -61,13 +63,26 @@ private:
 };
 
 /**
- * This class manages a pool of open sqlite3* objects.
+ * This class manages a pool of open sqlite3* objects, along with the prepared statements cached
+ * for each of them.
  */
 class MobileSessionPool final {
     MONGO_DISALLOW_COPYING(MobileSessionPool);
 
 public:
-    MobileSessionPool(const std::string& path, std::uint64_t maxPoolSize = 80);
+    static const std::uint64_t kDefaultMaxPoolSize = 80;
+
+    /**
+     * Maximum number of prepared statements kept per open session.
+     */
+    static const std::size_t kMaxCachedStatementsPerSession = 64;
+
+    /**
+     * A non-zero 'groupCommitDelay' enables group commit, see MobileGroupCommit.
+     */
+    MobileSessionPool(const std::string& path,
+                      std::uint64_t maxPoolSize = kDefaultMaxPoolSize,
+                      Milliseconds groupCommitDelay = Milliseconds(0));
 
     ~MobileSessionPool();
 
@@ -87,6 +102,25 @@ public:
      */
     void shutDown();
 
+    /**
+     * Returns the group committer, or nullptr when group commit is disabled.
+     */
+    MobileGroupCommit* getGroupCommit() const {
+        return _groupCommit.get();
+    }
+
+    /**
+     * Removes and returns a statement previously prepared for 'sqlQuery' on 'session', or returns
+     * nullptr if there is none.
+     */
+    sqlite3_stmt* takeCachedStatement(sqlite3* session, const std::string& sqlQuery);
+
+    /**
+     * Caches a reset statement for reuse on 'session'. Returns false if the cache for the session
+     * is full, in which case the caller remains responsible for finalizing the statement.
+     */
+    bool cacheStatement(sqlite3* session, const std::string& sqlQuery, sqlite3_stmt* stmt);
+
     // Failed drops get queued here and get re-tried periodically
     MobileDelayedOpQueue failedDropsQueue;
 
@@ -96,6 +130,16 @@ private:
      */
     sqlite3* _popSession_inlock();
 
+    /**
+     * Opens a new connection to the database file.
+     */
+    sqlite3* _openSession();
+
+    /**
+     * Finalizes every statement cached for 'session'.
+     */
+    void _finalizeCachedStatements(sqlite3* session);
+
     // This is used to lock the _sessions vector.
     stdx::mutex _mutex;
     stdx::condition_variable _releasedSessionNotifier;
@@ -111,5 +155,13 @@ private:
 
     using SessionPool = std::vector<sqlite3*>;
     SessionPool _sessions;
+
+    std::unique_ptr<MobileGroupCommit> _groupCommit;
+
+    // Guards _statementCache. Statements are returned from any thread holding the session, so this
+    // is separate from _mutex.
+    stdx::mutex _statementCacheMutex;
+    using StatementCache = std::unordered_multimap<std::string, sqlite3_stmt*>;
+    stdx::unordered_map<sqlite3*, StatementCache> _statementCache;
 };
 }  // namespace mongo
@@ -46,12 +46,20 @@ namespace mongo {
 
 AtomicInt64 SqliteStatement::_nextID(0);
 
-SqliteStatement::SqliteStatement(const MobileSession& session, const std::string& sqlQuery) {
+SqliteStatement::SqliteStatement(const MobileSession& session, const std::string& sqlQuery)
+    : _session(session.getSession()), _sessionPool(session.getSessionPool()), _sqlQuery(sqlQuery) {
     // Increment the global instance count and assign this instance an id.
     _id = _nextID.addAndFetch(1);
+
+    _stmt = _sessionPool->takeCachedStatement(_session, _sqlQuery);
+    if (_stmt) {
+        SQLITE_STMT_TRACE() << "Reusing cached statement: " << sqlQuery;
+        return;
+    }
+
     SQLITE_STMT_TRACE() << "Preparing: " << sqlQuery;
-    int status = sqlite3_prepare_v2(
-        session.getSession(), sqlQuery.c_str(), sqlQuery.length() + 1, &_stmt, NULL);
+    int status =
+        sqlite3_prepare_v2(_session, sqlQuery.c_str(), sqlQuery.length() + 1, &_stmt, NULL);
     if (status == SQLITE_BUSY) {
         SQLITE_STMT_TRACE() << "Throwing writeConflictException, "
                             << "SQLITE_BUSY while preparing: " << sqlQuery;
@@ -65,8 +73,15 @@ SqliteStatement::SqliteStatement(const MobileSession& session, const std::string
 }
 
 SqliteStatement::~SqliteStatement() {
-    int status = sqlite3_finalize(_stmt);
+    // Like sqlite3_finalize, sqlite3_reset returns the error of the most recent failed step. The
+    // reset also releases any read transaction the statement holds open.
+    int status = sqlite3_reset(_stmt);
     fassert(37053, status == _exceptionStatus);
+
+    sqlite3_clear_bindings(_stmt);
+    if (!_sessionPool->cacheStatement(_session, _sqlQuery, _stmt)) {
+        sqlite3_finalize(_stmt);
+    }
 }
 
 void SqliteStatement::bindInt(int paramIndex, int64_t intValue) {
@@ -43,12 +43,14 @@ namespace mongo {
 class SqliteStatement final {
 public:
     /**
-     * Creates and prepares a SQLite statement.
+     * Creates and prepares a SQLite statement, reusing a statement previously prepared for the
+     * same query on the same session when one is cached.
      */
     SqliteStatement(const MobileSession& session, const std::string& sqlQuery);
 
     /**
-     * Finalizes the prepared statement.
+     * Resets the prepared statement and returns it to the session's statement cache, or finalizes
+     * it if the cache is full.
      */
     ~SqliteStatement();
 
@@ -122,6 +124,10 @@ private:
     static AtomicInt64 _nextID;
     sqlite3_stmt* _stmt;
 
+    sqlite3* _session;
+    MobileSessionPool* _sessionPool;
+    std::string _sqlQuery;
+
     // If the most recent call to sqlite3_step on this statement returned an error, the error is
     // returned again when the statement is finalized. This is used to verify that the last error
     // code returned matches the finalize error code, if there is any.
@@ -38,6 +38,7 @@
 #include "mongo/db/repl/read_concern_level.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/storage/snapshot.h"
+#include "mongo/util/future.h"
 
 namespace mongo {
 
@@ -98,6 +99,17 @@ public:
      */
     virtual bool waitUntilDurable() = 0;
 
+    /**
+     * Asynchronous version of waitUntilDurable(). The returned Future becomes ready once all
+     * commits that happened before this call are durable in the journal, which lets callers
+     * attach continuations or overlap the flush with other waits. Storage engines that batch
+     * journal flushes complete it from their flusher thread. The default implementation waits
+     * synchronously and returns a ready Future.
+     */
+    virtual Future<void> waitUntilDurableAsync() {
+        return makeReadyFutureWith([this] { waitUntilDurable(); });
+    }
+
     /**
      * Unlike `waitUntilDurable`, this method takes a stable checkpoint, making durable any writes
      * on unjournaled tables that are behind the current stable timestamp. If the storage engine
@@ -381,6 +381,16 @@ public:
         return {};
     }
 
+    /**
+     * Like newRandomCursor(), for a caller which intends to draw about 'numSamples' entries.
+     * Storage engines which can use that number to spread the entries returned more evenly over
+     * the index should override this.
+     */
+    virtual std::unique_ptr<Cursor> newSamplingCursor(OperationContext* opCtx,
+                                                      long long numSamples) const {
+        return newRandomCursor(opCtx);
+    }
+
     //
     // Index creation
     //
@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/timestamp.h"
 #include "mongo/util/mongoutils/str.h"
@@ -273,6 +274,35 @@ public:
         return;
     }
 
+    /**
+     * A file that belongs to a non-blocking backup. 'filename' is relative to the dbpath and only
+     * the first 'fileSize' bytes of the file are part of the backup.
+     */
+    struct BackupFile {
+        std::string filename;
+        std::uint64_t fileSize;
+    };
+
+    /**
+     * Pins the most recent checkpoint so that the files making it up, together with the journal
+     * files needed to recover it, can be copied while writes continue. Returns those files.
+     *
+     * Only one non-blocking backup may be open at a time. Storage engines that do not support
+     * this feature should use the default implementation. Storage engines that implement this
+     * must also implement endNonBlockingBackup().
+     */
+    virtual StatusWith<std::vector<BackupFile>> beginNonBlockingBackup(OperationContext* opCtx) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The current storage engine doesn't support non-blocking backups");
+    }
+
+    /**
+     * Releases the checkpoint pinned by beginNonBlockingBackup().
+     */
+    virtual void endNonBlockingBackup(OperationContext* opCtx) {
+        return;
+    }
+
     /**
      * Recover as much data as possible from a potentially corrupt RecordStore.
      * This only recovers the record data, not indexes or anything else.
@@ -0,0 +1,181 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem/operations.hpp>
+#include <wiredtiger.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+const int kNumDocuments = 20 * 1000;
+
+// A small cache keeps the scans reading, and therefore decompressing, pages from disk.
+const char* kOpenConfig = "create,cache_size=32MB,log=(enabled=false)";
+const char* kTableUri = "table:corpus";
+
+const char* const kWords[] = {"order",  "shipped", "pending", "customer", "priority", "return",
+                              "refund", "gift",    "express", "delayed",  "address",  "invoice",
+                              "the",    "a",       "and",     "of",       "to",       "with"};
+const char* const kCities[] = {"New York", "Dublin", "Sydney", "Austin", "Berlin", "Toronto"};
+const char* const kStatuses[] = {"new", "paid", "shipped", "delivered", "cancelled"};
+
+template <typename T, size_t N>
+const T& pick(PseudoRandom& random, const T (&values)[N]) {
+    return values[random.nextInt32(N)];
+}
+
+/**
+ * Generates an order document resembling those of an archival e-commerce collection: a mix of
+ * repetitive field names and enum-like strings, free text, dates and numeric arrays.
+ */
+BSONObj makeDocument(PseudoRandom& random, int id) {
+    BSONObjBuilder bob;
+    bob.append("_id", id);
+    bob.appendDate("createdAt", Date_t::fromMillisSinceEpoch(1500000000000LL + id * 1000LL));
+    bob.append("status", pick(random, kStatuses));
+    {
+        BSONObjBuilder customer(bob.subobjStart("customer"));
+        customer.append("customerId", random.nextInt32(100 * 1000));
+        customer.append("email", str::stream() << "user" << random.nextInt32(100 * 1000)
+                                               << "@example.com");
+        BSONObjBuilder address(customer.subobjStart("address"));
+        address.append("street", str::stream() << random.nextInt32(1000) << " Main Street");
+        address.append("city", pick(random, kCities));
+        address.append("zip", str::stream() << 10000 + random.nextInt32(90000));
+    }
+    {
+        BSONArrayBuilder items(bob.subarrayStart("items"));
+        const int numItems = 1 + random.nextInt32(5);
+        for (int i = 0; i < numItems; i++) {
+            BSONObjBuilder item(items.subobjStart());
+            item.append("sku", str::stream() << "SKU-" << random.nextInt32(5000));
+            item.append("quantity", 1 + random.nextInt32(4));
+            item.append("price", random.nextInt32(20000) / 100.0);
+        }
+    }
+    {
+        StringBuilder notes;
+        const int numWords = random.nextInt32(40);
+        for (int i = 0; i < numWords; i++) {
+            notes << pick(random, kWords) << ' ';
+        }
+        bob.append("notes", notes.str());
+    }
+    return bob.obj();
+}
+
+/**
+ * Loads the corpus into a table created with 'blockCompressor' and returns the total size of the
+ * uncompressed documents.
+ */
+int64_t loadCorpus(WT_CONNECTION* conn, StringData blockCompressor) {
+    WT_SESSION* session;
+    invariantWTOK(conn->open_session(conn, nullptr, nullptr, &session));
+
+    const std::string config = str::stream() << "key_format=q,value_format=u,block_compressor="
+                                             << blockCompressor;
+    invariantWTOK(session->create(session, kTableUri, config.c_str()));
+
+    WT_CURSOR* cursor;
+    invariantWTOK(session->open_cursor(session, kTableUri, nullptr, "bulk", &cursor));
+
+    PseudoRandom random(1);
+    int64_t rawBytes = 0;
+    for (int id = 0; id < kNumDocuments; id++) {
+        BSONObj doc = makeDocument(random, id);
+        WiredTigerItem value(doc.objdata(), doc.objsize());
+        cursor->set_key(cursor, static_cast<int64_t>(id));
+        cursor->set_value(cursor, value.Get());
+        invariantWTOK(cursor->insert(cursor));
+        rawBytes += doc.objsize();
+    }
+    invariantWTOK(cursor->close(cursor));
+    invariantWTOK(session->checkpoint(session, nullptr));
+    invariantWTOK(session->close(session, nullptr));
+    return rawBytes;
+}
+
+/**
+ * Measures full scans of a corpus stored with the given block compressor, each scan starting from
+ * a freshly opened connection so that every page is read from disk and decompressed. Reports the
+ * compression ratio achieved on the corpus alongside the read throughput.
+ */
+void BM_ColdScan(benchmark::State& state, const char* blockCompressor) {
+    unittest::TempDir dbpath("wt_compression_bm");
+
+    WT_CONNECTION* conn;
+    invariantWTOK(wiredtiger_open(dbpath.path().c_str(), nullptr, kOpenConfig, &conn));
+    const int64_t rawBytes = loadCorpus(conn, blockCompressor);
+    invariantWTOK(conn->close(conn, nullptr));
+
+    const auto fileSize = boost::filesystem::file_size(dbpath.path() + "/corpus.wt");
+
+    for (auto keepRunning : state) {
+        invariantWTOK(wiredtiger_open(dbpath.path().c_str(), nullptr, kOpenConfig, &conn));
+        WT_SESSION* session;
+        invariantWTOK(conn->open_session(conn, nullptr, nullptr, &session));
+        WT_CURSOR* cursor;
+        invariantWTOK(session->open_cursor(session, kTableUri, nullptr, nullptr, &cursor));
+
+        int64_t scannedBytes = 0;
+        int ret;
+        while ((ret = cursor->next(cursor)) == 0) {
+            WT_ITEM value;
+            invariantWTOK(cursor->get_value(cursor, &value));
+            scannedBytes += value.size;
+        }
+        invariant(ret == WT_NOTFOUND);
+        invariant(scannedBytes == rawBytes);
+        benchmark::DoNotOptimize(scannedBytes);
+
+        invariantWTOK(conn->close(conn, nullptr));
+    }
+
+    state.SetBytesProcessed(state.iterations() * rawBytes);
+    state.SetItemsProcessed(state.iterations() * kNumDocuments);
+    state.counters["compressionRatio"] = static_cast<double>(rawBytes) / fileSize;
+    state.counters["fileBytes"] = fileSize;
+}
+
+BENCHMARK_CAPTURE(BM_ColdScan, none, "none")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ColdScan, snappy, "snappy")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ColdScan, zlib, "zlib")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ColdScan, zstd, "zstd")->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mongo
@@ -153,6 +153,14 @@ StatusWith<std::string> WiredTigerIndex::parseIndexOptions(const BSONObj& option
                 return status;
             }
             ss << elem.valueStringData() << ',';
+        } else if (elem.fieldNameStringData() == "blockCompressor" ||
+                   elem.fieldNameStringData() == "prefixCompression") {
+            StatusWith<std::string> compressionConfig =
+                WiredTigerUtil::parseCompressionOption(elem);
+            if (!compressionConfig.isOK()) {
+                return compressionConfig;
+            }
+            ss << compressionConfig.getValue();
         } else {
             // Return error on first unrecognized field.
             return StatusWith<std::string>(ErrorCodes::InvalidOptions,
@@ -1223,8 +1231,156 @@ private:
     }
 };
 
+/**
+ * Returns index entries chosen at random by a WiredTiger cursor opened with the 'next_random'
+ * configuration and 'config'. Since such a cursor cannot be positioned, only next() is supported.
+ */
+class WiredTigerIndexRandomCursor final : public SortedDataInterface::Cursor {
+public:
+    WiredTigerIndexRandomCursor(const WiredTigerIndex& idx,
+                                OperationContext* opCtx,
+                                std::string config)
+        : _opCtx(opCtx),
+          _idx(idx),
+          _config(std::move(config)),
+          _key(idx.keyStringVersion()),
+          _typeBits(idx.keyStringVersion()) {
+        restore();
+    }
+
+    ~WiredTigerIndexRandomCursor() {
+        if (_cursor)
+            detachFromOperationContext();
+    }
+
+    boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
+        int ret = wiredTigerPrepareConflictRetry(_opCtx, [&] { return _cursor->next(_cursor); });
+        if (ret == WT_NOTFOUND)
+            return {};
+        invariantWTOK(ret);
+
+        WT_ITEM keyItem;
+        invariantWTOK(_cursor->get_key(_cursor, &keyItem));
+        _key.resetFromBuffer(keyItem.data, keyItem.size);
+
+        WT_ITEM valueItem;
+        invariantWTOK(_cursor->get_value(_cursor, &valueItem));
+        BufReader br(valueItem.data, valueItem.size);
+
+        // Keys of _id indexes and of unique indexes in the timestamp unsafe format hold only the
+        // index key and their RecordId is in the value. All other keys end with their RecordId.
+        RecordId id;
+        const auto keySize = KeyString::getKeySize(
+            _key.getBuffer(), _key.getSize(), _idx.ordering(), _key.getTypeBits());
+        if (_key.getSize() == keySize) {
+            id = KeyString::decodeRecordId(&br);
+        } else {
+            id = KeyString::decodeRecordIdAtEnd(_key.getBuffer(), _key.getSize());
+        }
+        _typeBits.resetFromBuffer(&br);
+
+        BSONObj bson;
+        if (parts & kWantKey) {
+            bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits);
+        }
+
+        return {{std::move(bson), id}};
+    }
+
+    void save() override {
+        if (_cursor && !wt_keeptxnopen()) {
+            try {
+                _cursor->reset(_cursor);
+            } catch (const WriteConflictException&) {
+                // Ignore since this is only called when we are about to kill our transaction
+                // anyway.
+            }
+        }
+    }
+
+    void saveUnpositioned() override {
+        save();
+    }
+
+    void restore() override {
+        // We can't use the CursorCache since this cursor needs a special config string.
+        WT_SESSION* session = WiredTigerRecoveryUnit::get(_opCtx)->getSession()->getSession();
+
+        if (!_cursor) {
+            invariantWTOK(session->open_cursor(
+                session, _idx.uri().c_str(), nullptr, _config.c_str(), &_cursor));
+            invariant(_cursor);
+        }
+    }
+
+    void detachFromOperationContext() override {
+        invariant(_opCtx);
+        _opCtx = nullptr;
+        if (_cursor) {
+            invariantWTOK(_cursor->close(_cursor));
+        }
+        _cursor = nullptr;
+    }
+
+    void reattachToOperationContext(OperationContext* opCtx) override {
+        invariant(!_opCtx);
+        _opCtx = opCtx;
+    }
+
+    //
+    // Should never be called.
+    //
+    void setEndPosition(const BSONObj& key, bool inclusive) override {
+        MONGO_UNREACHABLE;
+    }
+    boost::optional<IndexKeyEntry> seek(const BSONObj& key,
+                                        bool inclusive,
+                                        RequestedInfo parts) override {
+        MONGO_UNREACHABLE;
+    }
+    boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
+                                        RequestedInfo parts) override {
+        MONGO_UNREACHABLE;
+    }
+
+private:
+    OperationContext* _opCtx;
+    WT_CURSOR* _cursor = nullptr;
+    const WiredTigerIndex& _idx;  // not owned
+    const std::string _config;
+
+    KeyString _key;
+    KeyString::TypeBits _typeBits;
+};
+
 }  // namespace
 
+std::unique_ptr<SortedDataInterface::Cursor> WiredTigerIndex::newRandomCursor(
+    OperationContext* opCtx) const {
+    // Prefixed indexes share their table with other indexes, whose entries a random cursor would
+    // return as well
+    if (_prefix != KVPrefix::kNotPrefixed) {
+        return {};
+    }
+
+    return stdx::make_unique<WiredTigerIndexRandomCursor>(*this, opCtx, "next_random");
+}
+
+std::unique_ptr<SortedDataInterface::Cursor> WiredTigerIndex::newSamplingCursor(
+    OperationContext* opCtx, long long numSamples) const {
+    if (_prefix != KVPrefix::kNotPrefixed) {
+        return {};
+    }
+
+    // Without a sample size, every entry is drawn from a random leaf page, which favors the
+    // entries of sparsely filled pages. With one, the cursor skips the same number of leaf pages
+    // between consecutive entries, spreading 'numSamples' entries evenly over the index.
+    return stdx::make_unique<WiredTigerIndexRandomCursor>(
+        *this,
+        opCtx,
+        str::stream() << "next_random,next_random_sample_size=" << std::max(numSamples, 1LL));
+}
+
 WiredTigerIndexUnique::WiredTigerIndexUnique(OperationContext* ctx,
                                              const std::string& uri,
                                              const IndexDescriptor* desc,
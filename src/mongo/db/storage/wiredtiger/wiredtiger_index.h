@@ -118,6 +118,12 @@ public:
 
     virtual Status compact(OperationContext* opCtx);
 
+    virtual std::unique_ptr<SortedDataInterface::Cursor> newRandomCursor(
+        OperationContext* opCtx) const;
+
+    virtual std::unique_ptr<SortedDataInterface::Cursor> newSamplingCursor(
+        OperationContext* opCtx, long long numSamples) const;
+
     const std::string& uri() const {
         return _uri;
     }
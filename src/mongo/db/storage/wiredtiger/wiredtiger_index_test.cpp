@@ -93,5 +93,36 @@ TEST(WiredTigerIndexTest, GenerateCreateStringValidConfigStringOption) {
     ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string("prefix_compression=true,"));
 }
 
+TEST(WiredTigerIndexTest, GenerateCreateStringBlockCompressorOption) {
+    BSONObj spec = fromjson("{blockCompressor: 'zlib'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string("block_compressor=zlib,"));
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringUnsupportedBlockCompressor) {
+    BSONObj spec = fromjson("{blockCompressor: 'lzma'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), ErrorCodes::InvalidOptions);
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringZstdBlockCompressor) {
+    BSONObj spec = fromjson("{blockCompressor: 'zstd'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string("block_compressor=zstd,"));
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringNonStringBlockCompressor) {
+    BSONObj spec = fromjson("{blockCompressor: 1}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), ErrorCodes::TypeMismatch);
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringPrefixCompressionOption) {
+    BSONObj spec = fromjson("{prefixCompression: false, blockCompressor: 'none'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec),
+              std::string("prefix_compression=false,block_compressor=none,"));
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringNonBooleanPrefixCompression) {
+    BSONObj spec = fromjson("{prefixCompression: 'yes'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), ErrorCodes::TypeMismatch);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -217,22 +217,30 @@ public:
 
         LOG(1) << "starting " << name() << " thread";
 
-        while (!_shuttingDown.load()) {
-            try {
-                const bool forceCheckpoint = false;
-                const bool stableCheckpoint = false;
-                _sessionCache->waitUntilDurable(forceCheckpoint, stableCheckpoint);
-            } catch (const AssertionException& e) {
-                invariant(e.code() == ErrorCodes::ShutdownInProgress);
-            }
+        // Durability requests made through the session cache are batched and serviced by this
+        // thread from now on. Besides those, the journal is flushed at least once per commit
+        // interval.
+        _sessionCache->setGroupCommitEnabled(true);
 
+        while (!_shuttingDown.load()) {
             int ms = storageGlobalParams.journalCommitIntervalMs.load();
             if (!ms) {
                 ms = kDefaultJournalDelayMillis;
             }
 
-            MONGO_IDLE_THREAD_BLOCK;
-            sleepmillis(ms);
+            try {
+                _sessionCache->flushJournalForQueuedWaiters(Milliseconds(ms));
+            } catch (const AssertionException& e) {
+                invariant(e.code() == ErrorCodes::ShutdownInProgress);
+            }
+        }
+
+        // Complete any requests that were queued before group commit was turned off.
+        _sessionCache->setGroupCommitEnabled(false);
+        try {
+            _sessionCache->flushJournalForQueuedWaiters(Milliseconds(0));
+        } catch (const AssertionException& e) {
+            invariant(e.code() == ErrorCodes::ShutdownInProgress);
         }
         LOG(1) << "stopping " << name() << " thread";
     }
@@ -755,6 +763,62 @@ void WiredTigerKVEngine::endBackup(OperationContext* opCtx) {
     _backupSession.reset();
 }
 
+StatusWith<std::vector<StorageEngine::BackupFile>> WiredTigerKVEngine::beginNonBlockingBackup(
+    OperationContext* opCtx) {
+    if (_ephemeral) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The inMemory storage engine doesn't support non-blocking backups");
+    }
+    if (_nonBlockingBackupSession) {
+        return Status(ErrorCodes::ConflictingOperationInProgress,
+                      "A non-blocking backup is already in progress");
+    }
+
+    // The backup cursor pins the last checkpoint until it is closed. It will be freed by the
+    // session being closed as the session is uncached.
+    auto session = stdx::make_unique<WiredTigerSession>(_conn);
+    WT_CURSOR* c = NULL;
+    WT_SESSION* s = session->getSession();
+    int ret = WT_OP_CHECK(s->open_cursor(s, "backup:", NULL, NULL, &c));
+    if (ret != 0) {
+        return wtRCToStatus(ret);
+    }
+
+    std::vector<StorageEngine::BackupFile> files;
+    const char* filename;
+    while ((ret = c->next(c)) == 0) {
+        invariantWTOK(c->get_key(c, &filename));
+        // Log files live in the journal directory, but are reported by name only.
+        boost::filesystem::path relativePath;
+        if (StringData(filename).startsWith("WiredTigerLog.")) {
+            relativePath /= "journal";
+        }
+        relativePath /= filename;
+
+        boost::system::error_code errorCode;
+        const auto fileSize =
+            boost::filesystem::file_size(boost::filesystem::path(_path) / relativePath, errorCode);
+        if (errorCode) {
+            return Status(ErrorCodes::UnknownError,
+                          str::stream() << "Failed to get the size of backup file "
+                                        << relativePath.string()
+                                        << ": "
+                                        << errorCode.message());
+        }
+        files.push_back({relativePath.string(), static_cast<std::uint64_t>(fileSize)});
+    }
+    if (ret != WT_NOTFOUND) {
+        return wtRCToStatus(ret);
+    }
+
+    _nonBlockingBackupSession = std::move(session);
+    return std::move(files);
+}
+
+void WiredTigerKVEngine::endNonBlockingBackup(OperationContext* opCtx) {
+    _nonBlockingBackupSession.reset();
+}
+
 void WiredTigerKVEngine::syncSizeInfo(bool sync) const {
     if (!_sizeStorer)
         return;
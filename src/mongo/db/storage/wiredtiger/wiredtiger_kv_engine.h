@@ -161,6 +161,11 @@ public:
 
     virtual void endBackup(OperationContext* opCtx);
 
+    StatusWith<std::vector<StorageEngine::BackupFile>> beginNonBlockingBackup(
+        OperationContext* opCtx) override;
+
+    void endNonBlockingBackup(OperationContext* opCtx) override;
+
     virtual int64_t getIdentSize(OperationContext* opCtx, StringData ident);
 
     virtual Status repairIdent(OperationContext* opCtx, StringData ident);
@@ -340,6 +345,8 @@ private:
     mutable Date_t _previousCheckedDropsQueued;
 
     std::unique_ptr<WiredTigerSession> _backupSession;
+    // Holds the backup cursor of the open non-blocking backup, if any.
+    std::unique_ptr<WiredTigerSession> _nonBlockingBackupSession;
     Timestamp _recoveryTimestamp;
     WiredTigerFileVersion _fileVersion;
 
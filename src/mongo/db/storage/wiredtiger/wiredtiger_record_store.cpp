@@ -47,6 +47,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/server_recovery.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
@@ -106,6 +107,18 @@ const std::string kWiredTigerEngineName = "wiredTiger";
 // cursors will be available in the needed session caches.
 static int kCappedDocumentRemoveLimit = 3;
 
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerOplogAdaptiveStoneSizing, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerOplogTruncationTimeBudgetMillis, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "wiredTigerOplogTruncationTimeBudgetMillis must be greater than or equal "
+                          "to 0");
+        }
+        return Status::OK();
+    });
+
 class WiredTigerRecordStore::OplogStones::InsertChange final : public RecoveryUnit::Change {
 public:
     InsertChange(OplogStones* oplogStones,
@@ -123,7 +136,7 @@ public:
 
         _oplogStones->_currentRecords.addAndFetch(_countInserted);
         int64_t newCurrentBytes = _oplogStones->_currentBytes.addAndFetch(_bytesInserted);
-        if (newCurrentBytes >= _oplogStones->_minBytesPerStone) {
+        if (newCurrentBytes >= _oplogStones->_minBytesPerStone.load()) {
             _oplogStones->createNewStoneIfNeeded(_highestInserted);
         }
     }
@@ -161,15 +174,11 @@ WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* opCtx, WiredTi
 
     invariant(rs->isCapped());
     invariant(rs->cappedMaxSize() > 0);
-    unsigned long long maxSize = rs->cappedMaxSize();
-
-    const unsigned long long kMinStonesToKeep = 10ULL;
-    const unsigned long long kMaxStonesToKeep = 100ULL;
+    int64_t maxSize = rs->cappedMaxSize();
 
-    unsigned long long numStones = maxSize / BSONObjMaxInternalSize;
-    size_t numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
-    _minBytesPerStone = maxSize / numStonesToKeep;
-    invariant(_minBytesPerStone > 0);
+    _minBytesPerStone.store(
+        computeMinBytesPerStone(maxSize, wiredTigerOplogAdaptiveStoneSizing.load(), 0));
+    size_t numStonesToKeep = maxSize / _minBytesPerStone.load();
 
     _calculateStones(opCtx, numStonesToKeep);
     _pokeReclaimThreadIfNeeded();  // Reclaim stones if over the limit.
@@ -219,6 +228,94 @@ void WiredTigerRecordStore::OplogStones::popOldestStone() {
     _stones.pop_front();
 }
 
+void WiredTigerRecordStore::OplogStones::updateOldestStoneAfterPartialTruncate(
+    int64_t recordsRemoved, int64_t bytesRemoved) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(!_stones.empty());
+
+    // The stone's size may have been estimated by sampling, so don't let it go negative.
+    Stone& oldest = _stones.front();
+    oldest.records = std::max(int64_t(0), oldest.records - recordsRemoved);
+    oldest.bytes = std::max(int64_t(0), oldest.bytes - bytesRemoved);
+}
+
+int64_t WiredTigerRecordStore::OplogStones::excessBytes() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    int64_t totalBytes = 0;
+    for (const auto& stone : _stones) {
+        totalBytes += stone.bytes;
+    }
+    return std::max(int64_t(0), totalBytes - _rs->cappedMaxSize());
+}
+
+int64_t WiredTigerRecordStore::OplogStones::truncateRangeBytesForBudget(
+    int64_t remainingMillis) const {
+    // Used until the throughput of truncate calls has been measured.
+    const int64_t kInitialTruncateRangeBytes = 16 * 1024 * 1024;
+    // Lower bound so that a slow truncate doesn't degenerate into removing single records.
+    const int64_t kMinTruncateRangeBytes = 64 * 1024;
+
+    const int64_t bytesPerMilli = _truncateBytesPerMilli.load();
+    if (bytesPerMilli <= 0) {
+        return kInitialTruncateRangeBytes;
+    }
+    return std::max(kMinTruncateRangeBytes, bytesPerMilli * remainingMillis);
+}
+
+void WiredTigerRecordStore::OplogStones::recordTruncate(int64_t bytesRemoved,
+                                                        Microseconds duration) {
+    _truncateCount.fetchAndAdd(1);
+    _totalTimeTruncatingMicros.fetchAndAdd(durationCount<Microseconds>(duration));
+
+    const int64_t micros = durationCount<Microseconds>(duration);
+    if (micros <= 0 || bytesRemoved <= 0) {
+        return;
+    }
+
+    // Smooth the observed throughput so that a single slow or fast call doesn't swing the size of
+    // the next truncate range.
+    const int64_t observed = std::max(int64_t(1), bytesRemoved * 1000 / micros);
+    const int64_t previous = _truncateBytesPerMilli.load();
+    _truncateBytesPerMilli.store(previous <= 0 ? observed : (3 * previous + observed) / 4);
+}
+
+void WiredTigerRecordStore::OplogStones::recordReclaimPass(int64_t recordsRemoved,
+                                                           int64_t bytesRemoved,
+                                                           Milliseconds duration) {
+    _reclaimPasses.fetchAndAdd(1);
+    _totalBytesReclaimed.fetchAndAdd(bytesRemoved);
+    _lastPassRecordsReclaimed.store(recordsRemoved);
+    _lastPassBytesReclaimed.store(bytesRemoved);
+    _lastPassMillis.store(durationCount<Milliseconds>(duration));
+}
+
+void WiredTigerRecordStore::OplogStones::getOplogTruncateStats(BSONObjBuilder& builder) const {
+    size_t numStones;
+    double insertBytesPerSecond;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        numStones = _stones.size();
+        insertBytesPerSecond = _insertBytesPerSecond;
+    }
+
+    builder.append("adaptiveStoneSizing", wiredTigerOplogAdaptiveStoneSizing.load());
+    builder.append("minBytesPerStone", static_cast<long long>(_minBytesPerStone.load()));
+    builder.append("numStones", static_cast<long long>(numStones));
+    builder.append("insertBytesPerSecond", insertBytesPerSecond);
+    builder.append("truncationLagBytes", static_cast<long long>(excessBytes()));
+    builder.append("truncateCount", static_cast<long long>(_truncateCount.load()));
+    builder.append("totalTimeTruncatingMicros",
+                   static_cast<long long>(_totalTimeTruncatingMicros.load()));
+    builder.append("passes", static_cast<long long>(_reclaimPasses.load()));
+    builder.append("totalBytesReclaimed", static_cast<long long>(_totalBytesReclaimed.load()));
+
+    BSONObjBuilder lastPass(builder.subobjStart("lastPass"));
+    lastPass.append("recordsReclaimed", static_cast<long long>(_lastPassRecordsReclaimed.load()));
+    lastPass.append("bytesReclaimed", static_cast<long long>(_lastPassBytesReclaimed.load()));
+    lastPass.append("durationMillis", static_cast<long long>(_lastPassMillis.load()));
+    lastPass.done();
+}
+
 void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRecord) {
     stdx::unique_lock<stdx::mutex> lk(_mutex, stdx::try_to_lock);
     if (!lk) {
@@ -227,7 +324,7 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
         return;
     }
 
-    if (_currentBytes.load() < _minBytesPerStone) {
+    if (_currentBytes.load() < _minBytesPerStone.load()) {
         // Must have raced to create a new stone, someone else already triggered it.
         return;
     }
@@ -243,6 +340,12 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
     OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
     _stones.push_back(stone);
 
+    _updateInsertRate_inlock(stone.bytes);
+    if (wiredTigerOplogAdaptiveStoneSizing.load()) {
+        _minBytesPerStone.store(
+            computeMinBytesPerStone(_rs->cappedMaxSize(), true, _insertBytesPerSecond));
+    }
+
     _pokeReclaimThreadIfNeeded();
 }
 
@@ -295,7 +398,53 @@ void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
 
     // Only allow changing the minimum bytes per stone if no data has been inserted.
     invariant(_stones.size() == 0 && _currentRecords.load() == 0);
-    _minBytesPerStone = size;
+    _minBytesPerStone.store(size);
+}
+
+// static
+int64_t WiredTigerRecordStore::OplogStones::computeMinBytesPerStone(int64_t maxSize,
+                                                                    bool adaptive,
+                                                                    double insertBytesPerSecond) {
+    const int64_t kMinStonesToKeep = 10;
+    const int64_t kMaxStonesToKeep = 100;
+    const int64_t kMaxStonesToKeepAdaptive = 1000;
+
+    const int64_t numStones = maxSize / BSONObjMaxInternalSize;
+    const int64_t fixedBytesPerStone =
+        maxSize / std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
+    invariant(fixedBytesPerStone > 0);
+    if (!adaptive) {
+        return fixedBytesPerStone;
+    }
+
+    // Keep the granularity proportional to the oplog's size, so that truncating one stone frees a
+    // small fraction of the oplog regardless of how large it is configured.
+    const int64_t proportionalBytesPerStone =
+        maxSize / std::min(kMaxStonesToKeepAdaptive, std::max(kMinStonesToKeep, numStones));
+
+    // Bursts of inserts would otherwise cut a stone (and wake the reclaim thread) many times a
+    // second, so let stones grow to hold about a second of inserts.
+    const int64_t rateBytesPerStone = static_cast<int64_t>(insertBytesPerSecond);
+
+    return std::min(fixedBytesPerStone, std::max(proportionalBytesPerStone, rateBytesPerStone));
+}
+
+void WiredTigerRecordStore::OplogStones::_updateInsertRate_inlock(int64_t bytesInStone) {
+    const Date_t now = Date_t::now();
+    const Date_t lastStoneCreatedAt = _lastStoneCreatedAt;
+    _lastStoneCreatedAt = now;
+    if (lastStoneCreatedAt == Date_t()) {
+        return;
+    }
+
+    const auto elapsedMillis = durationCount<Milliseconds>(now - lastStoneCreatedAt);
+    if (elapsedMillis <= 0) {
+        return;
+    }
+
+    const double observed = double(bytesInStone) * 1000 / elapsedMillis;
+    _insertBytesPerSecond =
+        _insertBytesPerSecond == 0 ? observed : 0.75 * _insertBytesPerSecond + 0.25 * observed;
 }
 
 void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCtx,
@@ -322,7 +471,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
     // Use the oplog's average record size to estimate the number of records in each stone, and thus
     // estimate the combined size of the records.
     double avgRecordSize = double(dataSize) / double(numRecords);
-    double estRecordsPerStone = std::ceil(_minBytesPerStone / avgRecordSize);
+    double estRecordsPerStone = std::ceil(_minBytesPerStone.load() / avgRecordSize);
     double estBytesPerStone = estRecordsPerStone * avgRecordSize;
 
     _calculateStonesBySampling(opCtx, int64_t(estRecordsPerStone), int64_t(estBytesPerStone));
@@ -338,7 +487,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationCon
     while (auto record = cursor->next()) {
         _currentRecords.addAndFetch(1);
         int64_t newCurrentBytes = _currentBytes.addAndFetch(record->data.size());
-        if (newCurrentBytes >= _minBytesPerStone) {
+        if (newCurrentBytes >= _minBytesPerStone.load()) {
             LOG(1) << "Placing a marker at optime "
                    << Timestamp(record->id.repr()).toStringPretty();
 
@@ -444,13 +593,8 @@ void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded() {
 
 void WiredTigerRecordStore::OplogStones::adjust(int64_t maxSize) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    const unsigned long long kMinStonesToKeep = 10ULL;
-    const unsigned long long kMaxStonesToKeep = 100ULL;
-
-    unsigned long long numStones = maxSize / BSONObjMaxInternalSize;
-    size_t numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
-    _minBytesPerStone = maxSize / numStonesToKeep;
-    invariant(_minBytesPerStone > 0);
+    _minBytesPerStone.store(computeMinBytesPerStone(
+        maxSize, wiredTigerOplogAdaptiveStoneSizing.load(), _insertBytesPerSecond));
     _pokeReclaimThreadIfNeeded();
 }
 
@@ -463,6 +607,14 @@ StatusWith<std::string> WiredTigerRecordStore::parseOptionsField(const BSONObj o
                 return status;
             }
             ss << elem.valueStringData() << ',';
+        } else if (elem.fieldNameStringData() == "blockCompressor" ||
+                   elem.fieldNameStringData() == "prefixCompression") {
+            StatusWith<std::string> compressionConfig =
+                WiredTigerUtil::parseCompressionOption(elem);
+            if (!compressionConfig.isOK()) {
+                return compressionConfig;
+            }
+            ss << compressionConfig.getValue();
         } else {
             // Return error on first unrecognized field.
             return StatusWith<std::string>(ErrorCodes::InvalidOptions,
@@ -1163,12 +1315,23 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx) {
 
 void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp persistedTimestamp) {
     Timer timer;
+    const int budgetMillis = wiredTigerOplogTruncationTimeBudgetMillis.load();
+    int64_t passRecordsRemoved = 0;
+    int64_t passBytesRemoved = 0;
+
     while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
         invariant(stone->lastRecord.isNormal());
 
         if (static_cast<std::uint64_t>(stone->lastRecord.repr()) >= persistedTimestamp.asULL()) {
             // Do not truncate oplogs needed for replication recovery.
-            return;
+            break;
+        }
+
+        const int64_t remainingMillis = budgetMillis - timer.millis();
+        if (budgetMillis > 0 && remainingMillis <= 0) {
+            LOG(1) << "Oplog truncation exhausted its time budget of " << budgetMillis
+                   << "ms, deferring the remaining work to the next pass";
+            break;
         }
 
         LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
@@ -1181,6 +1344,9 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp pers
         try {
             WriteUnitOfWork wuow(opCtx);
 
+            // Times everything that scales with the size of the truncated range, so that the
+            // learned truncation rate also accounts for finding the end of a partial range.
+            Timer truncateTimer;
             WiredTigerCursor cwrap(_uri, _tableId, true, opCtx);
             WT_CURSOR* cursor = cwrap.get();
 
@@ -1193,29 +1359,93 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp pers
                           << _oplogStones->firstRecord << ", " << stone->lastRecord << ")";
             }
 
-            setKey(cursor, stone->lastRecord);
+            RecordId truncateTo = stone->lastRecord;
+            int64_t recordsRemoved = stone->records;
+            int64_t bytesRemoved = stone->bytes;
+
+            if (budgetMillis > 0) {
+                // Only remove as much of the stone as can be truncated within the remaining
+                // budget, and never more than is needed to bring the oplog back under its cap.
+                const int64_t targetBytes =
+                    std::min(_oplogStones->excessBytes(),
+                             _oplogStones->truncateRangeBytesForBudget(remainingMillis));
+                if (targetBytes < stone->bytes && stone->records > 0 &&
+                    firstRecord <= stone->lastRecord) {
+                    // Size the partial range from the stone's average record size, so that finding
+                    // its end only steps over keys and never reads the records themselves.
+                    const int64_t avgRecordBytes =
+                        std::max(stone->bytes / stone->records, int64_t{1});
+                    const int64_t targetRecords =
+                        std::max((targetBytes + avgRecordBytes - 1) / avgRecordBytes, int64_t{1});
+
+                    truncateTo = firstRecord;
+                    recordsRemoved = 1;
+                    while (recordsRemoved < targetRecords && truncateTo < stone->lastRecord) {
+                        ret = wiredTigerPrepareConflictRetry(
+                            opCtx, [&] { return cursor->next(cursor); });
+                        if (ret == WT_NOTFOUND) {
+                            break;
+                        }
+                        invariantWTOK(ret);
+
+                        RecordId id = getKey(cursor);
+                        if (id > stone->lastRecord) {
+                            break;
+                        }
+                        truncateTo = id;
+                        ++recordsRemoved;
+                    }
+
+                    if (truncateTo == stone->lastRecord) {
+                        recordsRemoved = stone->records;
+                        bytesRemoved = stone->bytes;
+                    } else {
+                        bytesRemoved = std::min(recordsRemoved * avgRecordBytes, stone->bytes);
+                    }
+                }
+            }
+
+            setKey(cursor, truncateTo);
             invariantWTOK(session->truncate(session, nullptr, nullptr, cursor, nullptr));
-            _changeNumRecords(opCtx, -stone->records);
-            _increaseDataSize(opCtx, -stone->bytes);
+            _changeNumRecords(opCtx, -recordsRemoved);
+            _increaseDataSize(opCtx, -bytesRemoved);
 
             wuow.commit();
+            _oplogStones->recordTruncate(bytesRemoved, Microseconds(truncateTimer.micros()));
 
-            // Remove the stone after a successful truncation.
-            _oplogStones->popOldestStone();
+            if (truncateTo == stone->lastRecord) {
+                // Remove the stone after a successful truncation.
+                _oplogStones->popOldestStone();
+            } else {
+                _oplogStones->updateOldestStoneAfterPartialTruncate(recordsRemoved, bytesRemoved);
+            }
 
             // Stash the truncate point for next time to cleanly skip over tombstones, etc.
-            _oplogStones->firstRecord = stone->lastRecord;
+            _oplogStones->firstRecord = truncateTo;
+
+            passRecordsRemoved += recordsRemoved;
+            passBytesRemoved += bytesRemoved;
         } catch (const WriteConflictException&) {
             LOG(1) << "Caught WriteConflictException while truncating oplog entries, retrying";
         }
     }
 
+    _oplogStones->recordReclaimPass(
+        passRecordsRemoved, passBytesRemoved, Milliseconds(timer.millis()));
+
     LOG(1) << "Finished truncating the oplog, it now contains approximately "
            << _sizeInfo->numRecords.load() << " records totaling to " << _sizeInfo->dataSize.load()
            << " bytes";
     log() << "WiredTiger record store oplog truncation finished in: " << timer.millis() << "ms";
 }
 
+void WiredTigerRecordStore::getOplogTruncateStats(BSONObjBuilder& builder) const {
+    if (!_oplogStones) {
+        return;
+    }
+    _oplogStones->getOplogTruncateStats(builder);
+}
+
 Status WiredTigerRecordStore::insertRecords(OperationContext* opCtx,
                                             std::vector<Record>* records,
                                             std::vector<Timestamp>* timestamps,
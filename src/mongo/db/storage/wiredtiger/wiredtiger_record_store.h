@@ -264,6 +264,12 @@ public:
      */
     void reclaimOplog(OperationContext* opCtx, Timestamp persistedTimestamp);
 
+    /**
+     * Appends statistics about oplog stones and truncation to 'builder'. Appends nothing if
+     * this record store does not maintain oplog stones.
+     */
+    void getOplogTruncateStats(BSONObjBuilder& builder) const;
+
     int64_t cappedDeleteAsNeeded(OperationContext* opCtx, const RecordId& justInserted);
 
     int64_t cappedDeleteAsNeeded_inlock(OperationContext* opCtx, const RecordId& justInserted);
@@ -38,6 +38,7 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/namespace_string.h"
@@ -153,6 +154,35 @@ bool initRsOplogBackgroundThread(StringData ns) {
     return true;
 }
 
+class OplogTruncationServerStatus : public ServerStatusSection {
+public:
+    OplogTruncationServerStatus() : ServerStatusSection("oplogTruncation") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        AutoGetCollectionForRead ctx(opCtx, NamespaceString::kRsOplogNamespace);
+        Collection* oplog = ctx.getCollection();
+        if (!oplog) {
+            return BSONObj();
+        }
+
+        // The section is registered whenever WiredTiger is linked in, even if another storage
+        // engine is in use.
+        auto rs = dynamic_cast<WiredTigerRecordStore*>(oplog->getRecordStore());
+        if (!rs) {
+            return BSONObj();
+        }
+
+        BSONObjBuilder builder;
+        rs->getOplogTruncateStats(builder);
+        return builder.obj();
+    }
+} oplogTruncationServerStatus;
+
 MONGO_INITIALIZER(SetInitRsOplogBackgroundThreadCallback)(InitializerContext* context) {
     WiredTigerKVEngine::setInitRsOplogBackgroundThreadCallback(initRsOplogBackgroundThread);
     return Status::OK();
@@ -35,12 +35,23 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class OperationContext;
 class RecordId;
 
+// When true, the size of new oplog stones follows the oplog's size and recent insert rate instead
+// of being fixed when the oplog is opened or resized.
+extern AtomicBool wiredTigerOplogAdaptiveStoneSizing;
+
+// When positive, each pass of oplog truncation stops after this many milliseconds and truncates
+// the oldest stone in ranges sized to fit the budget. Zero truncates whole stones without a limit.
+extern AtomicInt32 wiredTigerOplogTruncationTimeBudgetMillis;
+
 // Keep "milestones" against the oplog to efficiently remove the old records when the collection
 // grows beyond its desired maximum size.
 class WiredTigerRecordStore::OplogStones {
@@ -73,6 +84,25 @@ public:
 
     void popOldestStone();
 
+    // Accounts for the removal of the first 'recordsRemoved' records of the oldest stone, totaling
+    // 'bytesRemoved' bytes, when it was only partially truncated.
+    void updateOldestStoneAfterPartialTruncate(int64_t recordsRemoved, int64_t bytesRemoved);
+
+    // Returns the number of bytes by which the stones exceed the oplog's maximum size.
+    int64_t excessBytes() const;
+
+    // Returns how many bytes the reclaim thread should try to truncate with a single WiredTiger
+    // truncate call to stay within 'remainingMillis', based on the throughput of earlier calls.
+    int64_t truncateRangeBytesForBudget(int64_t remainingMillis) const;
+
+    // Records the statistics of a single WiredTiger truncate call.
+    void recordTruncate(int64_t bytesRemoved, Microseconds duration);
+
+    // Records the statistics of a completed reclaim pass.
+    void recordReclaimPass(int64_t recordsRemoved, int64_t bytesRemoved, Milliseconds duration);
+
+    void getOplogTruncateStats(BSONObjBuilder& builder) const;
+
     void createNewStoneIfNeeded(RecordId lastRecord);
 
     void updateCurrentStoneAfterInsertOnCommit(OperationContext* opCtx,
@@ -111,12 +141,25 @@ public:
         return _currentRecords.load();
     }
 
+    int64_t minBytesPerStone() const {
+        return _minBytesPerStone.load();
+    }
+
     void setMinBytesPerStone(int64_t size);
 
+    // Computes the minimum size of a stone for an oplog of 'maxSize' bytes. With adaptive sizing
+    // the stones are finer grained and grow with 'insertBytesPerSecond' so that a new stone is not
+    // cut more than about once a second, but never beyond the fixed sizing's granularity.
+    static int64_t computeMinBytesPerStone(int64_t maxSize,
+                                           bool adaptive,
+                                           double insertBytesPerSecond);
+
 private:
     class InsertChange;
     class TruncateChange;
 
+    void _updateInsertRate_inlock(int64_t bytesInStone);
+
     void _calculateStones(OperationContext* opCtx, size_t size);
     void _calculateStonesByScanning(OperationContext* opCtx);
     void _calculateStonesBySampling(OperationContext* opCtx,
@@ -138,13 +181,28 @@ private:
 
     // Minimum number of bytes the stone being filled should contain before it gets added to the
     // deque of oplog stones.
-    int64_t _minBytesPerStone;
+    AtomicInt64 _minBytesPerStone;
 
     AtomicInt64 _currentRecords;  // Number of records in the stone being filled.
     AtomicInt64 _currentBytes;    // Number of bytes in the stone being filled.
 
     mutable stdx::mutex _mutex;  // Protects against concurrent access to the deque of oplog stones.
     std::deque<OplogStones::Stone> _stones;  // front = oldest, back = newest.
+
+    // Exponentially weighted moving average of the oplog insert rate, measured each time a stone
+    // is created. Protected by '_mutex'.
+    double _insertBytesPerSecond = 0;
+    Date_t _lastStoneCreatedAt;
+
+    // Truncation statistics, reported in serverStatus. Only updated by the reclaim thread.
+    AtomicInt64 _truncateBytesPerMilli;  // Observed throughput of WiredTiger truncate calls.
+    AtomicInt64 _truncateCount;
+    AtomicInt64 _totalTimeTruncatingMicros;
+    AtomicInt64 _reclaimPasses;
+    AtomicInt64 _totalBytesReclaimed;
+    AtomicInt64 _lastPassRecordsReclaimed;
+    AtomicInt64 _lastPassBytesReclaimed;
+    AtomicInt64 _lastPassMillis;
 };
 
 }  // namespace mongo
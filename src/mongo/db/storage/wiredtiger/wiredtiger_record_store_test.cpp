@@ -101,6 +101,39 @@ TEST(WiredTigerRecordStoreTest, GenerateCreateStringValidConfigStringOption) {
               std::string("prefix_compression=true,"));
 }
 
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringBlockCompressorOption) {
+    BSONObj spec = fromjson("{blockCompressor: 'zlib'}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec),
+              std::string("block_compressor=zlib,"));
+}
+
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringUnsupportedBlockCompressor) {
+    BSONObj spec = fromjson("{blockCompressor: 'lzma'}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec), ErrorCodes::InvalidOptions);
+}
+
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringZstdBlockCompressor) {
+    BSONObj spec = fromjson("{blockCompressor: 'zstd'}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec),
+              std::string("block_compressor=zstd,"));
+}
+
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringNonStringBlockCompressor) {
+    BSONObj spec = fromjson("{blockCompressor: 1}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec), ErrorCodes::TypeMismatch);
+}
+
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringPrefixCompressionOption) {
+    BSONObj spec = fromjson("{prefixCompression: false, blockCompressor: 'none'}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec),
+              std::string("prefix_compression=false,block_compressor=none,"));
+}
+
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringNonBooleanPrefixCompression) {
+    BSONObj spec = fromjson("{prefixCompression: 'yes'}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec), ErrorCodes::TypeMismatch);
+}
+
 TEST(WiredTigerRecordStoreTest, Isolation1) {
     const auto harnessHelper(newRecordStoreHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
@@ -820,6 +853,91 @@ TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStones) {
     }
 }
 
+// Verify that a time budget for oplog truncation removes only the part of the oldest stone needed
+// to bring the oplog back under cappedMaxSize.
+TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimPartialStones) {
+    std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
+
+    const int originalBudget = wiredTigerOplogTruncationTimeBudgetMillis.load();
+    wiredTigerOplogTruncationTimeBudgetMillis.store(1000);
+    ON_BLOCK_EXIT([&] { wiredTigerOplogTruncationTimeBudgetMillis.store(originalBudget); });
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(
+        harnessHelper->newCappedRecordStore("local.oplog.stones", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_OK(wtrs->updateCappedSize(opCtx.get(), 300U));
+    }
+
+    oplogStones->setMinBytesPerStone(100);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 1), 50), RecordId(1, 1));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 2), 60), RecordId(1, 2));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 3), 50), RecordId(1, 3));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 4), 60), RecordId(1, 4));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 5), 50), RecordId(1, 5));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 6), 60), RecordId(1, 6));
+
+        ASSERT_EQ(6, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(330, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_EQ(30, oplogStones->excessBytes());
+    }
+
+    // Only the first record of the oldest stone needs to go for the oplog to fit. Partial ranges
+    // are sized from the average record size of their stone, 55 bytes here.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        wtrs->reclaimOplog(opCtx.get(), Timestamp(1, 6));
+
+        ASSERT_EQ(5, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(275, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_EQ(0, oplogStones->excessBytes());
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 7), 100), RecordId(1, 7));
+
+        ASSERT_EQ(6, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(375, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(4U, oplogStones->numStones());
+        ASSERT_EQ(75, oplogStones->excessBytes());
+    }
+
+    // The remainder of the oldest stone is removed whole, then part of the next one.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        wtrs->reclaimOplog(opCtx.get(), Timestamp(1, 7));
+
+        ASSERT_EQ(4, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(265, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_EQ(0, oplogStones->excessBytes());
+    }
+
+    BSONObjBuilder builder;
+    wtrs->getOplogTruncateStats(builder);
+    BSONObj stats = builder.obj();
+    ASSERT_EQ(2, stats["passes"].numberLong());
+    ASSERT_EQ(3, stats["truncateCount"].numberLong());
+    ASSERT_EQ(165, stats["totalBytesReclaimed"].numberLong());
+    ASSERT_EQ(2, stats["lastPass"]["recordsReclaimed"].numberLong());
+    ASSERT_EQ(110, stats["lastPass"]["bytesReclaimed"].numberLong());
+}
+
 // Verify that an oplog stone isn't created if it would cause the logical representation of the
 // records to not be in increasing order.
 TEST(WiredTigerRecordStoreTest, OplogStones_AscendingOrder) {
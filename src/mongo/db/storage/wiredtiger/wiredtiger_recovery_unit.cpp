@@ -178,13 +178,16 @@ void WiredTigerRecoveryUnit::_ensureSession() {
 }
 
 bool WiredTigerRecoveryUnit::waitUntilDurable() {
-    invariant(!_inUnitOfWork);
-    const bool forceCheckpoint = false;
-    const bool stableCheckpoint = false;
-    _sessionCache->waitUntilDurable(forceCheckpoint, stableCheckpoint);
+    // Share a group commit with any other waiters instead of serializing on the log flush.
+    waitUntilDurableAsync().get();
     return true;
 }
 
+Future<void> WiredTigerRecoveryUnit::waitUntilDurableAsync() {
+    invariant(!_inUnitOfWork);
+    return _sessionCache->waitUntilDurableAsync();
+}
+
 bool WiredTigerRecoveryUnit::waitUntilUnjournaledWritesDurable() {
     invariant(!_inUnitOfWork);
     const bool forceCheckpoint = true;
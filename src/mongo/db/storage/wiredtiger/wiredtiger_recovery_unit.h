@@ -70,6 +70,8 @@ public:
 
     bool waitUntilDurable() override;
 
+    Future<void> waitUntilDurableAsync() override;
+
     bool waitUntilUnjournaledWritesDurable() override;
 
     void registerChange(Change* change) override;
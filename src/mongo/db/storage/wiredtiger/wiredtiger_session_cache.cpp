@@ -35,19 +35,36 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/base/error_codes.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/global_settings.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
+namespace {
+
+// Journal flushes performed by the journal flusher on behalf of waitUntilDurableAsync() callers,
+// and the number of requests they completed. The average batch size is requests / batches.num.
+TimerStats groupCommitBatchStats;
+ServerStatusMetricField<TimerStats> displayGroupCommitBatches("storage.journal.groupCommit.batches",
+                                                              &groupCommitBatchStats);
+Counter64 groupCommitRequests;
+ServerStatusMetricField<Counter64> displayGroupCommitRequests(
+    "storage.journal.groupCommit.requests", &groupCommitRequests);
+
+}  // namespace
 
 // The "wiredTigerCursorCacheSize" parameter has the following meaning.
 //
@@ -288,6 +305,69 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableC
     _journalListener->onDurable(token);
 }
 
+Future<void> WiredTigerSessionCache::waitUntilDurableAsync() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_durabilityRequestsMutex);
+        if (_groupCommitEnabled) {
+            auto pf = makePromiseFuture<void>();
+            _durabilityRequests.push_back(std::move(pf.promise));
+            _durabilityRequestsCond.notify_one();
+            return std::move(pf.future);
+        }
+    }
+
+    return makeReadyFutureWith([this] {
+        const bool forceCheckpoint = false;
+        const bool stableCheckpoint = false;
+        waitUntilDurable(forceCheckpoint, stableCheckpoint);
+    });
+}
+
+void WiredTigerSessionCache::setGroupCommitEnabled(bool enabled) {
+    stdx::lock_guard<stdx::mutex> lk(_durabilityRequestsMutex);
+    _groupCommitEnabled = enabled;
+}
+
+void WiredTigerSessionCache::flushJournalForQueuedWaiters(Milliseconds maxWait) {
+    std::vector<Promise<void>> batch;
+    {
+        stdx::unique_lock<stdx::mutex> lk(_durabilityRequestsMutex);
+        MONGO_IDLE_THREAD_BLOCK;
+        _durabilityRequestsCond.wait_for(
+            lk, maxWait.toSystemDuration(), [&] { return !_durabilityRequests.empty(); });
+
+        // Only requests queued before the flush starts are guaranteed to be covered by it. Anything
+        // that arrives while we are flushing waits for the next batch.
+        batch.swap(_durabilityRequests);
+    }
+
+    Timer flushTimer;
+    Status status = Status::OK();
+    try {
+        const bool forceCheckpoint = false;
+        const bool stableCheckpoint = false;
+        waitUntilDurable(forceCheckpoint, stableCheckpoint);
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    if (!batch.empty()) {
+        groupCommitBatchStats.recordMillis(flushTimer.millis());
+        groupCommitRequests.increment(batch.size());
+        LOG(4) << "group commit completed " << batch.size() << " durability requests";
+    }
+
+    for (auto& promise : batch) {
+        if (status.isOK()) {
+            promise.emplaceValue();
+        } else {
+            promise.setError(status);
+        }
+    }
+
+    uassertStatusOK(status);
+}
+
 void WiredTigerSessionCache::waitUntilPreparedUnitOfWorkCommitsOrAborts(OperationContext* opCtx) {
     invariant(opCtx);
     stdx::unique_lock<stdx::mutex> lk(_prepareCommittedOrAbortedMutex);
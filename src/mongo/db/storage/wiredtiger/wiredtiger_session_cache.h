@@ -33,14 +33,18 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <wiredtiger.h>
 
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/future.h"
 
 namespace mongo {
 
@@ -211,6 +215,30 @@ public:
      */
     void waitUntilDurable(bool forceCheckpoint, bool stableCheckpoint);
 
+    /**
+     * Returns a Future that becomes ready once all commits that happened before this call are
+     * durable in the journal. While group commit is enabled the request is queued for the journal
+     * flusher, so that a single log flush completes every request registered before it started.
+     * Otherwise the flush is performed inline and the returned Future is already ready. Errors,
+     * such as ShutdownInProgress, are reported through the Future.
+     */
+    Future<void> waitUntilDurableAsync();
+
+    /**
+     * Turns group commit on or off. Must only be on while a journal flusher thread is calling
+     * flushJournalForQueuedWaiters(). Once turned off, new requests are flushed inline, but
+     * requests that were already queued are only completed by the next call to
+     * flushJournalForQueuedWaiters().
+     */
+    void setGroupCommitEnabled(bool enabled);
+
+    /**
+     * Called by the journal flusher. Waits up to 'maxWait' for a durability request to be queued,
+     * then flushes the journal once and completes every request that was queued before the flush
+     * started. Throws if the flush fails, after reporting the error to the queued requests.
+     */
+    void flushJournalForQueuedWaiters(Milliseconds maxWait);
+
     /**
      * Waits until a prepared unit of work has ended (either been commited or aborted). This
      * should be used when encountering WT_PREPARE_CONFLICT errors. The caller is required to retry
@@ -277,6 +305,14 @@ private:
     AtomicUInt32 _lastSyncTime;
     stdx::mutex _lastSyncMutex;
 
+    // Protects the group commit state below.
+    stdx::mutex _durabilityRequestsMutex;
+    // Signaled when a request is added to _durabilityRequests.
+    stdx::condition_variable _durabilityRequestsCond;
+    // Requests waiting for the next journal flush, completed by flushJournalForQueuedWaiters.
+    std::vector<Promise<void>> _durabilityRequests;
+    bool _groupCommitEnabled = false;
+
     // Mutex and cond var for waiting on prepare commit or abort.
     stdx::mutex _prepareCommittedOrAbortedMutex;
     stdx::condition_variable _prepareCommittedOrAbortedCond;
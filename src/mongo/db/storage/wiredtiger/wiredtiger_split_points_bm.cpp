@@ -0,0 +1,181 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include <wiredtiger.h>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const int64_t kNumKeys = 500 * 1000;
+
+// The number of keys in each chunk produced by the split, as if the average document took up
+// 1KB and the max chunk size was 64MB.
+const int64_t kKeysPerSplitChunk = 32 * 1024;
+
+const char* kOpenConfig = "create,cache_size=64MB,log=(enabled=false)";
+const char* kIndexUri = "table:idx_skey";
+
+/**
+ * Fills a table laid out like a WiredTiger shard key index over a single chunk holding the whole
+ * collection.
+ */
+void loadIndex(WT_SESSION* session) {
+    invariantWTOK(session->create(session, kIndexUri, "key_format=q,value_format=q"));
+
+    WT_CURSOR* cursor;
+    invariantWTOK(session->open_cursor(session, kIndexUri, nullptr, nullptr, &cursor));
+    invariantWTOK(session->begin_transaction(session, nullptr));
+    for (int64_t key = 0; key < kNumKeys; key++) {
+        cursor->set_key(cursor, key);
+        cursor->set_value(cursor, key);
+        invariantWTOK(cursor->insert(cursor));
+    }
+    invariantWTOK(session->commit_transaction(session, nullptr));
+    invariantWTOK(cursor->close(cursor));
+}
+
+class WiredTigerIndexHarness {
+public:
+    WiredTigerIndexHarness() : _dbpath("wt_split_points_bm") {
+        invariantWTOK(wiredtiger_open(_dbpath.path().c_str(), nullptr, kOpenConfig, &_conn));
+        invariantWTOK(_conn->open_session(_conn, nullptr, nullptr, &_session));
+        loadIndex(_session);
+    }
+
+    ~WiredTigerIndexHarness() {
+        invariantWTOK(_conn->close(_conn, nullptr));
+    }
+
+    WT_SESSION* session() const {
+        return _session;
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn;
+    WT_SESSION* _session;
+};
+
+/**
+ * splitVector's approach: walks every key of the chunk, picking a split point after every
+ * kKeysPerSplitChunk keys.
+ */
+void BM_ScanSplitPoints(benchmark::State& state) {
+    WiredTigerIndexHarness harness;
+
+    std::vector<int64_t> splitKeys;
+    for (auto keepRunning : state) {
+        WT_CURSOR* cursor;
+        invariantWTOK(harness.session()->open_cursor(
+            harness.session(), kIndexUri, nullptr, nullptr, &cursor));
+
+        splitKeys.clear();
+        int64_t count = 0;
+        while (cursor->next(cursor) == 0) {
+            int64_t key;
+            invariantWTOK(cursor->get_key(cursor, &key));
+            if (++count > kKeysPerSplitChunk) {
+                splitKeys.push_back(key);
+                count = 0;
+            }
+        }
+        invariantWTOK(cursor->close(cursor));
+
+        benchmark::DoNotOptimize(splitKeys.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * kNumKeys);
+}
+
+/**
+ * sampleSplitPoints' approach: reads state.range(0) keys in runs of consecutive keys starting at
+ * random index entries, estimating the split points from their evenly spaced quantiles.
+ */
+void BM_SampleSplitPoints(benchmark::State& state) {
+    WiredTigerIndexHarness harness;
+    const int64_t numSamples = state.range(0);
+    const int64_t numSplitPoints = std::min((kNumKeys - 1) / kKeysPerSplitChunk, numSamples - 1);
+    const int64_t keysPerRun = std::max<int64_t>(1, std::min<int64_t>(16, numSamples / 64));
+    const std::string randomConfig = str::stream()
+        << "next_random=true,next_random_sample_size=" << numSamples / keysPerRun;
+
+    std::vector<int64_t> samples;
+    std::vector<int64_t> splitKeys;
+    for (auto keepRunning : state) {
+        WT_CURSOR* randomCursor;
+        invariantWTOK(harness.session()->open_cursor(
+            harness.session(), kIndexUri, nullptr, randomConfig.c_str(), &randomCursor));
+        WT_CURSOR* rangeCursor;
+        invariantWTOK(harness.session()->open_cursor(
+            harness.session(), kIndexUri, nullptr, nullptr, &rangeCursor));
+
+        samples.clear();
+        while (static_cast<int64_t>(samples.size()) < numSamples) {
+            invariantWTOK(randomCursor->next(randomCursor));
+            int64_t key;
+            invariantWTOK(randomCursor->get_key(randomCursor, &key));
+
+            rangeCursor->set_key(rangeCursor, key);
+            invariantWTOK(rangeCursor->search(rangeCursor));
+            samples.push_back(key);
+            for (int64_t i = 1; i < keysPerRun && rangeCursor->next(rangeCursor) == 0; i++) {
+                invariantWTOK(rangeCursor->get_key(rangeCursor, &key));
+                samples.push_back(key);
+            }
+        }
+        invariantWTOK(rangeCursor->close(rangeCursor));
+        invariantWTOK(randomCursor->close(randomCursor));
+
+        std::sort(samples.begin(), samples.end());
+        splitKeys.clear();
+        for (int64_t i = 1; i <= numSplitPoints; i++) {
+            splitKeys.push_back(samples[i * samples.size() / (numSplitPoints + 1)]);
+        }
+
+        benchmark::DoNotOptimize(splitKeys.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * numSamples);
+}
+
+BENCHMARK(BM_ScanSplitPoints)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SampleSplitPoints)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mongo
@@ -33,6 +33,7 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "mongo/base/simple_string_data_comparator.h"
@@ -310,6 +311,35 @@ Status WiredTigerUtil::checkTableCreationOptions(const BSONElement& configElem)
     return Status::OK();
 }
 
+// static
+StatusWith<std::string> WiredTigerUtil::parseCompressionOption(const BSONElement& elem) {
+    // The block compressors WiredTiger is built with, see third_party/wiredtiger/SConscript.
+    static const StringData kBlockCompressors[] = {"none"_sd, "snappy"_sd, "zlib"_sd, "zstd"_sd};
+
+    const StringData fieldName = elem.fieldNameStringData();
+    if (fieldName == "blockCompressor") {
+        if (elem.type() != String) {
+            return {ErrorCodes::TypeMismatch, "'blockCompressor' must be a string."};
+        }
+
+        const StringData compressor = elem.valueStringData();
+        if (std::find(std::begin(kBlockCompressors), std::end(kBlockCompressors), compressor) ==
+            std::end(kBlockCompressors)) {
+            return {ErrorCodes::InvalidOptions,
+                    str::stream() << "unsupported 'blockCompressor' value '" << compressor
+                                  << "', must be one of none, snappy, zlib or zstd."};
+        }
+        return std::string(str::stream() << "block_compressor=" << compressor << ',');
+    }
+
+    invariant(fieldName == "prefixCompression");
+    if (!elem.isBoolean()) {
+        return {ErrorCodes::TypeMismatch, "'prefixCompression' must be a boolean."};
+    }
+    return std::string(str::stream() << "prefix_compression="
+                                     << (elem.boolean() ? "true" : "false") << ',');
+}
+
 // static
 StatusWith<uint64_t> WiredTigerUtil::getStatisticsValue(WT_SESSION* session,
                                                         const std::string& uri,
@@ -195,6 +195,13 @@ public:
      */
     static Status checkTableCreationOptions(const BSONElement& configElem);
 
+    /**
+     * Validates a 'blockCompressor' or 'prefixCompression' collection or index creation option and
+     * returns the equivalent WiredTiger table configuration. 'blockCompressor' must name a block
+     * compressor built into this server.
+     */
+    static StatusWith<std::string> parseCompressionOption(const BSONElement& elem);
+
     /**
      * Reads individual statistics using URI.
      * List of statistics keys WT_STAT_* can be found in wiredtiger.h.
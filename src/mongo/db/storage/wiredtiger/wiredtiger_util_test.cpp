@@ -360,4 +360,48 @@ TEST(WiredTigerUtilTest, GetStatisticsValueAsUInt8) {
     ASSERT_EQUALS(static_cast<uint8_t>(100), resultInt16.getValue());
 }
 
+TEST(WiredTigerSessionCacheTest, DurabilityRequestIsCompletedInlineWithoutGroupCommit) {
+    WiredTigerUtilHarnessHelper harnessHelper("");
+    auto future = harnessHelper.getSessionCache()->waitUntilDurableAsync();
+    ASSERT_TRUE(future.isReady());
+    ASSERT_OK(future.getNoThrow());
+}
+
+TEST(WiredTigerSessionCacheTest, QueuedDurabilityRequestsAreCompletedByOneFlush) {
+    WiredTigerUtilHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+    sessionCache->setGroupCommitEnabled(true);
+
+    std::vector<Future<void>> futures;
+    for (int i = 0; i < 5; ++i) {
+        futures.push_back(sessionCache->waitUntilDurableAsync());
+    }
+    for (const auto& future : futures) {
+        ASSERT_FALSE(future.isReady());
+    }
+
+    sessionCache->flushJournalForQueuedWaiters(Milliseconds(0));
+    for (const auto& future : futures) {
+        ASSERT_TRUE(future.isReady());
+        ASSERT_OK(future.getNoThrow());
+    }
+}
+
+TEST(WiredTigerSessionCacheTest, QueuedDurabilityRequestsSurviveDisablingGroupCommit) {
+    WiredTigerUtilHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+    sessionCache->setGroupCommitEnabled(true);
+    auto queued = sessionCache->waitUntilDurableAsync();
+    sessionCache->setGroupCommitEnabled(false);
+
+    // New requests no longer wait for the flusher.
+    auto inlined = sessionCache->waitUntilDurableAsync();
+    ASSERT_TRUE(inlined.isReady());
+    ASSERT_OK(inlined.getNoThrow());
+
+    ASSERT_FALSE(queued.isReady());
+    sessionCache->flushJournalForQueuedWaiters(Milliseconds(0));
+    ASSERT_OK(queued.getNoThrow());
+}
+
 }  // namespace mongo
@@ -46,6 +46,7 @@
 #include "mongo/db/write_concern_options.h"
 #include "mongo/rpc/protocol.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/future.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -176,6 +177,10 @@ Status waitForWriteConcern(OperationContext* opCtx,
     WriteConcernOptions writeConcernWithPopulatedSyncMode =
         replCoord->populateUnsetWriteConcernOptionsSyncMode(writeConcern);
 
+    // A journal flush that may still be in progress while we wait for replication. It must be
+    // waited on before reporting success.
+    Future<void> journalFlush;
+
     switch (writeConcernWithPopulatedSyncMode.syncMode) {
         case WriteConcernOptions::SyncMode::UNSET:
             severe() << "Attempting to wait on a WriteConcern with an unset sync option";
@@ -195,22 +200,34 @@ Status waitForWriteConcern(OperationContext* opCtx,
         case WriteConcernOptions::SyncMode::JOURNAL:
             if (replCoord->getReplicationMode() != repl::ReplicationCoordinator::Mode::modeNone) {
                 // Wait for ops to become durable then update replication system's
-                // knowledge of this.
+                // knowledge of this. The flush is requested asynchronously so that it is batched
+                // with other writers and overlaps with waiting for replication below.
                 OpTime appliedOpTime = replCoord->getMyLastAppliedOpTime();
-                opCtx->recoveryUnit()->waitUntilDurable();
-                replCoord->setMyLastDurableOpTimeForward(appliedOpTime);
+                journalFlush = opCtx->recoveryUnit()->waitUntilDurableAsync().then(
+                    [replCoord, appliedOpTime] {
+                        replCoord->setMyLastDurableOpTimeForward(appliedOpTime);
+                    });
             } else {
                 opCtx->recoveryUnit()->waitUntilDurable();
             }
             break;
     }
 
+    const auto waitForJournalFlush = [&] {
+        const bool inProgress = !journalFlush.isReady();
+        journalFlush.get();
+        if (inProgress) {
+            result->syncMillis = syncTimer.millis();
+        }
+    };
+
     result->syncMillis = syncTimer.millis();
 
     // Now wait for replication
 
     if (replOpTime.isNull()) {
         // no write happened for this client yet
+        waitForJournalFlush();
         return Status::OK();
     }
 
@@ -218,12 +235,14 @@ Status waitForWriteConcern(OperationContext* opCtx,
     if (writeConcernWithPopulatedSyncMode.wNumNodes <= 1 &&
         writeConcernWithPopulatedSyncMode.wMode.empty()) {
         // no desired replication check
+        waitForJournalFlush();
         return Status::OK();
     }
 
     // Replica set stepdowns and gle mode changes are thrown as errors
     repl::ReplicationCoordinator::StatusAndDuration replStatus =
         replCoord->awaitReplication(opCtx, replOpTime, writeConcernWithPopulatedSyncMode);
+    waitForJournalFlush();
     if (replStatus.status == ErrorCodes::WriteConcernFailed) {
         gleWtimeouts.increment();
         result->err = "timeout";
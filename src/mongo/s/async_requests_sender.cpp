@@ -32,12 +32,17 @@
 
 #include "mongo/s/async_requests_sender.h"
 
+#include <algorithm>
+
+#include "mongo/base/counter.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/host_latency_tracker.h"
 #include "mongo/s/transaction/router_session_runtime_state.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/baton.h"
@@ -50,11 +55,49 @@ namespace mongo {
 
 MONGO_EXPORT_SERVER_PARAMETER(AsyncRequestsSenderUseBaton, bool, true);
 
+MONGO_EXPORT_SERVER_PARAMETER(enableHedgedReads, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(hedgedReadDelayPercentile, int, 95)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 100) {
+            return Status(ErrorCodes::BadValue,
+                          "hedgedReadDelayPercentile must be between 1 and 100");
+        }
+        return Status::OK();
+    });
+
+MONGO_EXPORT_SERVER_PARAMETER(hedgedReadMaxDelayMS, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue, "hedgedReadMaxDelayMS must be at least 1");
+        }
+        return Status::OK();
+    });
+
 namespace {
 
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+Counter64 hedgedReadsIssued;
+Counter64 hedgedReadsWon;
+
+ServerStatusMetricField<Counter64> displayHedgedReadsIssued("hedgedReads.issued",
+                                                            &hedgedReadsIssued);
+ServerStatusMetricField<Counter64> displayHedgedReadsWon("hedgedReads.won", &hedgedReadsWon);
+
+/**
+ * Returns whether the command leaves a cursor open on the host which runs it. The losing request
+ * of a hedged pair is canceled, which does not stop a host which already received it from
+ * establishing the cursor, and its cursor id is never seen. Such commands must not be hedged, or
+ * the cursor would stay open on the losing host until it times out.
+ */
+bool establishesCursor(const BSONObj& cmdObj) {
+    const StringData cmdName = cmdObj.firstElementFieldName();
+    return cmdName == "find"_sd || cmdName == "aggregate"_sd || cmdName == "listCollections"_sd ||
+        cmdName == "listIndexes"_sd || cmdName == "parallelCollectionScan"_sd;
+}
+
 }  // namespace
 
 AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
@@ -71,7 +114,10 @@ AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
       _retryPolicy(retryPolicy) {
     auto routerSession = RouterSessionRuntimeState::get(opCtx);
 
+    bool anyEstablishesCursor = false;
     for (const auto& request : requests) {
+        anyEstablishesCursor = anyEstablishesCursor || establishesCursor(request.cmdObj);
+
         auto cmdObj = request.cmdObj;
         if (routerSession) {
             auto& participant = routerSession->getOrCreateParticipant(request.shardId);
@@ -81,6 +127,12 @@ AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
         _remotes.emplace_back(request.shardId, cmdObj);
     }
 
+    // Only idempotent reads which may be served by more than one host and do not leave a cursor
+    // behind can be hedged. Statements of a transaction must reach each participant exactly once.
+    _hedgeReads = enableHedgedReads.load() && retryPolicy == Shard::RetryPolicy::kIdempotent &&
+        readPreference.pref != ReadPreference::PrimaryOnly && !routerSession &&
+        !anyEstablishesCursor;
+
     // Initialize command metadata to handle the read preference.
     _metadataObj = readPreference.toContainingBSON();
 
@@ -95,6 +147,11 @@ AsyncRequestsSender::~AsyncRequestsSender() {
     while (!done()) {
         next();
     }
+
+    // Wait on the callbacks of the hedged requests and hedge timers which lost the race.
+    while (!_abandonedCallbacks.empty()) {
+        _makeProgress(nullptr);
+    }
 }
 
 AsyncRequestsSender::Response AsyncRequestsSender::next() {
@@ -136,8 +193,11 @@ void AsyncRequestsSender::_cancelPendingRequests() {
 
     // Cancel all outstanding requests so they return immediately.
     for (auto& remote : _remotes) {
-        if (remote.cbHandle.isValid()) {
-            _executor->cancel(remote.cbHandle);
+        for (const auto& cbHandle :
+             {remote.cbHandle, remote.hedgeCbHandle, remote.hedgeTimerHandle}) {
+            if (cbHandle.isValid()) {
+                _executor->cancel(cbHandle);
+            }
         }
     }
 }
@@ -218,7 +278,7 @@ void AsyncRequestsSender::_scheduleRequests() {
         }
 
         // If the remote does not have a response or pending request, schedule remote work for it.
-        if (!remote.swResponse && !remote.cbHandle.isValid()) {
+        if (!remote.swResponse && !remote.cbHandle.isValid() && !remote.hedgeCbHandle.isValid()) {
             auto scheduleStatus = _scheduleRequest(i);
             if (!scheduleStatus.isOK()) {
                 remote.swResponse = std::move(scheduleStatus);
@@ -253,12 +313,7 @@ Status AsyncRequestsSender::_scheduleRequest(size_t remoteIndex) {
     auto callbackStatus = _executor->scheduleRemoteCommand(
         request,
         [remoteIndex, this](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {
-            if (_baton) {
-                _batonRequests++;
-                _baton->schedule([this] { _batonRequests--; });
-            }
-
-            _responseQueue.push(Job{cbData, remoteIndex});
+            _enqueueJob(Job{cbData.myHandle, cbData, remoteIndex});
         },
         _baton);
     if (!callbackStatus.isOK()) {
@@ -266,9 +321,97 @@ Status AsyncRequestsSender::_scheduleRequest(size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+
+    if (_hedgeReads) {
+        _scheduleHedgeTimer(remoteIndex);
+    }
+
     return Status::OK();
 }
 
+void AsyncRequestsSender::_scheduleHedgeTimer(size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    invariant(!remote.hedgeTimerHandle.isValid());
+
+    // Wait for as long as most requests to the host take. Until enough requests have completed
+    // to know what is usual for the host, only hedge requests which are very slow.
+    const Milliseconds maxDelay(hedgedReadMaxDelayMS.load());
+    const auto usualLatency = HostLatencyTracker::get(_opCtx->getServiceContext())
+                                  .percentile(*remote.shardHostAndPort,
+                                              hedgedReadDelayPercentile.load() / 100.0);
+    const auto delay = usualLatency ? std::min(*usualLatency, maxDelay) : maxDelay;
+
+    auto callbackStatus = _executor->scheduleWorkAt(
+        _executor->now() + delay,
+        [remoteIndex, this](const executor::TaskExecutor::CallbackArgs& cbArgs) {
+            _enqueueJob(Job{cbArgs.myHandle, boost::none, remoteIndex});
+        });
+    if (!callbackStatus.isOK()) {
+        // Hedging is best effort, the request is still outstanding
+        return;
+    }
+
+    remote.hedgeTimerHandle = callbackStatus.getValue();
+}
+
+void AsyncRequestsSender::_scheduleHedgedRequest(size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    invariant(remote.cbHandle.isValid());
+    invariant(!remote.hedgeCbHandle.isValid());
+    invariant(!remote.swResponse);
+
+    const auto shard = remote.getShard();
+    if (!shard) {
+        return;
+    }
+
+    auto findHostStatus = shard->getTargeter()->findAlternateHostNoWait(
+        _readPreference, {*remote.shardHostAndPort});
+    if (!findHostStatus.isOK()) {
+        LOG(2) << "Not hedging slow request to " << *remote.shardHostAndPort << " of shard "
+               << remote.shardId << causedBy(findHostStatus.getStatus());
+        return;
+    }
+
+    executor::RemoteCommandRequest request(
+        findHostStatus.getValue(), _db, remote.cmdObj, _metadataObj, _opCtx);
+
+    auto callbackStatus = _executor->scheduleRemoteCommand(
+        request,
+        [remoteIndex, this](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {
+            _enqueueJob(Job{cbData.myHandle, cbData, remoteIndex});
+        },
+        _baton);
+    if (!callbackStatus.isOK()) {
+        return;
+    }
+
+    remote.hedgeHostAndPort = std::move(findHostStatus.getValue());
+    remote.hedgeCbHandle = callbackStatus.getValue();
+    hedgedReadsIssued.increment();
+}
+
+void AsyncRequestsSender::_abandonCallback(executor::TaskExecutor::CallbackHandle* cbHandle) {
+    if (!cbHandle->isValid()) {
+        return;
+    }
+
+    _executor->cancel(*cbHandle);
+    _abandonedCallbacks.push_back(*cbHandle);
+    *cbHandle = executor::TaskExecutor::CallbackHandle();
+}
+
+void AsyncRequestsSender::_enqueueJob(Job job) {
+    if (_baton) {
+        _batonRequests++;
+        _baton->schedule([this] { _batonRequests--; });
+    }
+
+    _responseQueue.push(std::move(job));
+}
+
 // Passing opCtx means you'd like to opt into opCtx interruption.  During cleanup we actually don't.
 void AsyncRequestsSender::_makeProgress(OperationContext* opCtx) {
     invariant(!opCtx || opCtx == _opCtx);
@@ -291,16 +434,69 @@ void AsyncRequestsSender::_makeProgress(OperationContext* opCtx) {
         return;
     }
 
+    // The losing request of a hedged pair and unneeded hedge timers only have to be waited for.
+    auto abandoned =
+        std::find(_abandonedCallbacks.begin(), _abandonedCallbacks.end(), job->cbHandle);
+    if (abandoned != _abandonedCallbacks.end()) {
+        _abandonedCallbacks.erase(abandoned);
+        return;
+    }
+
     auto& remote = _remotes[job->remoteIndex];
     invariant(!remote.swResponse);
 
+    if (!job->cbData) {
+        // The remote took longer to respond than usual, so hedge its request unless the ARS is
+        // winding down.
+        invariant(job->cbHandle == remote.hedgeTimerHandle);
+        remote.hedgeTimerHandle = executor::TaskExecutor::CallbackHandle();
+
+        if (!_stopRetrying) {
+            _scheduleHedgedRequest(job->remoteIndex);
+        }
+        return;
+    }
+
+    const bool fromHedge = job->cbHandle == remote.hedgeCbHandle;
+    auto& cbHandle = fromHedge ? remote.hedgeCbHandle : remote.cbHandle;
+    auto& otherCbHandle = fromHedge ? remote.cbHandle : remote.hedgeCbHandle;
+    invariant(job->cbHandle == cbHandle);
+
     // Clear the callback handle. This indicates that we are no longer waiting on a response from
     // 'remote'.
-    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    cbHandle = executor::TaskExecutor::CallbackHandle();
+
+    auto& response = job->cbData->response;
+    const auto& target = job->cbData->request.target;
+
+    if (!response.status.isOK() && otherCbHandle.isValid()) {
+        // One request of a hedged pair failed, but the other one may still succeed.
+        if (auto shard = remote.getShard()) {
+            shard->updateReplSetMonitor(target, response.status);
+        }
+        return;
+    }
+
+    // This request won, so neither the other request nor the hedge timer is needed anymore.
+    _abandonCallback(&otherCbHandle);
+    _abandonCallback(&remote.hedgeTimerHandle);
+
+    if (fromHedge) {
+        remote.shardHostAndPort = target;
+        if (response.status.isOK()) {
+            hedgedReadsWon.increment();
+        }
+    }
+    remote.hedgeHostAndPort = boost::none;
+
+    if (response.status.isOK() && response.elapsedMillis) {
+        HostLatencyTracker::get(_opCtx->getServiceContext())
+            .record(target, *response.elapsedMillis);
+    }
 
     // Store the response or error.
-    if (job->cbData.response.status.isOK()) {
-        remote.swResponse = std::move(job->cbData.response);
+    if (response.status.isOK()) {
+        remote.swResponse = std::move(response);
 
         if (auto routerSession = RouterSessionRuntimeState::get(opCtx)) {
             auto& participant = routerSession->getOrCreateParticipant(remote.shardId);
@@ -308,7 +504,7 @@ void AsyncRequestsSender::_makeProgress(OperationContext* opCtx) {
         }
     } else {
         // TODO: call participant.markAsCommandSent on "transaction already started" errors?
-        remote.swResponse = std::move(job->cbData.response.status);
+        remote.swResponse = std::move(response.status);
     }
 }
 
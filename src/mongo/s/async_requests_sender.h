@@ -76,6 +76,12 @@ namespace mongo {
  *     }
  * }
  *
+ * If hedged reads are enabled and the requests are idempotent reads which may run on a secondary
+ * and do not establish cursors, the ARS sends a second copy of a request to another member of the
+ * shard's replica set when the first host takes longer than usual to respond. The usual latency of
+ * each host is learned from the responses to previous requests. The first response wins and the
+ * other request is canceled.
+ *
  * Does not throw exceptions.
  */
 class AsyncRequestsSender {
@@ -199,6 +205,16 @@ private:
         // The callback handle to an outstanding request for this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
+        // The host to which the request was hedged. Is unset unless a hedged request is
+        // outstanding.
+        boost::optional<HostAndPort> hedgeHostAndPort;
+
+        // The callback handle to an outstanding hedged request for this remote.
+        executor::TaskExecutor::CallbackHandle hedgeCbHandle;
+
+        // The callback handle to the timer after which the request to this remote gets hedged.
+        executor::TaskExecutor::CallbackHandle hedgeTimerHandle;
+
         // Whether this remote's result has been returned.
         bool done = false;
     };
@@ -208,7 +224,12 @@ private:
      * off thread, and this wraps up the arguments for that call.
      */
     struct Job {
-        executor::TaskExecutor::RemoteCommandCallbackArgs cbData;
+        // The callback which produced this job.
+        executor::TaskExecutor::CallbackHandle cbHandle;
+
+        // Is unset if the job signals that the hedge delay of the remote has elapsed.
+        boost::optional<executor::TaskExecutor::RemoteCommandCallbackArgs> cbData;
+
         size_t remoteIndex;
     };
 
@@ -278,6 +299,29 @@ private:
      */
     Status _scheduleRequest(size_t remoteIndex);
 
+    /**
+     * Schedules the timer after which the outstanding request to a remote gets hedged. The delay
+     * is derived from the latencies recently observed from the host the request was sent to.
+     */
+    void _scheduleHedgeTimer(size_t remoteIndex);
+
+    /**
+     * Sends a copy of the outstanding request to a remote to another eligible host of the shard,
+     * if there is one.
+     */
+    void _scheduleHedgedRequest(size_t remoteIndex);
+
+    /**
+     * Cancels the callback and clears its handle, but remembers it so the ARS still waits for it
+     * to run before being destroyed. Its job gets discarded.
+     */
+    void _abandonCallback(executor::TaskExecutor::CallbackHandle* cbHandle);
+
+    /**
+     * Pushes a job produced by a TaskExecutor callback to the response queue.
+     */
+    void _enqueueJob(Job job);
+
     /**
      * Waits for forward progress in gathering responses from a remote.
      *
@@ -306,6 +350,13 @@ private:
     // The policy to use when deciding whether to retry on an error.
     Shard::RetryPolicy _retryPolicy;
 
+    // Whether requests which are slow to respond get hedged to a second host.
+    bool _hedgeReads = false;
+
+    // Callbacks of hedged requests and hedge timers which were canceled because the remote already
+    // has a response.
+    std::vector<executor::TaskExecutor::CallbackHandle> _abandonedCallbacks;
+
     // Is set to a non-OK status if the client operation is interrupted.
     // When waiting for a remote to be ready, we only check for interrupt if the _interruptStatus
     // has not already been set to an error (so we can wait for callbacks for (canceled) outstanding
@@ -0,0 +1,277 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/async_requests_sender.h"
+
+#include "mongo/client/remote_command_targeter_factory_mock.h"
+#include "mongo/client/remote_command_targeter_mock.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/executor/network_interface_mock.h"
+#include "mongo/s/catalog/type_shard.h"
+#include "mongo/s/host_latency_tracker.h"
+#include "mongo/s/sharding_router_test_fixture.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+using executor::RemoteCommandResponse;
+
+const HostAndPort kTestConfigShardHost("FakeConfigHost", 12345);
+const ShardId kTestShardId("FakeShard");
+const HostAndPort kTestShardHost("FakeShardHost", 12345);
+const HostAndPort kTestAlternateHost("FakeShardSecondaryHost", 12345);
+
+// Default of the hedgedReadMaxDelayMS server parameter
+const Milliseconds kMaxHedgeDelay(1000);
+
+void setServerParameter(StringData name, StringData value) {
+    auto parameter = ServerParameterSet::getGlobal()->getMap().find(name.toString());
+    ASSERT(parameter != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(parameter->second->setFromString(value.toString()));
+}
+
+class AsyncRequestsSenderTest : public ShardingTestFixture {
+public:
+    void setUp() override {
+        ShardingTestFixture::setUp();
+
+        configTargeter()->setFindHostReturnValue(kTestConfigShardHost);
+
+        ShardType shardType;
+        shardType.setName(kTestShardId.toString());
+        shardType.setHost(kTestShardHost.toString());
+
+        auto targeter = stdx::make_unique<RemoteCommandTargeterMock>();
+        targeter->setConnectionStringReturnValue(ConnectionString(kTestShardHost));
+        targeter->setFindHostReturnValue(kTestShardHost);
+        targeter->setFindAlternateHostReturnValue(kTestAlternateHost);
+        _targeter = targeter.get();
+
+        targeterFactory()->addTargeterToReturn(ConnectionString(kTestShardHost),
+                                               std::move(targeter));
+
+        setupShards({shardType});
+
+        setServerParameter("enableHedgedReads", "true");
+    }
+
+    void tearDown() override {
+        setServerParameter("enableHedgedReads", "false");
+
+        ShardingTestFixture::tearDown();
+    }
+
+protected:
+    /**
+     * Sends a read command, a count by default, to the test shard and returns the host which
+     * served it.
+     */
+    HostAndPort runRead(ReadPreference readPref,
+                        BSONObj cmdObj = BSON("count"
+                                              << "testcoll")) {
+        AsyncRequestsSender ars(operationContext(),
+                                executor(),
+                                "testdb",
+                                {{kTestShardId, cmdObj}},
+                                ReadPreferenceSetting{readPref},
+                                Shard::RetryPolicy::kIdempotent);
+        auto response = ars.next();
+        ASSERT_OK(response.swResponse.getStatus());
+        ASSERT(ars.done());
+        return *response.shardHostAndPort;
+    }
+
+    void respond(executor::NetworkInterfaceMock::NetworkOperationIterator noi) {
+        const RemoteCommandResponse response(BSON("ok" << 1), BSONObj(), Milliseconds(1));
+        network()->scheduleResponse(noi, network()->now(), response);
+    }
+
+    RemoteCommandTargeterMock* _targeter;
+};
+
+TEST_F(AsyncRequestsSenderTest, FastResponseIsNotHedged) {
+    auto future = launchAsync([&] { ASSERT_EQ(kTestShardHost, runRead(ReadPreference::Nearest)); });
+
+    onCommand([&](const executor::RemoteCommandRequest& request) {
+        ASSERT_EQ(kTestShardHost, request.target);
+        return BSONObj();
+    });
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(AsyncRequestsSenderTest, SlowRequestIsHedgedAndHedgeWins) {
+    auto future =
+        launchAsync([&] { ASSERT_EQ(kTestAlternateHost, runRead(ReadPreference::Nearest)); });
+
+    network()->enterNetwork();
+    auto slowRequest = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHost, slowRequest->getRequest().target);
+
+    // No latency was observed from the host yet, so the request is hedged after the max delay.
+    network()->runUntil(network()->now() + kMaxHedgeDelay);
+    auto hedgedRequest = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestAlternateHost, hedgedRequest->getRequest().target);
+    ASSERT_BSONOBJ_EQ(slowRequest->getRequest().cmdObj, hedgedRequest->getRequest().cmdObj);
+
+    // The response to the hedged request arrives first.
+    respond(hedgedRequest);
+    respond(slowRequest);
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(AsyncRequestsSenderTest, HedgeDelayFollowsHostLatency) {
+    auto& tracker = HostLatencyTracker::get(serviceContext());
+    for (size_t i = 0; i < HostLatencyTracker::Histogram::kMinSamples; ++i) {
+        tracker.record(kTestShardHost, Milliseconds(10));
+    }
+
+    auto future = launchAsync([&] { ASSERT_EQ(kTestShardHost, runRead(ReadPreference::Nearest)); });
+
+    network()->enterNetwork();
+    const auto start = network()->now();
+    auto slowRequest = network()->getNextReadyRequest();
+
+    // The requests to the host took less than 12ms so far.
+    network()->runUntil(start + Milliseconds(11));
+    ASSERT_FALSE(network()->hasReadyRequests());
+
+    network()->runUntil(start + Milliseconds(12));
+    auto hedgedRequest = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestAlternateHost, hedgedRequest->getRequest().target);
+
+    // The response to the original request arrives first.
+    respond(slowRequest);
+    respond(hedgedRequest);
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(AsyncRequestsSenderTest, FailedHedgeWaitsForOriginalRequest) {
+    auto future = launchAsync([&] { ASSERT_EQ(kTestShardHost, runRead(ReadPreference::Nearest)); });
+
+    network()->enterNetwork();
+    auto slowRequest = network()->getNextReadyRequest();
+    network()->runUntil(network()->now() + kMaxHedgeDelay);
+    auto hedgedRequest = network()->getNextReadyRequest();
+
+    network()->scheduleResponse(hedgedRequest,
+                                network()->now(),
+                                {Status(ErrorCodes::HostUnreachable, "host unreachable"),
+                                 Milliseconds(0)});
+    network()->runReadyNetworkOperations();
+
+    respond(slowRequest);
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(AsyncRequestsSenderTest, PrimaryOnlyReadIsNotHedged) {
+    auto future =
+        launchAsync([&] { ASSERT_EQ(kTestShardHost, runRead(ReadPreference::PrimaryOnly)); });
+
+    network()->enterNetwork();
+    auto slowRequest = network()->getNextReadyRequest();
+    network()->runUntil(network()->now() + kMaxHedgeDelay * 2);
+    ASSERT_FALSE(network()->hasReadyRequests());
+
+    respond(slowRequest);
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(AsyncRequestsSenderTest, CursorEstablishingReadIsNotHedged) {
+    const NamespaceString nss("testdb.testcoll");
+    const CursorId cursorId = 123;
+
+    auto future = launchAsync([&] {
+        ASSERT_EQ(kTestShardHost,
+                  runRead(ReadPreference::Nearest,
+                          BSON("find" << nss.coll() << "batchSize" << 0)));
+    });
+
+    network()->enterNetwork();
+    auto slowRequest = network()->getNextReadyRequest();
+    ASSERT_EQ(kTestShardHost, slowRequest->getRequest().target);
+
+    // A hedged find would open a second cursor on the alternate host, which nobody would close.
+    network()->runUntil(network()->now() + kMaxHedgeDelay * 2);
+    ASSERT_FALSE(network()->hasReadyRequests());
+
+    const RemoteCommandResponse response(
+        CursorResponse(nss, cursorId, {}).toBSON(CursorResponse::ResponseType::InitialResponse),
+        BSONObj(),
+        Milliseconds(1));
+    network()->scheduleResponse(slowRequest, network()->now(), response);
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+
+    // The only cursor is the one returned to the caller, and no other host was ever contacted.
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+}
+
+TEST_F(AsyncRequestsSenderTest, NoEligibleHostMeansNoHedge) {
+    _targeter->setFindAlternateHostReturnValue(
+        Status(ErrorCodes::FailedToSatisfyReadPreference, "no other host"));
+
+    auto future = launchAsync([&] { ASSERT_EQ(kTestShardHost, runRead(ReadPreference::Nearest)); });
+
+    network()->enterNetwork();
+    auto slowRequest = network()->getNextReadyRequest();
+    network()->runUntil(network()->now() + kMaxHedgeDelay * 2);
+    ASSERT_FALSE(network()->hasReadyRequests());
+
+    respond(slowRequest);
+    network()->runReadyNetworkOperations();
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+}
+
+}  // namespace
+}  // namespace mongo
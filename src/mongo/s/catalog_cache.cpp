@@ -155,13 +155,33 @@ StatusWith<CachedDatabaseInfo> CatalogCache::getDatabase(OperationContext* opCtx
                     uassertStatusOK(Grid::get(opCtx)->catalogClient()->getCollections(
                         opCtx, &dbNameCopy, &collLoadConfigOptime));
 
+                // Routing tables restored from a snapshot can only be used as the starting point
+                // of a refresh if the collection has not been dropped or recreated since
+                auto snapshotRoutingTables = [&] {
+                    StringMap<std::shared_ptr<RoutingTableHistory>> routingTables;
+                    auto it = _snapshotRoutingTablesByDb.find(dbName);
+                    if (it != _snapshotRoutingTablesByDb.end()) {
+                        routingTables = std::move(it->second);
+                        _snapshotRoutingTablesByDb.erase(it);
+                    }
+                    return routingTables;
+                }();
+
                 CollectionInfoMap collectionEntries;
                 for (const auto& coll : collections) {
                     if (coll.getDropped()) {
                         continue;
                     }
-                    collectionEntries[coll.getNs().ns()] =
-                        std::make_shared<CollectionRoutingInfoEntry>();
+                    auto collEntry = std::make_shared<CollectionRoutingInfoEntry>();
+
+                    auto itSnapshot = snapshotRoutingTables.find(coll.getNs().ns());
+                    if (itSnapshot != snapshotRoutingTables.end() &&
+                        itSnapshot->second->getVersion().epoch() == coll.getEpoch()) {
+                        collEntry->routingInfo = std::move(itSnapshot->second);
+                        _stats.countRoutingTablesSeededFromSnapshot.addAndFetch(1);
+                    }
+
+                    collectionEntries[coll.getNs().ns()] = std::move(collEntry);
                 }
                 _collectionsByDb[dbName] = std::move(collectionEntries);
                 dbEntry->mustLoadShardedCollections = false;
@@ -401,12 +421,46 @@ void CatalogCache::purgeDatabase(StringData dbName) {
     stdx::lock_guard<stdx::mutex> lg(_mutex);
     _databases.erase(dbName);
     _collectionsByDb.erase(dbName);
+    _snapshotRoutingTablesByDb.erase(dbName);
 }
 
 void CatalogCache::purgeAllDatabases() {
     stdx::lock_guard<stdx::mutex> lg(_mutex);
     _databases.clear();
     _collectionsByDb.clear();
+    _snapshotRoutingTablesByDb.clear();
+}
+
+void CatalogCache::seedRoutingTablesFromSnapshot(
+    std::vector<std::shared_ptr<RoutingTableHistory>> routingTables) {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    for (auto& rt : routingTables) {
+        const auto& nss = rt->getns();
+        _snapshotRoutingTablesByDb[nss.db()][nss.ns()] = std::move(rt);
+    }
+}
+
+std::vector<std::shared_ptr<RoutingTableHistory>> CatalogCache::getRoutingTablesForSnapshot()
+    const {
+    std::vector<std::shared_ptr<RoutingTableHistory>> routingTables;
+
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    for (const auto& db : _collectionsByDb) {
+        for (const auto& coll : db.second) {
+            // The routing table of a collection which is being refreshed is temporarily moved out
+            // of its entry and will be included in the next snapshot instead
+            if (coll.second->routingInfo) {
+                routingTables.push_back(coll.second->routingInfo);
+            }
+        }
+    }
+    for (const auto& db : _snapshotRoutingTablesByDb) {
+        for (const auto& coll : db.second) {
+            routingTables.push_back(coll.second);
+        }
+    }
+
+    return routingTables;
 }
 
 void CatalogCache::report(BSONObjBuilder* builder) const {
@@ -619,6 +673,9 @@ void CatalogCache::Stats::report(BSONObjBuilder* builder) const {
     builder->append("countFullRefreshesStarted", countFullRefreshesStarted.load());
 
     builder->append("countFailedRefreshes", countFailedRefreshes.load());
+
+    builder->append("countRoutingTablesSeededFromSnapshot",
+                    countRoutingTablesSeededFromSnapshot.load());
 }
 
 CachedDatabaseInfo::CachedDatabaseInfo(DatabaseType dbt, std::shared_ptr<Shard> primaryShard)
@@ -236,6 +236,23 @@ public:
      */
     void purgeAllDatabases();
 
+    /**
+     * Non-blocking method, which supplies routing tables restored from a local snapshot. When the
+     * sharded collections of a database are first loaded, the restored routing table of each
+     * collection whose epoch still matches config.collections is used as the starting point of the
+     * collection's refresh, so that only the chunks changed since the snapshot need to be fetched.
+     * Restored routing tables for collections, which have since been dropped or recreated, are
+     * discarded.
+     */
+    void seedRoutingTablesFromSnapshot(
+        std::vector<std::shared_ptr<RoutingTableHistory>> routingTables);
+
+    /**
+     * Returns the latest cached routing table of every sharded collection, including the restored
+     * routing tables which have not been used yet, to be persisted to a local snapshot.
+     */
+    std::vector<std::shared_ptr<RoutingTableHistory>> getRoutingTablesForSnapshot() const;
+
     /**
      * Reports statistics about the catalog cache to be used by serverStatus
      */
@@ -367,6 +384,10 @@ private:
         // for whatever reason
         AtomicInt64 countFailedRefreshes{0};
 
+        // Cumulative, always-increasing counter of how many collections started from a routing
+        // table restored from a local snapshot rather than a full refresh
+        AtomicInt64 countRoutingTablesSeededFromSnapshot{0};
+
         /**
          * Reports the accumulated statistics for serverStatus.
          */
@@ -377,6 +398,8 @@ private:
     using DatabaseInfoMap = StringMap<std::shared_ptr<DatabaseInfoEntry>>;
     using CollectionInfoMap = StringMap<std::shared_ptr<CollectionRoutingInfoEntry>>;
     using CollectionsByDbMap = StringMap<CollectionInfoMap>;
+    using SnapshotRoutingTablesByDbMap =
+        StringMap<StringMap<std::shared_ptr<RoutingTableHistory>>>;
 
     // Mutex to serialize access to the structures below
     mutable stdx::mutex _mutex;
@@ -385,6 +408,9 @@ private:
     DatabaseInfoMap _databases;
     // Map from full collection name to the routing info for that collection, grouped by database
     CollectionsByDbMap _collectionsByDb;
+    // Map from full collection name to the routing table restored from a local snapshot, grouped
+    // by database. Entries are consumed when the sharded collections of their database are loaded.
+    SnapshotRoutingTablesByDbMap _snapshotRoutingTablesByDb;
 };
 
 }  // namespace mongo
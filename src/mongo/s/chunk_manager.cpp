@@ -66,6 +66,33 @@ std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering orde
     return {ks.getBuffer(), ks.getSize()};
 }
 
+/**
+ * Returns the first chunk whose max KeyString sorts after 'keyString', i.e. the chunk which
+ * contains the key if there is one.
+ */
+ChunkInfoMap::const_iterator upperBound(const ChunkInfoMap& chunkMap,
+                                        const std::string& keyString) {
+    return std::upper_bound(chunkMap.begin(),
+                            chunkMap.end(),
+                            keyString,
+                            [](const std::string& key, const ChunkInfoMap::value_type& entry) {
+                                return key < entry.first;
+                            });
+}
+
+/**
+ * Returns the first chunk whose max KeyString does not sort before 'keyString'.
+ */
+ChunkInfoMap::const_iterator lowerBound(const ChunkInfoMap& chunkMap,
+                                        const std::string& keyString) {
+    return std::lower_bound(chunkMap.begin(),
+                            chunkMap.end(),
+                            keyString,
+                            [](const ChunkInfoMap::value_type& entry, const std::string& key) {
+                                return entry.first < key;
+                            });
+}
+
 }  // namespace
 
 RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
@@ -99,7 +126,7 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
         }
     }
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    const auto it = upperBound(_rt->getChunkMap(), _rt->_extractKeyString(shardKey));
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
             it != _rt->getChunkMap().end() && it->second->containsKey(shardKey));
@@ -107,11 +134,53 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
     return Chunk(*(it->second), _clusterTime);
 }
 
+std::vector<Chunk> ChunkManager::findIntersectingChunksWithSimpleCollation(
+    const std::vector<BSONObj>& shardKeys) const {
+    std::vector<std::pair<std::string, size_t>> keyStrings;
+    keyStrings.reserve(shardKeys.size());
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        keyStrings.emplace_back(_rt->_extractKeyString(shardKeys[i]), i);
+    }
+    std::sort(keyStrings.begin(), keyStrings.end());
+
+    const auto& chunkMap = _rt->getChunkMap();
+    std::vector<ChunkInfo*> chunkInfos(shardKeys.size());
+
+    // Since the keys are visited in ascending order, the chunk containing each key is never before
+    // the one which contained the previous key, so each search only covers the rest of the table.
+    auto it = chunkMap.begin();
+    for (const auto& keyString : keyStrings) {
+        if (it != chunkMap.end() && !(keyString.first < it->first)) {
+            it = std::upper_bound(
+                it,
+                chunkMap.end(),
+                keyString.first,
+                [](const std::string& key, const ChunkInfoMap::value_type& entry) {
+                    return key < entry.first;
+                });
+        }
+
+        const auto& shardKey = shardKeys[keyString.second];
+        uassert(ErrorCodes::ShardKeyNotFound,
+                str::stream() << "Cannot target single shard using key " << shardKey,
+                it != chunkMap.end() && it->second->containsKey(shardKey));
+
+        chunkInfos[keyString.second] = it->second.get();
+    }
+
+    std::vector<Chunk> chunks;
+    chunks.reserve(chunkInfos.size());
+    for (auto chunkInfo : chunkInfos) {
+        chunks.emplace_back(*chunkInfo, _clusterTime);
+    }
+    return chunks;
+}
+
 bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const {
     if (shardKey.isEmpty())
         return false;
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    const auto it = upperBound(_rt->getChunkMap(), _rt->_extractKeyString(shardKey));
     if (it == _rt->getChunkMap().end())
         return false;
 
@@ -211,7 +280,7 @@ bool ChunkManager::rangeOverlapsShard(const ChunkRange& range, const ShardId& sh
 
 ChunkManager::ConstRangeOfChunks ChunkManager::getNextChunkOnShard(const BSONObj& shardKey,
                                                                    const ShardId& shardId) const {
-    for (auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    for (auto it = upperBound(_rt->getChunkMap(), _rt->_extractKeyString(shardKey));
          it != _rt->getChunkMap().end();
          ++it) {
         const auto& chunk = it->second;
@@ -237,10 +306,10 @@ RoutingTableHistory::overlappingRanges(const BSONObj& min,
                                        const BSONObj& max,
                                        bool isMaxInclusive) const {
 
-    const auto itMin = _chunkMap.upper_bound(_extractKeyString(min));
+    const auto itMin = upperBound(_chunkMap, _extractKeyString(min));
     const auto itMax = [this, &max, isMaxInclusive]() {
-        auto it = isMaxInclusive ? _chunkMap.upper_bound(_extractKeyString(max))
-                                 : _chunkMap.lower_bound(_extractKeyString(max));
+        auto it = isMaxInclusive ? upperBound(_chunkMap, _extractKeyString(max))
+                                 : lowerBound(_chunkMap, _extractKeyString(max));
         return it == _chunkMap.end() ? it : ++it;
     }();
 
@@ -507,7 +576,13 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
-    auto chunkMap = _chunkMap;
+
+    // Applying a chunk erases every chunk whose max lies in (min, max] and inserts the chunk
+    // itself. Rather than copying the whole table and applying the changes to it one by one, the
+    // changes are first applied to each other, and the erased ranges of the current table are
+    // recorded, so that the new table can be built in a single merge pass.
+    std::map<std::string, std::shared_ptr<ChunkInfo>> updatedChunks;
+    std::vector<std::pair<size_t, size_t>> erasedRanges;
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -528,17 +603,22 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
 
         // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
         // min
-        const auto low = chunkMap.upper_bound(chunkMinKeyString);
+        const auto low = upperBound(_chunkMap, chunkMinKeyString);
 
         // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
         // not overlap max
-        const auto high = chunkMap.upper_bound(chunkMaxKeyString);
+        const auto high = upperBound(_chunkMap, chunkMaxKeyString);
 
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
+        // Erase all chunks which overlap the chunk we got from the persistent store, both from the
+        // current table and from the changes applied so far
+        if (low != high) {
+            erasedRanges.emplace_back(low - _chunkMap.begin(), high - _chunkMap.begin());
+        }
+        updatedChunks.erase(updatedChunks.upper_bound(chunkMinKeyString),
+                            updatedChunks.upper_bound(chunkMaxKeyString));
 
         // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunkMaxKeyString, std::make_shared<ChunkInfo>(chunk)));
+        updatedChunks.emplace(chunkMaxKeyString, std::make_shared<ChunkInfo>(chunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -552,6 +632,33 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         return shared_from_this();
     }
 
+    std::sort(erasedRanges.begin(), erasedRanges.end());
+
+    ChunkInfoMap chunkMap;
+    chunkMap.reserve(_chunkMap.size() + updatedChunks.size());
+
+    auto updatedIt = updatedChunks.begin();
+    const auto appendChunk = [&](const ChunkInfoMap::value_type& entry) {
+        for (; updatedIt != updatedChunks.end() && updatedIt->first < entry.first; ++updatedIt) {
+            chunkMap.emplace_back(updatedIt->first, std::move(updatedIt->second));
+        }
+        chunkMap.push_back(entry);
+    };
+
+    size_t pos = 0;
+    for (const auto& erased : erasedRanges) {
+        for (; pos < erased.first; ++pos) {
+            appendChunk(_chunkMap[pos]);
+        }
+        pos = std::max(pos, erased.second);
+    }
+    for (; pos < _chunkMap.size(); ++pos) {
+        appendChunk(_chunkMap[pos]);
+    }
+    for (; updatedIt != updatedChunks.end(); ++updatedIt) {
+        chunkMap.emplace_back(updatedIt->first, std::move(updatedIt->second));
+    }
+
     return std::shared_ptr<RoutingTableHistory>(
         new RoutingTableHistory(_nss,
                                 _uuid,
@@ -49,8 +49,10 @@ struct QuerySolutionNode;
 class OperationContext;
 class ChunkManager;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkInfoMap = std::map<std::string, std::shared_ptr<ChunkInfo>>;
+// Flat map from the KeyString of the max for each chunk to an entry describing the chunk, sorted by
+// that KeyString. Lookups binary search the contiguous array instead of chasing tree nodes, and
+// the ChunkInfo entries are shared between successive versions of the routing table.
+using ChunkInfoMap = std::vector<std::pair<std::string, std::shared_ptr<ChunkInfo>>>;
 
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
@@ -353,6 +355,17 @@ public:
         return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
     }
 
+    /**
+     * Batch form of findIntersectingChunkWithSimpleCollation. Returns the chunk containing each of
+     * "shardKeys", in the same order. The keys are sorted and resolved with a single forward walk
+     * of the routing table, which is cheaper than looking each of them up separately when there
+     * are many.
+     *
+     * Throws a DBException with the ShardKeyNotFound code if any key cannot be targeted.
+     */
+    std::vector<Chunk> findIntersectingChunksWithSimpleCollation(
+        const std::vector<BSONObj>& shardKeys) const;
+
     /**
      * Finds the shard IDs for a given filter and collation. If collation is empty, we use the
      * collection default collation for targeting.
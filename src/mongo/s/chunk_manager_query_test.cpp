@@ -487,5 +487,93 @@ TEST_F(ChunkManagerQueryTest, SimpleCollationNumbersMultiShard) {
         {ShardId("0")});
 }
 
+TEST_F(ChunkManagerQueryTest, FindIntersectingChunksMatchesSingleKeyLookups) {
+    const ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+    auto chunkManager = makeChunkManager(kNss,
+                                         shardKeyPattern,
+                                         nullptr,
+                                         false,
+                                         {BSON("a" << -100), BSON("a" << 0), BSON("a" << 100)});
+
+    // Unsorted, with duplicates and keys on chunk boundaries.
+    const std::vector<BSONObj> shardKeys{BSON("a" << 150),
+                                         BSON("a" << -100),
+                                         BSON("a" << MINKEY),
+                                         BSON("a" << 0),
+                                         BSON("a" << 150),
+                                         BSON("a" << -101),
+                                         BSON("a" << 99)};
+
+    const auto chunks = chunkManager->findIntersectingChunksWithSimpleCollation(shardKeys);
+    ASSERT_EQ(shardKeys.size(), chunks.size());
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        const auto expected = chunkManager->findIntersectingChunkWithSimpleCollation(shardKeys[i]);
+        ASSERT_BSONOBJ_EQ(expected.getMin(), chunks[i].getMin());
+        ASSERT_EQ(expected.getShardId(), chunks[i].getShardId());
+    }
+
+    ASSERT(chunkManager->findIntersectingChunksWithSimpleCollation({}).empty());
+}
+
+TEST_F(ChunkManagerQueryTest, IncrementalUpdateAppliesOverlappingChanges) {
+    const OID epoch = OID::gen();
+    const ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+
+    auto rt = RoutingTableHistory::makeNew(
+        kNss,
+        UUID::gen(),
+        shardKeyPattern.getKeyPattern(),
+        nullptr,
+        false,
+        epoch,
+        {ChunkType(kNss, {BSON("a" << MINKEY), BSON("a" << 0)}, {1, 0, epoch}, ShardId("0")),
+         ChunkType(kNss, {BSON("a" << 0), BSON("a" << 100)}, {2, 0, epoch}, ShardId("0")),
+         ChunkType(kNss, {BSON("a" << 100), BSON("a" << MAXKEY)}, {3, 0, epoch}, ShardId("1"))});
+
+    // Split [0, 100) in two, then move the upper half and merge it with the last chunk, all in a
+    // single refresh.
+    auto updatedRt = rt->makeUpdated(
+        {ChunkType(kNss, {BSON("a" << 0), BSON("a" << 50)}, {3, 1, epoch}, ShardId("0")),
+         ChunkType(kNss, {BSON("a" << 50), BSON("a" << 100)}, {3, 2, epoch}, ShardId("0")),
+         ChunkType(kNss, {BSON("a" << 50), BSON("a" << 100)}, {4, 0, epoch}, ShardId("1")),
+         ChunkType(kNss, {BSON("a" << 50), BSON("a" << MAXKEY)}, {4, 1, epoch}, ShardId("1"))});
+
+    ChunkManager cm(updatedRt, boost::none);
+    ASSERT_EQ(3, cm.numChunks());
+    ASSERT_EQ(ChunkVersion(4, 1, epoch), cm.getVersion());
+
+    std::vector<std::pair<BSONObj, ShardId>> chunks;
+    for (const auto& chunk : cm.chunks()) {
+        chunks.emplace_back(chunk.getMin(), chunk.getShardId());
+    }
+    ASSERT_EQ(3U, chunks.size());
+    ASSERT_BSONOBJ_EQ(BSON("a" << MINKEY), chunks[0].first);
+    ASSERT_EQ(ShardId("0"), chunks[0].second);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 0), chunks[1].first);
+    ASSERT_EQ(ShardId("0"), chunks[1].second);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 50), chunks[2].first);
+    ASSERT_EQ(ShardId("1"), chunks[2].second);
+
+    ASSERT_EQ(ShardId("1"),
+              cm.findIntersectingChunkWithSimpleCollation(BSON("a" << 75)).getShardId());
+    ASSERT_EQ(ShardId("0"),
+              cm.findIntersectingChunkWithSimpleCollation(BSON("a" << 25)).getShardId());
+
+    // The original routing table is left untouched.
+    ASSERT_EQ(3, ChunkManager(rt, boost::none).numChunks());
+    ASSERT_EQ(ChunkVersion(3, 0, epoch), rt->getVersion());
+}
+
+TEST_F(ChunkManagerQueryTest, IncrementalUpdateWithoutNewVersionReturnsSameRoutingTable) {
+    const OID epoch = OID::gen();
+    const ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+    const ChunkType chunk(
+        kNss, {BSON("a" << MINKEY), BSON("a" << MAXKEY)}, {1, 0, epoch}, ShardId("0"));
+
+    auto rt = RoutingTableHistory::makeNew(
+        kNss, UUID::gen(), shardKeyPattern.getKeyPattern(), nullptr, false, epoch, {chunk});
+    ASSERT_EQ(rt, rt->makeUpdated({chunk}));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -120,7 +120,43 @@ void BM_IncrementalRefreshOfPessimalBalancedDistribution(benchmark::State& state
     }
 }
 
-BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)->Args({2, 50000});
+BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)
+    ->Args({2, 50000})
+    ->Args({2, 500000});
+
+void BM_IncrementalRefreshWithManySplits(benchmark::State& state) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+    const int nSplits = state.range(2);
+    auto cm = makeChunkManagerWithOptimalBalancedDistribution(nShards, nChunks);
+
+    auto postSplitVersion = cm->getChunkManager()->getVersion();
+    const auto collName = NamespaceString(cm->getChunkManager()->getns());
+    std::vector<ChunkType> newChunks;
+    newChunks.reserve(2 * nSplits);
+    for (int i = 1; i <= nSplits; ++i) {
+        // Split chunks spread evenly across the key space, excluding the first and last chunks.
+        const int chunkIndex = 1 + int64_t(i) * (nChunks - 3) / nSplits;
+        const auto range = getRangeForChunk(chunkIndex, nChunks);
+        const auto splitPoint = BSON("_id" << (chunkIndex - 1) * 100 + 50);
+        const auto shardId = optimalShardSelector(chunkIndex, nShards, nChunks);
+        postSplitVersion.incMinor();
+        newChunks.emplace_back(
+            collName, ChunkRange(range.getMin(), splitPoint), postSplitVersion, shardId);
+        postSplitVersion.incMinor();
+        newChunks.emplace_back(
+            collName, ChunkRange(splitPoint, range.getMax()), postSplitVersion, shardId);
+    }
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(runIncrementalUpdate(*cm, newChunks));
+    }
+}
+
+BENCHMARK(BM_IncrementalRefreshWithManySplits)
+    ->Args({10, 50000, 1000})
+    ->Args({10, 500000, 1000})
+    ->Args({10, 500000, 10000});
 
 template <typename ShardSelectorFn>
 auto BM_FullBuildOfChunkManager(benchmark::State& state, ShardSelectorFn selectShard) {
@@ -245,6 +281,49 @@ void BM_FindIntersectingChunk(benchmark::State& state,
     state.SetItemsProcessed(state.iterations());
 }
 
+// Targets an insert batch of state.range(2) documents one key at a time, the way mongos used to
+// target inserts.
+template <typename CollectionMetadataBuilderFn>
+void BM_FindIntersectingChunkForBatch(benchmark::State& state,
+                                      CollectionMetadataBuilderFn makeCollectionMetadata) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+    const int batchSize = state.range(2);
+
+    auto cm = makeCollectionMetadata(nShards, nChunks);
+    auto keys = makeKeys(nChunks);
+    keys.resize(batchSize);
+
+    for (auto keepRunning : state) {
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(
+                cm->getChunkManager()->findIntersectingChunkWithSimpleCollation(key));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+
+// Same as above, using the batch lookup.
+template <typename CollectionMetadataBuilderFn>
+void BM_FindIntersectingChunksBatched(benchmark::State& state,
+                                      CollectionMetadataBuilderFn makeCollectionMetadata) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+    const int batchSize = state.range(2);
+
+    auto cm = makeCollectionMetadata(nShards, nChunks);
+    auto keys = makeKeys(nChunks);
+    keys.resize(batchSize);
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(
+            cm->getChunkManager()->findIntersectingChunksWithSimpleCollation(keys));
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+
 template <typename CollectionMetadataBuilderFn>
 void BM_GetShardIdsForRange(benchmark::State& state,
                             CollectionMetadataBuilderFn makeCollectionMetadata) {
@@ -341,11 +420,25 @@ MONGO_INITIALIZER(RegisterBenchmarks)(InitializerContext* context) {
             BM_RangeOverlapsChunk, Optimal, makeChunkManagerWithOptimalBalancedDistribution),
     };
 
+    std::initializer_list<benchmark::internal::Benchmark*> batchBmCases{
+        REGISTER_BENCHMARK_CAPTURE(BM_FindIntersectingChunkForBatch,
+                                   Optimal,
+                                   makeChunkManagerWithOptimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(BM_FindIntersectingChunksBatched,
+                                   Optimal,
+                                   makeChunkManagerWithOptimalBalancedDistribution),
+    };
+
+    for (auto bmCase : batchBmCases) {
+        bmCase->Args({10, 50000, 1000})->Args({10, 50000, 100000})->Args({100, 500000, 100000});
+    }
+
     for (auto bmCase : bmCases) {
         bmCase->Args({2, 50000})
             ->Args({10, 50000})
             ->Args({100, 50000})
             ->Args({1000, 50000})
+            ->Args({100, 500000})
             ->Args({2, 2});
     }
 
@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/host_latency_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+namespace {
+
+const auto getHostLatencyTracker = ServiceContext::declareDecoration<HostLatencyTracker>();
+
+}  // namespace
+
+constexpr size_t HostLatencyTracker::Histogram::kNumBuckets;
+constexpr uint64_t HostLatencyTracker::Histogram::kDecayThreshold;
+constexpr uint64_t HostLatencyTracker::Histogram::kMinSamples;
+
+void HostLatencyTracker::Histogram::record(Milliseconds latency) {
+    _counts[_bucketFor(latency)]++;
+    _total++;
+
+    if (_total < kDecayThreshold) {
+        return;
+    }
+
+    _total = 0;
+    for (auto& count : _counts) {
+        count /= 2;
+        _total += count;
+    }
+}
+
+boost::optional<Milliseconds> HostLatencyTracker::Histogram::percentile(double fraction) const {
+    if (_total < kMinSamples) {
+        return boost::none;
+    }
+
+    const auto target = std::max<uint64_t>(1, std::ceil(_total * fraction));
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+        seen += _counts[bucket];
+        if (seen >= target) {
+            return _upperBound(bucket);
+        }
+    }
+
+    return _upperBound(kNumBuckets - 1);
+}
+
+size_t HostLatencyTracker::Histogram::_bucketFor(Milliseconds latency) {
+    const auto millis = static_cast<unsigned long long>(std::max<long long>(latency.count(), 0));
+    if (millis < 4) {
+        return millis;
+    }
+
+    // Two buckets per power of two, split at 1.5x
+    const int log2 = 63 - countLeadingZeros64(millis);
+    const bool upperHalf = millis >= (3ULL << (log2 - 1));
+    return std::min<size_t>(4 + 2 * (log2 - 2) + upperHalf, kNumBuckets - 1);
+}
+
+Milliseconds HostLatencyTracker::Histogram::_upperBound(size_t bucket) {
+    if (bucket < 4) {
+        return Milliseconds(static_cast<long long>(bucket) + 1);
+    }
+
+    const int log2 = 2 + (bucket - 4) / 2;
+    const bool upperHalf = (bucket - 4) % 2;
+    return Milliseconds(upperHalf ? (2LL << log2) : (3LL << (log2 - 1)));
+}
+
+HostLatencyTracker& HostLatencyTracker::get(ServiceContext* serviceContext) {
+    return getHostLatencyTracker(serviceContext);
+}
+
+void HostLatencyTracker::record(const HostAndPort& host, Milliseconds latency) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _histograms[host].record(latency);
+}
+
+boost::optional<Milliseconds> HostLatencyTracker::percentile(const HostAndPort& host,
+                                                             double fraction) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _histograms.find(host);
+    if (it == _histograms.end()) {
+        return boost::none;
+    }
+
+    return it->second.percentile(fraction);
+}
+
+}  // namespace mongo
@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <boost/optional.hpp>
+#include <cstdint>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * Keeps a latency histogram per host to which this node sends commands, so that callers can learn
+ * what response time is normal for a host. The AsyncRequestsSender uses it to decide how long to
+ * wait for a read before hedging it to another member of the replica set.
+ *
+ * This class is thread-safe.
+ */
+class HostLatencyTracker {
+    MONGO_DISALLOW_COPYING(HostLatencyTracker);
+
+public:
+    /**
+     * Histogram with exponentially growing buckets: one per millisecond below 4ms and then two per
+     * power of two (at 1x and 1.5x), which bounds the relative error of a percentile to 50%. Counts
+     * are halved whenever kDecayThreshold samples have accumulated, so the histogram follows
+     * changes in a host's latency instead of being dominated by old samples.
+     */
+    class Histogram {
+    public:
+        static constexpr size_t kNumBuckets = 36;
+        static constexpr uint64_t kDecayThreshold = 1024;
+        static constexpr uint64_t kMinSamples = 16;
+
+        void record(Milliseconds latency);
+
+        /**
+         * Returns a latency which at least 'fraction' of the recorded samples did not exceed, or
+         * boost::none if fewer than kMinSamples samples have been recorded.
+         */
+        boost::optional<Milliseconds> percentile(double fraction) const;
+
+        uint64_t count() const {
+            return _total;
+        }
+
+    private:
+        static size_t _bucketFor(Milliseconds latency);
+        static Milliseconds _upperBound(size_t bucket);
+
+        std::array<uint64_t, kNumBuckets> _counts{};
+        uint64_t _total = 0;
+    };
+
+    HostLatencyTracker() = default;
+
+    static HostLatencyTracker& get(ServiceContext* serviceContext);
+
+    /**
+     * Records the round-trip time of a command which completed on 'host'.
+     */
+    void record(const HostAndPort& host, Milliseconds latency);
+
+    /**
+     * Returns the given percentile of the latencies recently recorded for 'host', or boost::none
+     * if too few commands to that host have completed to tell.
+     */
+    boost::optional<Milliseconds> percentile(const HostAndPort& host, double fraction) const;
+
+private:
+    mutable stdx::mutex _mutex;
+
+    stdx::unordered_map<HostAndPort, Histogram> _histograms;
+};
+
+}  // namespace mongo
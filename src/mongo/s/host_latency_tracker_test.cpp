@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/host_latency_tracker.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Histogram = HostLatencyTracker::Histogram;
+
+void recordMany(Histogram* histogram, Milliseconds latency, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        histogram->record(latency);
+    }
+}
+
+TEST(HostLatencyHistogramTest, PercentileRequiresMinimumSamples) {
+    Histogram histogram;
+    recordMany(&histogram, Milliseconds(10), Histogram::kMinSamples - 1);
+    ASSERT_FALSE(histogram.percentile(0.5));
+
+    histogram.record(Milliseconds(10));
+    ASSERT(histogram.percentile(0.5));
+}
+
+TEST(HostLatencyHistogramTest, PercentileIsUpperBoundOfBucket) {
+    Histogram histogram;
+    recordMany(&histogram, Milliseconds(10), 100);
+
+    // 10ms falls in the [8ms, 12ms) bucket
+    ASSERT_EQ(Milliseconds(12), *histogram.percentile(0.5));
+    ASSERT_EQ(Milliseconds(12), *histogram.percentile(0.95));
+}
+
+TEST(HostLatencyHistogramTest, PercentileReflectsTail) {
+    Histogram histogram;
+    recordMany(&histogram, Milliseconds(1), 90);
+    recordMany(&histogram, Milliseconds(100), 10);
+
+    ASSERT_EQ(Milliseconds(2), *histogram.percentile(0.5));
+    ASSERT_EQ(Milliseconds(2), *histogram.percentile(0.9));
+
+    // 100ms falls in the [96ms, 128ms) bucket
+    ASSERT_EQ(Milliseconds(128), *histogram.percentile(0.95));
+}
+
+TEST(HostLatencyHistogramTest, OldSamplesDecay) {
+    Histogram histogram;
+    recordMany(&histogram, Milliseconds(100), Histogram::kDecayThreshold);
+    ASSERT_LT(histogram.count(), Histogram::kDecayThreshold);
+
+    recordMany(&histogram, Milliseconds(1), 4 * Histogram::kDecayThreshold);
+    ASSERT_EQ(Milliseconds(2), *histogram.percentile(0.9));
+}
+
+TEST(HostLatencyHistogramTest, LatenciesBeyondLastBucketAreClamped) {
+    Histogram histogram;
+    recordMany(&histogram, Hours(1), Histogram::kMinSamples);
+    recordMany(&histogram, Milliseconds(-1), Histogram::kMinSamples);
+
+    ASSERT_EQ(Milliseconds(1), *histogram.percentile(0.5));
+    ASSERT_EQ(Milliseconds(262144), *histogram.percentile(1));
+}
+
+TEST(HostLatencyTrackerTest, TracksHostsSeparately) {
+    const HostAndPort fastHost("FastHost", 12345);
+    const HostAndPort slowHost("SlowHost", 12345);
+
+    HostLatencyTracker tracker;
+    for (size_t i = 0; i < Histogram::kMinSamples; ++i) {
+        tracker.record(fastHost, Milliseconds(1));
+        tracker.record(slowHost, Milliseconds(100));
+    }
+
+    ASSERT_EQ(Milliseconds(2), *tracker.percentile(fastHost, 0.95));
+    ASSERT_EQ(Milliseconds(128), *tracker.percentile(slowHost, 0.95));
+    ASSERT_FALSE(tracker.percentile(HostAndPort("UnknownHost", 12345), 0.95));
+}
+
+}  // namespace
+}  // namespace mongo
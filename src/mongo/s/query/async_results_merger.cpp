@@ -38,6 +38,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/util/assert_util.h"
@@ -78,6 +79,18 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+/**
+ * Returns the Ordering with which to encode sort keys following 'sortKeyPattern' as KeyStrings, so
+ * that they compare the same as with compareSortKeys(), or boost::none if the pattern has more
+ * fields than an Ordering can describe.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const BSONObj& sortKeyPattern) {
+    if (sortKeyPattern.nFields() > 32) {
+        return boost::none;
+    }
+    return Ordering::make(sortKeyPattern);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -91,22 +104,29 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       _tailableMode(params.getTailableMode() ? *params.getTailableMode()
                                              : TailableModeEnum::kNormal),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(_remotes,
-                                    _params.getSort() ? *_params.getSort() : BSONObj(),
-                                    _params.getCompareWholeSortKey())) {
+      _sortKeyOrdering(_params.getSort() ? makeSortKeyOrdering(*_params.getSort()) : boost::none),
+      _mergeTree(MergingComparator(_remotes,
+                                   _params.getSort() ? *_params.getSort() : BSONObj(),
+                                   _params.getCompareWholeSortKey())) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
     }
 
-    size_t remoteIndex = 0;
     for (const auto& remote : _params.getRemotes()) {
         _remotes.emplace_back(remote.getHostAndPort(),
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId());
+    }
+    _mergeTree.resize(_remotes.size());
 
+    size_t remoteIndex = 0;
+    for (const auto& remote : _params.getRemotes()) {
         // We don't check the return value of _addBatchToBuffer here; if there was an error,
         // it will be stored in the remote and the first call to ready() will return true.
-        _addBatchToBuffer(WithLock::withoutLock(), remoteIndex, remote.getCursorResponse());
+        _addBatchToBuffer(WithLock::withoutLock(),
+                          remoteIndex,
+                          remote.getCursorResponse(),
+                          _prepareBatch(remote.getCursorResponse()));
         ++remoteIndex;
     }
 }
@@ -179,6 +199,7 @@ void AsyncResultsMerger::addNewShardCursors(std::vector<RemoteCursor>&& newCurso
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId());
     }
+    _mergeTree.resize(_remotes.size());
 }
 
 bool AsyncResultsMerger::_ready(WithLock lk) {
@@ -220,12 +241,12 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock) {
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
-    auto smallestResult = _remotes[smallestRemote].docBuffer.front();
+    auto smallestRemote = _mergeTree.top();
+    const auto& smallestResult = _remotes[smallestRemote].front();
     auto keyWeWantToReturn =
         extractSortKey(*smallestResult.getResult(), _params.getCompareWholeSortKey());
     for (const auto& remote : _remotes) {
@@ -281,23 +302,22 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
 
-    invariant(!_remotes[smallestRemote].docBuffer.empty());
+    invariant(_remotes[smallestRemote].hasNext());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _remotes[smallestRemote].popFront();
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+    // Replay the merge with the next result from 'smallestRemote', if it has a next result.
+    if (_remotes[smallestRemote].hasNext()) {
+        _mergeTree.update(smallestRemote);
+    } else {
+        _mergeTree.remove(smallestRemote);
     }
 
     return front;
@@ -310,8 +330,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _remotes[_gettingFromRemote].popFront();
 
             if (_tailableMode == TailableModeEnum::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -374,10 +393,24 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     executor::RemoteCommandRequest request(
         remote.getTargetHost(), _params.getNss().db().toString(), cmdObj, _opCtx);
 
-    auto callbackStatus =
-        _executor->scheduleRemoteCommand(request, [this, remoteIndex](auto const& cbData) {
+    // The cursor id of a remote does not change while a request to it is outstanding, so it is
+    // safe to check the response against it without holding the mutex.
+    const CursorId cursorId = remote.cursorId;
+
+    auto callbackStatus = _executor->scheduleRemoteCommand(
+        request, [this, remoteIndex, cursorId](auto const& cbData) {
+            // Parse the response and prepare its results before acquiring the mutex, so that the
+            // merging thread is only kept waiting while the batch is handed over to it.
+            auto cursorResponse = cbData.response.isOK()
+                ? _parseCursorResponse(cbData.response.data, cursorId)
+                : StatusWith<CursorResponse>(cbData.response.status);
+            auto batch = cursorResponse.isOK()
+                ? this->_prepareBatch(cursorResponse.getValue())
+                : StatusWith<BufferedBatch>(cursorResponse.getStatus());
+
             stdx::lock_guard<stdx::mutex> lk(this->_mutex);
-            this->_handleBatchResponse(lk, cbData, remoteIndex);
+            this->_handleBatchResponse(
+                lk, std::move(cursorResponse), std::move(batch), remoteIndex);
         });
 
     if (!callbackStatus.isOK()) {
@@ -458,8 +491,8 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
     return eventToReturn;
 }
 
-StatusWith<CursorResponse> AsyncResultsMerger::_parseCursorResponse(
-    const BSONObj& responseObj, const RemoteCursorData& remote) {
+StatusWith<CursorResponse> AsyncResultsMerger::_parseCursorResponse(const BSONObj& responseObj,
+                                                                     CursorId expectedCursorId) {
 
     auto getMoreParseStatus = CursorResponse::parseFromBSON(responseObj);
     if (!getMoreParseStatus.isOK()) {
@@ -470,15 +503,62 @@ StatusWith<CursorResponse> AsyncResultsMerger::_parseCursorResponse(
 
     // If we get a non-zero cursor id that is not equal to the established cursor id, we will fail
     // the operation.
-    if (cursorResponse.getCursorId() != 0 && remote.cursorId != cursorResponse.getCursorId()) {
+    if (cursorResponse.getCursorId() != 0 && expectedCursorId != cursorResponse.getCursorId()) {
         return Status(ErrorCodes::BadValue,
-                      str::stream() << "Expected cursorid " << remote.cursorId << " but received "
+                      str::stream() << "Expected cursorid " << expectedCursorId
+                                    << " but received "
                                     << cursorResponse.getCursorId());
     }
 
     return std::move(cursorResponse);
 }
 
+StatusWith<AsyncResultsMerger::BufferedBatch> AsyncResultsMerger::_prepareBatch(
+    const CursorResponse& response) const {
+    BufferedBatch batch;
+    batch.results.reserve(response.getBatch().size());
+
+    boost::optional<KeyString> sortKey;
+    if (_sortKeyOrdering) {
+        sortKey.emplace(KeyString::Version::V1);
+        batch.sortKeyEnds.reserve(response.getBatch().size());
+    }
+
+    for (const auto& obj : response.getBatch()) {
+        // If there's a sort, we're expecting the remote node to have given us back a sort key.
+        if (_params.getSort()) {
+            auto key = obj[AsyncResultsMerger::kSortKeyField];
+            if (!key) {
+                return Status(ErrorCodes::InternalError,
+                              str::stream() << "Missing field '"
+                                            << AsyncResultsMerger::kSortKeyField
+                                            << "' in document: "
+                                            << obj);
+            } else if (!_params.getCompareWholeSortKey() && key.type() != BSONType::Object) {
+                return Status(ErrorCodes::InternalError,
+                              str::stream() << "Field '" << AsyncResultsMerger::kSortKeyField
+                                            << "' was not of type Object in document: "
+                                            << obj);
+            }
+
+            if (sortKey) {
+                try {
+                    sortKey->resetToKey(extractSortKey(obj, _params.getCompareWholeSortKey()),
+                                        *_sortKeyOrdering);
+                } catch (const DBException& e) {
+                    return e.toStatus();
+                }
+                batch.sortKeys.append(sortKey->getBuffer(), sortKey->getSize());
+                batch.sortKeyEnds.push_back(batch.sortKeys.size());
+            }
+        }
+
+        batch.results.emplace_back(obj);
+    }
+
+    return std::move(batch);
+}
+
 void AsyncResultsMerger::updateRemoteMetadata(RemoteCursorData* remote,
                                               const CursorResponse& response) {
     // Update the cursorId; it is sent as '0' when the cursor has been exhausted on the shard.
@@ -524,7 +604,8 @@ void AsyncResultsMerger::updateRemoteMetadata(RemoteCursorData* remote,
 }
 
 void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
-                                              CbData const& cbData,
+                                              StatusWith<CursorResponse> cursorResponse,
+                                              StatusWith<BufferedBatch> batch,
                                               size_t remoteIndex) {
     // Got a response from remote, so indicate we are no longer waiting for one.
     _remotes[remoteIndex].cbHandle = executor::TaskExecutor::CallbackHandle();
@@ -536,7 +617,7 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
         return;
     }
     try {
-        _processBatchResults(lk, cbData.response, remoteIndex);
+        _processBatchResults(lk, std::move(cursorResponse), std::move(batch), remoteIndex);
     } catch (DBException const& e) {
         _remotes[remoteIndex].status = e.toStatus();
     }
@@ -567,33 +648,32 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         remote.status = Status::OK();
 
         // Clear the results buffer and cursor id.
-        std::queue<ClusterQueryResult> emptyBuffer;
-        std::swap(remote.docBuffer, emptyBuffer);
+        remote.docBuffer.clear();
         remote.cursorId = 0;
+
+        if (_params.getSort()) {
+            _mergeTree.remove(remoteIndex);
+        }
     }
 }
 
 void AsyncResultsMerger::_processBatchResults(WithLock lk,
-                                              CbResponse const& response,
+                                              StatusWith<CursorResponse> cursorResponseStatus,
+                                              StatusWith<BufferedBatch> batch,
                                               size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
-    if (!response.isOK()) {
-        _cleanUpFailedBatch(lk, response.status, remoteIndex);
-        return;
-    }
-    auto cursorResponseStatus = _parseCursorResponse(response.data, remote);
     if (!cursorResponseStatus.isOK()) {
         _cleanUpFailedBatch(lk, cursorResponseStatus.getStatus(), remoteIndex);
         return;
     }
 
-    CursorResponse cursorResponse = std::move(cursorResponseStatus.getValue());
+    const CursorResponse& cursorResponse = cursorResponseStatus.getValue();
 
     // Update the cursorId; it is sent as '0' when the cursor has been exhausted on the shard.
     remote.cursorId = cursorResponse.getCursorId();
 
     // Save the batch in the remote's buffer.
-    if (!_addBatchToBuffer(lk, remoteIndex, cursorResponse)) {
+    if (!_addBatchToBuffer(lk, remoteIndex, cursorResponse, std::move(batch))) {
         return;
     }
 
@@ -617,39 +697,28 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
 
 bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            size_t remoteIndex,
-                                           const CursorResponse& response) {
+                                           const CursorResponse& response,
+                                           StatusWith<BufferedBatch> batch) {
     auto& remote = _remotes[remoteIndex];
     updateRemoteMetadata(&remote, response);
-    for (const auto& obj : response.getBatch()) {
-        // If there's a sort, we're expecting the remote node to have given us back a sort key.
-        if (_params.getSort()) {
-            auto key = obj[AsyncResultsMerger::kSortKeyField];
-            if (!key) {
-                remote.status =
-                    Status(ErrorCodes::InternalError,
-                           str::stream() << "Missing field '" << AsyncResultsMerger::kSortKeyField
-                                         << "' in document: "
-                                         << obj);
-                return false;
-            } else if (!_params.getCompareWholeSortKey() && key.type() != BSONType::Object) {
-                remote.status =
-                    Status(ErrorCodes::InternalError,
-                           str::stream() << "Field '" << AsyncResultsMerger::kSortKeyField
-                                         << "' was not of type Object in document: "
-                                         << obj);
-                return false;
-            }
-        }
+    if (!batch.isOK()) {
+        remote.status = batch.getStatus();
+        return false;
+    }
 
-        ClusterQueryResult result(obj);
-        remote.docBuffer.push(result);
-        ++remote.fetchedCount;
+    if (batch.getValue().empty()) {
+        return true;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
-    // queue.
-    if (_params.getSort() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+    remote.fetchedCount += batch.getValue().results.size();
+
+    const bool hadNext = remote.hasNext();
+    remote.docBuffer.push_back(std::move(batch.getValue()));
+
+    // If we're doing a sorted merge and this remote had nothing buffered, then we have to make
+    // sure to enter it into the merge.
+    if (_params.getSort() && !hadNext) {
+        _mergeTree.update(remoteIndex);
     }
     return true;
 }
@@ -756,17 +825,54 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
     return cursorId == 0;
 }
 
+const ClusterQueryResult& AsyncResultsMerger::RemoteCursorData::front() const {
+    const auto& batch = docBuffer.front();
+    return batch.results[batch.nextResult];
+}
+
+StringData AsyncResultsMerger::RemoteCursorData::frontSortKey() const {
+    return docBuffer.front().nextSortKey();
+}
+
+ClusterQueryResult AsyncResultsMerger::RemoteCursorData::popFront() {
+    auto& batch = docBuffer.front();
+    ClusterQueryResult result = std::move(batch.results[batch.nextResult++]);
+    if (batch.empty()) {
+        docBuffer.pop_front();
+    }
+    return result;
+}
+
+//
+// AsyncResultsMerger::BufferedBatch
+//
+
+StringData AsyncResultsMerger::BufferedBatch::nextSortKey() const {
+    if (sortKeyEnds.empty()) {
+        return StringData();
+    }
+
+    const size_t begin = nextResult == 0 ? 0 : sortKeyEnds[nextResult - 1];
+    return StringData(sortKeys.data() + begin, sortKeyEnds[nextResult] - begin);
+}
+
 //
 // AsyncResultsMerger::MergingComparator
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+int AsyncResultsMerger::MergingComparator::operator()(size_t lhs, size_t rhs) const {
+    const StringData leftKey = _remotes[lhs].frontSortKey();
+    const StringData rightKey = _remotes[rhs].frontSortKey();
+    if (!leftKey.empty() && !rightKey.empty()) {
+        return leftKey.compare(rightKey);
+    }
+
+    const ClusterQueryResult& leftDoc = _remotes[lhs].front();
+    const ClusterQueryResult& rightDoc = _remotes[rhs].front();
 
     return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
                            extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
+                           _sort);
 }
 
 void AsyncResultsMerger::blockingKill(OperationContext* opCtx) {
@@ -29,16 +29,19 @@
 #pragma once
 
 #include <boost/optional.hpp>
-#include <queue>
+#include <deque>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
 #include "mongo/s/query/cluster_query_result.h"
+#include "mongo/s/query/loser_tree.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
@@ -67,6 +70,11 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * Sorted streams are merged with a tournament tree of losers over the remotes, comparing the sort
+ * keys of their results as KeyStrings which are encoded when a batch arrives. Network callbacks
+ * parse and prepare a batch before acquiring the ARM's mutex, so that handing it to the merging
+ * thread only takes the mutex for a constant amount of time.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -87,8 +95,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, enters the remotes with
+     * buffered results into _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      *
@@ -244,6 +252,34 @@ public:
     void blockingKill(OperationContext*);
 
 private:
+    /**
+     * A batch of results received from a remote host. If there is a sort, the sort key of each
+     * result is encoded as a KeyString when the batch is prepared, so that merging compares
+     * results by memcmp rather than by walking their $sortKey fields.
+     */
+    struct BufferedBatch {
+        bool empty() const {
+            return nextResult == results.size();
+        }
+
+        /**
+         * Returns the encoded sort key of the next result, or an empty StringData if the sort keys
+         * of this batch were not encoded.
+         */
+        StringData nextSortKey() const;
+
+        std::vector<ClusterQueryResult> results;
+
+        // The KeyString encoded sort keys of 'results', back to back, and the offset in 'sortKeys'
+        // at which each of them ends. Empty if there is no sort or the sort pattern cannot be
+        // represented by an Ordering.
+        std::string sortKeys;
+        std::vector<size_t> sortKeyEnds;
+
+        // The position in 'results' of the next result to return
+        size_t nextResult = 0;
+    };
+
     /**
      * We instantiate one of these per remote host. It contains the buffer of results we've
      * retrieved from the host but not yet returned, as well as the cursor id, and any error
@@ -270,6 +306,22 @@ private:
          */
         bool exhausted() const;
 
+        /**
+         * Returns the next buffered result. Invalid to call unless hasNext().
+         */
+        const ClusterQueryResult& front() const;
+
+        /**
+         * Returns the encoded sort key of the next buffered result, or an empty StringData if it
+         * was not encoded. Invalid to call unless hasNext().
+         */
+        StringData frontSortKey() const;
+
+        /**
+         * Removes the next buffered result and returns it. Invalid to call unless hasNext().
+         */
+        ClusterQueryResult popFront();
+
         // Used when merging tailable awaitData cursors in sorted order. In order to return any
         // result to the client we have to know that no shard will ever return anything that sorts
         // before it. This object represents a promise from the remote that it will never return a
@@ -288,8 +340,9 @@ private:
         // The exact host in the shard on which the cursor resides.
         HostAndPort shardHostAndPort;
 
-        // The buffer of results that have been retrieved but not yet returned to the caller.
-        std::queue<ClusterQueryResult> docBuffer;
+        // The buffer of results that have been retrieved but not yet returned to the caller. Holds
+        // no empty batches, so that hasNext() does not need to look into them.
+        std::deque<BufferedBatch> docBuffer;
 
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
@@ -303,6 +356,10 @@ private:
         long long fetchedCount = 0;
     };
 
+    /**
+     * Compares the next buffered results of two remotes. Uses the encoded sort keys if both
+     * results have one, and falls back to comparing their $sortKey fields otherwise.
+     */
     class MergingComparator {
     public:
         MergingComparator(const std::vector<RemoteCursorData>& remotes,
@@ -310,7 +367,7 @@ private:
                           bool compareWholeSortKey)
             : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        int operator()(size_t lhs, size_t rhs) const;
 
     private:
         const std::vector<RemoteCursorData>& _remotes;
@@ -328,10 +385,20 @@ private:
     /**
      * Parses the find or getMore command response object to a CursorResponse.
      *
-     * Returns a non-OK response if the response fails to parse or if there is a cursor id mismatch.
+     * Returns a non-OK response if the response fails to parse or if there is a cursor id mismatch
+     * with 'expectedCursorId', the id of the remote cursor the request was sent to.
      */
     static StatusWith<CursorResponse> _parseCursorResponse(const BSONObj& responseObj,
-                                                           const RemoteCursorData& remote);
+                                                           CursorId expectedCursorId);
+
+    /**
+     * Checks that the results of 'response' carry a sort key if there is a sort, and copies them
+     * into a batch along with their encoded sort keys.
+     *
+     * Does not access any state protected by '_mutex', so that network callbacks can prepare a
+     * batch before acquiring it.
+     */
+    StatusWith<BufferedBatch> _prepareBatch(const CursorResponse& response) const;
 
     /**
      * Helper to schedule a command asking the remote node for another batch of results.
@@ -368,13 +435,17 @@ private:
     using CbResponse = executor::TaskExecutor::ResponseStatus;
 
     /**
-     * When nextEvent() schedules remote work, the callback uses this function to process results.
+     * When nextEvent() schedules remote work, the callback uses this function to process results,
+     * which it has already parsed and prepared using '_parseCursorResponse' and '_prepareBatch'.
      *
      * 'remoteIndex' is the position of the relevant remote node in '_remotes', and therefore
      * indicates which node the response came from and where the new result documents should be
      * buffered.
      */
-    void _handleBatchResponse(WithLock, CbData const&, size_t remoteIndex);
+    void _handleBatchResponse(WithLock,
+                              StatusWith<CursorResponse> cursorResponse,
+                              StatusWith<BufferedBatch> batch,
+                              size_t remoteIndex);
 
     /**
      * Cleans up if the remote cursor was killed while waiting for a response.
@@ -389,13 +460,19 @@ private:
     /**
      * Processes results from a remote query.
      */
-    void _processBatchResults(WithLock, CbResponse const&, size_t remoteIndex);
+    void _processBatchResults(WithLock,
+                              StatusWith<CursorResponse> cursorResponse,
+                              StatusWith<BufferedBatch> batch,
+                              size_t remoteIndex);
 
     /**
-     * Adds the batch of results to the RemoteCursorData. Returns false if there was an error
-     * parsing the batch.
+     * Adds the batch of results, prepared from 'response', to the RemoteCursorData. Returns false
+     * if there was an error preparing the batch.
      */
-    bool _addBatchToBuffer(WithLock, size_t remoteIndex, const CursorResponse& response);
+    bool _addBatchToBuffer(WithLock,
+                           size_t remoteIndex,
+                           const CursorResponse& response,
+                           StatusWith<BufferedBatch> batch);
 
     /**
      * If there is a valid unsignaled event that has been requested via nextEvent() and there are
@@ -432,15 +509,22 @@ private:
     TailableModeEnum _tailableMode;
     AsyncResultsMergerParams _params;
 
-    // Must be acquired before accessing any data members (other than _params, which is read-only).
+    // The Ordering with which sort keys are encoded as KeyStrings. Not set if there is no sort or
+    // the sort pattern has more fields than an Ordering can describe, in which case sort keys are
+    // compared as BSON. Read-only after construction.
+    boost::optional<Ordering> _sortKeyOrdering;
+
+    // Must be acquired before accessing any data members (other than _params and _sortKeyOrdering,
+    // which are read-only).
     stdx::mutex _mutex;
 
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
+    // Has a leaf for every remote host, which holds a value while the remote has buffered
+    // results. The top of this tree is the index into '_remotes' for the remote host that has the
     // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    LoserTree<MergingComparator> _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
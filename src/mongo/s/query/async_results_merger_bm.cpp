@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/s/query/async_results_merger.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("testdb.testcoll");
+
+/**
+ * Makes the parameters of a sorted merge over 'numShards' exhausted remote cursors, each of which
+ * has a first batch of 'docsPerShard' results. Consecutive sort keys come from different shards,
+ * so that the merge switches remotes on every result.
+ */
+AsyncResultsMergerParams makeSortedParams(int numShards, int docsPerShard, bool compound) {
+    std::vector<RemoteCursor> remotes;
+    for (int shard = 0; shard < numShards; shard++) {
+        std::vector<BSONObj> batch;
+        batch.reserve(docsPerShard);
+        for (int i = 0; i < docsPerShard; i++) {
+            const int key = i * numShards + shard;
+            const BSONObj sortKey = compound
+                ? BSON("" << std::string(str::stream() << "user" << key / 16) << "" << key % 16)
+                : BSON("" << key);
+            batch.push_back(BSON("_id" << key << "x" << key << AsyncResultsMerger::kSortKeyField
+                                       << sortKey));
+        }
+
+        RemoteCursor remote;
+        remote.setShardId(str::stream() << "shard" << shard);
+        remote.setHostAndPort(HostAndPort(str::stream() << "shard" << shard << "host", 27017));
+        remote.setCursorResponse(CursorResponse(kNss, CursorId(0), std::move(batch)));
+        remotes.push_back(std::move(remote));
+    }
+
+    AsyncResultsMergerParams params;
+    params.setNss(kNss);
+    params.setRemotes(std::move(remotes));
+    params.setSort(compound ? BSON("name" << 1 << "seq" << -1) : BSON("_id" << 1));
+    return params;
+}
+
+/**
+ * Merges the synthetic first batches of state.range(0) shards with state.range(1) results each.
+ * This includes preparing the batches, since the ARM does so when it receives them.
+ */
+void BM_SortedMerge(benchmark::State& state, bool compound) {
+    const int numShards = state.range(0);
+    const int docsPerShard = state.range(1);
+
+    for (auto _ : state) {
+        // The parameters hold move-only cursor responses, so they are rebuilt for every iteration
+        state.PauseTiming();
+        auto params = makeSortedParams(numShards, docsPerShard, compound);
+        state.ResumeTiming();
+
+        // The remote cursors are exhausted, so the ARM never schedules remote work and needs
+        // neither an OperationContext nor an executor.
+        AsyncResultsMerger arm(nullptr, nullptr, std::move(params));
+
+        long long numResults = 0;
+        while (true) {
+            invariant(arm.ready());
+            auto next = arm.nextReady();
+            invariant(next.isOK());
+            if (next.getValue().isEOF()) {
+                break;
+            }
+            benchmark::DoNotOptimize(next.getValue().getResult());
+            numResults++;
+        }
+        invariant(numResults == static_cast<long long>(numShards) * docsPerShard);
+    }
+
+    state.SetItemsProcessed(state.iterations() * numShards * docsPerShard);
+}
+
+BENCHMARK_CAPTURE(BM_SortedMerge, singleKey, false)
+    ->Args({2, 10000})
+    ->Args({16, 2000})
+    ->Args({128, 250})
+    ->Args({512, 100});
+BENCHMARK_CAPTURE(BM_SortedMerge, compoundKey, true)
+    ->Args({2, 10000})
+    ->Args({16, 2000})
+    ->Args({128, 250})
+    ->Args({512, 100});
+
+}  // namespace
+}  // namespace mongo
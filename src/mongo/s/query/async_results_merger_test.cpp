@@ -636,6 +636,52 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergeComparesNumericTypes) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1}}");
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, {})));
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[1], kTestShardHosts[1], CursorResponse(kTestNss, 6, {})));
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[2], kTestShardHosts[2], CursorResponse(kTestNss, 7, {})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    // Schedule requests.
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    // Deliver responses, whose sort keys are numbers of different types.
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {BSON("$sortKey" << BSON("" << 1)),
+                                   BSON("$sortKey" << BSON("" << 2.5))};
+    responses.emplace_back(kTestNss, CursorId(0), batch1);
+    std::vector<BSONObj> batch2 = {BSON("$sortKey" << BSON("" << 2LL)),
+                                   BSON("$sortKey" << BSON("" << 3))};
+    responses.emplace_back(kTestNss, CursorId(0), batch2);
+    std::vector<BSONObj> batch3 = {BSON("$sortKey" << BSON("" << 1.5)),
+                                   BSON("$sortKey" << BSON("" << Decimal128("2.75")))};
+    responses.emplace_back(kTestNss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+
+    // ARM returns all results in numeric order, regardless of their type.
+    std::vector<BSONObj> expected = {BSON("$sortKey" << BSON("" << 1)),
+                                     BSON("$sortKey" << BSON("" << 1.5)),
+                                     BSON("$sortKey" << BSON("" << 2LL)),
+                                     BSON("$sortKey" << BSON("" << 2.5)),
+                                     BSON("$sortKey" << BSON("" << Decimal128("2.75"))),
+                                     BSON("$sortKey" << BSON("" << 3))};
+    for (const auto& obj : expected) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(obj, *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
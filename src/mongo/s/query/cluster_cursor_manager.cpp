@@ -76,6 +76,8 @@ uint32_t extractPrefixFromCursorId(CursorId cursorId) {
 
 }  // namespace
 
+constexpr int ClusterCursorManager::kNumPartitions;
+
 ClusterCursorManager::PinnedCursor::PinnedCursor(ClusterCursorManager* manager,
                                                  std::unique_ptr<ClusterClientCursor> cursor,
                                                  const NamespaceString& nss,
@@ -200,14 +202,15 @@ ClusterCursorManager::ClusterCursorManager(ClockSource* clockSource)
 }
 
 ClusterCursorManager::~ClusterCursorManager() {
+    invariant(_cursorMap.empty());
     invariant(_cursorIdPrefixToNamespaceMap.empty());
     invariant(_namespaceToContainerMap.empty());
 }
 
 void ClusterCursorManager::shutdown(OperationContext* opCtx) {
     {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _inShutdown = true;
+        stdx::lock_guard<stdx::mutex> lk(_registrationMutex);
+        _inShutdown.store(true);
     }
     killAllCursors(opCtx);
 }
@@ -222,9 +225,9 @@ StatusWith<CursorId> ClusterCursorManager::registerCursor(
     // Read the clock out of the lock.
     const auto now = _clockSource->now();
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    stdx::unique_lock<stdx::mutex> lk(_registrationMutex);
 
-    if (_inShutdown) {
+    if (_inShutdown.load()) {
         lk.unlock();
         cursor->kill(opCtx);
         return Status(ErrorCodes::ShutdownInProgress,
@@ -253,25 +256,33 @@ StatusWith<CursorId> ClusterCursorManager::registerCursor(
 
         nsToContainerIt = emplaceResult.first;
     } else {
-        invariant(!nsToContainerIt->second.entryMap.empty());  // If exists, shouldn't be empty.
+        invariant(nsToContainerIt->second.numCursors > 0);  // If exists, shouldn't be empty.
     }
     CursorEntryContainer& container = nsToContainerIt->second;
 
-    // Generate a CursorId (which can't be the invalid value zero).
-    CursorEntryMap& entryMap = container.entryMap;
-    CursorId cursorId = 0;
-    do {
+    // Generate a CursorId (which can't be the invalid value zero), and register a new CursorEntry
+    // for it in its partition of '_cursorMap'.
+    while (true) {
         const uint32_t cursorSuffix = static_cast<uint32_t>(_pseudoRandom.nextInt32());
-        cursorId = createCursorId(container.containerPrefix, cursorSuffix);
-    } while (cursorId == 0 || entryMap.count(cursorId) > 0);
+        const CursorId cursorId = createCursorId(container.containerPrefix, cursorSuffix);
+        if (cursorId == 0) {
+            continue;
+        }
 
-    // Create a new CursorEntry and register it in the CursorEntryContainer's map.
-    auto emplaceResult = entryMap.emplace(
-        cursorId,
-        CursorEntry(std::move(cursor), cursorType, cursorLifetime, now, authenticatedUsers));
-    invariant(emplaceResult.second);
+        auto partition = _cursorMap.lockOnePartition(cursorId);
+        if (partition->count(cursorId) > 0) {
+            continue;
+        }
+
+        auto emplaceResult = partition->emplace(
+            cursorId,
+            CursorEntry(
+                std::move(cursor), nss, cursorType, cursorLifetime, now, authenticatedUsers));
+        invariant(emplaceResult.second);
+        ++container.numCursors;
 
-    return cursorId;
+        return cursorId;
+    }
 }
 
 StatusWith<ClusterCursorManager::PinnedCursor> ClusterCursorManager::checkOutCursor(
@@ -280,14 +291,14 @@ StatusWith<ClusterCursorManager::PinnedCursor> ClusterCursorManager::checkOutCur
     OperationContext* opCtx,
     AuthzCheckFn authChecker,
     AuthCheck checkSessionAuth) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-    if (_inShutdown) {
+    if (_inShutdown.load()) {
         return Status(ErrorCodes::ShutdownInProgress,
                       "Cannot check out cursor as we are in the process of shutting down");
     }
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
+    auto partition = _cursorMap.lockOnePartition(cursorId);
+
+    CursorEntry* entry = _getEntry(*partition, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -339,9 +350,9 @@ void ClusterCursorManager::checkInCursor(std::unique_ptr<ClusterClientCursor> cu
     invariant(opCtx);
     cursor->detachFromOperationContext();
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    auto partition = _cursorMap.lockOnePartition(cursorId);
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
+    CursorEntry* entry = _getEntry(*partition, nss, cursorId);
     invariant(entry);
 
     // killPending will be true if killCursor() was called while the cursor was in use.
@@ -357,15 +368,15 @@ void ClusterCursorManager::checkInCursor(std::unique_ptr<ClusterClientCursor> cu
 
     // After detaching the cursor, the entry will be destroyed.
     entry = nullptr;
-    detachAndKillCursor(std::move(lk), opCtx, nss, cursorId);
+    detachAndKillCursor(std::move(partition), opCtx, nss, cursorId);
 }
 
 Status ClusterCursorManager::checkAuthForKillCursors(OperationContext* opCtx,
                                                      const NamespaceString& nss,
                                                      CursorId cursorId,
                                                      AuthzCheckFn authChecker) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    auto entry = _getEntry(lk, nss, cursorId);
+    auto partition = _cursorMap.lockOnePartition(cursorId);
+    auto entry = _getEntry(*partition, nss, cursorId);
 
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
@@ -376,7 +387,7 @@ Status ClusterCursorManager::checkAuthForKillCursors(OperationContext* opCtx,
     return authChecker(entry->getAuthenticatedUsers());
 }
 
-void ClusterCursorManager::killOperationUsingCursor(WithLock, CursorEntry* entry) {
+void ClusterCursorManager::killOperationUsingCursor(CursorEntry* entry) {
     invariant(entry->getOperationUsingCursor());
     // Interrupt any operation currently using the cursor.
     OperationContext* opUsingCursor = entry->getOperationUsingCursor();
@@ -392,9 +403,9 @@ Status ClusterCursorManager::killCursor(OperationContext* opCtx,
                                         CursorId cursorId) {
     invariant(opCtx);
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    auto partition = _cursorMap.lockOnePartition(cursorId);
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
+    CursorEntry* entry = _getEntry(*partition, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -404,35 +415,39 @@ Status ClusterCursorManager::killCursor(OperationContext* opCtx,
     if (opUsingCursor) {
         // The caller shouldn't need to call killCursor on their own cursor.
         invariant(opUsingCursor != opCtx, "Cannot call killCursor() on your own cursor");
-        killOperationUsingCursor(lk, entry);
+        killOperationUsingCursor(entry);
         return Status::OK();
     }
 
     // No one is using the cursor, so we destroy it.
-    detachAndKillCursor(std::move(lk), opCtx, nss, cursorId);
+    detachAndKillCursor(std::move(partition), opCtx, nss, cursorId);
 
     // We no longer hold the lock here.
 
     return Status::OK();
 }
 
-void ClusterCursorManager::detachAndKillCursor(stdx::unique_lock<stdx::mutex> lk,
+void ClusterCursorManager::detachAndKillCursor(PartitionedCursorEntryMap::OnePartition&& partition,
                                                OperationContext* opCtx,
                                                const NamespaceString& nss,
                                                CursorId cursorId) {
-    auto detachedCursor = _detachCursor(lk, nss, cursorId);
-    invariant(detachedCursor.getStatus());
+    std::unique_ptr<ClusterClientCursor> detachedCursor;
+    {
+        auto lockWithRestrictedScope = std::move(partition);
+        auto swDetachedCursor = _detachCursor(*lockWithRestrictedScope, nss, cursorId);
+        invariant(swDetachedCursor.getStatus());
+        detachedCursor = std::move(swDetachedCursor.getValue());
+    }
+
+    _removeCursorsFromNamespace(nss, 1);
 
     // Deletion of the cursor can happen out of the lock.
-    lk.unlock();
-    detachedCursor.getValue()->kill(opCtx);
-    detachedCursor.getValue().reset();
+    detachedCursor->kill(opCtx);
+    detachedCursor.reset();
 }
 
 std::size_t ClusterCursorManager::killMortalCursorsInactiveSince(OperationContext* opCtx,
                                                                  Date_t cutoff) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
     auto pred = [cutoff](CursorId cursorId, const CursorEntry& entry) -> bool {
         bool res = entry.getLifetimeType() == CursorLifetime::Mortal &&
             !entry.getOperationUsingCursor() && entry.getLastActive() <= cutoff;
@@ -445,63 +460,58 @@ std::size_t ClusterCursorManager::killMortalCursorsInactiveSince(OperationContex
         return res;
     };
 
-    return killCursorsSatisfying(std::move(lk), opCtx, std::move(pred));
+    return killCursorsSatisfying(opCtx, std::move(pred));
 }
 
 void ClusterCursorManager::killAllCursors(OperationContext* opCtx) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
     auto pred = [](CursorId, const CursorEntry&) -> bool { return true; };
 
-    killCursorsSatisfying(std::move(lk), opCtx, std::move(pred));
+    killCursorsSatisfying(opCtx, std::move(pred));
 }
 
 std::size_t ClusterCursorManager::killCursorsSatisfying(
-    stdx::unique_lock<stdx::mutex> lk,
-    OperationContext* opCtx,
-    std::function<bool(CursorId, const CursorEntry&)> pred) {
+    OperationContext* opCtx, std::function<bool(CursorId, const CursorEntry&)> pred) {
     invariant(opCtx);
-    invariant(lk.owns_lock());
     std::size_t nKilled = 0;
 
     std::vector<std::unique_ptr<ClusterClientCursor>> cursorsToDestroy;
-    auto nsContainerIt = _namespaceToContainerMap.begin();
-    while (nsContainerIt != _namespaceToContainerMap.end()) {
-        auto&& entryMap = nsContainerIt->second.entryMap;
-        auto cursorIdEntryIt = entryMap.begin();
-        while (cursorIdEntryIt != entryMap.end()) {
-            auto cursorId = cursorIdEntryIt->first;
-            auto& entry = cursorIdEntryIt->second;
-
-            if (!pred(cursorId, entry)) {
-                ++cursorIdEntryIt;
-                continue;
-            }
-
-            ++nKilled;
-
-            if (entry.getOperationUsingCursor()) {
-                // Mark the OperationContext using the cursor as killed, and move on.
-                killOperationUsingCursor(lk, &entry);
-                ++cursorIdEntryIt;
-                continue;
+    stdx::unordered_map<NamespaceString, size_t, NamespaceString::Hasher> numDestroyedByNss;
+    {
+        auto allPartitions = _cursorMap.lockAllPartitions();
+        for (auto&& entryMap : allPartitions) {
+            auto cursorIdEntryIt = entryMap.begin();
+            while (cursorIdEntryIt != entryMap.end()) {
+                auto cursorId = cursorIdEntryIt->first;
+                auto& entry = cursorIdEntryIt->second;
+
+                if (!pred(cursorId, entry)) {
+                    ++cursorIdEntryIt;
+                    continue;
+                }
+
+                ++nKilled;
+
+                if (entry.getOperationUsingCursor()) {
+                    // Mark the OperationContext using the cursor as killed, and move on.
+                    killOperationUsingCursor(&entry);
+                    ++cursorIdEntryIt;
+                    continue;
+                }
+
+                cursorsToDestroy.push_back(entry.releaseCursor(nullptr));
+                ++numDestroyedByNss[entry.getNamespace()];
+
+                // Destroy the entry and set the iterator to the next element.
+                cursorIdEntryIt = entryMap.erase(cursorIdEntryIt);
             }
-
-            cursorsToDestroy.push_back(entry.releaseCursor(nullptr));
-
-            // Destroy the entry and set the iterator to the next element.
-            cursorIdEntryIt = entryMap.erase(cursorIdEntryIt);
-        }
-
-        if (entryMap.empty()) {
-            nsContainerIt = eraseContainer(nsContainerIt);
-        } else {
-            ++nsContainerIt;
         }
     }
 
-    // Call kill() outside of the lock, as it may require waiting for callbacks to finish.
-    lk.unlock();
+    for (const auto& nssAndNumDestroyed : numDestroyedByNss) {
+        _removeCursorsFromNamespace(nssAndNumDestroyed.first, nssAndNumDestroyed.second);
+    }
 
+    // Call kill() outside of the locks, as it may require waiting for callbacks to finish.
     for (auto&& cursor : cursorsToDestroy) {
         invariant(cursor.get());
         cursor->kill(opCtx);
@@ -511,12 +521,12 @@ std::size_t ClusterCursorManager::killCursorsSatisfying(
 }
 
 ClusterCursorManager::Stats ClusterCursorManager::stats() const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto allPartitions = _cursorMap.lockAllPartitions();
 
     Stats stats;
 
-    for (auto& nsContainerPair : _namespaceToContainerMap) {
-        for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+    for (auto&& entryMap : allPartitions) {
+        for (auto& cursorIdEntryPair : entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
@@ -544,10 +554,10 @@ ClusterCursorManager::Stats ClusterCursorManager::stats() const {
 }
 
 void ClusterCursorManager::appendActiveSessions(LogicalSessionIdSet* lsids) const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto allPartitions = _cursorMap.lockAllPartitions();
 
-    for (const auto& nsContainerPair : _namespaceToContainerMap) {
-        for (const auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+    for (auto&& entryMap : allPartitions) {
+        for (const auto& cursorIdEntryPair : entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
@@ -566,10 +576,10 @@ void ClusterCursorManager::appendActiveSessions(LogicalSessionIdSet* lsids) cons
 std::vector<GenericCursor> ClusterCursorManager::getAllCursors() const {
     std::vector<GenericCursor> cursors;
 
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto allPartitions = _cursorMap.lockAllPartitions();
 
-    for (const auto& nsContainerPair : _namespaceToContainerMap) {
-        for (const auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+    for (auto&& entryMap : allPartitions) {
+        for (const auto& cursorIdEntryPair : entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
@@ -580,7 +590,7 @@ std::vector<GenericCursor> ClusterCursorManager::getAllCursors() const {
             cursors.emplace_back();
             auto& gc = cursors.back();
             gc.setId(cursorIdEntryPair.first);
-            gc.setNs(nsContainerPair.first);
+            gc.setNs(entry.getNamespace());
             gc.setLsid(entry.getLsid());
         }
     }
@@ -601,12 +611,12 @@ std::pair<Status, int> ClusterCursorManager::killCursorsWithMatchingSessions(
 
 stdx::unordered_set<CursorId> ClusterCursorManager::getCursorsForSession(
     LogicalSessionId lsid) const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto allPartitions = _cursorMap.lockAllPartitions();
 
     stdx::unordered_set<CursorId> cursorIds;
 
-    for (auto&& nsContainerPair : _namespaceToContainerMap) {
-        for (auto&& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+    for (auto&& entryMap : allPartitions) {
+        for (auto&& cursorIdEntryPair : entryMap) {
             const CursorEntry& entry = cursorIdEntryPair.second;
 
             if (entry.isKillPending()) {
@@ -626,7 +636,7 @@ stdx::unordered_set<CursorId> ClusterCursorManager::getCursorsForSession(
 
 boost::optional<NamespaceString> ClusterCursorManager::getNamespaceForCursorId(
     CursorId cursorId) const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    stdx::lock_guard<stdx::mutex> lk(_registrationMutex);
 
     const auto it = _cursorIdPrefixToNamespaceMap.find(extractPrefixFromCursorId(cursorId));
     if (it == _cursorIdPrefixToNamespaceMap.end()) {
@@ -635,41 +645,42 @@ boost::optional<NamespaceString> ClusterCursorManager::getNamespaceForCursorId(
     return it->second;
 }
 
-auto ClusterCursorManager::_getEntry(WithLock, NamespaceString const& nss, CursorId cursorId)
-    -> CursorEntry* {
-
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    if (nsToContainerIt == _namespaceToContainerMap.end()) {
-        return nullptr;
-    }
-    CursorEntryMap& entryMap = nsToContainerIt->second.entryMap;
+auto ClusterCursorManager::_getEntry(CursorEntryMap& entryMap,
+                                     NamespaceString const& nss,
+                                     CursorId cursorId) -> CursorEntry* {
     auto entryMapIt = entryMap.find(cursorId);
-    if (entryMapIt == entryMap.end()) {
+    if (entryMapIt == entryMap.end() || entryMapIt->second.getNamespace() != nss) {
         return nullptr;
     }
 
     return &entryMapIt->second;
 }
 
-auto ClusterCursorManager::eraseContainer(NssToCursorContainerMap::iterator it)
-    -> NssToCursorContainerMap::iterator {
-    auto&& container = it->second;
-    auto&& entryMap = container.entryMap;
-    invariant(entryMap.empty());
+void ClusterCursorManager::_removeCursorsFromNamespace(const NamespaceString& nss,
+                                                       size_t numCursors) {
+    stdx::lock_guard<stdx::mutex> lk(_registrationMutex);
+
+    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
+    invariant(nsToContainerIt != _namespaceToContainerMap.end());
+    auto&& container = nsToContainerIt->second;
+    invariant(container.numCursors >= numCursors);
+    container.numCursors -= numCursors;
+    if (container.numCursors > 0) {
+        return;
+    }
 
     // This was the last cursor remaining in the given namespace.  Erase all state associated
     // with this namespace.
     size_t numDeleted = _cursorIdPrefixToNamespaceMap.erase(container.containerPrefix);
     invariant(numDeleted == 1);
-    it = _namespaceToContainerMap.erase(it);
+    _namespaceToContainerMap.erase(nsToContainerIt);
     invariant(_namespaceToContainerMap.size() == _cursorIdPrefixToNamespaceMap.size());
-    return it;
 }
 
 StatusWith<std::unique_ptr<ClusterClientCursor>> ClusterCursorManager::_detachCursor(
-    WithLock lk, NamespaceString const& nss, CursorId cursorId) {
+    CursorEntryMap& entryMap, NamespaceString const& nss, CursorId cursorId) {
 
-    CursorEntry* entry = _getEntry(lk, nss, cursorId);
+    CursorEntry* entry = _getEntry(entryMap, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -682,14 +693,8 @@ StatusWith<std::unique_ptr<ClusterClientCursor>> ClusterCursorManager::_detachCu
     std::unique_ptr<ClusterClientCursor> cursor = entry->releaseCursor(nullptr);
 
     // Destroy the entry.
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    invariant(nsToContainerIt != _namespaceToContainerMap.end());
-    CursorEntryMap& entryMap = nsToContainerIt->second.entryMap;
     size_t eraseResult = entryMap.erase(cursorId);
     invariant(1 == eraseResult);
-    if (entryMap.empty()) {
-        eraseContainer(nsToContainerIt);
-    }
 
     return std::move(cursor);
 }
@@ -32,17 +32,18 @@
 #include <utility>
 #include <vector>
 
+#include "mongo/db/catalog/util/partitioned.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/db/generic_cursor.h"
 #include "mongo/db/kill_sessions.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/session_killer.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/query/cluster_client_cursor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/unordered_map.h"
-#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -66,7 +67,9 @@ class StatusWith;
  * The manager supports killing of registered cursors, either through the PinnedCursor object or
  * with the kill*() suite of methods.
  *
- * No public methods throw exceptions, and all public methods are thread-safe.
+ * No public methods throw exceptions, and all public methods are thread-safe. The registered
+ * cursors are partitioned by cursor id, so that checking out and checking in a cursor only
+ * contends with other operations on cursors in the same partition.
  *
  * TODO: Add maxTimeMS support.  SERVER-19410.
  * TODO: Add method "size_t killCursorsOnNamespace(const NamespaceString& nss)" for
@@ -444,7 +447,9 @@ public:
 private:
     class CursorEntry;
     struct CursorEntryContainer;
+    static constexpr int kNumPartitions = 16;
     using CursorEntryMap = stdx::unordered_map<CursorId, CursorEntry>;
+    using PartitionedCursorEntryMap = Partitioned<CursorEntryMap, kNumPartitions>;
     using NssToCursorContainerMap =
         stdx::unordered_map<NamespaceString, CursorEntryContainer, NamespaceString::Hasher>;
 
@@ -465,46 +470,51 @@ private:
                        CursorState cursorState);
 
     /**
-     * Will detach a cursor, release the lock and then call kill() on it.
+     * Will detach a cursor, release the lock on its partition and then call kill() on it.
      */
-    void detachAndKillCursor(stdx::unique_lock<stdx::mutex> lk,
+    void detachAndKillCursor(PartitionedCursorEntryMap::OnePartition&& partition,
                              OperationContext* opCtx,
                              const NamespaceString& nss,
                              CursorId cursorId);
 
     /**
-     * Returns a pointer to the CursorEntry for the given cursor.  If the given cursor is not
-     * registered, returns null.
-     *
-     * Not thread-safe.
+     * Returns a pointer to the CursorEntry for the given cursor in 'entryMap', the locked partition
+     * of '_cursorMap' for 'cursorId'.  If the given cursor is not registered, returns null.
      */
-    CursorEntry* _getEntry(WithLock, NamespaceString const& nss, CursorId cursorId);
+    CursorEntry* _getEntry(CursorEntryMap& entryMap, NamespaceString const& nss, CursorId cursorId);
 
     /**
-     * De-registers the given cursor, and returns an owned pointer to the underlying
-     * ClusterClientCursor object.
+     * Removes the given cursor from 'entryMap', the locked partition of '_cursorMap' for
+     * 'cursorId', and returns an owned pointer to the underlying ClusterClientCursor object. The
+     * caller must then release the partition's lock and call _removeCursorsFromNamespace().
      *
      * If the given cursor is pinned, returns an error Status with code CursorInUse.  If the given
      * cursor is not registered, returns an error Status with code CursorNotFound.
-     *
-     * Not thread-safe.
      */
-    StatusWith<std::unique_ptr<ClusterClientCursor>> _detachCursor(WithLock,
+    StatusWith<std::unique_ptr<ClusterClientCursor>> _detachCursor(CursorEntryMap& entryMap,
                                                                    NamespaceString const& nss,
                                                                    CursorId cursorId);
 
     /**
-     * Flags the OperationContext that's using the given cursor as interrupted.
+     * Accounts for 'numCursors' cursors on 'nss' having been removed from '_cursorMap', erasing
+     * the state associated with 'nss' once it has no cursors left. Acquires '_registrationMutex',
+     * so must not be called while holding the lock on any partition of '_cursorMap'.
      */
-    void killOperationUsingCursor(WithLock, CursorEntry* entry);
+    void _removeCursorsFromNamespace(const NamespaceString& nss, size_t numCursors);
 
     /**
-     * Kill the cursors satisfying the given predicate. Assumes that 'lk' is held upon entry.
+     * Flags the OperationContext that's using the given cursor as interrupted. The caller must
+     * hold the lock on the partition of '_cursorMap' which holds 'entry'.
+     */
+    void killOperationUsingCursor(CursorEntry* entry);
+
+    /**
+     * Kill the cursors satisfying the given predicate. Locks all partitions of '_cursorMap' while
+     * evaluating the predicate.
      *
      * Returns the number of cursors killed.
      */
-    std::size_t killCursorsSatisfying(stdx::unique_lock<stdx::mutex> lk,
-                                      OperationContext* opCtx,
+    std::size_t killCursorsSatisfying(OperationContext* opCtx,
                                       std::function<bool(CursorId, const CursorEntry&)> pred);
 
     /**
@@ -517,11 +527,13 @@ private:
         CursorEntry() = default;
 
         CursorEntry(std::unique_ptr<ClusterClientCursor> cursor,
+                    const NamespaceString& nss,
                     CursorType cursorType,
                     CursorLifetime cursorLifetime,
                     Date_t lastActive,
                     UserNameIterator authenticatedUsersIter)
             : _cursor(std::move(cursor)),
+              _nss(nss),
               _cursorType(cursorType),
               _cursorLifetime(cursorLifetime),
               _lastActive(lastActive),
@@ -541,6 +553,10 @@ private:
                 !_operationUsingCursor->checkForInterruptNoAssert().isOK();
         }
 
+        const NamespaceString& getNamespace() const {
+            return _nss;
+        }
+
         CursorType getCursorType() const {
             return _cursorType;
         }
@@ -597,6 +613,7 @@ private:
 
     private:
         std::unique_ptr<ClusterClientCursor> _cursor;
+        NamespaceString _nss;
         CursorType _cursorType = CursorType::SingleTarget;
         CursorLifetime _cursorLifetime = CursorLifetime::Mortal;
         Date_t _lastActive;
@@ -610,8 +627,9 @@ private:
     };
 
     /**
-     * CursorEntryContainer is a moveable, non-copyable container for a set of cursors, where all
-     * contained cursors share the same 32-bit prefix of their cursor id.
+     * CursorEntryContainer is a moveable, non-copyable record of the set of cursors on a
+     * namespace, where all the cursors share the same 32-bit prefix of their cursor id. The
+     * cursors themselves live in '_cursorMap'.
      */
     struct CursorEntryContainer {
         MONGO_DISALLOW_COPYING(CursorEntryContainer);
@@ -624,24 +642,29 @@ private:
         // Common cursor id prefix for all cursors in this container.
         uint32_t containerPrefix;
 
-        // Map from cursor id to cursor entry.
-        CursorEntryMap entryMap;
+        // Number of cursors in '_cursorMap' with this prefix.
+        size_t numCursors = 0;
     };
 
-    /**
-     * Erase the container that 'it' points to and return an iterator to the next one. Assumes 'it'
-     * is an iterator in '_namespaceToContainerMap'.
-     */
-    NssToCursorContainerMap::iterator eraseContainer(NssToCursorContainerMap::iterator it);
-
     // Clock source.  Used when the 'last active' time for a cursor needs to be set/updated.  May be
     // concurrently accessed by multiple threads.
     ClockSource* _clockSource;
 
-    // Synchronizes access to all private state variables below.
-    mutable stdx::mutex _mutex;
+    // Map from cursor id to cursor entry, partitioned by cursor id. Each partition is protected by
+    // its own mutex, so that checking out and checking in a cursor only needs the partition's lock.
+    //
+    // If both '_registrationMutex' and partition mutexes need to be held at once,
+    // '_registrationMutex' must be acquired first. Multiple partitions must be locked in ascending
+    // order, or all at once through lockAllPartitions().
+    mutable PartitionedCursorEntryMap _cursorMap;
+
+    // Synchronizes access to all private state variables below, and is held from the generation of
+    // a cursor id until the cursor is inserted into '_cursorMap'.
+    mutable stdx::mutex _registrationMutex;
 
-    bool _inShutdown{false};
+    // Only set while holding '_registrationMutex', so that no cursor can be registered after
+    // shutdown() kills all cursors, but can be read without it.
+    AtomicBool _inShutdown{false};
 
     // Randomness source.  Used for cursor id generation.
     PseudoRandom _pseudoRandom;
@@ -661,7 +684,9 @@ private:
     // Map from namespace to the CursorEntryContainer for that namespace.
     //
     // Entries are added when the first cursor on the given namespace is registered, and removed
-    // when the last cursor on the given namespace is destroyed.
+    // when the last cursor on the given namespace is destroyed. A cursor is removed from
+    // '_cursorMap' before its container is updated, so a container may briefly count a cursor
+    // which is no longer registered, but never the other way around.
     NssToCursorContainerMap _namespaceToContainerMap;
 
     size_t _cursorsTimedOut = 0;
@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/s/query/cluster_client_cursor_mock.h"
+#include "mongo/s/query/cluster_cursor_manager.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/system_clock_source.h"
+
+namespace mongo {
+namespace {
+
+const int kMaxThreads = 16;
+
+const NamespaceString kNss("testdb.testcoll");
+
+Status successAuthChecker(UserNameIterator) {
+    return Status::OK();
+}
+
+/**
+ * Shares one ClusterCursorManager between the benchmark threads, each of which has its own Client
+ * and OperationContext, like concurrent getMores on a mongos. Thread 0 sets up the shared state
+ * before the benchmark loop and tears it down after, while the other threads wait for it at the
+ * loop's start and stop barriers.
+ */
+class ClusterCursorManagerBM : public benchmark::Fixture {
+protected:
+    void setUpClients(int numThreads) {
+        manager = stdx::make_unique<ClusterCursorManager>(SystemClockSource::get());
+        for (int i = 0; i < numThreads; ++i) {
+            auto client = getGlobalServiceContext()->makeClient(str::stream()
+                                                                << "test client for thread " << i);
+            auto opCtx = client->makeOperationContext();
+            clients.emplace_back(std::move(client), std::move(opCtx));
+        }
+    }
+
+    CursorId registerCursor(OperationContext* opCtx) {
+        return uassertStatusOK(
+            manager->registerCursor(opCtx,
+                                    stdx::make_unique<ClusterClientCursorMock>(boost::none,
+                                                                               boost::none),
+                                    kNss,
+                                    ClusterCursorManager::CursorType::MultiTarget,
+                                    ClusterCursorManager::CursorLifetime::Mortal,
+                                    UserNameIterator()));
+    }
+
+    void tearDownClients() {
+        manager->killAllCursors(clients.front().second.get());
+        manager.reset();
+        clients.clear();
+        cursorIds.clear();
+    }
+
+    std::unique_ptr<ClusterCursorManager> manager;
+    std::vector<std::pair<ServiceContext::UniqueClient, ServiceContext::UniqueOperationContext>>
+        clients;
+    std::vector<CursorId> cursorIds;
+};
+
+/**
+ * Each thread repeatedly checks out and checks in its own cursor, as a getMore does. All cursors
+ * are on the same namespace.
+ */
+BENCHMARK_DEFINE_F(ClusterCursorManagerBM, BM_CheckOutCheckIn)(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        setUpClients(state.threads);
+        for (auto&& client : clients) {
+            cursorIds.push_back(registerCursor(client.second.get()));
+        }
+    }
+
+    for (auto keepRunning : state) {
+        auto pinnedCursor =
+            uassertStatusOK(manager->checkOutCursor(kNss,
+                                                    cursorIds[state.thread_index],
+                                                    clients[state.thread_index].second.get(),
+                                                    successAuthChecker,
+                                                    ClusterCursorManager::kNoCheckSession));
+        pinnedCursor.returnCursor(ClusterCursorManager::CursorState::NotExhausted);
+    }
+
+    if (state.thread_index == 0) {
+        tearDownClients();
+    }
+}
+
+/**
+ * Each thread repeatedly registers a cursor and kills it, which also updates the state shared by
+ * all the cursors on the namespace.
+ */
+BENCHMARK_DEFINE_F(ClusterCursorManagerBM, BM_RegisterKill)(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        setUpClients(state.threads);
+    }
+
+    for (auto keepRunning : state) {
+        auto opCtx = clients[state.thread_index].second.get();
+        uassertStatusOK(manager->killCursor(opCtx, kNss, registerCursor(opCtx)));
+    }
+
+    if (state.thread_index == 0) {
+        tearDownClients();
+    }
+}
+
+BENCHMARK_REGISTER_F(ClusterCursorManagerBM, BM_CheckOutCheckIn)->ThreadRange(1, kMaxThreads);
+BENCHMARK_REGISTER_F(ClusterCursorManagerBM, BM_RegisterKill)->ThreadRange(1, kMaxThreads);
+
+}  // namespace
+}  // namespace mongo
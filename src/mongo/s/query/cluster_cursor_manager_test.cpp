@@ -829,6 +829,47 @@ TEST_F(ClusterCursorManagerTest, GetNamespaceForCursorIdUnknown) {
     ASSERT_FALSE(cursorNamespace);
 }
 
+// Test that the namespace of cursors spread across partitions stays known until the last of them
+// is killed, and that a namespace registered again afterwards gets new cursor ids.
+TEST_F(ClusterCursorManagerTest, GetNamespaceForCursorIdAfterKillingCursorsAcrossPartitions) {
+    const size_t numCursors = 100;
+    std::vector<CursorId> cursorIds(numCursors);
+    for (size_t i = 0; i < numCursors; ++i) {
+        cursorIds[i] =
+            assertGet(getManager()->registerCursor(_opCtx.get(),
+                                                   allocateMockCursor(),
+                                                   nss,
+                                                   ClusterCursorManager::CursorType::SingleTarget,
+                                                   ClusterCursorManager::CursorLifetime::Mortal,
+                                                   UserNameIterator()));
+    }
+
+    for (size_t i = 0; i < numCursors - 1; ++i) {
+        ASSERT_OK(getManager()->killCursor(_opCtx.get(), nss, cursorIds[i]));
+        ASSERT(getManager()->getNamespaceForCursorId(cursorIds.back()));
+    }
+    ASSERT_EQ(1U, getManager()->stats().cursorsSingleTarget);
+
+    ASSERT_OK(getManager()->killCursor(_opCtx.get(), nss, cursorIds.back()));
+    ASSERT_FALSE(getManager()->getNamespaceForCursorId(cursorIds.back()));
+    ASSERT_EQ(0U, getManager()->stats().cursorsSingleTarget);
+    for (size_t i = 0; i < numCursors; ++i) {
+        ASSERT_TRUE(isMockCursorKilled(i));
+    }
+
+    auto cursorId =
+        assertGet(getManager()->registerCursor(_opCtx.get(),
+                                               allocateMockCursor(),
+                                               nss,
+                                               ClusterCursorManager::CursorType::SingleTarget,
+                                               ClusterCursorManager::CursorLifetime::Mortal,
+                                               UserNameIterator()));
+    auto cursorNamespace = getManager()->getNamespaceForCursorId(cursorId);
+    ASSERT(cursorNamespace);
+    ASSERT_EQ(nss.ns(), cursorNamespace->ns());
+    ASSERT_OK(getManager()->killCursor(_opCtx.get(), nss, cursorId));
+}
+
 // Test that the PinnedCursor default constructor creates a pin that owns no cursor.
 TEST_F(ClusterCursorManagerTest, PinnedCursorDefaultConstructor) {
     ClusterCursorManager::PinnedCursor pinnedCursor;
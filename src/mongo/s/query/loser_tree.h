@@ -0,0 +1,220 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * A tournament tree of losers over a fixed number of leaves, each of which either holds a value or
+ * is empty. It yields the leaf with the smallest value, as compared by 'Compare', which must be
+ * callable as 'int compare(size_t lhsLeaf, size_t rhsLeaf)' and return a negative number, zero or
+ * a positive number like memcmp. Ties are broken by leaf index, which makes the order stable.
+ *
+ * Every internal node stores the loser of the match played at it, so after the value of the
+ * winning leaf changes, only the matches on its path to the root are replayed, with one comparison
+ * per level and no reads of sibling subtrees. This makes it a better fit than a binary heap for
+ * k-way merging, where the winner is replaced on every step. Changing any other leaf makes the
+ * next call to top() or empty() rebuild the tree, which is linear in the number of leaves, so that
+ * changes to many leaves in between only cost a single rebuild.
+ *
+ * The leaves are laid out implicitly, with leaf 'i' at node 'numLeaves + i' and the parent of node
+ * 'n' at node 'n / 2', so the number of leaves does not have to be a power of two. Node 0 holds the
+ * overall winner.
+ *
+ * Not thread safe.
+ */
+template <typename Compare>
+class LoserTree {
+public:
+    static constexpr size_t kNoLeaf = std::numeric_limits<size_t>::max();
+
+    explicit LoserTree(Compare compare) : _compare(std::move(compare)) {}
+
+    /**
+     * Changes the number of leaves. Leaves which are added start out empty.
+     */
+    void resize(size_t numLeaves) {
+        _hasValue.resize(numLeaves, false);
+        _needsRebuild = true;
+    }
+
+    size_t size() const {
+        return _hasValue.size();
+    }
+
+    /**
+     * Returns true if no leaf holds a value.
+     */
+    bool empty() {
+        if (_needsRebuild) {
+            _rebuild();
+        }
+        return _nodes.empty() || !_hasValue[_nodes[0]];
+    }
+
+    /**
+     * Returns the leaf with the smallest value. Invalid to call if empty().
+     */
+    size_t top() {
+        invariant(!empty());
+        return _nodes[0];
+    }
+
+    /**
+     * Notifies the tree that 'leaf' now holds a value, which may be different from its previous
+     * one. Must be called whenever the value of a leaf changes, before the next call to top().
+     */
+    void update(size_t leaf) {
+        invariant(leaf < size());
+        if (_isWinner(leaf)) {
+            _replay(leaf);
+            return;
+        }
+
+        _hasValue[leaf] = true;
+        _needsRebuild = true;
+    }
+
+    /**
+     * Notifies the tree that 'leaf' no longer holds a value.
+     */
+    void remove(size_t leaf) {
+        invariant(leaf < size());
+        if (!_hasValue[leaf]) {
+            return;
+        }
+
+        const bool wasWinner = _isWinner(leaf);
+        _hasValue[leaf] = false;
+        if (wasWinner) {
+            _replay(leaf);
+        } else {
+            _needsRebuild = true;
+        }
+    }
+
+private:
+    /**
+     * Returns true if 'leaf' holds a value and is known to be the winner without a rebuild.
+     */
+    bool _isWinner(size_t leaf) const {
+        return !_needsRebuild && _hasValue[leaf] && leaf == _nodes[0];
+    }
+
+    /**
+     * Returns true if 'lhs' wins a match against 'rhs'. Empty leaves lose against any leaf which
+     * holds a value.
+     */
+    bool _beats(size_t lhs, size_t rhs) {
+        if (!_hasValue[rhs]) {
+            return _hasValue[lhs] || lhs < rhs;
+        }
+        if (!_hasValue[lhs]) {
+            return false;
+        }
+
+        const int cmp = _compare(lhs, rhs);
+        return cmp < 0 || (cmp == 0 && lhs < rhs);
+    }
+
+    /**
+     * Replays the matches on the path from the winning 'leaf' to the root.
+     */
+    void _replay(size_t leaf) {
+        const size_t numLeaves = size();
+
+        size_t winner = leaf;
+        for (size_t node = (numLeaves + leaf) / 2; node > 0; node /= 2) {
+            if (_beats(_nodes[node], winner)) {
+                std::swap(_nodes[node], winner);
+            }
+        }
+        _nodes[0] = winner;
+    }
+
+    /**
+     * Plays all matches bottom up.
+     */
+    void _rebuild() {
+        _needsRebuild = false;
+
+        const size_t numLeaves = size();
+        _nodes.assign(numLeaves, kNoLeaf);
+        if (numLeaves == 0) {
+            return;
+        }
+
+        // Winners of the matches at every node, where the nodes in [numLeaves, 2 * numLeaves) are
+        // the leaves themselves
+        _winners.resize(2 * numLeaves);
+        for (size_t leaf = 0; leaf < numLeaves; leaf++) {
+            _winners[numLeaves + leaf] = leaf;
+        }
+
+        for (size_t node = numLeaves - 1; node > 0; node--) {
+            const size_t lhs = _winners[2 * node];
+            const size_t rhs = _winners[2 * node + 1];
+            if (_beats(lhs, rhs)) {
+                _winners[node] = lhs;
+                _nodes[node] = rhs;
+            } else {
+                _winners[node] = rhs;
+                _nodes[node] = lhs;
+            }
+        }
+
+        _nodes[0] = numLeaves == 1 ? 0 : _winners[1];
+    }
+
+    Compare _compare;
+
+    // Whether each leaf currently holds a value
+    std::vector<bool> _hasValue;
+
+    // The winning leaf at node 0 and the losing leaf of the match at every other node
+    std::vector<size_t> _nodes;
+
+    // Scratch space for _rebuild()
+    std::vector<size_t> _winners;
+
+    // Set when a leaf other than the winner has changed, so '_nodes' no longer reflect the leaves
+    bool _needsRebuild = false;
+};
+
+template <typename Compare>
+constexpr size_t LoserTree<Compare>::kNoLeaf;
+
+}  // namespace mongo
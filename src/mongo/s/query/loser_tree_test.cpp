@@ -0,0 +1,178 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/platform/random.h"
+#include "mongo/s/query/loser_tree.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Merges sorted lists of ints with a LoserTree, in the way the AsyncResultsMerger merges the
+ * buffered results of its remotes.
+ */
+class ListMerger {
+public:
+    explicit ListMerger(std::vector<std::vector<int>> lists)
+        : _lists(std::move(lists)), _positions(_lists.size(), 0), _tree(Compare{this}) {
+        _tree.resize(_lists.size());
+        for (size_t i = 0; i < _lists.size(); i++) {
+            if (!_lists[i].empty()) {
+                _tree.update(i);
+            }
+        }
+    }
+
+    bool empty() {
+        return _tree.empty();
+    }
+
+    size_t topList() {
+        return _tree.top();
+    }
+
+    int pop() {
+        const size_t list = _tree.top();
+        const int value = _lists[list][_positions[list]++];
+        if (_positions[list] < _lists[list].size()) {
+            _tree.update(list);
+        } else {
+            _tree.remove(list);
+        }
+        return value;
+    }
+
+    /**
+     * Adds a value to the end of the specified list, which must not be smaller than the last value
+     * returned by pop() for the merged output to remain sorted.
+     */
+    void push(size_t list, int value) {
+        const bool wasEmpty = _positions[list] == _lists[list].size();
+        _lists[list].push_back(value);
+        if (wasEmpty) {
+            _tree.update(list);
+        }
+    }
+
+private:
+    struct Compare {
+        int operator()(size_t lhs, size_t rhs) const {
+            const int lhsValue = merger->_lists[lhs][merger->_positions[lhs]];
+            const int rhsValue = merger->_lists[rhs][merger->_positions[rhs]];
+            return lhsValue < rhsValue ? -1 : (lhsValue > rhsValue ? 1 : 0);
+        }
+
+        ListMerger* merger;
+    };
+
+    std::vector<std::vector<int>> _lists;
+    std::vector<size_t> _positions;
+    LoserTree<Compare> _tree;
+};
+
+TEST(LoserTree, EmptyTree) {
+    ListMerger merger({});
+    ASSERT(merger.empty());
+
+    ListMerger mergerOfEmptyLists({{}, {}, {}});
+    ASSERT(mergerOfEmptyLists.empty());
+}
+
+TEST(LoserTree, SingleList) {
+    ListMerger merger({{1, 2, 3}});
+    ASSERT_EQ(1, merger.pop());
+    ASSERT_EQ(2, merger.pop());
+    ASSERT_EQ(3, merger.pop());
+    ASSERT(merger.empty());
+}
+
+TEST(LoserTree, TiesAreBrokenByLeafIndex) {
+    ListMerger merger({{5, 7}, {5}, {3, 5}});
+    ASSERT_EQ(2U, merger.topList());
+    ASSERT_EQ(3, merger.pop());
+    ASSERT_EQ(0U, merger.topList());
+    ASSERT_EQ(5, merger.pop());
+    ASSERT_EQ(1U, merger.topList());
+    ASSERT_EQ(5, merger.pop());
+    ASSERT_EQ(2U, merger.topList());
+    ASSERT_EQ(5, merger.pop());
+    ASSERT_EQ(7, merger.pop());
+    ASSERT(merger.empty());
+}
+
+TEST(LoserTree, ListRefilledAfterRunningEmpty) {
+    ListMerger merger({{1, 4}, {2}, {3, 6}});
+    ASSERT_EQ(1, merger.pop());
+    ASSERT_EQ(2, merger.pop());
+
+    // The second list ran empty and receives more values while it is not the winner
+    merger.push(1, 5);
+    ASSERT_EQ(3, merger.pop());
+    ASSERT_EQ(4, merger.pop());
+    ASSERT_EQ(5, merger.pop());
+    ASSERT_EQ(6, merger.pop());
+    ASSERT(merger.empty());
+}
+
+TEST(LoserTree, MergesRandomListsInOrder) {
+    PseudoRandom random(1);
+
+    for (int trial = 0; trial < 200; trial++) {
+        const size_t numLists = 1 + random.nextInt32(40);
+
+        std::vector<std::vector<int>> lists(numLists);
+        std::vector<int> expected;
+        for (auto& list : lists) {
+            const int length = random.nextInt32(20);
+            for (int i = 0; i < length; i++) {
+                list.push_back(random.nextInt32(100));
+            }
+            std::sort(list.begin(), list.end());
+            expected.insert(expected.end(), list.begin(), list.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        ListMerger merger(std::move(lists));
+        std::vector<int> merged;
+        while (!merger.empty()) {
+            merged.push_back(merger.pop());
+        }
+
+        ASSERT(expected == merged) << "trial " << trial;
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,473 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/routing_table_snapshot.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <zlib.h>
+
+#include "mongo/base/data_type_endian.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/collation/collator_factory_interface.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog_cache.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/bufreader.h"
+#include "mongo/util/log.h"
+#include "mongo/util/periodic_runner.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(routingTableSnapshotPath, std::string, "");
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(routingTableSnapshotIntervalSecs, int, 300)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "routingTableSnapshotIntervalSecs must be at least 1");
+        }
+        return Status::OK();
+    });
+
+namespace routing_table_snapshot {
+namespace {
+
+const uint32_t kMagic = 0x5354524d;  // "MRTS"
+const uint32_t kFormatVersion = 2;
+
+const char kNsField[] = "ns";
+const char kUUIDField[] = "uuid";
+const char kEpochField[] = "epoch";
+const char kKeyField[] = "key";
+const char kUniqueField[] = "unique";
+const char kDefaultCollationField[] = "defaultCollation";
+
+void appendBound(BufBuilder* buf, const BSONObj& bound, Ordering ordering) {
+    BSONObjBuilder strippedBound;
+    for (const auto& elem : bound) {
+        strippedBound.appendAs(elem, ""_sd);
+    }
+
+    const KeyString ks(KeyString::Version::V1, strippedBound.obj(), ordering);
+    buf->appendNum(static_cast<uint32_t>(ks.getSize()));
+    buf->appendBuf(ks.getBuffer(), ks.getSize());
+
+    const auto& typeBits = ks.getTypeBits();
+    invariant(typeBits.getSize() <= std::numeric_limits<uint8_t>::max());
+    buf->appendNum(static_cast<char>(typeBits.getSize()));
+    buf->appendBuf(typeBits.getBuffer(), typeBits.getSize());
+}
+
+BSONObj readBound(BufReader* reader, const BSONObj& keyPattern, Ordering ordering) {
+    const auto size = reader->read<LittleEndian<uint32_t>>().value;
+    const auto ks = static_cast<const char*>(reader->skip(size));
+
+    // The TypeBits are size-prefixed, because they would otherwise decode as all zeros from an
+    // empty buffer and a snapshot truncated right before them would not be detected
+    const auto typeBitsSize = reader->read<uint8_t>();
+    BufReader typeBitsReader(reader->skip(typeBitsSize), typeBitsSize);
+    const auto typeBits =
+        KeyString::TypeBits::fromBuffer(KeyString::Version::V1, &typeBitsReader);
+
+    // The KeyString does not include the field names, so they are restored from the shard key
+    BSONObjBuilder bound;
+    BSONObjIterator fields(keyPattern);
+    for (const auto& elem : KeyString::toBsonSafe(ks, size, ordering, typeBits)) {
+        uassert(50873, "Chunk bound in routing table snapshot has too many fields", fields.more());
+        bound.appendAs(elem, fields.next().fieldNameStringData());
+    }
+    uassert(50874, "Chunk bound in routing table snapshot has too few fields", !fields.more());
+
+    return bound.obj();
+}
+
+BSONObj readBSON(BufReader* reader) {
+    const auto size = reader->peek<LittleEndian<int32_t>>().value;
+    uassert(50875,
+            "Invalid collection document size in routing table snapshot",
+            size >= BSONObj::kMinBSONLength && static_cast<unsigned>(size) <= reader->remaining());
+
+    const auto data = static_cast<const char*>(reader->skip(size));
+    uassertStatusOK(validateBSON(data, size, BSONVersion::kLatest));
+
+    return BSONObj(data).getOwned();
+}
+
+void appendRoutingTable(BufBuilder* buf, const RoutingTableHistory& rt) {
+    const auto& keyPattern = rt.getShardKeyPattern().toBSON();
+    const auto ordering = Ordering::make(keyPattern);
+    const auto& chunkMap = rt.getChunkMap();
+    invariant(!chunkMap.empty());
+
+    BSONObjBuilder collBuilder;
+    collBuilder.append(kNsField, rt.getns().ns());
+    if (auto uuid = rt.getUUID()) {
+        uuid->appendToBuilder(&collBuilder, kUUIDField);
+    }
+    collBuilder.append(kEpochField, rt.getVersion().epoch());
+    collBuilder.append(kKeyField, keyPattern);
+    collBuilder.append(kUniqueField, rt.isUnique());
+    if (auto collator = rt.getDefaultCollator()) {
+        collBuilder.append(kDefaultCollationField, collator->getSpec().toBSON());
+    }
+    const BSONObj collObj = collBuilder.obj();
+    buf->appendBuf(collObj.objdata(), collObj.objsize());
+
+    // Shard ids are stored once per collection and referred to by their index in the chunks
+    std::vector<ShardId> shardIds;
+    const auto shardIndex = [&shardIds](const ShardId& shardId) {
+        auto it = std::find(shardIds.begin(), shardIds.end(), shardId);
+        if (it == shardIds.end()) {
+            it = shardIds.insert(it, shardId);
+        }
+        return static_cast<uint32_t>(it - shardIds.begin());
+    };
+
+    BufBuilder chunksBuf;
+    for (const auto& entry : chunkMap) {
+        const auto& chunk = *entry.second;
+
+        appendBound(&chunksBuf, chunk.getMin(), ordering);
+        chunksBuf.appendNum(static_cast<uint32_t>(chunk.getLastmod().majorVersion()));
+        chunksBuf.appendNum(static_cast<uint32_t>(chunk.getLastmod().minorVersion()));
+        chunksBuf.appendNum(shardIndex(chunk.getShardIdAt(boost::none)));
+        chunksBuf.appendNum(static_cast<char>(chunk.isJumbo()));
+
+        const auto& history = chunk.getHistory();
+        chunksBuf.appendNum(static_cast<uint32_t>(history.size()));
+        for (const auto& historyEntry : history) {
+            chunksBuf.appendNum(historyEntry.getValidAfter().asULL());
+            chunksBuf.appendNum(shardIndex(historyEntry.getShard()));
+        }
+    }
+    appendBound(&chunksBuf, chunkMap.back().second->getMax(), ordering);
+
+    buf->appendNum(static_cast<uint32_t>(shardIds.size()));
+    for (const auto& shardId : shardIds) {
+        buf->appendStr(shardId.toString());
+    }
+    buf->appendNum(static_cast<uint32_t>(chunkMap.size()));
+    buf->appendBuf(chunksBuf.buf(), chunksBuf.len());
+}
+
+std::shared_ptr<RoutingTableHistory> readRoutingTable(OperationContext* opCtx,
+                                                      BufReader* reader) {
+    const BSONObj collObj = readBSON(reader);
+
+    const NamespaceString nss(collObj[kNsField].str());
+    uassert(50876,
+            str::stream() << "Invalid namespace in routing table snapshot: " << collObj,
+            nss.isValid());
+
+    boost::optional<UUID> uuid;
+    if (auto uuidElem = collObj[kUUIDField]) {
+        uuid = uassertStatusOK(UUID::parse(uuidElem));
+    }
+
+    const auto epochElem = collObj[kEpochField];
+    const auto keyElem = collObj[kKeyField];
+    uassert(50877,
+            str::stream() << "Invalid collection document in routing table snapshot: " << collObj,
+            epochElem.type() == jstOID && keyElem.type() == Object);
+    const OID epoch = epochElem.OID();
+    const BSONObj keyPattern = keyElem.Obj();
+    const auto ordering = Ordering::make(keyPattern);
+
+    std::unique_ptr<CollatorInterface> defaultCollator;
+    if (auto collationElem = collObj[kDefaultCollationField]) {
+        defaultCollator = uassertStatusOK(CollatorFactoryInterface::get(opCtx->getServiceContext())
+                                              ->makeFromBSON(collationElem.Obj()));
+    }
+
+    std::vector<ShardId> shardIds(reader->read<LittleEndian<uint32_t>>().value);
+    for (auto& shardId : shardIds) {
+        shardId = ShardId(reader->readCStr().toString());
+    }
+    const auto shardAt = [&shardIds](uint32_t index) -> const ShardId& {
+        uassert(50878, "Invalid shard index in routing table snapshot", index < shardIds.size());
+        return shardIds[index];
+    };
+
+    const auto numChunks = reader->read<LittleEndian<uint32_t>>().value;
+    uassert(50879, "Routing table snapshot contains a collection without chunks", numChunks > 0);
+
+    std::vector<ChunkType> chunks;
+    BSONObj min = readBound(reader, keyPattern, ordering);
+    for (uint32_t i = 0; i < numChunks; i++) {
+        const auto majorVersion = reader->read<LittleEndian<uint32_t>>().value;
+        const auto minorVersion = reader->read<LittleEndian<uint32_t>>().value;
+        const ShardId& shardId = shardAt(reader->read<LittleEndian<uint32_t>>().value);
+        const bool jumbo = reader->read<uint8_t>();
+
+        std::vector<ChunkHistory> history(reader->read<LittleEndian<uint32_t>>().value);
+        for (auto& entry : history) {
+            const auto validAfter = reader->read<LittleEndian<unsigned long long>>().value;
+            entry = ChunkHistory(Timestamp(validAfter),
+                                 shardAt(reader->read<LittleEndian<uint32_t>>().value));
+        }
+
+        // The max bound of each chunk is the min bound of the next one
+        BSONObj max = readBound(reader, keyPattern, ordering);
+
+        ChunkType chunk(nss,
+                        ChunkRange(min, max),
+                        ChunkVersion(majorVersion, minorVersion, epoch),
+                        shardId);
+        chunk.setJumbo(jumbo);
+        chunk.setHistory(std::move(history));
+        chunks.push_back(std::move(chunk));
+
+        min = std::move(max);
+    }
+
+    // The routing table must be built from chunks in ascending version order
+    std::sort(chunks.begin(), chunks.end(), [](const ChunkType& a, const ChunkType& b) {
+        return a.getVersion().toLong() < b.getVersion().toLong();
+    });
+
+    return RoutingTableHistory::makeNew(nss,
+                                        std::move(uuid),
+                                        KeyPattern(keyPattern.getOwned()),
+                                        std::move(defaultCollator),
+                                        collObj[kUniqueField].trueValue(),
+                                        epoch,
+                                        chunks);
+}
+
+uint32_t checksum(const char* data, size_t size) {
+    return crc32(
+        crc32(0, nullptr, 0), reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size));
+}
+
+}  // namespace
+
+std::string serialize(const std::vector<std::shared_ptr<RoutingTableHistory>>& routingTables) {
+    BufBuilder body;
+    body.appendNum(static_cast<uint32_t>(routingTables.size()));
+    for (const auto& rt : routingTables) {
+        appendRoutingTable(&body, *rt);
+    }
+
+    BufBuilder buf;
+    buf.appendNum(kMagic);
+    buf.appendNum(kFormatVersion);
+    buf.appendNum(checksum(body.buf(), body.len()));
+    buf.appendBuf(body.buf(), body.len());
+
+    return std::string(buf.buf(), buf.len());
+}
+
+std::vector<std::shared_ptr<RoutingTableHistory>> parse(OperationContext* opCtx, StringData data) {
+    BufReader reader(data.rawData(), data.size());
+
+    uassert(50880,
+            "Not a routing table snapshot",
+            reader.read<LittleEndian<uint32_t>>().value == kMagic);
+
+    const auto formatVersion = reader.read<LittleEndian<uint32_t>>().value;
+    uassert(50881,
+            str::stream() << "Unsupported routing table snapshot format version " << formatVersion,
+            formatVersion == kFormatVersion);
+
+    // The checksum is verified before decoding anything else, so that a corrupted snapshot is
+    // rejected as a whole even if it happens to decode
+    const auto expectedChecksum = reader.read<LittleEndian<uint32_t>>().value;
+    uassert(50884,
+            "Routing table snapshot checksum mismatch",
+            checksum(static_cast<const char*>(reader.pos()), reader.remaining()) ==
+                expectedChecksum);
+
+    std::vector<std::shared_ptr<RoutingTableHistory>> routingTables(
+        reader.read<LittleEndian<uint32_t>>().value);
+    for (auto& rt : routingTables) {
+        rt = readRoutingTable(opCtx, &reader);
+    }
+
+    uassert(50882, "Unexpected trailing data in routing table snapshot", reader.atEof());
+
+    return routingTables;
+}
+
+Status writeFile(const std::string& path,
+                 const std::vector<std::shared_ptr<RoutingTableHistory>>& routingTables) {
+    const std::string data = serialize(routingTables);
+
+    const boost::filesystem::path snapshotPath(path);
+    const boost::filesystem::path snapshotTempPath(path + ".tmp");
+    {
+        std::ofstream ofs(snapshotTempPath.c_str(), std::ios_base::out | std::ios_base::binary);
+        if (!ofs) {
+            return Status(ErrorCodes::FileNotOpen,
+                          str::stream() << "Failed to open " << snapshotTempPath.string()
+                                        << " for writing: "
+                                        << errnoWithDescription());
+        }
+
+        ofs.write(data.data(), data.size());
+        ofs.flush();
+        if (!ofs) {
+            return Status(ErrorCodes::OperationFailed,
+                          str::stream() << "Failed to write routing table snapshot to "
+                                        << snapshotTempPath.string()
+                                        << ": "
+                                        << errnoWithDescription());
+        }
+    }
+
+    // The snapshot is not fsynced, because a torn file is detected when it is parsed and only
+    // causes the routing tables to be loaded from the config servers
+    try {
+        boost::filesystem::rename(snapshotTempPath, snapshotPath);
+    } catch (const std::exception& ex) {
+        return Status(ErrorCodes::FileRenameFailed,
+                      str::stream() << "Failed to rename " << snapshotTempPath.string() << " to "
+                                    << snapshotPath.string()
+                                    << ": "
+                                    << ex.what());
+    }
+
+    return Status::OK();
+}
+
+StatusWith<std::vector<std::shared_ptr<RoutingTableHistory>>> readFile(OperationContext* opCtx,
+                                                                       const std::string& path) {
+    std::string data;
+    try {
+        std::ifstream ifs(path.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!ifs) {
+            return Status(ErrorCodes::FileNotOpen,
+                          str::stream() << "Failed to open " << path << " for reading");
+        }
+
+        std::ostringstream contents;
+        contents << ifs.rdbuf();
+        if (!ifs) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "Failed to read routing table snapshot from " << path);
+        }
+        data = contents.str();
+    } catch (const std::exception& ex) {
+        return Status(ErrorCodes::FileStreamFailed,
+                      str::stream() << "Unexpected error reading routing table snapshot from "
+                                    << path
+                                    << ": "
+                                    << ex.what());
+    }
+
+    try {
+        return parse(opCtx, data);
+    } catch (const DBException& ex) {
+        return ex.toStatus().withContext(str::stream() << "Failed to parse routing table snapshot "
+                                                       << path);
+    }
+}
+
+void loadIntoCatalogCache(OperationContext* opCtx) {
+    if (routingTableSnapshotPath.empty()) {
+        return;
+    }
+
+    if (!boost::filesystem::exists(routingTableSnapshotPath)) {
+        log() << "No routing table snapshot found at " << routingTableSnapshotPath;
+        return;
+    }
+
+    Timer t;
+    auto swRoutingTables = readFile(opCtx, routingTableSnapshotPath);
+    if (!swRoutingTables.isOK()) {
+        warning() << "Ignoring routing table snapshot" << causedBy(swRoutingTables.getStatus());
+        return;
+    }
+
+    auto& routingTables = swRoutingTables.getValue();
+    log() << "Loaded routing tables for " << routingTables.size()
+          << " collections from snapshot " << routingTableSnapshotPath << " in " << t.millis()
+          << " ms";
+
+    Grid::get(opCtx)->catalogCache()->seedRoutingTablesFromSnapshot(std::move(routingTables));
+}
+
+void saveFromCatalogCache(ServiceContext* serviceContext) {
+    if (routingTableSnapshotPath.empty()) {
+        return;
+    }
+
+    auto const catalogCache = Grid::get(serviceContext)->catalogCache();
+    if (!catalogCache) {
+        return;
+    }
+
+    Timer t;
+    const auto routingTables = catalogCache->getRoutingTablesForSnapshot();
+    Status status = writeFile(routingTableSnapshotPath, routingTables);
+    if (!status.isOK()) {
+        warning() << "Failed to save routing table snapshot" << causedBy(redact(status));
+        return;
+    }
+
+    LOG(1) << "Saved routing tables for " << routingTables.size() << " collections to snapshot "
+           << routingTableSnapshotPath << " in " << t.millis() << " ms";
+}
+
+void startPeriodicSave(ServiceContext* serviceContext) {
+    if (routingTableSnapshotPath.empty()) {
+        return;
+    }
+
+    auto periodicRunner = serviceContext->getPeriodicRunner();
+    invariant(periodicRunner);
+
+    PeriodicRunner::PeriodicJob job("RoutingTableSnapshot",
+                                    [](Client* client) {
+                                        saveFromCatalogCache(client->getServiceContext());
+                                    },
+                                    Seconds(routingTableSnapshotIntervalSecs));
+
+    periodicRunner->scheduleJob(std::move(job));
+}
+
+}  // namespace routing_table_snapshot
+}  // namespace mongo
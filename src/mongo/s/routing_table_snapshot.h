@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+class OperationContext;
+class RoutingTableHistory;
+class ServiceContext;
+
+/**
+ * Persists the routing tables cached by a router to a local file, so that a restarted mongos can
+ * seed its CatalogCache from disk and only fetch from the config servers the chunks which changed
+ * since the snapshot was taken, instead of reloading every collection's full chunk list.
+ *
+ * Snapshots are only written and read if the 'routingTableSnapshotPath' startup parameter is set.
+ * A snapshot is never authoritative: the CatalogCache only uses a restored routing table if the
+ * collection's epoch in config.collections still matches it, and always refreshes it before use.
+ */
+namespace routing_table_snapshot {
+
+/**
+ * Encodes the specified routing tables in the snapshot file format. All integers are little
+ * endian:
+ *
+ *  header:     uint32 magic, uint32 format version, uint32 CRC-32 of everything that follows,
+ *              uint32 number of collections
+ *  collection: BSON {ns, uuid, epoch, key, unique, defaultCollation}, uint32 number of shards,
+ *              the shard ids as NUL-terminated strings, uint32 number of chunks, the chunks in
+ *              shard key order and finally the max bound of the last chunk
+ *  chunk:      min bound, uint32 major version, uint32 minor version, uint32 shard index,
+ *              uint8 jumbo, uint32 number of history entries, then for each history entry
+ *              uint64 validAfter timestamp and uint32 shard index
+ *  bound:      uint32 KeyString size, the V1 KeyString of the bound with its field names stripped,
+ *              uint8 TypeBits size and the KeyString's TypeBits
+ *
+ * Since the chunks of a collection are contiguous, only the min bound of each chunk is stored.
+ */
+std::string serialize(const std::vector<std::shared_ptr<RoutingTableHistory>>& routingTables);
+
+/**
+ * Decodes routing tables previously encoded by 'serialize'. Throws if the data is truncated, does
+ * not match its checksum, is otherwise corrupted or was written by an unsupported format version.
+ */
+std::vector<std::shared_ptr<RoutingTableHistory>> parse(OperationContext* opCtx, StringData data);
+
+/**
+ * Atomically replaces the contents of the snapshot file at 'path' with the specified routing
+ * tables by writing them to a temporary file, which is then renamed over 'path'.
+ */
+Status writeFile(const std::string& path,
+                 const std::vector<std::shared_ptr<RoutingTableHistory>>& routingTables);
+
+/**
+ * Reads and decodes the snapshot file at 'path'.
+ */
+StatusWith<std::vector<std::shared_ptr<RoutingTableHistory>>> readFile(OperationContext* opCtx,
+                                                                       const std::string& path);
+
+/**
+ * If snapshots are enabled and a snapshot file exists, seeds the CatalogCache with the routing
+ * tables it contains. A missing or unreadable snapshot is logged and otherwise ignored, in which
+ * case the routing tables are loaded from the config servers as usual.
+ */
+void loadIntoCatalogCache(OperationContext* opCtx);
+
+/**
+ * If snapshots are enabled, writes the routing tables currently cached by the CatalogCache to the
+ * snapshot file. Failures are logged and otherwise ignored.
+ */
+void saveFromCatalogCache(ServiceContext* serviceContext);
+
+/**
+ * If snapshots are enabled, schedules a job on the service context's periodic runner, which saves
+ * the snapshot every 'routingTableSnapshotIntervalSecs' seconds.
+ */
+void startPeriodicSave(ServiceContext* serviceContext);
+
+}  // namespace routing_table_snapshot
+}  // namespace mongo
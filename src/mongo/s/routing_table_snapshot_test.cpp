@@ -0,0 +1,319 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem/path.hpp>
+
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_request.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_collection.h"
+#include "mongo/s/catalog_cache.h"
+#include "mongo/s/catalog_cache_test_fixture.h"
+#include "mongo/s/grid.h"
+#include "mongo/s/routing_table_snapshot.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo {
+namespace {
+
+using executor::RemoteCommandRequest;
+using unittest::assertGet;
+
+const NamespaceString kNss("TestDB", "TestColl");
+const NamespaceString kOtherNss("TestDB", "OtherColl");
+
+class RoutingTableSnapshotTest : public CatalogCacheTestFixture {
+protected:
+    void setUp() override {
+        CatalogCacheTestFixture::setUp();
+
+        setupNShards(3);
+    }
+
+    /**
+     * Returns a routing table sharded on {a: 1, b: -1} with bounds of mixed types, chunk versions
+     * which are not in shard key order and chunks with history.
+     */
+    std::shared_ptr<RoutingTableHistory> makeRoutingTable(const NamespaceString& nss, OID epoch) {
+        const KeyPattern keyPattern(BSON("a" << 1 << "b" << -1));
+
+        ChunkType chunk1(nss,
+                         {keyPattern.globalMin(), BSON("a" << 10 << "b" << "x")},
+                         ChunkVersion(1, 0, epoch),
+                         {"0"});
+        chunk1.setHistory({ChunkHistory(Timestamp(10, 1), {"0"})});
+
+        ChunkType chunk2(nss,
+                         {BSON("a" << 10 << "b" << "x"), BSON("a" << 20.5 << "b" << MINKEY)},
+                         ChunkVersion(1, 1, epoch),
+                         {"1"});
+        chunk2.setJumbo(true);
+        chunk2.setHistory(
+            {ChunkHistory(Timestamp(20, 1), {"1"}), ChunkHistory(Timestamp(10, 1), {"0"})});
+
+        ChunkType chunk3(nss,
+                         {BSON("a" << 20.5 << "b" << MINKEY), BSON("a" << 30LL << "b" << "y")},
+                         ChunkVersion(2, 0, epoch),
+                         {"0"});
+
+        ChunkType chunk4(nss,
+                         {BSON("a" << 30LL << "b" << "y"), keyPattern.globalMax()},
+                         ChunkVersion(1, 2, epoch),
+                         {"2"});
+
+        auto collator = stdx::make_unique<CollatorInterfaceMock>(
+            CollatorInterfaceMock::MockType::kReverseString);
+
+        return RoutingTableHistory::makeNew(nss,
+                                            UUID::gen(),
+                                            keyPattern,
+                                            std::move(collator),
+                                            true,
+                                            epoch,
+                                            {chunk1, chunk2, chunk4, chunk3});
+    }
+
+    void assertRoutingTablesEqual(const RoutingTableHistory& expected,
+                                  const RoutingTableHistory& actual) {
+        ASSERT_EQ(expected.getns(), actual.getns());
+        ASSERT(expected.getUUID() == actual.getUUID());
+        ASSERT_EQ(expected.getVersion(), actual.getVersion());
+        ASSERT_BSONOBJ_EQ(expected.getShardKeyPattern().toBSON(),
+                          actual.getShardKeyPattern().toBSON());
+        ASSERT_EQ(expected.isUnique(), actual.isUnique());
+        ASSERT(CollatorInterface::collatorsMatch(expected.getDefaultCollator(),
+                                                 actual.getDefaultCollator()));
+
+        const auto& expectedChunks = expected.getChunkMap();
+        const auto& actualChunks = actual.getChunkMap();
+        ASSERT_EQ(expectedChunks.size(), actualChunks.size());
+        for (size_t i = 0; i < expectedChunks.size(); i++) {
+            const auto& expectedChunk = *expectedChunks[i].second;
+            const auto& actualChunk = *actualChunks[i].second;
+
+            // The bounds must be restored with their original types, not only compare equal
+            ASSERT(expectedChunk.getMin().binaryEqual(actualChunk.getMin()));
+            ASSERT(expectedChunk.getMax().binaryEqual(actualChunk.getMax()));
+            ASSERT_EQ(expectedChunk.getLastmod(), actualChunk.getLastmod());
+            ASSERT_EQ(expectedChunk.getShardIdAt(boost::none),
+                      actualChunk.getShardIdAt(boost::none));
+            ASSERT_EQ(expectedChunk.isJumbo(), actualChunk.isJumbo());
+            ASSERT(expectedChunk.getHistory() == actualChunk.getHistory());
+        }
+    }
+
+    void expectGetDatabase() {
+        CatalogCacheTestFixture::expectGetDatabase(kNss);
+    }
+
+    void expectGetCollection(OID epoch) {
+        CatalogCacheTestFixture::expectGetCollection(
+            kNss, epoch, ShardKeyPattern(BSON("a" << 1 << "b" << -1)));
+    }
+
+    CatalogCache* catalogCache() const {
+        return Grid::get(operationContext())->catalogCache();
+    }
+};
+
+TEST_F(RoutingTableSnapshotTest, SerializeAndParseRoundTrip) {
+    const auto rt1 = makeRoutingTable(kNss, OID::gen());
+    const auto rt2 = makeRoutingTable(kOtherNss, OID::gen());
+
+    const auto routingTables = routing_table_snapshot::parse(
+        operationContext(), routing_table_snapshot::serialize({rt1, rt2}));
+    ASSERT_EQ(2U, routingTables.size());
+    assertRoutingTablesEqual(*rt1, *routingTables[0]);
+    assertRoutingTablesEqual(*rt2, *routingTables[1]);
+}
+
+TEST_F(RoutingTableSnapshotTest, SerializeAndParseEmptySnapshot) {
+    ASSERT(routing_table_snapshot::parse(operationContext(), routing_table_snapshot::serialize({}))
+               .empty());
+}
+
+TEST_F(RoutingTableSnapshotTest, TruncatedSnapshotIsRejected) {
+    const auto data = routing_table_snapshot::serialize({makeRoutingTable(kNss, OID::gen())});
+
+    for (size_t size = 0; size < data.size(); size++) {
+        ASSERT_THROWS(
+            routing_table_snapshot::parse(operationContext(), StringData(data.data(), size)),
+            DBException);
+    }
+}
+
+TEST_F(RoutingTableSnapshotTest, CorruptedSnapshotIsRejected) {
+    const auto data = routing_table_snapshot::serialize({makeRoutingTable(kNss, OID::gen())});
+
+    auto badMagic = data;
+    badMagic[0] ^= 0xff;
+    ASSERT_THROWS(routing_table_snapshot::parse(operationContext(), badMagic), DBException);
+
+    auto badFormatVersion = data;
+    badFormatVersion[4] ^= 0xff;
+    ASSERT_THROWS(routing_table_snapshot::parse(operationContext(), badFormatVersion),
+                  DBException);
+
+    auto trailingData = data;
+    trailingData.push_back(0);
+    ASSERT_THROWS(routing_table_snapshot::parse(operationContext(), trailingData), DBException);
+}
+
+TEST_F(RoutingTableSnapshotTest, SnapshotWithFlippedBodyByteIsRejected) {
+    const auto data = routing_table_snapshot::serialize({makeRoutingTable(kNss, OID::gen())});
+
+    // Every byte after the 12 byte header is covered by the checksum
+    for (size_t i = 12; i < data.size(); i++) {
+        auto corrupted = data;
+        corrupted[i] ^= 0x01;
+        ASSERT_THROWS_CODE(routing_table_snapshot::parse(operationContext(), corrupted),
+                           DBException,
+                           50884);
+    }
+}
+
+TEST_F(RoutingTableSnapshotTest, WriteAndReadFile) {
+    unittest::TempDir tempDir("routing_table_snapshot_test");
+    const auto path = (boost::filesystem::path(tempDir.path()) / "snapshot").string();
+
+    const auto rt = makeRoutingTable(kNss, OID::gen());
+    ASSERT_OK(routing_table_snapshot::writeFile(path, {rt}));
+
+    // Overwriting an existing snapshot replaces its contents
+    ASSERT_OK(routing_table_snapshot::writeFile(path, {rt}));
+
+    const auto routingTables =
+        assertGet(routing_table_snapshot::readFile(operationContext(), path));
+    ASSERT_EQ(1U, routingTables.size());
+    assertRoutingTablesEqual(*rt, *routingTables[0]);
+}
+
+TEST_F(RoutingTableSnapshotTest, ReadMissingFileFails) {
+    unittest::TempDir tempDir("routing_table_snapshot_test");
+    const auto path = (boost::filesystem::path(tempDir.path()) / "snapshot").string();
+
+    ASSERT_NOT_OK(routing_table_snapshot::readFile(operationContext(), path).getStatus());
+}
+
+TEST_F(RoutingTableSnapshotTest, SeededRoutingTableIsRefreshedIncrementally) {
+    const auto rt = makeRoutingTable(kNss, OID::gen());
+    ChunkVersion version = rt->getVersion();
+
+    catalogCache()->seedRoutingTablesFromSnapshot({rt});
+
+    auto future = scheduleRoutingInfoRefresh(kNss);
+
+    expectGetDatabase();
+    expectGetCollection(version.epoch());
+    expectGetCollection(version.epoch());
+
+    onFindCommand([&](const RemoteCommandRequest& request) {
+        // Only the chunks changed since the snapshot are fetched
+        const auto diffQuery =
+            assertGet(QueryRequest::makeFromFindCommand(kNss, request.cmdObj, false));
+        ASSERT_BSONOBJ_EQ(
+            BSON("ns" << kNss.ns() << "lastmod"
+                      << BSON("$gte" << Timestamp(version.majorVersion(), version.minorVersion()))),
+            diffQuery->getFilter());
+
+        version.incMajor();
+        ChunkType chunk(kNss,
+                        {BSON("a" << 30LL << "b" << "y"),
+                         rt->getShardKeyPattern().getKeyPattern().globalMax()},
+                        version,
+                        {"1"});
+
+        return std::vector<BSONObj>{chunk.toConfigBSON()};
+    });
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT(routingInfo->cm());
+    auto cm = routingInfo->cm();
+
+    ASSERT_EQ(4, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+    ASSERT_EQ(version, cm->getVersion({"1"}));
+    ASSERT_EQ(ChunkVersion(0, 0, version.epoch()), cm->getVersion({"2"}));
+
+    // The seeded routing table was consumed and replaced by the refreshed one
+    const auto snapshotRoutingTables = catalogCache()->getRoutingTablesForSnapshot();
+    ASSERT_EQ(1U, snapshotRoutingTables.size());
+    ASSERT_EQ(version, snapshotRoutingTables[0]->getVersion());
+}
+
+TEST_F(RoutingTableSnapshotTest, SeededRoutingTableWithDifferentEpochIsDiscarded) {
+    catalogCache()->seedRoutingTablesFromSnapshot({makeRoutingTable(kNss, OID::gen())});
+
+    const OID epoch = OID::gen();
+    auto future = scheduleRoutingInfoRefresh(kNss);
+
+    expectGetDatabase();
+    expectGetCollection(epoch);
+    expectGetCollection(epoch);
+
+    onFindCommand([&](const RemoteCommandRequest& request) {
+        // The collection was dropped and recreated since the snapshot, so all chunks are fetched
+        const auto fullQuery =
+            assertGet(QueryRequest::makeFromFindCommand(kNss, request.cmdObj, false));
+        ASSERT_BSONOBJ_EQ(BSON("ns" << kNss.ns() << "lastmod" << BSON("$gte" << Timestamp(0, 0))),
+                          fullQuery->getFilter());
+
+        const KeyPattern keyPattern(BSON("a" << 1 << "b" << -1));
+        ChunkType chunk(kNss,
+                        {keyPattern.globalMin(), keyPattern.globalMax()},
+                        ChunkVersion(1, 0, epoch),
+                        {"0"});
+
+        return std::vector<BSONObj>{chunk.toConfigBSON()};
+    });
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT(routingInfo->cm());
+    auto cm = routingInfo->cm();
+
+    ASSERT_EQ(1, cm->numChunks());
+    ASSERT_EQ(ChunkVersion(1, 0, epoch), cm->getVersion());
+}
+
+TEST_F(RoutingTableSnapshotTest, UnusedSeededRoutingTablesAreIncludedInNextSnapshot) {
+    const auto rt = makeRoutingTable(kNss, OID::gen());
+    catalogCache()->seedRoutingTablesFromSnapshot({rt});
+
+    auto snapshotRoutingTables = catalogCache()->getRoutingTablesForSnapshot();
+    ASSERT_EQ(1U, snapshotRoutingTables.size());
+    ASSERT_EQ(rt, snapshotRoutingTables[0]);
+
+    catalogCache()->purgeDatabase(kNss.db());
+    ASSERT(catalogCache()->getRoutingTablesForSnapshot().empty());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -83,6 +83,7 @@
 #include "mongo/s/mongos_options.h"
 #include "mongo/s/query/cluster_cursor_cleanup_job.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
+#include "mongo/s/routing_table_snapshot.h"
 #include "mongo/s/service_entry_point_mongos.h"
 #include "mongo/s/sharding_egress_metadata_hook_for_mongos.h"
 #include "mongo/s/sharding_egress_metadata_hook_for_mongos.h"
@@ -220,6 +221,10 @@ void cleanupTask(ServiceContext* serviceContext) {
             cursorManager->shutdown(opCtx);
         }
 
+        // Persist the cached routing tables, so that the next startup only needs to fetch the
+        // chunks which changed in the meantime
+        routing_table_snapshot::saveFromCatalogCache(serviceContext);
+
         if (auto pool = Grid::get(opCtx)->getExecutorPool()) {
             pool->shutdownAndJoin();
         }
@@ -404,6 +409,8 @@ ExitCode runMongosServer(ServiceContext* serviceContext) {
             return EXIT_SHARDING_ERROR;
         }
 
+        routing_table_snapshot::loadIntoCatalogCache(opCtx.get());
+
         Grid::get(opCtx.get())
             ->getBalancerConfiguration()
             ->refreshAndCheck(opCtx.get())
@@ -438,6 +445,8 @@ ExitCode runMongosServer(ServiceContext* serviceContext) {
     runner->startup();
     serviceContext->setPeriodicRunner(std::move(runner));
 
+    routing_table_snapshot::startPeriodicSave(serviceContext);
+
     SessionKiller::set(serviceContext,
                        std::make_shared<SessionKiller>(serviceContext, killSessionsRemote));
 
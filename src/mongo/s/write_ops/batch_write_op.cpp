@@ -66,6 +66,12 @@ struct WriteErrorDetailComp {
 const int kEstUpdateOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 const int kEstDeleteOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 
+// Inserts are targeted in windows of consecutive ready writes, so that the targeter can resolve
+// their shard keys together. The window starts small and doubles each time one is used up, so an
+// ordered batch which gets cut short after a few writes does not target many writes it won't send.
+const size_t kInitialInsertTargetingWindow = 16;
+const size_t kMaxInsertTargetingWindow = 8192;
+
 /**
  * Returns a new write concern that has the copy of every field from the original
  * document but with a w set to 1. This is intended for upgrading { w: 0 } write
@@ -259,6 +265,14 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
 
+    const bool targetInsertsInWindows =
+        _clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+        !_clientRequest.isInsertIndexRequest();
+    size_t insertWindowSize = kInitialInsertTargetingWindow;
+    std::vector<size_t> insertWindowOps;
+    std::vector<StatusWith<ShardEndpoint>> insertWindowEndpoints;
+    size_t insertWindowPos = 0;
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -266,6 +280,26 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         if (writeOp.getWriteState() != WriteOpState_Ready)
             continue;
 
+        if (targetInsertsInWindows && insertWindowPos == insertWindowOps.size()) {
+            if (!insertWindowOps.empty()) {
+                insertWindowSize = std::min(insertWindowSize * 2, kMaxInsertTargetingWindow);
+            }
+
+            insertWindowOps.clear();
+            insertWindowPos = 0;
+
+            std::vector<BSONObj> docs;
+            for (size_t j = i; j < numWriteOps && insertWindowOps.size() < insertWindowSize; ++j) {
+                if (_writeOps[j].getWriteState() != WriteOpState_Ready)
+                    continue;
+                insertWindowOps.push_back(j);
+                docs.push_back(_writeOps[j].getWriteItem().getDocument());
+            }
+
+            insertWindowEndpoints = targeter.targetInsertBatch(_opCtx, docs);
+            invariant(insertWindowEndpoints.size() == insertWindowOps.size());
+        }
+
         //
         // Get TargetedWrites from the targeter for the write operation
         //
@@ -274,7 +308,14 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         OwnedPointerVector<TargetedWrite> writesOwned;
         vector<TargetedWrite*>& writes = writesOwned.mutableVector();
 
-        Status targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        Status targetStatus = Status::OK();
+        if (targetInsertsInWindows) {
+            invariant(insertWindowOps[insertWindowPos] == i);
+            targetStatus = writeOp.targetInsertWrite(
+                std::move(insertWindowEndpoints[insertWindowPos++]), &writes);
+        } else {
+            targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        }
 
         if (!targetStatus.isOK()) {
             WriteErrorDetail targetError;
@@ -519,6 +519,100 @@ TEST_F(BatchWriteOpTest, MultiOpTwoShardsUnordered) {
     ASSERT_EQUALS(clientResponse.getN(), 2);
 }
 
+// Large unordered insert batch, which is targeted in several windows. All of the writes should be
+// targeted in a single round.
+TEST_F(BatchWriteOpTest, ManyInsertsTwoShardsUnordered) {
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpointA(ShardId("shardA"), ChunkVersion::IGNORED());
+    ShardEndpoint endpointB(ShardId("shardB"), ChunkVersion::IGNORED());
+    MockNSTargeter targeter;
+    initTargeterSplitRange(nss, endpointA, endpointB, &targeter);
+
+    const int numDocs = 1000;
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase wcb;
+            wcb.setOrdered(false);
+            return wcb;
+        }());
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < numDocs; ++i) {
+            docs.push_back(BSON("x" << (i % 2 ? i : -i - 1)));
+        }
+        insertOp.setDocuments(docs);
+        return insertOp;
+    }());
+
+    BatchWriteOp batchOp(operationContext(), request);
+
+    OwnedPointerMap<ShardId, TargetedWriteBatch> targetedOwned;
+    std::map<ShardId, TargetedWriteBatch*>& targeted = targetedOwned.mutableMap();
+    ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted));
+    ASSERT(!batchOp.isFinished());
+    verifyTargetedBatches({{endpointA.shardName, numDocs / 2}, {endpointB.shardName, numDocs / 2}},
+                          targeted);
+
+    BatchedCommandResponse response;
+    buildResponse(numDocs / 2, &response);
+
+    for (auto it = targeted.begin(); it != targeted.end(); ++it) {
+        ASSERT(!batchOp.isFinished());
+        batchOp.noteBatchResponse(*it->second, response, NULL);
+    }
+    ASSERT(batchOp.isFinished());
+
+    BatchedCommandResponse clientResponse;
+    batchOp.buildClientResponse(&clientResponse);
+    ASSERT(clientResponse.getOk());
+    ASSERT_EQUALS(clientResponse.getN(), numDocs);
+}
+
+// Large unordered insert batch in which every other write cannot be targeted. The targeting errors
+// are recorded per write and the other writes are still sent.
+TEST_F(BatchWriteOpTest, ManyInsertsWithTargetErrorsUnordered) {
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpoint(ShardId("shard"), ChunkVersion::IGNORED());
+    MockNSTargeter targeter;
+    initTargeterHalfRange(nss, endpoint, &targeter);
+
+    const int numDocs = 100;
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase wcb;
+            wcb.setOrdered(false);
+            return wcb;
+        }());
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < numDocs; ++i) {
+            docs.push_back(BSON("x" << (i % 2 ? i : -i - 1)));
+        }
+        insertOp.setDocuments(docs);
+        return insertOp;
+    }());
+
+    BatchWriteOp batchOp(operationContext(), request);
+
+    OwnedPointerMap<ShardId, TargetedWriteBatch> targetedOwned;
+    std::map<ShardId, TargetedWriteBatch*>& targeted = targetedOwned.mutableMap();
+    ASSERT_OK(batchOp.targetBatch(targeter, true, &targeted));
+    ASSERT_EQUALS(targeted.size(), 1u);
+    ASSERT_EQUALS(targeted.begin()->second->getWrites().size(), size_t(numDocs / 2));
+
+    BatchedCommandResponse response;
+    buildResponse(numDocs / 2, &response);
+    batchOp.noteBatchResponse(*targeted.begin()->second, response, NULL);
+    ASSERT(batchOp.isFinished());
+
+    BatchedCommandResponse clientResponse;
+    batchOp.buildClientResponse(&clientResponse);
+    ASSERT(clientResponse.getOk());
+    ASSERT_EQUALS(clientResponse.getN(), numDocs / 2);
+    ASSERT_EQUALS(clientResponse.sizeErrDetails(), size_t(numDocs / 2));
+    ASSERT_EQUALS(clientResponse.getErrDetailsAt(0)->getIndex(), 1);
+}
+
 // Multi-op (ordered) targeting test where each op goes to both shards. There should be two sets of
 // two batches to each shard (two for each delete op).
 TEST_F(BatchWriteOpTest, MultiOpTwoShardsEachOrdered) {
@@ -384,6 +384,61 @@ StatusWith<ShardEndpoint> ChunkManagerTargeter::targetInsert(OperationContext* o
     return Status::OK();
 }
 
+std::vector<StatusWith<ShardEndpoint>> ChunkManagerTargeter::targetInsertBatch(
+    OperationContext* opCtx, const std::vector<BSONObj>& docs) const {
+    if (!_routingInfo->cm()) {
+        return NSTargeter::targetInsertBatch(opCtx, docs);
+    }
+
+    const auto& shardKeyPattern = _routingInfo->cm()->getShardKeyPattern();
+
+    // Extract and validate the shard key of every document, then look up the chunks for all of the
+    // valid ones at once.
+    std::vector<Status> keyStatuses;
+    std::vector<BSONObj> shardKeys;
+    keyStatuses.reserve(docs.size());
+    shardKeys.reserve(docs.size());
+    for (const auto& doc : docs) {
+        auto shardKey = shardKeyPattern.extractShardKeyFromDoc(doc);
+        if (shardKey.isEmpty()) {
+            keyStatuses.push_back({ErrorCodes::ShardKeyNotFound,
+                                   str::stream() << "document " << doc
+                                                 << " does not contain shard key for pattern "
+                                                 << shardKeyPattern.toString()});
+            continue;
+        }
+
+        Status status = ShardKeyPattern::checkShardKeySize(shardKey);
+        if (status.isOK()) {
+            shardKeys.push_back(std::move(shardKey));
+        }
+        keyStatuses.push_back(std::move(status));
+    }
+
+    const auto chunks = _routingInfo->cm()->findIntersectingChunksWithSimpleCollation(shardKeys);
+
+    std::vector<StatusWith<ShardEndpoint>> endpoints;
+    endpoints.reserve(docs.size());
+    auto chunkIt = chunks.begin();
+    for (size_t i = 0; i < docs.size(); ++i) {
+        if (!keyStatuses[i].isOK()) {
+            endpoints.push_back(std::move(keyStatuses[i]));
+            continue;
+        }
+
+        const auto& chunk = *chunkIt++;
+
+        // Track autosplit stats for sharded collections
+        // Note: this is only best effort accounting and is not accurate.
+        _stats->chunkSizeDelta[chunk.getMin()] += docs[i].objsize();
+
+        endpoints.push_back(
+            ShardEndpoint(chunk.getShardId(), _routingInfo->cm()->getVersion(chunk.getShardId())));
+    }
+
+    return endpoints;
+}
+
 StatusWith<std::vector<ShardEndpoint>> ChunkManagerTargeter::targetUpdate(
     OperationContext* opCtx, const write_ops::UpdateOpEntry& updateDoc) const {
     //
@@ -72,6 +72,11 @@ public:
     StatusWith<ShardEndpoint> targetInsert(OperationContext* opCtx,
                                            const BSONObj& doc) const override;
 
+    // Extracts the shard keys of all documents first and resolves them against the routing table
+    // together. Errors are per-document, as for targetInsert.
+    std::vector<StatusWith<ShardEndpoint>> targetInsertBatch(
+        OperationContext* opCtx, const std::vector<BSONObj>& docs) const override;
+
     // Returns ShardKeyNotFound if the update can't be targeted without a shard key.
     StatusWith<std::vector<ShardEndpoint>> targetUpdate(
         OperationContext* opCtx, const write_ops::UpdateOpEntry& updateDoc) const override;
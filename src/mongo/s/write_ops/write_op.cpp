@@ -112,6 +112,26 @@ Status WriteOp::targetWrites(OperationContext* opCtx,
     return Status::OK();
 }
 
+Status WriteOp::targetInsertWrite(StatusWith<ShardEndpoint> swEndpoint,
+                                  std::vector<TargetedWrite*>* targetedWrites) {
+    invariant(_itemRef.getOpType() == BatchedCommandRequest::BatchType_Insert);
+    invariant(!_itemRef.getRequest()->isInsertIndexRequest());
+
+    if (!swEndpoint.isOK())
+        return swEndpoint.getStatus();
+
+    _childOps.emplace_back(this);
+
+    WriteOpRef ref(_itemRef.getItemIndex(), _childOps.size() - 1);
+    targetedWrites->push_back(new TargetedWrite(std::move(swEndpoint.getValue()), ref));
+
+    _childOps.back().pendingWrite = targetedWrites->back();
+    _childOps.back().state = WriteOpState_Pending;
+
+    _state = WriteOpState_Pending;
+    return Status::OK();
+}
+
 size_t WriteOp::getNumTargeted() {
     return _childOps.size();
 }
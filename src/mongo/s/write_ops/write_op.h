@@ -121,6 +121,13 @@ public:
                         const NSTargeter& targeter,
                         std::vector<TargetedWrite*>* targetedWrites);
 
+    /**
+     * Same as targetWrites, for an insert whose endpoint was already obtained from the targeter
+     * together with those of other inserts (see NSTargeter::targetInsertBatch).
+     */
+    Status targetInsertWrite(StatusWith<ShardEndpoint> swEndpoint,
+                             std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Returns the number of child writes that were last targeted.
      */
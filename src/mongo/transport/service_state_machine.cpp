@@ -391,6 +391,11 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         // If this is an exhaust cursor, don't source more Messages
         if (dbresponse.exhaustNS.size() > 0 && setExhaustMessage(&_inMessage, dbresponse)) {
             _inExhaust = true;
+        } else if (dbresponse.nextInvocation) {
+            // The reply to the next invocation answers the reply sent now.
+            _inExhaust = true;
+            _inMessage = std::move(*dbresponse.nextInvocation);
+            _inMessage.header().setId(toSink.header().getId());
         } else {
             _inExhaust = false;
             _inMessage.reset();
@@ -70,6 +70,9 @@ public:
         ASSERT_TRUE(haveClient());
 
         auto req = OpMsgRequest::parse(request);
+        if (req.getCommandName() == "getMore"_sd) {
+            return _handleGetMore(request);
+        }
         ASSERT_BSONOBJ_EQ(BSON("ping" << 1), req.body);
 
         // Build out a dummy reply
@@ -106,9 +109,46 @@ public:
         return ret;
     }
 
+    void setGetMoreBatches(int batches) {
+        _getMoreBatchesLeft = batches;
+    }
+
+    int getMoresRun() const {
+        return _getMoresRun;
+    }
+
 private:
+    /**
+     * Returns a batch of a cursor which is exhausted after the number of batches set through
+     * setGetMoreBatches(). Like mongod, runs the getMore again if it was sent with the
+     * exhaustSupported flag and the cursor is still open.
+     */
+    DbResponse _handleGetMore(const Message& request) {
+        ++_getMoresRun;
+        ASSERT_GT(_getMoreBatchesLeft, 0);
+        const bool cursorExhausted = --_getMoreBatchesLeft == 0;
+
+        OpMsgBuilder builder;
+        builder.setBody(BSON("cursor" << BSON("id" << (cursorExhausted ? 0LL : 5LL) << "ns"
+                                                   << "test.coll"
+                                                   << "nextBatch"
+                                                   << BSONArray())
+                                      << "ok"
+                                      << 1));
+        DbResponse response{builder.finish()};
+
+        if (!cursorExhausted && OpMsg::isFlagSet(request, OpMsg::kExhaustSupported)) {
+            OpMsg::setFlag(&response.response, OpMsg::kMoreToCome);
+            response.nextInvocation = OpMsg::parse(request).serialize();
+            OpMsg::setFlag(&*response.nextInvocation, OpMsg::kExhaustSupported);
+        }
+        return response;
+    }
+
     bool _uassertInHandler = false;
     bool _ranHandler = false;
+    int _getMoreBatchesLeft = 0;
+    int _getMoresRun = 0;
 };
 
 using namespace transport;
@@ -133,11 +173,17 @@ public:
                 return TransportLayer::TicketSessionClosedStatus;
             }
 
+            ++tl->_timesSourced;
             auto out = MockSession::sourceMessage();
             if (out.isOK()) {
-                OpMsgBuilder builder;
-                builder.setBody(BSON("ping" << 1));
-                out.getValue() = builder.finish();
+                if (tl->_nextToSource) {
+                    out.getValue() = std::move(*tl->_nextToSource);
+                    tl->_nextToSource = boost::none;
+                } else {
+                    OpMsgBuilder builder;
+                    builder.setBody(BSON("ping" << 1));
+                    out.getValue() = builder.finish();
+                }
             }
             return out;
         }
@@ -191,6 +237,17 @@ public:
         return _ranSource;
     }
 
+    int timesSourced() const {
+        return _timesSourced;
+    }
+
+    /**
+     * Makes the next sourced message 'message' rather than a ping.
+     */
+    void setNextToSource(Message message) {
+        _nextToSource = std::move(message);
+    }
+
     void setWaitHook(stdx::function<void()> hook) {
         _waitHook = std::move(hook);
     }
@@ -199,6 +256,8 @@ private:
     bool _lastTicketSource = true;
     bool _ranSink = false;
     bool _ranSource = false;
+    int _timesSourced = 0;
+    boost::optional<Message> _nextToSource;
     FailureMode _nextShouldFail = Nothing;
     Message _lastSunk;
     ServiceStateMachine* _ssm;
@@ -545,6 +604,39 @@ TEST_F(ServiceStateMachineFixture, TerminateWorksForAllStatesWithScheduleFailure
     }
 }
 
+// The replies to an exhaust getMore are sent one after another without sourcing another message,
+// each answering the one before it.
+TEST_F(ServiceStateMachineFixture, ExhaustGetMoreRunsUntilCursorIsExhausted) {
+    const int kBatches = 3;
+    _sep->setGetMoreBatches(kBatches);
+
+    auto getMore = buildRequest(BSON("getMore" << 5LL << "collection"
+                                               << "coll"
+                                               << "$db"
+                                               << "test"));
+    OpMsg::setFlag(&getMore, OpMsg::kExhaustSupported);
+    getMore.header().setId(42);
+    _tl->setNextToSource(std::move(getMore));
+
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Process);
+
+    int32_t expectedResponseTo = 42;
+    for (int batch = 1; batch <= kBatches; ++batch) {
+        _ssm->runNext();
+
+        const bool moreToCome = batch < kBatches;
+        auto reply = _tl->getLastSunk();
+        ASSERT_EQ(reply.header().getResponseToMsgId(), expectedResponseTo);
+        ASSERT_EQ(OpMsg::isFlagSet(reply, OpMsg::kMoreToCome), moreToCome);
+        ASSERT_EQ(_ssm->state(), moreToCome ? State::Process : State::Source);
+        expectedResponseTo = reply.header().getId();
+    }
+
+    ASSERT_EQ(_sep->getMoresRun(), kBatches);
+    ASSERT_EQ(_tl->timesSourced(), 1);
+}
+
 // This makes sure that the SSM can run recursively by forcing the ServiceExecutor to run everything
 // recursively
 TEST_F(ServiceStateMachineFixture, SSMRunsRecursively) {
@@ -187,6 +187,13 @@ public:
         return _buffer.isShared();
     }
 
+    /**
+     * Returns the allocation size of the underlying buffer.
+     */
+    size_t capacity() const {
+        return _buffer.capacity();
+    }
+
     /**
      * Converts to a mutable SharedBuffer.
      * This is only legal to call if you have exclusive access to the underlying buffer.
@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+
+set -o verbose
+set -o errexit
+
+# This script downloads and imports zstd
+# Only the library sources are imported, zstd's own make/cmake build is not used.
+# This script is designed to run on most unix-like OSes
+#
+
+VERSION=1.5.7
+NAME=zstd
+TARBALL=${NAME}-${VERSION}.tar.gz
+TARBALL_DEST_DIR=${NAME}-${VERSION}
+DEST_DIR=$(git rev-parse --show-toplevel)/src/third_party/zstandard-${VERSION}
+
+echo ${DEST_DIR}
+
+rm -fr ${TARBALL_DEST_DIR}
+rm -f ${TARBALL}
+
+if [ ! -f ${TARBALL} ]; then
+    echo "Get tarball"
+    wget https://github.com/facebook/zstd/releases/download/v${VERSION}/${TARBALL}
+fi
+
+tar -zxvf ${TARBALL}
+
+rm -rf ${DEST_DIR}/zstd
+mkdir -p ${DEST_DIR}/zstd/lib
+
+# Just move the compression and decompression sources, WiredTiger does not use the dictionary
+# builder, the deprecated streaming API or the legacy formats
+mv ${TARBALL_DEST_DIR}/lib/{common,compress,decompress} ${DEST_DIR}/zstd/lib
+mv ${TARBALL_DEST_DIR}/lib/{zstd.h,zstd_errors.h} ${DEST_DIR}/zstd/lib
+
+# The SConscript builds with ZSTD_DISABLE_ASM
+rm -f ${DEST_DIR}/zstd/lib/decompress/huf_decompress_amd64.S
+
+# Move the license
+mv ${TARBALL_DEST_DIR}/{LICENSE,COPYING} ${DEST_DIR}/zstd
+
+rm -fR ${TARBALL_DEST_DIR}
+rm -f ${TARBALL}
+
+# Note: The SConscript is maintained by hand in ${DEST_DIR}
+echo "Done"